@@ -0,0 +1,2 @@
+SOURCES = lttng.cpp
+CONFIG -= qt dylib
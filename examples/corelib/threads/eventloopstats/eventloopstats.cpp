@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the examples of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** BSD License Usage
+** Alternatively, you may use this file under the terms of the BSD license
+** as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of The Qt Company Ltd nor the names of its
+**     contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore>
+
+#include <stdio.h>
+
+//! [0]
+// Handling a work request keeps the thread busy for a few milliseconds.
+class Worker : public QObject
+{
+public:
+    Worker()
+    {
+        // a timer that fires often, to show how late timers get when
+        // the thread is saturated
+        heartbeat.start(10, Qt::PreciseTimer, this);
+    }
+
+    bool event(QEvent *event) override
+    {
+        if (event->type() == QEvent::User) {
+            QElapsedTimer timer;
+            timer.start();
+            while (!timer.hasExpired(3))
+                ;
+            return true;
+        }
+        return QObject::event(event);
+    }
+
+protected:
+    void timerEvent(QTimerEvent *) override { }
+
+private:
+    QBasicTimer heartbeat;
+};
+//! [0]
+
+//! [1]
+// Periodically prints what the event loops of the monitored threads did
+// since the previous report.
+class Monitor : public QObject
+{
+public:
+    void addThread(const char *name, QThread *thread)
+    {
+        threads.append({ name, thread, thread->eventDispatcher()->statistics() });
+    }
+
+protected:
+    void timerEvent(QTimerEvent *) override
+    {
+        for (MonitoredThread &t : threads) {
+            const QEventDispatcherStatistics current = t.thread->eventDispatcher()->statistics();
+            report(t.name, t.previous, current);
+            t.previous = current;
+        }
+        fputc('\n', stdout);
+        fflush(stdout);
+    }
+//! [1]
+
+private:
+//! [2]
+    static void report(const char *name, const QEventDispatcherStatistics &previous,
+                       const QEventDispatcherStatistics &current)
+    {
+        const qint64 busy = current.busyTime() - previous.busyTime();
+        const qint64 blocked = current.blockedTime() - previous.blockedTime();
+        const qint64 total = qMax(busy + blocked, Q_INT64_C(1));
+        printf("%-8s %6llu iterations, %3d%% busy, %4d events queued (oldest %lld ms)\n",
+               name, current.iterations() - previous.iterations(),
+               int(busy * 100 / total), current.postedEventCount(),
+               current.oldestPostedEventAge() / 1000000);
+
+        const quint64 delivered = current.deliveredPostedEventCount() - previous.deliveredPostedEventCount();
+        printf("         %6llu posted events delivered; latency since start: %.2f ms average, %.2f ms maximum\n",
+               delivered, current.averagePostedEventLatency() / 1e6,
+               current.maximumPostedEventLatency() / 1e6);
+//! [2]
+
+//! [3]
+        const QVector<quint64> lateness = current.timerLatenessHistogram();
+        const QVector<quint64> previousLateness = previous.timerLatenessHistogram();
+        printf("         timers late by [<1 <2 <4 <8 ... ms]:");
+        for (int i = 0; i < lateness.size(); ++i)
+            printf(" %llu", lateness.at(i) - previousLateness.at(i));
+        printf("\n");
+
+        const QMetaEnum types = QMetaEnum::fromType<QEvent::Type>();
+        for (QEvent::Type type : current.eventTypes()) {
+            const quint64 count = current.eventCount(type) - previous.eventCount(type);
+            if (!count)
+                continue;
+            const qint64 time = current.eventHandlingTime(type) - previous.eventHandlingTime(type);
+            printf("         %-16s %6llu handled in %8.2f ms\n",
+                   types.valueToKey(type), count, time / 1e6);
+        }
+    }
+//! [3]
+
+    struct MonitoredThread
+    {
+        const char *name;
+        QThread *thread;
+        QEventDispatcherStatistics previous;
+    };
+    QVector<MonitoredThread> threads;
+};
+
+//! [4]
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QThread thread;
+    Worker worker;
+    worker.moveToThread(&thread);
+    thread.start();
+    while (!thread.eventDispatcher())
+        QThread::msleep(1);
+
+    // The main thread posts work requests to the worker at a rate that
+    // increases every second; after a few seconds the worker cannot keep
+    // up, and its queue and latencies grow.
+    int requestsPerTick = 1;
+    QTimer producer;
+    QObject::connect(&producer, &QTimer::timeout, [&]() {
+        for (int i = 0; i < requestsPerTick; ++i)
+            QCoreApplication::postEvent(&worker, new QEvent(QEvent::User));
+    });
+    producer.start(10);
+
+    QTimer ramp;
+    QObject::connect(&ramp, &QTimer::timeout, [&]() { ++requestsPerTick; });
+    ramp.start(1000);
+
+    Monitor monitor;
+    monitor.addThread("main", app.thread());
+    monitor.addThread("worker", &thread);
+    monitor.startTimer(1000);
+
+    QTimer::singleShot(8000, &app, &QCoreApplication::quit);
+    const int result = app.exec();
+
+    thread.quit();
+    thread.wait();
+    return result;
+}
+//! [4]
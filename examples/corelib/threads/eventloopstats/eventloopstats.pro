@@ -0,0 +1,9 @@
+SOURCES += eventloopstats.cpp
+QT = core
+
+CONFIG -= app_bundle
+CONFIG += console
+
+# install
+target.path = $$[QT_INSTALL_EXAMPLES]/corelib/threads/eventloopstats
+INSTALLS += target
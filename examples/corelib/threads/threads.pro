@@ -1,7 +1,8 @@
 TEMPLATE      = subdirs
 CONFIG += no_docs_target
 
-SUBDIRS       = semaphores \
+SUBDIRS       = eventloopstats \
+                semaphores \
                 waitconditions
 
 qtHaveModule(widgets): SUBDIRS += \
@@ -39,6 +39,7 @@
 
 #include "qlatincodec_p.h"
 #include "qlist.h"
+#include "private/qsimd_p.h"
 
 #ifndef QT_NO_TEXTCODEC
 
@@ -104,82 +105,111 @@ QLatin15Codec::~QLatin15Codec()
 {
 }
 
+// ISO-8859-15 differs from ISO-8859-1 in eight positions between 0xA4 and 0xBE
+enum { Latin15First = 0xa4, Latin15Last = 0xbe };
+
+static const ushort latin15ToUnicode[Latin15Last - Latin15First + 1] = {
+    0x20ac, 0x00a5, 0x0160, 0x00a7, 0x0161, 0x00a9, 0x00aa, 0x00ab,
+    0x00ac, 0x00ad, 0x00ae, 0x00af, 0x00b0, 0x00b1, 0x00b2, 0x00b3,
+    0x017d, 0x00b5, 0x00b6, 0x00b7, 0x017e, 0x00b9, 0x00ba, 0x00bb,
+    0x0152, 0x0153, 0x0178
+};
+
+void qt_from_latin1(ushort *dst, const char *str, size_t size) Q_DECL_NOTHROW;
+
 QString QLatin15Codec::convertToUnicode(const char* chars, int len, ConverterState *) const
 {
     if (chars == 0)
         return QString();
+    if (len < 0)
+        len = int(qstrlen(chars));
 
-    QString str = QString::fromLatin1(chars, len);
-    QChar *uc = str.data();
-    while(len--) {
-        switch(uc->unicode()) {
-            case 0xa4:
-                *uc = 0x20ac;
-                break;
-            case 0xa6:
-                *uc = 0x0160;
-                break;
-            case 0xa8:
-                *uc = 0x0161;
-                break;
-            case 0xb4:
-                *uc = 0x017d;
-                break;
-            case 0xb8:
-                *uc = 0x017e;
-                break;
-            case 0xbc:
-                *uc = 0x0152;
-                break;
-            case 0xbd:
-                *uc = 0x0153;
-                break;
-            case 0xbe:
-                *uc = 0x0178;
-                break;
-            default:
-                break;
-        }
-        uc++;
-    }
+    QString str(len, Qt::Uninitialized);
+    convertToUnicode(str.data(), chars, len);
     return str;
 }
 
+/*
+    Converts the \a len bytes starting at \a chars to the buffer starting
+    at \a buffer, which must have room for \a len characters. Returns a
+    pointer to one past the last character written.
+*/
+QChar *QLatin15Codec::convertToUnicode(QChar *buffer, const char *chars, int len) Q_DECL_NOTHROW
+{
+    ushort *dst = reinterpret_cast<ushort *>(buffer);
+    qt_from_latin1(dst, chars, size_t(len));
+
+    for (ushort *end = dst + len; dst != end; ++dst) {
+        if (Q_UNLIKELY(uint(*dst - Latin15First) <= Latin15Last - Latin15First))
+            *dst = latin15ToUnicode[*dst - Latin15First];
+    }
+    return reinterpret_cast<QChar *>(dst);
+}
+
 QByteArray QLatin15Codec::convertFromUnicode(const QChar *in, int length, ConverterState *state) const
 {
-    const char replacement = (state && state->flags & ConvertInvalidToNull) ? 0 : '?';
     QByteArray r(length, Qt::Uninitialized);
-    char *d = r.data();
+    convertFromUnicode(r.data(), in, length, state);
+    return r;
+}
+
+/*
+    Converts the \a length characters starting at \a in to the buffer
+    starting at \a out, which must have room for \a length bytes, replacing
+    the characters this codec can't encode as set in \a state. Returns a
+    pointer to one past the last byte written.
+*/
+char *QLatin15Codec::convertFromUnicode(char *out, const QChar *in, int length, ConverterState *state) Q_DECL_NOTHROW
+{
+    const char replacement = (state && state->flags & ConvertInvalidToNull) ? 0 : '?';
+    uchar *d = reinterpret_cast<uchar *>(out);
+    const ushort *src = reinterpret_cast<const ushort *>(in);
+    const ushort *const end = src + length;
     int invalid = 0;
-    for (int i = 0; i < length; ++i) {
-        uchar c;
-        ushort uc = in[i].unicode();
-        if (uc < 0x0100) {
-            if (uc > 0xa3) {
-                switch(uc) {
-                case 0xa4:
-                case 0xa6:
-                case 0xa8:
-                case 0xb4:
-                case 0xb8:
-                case 0xbc:
-                case 0xbd:
-                case 0xbe:
+
+    while (src != end) {
+        // the characters below U+00A4 are the same in both, so pack them
+        // sixteen at a time; after a block that has others, convert the next
+        // 64 characters one by one before trying again
+#if defined(__SSE2__)
+        for ( ; end - src >= 16 && *src < Latin15First; src += 16, d += 16) {
+            const __m128i data1 = _mm_loadu_si128((const __m128i *)src);
+            const __m128i data2 = _mm_loadu_si128(1 + (const __m128i *)src);
+            // compare as signed, after moving U+0000 to the bottom
+            const __m128i bias = _mm_set1_epi16(short(0x8000));
+            const __m128i limit = _mm_set1_epi16(short(0x8000 + Latin15First));
+            const __m128i below = _mm_and_si128(_mm_cmplt_epi16(_mm_add_epi16(data1, bias), limit),
+                                                _mm_cmplt_epi16(_mm_add_epi16(data2, bias), limit));
+            if (_mm_movemask_epi8(below) != 0xffff)
+                break;
+            _mm_storeu_si128((__m128i *)d, _mm_packus_epi16(data1, data2));
+        }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+        for ( ; end - src >= 16 && *src < Latin15First; src += 16, d += 16) {
+            const uint16x8_t data1 = vld1q_u16(src);
+            const uint16x8_t data2 = vld1q_u16(src + 8);
+            if (vmaxvq_u16(vmaxq_u16(data1, data2)) >= Latin15First)
+                break;
+            vst1q_u8(d, vcombine_u8(vmovn_u16(data1), vmovn_u16(data2)));
+        }
+#endif
+
+        const ushort *runEnd = src + qMin<qptrdiff>(64, end - src);
+        for ( ; src != runEnd; ++src, ++d) {
+            const ushort uc = *src;
+            uchar c = uchar(uc);
+            if (uc < Latin15First) {
+                // the same in ISO-8859-1 and ISO-8859-15
+            } else if (uc < 0x0100) {
+                if (uc <= Latin15Last && latin15ToUnicode[uc - Latin15First] != uc) {
                     c = replacement;
                     ++invalid;
-                    break;
-                default:
-                    c = (unsigned char) uc;
-                    break;
                 }
             } else {
-                c = (unsigned char) uc;
-            }
-        } else {
-            if (uc == 0x20ac)
-                c = 0xa4;
-            else if ((uc & 0xff00) == 0x0100) {
-                switch(uc) {
+                switch (uc) {
+                case 0x20ac:
+                    c = 0xa4;
+                    break;
                 case 0x0160:
                     c = 0xa6;
                     break;
@@ -205,18 +235,15 @@ QByteArray QLatin15Codec::convertFromUnicode(const QChar *in, int length, Conver
                     c = replacement;
                     ++invalid;
                 }
-            } else {
-                c = replacement;
-                ++invalid;
             }
+            *d = c;
         }
-        d[i] = (char)c;
     }
     if (state) {
         state->remainingChars = 0;
         state->invalidChars += invalid;
     }
-    return r;
+    return reinterpret_cast<char *>(d);
 }
 
 
@@ -81,6 +81,10 @@ public:
     QString convertToUnicode(const char *, int, ConverterState *) const Q_DECL_OVERRIDE;
     QByteArray convertFromUnicode(const QChar *, int, ConverterState *) const Q_DECL_OVERRIDE;
 
+    // stateless conversions into a buffer of at least as many characters as the input
+    static QChar *convertToUnicode(QChar *, const char *, int) Q_DECL_NOTHROW;
+    static char *convertFromUnicode(char *, const QChar *, int, ConverterState *) Q_DECL_NOTHROW;
+
     QByteArray name() const Q_DECL_OVERRIDE;
     QList<QByteArray> aliases() const Q_DECL_OVERRIDE;
     int mibEnum() const Q_DECL_OVERRIDE;
@@ -39,6 +39,7 @@
 
 #include "qsimplecodec_p.h"
 #include "qlist.h"
+#include "private/qsimd_p.h"
 
 #ifndef QT_NO_TEXTCODEC
 
@@ -605,39 +606,122 @@ static const struct {
     // if you add more chacater sets at the end, change LAST_MIB above
 };
 
-QSimpleTextCodec::QSimpleTextCodec(int i) : forwardIndex(i), reverseMap(0)
+// The tables for both directions, built the first time the codec is used;
+// every codec is instantiated at start-up, most of them are never used.
+struct QSimpleTextCodec::Tables
+{
+    ushort toUnicode[256];
+    QByteArray fromUnicode; // indexed by code unit, up to the largest one encodable; 0 if not encodable
+};
+
+QSimpleTextCodec::QSimpleTextCodec(int i) : forwardIndex(i), tables(0)
 {
 }
 
 
 QSimpleTextCodec::~QSimpleTextCodec()
 {
-    delete reverseMap.load();
+    delete tables.load();
 }
 
-static QByteArray *buildReverseMap(int forwardIndex)
+static QSimpleTextCodec::Tables *buildTables(int forwardIndex)
 {
-    QByteArray *map = new QByteArray();
+    QSimpleTextCodec::Tables *t = new QSimpleTextCodec::Tables;
+    const quint16 *values = unicodevalues[forwardIndex].values;
+    for (int i = 0; i < 128; ++i) {
+        t->toUnicode[i] = ushort(i);
+        t->toUnicode[i + 128] = values[i];
+    }
+
     int m = 0;
-    int i = 0;
-    while(i < 128) {
-        if (unicodevalues[forwardIndex].values[i] > m &&
-             unicodevalues[forwardIndex].values[i] < 0xfffd)
-            m = unicodevalues[forwardIndex].values[i];
-        i++;
+    for (int i = 0; i < 128; ++i) {
+        if (values[i] > m && values[i] < 0xfffd)
+            m = values[i];
     }
     m++;
-    map->resize(m);
-    for(i = 0; i < 128 && i < m; i++)
-        (*map)[i] = (char)i;
-    for(;i < m; i++)
-        (*map)[i] = 0;
-    for(i=128; i<256; i++) {
-        int u = unicodevalues[forwardIndex].values[i-128];
+    QByteArray &map = t->fromUnicode;
+    map.resize(m);
+    int i;
+    for (i = 0; i < 128 && i < m; i++)
+        map[i] = (char)i;
+    for (; i < m; i++)
+        map[i] = 0;
+    for (i = 128; i < 256; i++) {
+        int u = values[i - 128];
         if (u < m)
-            (*map)[u] = (char)(unsigned char)(i);
+            map[u] = (char)(unsigned char)(i);
+    }
+    return t;
+}
+
+const QSimpleTextCodec::Tables *QSimpleTextCodec::loadTables() const
+{
+    Tables *t = tables.loadAcquire();
+    if (!t) {
+        Tables *built = buildTables(forwardIndex);
+        if (tables.testAndSetOrdered(0, built, t))
+            t = built;
+        else
+            delete built;
     }
-    return map;
+    return t;
+}
+
+// The conversions copy blocks of sixteen ASCII characters with SIMD, and
+// look the others up one by one. After a block that isn't all ASCII, they
+// look up the next 64 characters before trying again, so that text in other
+// scripts doesn't pay for a failed check on every block.
+enum { SimpleCodecScalarRun = 64 };
+
+static inline void simdAsciiToUnicode(ushort *&dst, const uchar *&src, const uchar *end)
+{
+#if defined(__SSE2__)
+    for ( ; end - src >= 16; src += 16, dst += 16) {
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        if (_mm_movemask_epi8(data))
+            return;
+        _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi8(data, _mm_setzero_si128()));
+        _mm_storeu_si128(1 + (__m128i *)dst, _mm_unpackhi_epi8(data, _mm_setzero_si128()));
+    }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64) // vmaxvq is only available on AArch64
+    for ( ; end - src >= 16; src += 16, dst += 16) {
+        const uint8x16_t data = vld1q_u8(src);
+        if (vmaxvq_u8(data) >= 0x80)
+            return;
+        vst1q_u16(dst, vmovl_u8(vget_low_u8(data)));
+        vst1q_u16(dst + 8, vmovl_u8(vget_high_u8(data)));
+    }
+#else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#endif
+}
+
+static inline void simdAsciiFromUnicode(uchar *&dst, const ushort *&src, const ushort *end)
+{
+#if defined(__SSE2__)
+    for ( ; end - src >= 16; src += 16, dst += 16) {
+        const __m128i data1 = _mm_loadu_si128((const __m128i *)src);
+        const __m128i data2 = _mm_loadu_si128(1 + (const __m128i *)src);
+        const __m128i nonAscii = _mm_and_si128(_mm_or_si128(data1, data2), _mm_set1_epi16(short(0xff80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) != 0xffff)
+            return;
+        _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(data1, data2));
+    }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+    for ( ; end - src >= 16; src += 16, dst += 16) {
+        const uint16x8_t data1 = vld1q_u16(src);
+        const uint16x8_t data2 = vld1q_u16(src + 8);
+        if (vmaxvq_u16(vorrq_u16(data1, data2)) >= 0x80)
+            return;
+        vst1q_u8(dst, vcombine_u8(vmovn_u16(data1), vmovn_u16(data2)));
+    }
+#else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#endif
 }
 
 QString QSimpleTextCodec::convertToUnicode(const char* chars, int len, ConverterState *) const
@@ -645,61 +729,82 @@ QString QSimpleTextCodec::convertToUnicode(const char* chars, int len, Converter
     if (len <= 0 || chars == 0)
         return QString();
 
-    const unsigned char * c = (const unsigned char *)chars;
-
     QString r(len, Qt::Uninitialized);
-    QChar* uc = r.data();
+    convertToUnicode(r.data(), chars, len);
+    return r;
+}
 
-    for (int i = 0; i < len; i++) {
-        if (c[i] > 127)
-            uc[i] = unicodevalues[forwardIndex].values[c[i]-128];
-        else
-            uc[i] = QLatin1Char(c[i]);
+/*
+    Converts the \a len bytes starting at \a chars to the buffer starting
+    at \a buffer, which must have room for \a len characters. Returns a
+    pointer to one past the last character written.
+*/
+QChar *QSimpleTextCodec::convertToUnicode(QChar *buffer, const char *chars, int len) const
+{
+    const ushort *table = loadTables()->toUnicode;
+    ushort *dst = reinterpret_cast<ushort *>(buffer);
+    const uchar *src = reinterpret_cast<const uchar *>(chars);
+    const uchar *const end = src + len;
+
+    while (src != end) {
+        if (*src < 0x80)
+            simdAsciiToUnicode(dst, src, end);
+
+        const uchar *runEnd = src + qMin<qptrdiff>(SimpleCodecScalarRun, end - src);
+        for ( ; src != runEnd; ++src, ++dst)
+            *dst = table[*src];
     }
-    return r;
+    return reinterpret_cast<QChar *>(dst);
 }
 
 QByteArray QSimpleTextCodec::convertFromUnicode(const QChar *in, int length, ConverterState *state) const
+{
+    QByteArray r(length, Qt::Uninitialized);
+    convertFromUnicode(r.data(), in, length, state);
+    return r;
+}
+
+/*
+    Converts the \a length characters starting at \a in to the buffer
+    starting at \a out, which must have room for \a length bytes, replacing
+    the characters this codec can't encode as set in \a state. Returns a
+    pointer to one past the last byte written.
+*/
+char *QSimpleTextCodec::convertFromUnicode(char *out, const QChar *in, int length, ConverterState *state) const
 {
     const char replacement = (state && state->flags & ConvertInvalidToNull) ? 0 : '?';
     int invalid = 0;
 
-    QByteArray *rmap = reverseMap.load();
-    if (!rmap){
-        rmap = buildReverseMap(this->forwardIndex);
-        if (!reverseMap.testAndSetRelease(0, rmap)) {
-            delete rmap;
-            rmap = reverseMap.load();
-        }
-    }
-
-    QByteArray r(length, Qt::Uninitialized);
-    int i = length;
-    int u;
-    const QChar* ucp = in;
-    unsigned char* rp = (unsigned char *)r.data();
-    const unsigned char* rmp = (const unsigned char *)rmap->constData();
-    int rmsize = (int) rmap->size();
-    while(i--)
-    {
-        u = ucp->unicode();
-        if (u < 128) {
-            *rp = (char)u;
-        } else {
-            *rp = ((u < rmsize) ? (*(rmp+u)) : 0);
-            if (*rp == 0) {
-                *rp = replacement;
-                ++invalid;
+    const QByteArray &rmap = loadTables()->fromUnicode;
+    const unsigned char *rmp = (const unsigned char *)rmap.constData();
+    const int rmsize = rmap.size();
+    uchar *rp = reinterpret_cast<uchar *>(out);
+    const ushort *ucp = reinterpret_cast<const ushort *>(in);
+    const ushort *const end = ucp + length;
+
+    while (ucp != end) {
+        if (*ucp < 0x80)
+            simdAsciiFromUnicode(rp, ucp, end);
+
+        const ushort *runEnd = ucp + qMin<qptrdiff>(SimpleCodecScalarRun, end - ucp);
+        for ( ; ucp != runEnd; ++ucp, ++rp) {
+            const int u = *ucp;
+            if (u < 128) {
+                *rp = (char)u;
+            } else {
+                *rp = ((u < rmsize) ? (*(rmp+u)) : 0);
+                if (*rp == 0) {
+                    *rp = replacement;
+                    ++invalid;
+                }
             }
         }
-        rp++;
-        ucp++;
     }
 
     if (state) {
         state->invalidChars += invalid;
     }
-    return r;
+    return reinterpret_cast<char *>(rp);
 }
 
 QByteArray QSimpleTextCodec::name() const
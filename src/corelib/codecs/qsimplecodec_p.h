@@ -70,13 +70,21 @@ public:
     QString convertToUnicode(const char *, int, ConverterState *) const override;
     QByteArray convertFromUnicode(const QChar *, int, ConverterState *) const override;
 
+    // stateless conversions into a buffer of at least as many characters as the input
+    QChar *convertToUnicode(QChar *, const char *, int) const;
+    char *convertFromUnicode(char *, const QChar *, int, ConverterState *) const;
+
     QByteArray name() const override;
     QList<QByteArray> aliases() const override;
     int mibEnum() const override;
 
+    struct Tables;
+
 private:
+    const Tables *loadTables() const;
+
     int forwardIndex;
-    mutable QAtomicPointer<QByteArray> reverseMap;
+    mutable QAtomicPointer<Tables> tables;
 };
 
 #endif // QT_NO_TEXTCODEC
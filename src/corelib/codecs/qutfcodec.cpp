@@ -232,6 +232,729 @@ static inline bool simdDecodeAscii(ushort *, const uchar *, const uchar *, const
 }
 #endif
 
+// Text that is not ASCII is converted in blocks as well, as long as it is
+// made of ASCII and two-byte sequences (Latin supplements, Greek, Cyrillic,
+// Hebrew, Arabic, ...) or of three-byte sequences only (most of CJK).
+// Anything else, including four-byte sequences and errors, goes through the
+// scalar code.
+//
+// The decoders write up to 16 characters ahead of what they consume; they
+// only run with at least 48 bytes of input left, which always decode to that
+// many characters or more, so they stay within any buffer that can hold the
+// result. The encoders write up to 24 bytes ahead, and only run with at
+// least 8 characters left, which is within the 3 bytes per character we
+// allocate.
+//
+// Validation uses the table lookup algorithm by Keiser and Lemire ("Validating
+// UTF-8 In Less Than One Instruction Per Byte", 2020): three 16-entry tables,
+// indexed by the high and low nibble of the previous byte and the high nibble
+// of the current one, classify every pair of bytes; the results are combined
+// with a check that the second and third byte after a three- or four-byte
+// lead are continuation bytes.
+enum {
+    Utf8TooShort = 1 << 0,      // lead byte or ASCII, then lead byte or ASCII
+    Utf8TooLong = 1 << 1,       // ASCII, then continuation byte
+    Utf8Overlong3 = 1 << 2,     // 11100000 100_____
+    Utf8TooLarge = 1 << 3,      // 11110100 1001____ and above
+    Utf8Surrogate = 1 << 4,     // 11101101 101_____
+    Utf8Overlong2 = 1 << 5,     // 1100000_ 10______
+    Utf8TooLarge1000 = 1 << 6,  // 11110101 1000____ and above
+    Utf8Overlong4 = 1 << 6,     // 11110000 1000____
+    Utf8TwoConts = 1 << 7,      // continuation byte, then continuation byte
+    Utf8Carry = Utf8TooShort | Utf8TooLong | Utf8TwoConts
+};
+
+#define UTF8_BYTE1_HIGH_TABLE \
+    Utf8TooLong, Utf8TooLong, Utf8TooLong, Utf8TooLong, \
+    Utf8TooLong, Utf8TooLong, Utf8TooLong, Utf8TooLong, \
+    Utf8TwoConts, Utf8TwoConts, Utf8TwoConts, Utf8TwoConts, \
+    Utf8TooShort | Utf8Overlong2, \
+    Utf8TooShort, \
+    Utf8TooShort | Utf8Overlong3 | Utf8Surrogate, \
+    Utf8TooShort | Utf8TooLarge | Utf8TooLarge1000 | Utf8Overlong4
+#define UTF8_BYTE1_LOW_TABLE \
+    Utf8Carry | Utf8Overlong3 | Utf8Overlong2 | Utf8Overlong4, \
+    Utf8Carry | Utf8Overlong2, \
+    Utf8Carry, \
+    Utf8Carry, \
+    Utf8Carry | Utf8TooLarge, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000 | Utf8Surrogate, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000, \
+    Utf8Carry | Utf8TooLarge | Utf8TooLarge1000
+#define UTF8_BYTE2_HIGH_TABLE \
+    Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort, \
+    Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort, \
+    Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Overlong3 | Utf8TooLarge1000 | Utf8Overlong4, \
+    Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Overlong3 | Utf8TooLarge, \
+    Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Surrogate | Utf8TooLarge, \
+    Utf8TooLong | Utf8Overlong2 | Utf8TwoConts | Utf8Surrogate | Utf8TooLarge, \
+    Utf8TooShort, Utf8TooShort, Utf8TooShort, Utf8TooShort
+
+// Returns where the scalar code must continue validating after the blocks
+// ending at \a p: at the start of the last sequence, which may continue
+// past \a p.
+static inline const uchar *utf8ResumePosition(const uchar *begin, const uchar *p)
+{
+    const uchar *q = p;
+    while (q > begin && p - q < 3 && (q[-1] & 0xc0) == 0x80)
+        --q;
+    if (q > begin && q[-1] >= 0xc0)
+        --q;
+    return q;
+}
+
+
+#if QT_COMPILER_SUPPORTS_HERE(SSSE3) || (defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64))
+// The position of the n-th bit set in the low \a bits of \a m, or -1.
+static Q_DECL_CONSTEXPR int nthSetBit(uint m, int n, int bits, int i = 0)
+{
+    return i == bits ? -1
+                     : !(m & (1U << i)) ? nthSetBit(m, n, bits, i + 1)
+                                        : n ? nthSetBit(m, n - 1, bits, i + 1) : i;
+}
+
+// Spreads the bits of \a m to the odd bits of a 16-bit mask whose even bits are all set.
+static Q_DECL_CONSTEXPR uint interleaveWithOnes(uint m, int i = 0)
+{
+    return i == 8 ? 0 : (1U << (2 * i)) | ((m >> i & 1) << (2 * i + 1)) | interleaveWithOnes(m, i + 1);
+}
+
+// Byte shuffles that pack the 16-bit lanes selected by the index to the front.
+static Q_DECL_CONSTEXPR uchar packLanesIndex(uint m, int j)
+{
+    return nthSetBit(m, j / 2, 8) < 0 ? 0x80 : uchar(2 * nthSetBit(m, j / 2, 8) + (j & 1));
+}
+
+// Byte shuffles that keep the low byte of every 16-bit lane, and the high byte
+// of the lanes selected by the index.
+static Q_DECL_CONSTEXPR uchar packTwoByteIndex(uint m, int j)
+{
+    return nthSetBit(interleaveWithOnes(m), j, 16) < 0 ? 0x80 : uchar(nthSetBit(interleaveWithOnes(m), j, 16));
+}
+
+#define UTF8_SHUFFLE_ROW(f, m) \
+    { f(m, 0), f(m, 1), f(m, 2), f(m, 3), f(m, 4), f(m, 5), f(m, 6), f(m, 7), \
+      f(m, 8), f(m, 9), f(m, 10), f(m, 11), f(m, 12), f(m, 13), f(m, 14), f(m, 15) }
+#define UTF8_SHUFFLE_ROWS4(f, m) \
+    UTF8_SHUFFLE_ROW(f, m), UTF8_SHUFFLE_ROW(f, m + 1), UTF8_SHUFFLE_ROW(f, m + 2), UTF8_SHUFFLE_ROW(f, m + 3)
+#define UTF8_SHUFFLE_ROWS16(f, m) \
+    UTF8_SHUFFLE_ROWS4(f, m), UTF8_SHUFFLE_ROWS4(f, m + 4), UTF8_SHUFFLE_ROWS4(f, m + 8), UTF8_SHUFFLE_ROWS4(f, m + 12)
+#define UTF8_SHUFFLE_ROWS64(f, m) \
+    UTF8_SHUFFLE_ROWS16(f, m), UTF8_SHUFFLE_ROWS16(f, m + 16), UTF8_SHUFFLE_ROWS16(f, m + 32), UTF8_SHUFFLE_ROWS16(f, m + 48)
+
+Q_DECL_ALIGN(16) static const uchar utf8PackLanes[256][16] = {
+    UTF8_SHUFFLE_ROWS64(packLanesIndex, 0), UTF8_SHUFFLE_ROWS64(packLanesIndex, 64),
+    UTF8_SHUFFLE_ROWS64(packLanesIndex, 128), UTF8_SHUFFLE_ROWS64(packLanesIndex, 192)
+};
+Q_DECL_ALIGN(16) static const uchar utf8PackTwoByte[256][16] = {
+    UTF8_SHUFFLE_ROWS64(packTwoByteIndex, 0), UTF8_SHUFFLE_ROWS64(packTwoByteIndex, 64),
+    UTF8_SHUFFLE_ROWS64(packTwoByteIndex, 128), UTF8_SHUFFLE_ROWS64(packTwoByteIndex, 192)
+};
+
+#undef UTF8_SHUFFLE_ROW
+#undef UTF8_SHUFFLE_ROWS4
+#undef UTF8_SHUFFLE_ROWS16
+#undef UTF8_SHUFFLE_ROWS64
+
+// Given masks of the ASCII, continuation and two-byte lead bytes among the
+// 16 bytes of a block, returns how many of them can be decoded as ASCII and
+// two-byte sequences, without cutting a sequence in two. Sets \a complete to
+// whether the rest of the block may be too.
+static inline uint utf8UpToTwoBytesLength(uint ascii, uint cont, uint lead, bool *complete)
+{
+    // a continuation byte must follow a lead byte, and only there; bit 16
+    // stands for the first byte of the next block
+    const uint bad = (~(ascii | cont | lead) & 0xffff) | (cont ^ (lead << 1));
+    *complete = !(bad & 0xffff);
+    if (!bad)
+        return 16;
+    const uint e = qCountTrailingZeroBits(bad);
+    return e ? e - ((lead >> (e - 1)) & 1) : 0;
+}
+#endif
+
+#if defined(__SSE2__) && defined(QT_COMPILER_SUPPORTS_SSE2)
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdDecodeUpToTwoBytesSsse3(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    const uchar *const begin = src;
+    for ( ; end - src >= 48; ) {
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        const uint ascii = _mm_movemask_epi8(_mm_cmpgt_epi8(data, _mm_set1_epi8(-1)));
+        const uint cont = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xc0))),
+                                                           _mm_set1_epi8(char(0x80))));
+        const uint lead = _mm_movemask_epi8(_mm_andnot_si128(
+                    _mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(0x1e)), _mm_setzero_si128()),
+                    _mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xe0))), _mm_set1_epi8(char(0xc0)))));
+        bool complete;
+        const uint length = utf8UpToTwoBytesLength(ascii, cont, lead, &complete);
+        if (!length)
+            break;
+
+        // decode a character at every byte, each byte paired with the next one
+        // in a 16-bit lane, then keep those that start a character
+        const __m128i next = _mm_srli_si128(data, 1);
+        const __m128i low = _mm_unpacklo_epi8(data, next);
+        const __m128i high = _mm_unpackhi_epi8(data, next);
+        const __m128i lowAscii = _mm_cmpeq_epi16(_mm_and_si128(low, _mm_set1_epi16(0x80)), _mm_setzero_si128());
+        const __m128i highAscii = _mm_cmpeq_epi16(_mm_and_si128(high, _mm_set1_epi16(0x80)), _mm_setzero_si128());
+        const __m128i lowDecoded = _mm_or_si128(
+                    _mm_and_si128(lowAscii, _mm_and_si128(low, _mm_set1_epi16(0x7f))),
+                    _mm_andnot_si128(lowAscii, _mm_or_si128(_mm_slli_epi16(_mm_and_si128(low, _mm_set1_epi16(0x1f)), 6),
+                                                            _mm_and_si128(_mm_srli_epi16(low, 8), _mm_set1_epi16(0x3f)))));
+        const __m128i highDecoded = _mm_or_si128(
+                    _mm_and_si128(highAscii, _mm_and_si128(high, _mm_set1_epi16(0x7f))),
+                    _mm_andnot_si128(highAscii, _mm_or_si128(_mm_slli_epi16(_mm_and_si128(high, _mm_set1_epi16(0x1f)), 6),
+                                                             _mm_and_si128(_mm_srli_epi16(high, 8), _mm_set1_epi16(0x3f)))));
+
+        // count the characters in each half with PSADBW, which is cheaper
+        // than a POPCNT we can't count on
+        const __m128i startsInLength = _mm_andnot_si128(
+                    _mm_cmpeq_epi8(_mm_and_si128(data, _mm_set1_epi8(char(0xc0))), _mm_set1_epi8(char(0x80))),
+                    _mm_cmpgt_epi8(_mm_set1_epi8(char(length)), _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+        const uint starts = _mm_movemask_epi8(startsInLength);
+        const __m128i counts = _mm_sad_epu8(_mm_and_si128(startsInLength, _mm_set1_epi8(1)), _mm_setzero_si128());
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(lowDecoded, _mm_load_si128((const __m128i *)utf8PackLanes[starts & 0xff])));
+        dst += _mm_cvtsi128_si32(counts);
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(highDecoded, _mm_load_si128((const __m128i *)utf8PackLanes[starts >> 8])));
+        dst += _mm_extract_epi16(counts, 4);
+        src += length;
+        if (!complete)
+            break;
+    }
+    return src != begin;
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdEncodeUpToTwoBytesSsse3(uchar *&dst, const ushort *&src, const ushort *end)
+{
+    const ushort *const begin = src;
+    for ( ; end - src >= 8; ) {
+        // U+0000 to U+07FF: ASCII stays in the low byte of its 16-bit lane,
+        // the rest becomes a lead byte 110xxxxx and a continuation byte, which
+        // fill the lane
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(data, _mm_set1_epi16(short(0xff80))), _mm_setzero_si128());
+        const __m128i inRange = _mm_cmpeq_epi16(_mm_and_si128(data, _mm_set1_epi16(short(0xf800))), _mm_setzero_si128());
+        const __m128i twoByte = _mm_or_si128(_mm_or_si128(_mm_srli_epi16(data, 6), _mm_set1_epi16(0xc0)),
+                                             _mm_or_si128(_mm_slli_epi16(_mm_and_si128(data, _mm_set1_epi16(0x3f)), 8),
+                                                          _mm_set1_epi16(short(0x8000))));
+        const __m128i encoded = _mm_or_si128(_mm_and_si128(ascii, data), _mm_andnot_si128(ascii, twoByte));
+
+        const __m128i asciiBytes = _mm_packs_epi16(ascii, ascii);
+        const uint nonAscii = ~_mm_movemask_epi8(asciiBytes) & 0xff;
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(encoded, _mm_load_si128((const __m128i *)utf8PackTwoByte[nonAscii])));
+
+        uint n = ~_mm_movemask_epi8(_mm_packs_epi16(inRange, inRange)) & 0xff;
+        if (n) {
+            // the output for the characters before the first that is out of
+            // range is correct
+            n = qCountTrailingZeroBits(n);
+            src += n;
+            dst += n + qPopulationCount(nonAscii & ((1U << n) - 1));
+            break;
+        }
+        src += 8;
+        dst += 16 - _mm_cvtsi128_si32(_mm_sad_epu8(_mm_and_si128(asciiBytes, _mm_set1_epi8(1)), _mm_setzero_si128()));
+    }
+    return src != begin;
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdDecodeThreeByteSsse3(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    // gather the first two bytes of five sequences into one vector and the
+    // third into another, one sequence per 16-bit lane
+    const __m128i leadShuffle = _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i lastShuffle = _mm_setr_epi8(2, -1, 5, -1, 8, -1, 11, -1, 14, -1, -1, -1, -1, -1, -1, -1);
+
+    const uchar *const begin = src;
+    for ( ; end - src >= 48; src += 15, dst += 5) {
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        const __m128i lead = _mm_shuffle_epi8(data, leadShuffle);
+        const __m128i last = _mm_shuffle_epi8(data, lastShuffle);
+        const __m128i wellFormed = _mm_and_si128(
+                    _mm_cmpeq_epi16(_mm_and_si128(lead, _mm_set1_epi16(short(0xc0f0))), _mm_set1_epi16(short(0x80e0))),
+                    _mm_cmpeq_epi16(_mm_and_si128(last, _mm_set1_epi16(0xc0)), _mm_set1_epi16(0x80)));
+        const __m128i decoded = _mm_or_si128(
+                    _mm_or_si128(_mm_slli_epi16(lead, 12),
+                                 _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(lead, 8), _mm_set1_epi16(0x3f)), 6)),
+                    _mm_and_si128(last, _mm_set1_epi16(0x3f)));
+
+        // reject overlong forms (below U+0800) and surrogates
+        const __m128i top = _mm_and_si128(decoded, _mm_set1_epi16(short(0xf800)));
+        const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(top, _mm_setzero_si128()),
+                                             _mm_cmpeq_epi16(top, _mm_set1_epi16(short(0xd800))));
+        _mm_storeu_si128((__m128i *)dst, decoded);
+
+        uint n = ~_mm_movemask_epi8(_mm_andnot_si128(invalid, wellFormed)) & 0x3ff;
+        if (n) {
+            n = qCountTrailingZeroBits(n) / 2;
+            src += 3 * n;
+            dst += n;
+            break;
+        }
+    }
+    return src != begin;
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdEncodeThreeByteSsse3(uchar *&dst, const ushort *&src, const ushort *end)
+{
+    // interleave the first two bytes of each sequence, from one vector, with
+    // the third, from another, into 24 bytes
+    const __m128i leadShuffle1 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i lastShuffle1 = _mm_setr_epi8(-1, -1, 0, -1, -1, 2, -1, -1, 4, -1, -1, 6, -1, -1, 8, -1);
+    const __m128i leadShuffle2 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i lastShuffle2 = _mm_setr_epi8(-1, 10, -1, -1, 12, -1, -1, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    const ushort *const begin = src;
+    for ( ; end - src >= 8; src += 8, dst += 24) {
+        // U+0800 to U+FFFF, except for surrogates
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        const __m128i top = _mm_and_si128(data, _mm_set1_epi16(short(0xf800)));
+        const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(top, _mm_setzero_si128()),
+                                             _mm_cmpeq_epi16(top, _mm_set1_epi16(short(0xd800))));
+
+        const __m128i lead = _mm_or_si128(
+                    _mm_or_si128(_mm_srli_epi16(data, 12), _mm_set1_epi16(0xe0)),
+                    _mm_or_si128(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(data, 6), _mm_set1_epi16(0x3f)), 8),
+                                 _mm_set1_epi16(short(0x8000))));
+        const __m128i last = _mm_or_si128(_mm_and_si128(data, _mm_set1_epi16(0x3f)), _mm_set1_epi16(0x80));
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_shuffle_epi8(lead, leadShuffle1),
+                                                      _mm_shuffle_epi8(last, lastShuffle1)));
+        _mm_storel_epi64((__m128i *)(dst + 16), _mm_or_si128(_mm_shuffle_epi8(lead, leadShuffle2),
+                                                             _mm_shuffle_epi8(last, lastShuffle2)));
+
+        uint n = _mm_movemask_epi8(invalid);
+        if (n) {
+            n = qCountTrailingZeroBits(n) / 2;
+            src += n;
+            dst += 3 * n;
+            break;
+        }
+    }
+    return src != begin;
+}
+
+QT_FUNCTION_TARGET(SSSE3)
+static bool simdValidateUtf8Ssse3(const uchar *&src, const uchar *end)
+{
+    const __m128i byte1HighTable = _mm_setr_epi8(UTF8_BYTE1_HIGH_TABLE);
+    const __m128i byte1LowTable = _mm_setr_epi8(UTF8_BYTE1_LOW_TABLE);
+    const __m128i byte2HighTable = _mm_setr_epi8(UTF8_BYTE2_HIGH_TABLE);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+    // non-zero where the last bytes start a sequence that continues in the next block
+    const __m128i incompleteMax = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, char(0xef), char(0xdf), char(0xbf));
+
+    const uchar *const begin = src;
+    __m128i previous = _mm_setzero_si128();
+    __m128i previousIncomplete = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+    for ( ; end - src >= 16; src += 16) {
+        const __m128i data = _mm_loadu_si128((const __m128i *)src);
+        if (!_mm_movemask_epi8(data)) {
+            // ASCII only: fine, unless the previous block ended in the middle of a sequence
+            error = _mm_or_si128(error, previousIncomplete);
+            previousIncomplete = _mm_setzero_si128();
+            previous = data;
+            continue;
+        }
+
+        const __m128i prev1 = _mm_alignr_epi8(data, previous, 15);
+        const __m128i byte1High = _mm_shuffle_epi8(byte1HighTable, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibbleMask));
+        const __m128i byte1Low = _mm_shuffle_epi8(byte1LowTable, _mm_and_si128(prev1, nibbleMask));
+        const __m128i byte2High = _mm_shuffle_epi8(byte2HighTable, _mm_and_si128(_mm_srli_epi16(data, 4), nibbleMask));
+        const __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+        const __m128i prev2 = _mm_alignr_epi8(data, previous, 14);
+        const __m128i prev3 = _mm_alignr_epi8(data, previous, 13);
+        const __m128i mustBeContinuation = _mm_and_si128(
+                    _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80)),
+                                 _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0 - 0x80))),
+                    _mm_set1_epi8(char(0x80)));
+        error = _mm_or_si128(error, _mm_xor_si128(mustBeContinuation, special));
+
+        previousIncomplete = _mm_subs_epu8(data, incompleteMax);
+        previous = data;
+    }
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xffff)
+        return false;
+    src = utf8ResumePosition(begin, src);
+    return true;
+}
+#  endif // SSSE3
+
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static bool simdValidateUtf8Avx2(const uchar *&src, const uchar *end)
+{
+    const __m256i byte1HighTable = _mm256_setr_epi8(UTF8_BYTE1_HIGH_TABLE, UTF8_BYTE1_HIGH_TABLE);
+    const __m256i byte1LowTable = _mm256_setr_epi8(UTF8_BYTE1_LOW_TABLE, UTF8_BYTE1_LOW_TABLE);
+    const __m256i byte2HighTable = _mm256_setr_epi8(UTF8_BYTE2_HIGH_TABLE, UTF8_BYTE2_HIGH_TABLE);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+    const __m256i incompleteMax = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+                                                   -1, -1, -1, -1, -1, -1, -1, -1,
+                                                   -1, -1, -1, -1, -1, -1, -1, -1,
+                                                   -1, -1, -1, -1, -1, char(0xef), char(0xdf), char(0xbf));
+
+    const uchar *const begin = src;
+    __m256i previous = _mm256_setzero_si256();
+    __m256i previousIncomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    for ( ; end - src >= 32; src += 32) {
+        const __m256i data = _mm256_loadu_si256((const __m256i *)src);
+        if (!_mm256_movemask_epi8(data)) {
+            error = _mm256_or_si256(error, previousIncomplete);
+            previousIncomplete = _mm256_setzero_si256();
+            previous = data;
+            continue;
+        }
+
+        // the byte shifts work within 128-bit lanes: bring in the end of the
+        // previous block for the low lane and of the low lane for the high one
+        const __m256i carried = _mm256_permute2x128_si256(previous, data, 0x21);
+        const __m256i prev1 = _mm256_alignr_epi8(data, carried, 15);
+        const __m256i byte1High = _mm256_shuffle_epi8(byte1HighTable, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbleMask));
+        const __m256i byte1Low = _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(prev1, nibbleMask));
+        const __m256i byte2High = _mm256_shuffle_epi8(byte2HighTable, _mm256_and_si256(_mm256_srli_epi16(data, 4), nibbleMask));
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(byte1High, byte1Low), byte2High);
+
+        const __m256i prev2 = _mm256_alignr_epi8(data, carried, 14);
+        const __m256i prev3 = _mm256_alignr_epi8(data, carried, 13);
+        const __m256i mustBeContinuation = _mm256_and_si256(
+                    _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80)),
+                                    _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80))),
+                    _mm256_set1_epi8(char(0x80)));
+        error = _mm256_or_si256(error, _mm256_xor_si256(mustBeContinuation, special));
+
+        previousIncomplete = _mm256_subs_epu8(data, incompleteMax);
+        previous = data;
+    }
+
+    if (!_mm256_testz_si256(error, error))
+        return false;
+    src = utf8ResumePosition(begin, src);
+    return true;
+}
+#  endif // AVX2
+
+static inline bool simdDecodeUpToTwoBytes(ushort *&dst, const uchar *&src, const uchar *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdDecodeUpToTwoBytesSsse3(dst, src, end);
+#  else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#  endif
+    return false;
+}
+
+static inline bool simdEncodeUpToTwoBytes(uchar *&dst, const ushort *&src, const ushort *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdEncodeUpToTwoBytesSsse3(dst, src, end);
+#  else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#  endif
+    return false;
+}
+
+static inline bool simdDecodeThreeByte(ushort *&dst, const uchar *&src, const uchar *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdDecodeThreeByteSsse3(dst, src, end);
+#  else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#  endif
+    return false;
+}
+
+static inline bool simdEncodeThreeByte(uchar *&dst, const ushort *&src, const ushort *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdEncodeThreeByteSsse3(dst, src, end);
+#  else
+    Q_UNUSED(dst);
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+#  endif
+    return false;
+}
+
+static inline bool simdValidateUtf8(const uchar *&src, const uchar *end)
+{
+#  if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2))
+        return simdValidateUtf8Avx2(src, end);
+#  endif
+#  if QT_COMPILER_SUPPORTS_HERE(SSSE3)
+    if (qCpuHasFeature(SSSE3))
+        return simdValidateUtf8Ssse3(src, end);
+#  endif
+    Q_UNUSED(src);
+    Q_UNUSED(end);
+    return true;
+}
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+// the equivalent of _mm_movemask_epi8() for vectors of 0x00 and 0xff bytes
+static inline uint neonMovemask(uint8x16_t v)
+{
+    const uint8x16_t bits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7,
+                              1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+    const uint8x16_t masked = vandq_u8(v, bits);
+    return vaddv_u8(vget_low_u8(masked)) | (uint(vaddv_u8(vget_high_u8(masked))) << 8);
+}
+
+static inline bool simdDecodeUpToTwoBytes(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    // see the SSSE3 version
+    const uchar *const begin = src;
+    for ( ; end - src >= 48; ) {
+        const uint8x16_t data = vld1q_u8(src);
+        const uint ascii = neonMovemask(vcltq_u8(data, vdupq_n_u8(0x80)));
+        const uint cont = neonMovemask(vceqq_u8(vandq_u8(data, vdupq_n_u8(0xc0)), vdupq_n_u8(0x80)));
+        const uint lead = neonMovemask(vbicq_u8(vceqq_u8(vandq_u8(data, vdupq_n_u8(0xe0)), vdupq_n_u8(0xc0)),
+                                                vceqq_u8(vandq_u8(data, vdupq_n_u8(0x1e)), vdupq_n_u8(0))));
+        bool complete;
+        const uint length = utf8UpToTwoBytesLength(ascii, cont, lead, &complete);
+        if (!length)
+            break;
+
+        const uint8x16_t next = vextq_u8(data, vdupq_n_u8(0), 1);
+        const uint16x8_t low = vreinterpretq_u16_u8(vzip1q_u8(data, next));
+        const uint16x8_t high = vreinterpretq_u16_u8(vzip2q_u8(data, next));
+        const uint16x8_t lowAscii = vceqq_u16(vandq_u16(low, vdupq_n_u16(0x80)), vdupq_n_u16(0));
+        const uint16x8_t highAscii = vceqq_u16(vandq_u16(high, vdupq_n_u16(0x80)), vdupq_n_u16(0));
+        const uint16x8_t lowDecoded = vbslq_u16(lowAscii, vandq_u16(low, vdupq_n_u16(0x7f)),
+                                                vorrq_u16(vshlq_n_u16(vandq_u16(low, vdupq_n_u16(0x1f)), 6),
+                                                          vandq_u16(vshrq_n_u16(low, 8), vdupq_n_u16(0x3f))));
+        const uint16x8_t highDecoded = vbslq_u16(highAscii, vandq_u16(high, vdupq_n_u16(0x7f)),
+                                                 vorrq_u16(vshlq_n_u16(vandq_u16(high, vdupq_n_u16(0x1f)), 6),
+                                                           vandq_u16(vshrq_n_u16(high, 8), vdupq_n_u16(0x3f))));
+
+        const uint starts = (ascii | lead) & ((1U << length) - 1);
+        vst1q_u8(reinterpret_cast<uchar *>(dst),
+                 vqtbl1q_u8(vreinterpretq_u8_u16(lowDecoded), vld1q_u8(utf8PackLanes[starts & 0xff])));
+        dst += qPopulationCount(starts & 0xff);
+        vst1q_u8(reinterpret_cast<uchar *>(dst),
+                 vqtbl1q_u8(vreinterpretq_u8_u16(highDecoded), vld1q_u8(utf8PackLanes[starts >> 8])));
+        dst += qPopulationCount(starts >> 8);
+        src += length;
+        if (!complete)
+            break;
+    }
+    return src != begin;
+}
+
+static inline bool simdEncodeUpToTwoBytes(uchar *&dst, const ushort *&src, const ushort *end)
+{
+    // see the SSSE3 version
+    const uint16x8_t laneBits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+    const ushort *const begin = src;
+    for ( ; end - src >= 8; ) {
+        const uint16x8_t data = vld1q_u16(src);
+        const uint16x8_t ascii = vceqq_u16(vandq_u16(data, vdupq_n_u16(0xff80)), vdupq_n_u16(0));
+        const uint16x8_t inRange = vceqq_u16(vandq_u16(data, vdupq_n_u16(0xf800)), vdupq_n_u16(0));
+        const uint16x8_t twoByte = vorrq_u16(vorrq_u16(vshrq_n_u16(data, 6), vdupq_n_u16(0xc0)),
+                                             vorrq_u16(vshlq_n_u16(vandq_u16(data, vdupq_n_u16(0x3f)), 8),
+                                                       vdupq_n_u16(0x8000)));
+        const uint16x8_t encoded = vbslq_u16(ascii, data, twoByte);
+
+        const uint nonAscii = vaddvq_u16(vandq_u16(ascii, laneBits)) ^ 0xff;
+        vst1q_u8(dst, vqtbl1q_u8(vreinterpretq_u8_u16(encoded), vld1q_u8(utf8PackTwoByte[nonAscii])));
+
+        uint n = vaddvq_u16(vandq_u16(inRange, laneBits)) ^ 0xff;
+        if (n) {
+            n = qCountTrailingZeroBits(n);
+            src += n;
+            dst += n + qPopulationCount(nonAscii & ((1U << n) - 1));
+            break;
+        }
+        src += 8;
+        dst += 8 + qPopulationCount(nonAscii);
+    }
+    return src != begin;
+}
+
+static inline bool simdDecodeThreeByte(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    // see the SSSE3 version; TBL, like PSHUFB, yields zero for out of range indices
+    const uint8x16_t leadShuffle = { 0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    const uint8x16_t lastShuffle = { 2, 0xff, 5, 0xff, 8, 0xff, 11, 0xff, 14, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    const uint16x8_t laneBits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 0, 0, 0 };
+
+    const uchar *const begin = src;
+    for ( ; end - src >= 48; src += 15, dst += 5) {
+        const uint8x16_t data = vld1q_u8(src);
+        const uint16x8_t lead = vreinterpretq_u16_u8(vqtbl1q_u8(data, leadShuffle));
+        const uint16x8_t last = vreinterpretq_u16_u8(vqtbl1q_u8(data, lastShuffle));
+        const uint16x8_t wellFormed = vandq_u16(vceqq_u16(vandq_u16(lead, vdupq_n_u16(0xc0f0)), vdupq_n_u16(0x80e0)),
+                                                vceqq_u16(vandq_u16(last, vdupq_n_u16(0xc0)), vdupq_n_u16(0x80)));
+        const uint16x8_t decoded = vorrq_u16(vorrq_u16(vshlq_n_u16(lead, 12),
+                                                       vshlq_n_u16(vandq_u16(vshrq_n_u16(lead, 8), vdupq_n_u16(0x3f)), 6)),
+                                             vandq_u16(last, vdupq_n_u16(0x3f)));
+        const uint16x8_t top = vandq_u16(decoded, vdupq_n_u16(0xf800));
+        const uint16x8_t invalid = vorrq_u16(vceqq_u16(top, vdupq_n_u16(0)), vceqq_u16(top, vdupq_n_u16(0xd800)));
+        vst1q_u16(dst, decoded);
+
+        uint n = vaddvq_u16(vandq_u16(vbicq_u16(wellFormed, invalid), laneBits)) ^ 0x1f;
+        if (n) {
+            n = qCountTrailingZeroBits(n);
+            src += 3 * n;
+            dst += n;
+            break;
+        }
+    }
+    return src != begin;
+}
+
+static inline bool simdEncodeThreeByte(uchar *&dst, const ushort *&src, const ushort *end)
+{
+    const uint8x16_t leadShuffle1 = { 0, 1, 0xff, 2, 3, 0xff, 4, 5, 0xff, 6, 7, 0xff, 8, 9, 0xff, 10 };
+    const uint8x16_t lastShuffle1 = { 0xff, 0xff, 0, 0xff, 0xff, 2, 0xff, 0xff, 4, 0xff, 0xff, 6, 0xff, 0xff, 8, 0xff };
+    const uint8x8_t leadShuffle2 = { 11, 0xff, 12, 13, 0xff, 14, 15, 0xff };
+    const uint8x8_t lastShuffle2 = { 0xff, 10, 0xff, 0xff, 12, 0xff, 0xff, 14 };
+    const uint16x8_t laneBits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+
+    const ushort *const begin = src;
+    for ( ; end - src >= 8; src += 8, dst += 24) {
+        const uint16x8_t data = vld1q_u16(src);
+        const uint16x8_t top = vandq_u16(data, vdupq_n_u16(0xf800));
+        const uint16x8_t invalid = vorrq_u16(vceqq_u16(top, vdupq_n_u16(0)), vceqq_u16(top, vdupq_n_u16(0xd800)));
+
+        const uint8x16_t lead = vreinterpretq_u8_u16(vorrq_u16(
+                    vorrq_u16(vshrq_n_u16(data, 12), vdupq_n_u16(0xe0)),
+                    vorrq_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(data, 6), vdupq_n_u16(0x3f)), 8), vdupq_n_u16(0x8000))));
+        const uint8x16_t last = vreinterpretq_u8_u16(vorrq_u16(vandq_u16(data, vdupq_n_u16(0x3f)), vdupq_n_u16(0x80)));
+        vst1q_u8(dst, vorrq_u8(vqtbl1q_u8(lead, leadShuffle1), vqtbl1q_u8(last, lastShuffle1)));
+        vst1_u8(dst + 16, vorr_u8(vqtbl1_u8(lead, leadShuffle2), vqtbl1_u8(last, lastShuffle2)));
+
+        uint n = vaddvq_u16(vandq_u16(invalid, laneBits));
+        if (n) {
+            n = qCountTrailingZeroBits(n);
+            src += n;
+            dst += 3 * n;
+            break;
+        }
+    }
+    return src != begin;
+}
+
+static inline bool simdValidateUtf8(const uchar *&src, const uchar *end)
+{
+    // see the SSSE3 version
+    const uint8x16_t byte1HighTable = { UTF8_BYTE1_HIGH_TABLE };
+    const uint8x16_t byte1LowTable = { UTF8_BYTE1_LOW_TABLE };
+    const uint8x16_t byte2HighTable = { UTF8_BYTE2_HIGH_TABLE };
+    const uint8x16_t nibbleMask = vdupq_n_u8(0x0f);
+    const uint8x16_t incompleteMax = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                                       0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf };
+
+    const uchar *const begin = src;
+    uint8x16_t previous = vdupq_n_u8(0);
+    uint8x16_t previousIncomplete = vdupq_n_u8(0);
+    uint8x16_t error = vdupq_n_u8(0);
+    for ( ; end - src >= 16; src += 16) {
+        const uint8x16_t data = vld1q_u8(src);
+        if (vmaxvq_u8(data) < 0x80) {
+            error = vorrq_u8(error, previousIncomplete);
+            previousIncomplete = vdupq_n_u8(0);
+            previous = data;
+            continue;
+        }
+
+        const uint8x16_t prev1 = vextq_u8(previous, data, 15);
+        const uint8x16_t byte1High = vqtbl1q_u8(byte1HighTable, vshrq_n_u8(prev1, 4));
+        const uint8x16_t byte1Low = vqtbl1q_u8(byte1LowTable, vandq_u8(prev1, nibbleMask));
+        const uint8x16_t byte2High = vqtbl1q_u8(byte2HighTable, vshrq_n_u8(data, 4));
+        const uint8x16_t special = vandq_u8(vandq_u8(byte1High, byte1Low), byte2High);
+
+        const uint8x16_t prev2 = vextq_u8(previous, data, 14);
+        const uint8x16_t prev3 = vextq_u8(previous, data, 13);
+        const uint8x16_t mustBeContinuation = vandq_u8(vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80)),
+                                                                vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80))),
+                                                       vdupq_n_u8(0x80));
+        error = vorrq_u8(error, veorq_u8(mustBeContinuation, special));
+
+        previousIncomplete = vqsubq_u8(data, incompleteMax);
+        previous = data;
+    }
+
+    if (vmaxvq_u8(error))
+        return false;
+    src = utf8ResumePosition(begin, src);
+    return true;
+}
+#else
+static inline bool simdDecodeUpToTwoBytes(ushort *&, const uchar *&, const uchar *)
+{
+    return false;
+}
+
+static inline bool simdEncodeUpToTwoBytes(uchar *&, const ushort *&, const ushort *)
+{
+    return false;
+}
+
+static inline bool simdDecodeThreeByte(ushort *&, const uchar *&, const uchar *)
+{
+    return false;
+}
+
+static inline bool simdEncodeThreeByte(uchar *&, const ushort *&, const ushort *)
+{
+    return false;
+}
+
+static inline bool simdValidateUtf8(const uchar *&, const uchar *)
+{
+    return true;
+}
+#endif
+
+#undef UTF8_BYTE1_HIGH_TABLE
+#undef UTF8_BYTE1_LOW_TABLE
+#undef UTF8_BYTE2_HIGH_TABLE
+
+// Converts the run of non-ASCII text starting at \a src, if any.
+// Returns true if it advanced.
+static inline bool simdDecodeNonAscii(ushort *&dst, const uchar *&src, const uchar *end)
+{
+    if ((*src & 0xe0) == 0xc0)
+        return simdDecodeUpToTwoBytes(dst, src, end);
+    if ((*src & 0xf0) == 0xe0)
+        return simdDecodeThreeByte(dst, src, end);
+    return false;
+}
+
+static inline bool simdEncodeNonAscii(uchar *&dst, const ushort *&src, const ushort *end)
+{
+    if (*src < 0x800)
+        return simdEncodeUpToTwoBytes(dst, src, end);
+    return simdEncodeThreeByte(dst, src, end);
+}
+
 QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len)
 {
     // create a QByteArray with the worst case scenario size
@@ -244,6 +967,8 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len)
         const ushort *nextAscii = end;
         if (simdEncodeAscii(dst, nextAscii, src, end))
             break;
+        if (simdEncodeNonAscii(dst, src, end))
+            continue;
 
         do {
             ushort uc = *src++;
@@ -296,8 +1021,12 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len, QTextCodec::Conve
             surrogate_high = -1;
             res = QUtf8Functions::toUtf8<QUtf8BaseTraits>(uc, cursor, src, end);
         } else {
-            if (src >= nextAscii && simdEncodeAscii(cursor, nextAscii, src, end))
-                break;
+            if (src >= nextAscii) {
+                if (simdEncodeAscii(cursor, nextAscii, src, end))
+                    break;
+                if (simdEncodeNonAscii(cursor, src, end))
+                    continue;
+            }
 
             uc = *src++;
             res = QUtf8Functions::toUtf8<QUtf8BaseTraits>(uc, cursor, src, end);
@@ -387,6 +1116,8 @@ QChar *QUtf8::convertToUnicode(QChar *buffer, const char *chars, int len) Q_DECL
             nextAscii = end;
             if (simdDecodeAscii(dst, nextAscii, src, end))
                 break;
+            if (simdDecodeNonAscii(dst, src, end))
+                continue;
 
             do {
                 uchar b = *src++;
@@ -402,7 +1133,53 @@ QChar *QUtf8::convertToUnicode(QChar *buffer, const char *chars, int len) Q_DECL
     return reinterpret_cast<QChar *>(dst);
 }
 
+/*
+    Returns \c true if the \a len bytes starting at \a chars are well-formed
+    UTF-8, that is, if convertToUnicode() would decode them without inserting
+    any replacement character. Like the decoder, this accepts non-characters
+    and a BOM, but not surrogates, overlong forms or code points beyond
+    U+10FFFF.
+*/
+bool QUtf8::isValidUtf8(const char *chars, int len) Q_DECL_NOTHROW
+{
+    const uchar *src = reinterpret_cast<const uchar *>(chars);
+    const uchar *const end = src + len;
+
+    // checks whole blocks, leaving src at the first sequence it did not
+    // check completely
+    if (!simdValidateUtf8(src, end))
+        return false;
+
+    while (src < end) {
+        const uchar b = *src++;
+        if (b < 0x80)
+            continue;
+        ushort buffer[2];
+        ushort *dst = buffer;
+        if (QUtf8Functions::fromUtf8<QUtf8BaseTraitsNoAscii>(b, dst, src, end) < 0)
+            return false;
+    }
+    return true;
+}
+
 QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::ConverterState *state)
+{
+    // See below for buffer requirements
+    QString result(len + 1, Qt::Uninitialized);
+    const QChar *end = convertToUnicode(result.data(), chars, len, state);
+    if (!end)
+        return QString();
+    result.truncate(end - result.constData());
+    return result;
+}
+
+/*
+    Converts the UTF-8 sequence of \a len bytes starting at \a chars to UTF-16,
+    continuing from and updating \a state, and writes the result to \a buffer,
+    which must have room for \a len + 1 characters. Returns one past the last
+    character written, or \c nullptr if all of the input was kept in \a state.
+*/
+QChar *QUtf8::convertToUnicode(QChar *buffer, const char *chars, int len, QTextCodec::ConverterState *state)
 {
     bool headerdone = false;
     ushort replacement = QChar::ReplacementCharacter;
@@ -420,9 +1197,7 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
     //   1 of 2 bytes       invalid continuation        +1 (need to insert replacement and restart)
     //   2 of 3 bytes       same                        +1 (same)
     //   3 of 4 bytes       same                        +1 (same)
-    QString result(len + 1, Qt::Uninitialized);
-
-    ushort *dst = reinterpret_cast<ushort *>(const_cast<QChar *>(result.constData()));
+    ushort *dst = reinterpret_cast<ushort *>(buffer);
     const uchar *src = reinterpret_cast<const uchar *>(chars);
     const uchar *end = src + len;
 
@@ -454,7 +1229,7 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
                 // copy to our state and return
                 state->remainingChars = remainingCharsCount + newCharsToCopy;
                 memcpy(&state->state_data[0], remainingCharsData, state->remainingChars);
-                return QString();
+                return nullptr;
             } else if (!headerdone && res >= 0) {
                 // eat the UTF-8 BOM
                 headerdone = true;
@@ -475,8 +1250,13 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
     const uchar *nextAscii = src;
     const uchar *start = src;
     while (res >= 0 && src < end) {
-        if (src >= nextAscii && simdDecodeAscii(dst, nextAscii, src, end))
-            break;
+        if (src >= nextAscii) {
+            if (simdDecodeAscii(dst, nextAscii, src, end))
+                break;
+            // not before the BOM has been dealt with below
+            if (headerdone && simdDecodeNonAscii(dst, src, end))
+                continue;
+        }
 
         ch = *src++;
         res = QUtf8Functions::fromUtf8<QUtf8BaseTraits>(ch, dst, src, end);
@@ -502,7 +1282,6 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
             *dst++ = QChar::ReplacementCharacter;
     }
 
-    result.truncate(dst - (const ushort *)result.unicode());
     if (state) {
         state->invalidChars += invalid;
         if (headerdone)
@@ -515,7 +1294,7 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
             state->remainingChars = 0;
         }
     }
-    return result;
+    return reinterpret_cast<QChar *>(dst);
 }
 
 QByteArray QUtf16::convertFromUnicode(const QChar *uc, int len, QTextCodec::ConverterState *state, DataEndianness e)
@@ -288,8 +288,10 @@ struct QUtf8
     static QChar *convertToUnicode(QChar *, const char *, int) Q_DECL_NOTHROW;
     static QString convertToUnicode(const char *, int);
     static QString convertToUnicode(const char *, int, QTextCodec::ConverterState *);
+    static QChar *convertToUnicode(QChar *, const char *, int, QTextCodec::ConverterState *);
     static QByteArray convertFromUnicode(const QChar *, int);
     static QByteArray convertFromUnicode(const QChar *, int, QTextCodec::ConverterState *);
+    Q_CORE_EXPORT static bool isValidUtf8(const char *, int) Q_DECL_NOTHROW;
 };
 
 struct QUtf16
@@ -45,6 +45,7 @@ include(codecs/codecs.pri)
 include(statemachine/statemachine.pri)
 include(mimetypes/mimetypes.pri)
 include(xml/xml.pri)
+include(serialization/serialization.pri)
 
 win32 {
     mingw {
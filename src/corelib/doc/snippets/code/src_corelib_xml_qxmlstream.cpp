@@ -75,3 +75,16 @@
 //! [2]
 
 
+
+
+//! [3]
+  QXmlStreamReader xml(device);
+  xml.setNameInterning(true);
+  const QChar *const item = xml.internedName(QStringLiteral("item")).unicode();
+  while (!xml.atEnd()) {
+        if (xml.readNext() == QXmlStreamReader::StartElement
+            && xml.name().unicode() == item) {
+            ... // process the item
+        }
+  }
+//! [3]
@@ -16,12 +16,17 @@ HEADERS +=  \
         global/qglobalstatic.h \
         global/qlibraryinfo.h \
         global/qlogging.h \
+        global/qlogging_p.h \
+        global/qbinarylog_p.h \
         global/qtypeinfo.h \
         global/qsysinfo.h \
         global/qisenum.h \
         global/qtypetraits.h \
         global/qflags.h \
         global/qhooks_p.h \
+        global/qtrace_p.h \
+        global/qtcore_tracepoints_p.h \
+        global/qtrace_lttng_p.h \
         global/qversiontagging.h
 
 SOURCES += \
@@ -33,7 +38,9 @@ SOURCES += \
         global/qfloat16.cpp \
         global/qoperatingsystemversion.cpp \
         global/qlogging.cpp \
-        global/qhooks.cpp
+        global/qbinarylog.cpp \
+        global/qhooks.cpp \
+        global/qtrace.cpp
 
 VERSIONTAGGING_SOURCES = global/qversiontagging.cpp
 
@@ -61,6 +68,9 @@ qtConfig(slog2): \
 qtConfig(journald): \
     QMAKE_USE_PRIVATE += journald
 
+qtConfig(lttng): \
+    QMAKE_USE_PRIVATE += lttng_ust
+
 gcc:ltcg {
     versiontagging_compiler.commands = $$QMAKE_CXX -c $(CXXFLAGS) $(INCPATH)
 
@@ -0,0 +1,805 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qbinarylog_p.h"
+#include "qfile.h"
+#include "qlogging.h"
+#include "qvarlengtharray.h"
+
+#ifdef QBINARYLOG_HAVE_WRITER
+#  include "qplatformdefs.h"
+#  include "qmath.h"
+#  include "private/qcore_unix_p.h"
+#  include <sys/mman.h>
+#  include <time.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace QBinaryLog;
+
+namespace {
+
+// category, file and function names longer than this are cut
+enum { MaximumNameLength = 1024 };
+
+// length modifiers as understood by QString::vasprintf
+enum LengthModifier { lm_none, lm_hh, lm_h, lm_l, lm_ll, lm_L, lm_j, lm_z, lm_t };
+
+}
+
+static inline bool isFlagCharacter(char c)
+{
+    return c == '#' || c == '0' || c == '-' || c == ' ' || c == '+' || c == '\'';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static LengthModifier parseLengthModifier(const char *&c)
+{
+    switch (*c++) {
+    case 'h':
+        if (*c == 'h') {
+            ++c;
+            return lm_hh;
+        }
+        return lm_h;
+    case 'l':
+        if (*c == 'l') {
+            ++c;
+            return lm_ll;
+        }
+        return lm_l;
+    case 'L': return lm_L;
+    case 'j': return lm_j;
+    case 'z':
+    case 'Z': return lm_z;
+    case 't': return lm_t;
+    }
+    --c;
+    return lm_none;
+}
+
+static inline quint32 alignedRecordSize(quint64 size)
+{
+    return quint32((size + RecordAlignment - 1) & ~quint64(RecordAlignment - 1));
+}
+
+#ifdef QBINARYLOG_HAVE_WRITER
+
+typedef QVarLengthArray<char, 256> ArgumentBuffer;
+
+static inline void appendArgument(ArgumentBuffer *out, ArgumentTag tag, const void *data, int size)
+{
+    out->append(char(tag));
+    out->append(static_cast<const char *>(data), size);
+}
+
+static inline void appendInt(ArgumentBuffer *out, qint64 value)
+{
+    appendArgument(out, IntArgument, &value, sizeof value);
+}
+
+static void appendString(ArgumentBuffer *out, const char *data, quint32 length)
+{
+    appendArgument(out, StringArgument, &length, sizeof length);
+    out->append(data, int(length));
+}
+
+/*
+    Walks \a format exactly like QString::vasprintf() does, and stores the
+    values it would take from \a ap. QBinaryLogReader::formatMessage() walks
+    the format the same way to produce the same text later. Returns false
+    for formats that cannot be deferred (%n).
+*/
+static bool encodeArguments(const char *c, va_list ap, ArgumentBuffer *out)
+{
+    for (;;) {
+        while (*c != '\0' && *c != '%')
+            ++c;
+        if (*c == '\0')
+            return true;
+        ++c;
+        if (*c == '\0')
+            return true;
+        if (*c == '%') {
+            ++c;
+            continue;
+        }
+
+        while (*c != '\0' && isFlagCharacter(*c))
+            ++c;
+        if (*c == '\0')
+            return true;
+
+        if (isDigit(*c)) {
+            while (isDigit(*c))
+                ++c;
+        } else if (*c == '*') {
+            appendInt(out, va_arg(ap, int));
+            ++c;
+        }
+        if (*c == '\0')
+            return true;
+
+        if (*c == '.') {
+            ++c;
+            if (isDigit(*c)) {
+                while (isDigit(*c))
+                    ++c;
+            } else if (*c == '*') {
+                appendInt(out, va_arg(ap, int));
+                ++c;
+            }
+        }
+        if (*c == '\0')
+            return true;
+
+        const LengthModifier lengthModifier = parseLengthModifier(c);
+        if (*c == '\0')
+            return true;
+
+        switch (*c) {
+        case 'd':
+        case 'i': {
+            qint64 i;
+            switch (lengthModifier) {
+            case lm_none:
+            case lm_hh:
+            case lm_h:
+            case lm_t: i = va_arg(ap, int); break;
+            case lm_l:
+            case lm_j: i = va_arg(ap, long int); break;
+            case lm_ll: i = va_arg(ap, qint64); break;
+            case lm_z: i = va_arg(ap, size_t); break;
+            default: i = 0; break;
+            }
+            appendInt(out, i);
+            break;
+        }
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X': {
+            quint64 u;
+            switch (lengthModifier) {
+            case lm_none:
+            case lm_hh:
+            case lm_h: u = va_arg(ap, uint); break;
+            case lm_l: u = va_arg(ap, ulong); break;
+            case lm_ll: u = va_arg(ap, quint64); break;
+            case lm_z: u = va_arg(ap, size_t); break;
+            default: u = 0; break;
+            }
+            appendArgument(out, UIntArgument, &u, sizeof u);
+            break;
+        }
+        case 'E':
+        case 'e':
+        case 'F':
+        case 'f':
+        case 'G':
+        case 'g':
+        case 'A':
+        case 'a': {
+            double d;
+            if (lengthModifier == lm_L)
+                d = va_arg(ap, long double);
+            else
+                d = va_arg(ap, double);
+            appendArgument(out, DoubleArgument, &d, sizeof d);
+            break;
+        }
+        case 'c':
+            appendInt(out, va_arg(ap, int));
+            break;
+        case 's':
+            if (lengthModifier == lm_l) {
+                const ushort *buff = va_arg(ap, const ushort *);
+                const ushort *ch = buff;
+                while (*ch != 0)
+                    ++ch;
+                const QByteArray utf8 = QString::fromUtf16(buff, int(ch - buff)).toUtf8();
+                appendString(out, utf8.constData(), quint32(utf8.size()));
+            } else {
+                const char *s = va_arg(ap, const char *);
+                appendString(out, s, s ? quint32(strlen(s)) : 0);
+            }
+            break;
+        case 'p': {
+            const quint64 p = reinterpret_cast<quintptr>(va_arg(ap, void *));
+            appendArgument(out, PointerArgument, &p, sizeof p);
+            break;
+        }
+        case 'n':
+            return false;
+        default:
+            // bad escape, treated as text; the character is looked at again
+            continue;
+        }
+        ++c;
+    }
+}
+
+static qint64 currentTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return qint64(ts.tv_sec) * Q_INT64_C(1000000000) + ts.tv_nsec;
+}
+
+static inline QBasicAtomicInteger<quint64> &writePosition(FileHeader *header)
+{
+    return *reinterpret_cast<QBasicAtomicInteger<quint64> *>(&header->writePosition);
+}
+
+static inline QBasicAtomicInteger<quint32> &recordSize(RecordHeader *record)
+{
+    return *reinterpret_cast<QBasicAtomicInteger<quint32> *>(&record->size);
+}
+
+static inline quint16 boundedLength(const char *name)
+{
+    return name ? quint16(qMin<size_t>(strlen(name), MaximumNameLength)) : 0;
+}
+
+/*
+    \class QBinaryLogWriter
+    \internal
+
+    Appends log messages to a binary log file, see QBinaryLog. The file is
+    mapped into memory, so records reach the file without any system call,
+    and survive a crash of the process. Any number of threads, and processes
+    sharing the mapping after fork(), can write at the same time.
+*/
+QBinaryLogWriter::QBinaryLogWriter()
+    : header(Q_NULLPTR), ring(Q_NULLPTR), mappedSize(0)
+{
+}
+
+QBinaryLogWriter::~QBinaryLogWriter()
+{
+    if (header)
+        munmap(header, mappedSize);
+}
+
+/*
+    Creates, or truncates, \a fileName and maps it with a ring of
+    \a capacity bytes, rounded up to a power of two.
+*/
+bool QBinaryLogWriter::open(const QByteArray &fileName, quint64 capacity, QString *errorString)
+{
+    Q_ASSERT(!header);
+
+    capacity = qNextPowerOfTwo(qBound<quint64>(MinimumCapacity, capacity, Q_UINT64_C(1) << 30) - 1);
+    const quint64 size = HeaderSize + capacity;
+
+    int fd = qt_safe_open(fileName.constData(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1 || QT_FTRUNCATE(fd, QT_OFF_T(size)) == -1) {
+        if (errorString)
+            *errorString = qt_error_string(errno);
+        if (fd != -1)
+            qt_safe_close(fd);
+        return false;
+    }
+    void *map = mmap(Q_NULLPTR, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int mapError = errno;
+    qt_safe_close(fd);
+    if (map == MAP_FAILED) {
+        if (errorString)
+            *errorString = qt_error_string(mapError);
+        return false;
+    }
+
+    header = static_cast<FileHeader *>(map);
+    ring = static_cast<uchar *>(map) + HeaderSize;
+    mappedSize = size;
+
+    header->version = FileVersion;
+    header->headerSize = HeaderSize;
+    header->blockSize = BlockSize;
+    header->capacity = capacity;
+    header->processId = quint64(getpid());
+    header->startTime = currentTime();
+    writePosition(header).store(0);
+    reinterpret_cast<QBasicAtomicInteger<quint32> *>(&header->magic)->storeRelease(FileMagic);
+    return true;
+}
+
+void QBinaryLogWriter::writePadding(quint64 position, quint32 size)
+{
+    RecordHeader *record = reinterpret_cast<RecordHeader *>(ring + (position & (header->capacity - 1)));
+    recordSize(record).store(0);
+    record->position = quint32(position);
+    record->kind = PaddingRecord;
+    recordSize(record).storeRelease(size);
+}
+
+/*
+    Reserves \a size bytes of the ring that do not cross a block boundary.
+    The size of the record stays 0 until the caller publishes it.
+*/
+uchar *QBinaryLogWriter::reserve(quint32 size, quint64 *position)
+{
+    Q_ASSERT(size <= MaximumRecordSize && size % RecordAlignment == 0);
+    for (;;) {
+        const quint64 start = writePosition(header).fetchAndAddRelaxed(size);
+        const quint64 blockEnd = (start | (BlockSize - 1)) + 1;
+        if (start + size <= blockEnd) {
+            uchar *record = ring + (start & (header->capacity - 1));
+            recordSize(reinterpret_cast<RecordHeader *>(record)).store(0);
+            *position = start;
+            return record;
+        }
+        writePadding(start, quint32(blockEnd - start));
+        writePadding(blockEnd, quint32(start + size - blockEnd));
+    }
+}
+
+bool QBinaryLogWriter::write(QtMsgType type, const QMessageLogContext &context, quint64 threadId,
+                             RecordKind kind, const char *text, int textLength,
+                             const char *arguments, int argumentsLength)
+{
+    const quint16 categoryLength = boundedLength(context.category);
+    const quint16 fileLength = boundedLength(context.file);
+    const quint16 functionLength = boundedLength(context.function);
+    const quint64 fixedSize = sizeof(RecordHeader) + categoryLength + fileLength + functionLength;
+
+    if (fixedSize + textLength + argumentsLength > MaximumRecordSize) {
+        if (kind != TextRecord)
+            return false;
+        // keep as much of the message as fits, without splitting a character
+        textLength = int(MaximumRecordSize - fixedSize);
+        while (textLength > 0 && (uchar(text[textLength]) & 0xc0) == 0x80)
+            --textLength;
+    }
+
+    const quint32 size = alignedRecordSize(fixedSize + textLength + argumentsLength);
+    quint64 position;
+    uchar *data = reserve(size, &position);
+
+    RecordHeader *record = reinterpret_cast<RecordHeader *>(data);
+    record->position = quint32(position);
+    record->kind = kind;
+    record->type = quint8(type);
+    record->categoryLength = categoryLength;
+    record->line = quint32(context.line);
+    record->timestamp = currentTime();
+    record->threadId = threadId;
+    record->fileLength = fileLength;
+    record->functionLength = functionLength;
+    record->textLength = quint32(textLength);
+
+    uchar *out = data + sizeof(RecordHeader);
+    memcpy(out, context.category, categoryLength);
+    out += categoryLength;
+    memcpy(out, context.file, fileLength);
+    out += fileLength;
+    memcpy(out, context.function, functionLength);
+    out += functionLength;
+    memcpy(out, text, textLength);
+    out += textLength;
+    if (argumentsLength)
+        memcpy(out, arguments, argumentsLength);
+
+    recordSize(record).storeRelease(size);
+    return true;
+}
+
+/*
+    Stores \a message as text.
+*/
+bool QBinaryLogWriter::writeMessage(QtMsgType type, const QMessageLogContext &context,
+                                    quint64 threadId, const QString &message)
+{
+    const QByteArray utf8 = message.toUtf8();
+    return write(type, context, threadId, TextRecord, utf8.constData(), utf8.size(), Q_NULLPTR, 0);
+}
+
+/*
+    Stores \a format and the arguments it takes from \a ap, without
+    formatting them. Falls back to formatting the message now if the format
+    cannot be deferred or is too large for a record.
+*/
+bool QBinaryLogWriter::writeFormattedMessage(QtMsgType type, const QMessageLogContext &context,
+                                             quint64 threadId, const char *format, va_list ap)
+{
+    if (format && *format) {
+        ArgumentBuffer arguments;
+        va_list copy;
+        va_copy(copy, ap);
+        const bool encoded = encodeArguments(format, copy, &arguments);
+        va_end(copy);
+        if (encoded && write(type, context, threadId, FormatRecord, format, int(strlen(format)),
+                             arguments.constData(), arguments.size())) {
+            return true;
+        }
+    }
+    return writeMessage(type, context, threadId, QString::vasprintf(format, ap));
+}
+
+/*
+    Returns the writer for the file named by QT_LOGGING_BINARY_FILE, with
+    a ring of QT_LOGGING_BINARY_SIZE bytes (4 MiB by default), or null if
+    the variable is not set or the file cannot be created.
+*/
+QBinaryLogWriter *QBinaryLogWriter::instance()
+{
+    // never destroyed: messages can be logged until the process exits
+    static QBinaryLogWriter *writer = []() -> QBinaryLogWriter * {
+        const QByteArray fileName = qgetenv("QT_LOGGING_BINARY_FILE");
+        if (fileName.isEmpty())
+            return Q_NULLPTR;
+        bool ok;
+        int capacity = qEnvironmentVariableIntValue("QT_LOGGING_BINARY_SIZE", &ok);
+        if (!ok || capacity <= 0)
+            capacity = 4 * 1024 * 1024;
+
+        QBinaryLogWriter *writer = new QBinaryLogWriter;
+        QString errorString;
+        if (!writer->open(fileName, quint64(capacity), &errorString)) {
+            // the message handler cannot be used to report this
+            fprintf(stderr, "QT_LOGGING_BINARY_FILE: cannot open %s: %s\n",
+                    fileName.constData(), errorString.toLocal8Bit().constData());
+            delete writer;
+            return Q_NULLPTR;
+        }
+        return writer;
+    }();
+    return writer;
+}
+
+#endif // QBINARYLOG_HAVE_WRITER
+
+/*
+    \class QBinaryLogReader
+    \internal
+
+    Decodes the records of a binary log file, see QBinaryLog.
+*/
+
+bool QBinaryLogReader::open(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_entries.clear();
+        m_errorString = file.errorString();
+        return false;
+    }
+    return setData(file.readAll());
+}
+
+template <typename T>
+static inline T readValue(const char *data)
+{
+    T value;
+    memcpy(&value, data, sizeof value);
+    return value;
+}
+
+bool QBinaryLogReader::setData(const QByteArray &data)
+{
+    m_entries.clear();
+    m_errorString.clear();
+    m_skippedBytes = 0;
+
+    if (uint(data.size()) < sizeof(FileHeader)) {
+        m_errorString = QStringLiteral("Not a binary log file");
+        return false;
+    }
+    const FileHeader header = readValue<FileHeader>(data.constData());
+    if (header.magic != FileMagic) {
+        m_errorString = QStringLiteral("Not a binary log file");
+        return false;
+    }
+    if (header.version != FileVersion) {
+        m_errorString = QStringLiteral("Unsupported binary log version %1").arg(header.version);
+        return false;
+    }
+    const quint64 blockSize = header.blockSize;
+    const quint64 capacity = header.capacity;
+    if (blockSize < RecordAlignment || (blockSize & (blockSize - 1))
+            || capacity < blockSize || (capacity & (capacity - 1))
+            || quint64(data.size()) < header.headerSize + capacity) {
+        m_errorString = QStringLiteral("Truncated or corrupt binary log file");
+        return false;
+    }
+    m_processId = header.processId;
+    m_startTime = header.startTime;
+
+    const char *ring = data.constData() + header.headerSize;
+    const quint64 end = header.writePosition;
+    quint64 position = end > capacity ? end - capacity : 0;
+    if (position % blockSize) {
+        // the first block was partly overwritten already
+        const quint64 next = (position | (blockSize - 1)) + 1;
+        m_skippedBytes += next - position;
+        position = next;
+    }
+
+    while (position < end) {
+        const quint64 blockEnd = qMin((position | (blockSize - 1)) + 1, end);
+        const char *recordData = ring + (position & (capacity - 1));
+        const quint64 available = blockEnd - position;
+
+        RecordHeader record;
+        memset(&record, 0, sizeof record);
+        memcpy(&record, recordData, size_t(qMin<quint64>(available, sizeof record)));
+        if (record.size == 0 || record.size % RecordAlignment || record.size > available
+                || record.position != quint32(position)
+                || (record.kind != PaddingRecord && record.size < sizeof(RecordHeader))) {
+            // not (yet) written or overwritten; continue with the next block
+            m_skippedBytes += available;
+            position = blockEnd;
+            continue;
+        }
+
+        if (record.kind == TextRecord || record.kind == FormatRecord) {
+            const quint64 contentSize = quint64(record.categoryLength) + record.fileLength
+                    + record.functionLength + record.textLength;
+            if (sizeof(RecordHeader) + contentSize > record.size) {
+                m_skippedBytes += record.size;
+                position += record.size;
+                continue;
+            }
+            const char *content = recordData + sizeof(RecordHeader);
+            Entry entry;
+            entry.type = QtMsgType(record.type);
+            entry.line = int(record.line);
+            entry.timestamp = record.timestamp;
+            entry.threadId = record.threadId;
+            entry.category = QByteArray(content, record.categoryLength);
+            content += record.categoryLength;
+            entry.file = QByteArray(content, record.fileLength);
+            content += record.fileLength;
+            entry.function = QByteArray(content, record.functionLength);
+            content += record.functionLength;
+            if (record.kind == TextRecord) {
+                entry.message = QString::fromUtf8(content, int(record.textLength));
+            } else {
+                const QByteArray format(content, int(record.textLength));
+                entry.message = formatMessage(format.constData(), content + record.textLength,
+                                              recordData + record.size);
+            }
+            m_entries.append(entry);
+        }
+        position += record.size;
+    }
+    return true;
+}
+
+namespace {
+class ArgumentReader
+{
+public:
+    ArgumentReader(const char *begin, const char *end) : current(begin), end(end) {}
+
+    bool read(ArgumentTag tag, void *value, int size)
+    {
+        if (end - current < 1 + size || ArgumentTag(*current) != tag)
+            return false;
+        memcpy(value, current + 1, size);
+        current += 1 + size;
+        return true;
+    }
+
+    bool readString(QByteArray *string)
+    {
+        quint32 length;
+        if (!read(StringArgument, &length, sizeof length) || quint32(end - current) < length)
+            return false;
+        *string = QByteArray(current, int(length));
+        current += length;
+        return true;
+    }
+
+private:
+    const char *current;
+    const char *end;
+};
+}
+
+/*
+    Formats \a format with the arguments encoded between \a arguments and
+    \a end, producing the text QString::vasprintf() would have produced when
+    the message was logged.
+*/
+QString QBinaryLogReader::formatMessage(const char *format, const char *arguments, const char *end)
+{
+    if (!format || !*format)
+        return QString::fromLatin1("");
+
+    ArgumentReader reader(arguments, end);
+    QString result;
+    const char *c = format;
+    for (;;) {
+        const char *cb = c;
+        while (*c != '\0' && *c != '%')
+            ++c;
+        result.append(QString::fromUtf8(cb, int(c - cb)));
+        if (*c == '\0')
+            break;
+
+        const char *escapeStart = c;
+        ++c;
+        if (*c == '\0') {
+            result.append(QLatin1Char('%'));
+            break;
+        }
+        if (*c == '%') {
+            result.append(QLatin1Char('%'));
+            ++c;
+            continue;
+        }
+
+        // rebuild the conversion with the stored values in place of '*'
+        // and with length modifiers matching the stored types
+        QByteArray spec("%");
+        while (*c != '\0' && isFlagCharacter(*c))
+            spec += *c++;
+        if (*c == '\0') {
+            result.append(QLatin1String(escapeStart));
+            break;
+        }
+
+        bool ok = true;
+        if (isDigit(*c)) {
+            while (isDigit(*c))
+                spec += *c++;
+        } else if (*c == '*') {
+            qint64 width = -1;
+            ok = reader.read(IntArgument, &width, sizeof width);
+            if (width >= 0)
+                spec += QByteArray::number(width);
+            ++c;
+        }
+        if (*c == '\0') {
+            result.append(QLatin1String(escapeStart));
+            break;
+        }
+
+        if (*c == '.') {
+            ++c;
+            if (isDigit(*c)) {
+                spec += '.';
+                while (isDigit(*c))
+                    spec += *c++;
+            } else if (*c == '*') {
+                qint64 precision = -1;
+                ok = ok && reader.read(IntArgument, &precision, sizeof precision);
+                if (precision >= 0) {
+                    spec += '.';
+                    spec += QByteArray::number(precision);
+                }
+                ++c;
+            }
+        }
+        if (*c == '\0') {
+            result.append(QLatin1String(escapeStart));
+            break;
+        }
+
+        const LengthModifier lengthModifier = parseLengthModifier(c);
+        if (*c == '\0') {
+            result.append(QLatin1String(escapeStart));
+            break;
+        }
+
+        QString subst;
+        switch (*c) {
+        case 'd':
+        case 'i': {
+            qint64 i = 0;
+            ok = ok && reader.read(IntArgument, &i, sizeof i);
+            spec += "ll";
+            spec += *c;
+            subst = QString::asprintf(spec.constData(), i);
+            break;
+        }
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X': {
+            quint64 u = 0;
+            ok = ok && reader.read(UIntArgument, &u, sizeof u);
+            spec += "ll";
+            spec += *c;
+            subst = QString::asprintf(spec.constData(), u);
+            break;
+        }
+        case 'E':
+        case 'e':
+        case 'F':
+        case 'f':
+        case 'G':
+        case 'g':
+        case 'A':
+        case 'a': {
+            double d = 0;
+            ok = ok && reader.read(DoubleArgument, &d, sizeof d);
+            spec += *c;
+            subst = QString::asprintf(spec.constData(), d);
+            break;
+        }
+        case 'c': {
+            qint64 ch = 0;
+            ok = ok && reader.read(IntArgument, &ch, sizeof ch);
+            spec += lengthModifier == lm_l ? "lc" : "c";
+            subst = QString::asprintf(spec.constData(), int(ch));
+            break;
+        }
+        case 's': {
+            QByteArray s;
+            ok = ok && reader.readString(&s);
+            spec += 's';
+            subst = QString::asprintf(spec.constData(), s.constData());
+            break;
+        }
+        case 'p': {
+            quint64 p = 0;
+            ok = ok && reader.read(PointerArgument, &p, sizeof p);
+            spec += 'p';
+            subst = QString::asprintf(spec.constData(), reinterpret_cast<void *>(quintptr(p)));
+            break;
+        }
+        default:
+            // bad escape, treat as non-escape text
+            result.append(QLatin1String(escapeStart, int(c - escapeStart)));
+            continue;
+        }
+
+        if (!ok) {
+            // the arguments do not match the format; show what is left as is
+            result.append(QLatin1String(escapeStart));
+            break;
+        }
+        result.append(subst);
+        ++c;
+    }
+    return result;
+}
+
+QT_END_NAMESPACE
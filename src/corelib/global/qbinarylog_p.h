@@ -0,0 +1,219 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QBINARYLOG_P_H
+#define QBINARYLOG_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+
+#include <stdarg.h>
+
+#if defined(Q_OS_UNIX) && defined(Q_ATOMIC_INT64_IS_SUPPORTED) && !defined(QT_BOOTSTRAPPED)
+#  define QBINARYLOG_HAVE_WRITER
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class QMessageLogContext;
+
+/*
+    Layout of a binary log file, see QT_LOGGING_BINARY_FILE.
+
+    The file starts with a FileHeader, padded to HeaderSize, followed by a
+    ring of FileHeader::capacity bytes. The ring is divided into blocks of
+    BlockSize bytes, and no record crosses a block boundary: a writer that
+    would cross one fills the rest of the block with padding and retries.
+    Records are limited to MaximumRecordSize, so one retry always fits.
+    This lets a reader that starts in the middle of the ring (after it has
+    wrapped) resynchronize at the next block boundary.
+
+    FileHeader::writePosition counts all bytes ever reserved; the ring
+    offset of a position is position % capacity. A record is published by
+    writing its size last. Each record also stores the low 32 bits of its
+    position, so that data left over from a previous lap of the ring, or a
+    record that was never completed, is recognized and the rest of its
+    block skipped.
+
+    All values are stored in host byte order.
+*/
+namespace QBinaryLog {
+
+enum : quint32 {
+    FileMagic = 0x474c4251,     // "QBLG"
+    FileVersion = 1,
+    HeaderSize = 4096,
+    BlockSize = 16384,
+    RecordAlignment = 16,
+    MaximumRecordSize = BlockSize / 4,
+    MinimumCapacity = 4 * BlockSize
+};
+
+enum RecordKind : quint8 {
+    PaddingRecord = 1,
+    TextRecord = 2,             // the message as UTF-8
+    FormatRecord = 3            // a printf-style format and its encoded arguments
+};
+
+// tags of the arguments following the format of a FormatRecord
+enum ArgumentTag : quint8 {
+    IntArgument = 1,            // qint64
+    UIntArgument = 2,           // quint64
+    DoubleArgument = 3,         // double
+    StringArgument = 4,         // quint32 length, followed by UTF-8 data
+    PointerArgument = 5         // quint64
+};
+
+struct FileHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 headerSize;
+    quint32 blockSize;
+    quint64 capacity;
+    quint64 processId;
+    qint64 startTime;           // nanoseconds since the epoch
+    quint64 writePosition;      // accessed atomically by the writers
+};
+
+struct RecordHeader
+{
+    quint32 size;               // including this header; 0 until published
+    quint32 position;
+    quint8 kind;
+    quint8 type;                // QtMsgType
+    quint16 categoryLength;
+    quint32 line;
+    qint64 timestamp;           // nanoseconds since the epoch
+    quint64 threadId;
+    quint16 fileLength;
+    quint16 functionLength;
+    quint32 textLength;
+    // followed by category, file, function, text (message or format),
+    // and for FormatRecords the arguments
+};
+
+} // namespace QBinaryLog
+
+#ifdef QBINARYLOG_HAVE_WRITER
+class Q_CORE_EXPORT QBinaryLogWriter
+{
+public:
+    QBinaryLogWriter();
+    ~QBinaryLogWriter();
+
+    bool open(const QByteArray &fileName, quint64 capacity, QString *errorString = Q_NULLPTR);
+    bool isOpen() const { return header != Q_NULLPTR; }
+
+    bool writeMessage(QtMsgType type, const QMessageLogContext &context, quint64 threadId,
+                      const QString &message);
+    bool writeFormattedMessage(QtMsgType type, const QMessageLogContext &context,
+                               quint64 threadId, const char *format, va_list ap);
+
+    static QBinaryLogWriter *instance();
+
+private:
+    Q_DISABLE_COPY(QBinaryLogWriter)
+
+    uchar *reserve(quint32 size, quint64 *position);
+    void writePadding(quint64 position, quint32 size);
+    bool write(QtMsgType type, const QMessageLogContext &context, quint64 threadId,
+               QBinaryLog::RecordKind kind, const char *text, int textLength,
+               const char *arguments, int argumentsLength);
+
+    QBinaryLog::FileHeader *header;
+    uchar *ring;
+    quint64 mappedSize;
+};
+#endif // QBINARYLOG_HAVE_WRITER
+
+class Q_CORE_EXPORT QBinaryLogReader
+{
+public:
+    struct Entry
+    {
+        QtMsgType type;
+        int line;
+        qint64 timestamp;       // nanoseconds since the epoch
+        quint64 threadId;
+        QByteArray category;
+        QByteArray file;
+        QByteArray function;
+        QString message;
+    };
+
+    bool open(const QString &fileName);
+    bool setData(const QByteArray &data);
+
+    QString errorString() const { return m_errorString; }
+    quint64 processId() const { return m_processId; }
+    qint64 startTime() const { return m_startTime; }
+    // bytes of the ring that could not be decoded, e.g. unfinished records
+    quint64 skippedBytes() const { return m_skippedBytes; }
+    QVector<Entry> entries() const { return m_entries; }
+
+    static QString formatMessage(const char *format, const char *arguments, const char *end);
+
+private:
+    QVector<Entry> m_entries;
+    QString m_errorString;
+    quint64 m_processId = 0;
+    qint64 m_startTime = 0;
+    quint64 m_skippedBytes = 0;
+};
+
+Q_DECLARE_TYPEINFO(QBinaryLogReader::Entry, Q_MOVABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QBINARYLOG_P_H
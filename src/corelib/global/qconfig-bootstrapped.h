@@ -76,9 +76,11 @@
 # define QT_FEATURE_alloca_malloc_h -1
 #endif
 #define QT_FEATURE_iconv -1
+#define QT_FEATURE_etw -1
 #define QT_FEATURE_icu -1
 #define QT_FEATURE_journald -1
 #define QT_FEATURE_library -1
+#define QT_FEATURE_lttng -1
 #define QT_NO_QOBJECT
 #define QT_FEATURE_process -1
 #define QT_NO_SYSTEMLOCALE
@@ -88,6 +90,7 @@
 #define QT_NO_THREAD
 #define QT_FEATURE_timezone -1
 #define QT_FEATURE_topleveldomain -1
+#define QT_FEATURE_tracerecorder -1
 #define QT_NO_TRANSLATION
 #define QT_FEATURE_translation -1
 #define QT_NO_GEOM_VARIANT
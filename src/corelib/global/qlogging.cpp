@@ -41,6 +41,7 @@
 
 #include "qglobal_p.h"
 #include "qlogging.h"
+#include "qlogging_p.h"
 #include "qlist.h"
 #include "qbytearray.h"
 #include "qstring.h"
@@ -139,6 +140,15 @@ static QT_PREPEND_NAMESPACE(qint64) qt_gettid()
 #  include <cxxabi.h>
 #  include <execinfo.h>
 #endif
+
+#if defined(Q_OS_UNIX) && !defined(QT_NO_THREAD) && defined(Q_COMPILER_THREAD_LOCAL)
+#  define QLOGGING_HAVE_ASYNC
+#  include "qmath.h"
+#  include "qsemaphore.h"
+#  include <atomic>
+#  include <pthread.h>
+#endif
+#include "private/qbinarylog_p.h"
 #endif // !QT_BOOTSTRAPPED
 
 #include <cstdlib>
@@ -152,6 +162,10 @@ Q_NORETURN
 #endif
 static void qt_message_fatal(QtMsgType, const QMessageLogContext &context, const QString &message);
 static void qt_message_print(QtMsgType, const QMessageLogContext &context, const QString &message);
+#ifdef QBINARYLOG_HAVE_WRITER
+static bool binaryLogFormattedMessage(QtMsgType type, const QMessageLogContext &context,
+                                      const char *format, va_list ap);
+#endif
 
 static bool isFatal(QtMsgType msgType)
 {
@@ -277,6 +291,10 @@ static inline void convert_to_wchar_t_elided(wchar_t *d, size_t space, const cha
 Q_NEVER_INLINE
 static QString qt_message(QtMsgType msgType, const QMessageLogContext &context, const char *msg, va_list ap)
 {
+#ifdef QBINARYLOG_HAVE_WRITER
+    if (binaryLogFormattedMessage(msgType, context, msg, ap))
+        return QString();
+#endif
     QString buf = QString::vasprintf(msg, ap);
     qt_message_print(msgType, context, buf);
     return buf;
@@ -343,7 +361,7 @@ void QMessageLogger::info(const char *msg, ...) const
 */
 void QMessageLogger::debug(const QLoggingCategory &cat, const char *msg, ...) const
 {
-    if (!cat.isDebugEnabled())
+    if (!cat.isDebugEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -370,7 +388,7 @@ void QMessageLogger::debug(QMessageLogger::CategoryFunction catFunc,
                            const char *msg, ...) const
 {
     const QLoggingCategory &cat = (*catFunc)();
-    if (!cat.isDebugEnabled())
+    if (!cat.isDebugEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -410,7 +428,7 @@ QDebug QMessageLogger::debug() const
 QDebug QMessageLogger::debug(const QLoggingCategory &cat) const
 {
     QDebug dbg = QDebug(QtDebugMsg);
-    if (!cat.isDebugEnabled())
+    if (!cat.isDebugEnabled() || !cat.passesRateLimit())
         dbg.stream->message_output = false;
 
     QMessageLogContext &ctxt = dbg.stream->context;
@@ -454,7 +472,7 @@ QNoDebug QMessageLogger::noDebug() const Q_DECL_NOTHROW
 */
 void QMessageLogger::info(const QLoggingCategory &cat, const char *msg, ...) const
 {
-    if (!cat.isInfoEnabled())
+    if (!cat.isInfoEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -481,7 +499,7 @@ void QMessageLogger::info(QMessageLogger::CategoryFunction catFunc,
                            const char *msg, ...) const
 {
     const QLoggingCategory &cat = (*catFunc)();
-    if (!cat.isInfoEnabled())
+    if (!cat.isInfoEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -522,7 +540,7 @@ QDebug QMessageLogger::info() const
 QDebug QMessageLogger::info(const QLoggingCategory &cat) const
 {
     QDebug dbg = QDebug(QtInfoMsg);
-    if (!cat.isInfoEnabled())
+    if (!cat.isInfoEnabled() || !cat.passesRateLimit())
         dbg.stream->message_output = false;
 
     QMessageLogContext &ctxt = dbg.stream->context;
@@ -572,7 +590,7 @@ void QMessageLogger::warning(const char *msg, ...) const
 */
 void QMessageLogger::warning(const QLoggingCategory &cat, const char *msg, ...) const
 {
-    if (!cat.isWarningEnabled())
+    if (!cat.isWarningEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -599,7 +617,7 @@ void QMessageLogger::warning(QMessageLogger::CategoryFunction catFunc,
                              const char *msg, ...) const
 {
     const QLoggingCategory &cat = (*catFunc)();
-    if (!cat.isWarningEnabled())
+    if (!cat.isWarningEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -637,7 +655,7 @@ QDebug QMessageLogger::warning() const
 QDebug QMessageLogger::warning(const QLoggingCategory &cat) const
 {
     QDebug dbg = QDebug(QtWarningMsg);
-    if (!cat.isWarningEnabled())
+    if (!cat.isWarningEnabled() || !cat.passesRateLimit())
         dbg.stream->message_output = false;
 
     QMessageLogContext &ctxt = dbg.stream->context;
@@ -688,7 +706,7 @@ void QMessageLogger::critical(const char *msg, ...) const
 */
 void QMessageLogger::critical(const QLoggingCategory &cat, const char *msg, ...) const
 {
-    if (!cat.isCriticalEnabled())
+    if (!cat.isCriticalEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -715,7 +733,7 @@ void QMessageLogger::critical(QMessageLogger::CategoryFunction catFunc,
                               const char *msg, ...) const
 {
     const QLoggingCategory &cat = (*catFunc)();
-    if (!cat.isCriticalEnabled())
+    if (!cat.isCriticalEnabled() || !cat.passesRateLimit())
         return;
 
     QMessageLogContext ctxt;
@@ -754,7 +772,7 @@ QDebug QMessageLogger::critical() const
 QDebug QMessageLogger::critical(const QLoggingCategory &cat) const
 {
     QDebug dbg = QDebug(QtCriticalMsg);
-    if (!cat.isCriticalEnabled())
+    if (!cat.isCriticalEnabled() || !cat.passesRateLimit())
         dbg.stream->message_output = false;
 
     QMessageLogContext &ctxt = dbg.stream->context;
@@ -983,6 +1001,13 @@ struct QMessagePattern {
 
     void setPattern(const QString &pattern);
 
+    // what a message needs from the thread that logged it, see QMessageLogCapture
+    enum Requirement {
+        NeedsTime = 0x1,
+        NeedsQThread = 0x2,
+        NeedsLoggingThread = 0x4    // must be formatted by the logging thread
+    };
+
     // 0 terminated arrays of literal tokens / literal or placeholder tokens
     const char **literals;
     const char **tokens;
@@ -999,6 +1024,7 @@ struct QMessagePattern {
 #endif
 
     bool fromEnvironment;
+    QAtomicInt requirements;    // read without holding the mutex
     static QBasicMutex mutex;
 };
 #ifdef QLOGGING_HAVE_BACKTRACE
@@ -1179,6 +1205,17 @@ void QMessagePattern::setPattern(const QString &pattern)
             tokens[i] = literal;
         }
     }
+    int needs = 0;
+    for (int i = 0; tokens[i]; ++i) {
+        if (tokens[i] == timeTokenC)
+            needs |= NeedsTime;
+        else if (tokens[i] == qthreadptrTokenC)
+            needs |= NeedsQThread;
+        else if (tokens[i] == backtraceTokenC || tokens[i] == appnameTokenC)
+            needs |= NeedsLoggingThread;
+    }
+    requirements.store(needs);
+
     if (nestedIfError)
         error += QLatin1String("QT_MESSAGE_PATTERN: %{if-*} cannot be nested\n");
     else if (inIf)
@@ -1339,6 +1376,18 @@ static void slog2_default_handler(QtMsgType msgType, const char *message)
 
 Q_GLOBAL_STATIC(QMessagePattern, qMessagePattern)
 
+// the state of the logging thread at the time a message was logged
+struct QMessageLogCapture
+{
+    qint64 threadId;
+    quintptr qthread;
+    qint64 msecsSinceEpoch;
+    qint64 msecsSinceReference;
+};
+
+static QString formatLogMessage(QtMsgType type, const QMessageLogContext &context,
+                                const QString &str, const QMessageLogCapture *capture);
+
 /*!
     \relates <QtGlobal>
     \since 5.4
@@ -1354,6 +1403,17 @@ Q_GLOBAL_STATIC(QMessagePattern, qMessagePattern)
     \sa qInstallMessageHandler(), qSetMessagePattern()
  */
 QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, const QString &str)
+{
+    return formatLogMessage(type, context, str, 0);
+}
+
+/*
+    Formats a message like qFormatLogMessage(). If \a capture is not null, the
+    thread and time placeholders are taken from it instead of from the
+    calling thread and the current time.
+*/
+static QString formatLogMessage(QtMsgType type, const QMessageLogContext &context,
+                                const QString &str, const QMessageLogCapture *capture)
 {
     QString message;
 
@@ -1373,6 +1433,8 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
 #ifdef QLOGGING_HAVE_BACKTRACE
     int backtraceArgsIdx = 0;
 #endif
+#else
+    Q_UNUSED(capture);
 #endif
 
     // we do not convert file, function, line literals to local encoding due to overhead
@@ -1422,10 +1484,12 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
             message.append(QCoreApplication::applicationName());
         } else if (token == threadidTokenC) {
             // print the TID as decimal
-            message.append(QString::number(qt_gettid()));
+            message.append(QString::number(capture ? capture->threadId : qint64(qt_gettid())));
         } else if (token == qthreadptrTokenC) {
             message.append(QLatin1String("0x"));
-            message.append(QString::number(qlonglong(QThread::currentThread()->currentThread()), 16));
+            const quintptr thread = capture ? capture->qthread
+                                            : quintptr(QThread::currentThread()->currentThread());
+            message.append(QString::number(qlonglong(thread), 16));
 #ifdef QLOGGING_HAVE_BACKTRACE
         } else if (token == backtraceTokenC) {
             QMessagePattern::BacktraceParams backtraceParams = pattern->backtraceArgs.at(backtraceArgsIdx);
@@ -1436,20 +1500,30 @@ QString qFormatLogMessage(QtMsgType type, const QMessageLogContext &context, con
             QString timeFormat = pattern->timeArgs.at(timeArgsIdx);
             timeArgsIdx++;
             if (timeFormat == QLatin1String("process")) {
-                    quint64 ms = pattern->timer.elapsed();
+                    quint64 ms = capture
+                            ? capture->msecsSinceReference - pattern->timer.msecsSinceReference()
+                            : pattern->timer.elapsed();
                     message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
             } else if (timeFormat ==  QLatin1String("boot")) {
                 // just print the milliseconds since the elapsed timer reference
                 // like the Linux kernel does
-                QElapsedTimer now;
-                now.start();
-                uint ms = now.msecsSinceReference();
+                uint ms;
+                if (capture) {
+                    ms = capture->msecsSinceReference;
+                } else {
+                    QElapsedTimer now;
+                    now.start();
+                    ms = now.msecsSinceReference();
+                }
                 message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
 #if QT_CONFIG(datestring)
-            } else if (timeFormat.isEmpty()) {
-                    message.append(QDateTime::currentDateTime().toString(Qt::ISODate));
             } else {
-                message.append(QDateTime::currentDateTime().toString(timeFormat));
+                const QDateTime now = capture ? QDateTime::fromMSecsSinceEpoch(capture->msecsSinceEpoch)
+                                              : QDateTime::currentDateTime();
+                if (timeFormat.isEmpty())
+                    message.append(now.toString(Qt::ISODate));
+                else
+                    message.append(now.toString(timeFormat));
 #endif // QT_CONFIG(datestring)
             }
 #endif // !QT_BOOTSTRAPPED
@@ -1568,37 +1642,55 @@ static void android_default_message_handler(QtMsgType type,
 
 /*!
     \internal
+
+    Sends the formatted \a logMessage to the system log, unless the default
+    message handler logs to the console. Returns \c true if the message was
+    handled, \c false if it should be written to stderr.
 */
-static void qDefaultMessageHandler(QtMsgType type, const QMessageLogContext &context,
-                                   const QString &buf)
+static bool systemMessageSink(QtMsgType type, const QMessageLogContext &context,
+                              QString &logMessage)
 {
-    QString logMessage = qFormatLogMessage(type, context, buf);
-
-    // print nothing if message pattern didn't apply / was empty.
-    // (still print empty lines, e.g. because message itself was empty)
-    if (logMessage.isNull())
-        return;
-
+    Q_UNUSED(type);
+    Q_UNUSED(context);
+    Q_UNUSED(logMessage);
     if (!qt_logging_to_console()) {
 #if defined(Q_OS_WIN)
         logMessage.append(QLatin1Char('\n'));
         OutputDebugString(reinterpret_cast<const wchar_t *>(logMessage.utf16()));
-        return;
+        return true;
 #elif QT_CONFIG(slog2)
         logMessage.append(QLatin1Char('\n'));
         slog2_default_handler(type, logMessage.toLocal8Bit().constData());
-        return;
+        return true;
 #elif QT_CONFIG(journald)
         systemd_default_message_handler(type, context, logMessage);
-        return;
+        return true;
 #elif QT_CONFIG(syslog)
         syslog_default_message_handler(type, logMessage.toUtf8().constData());
-        return;
+        return true;
 #elif defined(Q_OS_ANDROID)
         android_default_message_handler(type, context, logMessage);
-        return;
+        return true;
 #endif
     }
+    return false;
+}
+
+/*!
+    \internal
+*/
+static void qDefaultMessageHandler(QtMsgType type, const QMessageLogContext &context,
+                                   const QString &buf)
+{
+    QString logMessage = qFormatLogMessage(type, context, buf);
+
+    // print nothing if message pattern didn't apply / was empty.
+    // (still print empty lines, e.g. because message itself was empty)
+    if (logMessage.isNull())
+        return;
+
+    if (systemMessageSink(type, context, logMessage))
+        return;
     fprintf(stderr, "%s\n", logMessage.toLocal8Bit().constData());
     fflush(stderr);
 }
@@ -1635,13 +1727,548 @@ static bool grabMessageHandler() { return true; }
 static void ungrabMessageHandler() { }
 #endif // (Q_COMPILER_THREAD_LOCAL)
 
-static void qt_message_print(QtMsgType msgType, const QMessageLogContext &context, const QString &message)
+#ifdef QLOGGING_HAVE_ASYNC
+/*
+    Asynchronous output for the default message handler, see QT_LOGGING_ASYNC.
+
+    Every thread that logs owns a single-producer/single-consumer ring buffer.
+    Logging a message only copies it, its context and whatever the message
+    pattern needs from the logging thread (thread id, time) into the ring of
+    the calling thread, without taking a lock. A writer thread collects the
+    records from all rings, formats them and writes them out in batches.
+    Messages from one thread stay in order; messages from different threads
+    may be interleaved differently than they were logged.
+
+    Rings are not freed while the output exists. When a thread exits, its
+    ring is marked free and taken over by the next thread that logs.
+*/
+
+struct QAsyncLogRecord
+{
+    enum { Padding = 0x80000000U };     // flag in size: skip to the end of the ring
+    enum Flag {
+        NullMessage = 0x1,
+        Formatted = 0x2                 // the message was formatted by the logging thread
+    };
+
+    quint32 size;           // of the whole record, a multiple of 8
+    quint8 type;
+    quint8 flags;
+    quint16 reserved;
+    int line;
+    quint32 messageSize;    // in QChars, the message follows the record
+    quint32 categorySize;   // in bytes including the terminating null, 0 for a null pointer
+    quint32 fileSize;
+    quint32 functionSize;
+    QMessageLogCapture capture;
+};
+
+class QAsyncLogRing
+{
+public:
+    enum State { Owned, Free };
+
+    explicit QAsyncLogRing(quint32 capacity)
+        : buffer(new char[capacity]), capacity(capacity), state(Owned), next(0)
+    {
+    }
+    ~QAsyncLogRing() { delete [] buffer; }
+
+    char *reserve(quint32 size, quint32 *newHead);
+
+    char *buffer;
+    const quint32 capacity;         // a power of two
+    QAtomicInteger<quint32> head;   // advanced by the owning thread
+    QAtomicInteger<quint32> tail;   // advanced by the writer
+    QAtomicInt dropped;
+    QAtomicInt state;
+    QAsyncLogRing *next;
+};
+
+/*
+    Returns space for a record of \a size bytes, or null if the ring is full.
+    The record becomes visible to the writer once head is set to \a newHead.
+    Only called by the thread that owns the ring.
+*/
+char *QAsyncLogRing::reserve(quint32 size, quint32 *newHead)
+{
+    const quint32 h = head.load();
+    const quint32 available = capacity - (h - tail.loadAcquire());
+    const quint32 offset = h & (capacity - 1);
+    const quint32 contiguous = capacity - offset;
+    if (size <= contiguous) {
+        if (available < size)
+            return 0;
+        *newHead = h + size;
+        return buffer + offset;
+    }
+
+    // the record does not fit before the end of the buffer: skip the rest
+    if (available < contiguous + size)
+        return 0;
+    *reinterpret_cast<quint32 *>(buffer + offset) = contiguous | QAsyncLogRecord::Padding;
+    *newHead = h + contiguous + size;
+    return buffer;
+}
+
+// a thread's claim on a ring
+struct QAsyncLogRingRef
+{
+    QAsyncLogRingRef() : ring(0), threadId(0), released(false) {}
+    ~QAsyncLogRingRef();
+
+    QAsyncLogRing *ring;
+    qint64 threadId;
+    bool released;          // the thread is exiting
+};
+
+static thread_local QAsyncLogRingRef currentLogRing;
+
+class QAsyncMessageOutput
+{
+public:
+    QAsyncMessageOutput();
+    ~QAsyncMessageOutput();
+
+    bool post(QtMsgType type, const QMessageLogContext &context, const QString &message,
+              bool block);
+    bool flush();
+    quint64 droppedCount();
+
+private:
+    enum {
+        DefaultRingCapacity = 64 * 1024,
+        BatchSize = 32 * 1024,
+        IdleTimeout = 100           // ms; a missed wakeup is never worse than this
+    };
+
+    static void *writerMain(void *self);
+    void run();
+    void wakeWriter();
+    QAsyncLogRing *claimRing();
+    bool drain();
+    void writeRecord(const QAsyncLogRecord *record);
+    void writeMessage(QtMsgType type, const QMessageLogContext &context, QString &logMessage);
+    void writeBatch();
+
+    QAtomicPointer<QAsyncLogRing> rings;
+    quint32 ringCapacity;
+
+    QMutex drainMutex;              // serializes the readers of the rings
+    QByteArray batch;
+    quint64 dropped;
+
+    QSemaphore wakeup;
+    QAtomicInt writerIdle;
+    QAtomicInt quit;
+    pthread_t writer;
+    bool writerRunning;
+};
+
+Q_GLOBAL_STATIC(QAsyncMessageOutput, asyncMessageOutput)
+
+static QBasicAtomicInt messageOutputMode = Q_BASIC_ATOMIC_INITIALIZER(-1);
+static bool forkedChild = false;
+
+static void resetMessageOutputAfterFork()
+{
+    // there is no writer thread in the child
+    forkedChild = true;
+    messageOutputMode.store(int(QMessageOutputMode::Synchronous));
+}
+
+static QMessageOutputMode currentMessageOutputMode()
+{
+    int mode = messageOutputMode.load();
+    if (Q_UNLIKELY(mode < 0)) {
+        const QByteArray env = qgetenv("QT_LOGGING_ASYNC").trimmed().toLower();
+        QMessageOutputMode fromEnvironment = QMessageOutputMode::Asynchronous;
+        if (env.isEmpty() || env == "0")
+            fromEnvironment = QMessageOutputMode::Synchronous;
+        else if (env == "block")
+            fromEnvironment = QMessageOutputMode::AsynchronousBlocking;
+        messageOutputMode.testAndSetRelaxed(-1, int(fromEnvironment));
+        mode = messageOutputMode.load();
+    }
+    return QMessageOutputMode(mode);
+}
+
+QAsyncLogRingRef::~QAsyncLogRingRef()
+{
+    released = true;
+    if (ring && !asyncMessageOutput.isDestroyed())
+        ring->state.storeRelease(QAsyncLogRing::Free);
+}
+
+QAsyncMessageOutput::QAsyncMessageOutput()
+    : ringCapacity(DefaultRingCapacity), dropped(0), writerRunning(false)
+{
+    bool ok;
+    const int size = qEnvironmentVariableIntValue("QT_LOGGING_ASYNC_BUFFER_SIZE", &ok);
+    if (ok && size > 0)
+        ringCapacity = qNextPowerOfTwo(quint32(qBound(4096, size, 64 * 1024 * 1024) - 1));
+    batch.reserve(BatchSize);
+
+    // Set up what the writer uses from this thread: otherwise the writer
+    // could become Qt's main thread by being the first one with thread data
+    // (text codecs use QThreadStorage), and the codec state would be
+    // destroyed before the writer exits.
+    QThread::currentThread();
+    Q_UNUSED(QString(QLatin1Char(' ')).toLocal8Bit());
+
+    pthread_atfork(0, 0, resetMessageOutputAfterFork);
+    writerRunning = pthread_create(&writer, 0, writerMain, this) == 0;
+}
+
+QAsyncMessageOutput::~QAsyncMessageOutput()
+{
+    if (forkedChild)
+        return;
+
+    if (writerRunning) {
+        quit.storeRelease(1);
+        wakeup.release();
+        pthread_join(writer, 0);
+    }
+    flush();
+
+    // threads that are still running may hold on to their rings
+    QAsyncLogRing *ring = rings.load();
+    while (ring) {
+        QAsyncLogRing *next = ring->next;
+        if (ring->state.load() == QAsyncLogRing::Free)
+            delete ring;
+        ring = next;
+    }
+}
+
+void *QAsyncMessageOutput::writerMain(void *self)
+{
+    // messages logged by the writer itself go straight to stderr
+    grabMessageHandler();
+    static_cast<QAsyncMessageOutput *>(self)->run();
+    return 0;
+}
+
+void QAsyncMessageOutput::run()
+{
+    while (!quit.loadAcquire()) {
+        if (flush())
+            continue;
+        writerIdle.fetchAndStoreOrdered(1);
+        if (!flush() && !quit.loadAcquire())
+            wakeup.tryAcquire(1, IdleTimeout);
+        writerIdle.store(0);
+    }
+}
+
+void QAsyncMessageOutput::wakeWriter()
+{
+    // pairs with the exchange in run(): either the writer sees the new
+    // record, or we see that it is about to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writerIdle.load() && writerIdle.testAndSetRelaxed(1, 0))
+        wakeup.release();
+}
+
+QAsyncLogRing *QAsyncMessageOutput::claimRing()
+{
+    for (QAsyncLogRing *ring = rings.loadAcquire(); ring; ring = ring->next) {
+        if (ring->state.load() == QAsyncLogRing::Free
+                && ring->state.testAndSetAcquire(QAsyncLogRing::Free, QAsyncLogRing::Owned)) {
+            return ring;
+        }
+    }
+
+    QAsyncLogRing *ring = new QAsyncLogRing(ringCapacity);
+    QAsyncLogRing *first;
+    do {
+        first = rings.loadAcquire();
+        ring->next = first;
+    } while (!rings.testAndSetRelease(first, ring));
+    return ring;
+}
+
+static inline quint32 logStringSize(const char *str)
+{
+    return str ? quint32(strlen(str)) + 1 : 0;
+}
+
+static inline char *appendLogString(char *out, const void *data, quint32 size)
+{
+    if (size)
+        memcpy(out, data, size);
+    return out + size;
+}
+
+/*
+    Queues a message in the ring of the calling thread. Returns false if the
+    message cannot be queued and has to be written synchronously.
+*/
+bool QAsyncMessageOutput::post(QtMsgType type, const QMessageLogContext &context,
+                               const QString &message, bool block)
+{
+    QAsyncLogRingRef &ref = currentLogRing;
+    if (ref.released || !writerRunning)
+        return false;
+    if (!ref.ring) {
+        ref.ring = claimRing();
+        ref.threadId = qt_gettid();
+    }
+    QAsyncLogRing *ring = ref.ring;
+
+    QMessagePattern *pattern = qMessagePattern();
+    const int needs = pattern ? pattern->requirements.load() : 0;
+
+    QAsyncLogRecord record;
+    record.type = quint8(type);
+    record.flags = 0;
+    record.reserved = 0;
+    record.line = context.line;
+
+    QString formatted;
+    const QString *text = &message;
+    if (needs & QMessagePattern::NeedsLoggingThread) {
+        formatted = qFormatLogMessage(type, context, message);
+        if (formatted.isNull())
+            return true;
+        text = &formatted;
+        record.flags |= QAsyncLogRecord::Formatted;
+    } else if (message.isNull()) {
+        record.flags |= QAsyncLogRecord::NullMessage;
+    }
+
+    // anything larger than half the ring might never fit
+    if (uint(text->size()) > ring->capacity / 2)
+        return false;
+    record.messageSize = text->size();
+    record.categorySize = logStringSize(context.category);
+    record.fileSize = logStringSize(context.file);
+    record.functionSize = logStringSize(context.function);
+    const quint64 size = (quint64(sizeof(QAsyncLogRecord)) + record.messageSize * sizeof(QChar)
+                          + record.categorySize + record.fileSize + record.functionSize + 7) & ~7;
+    if (size > ring->capacity / 2)
+        return false;
+    record.size = quint32(size);
+
+    record.capture.threadId = ref.threadId;
+    record.capture.qthread = (needs & QMessagePattern::NeedsQThread)
+            ? quintptr(QThread::currentThread()) : 0;
+    record.capture.msecsSinceEpoch = 0;
+    record.capture.msecsSinceReference = 0;
+    if (needs & QMessagePattern::NeedsTime) {
+        QElapsedTimer now;
+        now.start();
+        record.capture.msecsSinceReference = now.msecsSinceReference();
+        record.capture.msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    quint32 newHead;
+    char *out = ring->reserve(record.size, &newHead);
+    while (!out) {
+        if (!block) {
+            ring->dropped.ref();
+            wakeWriter();
+            return true;
+        }
+        if (quit.loadAcquire())
+            return false;
+        wakeWriter();
+        QThread::yieldCurrentThread();
+        out = ring->reserve(record.size, &newHead);
+    }
+
+    out = appendLogString(out, &record, sizeof(record));
+    out = appendLogString(out, text->constData(), record.messageSize * sizeof(QChar));
+    out = appendLogString(out, context.category, record.categorySize);
+    out = appendLogString(out, context.file, record.fileSize);
+    appendLogString(out, context.function, record.functionSize);
+    ring->head.storeRelease(newHead);
+
+    wakeWriter();
+    return true;
+}
+
+/*
+    Writes out everything that was queued so far. Returns true if there
+    was anything to write.
+*/
+bool QAsyncMessageOutput::flush()
+{
+    // messages logged while formatting must not end up in a ring again
+    const bool grabbed = grabMessageHandler();
+    bool wrote;
+    {
+        QMutexLocker locker(&drainMutex);
+        wrote = drain();
+    }
+    if (grabbed)
+        ungrabMessageHandler();
+    return wrote;
+}
+
+// called with drainMutex locked
+bool QAsyncMessageOutput::drain()
+{
+    bool wrote = false;
+    for (QAsyncLogRing *ring = rings.loadAcquire(); ring; ring = ring->next) {
+        quint32 t = ring->tail.load();
+        const quint32 h = ring->head.loadAcquire();
+        if (t != h)
+            wrote = true;
+        while (t != h) {
+            const char *data = ring->buffer + (t & (ring->capacity - 1));
+            const quint32 size = *reinterpret_cast<const quint32 *>(data);
+            if (!(size & QAsyncLogRecord::Padding))
+                writeRecord(reinterpret_cast<const QAsyncLogRecord *>(data));
+            t += size & ~quint32(QAsyncLogRecord::Padding);
+            ring->tail.storeRelease(t);
+        }
+
+        if (const int count = ring->dropped.fetchAndStoreRelaxed(0)) {
+            dropped += count;
+            wrote = true;
+            const QMessageLogContext context(0, 0, 0, "qt.core.logging");
+            QString logMessage = formatLogMessage(QtWarningMsg, context,
+                    QString::fromLatin1("%1 messages were dropped, the logging buffer was full")
+                        .arg(count), 0);
+            writeMessage(QtWarningMsg, context, logMessage);
+        }
+    }
+    writeBatch();
+    return wrote;
+}
+
+void QAsyncMessageOutput::writeRecord(const QAsyncLogRecord *record)
+{
+    const QChar *text = reinterpret_cast<const QChar *>(record + 1);
+    const char *strings = reinterpret_cast<const char *>(text + record->messageSize);
+    const char *category = record->categorySize ? strings : 0;
+    strings += record->categorySize;
+    const char *file = record->fileSize ? strings : 0;
+    strings += record->fileSize;
+    const char *function = record->functionSize ? strings : 0;
+
+    const QtMsgType type = QtMsgType(record->type);
+    const QMessageLogContext context(file, record->line, function, category);
+    QString message;
+    if (!(record->flags & QAsyncLogRecord::NullMessage))
+        message = QString::fromRawData(text, record->messageSize);
+
+    if (record->flags & QAsyncLogRecord::Formatted) {
+        writeMessage(type, context, message);
+    } else {
+        QString logMessage = formatLogMessage(type, context, message, &record->capture);
+        writeMessage(type, context, logMessage);
+    }
+}
+
+void QAsyncMessageOutput::writeMessage(QtMsgType type, const QMessageLogContext &context,
+                                       QString &logMessage)
+{
+    // same as qDefaultMessageHandler, but stderr output is collected
+    if (logMessage.isNull() || systemMessageSink(type, context, logMessage))
+        return;
+    batch += logMessage.toLocal8Bit();
+    batch += '\n';
+    if (batch.size() >= BatchSize)
+        writeBatch();
+}
+
+void QAsyncMessageOutput::writeBatch()
+{
+    if (batch.isEmpty())
+        return;
+    fwrite(batch.constData(), 1, size_t(batch.size()), stderr);
+    fflush(stderr);
+    batch.resize(0);
+}
+
+quint64 QAsyncMessageOutput::droppedCount()
+{
+    QMutexLocker locker(&drainMutex);
+    quint64 count = dropped;
+    for (QAsyncLogRing *ring = rings.loadAcquire(); ring; ring = ring->next)
+        count += ring->dropped.load();
+    return count;
+}
+
+/*
+    Hands a message for the default message handler to the asynchronous
+    output. Returns false if it has to be written synchronously; everything
+    queued before is written first then, so the output stays in order. This
+    is what makes sure that all messages logged before a fatal one appear.
+*/
+static bool postMessage(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    const QMessageOutputMode mode = currentMessageOutputMode();
+    if (mode != QMessageOutputMode::Synchronous && !isFatal(type)) {
+        // create the pattern first, so that it outlives the output
+        qMessagePattern();
+        QAsyncMessageOutput *output = asyncMessageOutput();
+        if (output && output->post(type, context, message,
+                                   mode == QMessageOutputMode::AsynchronousBlocking)) {
+            return true;
+        }
+    }
+    qt_flush_message_output();
+    return false;
+}
+#endif // QLOGGING_HAVE_ASYNC
+
+static bool isDefaultCategoryEnabled(QtMsgType msgType, const QMessageLogContext &context)
 {
 #ifndef QT_BOOTSTRAPPED
     // qDebug, qWarning, ... macros do not check whether category is enabled
     if (!context.category || (strcmp(context.category, "default") == 0)) {
-        if (QLoggingCategory *defaultCategory = QLoggingCategory::defaultCategory()) {
-            if (!defaultCategory->isEnabled(msgType))
+        if (QLoggingCategory *defaultCategory = QLoggingCategory::defaultCategory())
+            return defaultCategory->isEnabled(msgType);
+    }
+#else
+    Q_UNUSED(msgType);
+    Q_UNUSED(context);
+#endif
+    return true;
+}
+
+static inline bool usesDefaultMessageHandler()
+{
+    return messageHandler.load() == qDefaultMessageHandler
+            && msgHandler.load() == qDefaultMsgHandler;
+}
+
+#ifdef QBINARYLOG_HAVE_WRITER
+/*
+    Stores a printf-style message in the binary log (QT_LOGGING_BINARY_FILE)
+    instead of passing it to the default message handler. The format and its
+    arguments are stored as they are and only formatted when the log is
+    decoded. Returns false if the message has to be formatted now.
+*/
+static bool binaryLogFormattedMessage(QtMsgType type, const QMessageLogContext &context,
+                                      const char *format, va_list ap)
+{
+    // fatal messages are printed as well, see qt_message_print()
+    if (isFatal(type) || !usesDefaultMessageHandler())
+        return false;
+    QBinaryLogWriter *writer = QBinaryLogWriter::instance();
+    if (!writer)
+        return false;
+    if (isDefaultCategoryEnabled(type, context))
+        writer->writeFormattedMessage(type, context, quint64(qt_gettid()), format, ap);
+    return true;
+}
+#endif // QBINARYLOG_HAVE_WRITER
+
+static void qt_message_print(QtMsgType msgType, const QMessageLogContext &context, const QString &message)
+{
+    if (!isDefaultCategoryEnabled(msgType, context))
+        return;
+
+#ifdef QBINARYLOG_HAVE_WRITER
+    if (usesDefaultMessageHandler()) {
+        if (QBinaryLogWriter *writer = QBinaryLogWriter::instance()) {
+            writer->writeMessage(msgType, context, quint64(qt_gettid()), message);
+            if (!isFatal(msgType))
                 return;
         }
     }
@@ -1650,6 +2277,12 @@ static void qt_message_print(QtMsgType msgType, const QMessageLogContext &contex
     // prevent recursion in case the message handler generates messages
     // itself, e.g. by using Qt API
     if (grabMessageHandler()) {
+#ifdef QLOGGING_HAVE_ASYNC
+        if (usesDefaultMessageHandler() && postMessage(msgType, context, message)) {
+            ungrabMessageHandler();
+            return;
+        }
+#endif
         // prefer new message handler over the old one
         if (msgHandler.load() == qDefaultMsgHandler
                 || messageHandler.load() != qDefaultMessageHandler) {
@@ -1780,6 +2413,30 @@ void qErrnoWarning(int code, const char *msg, ...)
     Only one message handler can be defined, since this is usually
     done on an application-wide basis to control debug output.
 
+    On Unix, the default message handler can write its output from a
+    background thread, so that logging does not block the calling thread
+    on I/O. This is enabled by setting the \c QT_LOGGING_ASYNC environment
+    variable to \c 1. Each thread that logs then gets a buffer of
+    \c QT_LOGGING_ASYNC_BUFFER_SIZE bytes (64 KiB by default); messages that
+    do not fit while the buffer is full are dropped and counted, and the
+    number of dropped messages is reported in the output. If the variable
+    is set to \c block, the logging thread waits for room instead. Messages
+    logged by one thread keep their order. All queued messages are written
+    before a fatal message, before the message handler or the message
+    pattern is changed, and when the application exits.
+
+    For high-volume logging, the default message handler can instead
+    store messages in a compact binary log, by setting the
+    \c QT_LOGGING_BINARY_FILE environment variable to the name of the file
+    (on Unix). The file is memory-mapped and used as a ring buffer of
+    \c QT_LOGGING_BINARY_SIZE bytes (4 MiB by default), so it always holds
+    the most recent messages, even if the application crashes. Messages are
+    stored with their category, type, time, thread and source location;
+    messages logged with a printf-style format are stored with their
+    arguments and only formatted when the file is decoded with the
+    \c qlogdecode tool. The message pattern does not apply to the binary
+    log. Fatal messages are written to the console as well.
+
     To restore the message handler, call \c qInstallMessageHandler(0).
 
     Example:
@@ -1869,6 +2526,8 @@ QtMessageHandler qInstallMessageHandler(QtMessageHandler h)
 {
     if (!h)
         h = qDefaultMessageHandler;
+    // messages queued for the default handler go out before the new handler sees any
+    qt_flush_message_output();
     //set 'h' and return old message handler
     return messageHandler.fetchAndStoreRelaxed(h);
 }
@@ -1877,18 +2536,88 @@ QtMsgHandler qInstallMsgHandler(QtMsgHandler h)
 {
     if (!h)
         h = qDefaultMsgHandler;
+    qt_flush_message_output();
     //set 'h' and return old message handler
     return msgHandler.fetchAndStoreRelaxed(h);
 }
 
 void qSetMessagePattern(const QString &pattern)
 {
+    // queued messages are formatted with the pattern that was set when they were logged
+    qt_flush_message_output();
+
     QMutexLocker lock(&QMessagePattern::mutex);
 
     if (!qMessagePattern()->fromEnvironment)
         qMessagePattern()->setPattern(pattern);
 }
 
+/*!
+    \internal
+
+    Returns how the default message handler writes its output.
+*/
+QMessageOutputMode qt_message_output_mode()
+{
+#ifdef QLOGGING_HAVE_ASYNC
+    return currentMessageOutputMode();
+#else
+    return QMessageOutputMode::Synchronous;
+#endif
+}
+
+/*!
+    \internal
+
+    Switches the output of the default message handler to \a mode,
+    overriding QT_LOGGING_ASYNC. Has no effect on platforms without
+    asynchronous output.
+*/
+void qt_set_message_output_mode(QMessageOutputMode mode)
+{
+#ifdef QLOGGING_HAVE_ASYNC
+    if (forkedChild)
+        return;
+    messageOutputMode.store(int(mode));
+    if (mode == QMessageOutputMode::Synchronous)
+        qt_flush_message_output();
+#else
+    Q_UNUSED(mode);
+#endif
+}
+
+/*!
+    \internal
+
+    Writes out all messages that were queued for asynchronous output.
+*/
+void qt_flush_message_output()
+{
+#ifdef QLOGGING_HAVE_ASYNC
+    if (!forkedChild && asyncMessageOutput.exists()) {
+        if (QAsyncMessageOutput *output = asyncMessageOutput())
+            output->flush();
+    }
+#endif
+}
+
+/*!
+    \internal
+
+    Returns the number of messages the asynchronous output has dropped
+    because the buffer of the logging thread was full.
+*/
+quint64 qt_dropped_message_count()
+{
+#ifdef QLOGGING_HAVE_ASYNC
+    if (asyncMessageOutput.exists()) {
+        if (QAsyncMessageOutput *output = asyncMessageOutput())
+            return output->droppedCount();
+    }
+#endif
+    return 0;
+}
+
 
 /*!
     Copies context information from \a logContext into this QMessageLogContext
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QTCORE_TRACEPOINTS_P_H
+#define QTCORE_TRACEPOINTS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+/*
+    The tracepoints of QtCore, see qtrace_p.h.
+
+    QT_CORE_TRACEPOINTS is expanded once per tracing backend, with one
+    macro per number of arguments: each entry is the tracepoint name
+    followed by the kind (Pointer or Int) and the name of each argument.
+    Entry and exit tracepoints of the same operation are named _entry and
+    _exit, so that tools can compute the time spent in between. The
+    lateness of a timer is the number of microseconds between the moment
+    it was due and the moment it was activated.
+
+    Tracepoints may be added to this list, but existing ones should keep
+    their names and arguments: trace analysis scripts depend on them.
+*/
+
+#define QT_CORE_TRACEPOINTS(Q_TRACEPOINT0, Q_TRACEPOINT1, Q_TRACEPOINT2, Q_TRACEPOINT3) \
+    Q_TRACEPOINT3(QCoreApplication_notify_entry, Pointer, receiver, Pointer, event, Int, type) \
+    Q_TRACEPOINT1(QCoreApplication_notify_exit, Int, consumed) \
+    Q_TRACEPOINT3(QCoreApplication_postEvent, Pointer, receiver, Pointer, event, Int, type) \
+    Q_TRACEPOINT2(QCoreApplication_postEvent_event_compressed, Pointer, receiver, Pointer, event) \
+    Q_TRACEPOINT2(QCoreApplication_sendPostedEvents_entry, Pointer, receiver, Int, type) \
+    Q_TRACEPOINT0(QCoreApplication_sendPostedEvents_exit) \
+    Q_TRACEPOINT2(QMetaObject_activate_entry, Pointer, sender, Int, signalIndex) \
+    Q_TRACEPOINT0(QMetaObject_activate_exit) \
+    Q_TRACEPOINT2(QMetaObject_activate_slot_entry, Pointer, receiver, Int, slotIndex) \
+    Q_TRACEPOINT0(QMetaObject_activate_slot_exit) \
+    Q_TRACEPOINT2(QThreadPool_start, Pointer, threadPool, Pointer, runnable) \
+    Q_TRACEPOINT1(QThreadPool_runnable_entry, Pointer, runnable) \
+    Q_TRACEPOINT0(QThreadPool_runnable_exit) \
+    Q_TRACEPOINT3(QTimerInfoList_activateTimer_entry, Pointer, receiver, Int, timerId, Int, lateness) \
+    Q_TRACEPOINT0(QTimerInfoList_activateTimer_exit) \
+    Q_TRACEPOINT3(QSocketNotifier_activated_entry, Pointer, notifier, Int, socket, Int, type) \
+    Q_TRACEPOINT0(QSocketNotifier_activated_exit)
+
+#endif // QTCORE_TRACEPOINTS_P_H
@@ -0,0 +1,217 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtCore/private/qglobal_p.h>
+
+#if QT_CONFIG(lttng)
+// instantiate the probes of qtrace_lttng_p.h in this file only
+#  define TRACEPOINT_CREATE_PROBES
+#  define TRACEPOINT_DEFINE
+#endif
+
+#include "qtrace_p.h"
+
+#if QT_CONFIG(tracerecorder)
+#  include "qelapsedtimer.h"
+#  include "qmath.h"
+#  include "qmutex.h"
+#  include "qthread.h"
+#  include <atomic>
+#endif
+
+#if QT_CONFIG(etw)
+// {594b5065-8791-4648-9c29-9abd2db5e29d}
+TRACELOGGING_DEFINE_PROVIDER(qt_etw_qtcore, "QtCore",
+                             (0x594b5065, 0x8791, 0x4648, 0x9c, 0x29, 0x9a, 0xbd, 0x2d, 0xb5, 0xe2, 0x9d));
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#if QT_CONFIG(etw)
+static void registerEtwProvider()
+{
+    TraceLoggingRegister(qt_etw_qtcore);
+}
+Q_CONSTRUCTOR_FUNCTION(registerEtwProvider)
+
+static void unregisterEtwProvider()
+{
+    TraceLoggingUnregister(qt_etw_qtcore);
+}
+Q_DESTRUCTOR_FUNCTION(unregisterEtwProvider)
+#endif // QT_CONFIG(etw)
+
+#if QT_CONFIG(tracerecorder)
+namespace {
+struct TraceSlot
+{
+    // index + 1 of the event in the slot, 0 while it is being written
+    QBasicAtomicInteger<quintptr> sequence;
+    QTraceRecorder::Event event;
+};
+
+struct TraceRing
+{
+    explicit TraceRing(int size)
+        : capacity(size), entries(new TraceSlot[size])
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        next.store(0);
+        for (int i = 0; i < capacity; ++i)
+            entries[i].sequence.store(0);
+        timer.start();
+    }
+
+    const int capacity;     // a power of two
+    QBasicAtomicInteger<quintptr> next;
+    QElapsedTimer timer;
+    TraceSlot *entries;
+};
+}
+
+// the ring that record() writes to, null while not recording
+static QBasicAtomicPointer<TraceRing> recordingRing = Q_BASIC_ATOMIC_INITIALIZER(Q_NULLPTR);
+// the ring of the last recording, protected by recorderMutex
+static TraceRing *lastRing = Q_NULLPTR;
+Q_GLOBAL_STATIC(QMutex, recorderMutex)
+
+/*!
+    \class QTraceRecorder
+    \internal
+
+    The "recorder" tracing backend: while recording, every Q_TRACE appends
+    an event to a ring in memory, which events() returns. Meant for tests,
+    which can then check that code paths fire the expected tracepoints.
+*/
+
+/*!
+    Starts recording, keeping the last \a capacity events (rounded up to a
+    power of two). Earlier events are discarded.
+*/
+void QTraceRecorder::start(int capacity)
+{
+    capacity = int(qNextPowerOfTwo(quint32(qMax(capacity, 2) - 1)));
+
+    QMutexLocker locker(recorderMutex());
+    recordingRing.storeRelease(Q_NULLPTR);
+    if (lastRing && lastRing->capacity == capacity) {
+        lastRing->reset();
+    } else {
+        // a thread may still be writing to the previous ring, so it is
+        // never freed; the recorder is not meant for production use
+        lastRing = new TraceRing(capacity);
+    }
+    recordingRing.storeRelease(lastRing);
+}
+
+/*!
+    Stops recording. The events recorded so far are kept.
+*/
+void QTraceRecorder::stop()
+{
+    QMutexLocker locker(recorderMutex());
+    recordingRing.storeRelease(Q_NULLPTR);
+}
+
+/*!
+    Returns \c true between start() and stop().
+*/
+bool QTraceRecorder::isRecording()
+{
+    return recordingRing.load() != Q_NULLPTR;
+}
+
+/*!
+    Returns the recorded events, oldest first. Events that were being
+    written or overwritten while this function ran are left out.
+*/
+QVector<QTraceRecorder::Event> QTraceRecorder::events()
+{
+    QVector<Event> result;
+    QMutexLocker locker(recorderMutex());
+    const TraceRing *ring = lastRing;
+    if (!ring)
+        return result;
+
+    const quintptr end = ring->next.loadAcquire();
+    const quintptr begin = end > quintptr(ring->capacity) ? end - ring->capacity : 0;
+    result.reserve(int(end - begin));
+    for (quintptr i = begin; i != end; ++i) {
+        const TraceSlot &slot = ring->entries[i & (ring->capacity - 1)];
+        if (slot.sequence.loadAcquire() != i + 1)
+            continue;
+        const Event event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load() == i + 1)
+            result.append(event);
+    }
+    return result;
+}
+
+/*!
+    Appends an event for the tracepoint \a name, with the given arguments,
+    if recording. Called by Q_TRACE.
+*/
+void QTraceRecorder::record(const char *name, quintptr argument0, quintptr argument1,
+                            quintptr argument2)
+{
+    TraceRing *ring = recordingRing.loadAcquire();
+    if (!ring)
+        return;
+
+    const quintptr index = ring->next.fetchAndAddRelaxed(1);
+    TraceSlot &slot = ring->entries[index & (ring->capacity - 1)];
+    slot.sequence.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.name = name;
+    slot.event.timestamp = ring->timer.nsecsElapsed();
+    slot.event.threadId = QThread::currentThreadId();
+    slot.event.arguments[0] = argument0;
+    slot.event.arguments[1] = argument1;
+    slot.event.arguments[2] = argument2;
+    slot.sequence.storeRelease(index + 1);
+}
+#endif // QT_CONFIG(tracerecorder)
+
+QT_END_NAMESPACE
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+/*
+    The LTTng-UST tracepoint provider of QtCore. lttng-ust reads this file
+    several times, with different definitions of TRACEPOINT_EVENT, which is
+    why the include guard allows TRACEPOINT_HEADER_MULTI_READ. qtrace.cpp
+    instantiates the probes.
+
+    Record a session with, for instance:
+
+        lttng create && lttng enable-event -u 'qtcore:*' && lttng start
+*/
+
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER qtcore
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE <QtCore/private/qtrace_lttng_p.h>
+
+#if !defined(QTRACE_LTTNG_P_H) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define QTRACE_LTTNG_P_H
+
+#include <lttng/tracepoint.h>
+#include "qtcore_tracepoints_p.h"
+
+#define Q_TRACE_LTTNG_ARGUMENT_Pointer(a) const void *, a
+#define Q_TRACE_LTTNG_ARGUMENT_Int(a) int, a
+#define Q_TRACE_LTTNG_FIELD_Pointer(a) ctf_integer_hex(uintptr_t, a, reinterpret_cast<uintptr_t>(a))
+#define Q_TRACE_LTTNG_FIELD_Int(a) ctf_integer(int, a, a)
+
+#define Q_TRACE_LTTNG_EVENT0(name) \
+    TRACEPOINT_EVENT(qtcore, name, TP_ARGS(), TP_FIELDS())
+#define Q_TRACE_LTTNG_EVENT1(name, k1, a1) \
+    TRACEPOINT_EVENT(qtcore, name, \
+                     TP_ARGS(Q_TRACE_LTTNG_ARGUMENT_##k1(a1)), \
+                     TP_FIELDS(Q_TRACE_LTTNG_FIELD_##k1(a1)))
+#define Q_TRACE_LTTNG_EVENT2(name, k1, a1, k2, a2) \
+    TRACEPOINT_EVENT(qtcore, name, \
+                     TP_ARGS(Q_TRACE_LTTNG_ARGUMENT_##k1(a1), Q_TRACE_LTTNG_ARGUMENT_##k2(a2)), \
+                     TP_FIELDS(Q_TRACE_LTTNG_FIELD_##k1(a1) Q_TRACE_LTTNG_FIELD_##k2(a2)))
+#define Q_TRACE_LTTNG_EVENT3(name, k1, a1, k2, a2, k3, a3) \
+    TRACEPOINT_EVENT(qtcore, name, \
+                     TP_ARGS(Q_TRACE_LTTNG_ARGUMENT_##k1(a1), Q_TRACE_LTTNG_ARGUMENT_##k2(a2), \
+                             Q_TRACE_LTTNG_ARGUMENT_##k3(a3)), \
+                     TP_FIELDS(Q_TRACE_LTTNG_FIELD_##k1(a1) Q_TRACE_LTTNG_FIELD_##k2(a2) \
+                               Q_TRACE_LTTNG_FIELD_##k3(a3)))
+
+QT_CORE_TRACEPOINTS(Q_TRACE_LTTNG_EVENT0, Q_TRACE_LTTNG_EVENT1, Q_TRACE_LTTNG_EVENT2,
+                    Q_TRACE_LTTNG_EVENT3)
+
+#endif // QTRACE_LTTNG_P_H
+
+#include <lttng/tracepoint-event.h>
@@ -0,0 +1,219 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QTRACE_P_H
+#define QTRACE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+/*
+    Static tracepoints.
+
+    Q_TRACE(tracepoint, arguments...) fires one of the tracepoints listed
+    in qtcore_tracepoints_p.h. Q_TRACE_ENABLED(tracepoint) returns whether
+    a tracing session listens to it, and can be used to avoid computing
+    arguments that are only needed by the tracepoint.
+
+    The backend is chosen at configure time with -trace:
+
+    - lttng: LTTng-UST tracepoints in the "qtcore" provider, see
+      qtrace_lttng_p.h (Linux only);
+    - etw: TraceLogging events of the "QtCore" provider (Windows only);
+    - recorder: an in-memory ring of events that QTraceRecorder exposes,
+      meant for tests;
+    - no (the default): Q_TRACE expands to nothing, and its arguments are
+      not evaluated.
+*/
+
+#include <QtCore/private/qglobal_p.h>
+
+#if QT_CONFIG(lttng) || QT_CONFIG(etw) || QT_CONFIG(tracerecorder)
+#  define Q_TRACE(tracepoint, ...) QT_PREPEND_NAMESPACE(QtPrivate)::trace_##tracepoint(__VA_ARGS__)
+#  define Q_TRACE_ENABLED(tracepoint) QT_PREPEND_NAMESPACE(QtPrivate)::trace_##tracepoint##_enabled()
+#else
+#  define Q_TRACE(tracepoint, ...) do { } while (false)
+#  define Q_TRACE_ENABLED(tracepoint) false
+#endif
+
+#if QT_CONFIG(lttng) || QT_CONFIG(etw) || QT_CONFIG(tracerecorder)
+
+#include "qtcore_tracepoints_p.h"
+
+#if QT_CONFIG(lttng)
+#  include "qtrace_lttng_p.h"
+#elif QT_CONFIG(etw)
+#  include <QtCore/qt_windows.h>
+#  include <TraceLoggingProvider.h>
+TRACELOGGING_DECLARE_PROVIDER(qt_etw_qtcore);
+#else
+#  include <QtCore/qvector.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#if QT_CONFIG(tracerecorder)
+class Q_CORE_EXPORT QTraceRecorder
+{
+public:
+    struct Event {
+        const char *name;       // the tracepoint
+        qint64 timestamp;       // nanoseconds since start()
+        Qt::HANDLE threadId;
+        quintptr arguments[3];
+    };
+
+    static void start(int capacity = 65536);
+    static void stop();
+    static bool isRecording();
+    static QVector<Event> events();
+
+    static void record(const char *name, quintptr argument0 = 0, quintptr argument1 = 0,
+                       quintptr argument2 = 0);
+};
+Q_DECLARE_TYPEINFO(QTraceRecorder::Event, Q_PRIMITIVE_TYPE);
+#endif
+
+namespace QtPrivate {
+
+#define Q_TRACE_TYPE_Pointer const void *
+#define Q_TRACE_TYPE_Int int
+
+#if QT_CONFIG(lttng)
+
+#define Q_TRACE_FUNCTION0(name) \
+    inline void trace_##name() \
+    { tracepoint(qtcore, name); } \
+    inline bool trace_##name##_enabled() \
+    { return tracepoint_enabled(qtcore, name); }
+#define Q_TRACE_FUNCTION1(name, k1, a1) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1) \
+    { tracepoint(qtcore, name, a1); } \
+    inline bool trace_##name##_enabled() \
+    { return tracepoint_enabled(qtcore, name); }
+#define Q_TRACE_FUNCTION2(name, k1, a1, k2, a2) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2) \
+    { tracepoint(qtcore, name, a1, a2); } \
+    inline bool trace_##name##_enabled() \
+    { return tracepoint_enabled(qtcore, name); }
+#define Q_TRACE_FUNCTION3(name, k1, a1, k2, a2, k3, a3) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2, Q_TRACE_TYPE_##k3 a3) \
+    { tracepoint(qtcore, name, a1, a2, a3); } \
+    inline bool trace_##name##_enabled() \
+    { return tracepoint_enabled(qtcore, name); }
+
+#elif QT_CONFIG(etw)
+
+#define Q_TRACE_ETW_Pointer(a) TraceLoggingPointer(a, #a)
+#define Q_TRACE_ETW_Int(a) TraceLoggingInt32(a, #a)
+
+#define Q_TRACE_FUNCTION0(name) \
+    inline void trace_##name() \
+    { TraceLoggingWrite(qt_etw_qtcore, #name); } \
+    inline bool trace_##name##_enabled() \
+    { return TraceLoggingProviderEnabled(qt_etw_qtcore, 0, 0); }
+#define Q_TRACE_FUNCTION1(name, k1, a1) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1) \
+    { TraceLoggingWrite(qt_etw_qtcore, #name, Q_TRACE_ETW_##k1(a1)); } \
+    inline bool trace_##name##_enabled() \
+    { return TraceLoggingProviderEnabled(qt_etw_qtcore, 0, 0); }
+#define Q_TRACE_FUNCTION2(name, k1, a1, k2, a2) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2) \
+    { TraceLoggingWrite(qt_etw_qtcore, #name, Q_TRACE_ETW_##k1(a1), Q_TRACE_ETW_##k2(a2)); } \
+    inline bool trace_##name##_enabled() \
+    { return TraceLoggingProviderEnabled(qt_etw_qtcore, 0, 0); }
+#define Q_TRACE_FUNCTION3(name, k1, a1, k2, a2, k3, a3) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2, Q_TRACE_TYPE_##k3 a3) \
+    { TraceLoggingWrite(qt_etw_qtcore, #name, Q_TRACE_ETW_##k1(a1), Q_TRACE_ETW_##k2(a2), \
+                        Q_TRACE_ETW_##k3(a3)); } \
+    inline bool trace_##name##_enabled() \
+    { return TraceLoggingProviderEnabled(qt_etw_qtcore, 0, 0); }
+
+#else // tracerecorder
+
+#define Q_TRACE_RECORD_Pointer(a) quintptr(a)
+#define Q_TRACE_RECORD_Int(a) quintptr(qintptr(a))
+
+#define Q_TRACE_FUNCTION0(name) \
+    inline void trace_##name() \
+    { QTraceRecorder::record(#name); } \
+    inline bool trace_##name##_enabled() \
+    { return QTraceRecorder::isRecording(); }
+#define Q_TRACE_FUNCTION1(name, k1, a1) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1) \
+    { QTraceRecorder::record(#name, Q_TRACE_RECORD_##k1(a1)); } \
+    inline bool trace_##name##_enabled() \
+    { return QTraceRecorder::isRecording(); }
+#define Q_TRACE_FUNCTION2(name, k1, a1, k2, a2) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2) \
+    { QTraceRecorder::record(#name, Q_TRACE_RECORD_##k1(a1), Q_TRACE_RECORD_##k2(a2)); } \
+    inline bool trace_##name##_enabled() \
+    { return QTraceRecorder::isRecording(); }
+#define Q_TRACE_FUNCTION3(name, k1, a1, k2, a2, k3, a3) \
+    inline void trace_##name(Q_TRACE_TYPE_##k1 a1, Q_TRACE_TYPE_##k2 a2, Q_TRACE_TYPE_##k3 a3) \
+    { QTraceRecorder::record(#name, Q_TRACE_RECORD_##k1(a1), Q_TRACE_RECORD_##k2(a2), \
+                             Q_TRACE_RECORD_##k3(a3)); } \
+    inline bool trace_##name##_enabled() \
+    { return QTraceRecorder::isRecording(); }
+
+#endif
+
+QT_CORE_TRACEPOINTS(Q_TRACE_FUNCTION0, Q_TRACE_FUNCTION1, Q_TRACE_FUNCTION2, Q_TRACE_FUNCTION3)
+
+#undef Q_TRACE_FUNCTION0
+#undef Q_TRACE_FUNCTION1
+#undef Q_TRACE_FUNCTION2
+#undef Q_TRACE_FUNCTION3
+
+} // namespace QtPrivate
+
+QT_END_NAMESPACE
+
+#endif // QT_CONFIG(lttng) || QT_CONFIG(etw) || QT_CONFIG(tracerecorder)
+
+#endif // QTRACE_P_H
@@ -40,7 +40,10 @@
 // these might be defined via precompiled headers
 #include <QtCore/qatomic.h>
 
-#define FORKFD_NO_SPAWNFD
+// QProcess only uses spawnfd() with glibc, see qprocess_unix.cpp
+#if !defined(__GLIBC__) || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 24)
+#  define FORKFD_NO_SPAWNFD
+#endif
 
 #if defined(QT_NO_DEBUG) && !defined(NDEBUG)
 #  define NDEBUG
@@ -2,6 +2,8 @@
 
 HEADERS +=  \
         io/qabstractfileengine_p.h \
+        io/qasyncfileio.h \
+        io/qasyncfileio_p.h \
         io/qbuffer.h \
         io/qdatastream.h \
         io/qdatastream_p.h \
@@ -29,6 +31,7 @@ HEADERS +=  \
         io/qtemporaryfile_p.h \
         io/qresource_p.h \
         io/qresource_iterator_p.h \
+        io/qresourceindex_p.h \
         io/qsavefile.h \
         io/qstandardpaths.h \
         io/qstorageinfo.h \
@@ -56,6 +59,7 @@ HEADERS +=  \
 
 SOURCES += \
         io/qabstractfileengine.cpp \
+        io/qasyncfileio.cpp \
         io/qbuffer.cpp \
         io/qdatastream.cpp \
         io/qdataurl.cpp \
@@ -100,6 +104,11 @@ qtConfig(processenvironment) {
         io/qprocess.h \
         io/qprocess_p.h
 
+    qtConfig(process) {
+        SOURCES += io/qprocesspipeline.cpp
+        HEADERS += io/qprocesspipeline.h
+    }
+
     win32:!winrt: \
         SOURCES += io/qprocess_win.cpp
     else: unix: \
@@ -187,6 +196,9 @@ win32 {
             HEADERS += io/qfilesystemwatcher_inotify_p.h
         }
 
+        qtConfig(io_uring): \
+            SOURCES += io/qasyncfileio_uring.cpp
+
         !nacl {
             freebsd-*|mac|darwin-*|openbsd-*|netbsd-*:{
                 SOURCES += io/qfilesystemwatcher_kqueue.cpp
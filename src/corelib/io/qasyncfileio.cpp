@@ -0,0 +1,517 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qasyncfileio.h"
+#include "qasyncfileio_p.h"
+
+#include "qplatformdefs.h"
+#include "qdeadlinetimer.h"
+#include "qpointer.h"
+#include "qrunnable.h"
+#include "qthread.h"
+#include "qthreadpool.h"
+#include "qtimer.h"
+#include "private/qbytearray_p.h"
+
+#include <errno.h>
+
+#ifdef Q_OS_WIN
+#  include <qt_windows.h>
+#  include <io.h>
+#endif
+
+#if defined(QT_USE_XOPEN_LFS_EXTENSIONS) && defined(QT_LARGEFILE_SUPPORT)
+#  define QT_PREAD ::pread64
+#  define QT_PWRITE ::pwrite64
+#else
+#  define QT_PREAD ::pread
+#  define QT_PWRITE ::pwrite
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+// The requests block a thread each, so they get a pool of their own
+// instead of competing with the users of the global one.
+class QAsyncFileIOThreadPool : public QThreadPool
+{
+public:
+    QAsyncFileIOThreadPool()
+    {
+        setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+    }
+};
+
+class QAsyncFileIOTask : public QRunnable
+{
+public:
+    QAsyncFileIOTask(QAsyncFileIOThreadPoolBackend *backend, QAsyncFileIORequest *request)
+        : backend(backend), request(request)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QAsyncFileIOThreadPoolBackend::perform(request);
+        backend->finished(request);
+    }
+
+private:
+    QAsyncFileIOThreadPoolBackend *backend;
+    QAsyncFileIORequest *request;
+};
+}
+
+Q_GLOBAL_STATIC(QAsyncFileIOThreadPool, asyncFileIOThreadPool)
+
+QAsyncFileIOThreadPoolBackend::QAsyncFileIOThreadPoolBackend(QAsyncFileIOPrivate *d)
+    : QAsyncFileIOBackend(d), inFlight(0)
+{
+}
+
+void QAsyncFileIOThreadPoolBackend::submit(const QVector<QAsyncFileIORequest *> &requests)
+{
+    QThreadPool *pool = asyncFileIOThreadPool();
+    {
+        QMutexLocker locker(&mutex);
+        inFlight += requests.size();
+    }
+    for (QAsyncFileIORequest *request : requests)
+        pool->start(new QAsyncFileIOTask(this, request));
+}
+
+bool QAsyncFileIOThreadPoolBackend::waitForCompletions(int msecs)
+{
+    QDeadlineTimer deadline(msecs);
+    QMutexLocker locker(&d->completionMutex);
+    while (d->completed.isEmpty()) {
+        if (deadline.hasExpired())
+            return false;
+        const qint64 remaining = deadline.remainingTime();
+        d->completionCondition.wait(&d->completionMutex,
+                                    remaining < 0 ? ULONG_MAX : (unsigned long)remaining);
+    }
+    return true;
+}
+
+void QAsyncFileIOThreadPoolBackend::waitForIdle()
+{
+    QMutexLocker locker(&mutex);
+    while (inFlight > 0)
+        idleCondition.wait(&mutex);
+}
+
+void QAsyncFileIOThreadPoolBackend::finished(QAsyncFileIORequest *request)
+{
+    d->completeRequest(request);
+
+    QMutexLocker locker(&mutex);
+    if (--inFlight == 0)
+        idleCondition.wakeAll();
+}
+
+void QAsyncFileIOThreadPoolBackend::perform(QAsyncFileIORequest *request)
+{
+    const bool reading = request->operation == QAsyncFileIORequest::Read;
+    char *data = reading ? request->buffer.data() : const_cast<char *>(request->buffer.constData());
+
+    while (request->done < request->size) {
+        const qint64 offset = request->offset + request->done;
+        const qint64 chunk = request->size - request->done;
+#ifdef Q_OS_WIN
+        HANDLE handle = HANDLE(_get_osfhandle(request->fd));
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = DWORD(offset);
+        overlapped.OffsetHigh = DWORD(offset >> 32);
+        const DWORD toTransfer = DWORD(qMin<qint64>(chunk, 0x7fffffff));
+        DWORD transferred = 0;
+        const BOOL ok = reading
+                ? ReadFile(handle, data + request->done, toTransfer, &transferred, &overlapped)
+                : WriteFile(handle, data + request->done, toTransfer, &transferred, &overlapped);
+        if (!ok) {
+            const DWORD error = GetLastError();
+            if (error == ERROR_HANDLE_EOF)
+                break;
+            request->errorCode = int(error);
+            break;
+        }
+        const qint64 n = transferred;
+#else
+        const size_t toTransfer = size_t(qMin<qint64>(chunk, SSIZE_MAX));
+        const qint64 n = reading
+                ? QT_PREAD(request->fd, data + request->done, toTransfer, QT_OFF_T(offset))
+                : QT_PWRITE(request->fd, data + request->done, toTransfer, QT_OFF_T(offset));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            request->errorCode = errno;
+            break;
+        }
+#endif
+        if (n == 0)
+            break; // end of file
+        request->done += n;
+    }
+
+    if (request->errorCode)
+        request->error = reading ? QFileDevice::ReadError : QFileDevice::WriteError;
+}
+
+QAsyncFileIOPrivate::QAsyncFileIOPrivate()
+    : backend(0), backendType(QAsyncFileIO::ThreadPoolBackend),
+      nextId(0), pending(0), deliveryScheduled(false)
+{
+}
+
+QAsyncFileIOPrivate::~QAsyncFileIOPrivate()
+{
+    // the backend was shut down by ~QAsyncFileIO already
+    Q_ASSERT(!backend);
+    qDeleteAll(queued);
+    qDeleteAll(completed);
+}
+
+void QAsyncFileIOPrivate::init()
+{
+#if QT_CONFIG(io_uring)
+    if (!qEnvironmentVariableIsSet("QT_NO_IO_URING")) {
+        backend = QAsyncFileIOUringBackend::create(this);
+        if (backend)
+            backendType = QAsyncFileIO::IoUringBackend;
+    }
+#endif
+    if (!backend)
+        backend = new QAsyncFileIOThreadPoolBackend(this);
+}
+
+int QAsyncFileIOPrivate::enqueue(QAsyncFileIORequest *request)
+{
+    Q_Q(QAsyncFileIO);
+    request->id = nextId;
+    nextId = nextId == INT_MAX ? 0 : nextId + 1;
+    request->done = 0;
+    request->errorCode = 0;
+    request->error = QFileDevice::NoError;
+    ++pending;
+
+    if (request->fd == -1) {
+        request->error = QFileDevice::OpenError;
+        completeRequest(request);
+        return request->id;
+    }
+
+    // everything requested before control returns to the event loop is
+    // handed to the backend at once
+    if (queued.isEmpty())
+        QTimer::singleShot(0, q, [q]() { q->submit(); });
+    queued.append(request);
+    return request->id;
+}
+
+void QAsyncFileIOPrivate::completeRequest(QAsyncFileIORequest *request, bool scheduleDelivery)
+{
+    Q_Q(QAsyncFileIO);
+    QMutexLocker locker(&completionMutex);
+    completed.append(request);
+    completionCondition.wakeAll();
+    if (scheduleDelivery && !deliveryScheduled) {
+        deliveryScheduled = true;
+        QMetaObject::invokeMethod(q, "_q_deliverCompletions", Qt::QueuedConnection);
+    }
+}
+
+bool QAsyncFileIOPrivate::hasCompletions()
+{
+    QMutexLocker locker(&completionMutex);
+    return !completed.isEmpty();
+}
+
+void QAsyncFileIOPrivate::_q_deliverCompletions()
+{
+    Q_Q(QAsyncFileIO);
+    QVector<QAsyncFileIORequest *> requests;
+    {
+        QMutexLocker locker(&completionMutex);
+        requests.swap(completed);
+        deliveryScheduled = false;
+    }
+
+    // receivers may delete the object
+    QPointer<QAsyncFileIO> guard(q);
+    for (QAsyncFileIORequest *request : qAsConst(requests)) {
+        QScopedPointer<QAsyncFileIORequest> cleanup(request);
+        if (!guard)
+            continue;
+        --pending;
+        if (request->error != QFileDevice::NoError) {
+            const QString errorString = request->errorCode
+                    ? qt_error_string(request->errorCode)
+                    : QAsyncFileIO::tr("File is not open");
+            emit q->errorOccurred(request->id, request->error, errorString);
+        } else if (request->operation == QAsyncFileIORequest::Read) {
+            request->buffer.resize(int(request->done));
+            emit q->readFinished(request->id, request->buffer);
+        } else {
+            emit q->writeFinished(request->id, request->done);
+        }
+    }
+}
+
+/*!
+    \class QAsyncFileIO
+    \inmodule QtCore
+    \brief The QAsyncFileIO class reads and writes files without blocking the calling thread.
+    \since 5.10
+    \ingroup io
+    \reentrant
+
+    QAsyncFileIO performs positioned reads and writes on open files in the
+    background, and reports their results through signals in the thread
+    the object lives in. This allows an application to do file I/O from a
+    thread that runs an event loop, without blocking that event loop.
+
+    Each call to read() or write() returns an identifier for the request.
+    When the request has finished, readFinished() or writeFinished() is
+    emitted with that identifier, or errorOccurred() if it failed. The
+    signals of requests that are processed concurrently may be emitted in
+    any order.
+
+    All requests made before control returns to the event loop are
+    submitted together. submit() submits the requests made so far right
+    away, and waitForFinished() blocks until all of them have finished.
+
+    On Linux, the requests are carried out by the kernel through io_uring
+    if it is available; otherwise they are carried out by a pool of
+    threads. backend() tells which is used. Setting the environment
+    variable \c QT_NO_IO_URING disables the use of io_uring.
+
+    The requests operate on the native file handle of the device, at the
+    given offset. They bypass the buffer and the current position of the
+    device, so the device should be opened with QIODevice::Unbuffered if
+    it is also read or written directly. The device must stay open until
+    all requests for it have finished.
+
+    \sa QFile, QFileDevice::handle()
+*/
+
+/*!
+    \enum QAsyncFileIO::Backend
+
+    This enum describes how the requests are carried out.
+
+    \value ThreadPoolBackend The requests are carried out by blocking
+    reads and writes in a pool of threads.
+    \value IoUringBackend The requests are submitted to the Linux kernel
+    through io_uring.
+*/
+
+/*!
+    Constructs an asynchronous file I/O object with the given \a parent.
+*/
+QAsyncFileIO::QAsyncFileIO(QObject *parent)
+    : QObject(*new QAsyncFileIOPrivate, parent)
+{
+    d_func()->init();
+}
+
+/*!
+    Destroys the object. This blocks until all requests that were already
+    submitted have finished; their results are discarded. Requests that
+    were not submitted yet are dropped.
+*/
+QAsyncFileIO::~QAsyncFileIO()
+{
+    Q_D(QAsyncFileIO);
+    // the backend may own children of this object, and the kernel or the
+    // worker threads may still be writing into the buffers of the requests
+    d->backend->waitForIdle();
+    delete d->backend;
+    d->backend = 0;
+}
+
+/*!
+    Returns the backend used to carry out the requests.
+*/
+QAsyncFileIO::Backend QAsyncFileIO::backend() const
+{
+    Q_D(const QAsyncFileIO);
+    return d->backendType;
+}
+
+static int nativeHandle(QFileDevice *file, QIODevice::OpenModeFlag mode)
+{
+    if (!file || !(file->openMode() & mode))
+        return -1;
+    return file->handle();
+}
+
+/*!
+    Requests to read up to \a maxSize bytes from \a file, starting at
+    \a offset. Returns the identifier of the request, or -1 if the
+    arguments are invalid.
+
+    readFinished() is emitted with the data when the request has finished.
+    It contains less than \a maxSize bytes only if the end of the file was
+    reached.
+
+    \sa write(), readFinished()
+*/
+int QAsyncFileIO::read(QFileDevice *file, qint64 offset, qint64 maxSize)
+{
+    Q_D(QAsyncFileIO);
+    if (offset < 0 || maxSize < 0) {
+        qWarning("QAsyncFileIO::read: Negative offset or size");
+        return -1;
+    }
+    if (maxSize >= MaxByteArraySize) {
+        qWarning("QAsyncFileIO::read: maxSize argument exceeds QByteArray size limit");
+        return -1;
+    }
+
+    QAsyncFileIORequest *request = new QAsyncFileIORequest;
+    request->operation = QAsyncFileIORequest::Read;
+    request->fd = nativeHandle(file, QIODevice::ReadOnly);
+    request->offset = offset;
+    request->size = maxSize;
+    if (request->fd != -1)
+        request->buffer.resize(int(maxSize));
+    return d->enqueue(request);
+}
+
+/*!
+    Requests to write \a data to \a file, starting at \a offset. Returns
+    the identifier of the request, or -1 if \a offset is invalid.
+
+    writeFinished() is emitted when the request has finished.
+
+    \sa read(), writeFinished()
+*/
+int QAsyncFileIO::write(QFileDevice *file, qint64 offset, const QByteArray &data)
+{
+    Q_D(QAsyncFileIO);
+    if (offset < 0) {
+        qWarning("QAsyncFileIO::write: Negative offset");
+        return -1;
+    }
+
+    QAsyncFileIORequest *request = new QAsyncFileIORequest;
+    request->operation = QAsyncFileIORequest::Write;
+    request->fd = nativeHandle(file, QIODevice::WriteOnly);
+    request->offset = offset;
+    request->size = data.size();
+    request->buffer = data;
+    return d->enqueue(request);
+}
+
+/*!
+    Submits all requests made so far, instead of waiting for control to
+    return to the event loop.
+*/
+void QAsyncFileIO::submit()
+{
+    Q_D(QAsyncFileIO);
+    if (d->queued.isEmpty())
+        return;
+    QVector<QAsyncFileIORequest *> requests;
+    requests.swap(d->queued);
+    d->backend->submit(requests);
+}
+
+/*!
+    Returns the number of requests whose results have not been reported
+    yet.
+*/
+int QAsyncFileIO::pendingRequests() const
+{
+    Q_D(const QAsyncFileIO);
+    return d->pending;
+}
+
+/*!
+    Submits the requests made so far, and blocks until all requests have
+    finished and their results have been reported, or until \a msecs
+    milliseconds have passed. If \a msecs is -1, this function will not
+    time out.
+
+    Returns \c true if all requests have finished; otherwise returns
+    \c false.
+*/
+bool QAsyncFileIO::waitForFinished(int msecs)
+{
+    Q_D(QAsyncFileIO);
+    submit();
+
+    QDeadlineTimer deadline(msecs);
+    while (d->pending > 0) {
+        if (!d->hasCompletions() && !d->backend->waitForCompletions(int(deadline.remainingTime())))
+            return false;
+        d->_q_deliverCompletions();
+    }
+    return true;
+}
+
+/*!
+    \fn void QAsyncFileIO::readFinished(int id, const QByteArray &data)
+
+    This signal is emitted when the read request \a id has finished, with
+    the \a data that was read.
+*/
+
+/*!
+    \fn void QAsyncFileIO::writeFinished(int id, qint64 bytesWritten)
+
+    This signal is emitted when the write request \a id has finished.
+    \a bytesWritten is the size of the data that was written; it is less
+    than the size of the data only if the device ran out of space.
+*/
+
+/*!
+    \fn void QAsyncFileIO::errorOccurred(int id, QFileDevice::FileError error, const QString &errorString)
+
+    This signal is emitted when the request \a id has failed. \a error
+    is QFileDevice::ReadError or QFileDevice::WriteError if the operating
+    system reported a failure, which is described by \a errorString, and
+    QFileDevice::OpenError if the device was not open in the mode the
+    request needs.
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qasyncfileio.cpp"
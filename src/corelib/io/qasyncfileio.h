@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QASYNCFILEIO_H
+#define QASYNCFILEIO_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qfiledevice.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAsyncFileIOPrivate;
+
+class Q_CORE_EXPORT QAsyncFileIO : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QAsyncFileIO)
+
+public:
+    enum Backend {
+        ThreadPoolBackend,
+        IoUringBackend
+    };
+    Q_ENUM(Backend)
+
+    explicit QAsyncFileIO(QObject *parent = Q_NULLPTR);
+    ~QAsyncFileIO();
+
+    Backend backend() const;
+
+    int read(QFileDevice *file, qint64 offset, qint64 maxSize);
+    int write(QFileDevice *file, qint64 offset, const QByteArray &data);
+    void submit();
+
+    int pendingRequests() const;
+    bool waitForFinished(int msecs = 30000);
+
+Q_SIGNALS:
+    void readFinished(int id, const QByteArray &data);
+    void writeFinished(int id, qint64 bytesWritten);
+    void errorOccurred(int id, QFileDevice::FileError error, const QString &errorString);
+
+private:
+    Q_DISABLE_COPY(QAsyncFileIO)
+    Q_PRIVATE_SLOT(d_func(), void _q_deliverCompletions())
+};
+
+QT_END_NAMESPACE
+
+#endif // QASYNCFILEIO_H
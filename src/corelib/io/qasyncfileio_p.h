@@ -0,0 +1,202 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QASYNCFILEIO_P_H
+#define QASYNCFILEIO_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qasyncfileio.h"
+
+#include <private/qobject_p.h>
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qwaitcondition.h>
+
+QT_BEGIN_NAMESPACE
+
+struct QAsyncFileIORequest
+{
+    enum Operation {
+        Read,
+        Write
+    };
+
+    int id;
+    Operation operation;
+    int fd;
+    qint64 offset;
+    qint64 size;            // bytes requested
+    qint64 done;            // bytes transferred so far
+    QByteArray buffer;
+    int errorCode;          // errno-style code of the failure, 0 on success
+    QFileDevice::FileError error;
+};
+
+class QAsyncFileIOPrivate;
+
+class QAsyncFileIOBackend
+{
+public:
+    explicit QAsyncFileIOBackend(QAsyncFileIOPrivate *d) : d(d) {}
+    virtual ~QAsyncFileIOBackend() {}
+
+    // starts the given requests; each of them is eventually handed back
+    // through QAsyncFileIOPrivate::completeRequest()
+    virtual void submit(const QVector<QAsyncFileIORequest *> &requests) = 0;
+    // blocks until at least one request was completed or msecs have passed
+    virtual bool waitForCompletions(int msecs) = 0;
+    // blocks until no request is in flight anymore
+    virtual void waitForIdle() = 0;
+
+protected:
+    QAsyncFileIOPrivate *d;
+};
+
+class QAsyncFileIOThreadPoolBackend : public QAsyncFileIOBackend
+{
+public:
+    explicit QAsyncFileIOThreadPoolBackend(QAsyncFileIOPrivate *d);
+
+    void submit(const QVector<QAsyncFileIORequest *> &requests) Q_DECL_OVERRIDE;
+    bool waitForCompletions(int msecs) Q_DECL_OVERRIDE;
+    void waitForIdle() Q_DECL_OVERRIDE;
+
+    static void perform(QAsyncFileIORequest *request);
+    void finished(QAsyncFileIORequest *request);
+
+private:
+    QMutex mutex;
+    QWaitCondition idleCondition;
+    int inFlight;
+};
+
+#if QT_CONFIG(io_uring)
+class QSocketNotifier;
+
+class QAsyncFileIOUringBackend : public QAsyncFileIOBackend
+{
+public:
+    ~QAsyncFileIOUringBackend();
+
+    static QAsyncFileIOUringBackend *create(QAsyncFileIOPrivate *d);
+
+    void submit(const QVector<QAsyncFileIORequest *> &requests) Q_DECL_OVERRIDE;
+    bool waitForCompletions(int msecs) Q_DECL_OVERRIDE;
+    void waitForIdle() Q_DECL_OVERRIDE;
+
+    void eventFdActivated();
+
+private:
+    explicit QAsyncFileIOUringBackend(QAsyncFileIOPrivate *d);
+    bool setup(unsigned entries);
+    int submitBacklog();
+    int reap();
+
+    int ringFd;
+    int eventFd;
+    QSocketNotifier *notifier;
+
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    void *sqeArray;
+    size_t sqeArraySize;
+
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqRingMask;
+    unsigned *sqIndexArray;
+    unsigned sqEntries;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqRingMask;
+    void *cqes;
+
+    // requests that did not fit into the submission queue yet, and
+    // requests that have to be resubmitted after a short transfer
+    QVector<QAsyncFileIORequest *> backlog;
+    int inFlight;
+};
+#endif // QT_CONFIG(io_uring)
+
+class QAsyncFileIOPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QAsyncFileIO)
+
+public:
+    QAsyncFileIOPrivate();
+    ~QAsyncFileIOPrivate();
+    void init();
+
+    int enqueue(QAsyncFileIORequest *request);
+    // thread-safe
+    void completeRequest(QAsyncFileIORequest *request, bool scheduleDelivery = true);
+    bool hasCompletions();
+
+    // private slots
+    void _q_deliverCompletions();
+
+    QAsyncFileIOBackend *backend;
+    QAsyncFileIO::Backend backendType;
+
+    QVector<QAsyncFileIORequest *> queued;
+    int nextId;
+    int pending;            // requests handed out but not delivered yet
+
+    QMutex completionMutex;
+    QWaitCondition completionCondition;
+    QVector<QAsyncFileIORequest *> completed;
+    bool deliveryScheduled;
+};
+
+QT_END_NAMESPACE
+
+#endif // QASYNCFILEIO_P_H
@@ -0,0 +1,354 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qasyncfileio_p.h"
+
+#include "qdeadlinetimer.h"
+#include "qsocketnotifier.h"
+#include "qvarlengtharray.h"
+#include "private/qcore_unix_p.h"
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+QT_BEGIN_NAMESPACE
+
+// glibc has no wrappers for the io_uring system calls
+static int qt_io_uring_setup(unsigned entries, io_uring_params *params)
+{
+    return int(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int qt_io_uring_enter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    int ret;
+    EINTR_LOOP(ret, int(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, 0, 0)));
+    return ret;
+}
+
+static int qt_io_uring_register(int fd, unsigned opcode, void *arg, unsigned count)
+{
+    return int(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// IORING_OP_READ and IORING_OP_WRITE need Linux 5.6, older kernels fail
+// every such request with EINVAL; the probe itself is as old as they are
+static bool qt_io_uring_supports_read_write(int fd)
+{
+    const unsigned opCount = 256;
+    QVarLengthArray<char, 2048> buffer(int(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op)));
+    memset(buffer.data(), 0, size_t(buffer.size()));
+    io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+    if (qt_io_uring_register(fd, IORING_REGISTER_PROBE, probe, opCount) < 0)
+        return false;
+
+    const auto supported = [probe](unsigned op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+}
+
+// the head and tail indexes are shared with the kernel
+static inline unsigned loadAcquire(const unsigned *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease(unsigned *p, unsigned value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+QAsyncFileIOUringBackend::QAsyncFileIOUringBackend(QAsyncFileIOPrivate *d)
+    : QAsyncFileIOBackend(d),
+      ringFd(-1), eventFd(-1), notifier(0),
+      sqRing(MAP_FAILED), sqRingSize(0),
+      cqRing(MAP_FAILED), cqRingSize(0),
+      sqeArray(MAP_FAILED), sqeArraySize(0),
+      sqHead(0), sqTail(0), sqRingMask(0), sqIndexArray(0), sqEntries(0),
+      cqHead(0), cqTail(0), cqRingMask(0), cqes(0),
+      inFlight(0)
+{
+}
+
+QAsyncFileIOUringBackend::~QAsyncFileIOUringBackend()
+{
+    qDeleteAll(backlog);
+    delete notifier;
+    if (eventFd != -1)
+        qt_safe_close(eventFd);
+    if (sqeArray != MAP_FAILED)
+        munmap(sqeArray, sqeArraySize);
+    if (cqRing != MAP_FAILED && cqRing != sqRing)
+        munmap(cqRing, cqRingSize);
+    if (sqRing != MAP_FAILED)
+        munmap(sqRing, sqRingSize);
+    if (ringFd != -1)
+        qt_safe_close(ringFd);
+}
+
+QAsyncFileIOUringBackend *QAsyncFileIOUringBackend::create(QAsyncFileIOPrivate *d)
+{
+    // io_uring may be missing from the kernel or disallowed by a sandbox
+    QAsyncFileIOUringBackend *backend = new QAsyncFileIOUringBackend(d);
+    if (!backend->setup(256)) {
+        delete backend;
+        return 0;
+    }
+    return backend;
+}
+
+bool QAsyncFileIOUringBackend::setup(unsigned entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = qt_io_uring_setup(entries, &params);
+    if (ringFd < 0)
+        return false;
+    if (!qt_io_uring_supports_read_write(ringFd))
+        return false;
+
+    sqEntries = params.sq_entries;
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap)
+        sqRingSize = cqRingSize = qMax(sqRingSize, cqRingSize);
+
+    sqRing = mmap(0, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED)
+        return false;
+    if (singleMmap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(0, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED)
+            return false;
+    }
+    sqeArraySize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeArray = mmap(0, sqeArraySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ringFd, IORING_OFF_SQES);
+    if (sqeArray == MAP_FAILED)
+        return false;
+
+    char *sq = static_cast<char *>(sqRing);
+    sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sqRingMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sqIndexArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cqRing);
+    cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cqRingMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+
+    // completions are signalled through an eventfd, which the event loop watches
+    eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (eventFd < 0)
+        return false;
+    if (qt_io_uring_register(ringFd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0)
+        return false;
+
+    // parented so that it follows the QAsyncFileIO object to other threads
+    notifier = new QSocketNotifier(eventFd, QSocketNotifier::Read, d->q_ptr);
+    QObject::connect(notifier, &QSocketNotifier::activated,
+                     d->q_ptr, [this]() { eventFdActivated(); });
+    return true;
+}
+
+void QAsyncFileIOUringBackend::submit(const QVector<QAsyncFileIORequest *> &requests)
+{
+    backlog += requests;
+    submitBacklog();
+}
+
+int QAsyncFileIOUringBackend::submitBacklog()
+{
+    int completions = 0;
+    unsigned tail = *sqTail;
+    const unsigned mask = *sqRingMask;
+    int taken = 0;
+    // keeping at most sqEntries requests in flight also guarantees that the
+    // completion queue, which is twice as large, cannot overflow
+    while (taken < backlog.size() && inFlight < int(sqEntries)
+           && tail - loadAcquire(sqHead) < sqEntries) {
+        QAsyncFileIORequest *request = backlog.at(taken++);
+        if (request->done >= request->size) {
+            // nothing to transfer, and nothing will signal the eventfd for it
+            d->completeRequest(request);
+            ++completions;
+            continue;
+        }
+
+        const unsigned index = tail & mask;
+        io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqeArray) + index;
+        memset(sqe, 0, sizeof(*sqe));
+        const bool reading = request->operation == QAsyncFileIORequest::Read;
+        char *data = reading ? request->buffer.data()
+                             : const_cast<char *>(request->buffer.constData());
+        sqe->opcode = reading ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = request->fd;
+        sqe->off = quint64(request->offset + request->done);
+        sqe->addr = quint64(quintptr(data + request->done));
+        sqe->len = unsigned(qMin<qint64>(request->size - request->done, 0x7ffff000));
+        sqe->user_data = quint64(quintptr(request));
+        sqIndexArray[index] = index;
+        ++tail;
+        ++inFlight;
+    }
+    backlog.remove(0, taken);
+
+    storeRelease(sqTail, tail);
+    const unsigned head = loadAcquire(sqHead);
+    const unsigned unsubmitted = tail - head;
+    // entries the kernel does not take now are taken by the next call
+    if (!unsubmitted || qt_io_uring_enter(ringFd, unsubmitted, 0, 0) >= 0)
+        return completions;
+
+    // the kernel took none of the entries, so take them back; leaving them
+    // in the ring would let waitForIdle() wait for requests never submitted
+    const int error = errno;
+    QVector<QAsyncFileIORequest *> returned;
+    returned.reserve(int(unsubmitted));
+    for (unsigned i = head; i != tail; ++i) {
+        const io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqeArray) + (i & mask);
+        returned.append(reinterpret_cast<QAsyncFileIORequest *>(quintptr(sqe->user_data)));
+    }
+    storeRelease(sqTail, head);
+    inFlight -= returned.size();
+
+    if ((error == EAGAIN || error == EBUSY) && inFlight > 0) {
+        // the kernel is short of resources until it has completed some of
+        // the requests in flight, so try again when reaping those
+        backlog = returned + backlog;
+        return completions;
+    }
+    for (QAsyncFileIORequest *request : qAsConst(returned)) {
+        request->errorCode = error;
+        request->error = request->operation == QAsyncFileIORequest::Read
+                ? QFileDevice::ReadError : QFileDevice::WriteError;
+        d->completeRequest(request);
+        ++completions;
+    }
+    return completions;
+}
+
+int QAsyncFileIOUringBackend::reap()
+{
+    int completions = 0;
+    unsigned head = *cqHead;
+    const unsigned tail = loadAcquire(cqTail);
+    const unsigned mask = *cqRingMask;
+    while (head != tail) {
+        const io_uring_cqe *cqe = static_cast<io_uring_cqe *>(cqes) + (head & mask);
+        QAsyncFileIORequest *request = reinterpret_cast<QAsyncFileIORequest *>(quintptr(cqe->user_data));
+        const int result = cqe->res;
+        ++head;
+        --inFlight;
+
+        if (result == -EINTR || result == -EAGAIN) {
+            backlog.append(request);
+        } else if (result < 0) {
+            request->errorCode = -result;
+            request->error = request->operation == QAsyncFileIORequest::Read
+                    ? QFileDevice::ReadError : QFileDevice::WriteError;
+            d->completeRequest(request, false);
+            ++completions;
+        } else if (result > 0 && request->done + result < request->size) {
+            // short transfer, continue where it stopped
+            request->done += result;
+            backlog.append(request);
+        } else {
+            request->done += result;
+            d->completeRequest(request, false);
+            ++completions;
+        }
+    }
+    storeRelease(cqHead, head);
+
+    if (!backlog.isEmpty())
+        completions += submitBacklog();
+    return completions;
+}
+
+void QAsyncFileIOUringBackend::eventFdActivated()
+{
+    quint64 value;
+    qt_safe_read(eventFd, &value, sizeof(value));
+    if (reap() > 0)
+        d->_q_deliverCompletions();
+}
+
+bool QAsyncFileIOUringBackend::waitForCompletions(int msecs)
+{
+    if (reap() > 0)
+        return true;
+
+    QDeadlineTimer deadline(msecs);
+    while (inFlight > 0 || !backlog.isEmpty()) {
+        pollfd pfd = qt_make_pollfd(eventFd, POLLIN);
+        if (qt_poll_msecs(&pfd, 1, int(deadline.remainingTime())) <= 0)
+            return false;
+        quint64 value;
+        qt_safe_read(eventFd, &value, sizeof(value));
+        if (reap() > 0)
+            return true;
+    }
+    return false;
+}
+
+void QAsyncFileIOUringBackend::waitForIdle()
+{
+    while (inFlight > 0) {
+        // hands over entries the kernel did not take before, or fails them,
+        // so that everything still counted in flight will complete
+        submitBacklog();
+        if (inFlight == 0)
+            break;
+        if (qt_io_uring_enter(ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0)
+            break;
+        reap();
+    }
+}
+
+QT_END_NAMESPACE
@@ -48,6 +48,7 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include "qendian.h"
+#include <private/qsimd_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -1091,6 +1092,298 @@ int QDataStream::readRawData(char *s, int len)
 }
 
 
+// the size of the blocks in which arrays are byte-swapped or converted before being written
+static const int arrayBlockSize = 16384;
+
+/*
+    Reverses the byte order of the \a count elements of \a size bytes each
+    at \a data, sixteen bytes at a time where possible.
+*/
+static void swapArray(void *data, qint64 count, int size)
+{
+    uchar *ptr = static_cast<uchar *>(data);
+    uchar *const end = ptr + count * size;
+#if defined(__SSSE3__)
+    const __m128i mask = size == 2 ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+                       : size == 4 ? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+                       : _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr), _mm_shuffle_epi8(chunk, mask));
+    }
+#elif defined(__SSE2__)
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        // reverse the order of the 16-bit words within each element, then swap their bytes
+        if (size == 4) {
+            chunk = _mm_shufflelo_epi16(chunk, _MM_SHUFFLE(2, 3, 0, 1));
+            chunk = _mm_shufflehi_epi16(chunk, _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (size == 8) {
+            chunk = _mm_shufflelo_epi16(chunk, _MM_SHUFFLE(0, 1, 2, 3));
+            chunk = _mm_shufflehi_epi16(chunk, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        chunk = _mm_or_si128(_mm_slli_epi16(chunk, 8), _mm_srli_epi16(chunk, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ptr), chunk);
+    }
+#elif defined(__ARM_NEON__)
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const uint8x16_t chunk = vld1q_u8(ptr);
+        vst1q_u8(ptr, size == 2 ? vrev16q_u8(chunk) : size == 4 ? vrev32q_u8(chunk) : vrev64q_u8(chunk));
+    }
+#endif
+    for ( ; ptr < end; ptr += size) {
+        switch (size) {
+        case 2:
+            qToUnaligned(qbswap(qFromUnaligned<quint16>(ptr)), ptr);
+            break;
+        case 4:
+            qToUnaligned(qbswap(qFromUnaligned<quint32>(ptr)), ptr);
+            break;
+        case 8:
+            qToUnaligned(qbswap(qFromUnaligned<quint64>(ptr)), ptr);
+            break;
+        }
+    }
+}
+
+/*!
+    \internal
+
+    Reads \a count elements of \a size bytes into \a data as one block and
+    converts them from the stream's byte order. Elements that could not be
+    read are set to 0.
+*/
+void QDataStream::readArrayData(void *data, qint64 count, int size)
+{
+    const qint64 length = count * size;
+    if (!dev)
+        memset(data, 0, length);
+    CHECK_STREAM_PRECOND(Q_VOID)
+    // Disable reads on failure in transacted stream
+    qint64 readResult = 0;
+    if (q_status == Ok || !dev->isTransactionStarted())
+        readResult = qMax(dev->read(static_cast<char *>(data), length), qint64(0));
+    if (readResult != length) {
+        setStatus(ReadPastEnd);
+        readResult -= readResult % size;
+        memset(static_cast<char *>(data) + readResult, 0, length - readResult);
+    }
+    if (!noswap && size > 1)
+        swapArray(data, readResult / size, size);
+}
+
+/*!
+    \internal
+
+    Writes \a count elements of \a size bytes from \a data. They are
+    written in one block if the stream's byte order is the native one, and
+    in byte-swapped blocks otherwise.
+*/
+void QDataStream::writeArrayData(const void *data, qint64 count, int size)
+{
+    CHECK_STREAM_WRITE_PRECOND(Q_VOID)
+    const char *ptr = static_cast<const char *>(data);
+    qint64 length = count * size;
+    if (noswap || size == 1) {
+        if (dev->write(ptr, length) != length)
+            q_status = WriteFailed;
+        return;
+    }
+    quint64 block[arrayBlockSize / sizeof(quint64)];
+    while (length > 0) {
+        const int blockLength = int(qMin(length, qint64(sizeof(block))));
+        memcpy(block, ptr, blockLength);
+        swapArray(block, blockLength / size, size);
+        if (dev->write(reinterpret_cast<const char *>(block), blockLength) != blockLength) {
+            q_status = WriteFailed;
+            return;
+        }
+        ptr += blockLength;
+        length -= blockLength;
+    }
+}
+
+/*!
+    \internal
+
+    Reads \a count elements that are stored as \c StreamType in the stream,
+    such as floats stored in double precision, into \a data.
+*/
+template <typename T, typename StreamType>
+void QDataStream::readConvertedArray(T *data, int count)
+{
+    StreamType block[arrayBlockSize / sizeof(StreamType)];
+    while (count > 0) {
+        const int blockCount = qMin(count, int(sizeof(block) / sizeof(StreamType)));
+        readArrayData(block, blockCount, sizeof(StreamType));
+        for (int i = 0; i < blockCount; ++i)
+            data[i] = T(block[i]);
+        data += blockCount;
+        count -= blockCount;
+    }
+}
+
+/*!
+    \internal
+
+    Writes the \a count elements at \a data as \c StreamType.
+*/
+template <typename T, typename StreamType>
+void QDataStream::writeConvertedArray(const T *data, int count)
+{
+    StreamType block[arrayBlockSize / sizeof(StreamType)];
+    while (count > 0 && q_status == Ok) {
+        const int blockCount = qMin(count, int(sizeof(block) / sizeof(StreamType)));
+        for (int i = 0; i < blockCount; ++i)
+            block[i] = StreamType(data[i]);
+        writeArrayData(block, blockCount, sizeof(StreamType));
+        data += blockCount;
+        count -= blockCount;
+    }
+}
+
+/*!
+    \since 5.10
+
+    Reads \a count signed bytes from the stream into \a data and returns a
+    reference to the stream.
+
+    This function reads the same data as \a count calls to operator>>(),
+    but all at once, which is much faster for large arrays. Unlike
+    readBytes(), it does not read a length first. \a data must have room
+    for \a count elements. The elements that could not be read are set to
+    0. The operators that read QVector and QList of the integral and
+    floating point types use this function.
+
+    \sa writeArray(), readRawData()
+*/
+QDataStream &QDataStream::readArray(qint8 *data, int count)
+{
+    readArrayData(data, count, sizeof(qint8));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count unsigned bytes from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(quint8 *data, int count)
+{
+    return readArray(reinterpret_cast<qint8 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count signed 16-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(qint16 *data, int count)
+{
+    readArrayData(data, count, sizeof(qint16));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count unsigned 16-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(quint16 *data, int count)
+{
+    return readArray(reinterpret_cast<qint16 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count signed 32-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(qint32 *data, int count)
+{
+    readArrayData(data, count, sizeof(qint32));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count unsigned 32-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(quint32 *data, int count)
+{
+    return readArray(reinterpret_cast<qint32 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count signed 64-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(qint64 *data, int count)
+{
+    if (version() < 6) {
+        for (int i = 0; i < count; ++i)
+            *this >> data[i];
+        return *this;
+    }
+    readArrayData(data, count, sizeof(qint64));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count unsigned 64-bit integers from the stream into \a data.
+*/
+QDataStream &QDataStream::readArray(quint64 *data, int count)
+{
+    return readArray(reinterpret_cast<qint64 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count floating point numbers from the stream into \a data,
+    using the floatingPointPrecision() of the stream.
+*/
+QDataStream &QDataStream::readArray(float *data, int count)
+{
+    if (version() >= QDataStream::Qt_4_6
+        && floatingPointPrecision() == QDataStream::DoublePrecision) {
+        readConvertedArray<float, double>(data, count);
+        return *this;
+    }
+    readArrayData(data, count, sizeof(float));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Reads \a count floating point numbers from the stream into \a data,
+    using the floatingPointPrecision() of the stream.
+*/
+QDataStream &QDataStream::readArray(double *data, int count)
+{
+    if (version() >= QDataStream::Qt_4_6
+        && floatingPointPrecision() == QDataStream::SinglePrecision) {
+        readConvertedArray<double, float>(data, count);
+        return *this;
+    }
+    readArrayData(data, count, sizeof(double));
+    return *this;
+}
+
 /*****************************************************************************
   QDataStream write functions
  *****************************************************************************/
@@ -1370,6 +1663,148 @@ int QDataStream::writeRawData(const char *s, int len)
     return ret;
 }
 
+/*!
+    \since 5.10
+
+    Writes the \a count signed bytes at \a data to the stream and returns
+    a reference to the stream.
+
+    This function writes the same data as \a count calls to operator<<(),
+    but all at once: if the byteOrder() of the stream is the byte order of
+    the host, the elements are written to the device in one call, and
+    otherwise they are byte-swapped in blocks. Unlike writeBytes(), it
+    does not write a length first. The operators that write QVector and
+    QList of the integral and floating point types use this function.
+
+    \sa readArray(), writeRawData()
+*/
+QDataStream &QDataStream::writeArray(const qint8 *data, int count)
+{
+    writeArrayData(data, count, sizeof(qint8));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count unsigned bytes at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const quint8 *data, int count)
+{
+    return writeArray(reinterpret_cast<const qint8 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count signed 16-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const qint16 *data, int count)
+{
+    writeArrayData(data, count, sizeof(qint16));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count unsigned 16-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const quint16 *data, int count)
+{
+    return writeArray(reinterpret_cast<const qint16 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count signed 32-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const qint32 *data, int count)
+{
+    writeArrayData(data, count, sizeof(qint32));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count unsigned 32-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const quint32 *data, int count)
+{
+    return writeArray(reinterpret_cast<const qint32 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count signed 64-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const qint64 *data, int count)
+{
+    if (version() < 6) {
+        for (int i = 0; i < count; ++i)
+            *this << data[i];
+        return *this;
+    }
+    writeArrayData(data, count, sizeof(qint64));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count unsigned 64-bit integers at \a data to the stream.
+*/
+QDataStream &QDataStream::writeArray(const quint64 *data, int count)
+{
+    return writeArray(reinterpret_cast<const qint64 *>(data), count);
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count floating point numbers at \a data to the stream,
+    using the floatingPointPrecision() of the stream.
+*/
+QDataStream &QDataStream::writeArray(const float *data, int count)
+{
+    if (version() >= QDataStream::Qt_4_6
+        && floatingPointPrecision() == QDataStream::DoublePrecision) {
+        writeConvertedArray<float, double>(data, count);
+        return *this;
+    }
+    writeArrayData(data, count, sizeof(float));
+    return *this;
+}
+
+/*!
+    \since 5.10
+    \overload
+
+    Writes the \a count floating point numbers at \a data to the stream,
+    using the floatingPointPrecision() of the stream.
+*/
+QDataStream &QDataStream::writeArray(const double *data, int count)
+{
+    if (version() >= QDataStream::Qt_4_6
+        && floatingPointPrecision() == QDataStream::SinglePrecision) {
+        writeConvertedArray<double, float>(data, count);
+        return *this;
+    }
+    writeArrayData(data, count, sizeof(double));
+    return *this;
+}
+
 /*!
     \since 4.1
 
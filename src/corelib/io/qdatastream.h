@@ -183,6 +183,28 @@ public:
 
     int skipRawData(int len);
 
+    QDataStream &readArray(qint8 *data, int count);
+    QDataStream &readArray(quint8 *data, int count);
+    QDataStream &readArray(qint16 *data, int count);
+    QDataStream &readArray(quint16 *data, int count);
+    QDataStream &readArray(qint32 *data, int count);
+    QDataStream &readArray(quint32 *data, int count);
+    QDataStream &readArray(qint64 *data, int count);
+    QDataStream &readArray(quint64 *data, int count);
+    QDataStream &readArray(float *data, int count);
+    QDataStream &readArray(double *data, int count);
+
+    QDataStream &writeArray(const qint8 *data, int count);
+    QDataStream &writeArray(const quint8 *data, int count);
+    QDataStream &writeArray(const qint16 *data, int count);
+    QDataStream &writeArray(const quint16 *data, int count);
+    QDataStream &writeArray(const qint32 *data, int count);
+    QDataStream &writeArray(const quint32 *data, int count);
+    QDataStream &writeArray(const qint64 *data, int count);
+    QDataStream &writeArray(const quint64 *data, int count);
+    QDataStream &writeArray(const float *data, int count);
+    QDataStream &writeArray(const double *data, int count);
+
     void startTransaction();
     bool commitTransaction();
     void rollbackTransaction();
@@ -201,6 +223,10 @@ private:
     Status q_status;
 
     int readBlock(char *data, int len);
+    void readArrayData(void *data, qint64 count, int size);
+    void writeArrayData(const void *data, qint64 count, int size);
+    template <typename T, typename StreamType> void readConvertedArray(T *data, int count);
+    template <typename T, typename StreamType> void writeConvertedArray(const T *data, int count);
     friend class QtPrivate::StreamStateSaver;
 };
 
@@ -249,6 +275,86 @@ QDataStream &readArrayBasedContainer(QDataStream &s, Container &c)
     return s;
 }
 
+// the element types that QDataStream::readArray() and writeArray() handle
+template <typename T> struct IsDataStreamArrayType : std::false_type {};
+template <> struct IsDataStreamArrayType<qint8> : std::true_type {};
+template <> struct IsDataStreamArrayType<quint8> : std::true_type {};
+template <> struct IsDataStreamArrayType<qint16> : std::true_type {};
+template <> struct IsDataStreamArrayType<quint16> : std::true_type {};
+template <> struct IsDataStreamArrayType<qint32> : std::true_type {};
+template <> struct IsDataStreamArrayType<quint32> : std::true_type {};
+template <> struct IsDataStreamArrayType<qint64> : std::true_type {};
+template <> struct IsDataStreamArrayType<quint64> : std::true_type {};
+template <> struct IsDataStreamArrayType<float> : std::true_type {};
+template <> struct IsDataStreamArrayType<double> : std::true_type {};
+
+inline int arrayReserveSize(QDataStream &s, quint32 n, int size)
+{
+    const qint64 available = s.device() ? s.device()->bytesAvailable() / size : 0;
+    return int(qMin(qint64(n), available));
+}
+
+template <typename T>
+QDataStream &readVector(QDataStream &s, QVector<T> &v, std::false_type)
+{
+    return readArrayBasedContainer(s, v);
+}
+
+template <typename T>
+QDataStream &readVector(QDataStream &s, QVector<T> &v, std::true_type)
+{
+    StreamStateSaver stateSaver(&s);
+
+    v.clear();
+    quint32 n;
+    s >> n;
+    // read in steps, so that a corrupt size does not allocate more memory than there is data
+    v.reserve(arrayReserveSize(s, n, sizeof(T)));
+    const int step = 65536;
+    while (quint32(v.size()) < n) {
+        const int count = int(qMin(n - quint32(v.size()), quint32(step)));
+        v.resize(v.size() + count);
+        s.readArray(v.data() + v.size() - count, count);
+        if (s.status() != QDataStream::Ok) {
+            v.clear();
+            break;
+        }
+    }
+
+    return s;
+}
+
+template <typename T>
+QDataStream &readList(QDataStream &s, QList<T> &l, std::false_type)
+{
+    return readArrayBasedContainer(s, l);
+}
+
+template <typename T>
+QDataStream &readList(QDataStream &s, QList<T> &l, std::true_type)
+{
+    StreamStateSaver stateSaver(&s);
+
+    l.clear();
+    quint32 n;
+    s >> n;
+    l.reserve(arrayReserveSize(s, n, sizeof(T)));
+    T block[1024];
+    for (quint32 i = 0; i < n; ) {
+        const int count = int(qMin(n - i, quint32(sizeof(block) / sizeof(T))));
+        s.readArray(block, count);
+        if (s.status() != QDataStream::Ok) {
+            l.clear();
+            break;
+        }
+        for (int j = 0; j < count; ++j)
+            l.append(block[j]);
+        i += count;
+    }
+
+    return s;
+}
+
 template <typename Container>
 QDataStream &readListBasedContainer(QDataStream &s, Container &c)
 {
@@ -302,6 +408,41 @@ QDataStream &writeSequentialContainer(QDataStream &s, const Container &c)
     return s;
 }
 
+template <typename T>
+QDataStream &writeVector(QDataStream &s, const QVector<T> &v, std::false_type)
+{
+    return writeSequentialContainer(s, v);
+}
+
+template <typename T>
+QDataStream &writeVector(QDataStream &s, const QVector<T> &v, std::true_type)
+{
+    s << quint32(v.size());
+    return s.writeArray(v.constData(), v.size());
+}
+
+template <typename T>
+QDataStream &writeList(QDataStream &s, const QList<T> &l, std::false_type)
+{
+    return writeSequentialContainer(s, l);
+}
+
+template <typename T>
+QDataStream &writeList(QDataStream &s, const QList<T> &l, std::true_type)
+{
+    s << quint32(l.size());
+    T block[1024];
+    int count = 0;
+    for (const T &t : l) {
+        block[count++] = t;
+        if (count == int(sizeof(block) / sizeof(T))) {
+            s.writeArray(block, count);
+            count = 0;
+        }
+    }
+    return s.writeArray(block, count);
+}
+
 template <typename Container>
 QDataStream &writeAssociativeContainer(QDataStream &s, const Container &c)
 {
@@ -372,13 +513,13 @@ inline QDataStream &operator>>(QDataStream &s, QFlags<Enum> &e)
 template <typename T>
 inline QDataStream &operator>>(QDataStream &s, QList<T> &l)
 {
-    return QtPrivate::readArrayBasedContainer(s, l);
+    return QtPrivate::readList(s, l, QtPrivate::IsDataStreamArrayType<T>());
 }
 
 template <typename T>
 inline QDataStream &operator<<(QDataStream &s, const QList<T> &l)
 {
-    return QtPrivate::writeSequentialContainer(s, l);
+    return QtPrivate::writeList(s, l, QtPrivate::IsDataStreamArrayType<T>());
 }
 
 template <typename T>
@@ -396,13 +537,13 @@ inline QDataStream &operator<<(QDataStream &s, const QLinkedList<T> &l)
 template<typename T>
 inline QDataStream &operator>>(QDataStream &s, QVector<T> &v)
 {
-    return QtPrivate::readArrayBasedContainer(s, v);
+    return QtPrivate::readVector(s, v, QtPrivate::IsDataStreamArrayType<T>());
 }
 
 template<typename T>
 inline QDataStream &operator<<(QDataStream &s, const QVector<T> &v)
 {
-    return QtPrivate::writeSequentialContainer(s, v);
+    return QtPrivate::writeVector(s, v, QtPrivate::IsDataStreamArrayType<T>());
 }
 
 template <typename T>
@@ -57,6 +57,80 @@ using QtMiscUtils::fromHex;
 
 // This file is needed to force compilation of QDebug into the kernel library.
 
+#ifdef Q_COMPILER_THREAD_LOCAL
+/*
+    Keeps one spare message stream per thread, so that a qDebug() statement
+    does not have to allocate a text stream and grow a new buffer every
+    time. Streams writing to a device or a string are never cached. A stream
+    that is still in use, e.g. by a nested qDebug() inside an operator<<,
+    simply means the next stream of that thread is allocated as before.
+*/
+class QDebugStreamCache
+{
+public:
+    // larger buffers are released rather than kept around for the thread
+    enum { MaximumCapacity = 4096 };
+
+    static QDebug::Stream *take(QtMsgType type)
+    {
+        QDebug::Stream *stream = spare;
+        if (!stream)
+            return new QDebug::Stream(type);
+        spare = Q_NULLPTR;
+
+        stream->ts.reset();
+        stream->ts.resetStatus();
+        stream->ref = 1;
+        stream->type = type;
+        stream->space = true;
+        stream->message_output = true;
+        stream->context.version = 2;
+        stream->context.line = 0;
+        stream->context.file = Q_NULLPTR;
+        stream->context.function = Q_NULLPTR;
+        stream->context.category = Q_NULLPTR;
+        stream->flags = QDebug::Stream::DefaultVerbosity << QDebug::Stream::VerbosityShift;
+        return stream;
+    }
+
+    static void release(QDebug::Stream *stream)
+    {
+        // only streams created by QDebug(QtMsgType) write to their own buffer
+        if (stream->ts.string() != &stream->buffer || spare || finished
+                || stream->buffer.capacity() > MaximumCapacity) {
+            delete stream;
+            return;
+        }
+        // keeps the capacity unless a message handler still shares the data
+        stream->buffer.resize(0);
+        reaper.arm();
+        spare = stream;
+    }
+
+private:
+    struct Reaper
+    {
+        void arm() {}
+        ~Reaper()
+        {
+            delete spare;
+            spare = Q_NULLPTR;
+            finished = true;
+        }
+    };
+
+    // plain pointers stay usable while other thread-local and global
+    // objects are destroyed; the reaper only runs once for each thread
+    static thread_local QDebug::Stream *spare;
+    static thread_local bool finished;
+    static thread_local Reaper reaper;
+};
+
+thread_local QDebug::Stream *QDebugStreamCache::spare = Q_NULLPTR;
+thread_local bool QDebugStreamCache::finished = false;
+thread_local QDebugStreamCache::Reaper QDebugStreamCache::reaper;
+#endif // Q_COMPILER_THREAD_LOCAL
+
 /*!
     \class QDebug
     \inmodule QtCore
@@ -125,6 +199,15 @@ using QtMiscUtils::fromHex;
 
     Constructs a debug stream that writes to the handler for the message type specified by \a type.
 */
+// Has been defined in the header / inlined before Qt 5.10
+QDebug::QDebug(QtMsgType t)
+#ifdef Q_COMPILER_THREAD_LOCAL
+    : stream(QDebugStreamCache::take(t))
+#else
+    : stream(new Stream(t))
+#endif
+{
+}
 
 /*!
     \fn QDebug::QDebug(const QDebug &other)
@@ -155,7 +238,11 @@ QDebug::~QDebug()
                               stream->context,
                               stream->buffer);
         }
+#ifdef Q_COMPILER_THREAD_LOCAL
+        QDebugStreamCache::release(stream);
+#else
         delete stream;
+#endif
     }
 }
 
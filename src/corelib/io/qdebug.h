@@ -66,6 +66,7 @@ class Q_CORE_EXPORT QDebug
 {
     friend class QMessageLogger;
     friend class QDebugStateSaverPrivate;
+    friend class QDebugStreamCache;
     struct Stream {
         enum { DefaultVerbosity = 2, VerbosityShift = 29, VerbosityMask = 0x7 };
 
@@ -112,7 +113,7 @@ class Q_CORE_EXPORT QDebug
 public:
     inline QDebug(QIODevice *device) : stream(new Stream(device)) {}
     inline QDebug(QString *string) : stream(new Stream(string)) {}
-    inline QDebug(QtMsgType t) : stream(new Stream(t)) {}
+    QDebug(QtMsgType t);
     inline QDebug(const QDebug &o):stream(o.stream) { ++stream->ref; }
     inline QDebug &operator=(const QDebug &other);
     ~QDebug();
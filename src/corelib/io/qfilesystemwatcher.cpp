@@ -45,9 +45,13 @@
 #include <qdatetime.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <qdiriterator.h>
 #include <qfileinfo.h>
+#include <qmetaobject.h>
+#include <qpointer.h>
 #include <qset.h>
 #include <qtimer.h>
+#include <qvector.h>
 
 #if defined(Q_OS_LINUX) || (defined(Q_OS_QNX) && !defined(QT_NO_INOTIFY))
 #define USE_INOTIFY
@@ -88,7 +92,7 @@ QFileSystemWatcherEngine *QFileSystemWatcherPrivate::createNativeEngine(QObject
 }
 
 QFileSystemWatcherPrivate::QFileSystemWatcherPrivate()
-    : native(0), poller(0)
+    : native(0), poller(0), notificationDelay(0), notificationTimer(0)
 {
 }
 
@@ -136,6 +140,153 @@ void QFileSystemWatcherPrivate::initPollerEngine()
                      SLOT(_q_directoryChanged(QString,bool)));
 }
 
+QStringList QFileSystemWatcherPathSet::toList() const
+{
+    QVector<QPair<quint64, QString> > sorted;
+    sorted.reserve(order.size());
+    for (auto it = order.cbegin(), end = order.cend(); it != end; ++it)
+        sorted.append(qMakePair(it.value(), it.key()));
+    std::sort(sorted.begin(), sorted.end());
+
+    QStringList paths;
+    paths.reserve(sorted.size());
+    for (const auto &entry : qAsConst(sorted))
+        paths.append(entry.second);
+    return paths;
+}
+
+static const int DirectoryFilters = QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks;
+
+void QFileSystemWatcherPrivate::watchSubdirectories(QFileSystemWatcherEngine *engine,
+                                                    const QString &root, const QString &path)
+{
+    // watches all subdirectories of path that are not watched yet
+    QStringList subdirectories;
+    QDirIterator it(path, QDir::Filters(DirectoryFilters), QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString subdirectory = it.next();
+        if (!directories.contains(subdirectory))
+            subdirectories.append(subdirectory);
+    }
+    if (subdirectories.isEmpty())
+        return;
+
+    engine->addPaths(subdirectories, &files, &directories);
+
+    QSet<QString> &owned = recursiveRoots[root];
+    for (const QString &subdirectory : qAsConst(subdirectories)) {
+        if (directories.contains(subdirectory)) {
+            owned.insert(subdirectory);
+            recursiveRootOf.insert(subdirectory, root);
+        }
+    }
+}
+
+void QFileSystemWatcherPrivate::watchNewSubdirectories(QFileSystemWatcherEngine *engine,
+                                                       const QString &path)
+{
+    // path changed, which may mean that subdirectories were created or moved
+    // into it; only those need to be walked, not the whole tree below path
+    const QString root = recursiveRoots.contains(path) ? path : recursiveRootOf.value(path);
+    QStringList subdirectories;
+    QDirIterator it(path, QDir::Filters(DirectoryFilters));
+    while (it.hasNext()) {
+        const QString subdirectory = it.next();
+        if (!directories.contains(subdirectory))
+            subdirectories.append(subdirectory);
+    }
+    if (subdirectories.isEmpty())
+        return;
+
+    engine->addPaths(subdirectories, &files, &directories);
+
+    for (const QString &subdirectory : qAsConst(subdirectories)) {
+        if (directories.contains(subdirectory)) {
+            recursiveRoots[root].insert(subdirectory);
+            recursiveRootOf.insert(subdirectory, root);
+            watchSubdirectories(engine, root, subdirectory);
+        }
+    }
+}
+
+// Forgets about \a path having been watched recursively or on behalf of a
+// recursively watched directory. Returns the subdirectories that are no
+// longer watched because of that.
+QStringList QFileSystemWatcherPrivate::forgetRecursivePath(const QString &path)
+{
+    const auto rit = recursiveRoots.find(path);
+    if (rit != recursiveRoots.end()) {
+        QStringList subdirectories = rit.value().toList();
+        recursiveRoots.erase(rit);
+        if (subdirectories.isEmpty())
+            return subdirectories;
+
+        for (const QString &subdirectory : qAsConst(subdirectories))
+            recursiveRootOf.remove(subdirectory);
+        const QStringList p = native ? native->removePaths(subdirectories, &files, &directories)
+                                     : subdirectories;
+        if (poller)
+            poller->removePaths(p, &files, &directories);
+        return subdirectories;
+    }
+
+    const auto it = recursiveRootOf.find(path);
+    if (it != recursiveRootOf.end()) {
+        recursiveRoots[it.value()].remove(path);
+        recursiveRootOf.erase(it);
+    }
+    return QStringList();
+}
+
+void QFileSystemWatcherPrivate::queueChange(QSet<QString> *pending, const QString &path)
+{
+    Q_Q(QFileSystemWatcher);
+    pending->insert(path);
+    if (!notificationTimer) {
+        notificationTimer = new QTimer(q);
+        notificationTimer->setSingleShot(true);
+        QObject::connect(notificationTimer, &QTimer::timeout,
+                         q, [this]() { deliverPendingChanges(); });
+    }
+    // the first change starts the interval, later ones are coalesced into it
+    if (!notificationTimer->isActive())
+        notificationTimer->start(notificationDelay);
+}
+
+void QFileSystemWatcherPrivate::deliverPendingChanges()
+{
+    Q_Q(QFileSystemWatcher);
+    if (notificationTimer)
+        notificationTimer->stop();
+
+    const QStringList changedFiles = pendingFiles.toList();
+    const QStringList changedDirectories = pendingDirectories.toList();
+    pendingFiles.clear();
+    pendingDirectories.clear();
+
+    // receivers may delete the watcher
+    QPointer<QFileSystemWatcher> guard(q);
+    if (notificationDelay > 0) {
+        for (const QString &path : changedFiles) {
+            emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
+            if (!guard)
+                return;
+        }
+        for (const QString &path : changedDirectories) {
+            emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+            if (!guard)
+                return;
+        }
+    }
+    if (!changedFiles.isEmpty()) {
+        emit q->filesChanged(changedFiles, QFileSystemWatcher::QPrivateSignal());
+        if (!guard)
+            return;
+    }
+    if (!changedDirectories.isEmpty())
+        emit q->directoriesChanged(changedDirectories, QFileSystemWatcher::QPrivateSignal());
+}
+
 void QFileSystemWatcherPrivate::_q_fileChanged(const QString &path, bool removed)
 {
     Q_Q(QFileSystemWatcher);
@@ -144,7 +295,14 @@ void QFileSystemWatcherPrivate::_q_fileChanged(const QString &path, bool removed
         return;
     }
     if (removed)
-        files.removeAll(path);
+        files.remove(path);
+    if (notificationDelay > 0) {
+        queueChange(&pendingFiles, path);
+        return;
+    }
+    static const QMetaMethod filesChangedSignal = QMetaMethod::fromSignal(&QFileSystemWatcher::filesChanged);
+    if (q->isSignalConnected(filesChangedSignal))
+        queueChange(&pendingFiles, path);
     emit q->fileChanged(path, QFileSystemWatcher::QPrivateSignal());
 }
 
@@ -155,8 +313,20 @@ void QFileSystemWatcherPrivate::_q_directoryChanged(const QString &path, bool re
         // perhaps the path was removed after a change was detected, but before we delivered the signal
         return;
     }
-    if (removed)
-        directories.removeAll(path);
+    if (removed) {
+        directories.remove(path);
+        forgetRecursivePath(path);
+    } else if (recursiveRoots.contains(path) || recursiveRootOf.contains(path)) {
+        if (QFileSystemWatcherEngine *engine = qobject_cast<QFileSystemWatcherEngine *>(q->sender()))
+            watchNewSubdirectories(engine, path);
+    }
+    if (notificationDelay > 0) {
+        queueChange(&pendingDirectories, path);
+        return;
+    }
+    static const QMetaMethod directoriesChangedSignal = QMetaMethod::fromSignal(&QFileSystemWatcher::directoriesChanged);
+    if (q->isSignalConnected(directoriesChangedSignal))
+        queueChange(&pendingDirectories, path);
     emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
 }
 
@@ -227,6 +397,15 @@ void  QFileSystemWatcherPrivate::_q_winDriveRemoved(const QString &path)
     they have been renamed or removed from disk, and directories once
     they have been removed from disk.
 
+    A directory can be watched together with all of its subdirectories
+    by passing \l WatchSubdirectories to addPath() or addPaths().
+    Subdirectories that are created later on are watched as well.
+
+    Applications watching many paths can have changes delivered in
+    batches by connecting to filesChanged() and directoriesChanged(),
+    and can coalesce repeated changes to the same path by setting a
+    notificationDelay().
+
     \list
     \li \b Notes:
     \list
@@ -253,6 +432,20 @@ void  QFileSystemWatcherPrivate::_q_winDriveRemoved(const QString &path)
 */
 
 
+/*!
+    \enum QFileSystemWatcher::WatchOption
+    \since 5.10
+
+    This enum describes how a path is watched.
+
+    \value NoWatchOptions Only the path itself is watched.
+    \value WatchSubdirectories If the path is a directory, all directories
+    below it are watched as well, including the ones that are created after
+    the path was added. Symbolic links to directories are not followed. The
+    subdirectories are reported by directories(), and stop being watched
+    when the path is removed from the watcher.
+*/
+
 /*!
     Constructs a new file system watcher object with the given \a parent.
 */
@@ -313,6 +506,31 @@ bool QFileSystemWatcher::addPath(const QString &path)
     return paths.isEmpty();
 }
 
+/*!
+    \overload
+    \since 5.10
+
+    Adds \a path to the file system watcher, watching it as specified by
+    \a options. Returns \c true if the watch was successful.
+
+    If \l WatchSubdirectories is given and \a path is a directory, the
+    subdirectories of \a path are watched as well. Failing to watch one
+    of them, for instance because of the system limit on the number of
+    watches, does not make this function return \c false.
+
+    \sa addPaths(), removePath()
+*/
+bool QFileSystemWatcher::addPath(const QString &path, WatchOptions options)
+{
+    if (path.isEmpty()) {
+        qWarning("QFileSystemWatcher::addPath: path is empty");
+        return true;
+    }
+
+    QStringList paths = addPaths(QStringList(path), options);
+    return paths.isEmpty();
+}
+
 /*!
     Adds each path in \a paths to the file system watcher. Paths are
     not added if they not exist, or if they are already being
@@ -337,6 +555,21 @@ bool QFileSystemWatcher::addPath(const QString &path)
     \sa addPath(), removePaths()
 */
 QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
+{
+    return addPaths(paths, NoWatchOptions);
+}
+
+/*!
+    \overload
+    \since 5.10
+
+    Adds each path in \a paths to the file system watcher, watching them
+    as specified by \a options. The return value is a list of paths that
+    could not be watched.
+
+    \sa addPath(), removePaths()
+*/
+QStringList QFileSystemWatcher::addPaths(const QStringList &paths, WatchOptions options)
 {
     Q_D(QFileSystemWatcher);
 
@@ -380,10 +613,24 @@ QStringList QFileSystemWatcher::addPaths(const QStringList &paths)
         }
     }
 
-    if(engine)
-        p = engine->addPaths(p, &d->files, &d->directories);
+    if (!engine)
+        return p;
 
-    return p;
+    const QStringList unwatched = engine->addPaths(p, &d->files, &d->directories);
+
+    if (options & WatchSubdirectories) {
+        const QSet<QString> failed = unwatched.toSet();
+        for (const QString &path : qAsConst(p)) {
+            if (failed.contains(path) || !d->directories.contains(path)
+                || d->recursiveRoots.contains(path)) {
+                continue;
+            }
+            d->recursiveRoots.insert(path, QSet<QString>());
+            d->watchSubdirectories(engine, path, path);
+        }
+    }
+
+    return unwatched;
 }
 
 /*!
@@ -436,11 +683,26 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
         return QStringList();
     }
 
+    const QStringList requested = p;
     if (d->native)
         p = d->native->removePaths(p, &d->files, &d->directories);
     if (d->poller)
         p = d->poller->removePaths(p, &d->files, &d->directories);
 
+    // changes to paths that are no longer watched are not delivered
+    if (p.size() < requested.size()) {
+        const QSet<QString> failed = p.toSet();
+        for (const QString &path : requested) {
+            if (failed.contains(path))
+                continue;
+            d->pendingFiles.remove(path);
+            d->pendingDirectories.remove(path);
+            const QStringList subdirectories = d->forgetRecursivePath(path);
+            for (const QString &subdirectory : subdirectories)
+                d->pendingDirectories.remove(subdirectory);
+        }
+    }
+
     return p;
 }
 
@@ -450,7 +712,10 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
     This signal is emitted when the file at the specified \a path is
     modified, renamed or removed from disk.
 
-    \sa directoryChanged()
+    If a notificationDelay() is set, the signal is emitted once for all
+    changes to \a path within that delay.
+
+    \sa directoryChanged(), filesChanged()
 */
 
 /*!
@@ -463,7 +728,40 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
     However, the last change in the sequence of changes will always
     generate this signal.
 
-    \sa fileChanged()
+    If a notificationDelay() is set, the signal is emitted once for all
+    changes to \a path within that delay.
+
+    \sa fileChanged(), directoriesChanged()
+*/
+
+/*!
+    \fn void QFileSystemWatcher::filesChanged(const QStringList &paths)
+    \since 5.10
+
+    This signal is emitted with the \a paths of all files that were
+    modified, renamed or removed from disk since it was last emitted. Each
+    path is listed once, in no particular order.
+
+    Without a notificationDelay(), the changes are collected until control
+    returns to the event loop, and fileChanged() is emitted for each of them
+    as well, before this signal.
+
+    \sa directoriesChanged(), setNotificationDelay()
+*/
+
+/*!
+    \fn void QFileSystemWatcher::directoriesChanged(const QStringList &paths)
+    \since 5.10
+
+    This signal is emitted with the \a paths of all directories that were
+    modified or removed from disk since it was last emitted. Each path is
+    listed once, in no particular order.
+
+    Without a notificationDelay(), the changes are collected until control
+    returns to the event loop, and directoryChanged() is emitted for each of
+    them as well, before this signal.
+
+    \sa filesChanged(), setNotificationDelay()
 */
 
 /*!
@@ -485,13 +783,61 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
 QStringList QFileSystemWatcher::directories() const
 {
     Q_D(const QFileSystemWatcher);
-    return d->directories;
+    return d->directories.toList();
 }
 
 QStringList QFileSystemWatcher::files() const
 {
     Q_D(const QFileSystemWatcher);
-    return d->files;
+    return d->files.toList();
+}
+
+/*!
+    \since 5.10
+
+    Sets the delay, in milliseconds, by which change notifications are
+    held back to \a msecs.
+
+    All changes to a watched path within the delay result in a single
+    emission of fileChanged() or directoryChanged(), and all changed paths
+    are reported together by filesChanged() and directoriesChanged() when
+    the delay has passed. The delay starts with the first change after
+    the previous notification, so a path that changes continuously is
+    still reported once per delay.
+
+    The default delay is 0, in which case fileChanged() and
+    directoryChanged() are emitted as soon as a change is detected.
+    Changes that are pending when the delay is changed are delivered
+    right away.
+
+    \sa notificationDelay()
+*/
+void QFileSystemWatcher::setNotificationDelay(int msecs)
+{
+    Q_D(QFileSystemWatcher);
+    if (msecs < 0) {
+        qWarning("QFileSystemWatcher::setNotificationDelay: delay must not be negative");
+        return;
+    }
+    if (d->notificationDelay == msecs)
+        return;
+    if (!d->pendingFiles.isEmpty() || !d->pendingDirectories.isEmpty())
+        d->deliverPendingChanges();
+    d->notificationDelay = msecs;
+}
+
+/*!
+    \since 5.10
+
+    Returns the delay, in milliseconds, by which change notifications are
+    held back.
+
+    \sa setNotificationDelay()
+*/
+int QFileSystemWatcher::notificationDelay() const
+{
+    Q_D(const QFileSystemWatcher);
+    return d->notificationDelay;
 }
 
 QT_END_NAMESPACE
@@ -55,27 +55,42 @@ class Q_CORE_EXPORT QFileSystemWatcher : public QObject
     Q_DECLARE_PRIVATE(QFileSystemWatcher)
 
 public:
+    enum WatchOption {
+        NoWatchOptions = 0x0,
+        WatchSubdirectories = 0x1
+    };
+    Q_DECLARE_FLAGS(WatchOptions, WatchOption)
+
     QFileSystemWatcher(QObject *parent = Q_NULLPTR);
     QFileSystemWatcher(const QStringList &paths, QObject *parent = Q_NULLPTR);
     ~QFileSystemWatcher();
 
     bool addPath(const QString &file);
+    bool addPath(const QString &file, WatchOptions options);
     QStringList addPaths(const QStringList &files);
+    QStringList addPaths(const QStringList &files, WatchOptions options);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
 
     QStringList files() const;
     QStringList directories() const;
 
+    void setNotificationDelay(int msecs);
+    int notificationDelay() const;
+
 Q_SIGNALS:
     void fileChanged(const QString &path, QPrivateSignal);
     void directoryChanged(const QString &path, QPrivateSignal);
+    void filesChanged(const QStringList &paths, QPrivateSignal);
+    void directoriesChanged(const QStringList &paths, QPrivateSignal);
 
 private:
     Q_PRIVATE_SLOT(d_func(), void _q_fileChanged(const QString &path, bool removed))
     Q_PRIVATE_SLOT(d_func(), void _q_directoryChanged(const QString &path, bool removed))
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QFileSystemWatcher::WatchOptions)
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_FILESYSTEMWATCHER
@@ -324,8 +324,8 @@ QFseventsFileSystemWatcherEngine::~QFseventsFileSystemWatcherEngine()
 }
 
 QStringList QFseventsFileSystemWatcherEngine::addPaths(const QStringList &paths,
-                                                       QStringList *files,
-                                                       QStringList *directories)
+                                                       QFileSystemWatcherPathSet *files,
+                                                       QFileSystemWatcherPathSet *directories)
 {
     QMacAutoReleasePool pool;
 
@@ -362,13 +362,13 @@ QStringList QFseventsFileSystemWatcherEngine::addPaths(const QStringList &paths,
         if (isDir) {
             if (watchingState.watchedDirectories.contains(realPath))
                 continue;
-            directories->append(origPath);
+            directories->insert(origPath);
             watchedPath = realPath;
             it.remove();
         } else {
             if (files->contains(origPath))
                 continue;
-            files->append(origPath);
+            files->insert(origPath);
             it.remove();
 
             watchedPath = fi.path();
@@ -422,8 +422,8 @@ QStringList QFseventsFileSystemWatcherEngine::addPaths(const QStringList &paths,
 }
 
 QStringList QFseventsFileSystemWatcherEngine::removePaths(const QStringList &paths,
-                                                          QStringList *files,
-                                                          QStringList *directories)
+                                                          QFileSystemWatcherPathSet *files,
+                                                          QFileSystemWatcherPathSet *directories)
 {
     QMacAutoReleasePool pool;
 
@@ -448,7 +448,7 @@ QStringList QFseventsFileSystemWatcherEngine::removePaths(const QStringList &pat
             if (dirIt != watchingState.watchedDirectories.end()) {
                 needsRestart |= derefPath(dirIt->dirInfo.watchedPath);
                 watchingState.watchedDirectories.erase(dirIt);
-                directories->removeAll(origPath);
+                directories->remove(origPath);
                 it.remove();
                 DEBUG("Removed directory '%s'", qPrintable(realPath));
             }
@@ -464,7 +464,7 @@ QStringList QFseventsFileSystemWatcherEngine::removePaths(const QStringList &pat
                     filesInDir.erase(fIt);
                     if (filesInDir.isEmpty())
                         watchingState.watchedFiles.erase(pIt);
-                    files->removeAll(origPath);
+                    files->remove(origPath);
                     it.remove();
                     DEBUG("Removed file '%s'", qPrintable(realPath));
                 }
@@ -74,8 +74,8 @@ public:
 
     static QFseventsFileSystemWatcherEngine *create(QObject *parent);
 
-    QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories);
-    QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories);
+    QStringList addPaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
+    QStringList removePaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
 
     void processEvent(ConstFSEventStreamRef streamRef, size_t numEvents, char **eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[]);
 
@@ -259,21 +259,18 @@ QInotifyFileSystemWatcherEngine::~QInotifyFileSystemWatcherEngine()
 }
 
 QStringList QInotifyFileSystemWatcherEngine::addPaths(const QStringList &paths,
-                                                      QStringList *files,
-                                                      QStringList *directories)
+                                                      QFileSystemWatcherPathSet *files,
+                                                      QFileSystemWatcherPathSet *directories)
 {
-    QStringList p = paths;
-    QMutableListIterator<QString> it(p);
-    while (it.hasNext()) {
-        QString path = it.next();
+    // collect the paths we could not watch rather than removing the ones
+    // we could from a copy of \a paths, which is quadratic for long lists
+    QStringList unhandled;
+    for (const QString &path : paths) {
         QFileInfo fi(path);
         bool isDir = fi.isDir();
-        if (isDir) {
-            if (directories->contains(path))
-                continue;
-        } else {
-            if (files->contains(path))
-                continue;
+        if (isDir ? directories->contains(path) : files->contains(path)) {
+            unhandled.append(path);
+            continue;
         }
 
         int wd = inotify_add_watch(inotifyFd,
@@ -295,51 +292,54 @@ QStringList QInotifyFileSystemWatcherEngine::addPaths(const QStringList &paths,
                                        )));
         if (wd < 0) {
             qWarning().nospace() << "inotify_add_watch(" << path << ") failed: " << QSystemError(errno, QSystemError::NativeError).toString();
+            unhandled.append(path);
             continue;
         }
 
-        it.remove();
-
         int id = isDir ? -wd : wd;
         if (id < 0) {
-            directories->append(path);
+            directories->insert(path);
         } else {
-            files->append(path);
+            files->insert(path);
         }
 
         pathToID.insert(path, id);
         idToPath.insert(id, path);
     }
 
-    return p;
+    return unhandled;
 }
 
 QStringList QInotifyFileSystemWatcherEngine::removePaths(const QStringList &paths,
-                                                         QStringList *files,
-                                                         QStringList *directories)
+                                                         QFileSystemWatcherPathSet *files,
+                                                         QFileSystemWatcherPathSet *directories)
 {
-    QStringList p = paths;
-    QMutableListIterator<QString> it(p);
-    while (it.hasNext()) {
-        QString path = it.next();
-        int id = pathToID.take(path);
-        QString x = idToPath.take(id);
-        if (x.isEmpty() || x != path)
+    QStringList unhandled;
+    for (const QString &path : paths) {
+        const auto pit = pathToID.find(path);
+        if (pit == pathToID.end()) {
+            unhandled.append(path);
             continue;
+        }
+        const int id = pit.value();
+        pathToID.erase(pit);
+        idToPath.remove(id, path);
+
+        // the same inode may be watched through another path as well
+        if (!idToPath.contains(id)) {
+            int wd = id < 0 ? -id : id;
+            // qDebug() << "removing watch for path" << path << "wd" << wd;
+            inotify_rm_watch(inotifyFd, wd);
+        }
 
-        int wd = id < 0 ? -id : id;
-        // qDebug() << "removing watch for path" << path << "wd" << wd;
-        inotify_rm_watch(inotifyFd, wd);
-
-        it.remove();
         if (id < 0) {
-            directories->removeAll(path);
+            directories->remove(path);
         } else {
-            files->removeAll(path);
+            files->remove(path);
         }
     }
 
-    return p;
+    return unhandled;
 }
 
 void QInotifyFileSystemWatcherEngine::readFromInotify()
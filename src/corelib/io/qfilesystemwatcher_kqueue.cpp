@@ -93,8 +93,8 @@ QKqueueFileSystemWatcherEngine::~QKqueueFileSystemWatcherEngine()
 }
 
 QStringList QKqueueFileSystemWatcherEngine::addPaths(const QStringList &paths,
-                                                     QStringList *files,
-                                                     QStringList *directories)
+                                                     QFileSystemWatcherPathSet *files,
+                                                     QFileSystemWatcherPathSet *directories)
 {
     QStringList p = paths;
     QMutableListIterator<QString> it(p);
@@ -154,10 +154,10 @@ QStringList QKqueueFileSystemWatcherEngine::addPaths(const QStringList &paths,
         it.remove();
         if (id < 0) {
             DEBUG() << "QKqueueFileSystemWatcherEngine: added directory path" << path;
-            directories->append(path);
+            directories->insert(path);
         } else {
             DEBUG() << "QKqueueFileSystemWatcherEngine: added file path" << path;
-            files->append(path);
+            files->insert(path);
         }
 
         pathToID.insert(path, id);
@@ -168,8 +168,8 @@ QStringList QKqueueFileSystemWatcherEngine::addPaths(const QStringList &paths,
 }
 
 QStringList QKqueueFileSystemWatcherEngine::removePaths(const QStringList &paths,
-                                                        QStringList *files,
-                                                        QStringList *directories)
+                                                        QFileSystemWatcherPathSet *files,
+                                                        QFileSystemWatcherPathSet *directories)
 {
     QStringList p = paths;
     if (pathToID.isEmpty())
@@ -187,9 +187,9 @@ QStringList QKqueueFileSystemWatcherEngine::removePaths(const QStringList &paths
 
         it.remove();
         if (id < 0)
-            directories->removeAll(path);
+            directories->remove(path);
         else
-            files->removeAll(path);
+            files->remove(path);
     }
 
     return p;
@@ -72,8 +72,8 @@ public:
 
     static QKqueueFileSystemWatcherEngine *create(QObject *parent);
 
-    QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories);
-    QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories);
+    QStringList addPaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
+    QStringList removePaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
 
 private Q_SLOTS:
     void readFromKqueue();
@@ -59,9 +59,39 @@
 
 #include <QtCore/qstringlist.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qset.h>
 
 QT_BEGIN_NAMESPACE
 
+class QTimer;
+
+// the watched files or directories, remembering the order in which they
+// were added so that files() and directories() report them in that order
+class QFileSystemWatcherPathSet
+{
+public:
+    typedef QHash<QString, quint64>::key_iterator const_iterator;
+
+    bool contains(const QString &path) const { return order.contains(path); }
+    void insert(const QString &path)
+    {
+        if (!order.contains(path))
+            order.insert(path, next++);
+    }
+    bool remove(const QString &path) { return order.remove(path) != 0; }
+    int count() const { return order.count(); }
+    bool isEmpty() const { return order.isEmpty(); }
+
+    const_iterator cbegin() const { return order.keyBegin(); }
+    const_iterator cend() const { return order.keyEnd(); }
+
+    QStringList toList() const;
+
+private:
+    QHash<QString, quint64> order;
+    quint64 next = 0;
+};
+
 class QFileSystemWatcherEngine : public QObject
 {
     Q_OBJECT
@@ -76,14 +106,14 @@ public:
     // fills \a files and \a directories with the \a paths it could
     // watch, and returns a list of paths this engine could not watch
     virtual QStringList addPaths(const QStringList &paths,
-                                 QStringList *files,
-                                 QStringList *directories) = 0;
+                                 QFileSystemWatcherPathSet *files,
+                                 QFileSystemWatcherPathSet *directories) = 0;
     // removes \a paths from \a files and \a directories, and returns
     // a list of paths this engine does not know about (either addPath
     // failed or wasn't called)
     virtual QStringList removePaths(const QStringList &paths,
-                                    QStringList *files,
-                                    QStringList *directories) = 0;
+                                    QFileSystemWatcherPathSet *files,
+                                    QFileSystemWatcherPathSet *directories) = 0;
 
 Q_SIGNALS:
     void fileChanged(const QString &path, bool removed);
@@ -102,7 +132,25 @@ public:
     void initPollerEngine();
 
     QFileSystemWatcherEngine *native, *poller;
-    QStringList files, directories;
+    QFileSystemWatcherPathSet files, directories;
+
+    // recursively watched directories, mapped to the subdirectories that
+    // were added for them, and each of those mapped back to its root
+    QHash<QString, QSet<QString> > recursiveRoots;
+    QHash<QString, QString> recursiveRootOf;
+
+    void watchSubdirectories(QFileSystemWatcherEngine *engine, const QString &root,
+                             const QString &path);
+    void watchNewSubdirectories(QFileSystemWatcherEngine *engine, const QString &path);
+    QStringList forgetRecursivePath(const QString &path);
+
+    // changes waiting to be delivered by the notification timer
+    int notificationDelay;
+    QTimer *notificationTimer;
+    QSet<QString> pendingFiles, pendingDirectories;
+
+    void queueChange(QSet<QString> *pending, const QString &path);
+    void deliverPendingChanges();
 
     // private slots
     void _q_fileChanged(const QString &path, bool removed);
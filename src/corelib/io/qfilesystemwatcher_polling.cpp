@@ -52,30 +52,33 @@ QPollingFileSystemWatcherEngine::QPollingFileSystemWatcherEngine(QObject *parent
 }
 
 QStringList QPollingFileSystemWatcherEngine::addPaths(const QStringList &paths,
-                                                      QStringList *files,
-                                                      QStringList *directories)
+                                                      QFileSystemWatcherPathSet *files,
+                                                      QFileSystemWatcherPathSet *directories)
 {
-    QStringList p = paths;
-    QMutableListIterator<QString> it(p);
-    while (it.hasNext()) {
-        QString path = it.next();
+    QStringList unhandled;
+    for (const QString &path : paths) {
         QFileInfo fi(path);
-        if (!fi.exists())
+        if (!fi.exists()) {
+            unhandled.append(path);
             continue;
+        }
         if (fi.isDir()) {
-            if (directories->contains(path))
+            if (directories->contains(path)) {
+                unhandled.append(path);
                 continue;
-            directories->append(path);
+            }
+            directories->insert(path);
             if (!path.endsWith(QLatin1Char('/')))
                 fi = QFileInfo(path + QLatin1Char('/'));
             this->directories.insert(path, fi);
         } else {
-            if (files->contains(path))
+            if (files->contains(path)) {
+                unhandled.append(path);
                 continue;
-            files->append(path);
+            }
+            files->insert(path);
             this->files.insert(path, fi);
         }
-        it.remove();
     }
 
     if ((!this->files.isEmpty() ||
@@ -84,24 +87,21 @@ QStringList QPollingFileSystemWatcherEngine::addPaths(const QStringList &paths,
         timer.start(PollingInterval);
     }
 
-    return p;
+    return unhandled;
 }
 
 QStringList QPollingFileSystemWatcherEngine::removePaths(const QStringList &paths,
-                                                         QStringList *files,
-                                                         QStringList *directories)
+                                                         QFileSystemWatcherPathSet *files,
+                                                         QFileSystemWatcherPathSet *directories)
 {
-    QStringList p = paths;
-    QMutableListIterator<QString> it(p);
-    while (it.hasNext()) {
-        QString path = it.next();
-        if (this->directories.remove(path)) {
-            directories->removeAll(path);
-            it.remove();
-        } else if (this->files.remove(path)) {
-            files->removeAll(path);
-            it.remove();
-        }
+    QStringList unhandled;
+    for (const QString &path : paths) {
+        if (this->directories.remove(path))
+            directories->remove(path);
+        else if (this->files.remove(path))
+            files->remove(path);
+        else
+            unhandled.append(path);
     }
 
     if (this->files.isEmpty() &&
@@ -109,7 +109,7 @@ QStringList QPollingFileSystemWatcherEngine::removePaths(const QStringList &path
         timer.stop();
     }
 
-    return p;
+    return unhandled;
 }
 
 void QPollingFileSystemWatcherEngine::timeout()
@@ -363,8 +363,8 @@ QWindowsFileSystemWatcherEngine::~QWindowsFileSystemWatcherEngine()
 }
 
 QStringList QWindowsFileSystemWatcherEngine::addPaths(const QStringList &paths,
-                                                       QStringList *files,
-                                                       QStringList *directories)
+                                                       QFileSystemWatcherPathSet *files,
+                                                       QFileSystemWatcherPathSet *directories)
 {
     DEBUG() << "Adding" << paths.count() << "to existing" << (files->count() + directories->count()) << "watchers";
     QStringList p = paths;
@@ -449,9 +449,9 @@ QStringList QWindowsFileSystemWatcherEngine::addPaths(const QStringList &paths,
                 if (!h.contains(key)) {
                     thread->pathInfoForHandle[handle.handle].insert(key, pathInfo);
                     if (isDir)
-                        directories->append(path);
+                        directories->insert(path);
                     else
-                        files->append(path);
+                        files->insert(path);
                 }
                 it.remove();
                 thread->wakeup();
@@ -479,9 +479,9 @@ QStringList QWindowsFileSystemWatcherEngine::addPaths(const QStringList &paths,
 
                     thread->pathInfoForHandle[handle.handle].insert(QFileSystemWatcherPathKey(fileInfo.absoluteFilePath()), pathInfo);
                     if (isDir)
-                        directories->append(path);
+                        directories->insert(path);
                     else
-                        files->append(path);
+                        files->insert(path);
 
                     it.remove();
                     found = true;
@@ -497,9 +497,9 @@ QStringList QWindowsFileSystemWatcherEngine::addPaths(const QStringList &paths,
 
                 thread->pathInfoForHandle[handle.handle].insert(QFileSystemWatcherPathKey(fileInfo.absoluteFilePath()), pathInfo);
                 if (isDir)
-                    directories->append(path);
+                    directories->insert(path);
                 else
-                    files->append(path);
+                    files->insert(path);
 
                 connect(thread, SIGNAL(fileChanged(QString,bool)),
                         this, SIGNAL(fileChanged(QString,bool)));
@@ -524,8 +524,8 @@ QStringList QWindowsFileSystemWatcherEngine::addPaths(const QStringList &paths,
 }
 
 QStringList QWindowsFileSystemWatcherEngine::removePaths(const QStringList &paths,
-                                                          QStringList *files,
-                                                          QStringList *directories)
+                                                          QFileSystemWatcherPathSet *files,
+                                                          QFileSystemWatcherPathSet *directories)
 {
     DEBUG() << "removePaths" << paths;
     QStringList p = paths;
@@ -558,8 +558,8 @@ QStringList QWindowsFileSystemWatcherEngine::removePaths(const QStringList &path
                         thread->pathInfoForHandle[handle.handle];
                 if (h.remove(QFileSystemWatcherPathKey(fileInfo.absoluteFilePath()))) {
                     // ###
-                    files->removeAll(path);
-                    directories->removeAll(path);
+                    files->remove(path);
+                    directories->remove(path);
                     it.remove();
 
                     if (h.isEmpty()) {
@@ -79,8 +79,8 @@ public:
     explicit QWindowsFileSystemWatcherEngine(QObject *parent);
     ~QWindowsFileSystemWatcherEngine();
 
-    QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories);
-    QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories);
+    QStringList addPaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
+    QStringList removePaths(const QStringList &paths, QFileSystemWatcherPathSet *files, QFileSystemWatcherPathSet *directories);
 
     class Handle
     {
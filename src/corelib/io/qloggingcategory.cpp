@@ -39,6 +39,11 @@
 
 #include "qloggingcategory.h"
 #include "qloggingregistry_p.h"
+#ifndef QT_BOOTSTRAPPED
+#include "qelapsedtimer.h"
+#else
+#include "qdatetime.h"
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -47,6 +52,26 @@ const char qtDefaultCategoryName[] = "default";
 Q_GLOBAL_STATIC_WITH_ARGS(QLoggingCategory, qtDefaultCategory,
                           (qtDefaultCategoryName))
 
+struct QLoggingCategory::RateLimiter
+{
+    QAtomicInt limit;       // messages per second, 0 for no limit
+    QAtomicInt window;      // the second the current count belongs to
+    QAtomicInt count;       // messages seen in the current window
+    QAtomicInt suppressed;  // messages dropped since the last report
+};
+
+// the rate limiter only needs a coarse, preferably monotonic, clock
+static int currentSecond()
+{
+#ifndef QT_BOOTSTRAPPED
+    QElapsedTimer timer;
+    timer.start();
+    return int(timer.msecsSinceReference() / 1000);
+#else
+    return int(QDateTime::currentMSecsSinceEpoch() / 1000);
+#endif
+}
+
 #ifndef Q_ATOMIC_INT8_IS_SUPPORTED
 static void setBoolLane(QBasicAtomicInt *atomic, bool enable, int shift)
 {
@@ -124,6 +149,15 @@ static void setBoolLane(QBasicAtomicInt *atomic, bool enable, int shift)
 
     If no argument is passed, all messages will be logged.
 
+    \section1 Limiting the Message Rate
+
+    A category that is enabled in production may still produce more output
+    than is useful, for example when a message is logged from a tight loop.
+    \l setRateLimit() caps the number of messages a category lets through per
+    second; the remaining messages are dropped before their arguments are
+    evaluated, and the number of dropped messages is reported once the next
+    second has started.
+
     \section1 Configuring Categories
 
     The default configuration of categories can be overridden either by setting logging
@@ -218,8 +252,7 @@ static void setBoolLane(QBasicAtomicInt *atomic, bool enable, int shift)
     If \a category is \c{0}, the category name is changed to \c "default".
 */
 QLoggingCategory::QLoggingCategory(const char *category)
-    : d(0),
-      name(0)
+    : name(0)
 {
     init(category, QtDebugMsg);
 }
@@ -233,14 +266,14 @@ QLoggingCategory::QLoggingCategory(const char *category)
     \since 5.4
 */
 QLoggingCategory::QLoggingCategory(const char *category, QtMsgType enableForLevel)
-    : d(0),
-      name(0)
+    : name(0)
 {
     init(category, enableForLevel);
 }
 
 void QLoggingCategory::init(const char *category, QtMsgType severityLevel)
 {
+    d.store(Q_NULLPTR);
     enabled.store(0x01010101);   // enabledDebug = enabledWarning = enabledCritical = true;
 
     if (category)
@@ -259,6 +292,7 @@ QLoggingCategory::~QLoggingCategory()
 {
     if (QLoggingRegistry *reg = QLoggingRegistry::instance())
         reg->unregisterCategory(this);
+    delete d.load();
 }
 
 /*!
@@ -358,6 +392,100 @@ void QLoggingCategory::setEnabled(QtMsgType type, bool enable)
     }
 }
 
+/*!
+    \since 5.10
+
+    Limits the number of messages logged in this category to
+    \a messagesPerSecond. Messages exceeding the limit are discarded by the
+    \l qCDebug(), \l qCInfo(), \l qCWarning() and \l qCCritical() macros
+    without evaluating their arguments. When messages have been discarded, an
+    informational message stating their number is logged in this category
+    together with the first message of the following second, provided that
+    informational messages are enabled for it.
+
+    A value of 0, which is the default, removes the limit.
+
+    Like \l setEnabled(), this method is meant to be used from a filter
+    installed by \l installFilter(), or by code owning the category.
+
+    \sa rateLimit()
+*/
+void QLoggingCategory::setRateLimit(int messagesPerSecond)
+{
+    messagesPerSecond = qMax(messagesPerSecond, 0);
+
+    RateLimiter *limiter = d.loadAcquire();
+    if (!limiter) {
+        if (!messagesPerSecond)
+            return;
+        limiter = new RateLimiter;
+        limiter->limit.store(0);
+        limiter->window.store(currentSecond());
+        limiter->count.store(0);
+        limiter->suppressed.store(0);
+        if (!d.testAndSetOrdered(Q_NULLPTR, limiter)) {
+            delete limiter;
+            limiter = d.loadAcquire();
+        }
+    }
+    limiter->limit.store(messagesPerSecond);
+}
+
+/*!
+    \since 5.10
+
+    Returns the maximum number of messages logged in this category per
+    second, or 0 if the number is not limited.
+
+    \sa setRateLimit()
+*/
+int QLoggingCategory::rateLimit() const
+{
+    const RateLimiter *limiter = d.loadAcquire();
+    return limiter ? limiter->limit.load() : 0;
+}
+
+/*!
+    \fn bool QLoggingCategory::passesRateLimit() const
+    \internal
+
+    Returns \c true if one more message may be logged in this category
+    according to the limit set with setRateLimit(). Every call is counted as
+    a message.
+*/
+
+/*!
+    \internal
+*/
+bool QLoggingCategory::checkRateLimit() const
+{
+    RateLimiter *limiter = d.loadAcquire();
+    const int limit = limiter->limit.load();
+    if (limit <= 0)
+        return true;
+
+    // The window is only advanced by the first message of a new second, so
+    // a category that falls silent does not cost anything. The counters are
+    // updated without a lock; a few messages more or less around the change
+    // of the window are acceptable.
+    const int now = currentSecond();
+    const int window = limiter->window.load();
+    if (now != window && limiter->window.testAndSetRelaxed(window, now)) {
+        limiter->count.store(0);
+        const int dropped = limiter->suppressed.fetchAndStoreRelaxed(0);
+        if (dropped > 0 && isInfoEnabled()) {
+            QMessageLogger(Q_NULLPTR, 0, Q_NULLPTR, name)
+                .info("%d messages suppressed by the rate limit of %d messages per second",
+                      dropped, limit);
+        }
+    }
+
+    if (limiter->count.fetchAndAddRelaxed(1) < limit)
+        return true;
+    limiter->suppressed.ref();
+    return false;
+}
+
 /*!
     \fn QLoggingCategory &QLoggingCategory::operator()()
 
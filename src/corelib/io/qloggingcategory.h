@@ -70,6 +70,11 @@ public:
 #endif
     const char *categoryName() const { return name; }
 
+    void setRateLimit(int messagesPerSecond);
+    int rateLimit() const;
+    // used by the qCX macros; true if the message may be logged
+    bool passesRateLimit() const { return !d.load() || checkRateLimit(); }
+
     // allows usage of both factory method and variable in qCX macros
     QLoggingCategory &operator()() { return *this; }
     const QLoggingCategory &operator()() const { return *this; }
@@ -83,8 +88,10 @@ public:
 
 private:
     void init(const char *category, QtMsgType severityLevel);
+    bool checkRateLimit() const;
 
-    Q_DECL_UNUSED_MEMBER void *d; // reserved for future use
+    struct RateLimiter;
+    QBasicAtomicPointer<RateLimiter> d; // rate limiter, allocated on demand
     const char *name;
 
 #ifdef Q_BIG_ENDIAN
@@ -121,16 +128,16 @@ private:
     }
 
 #define qCDebug(category, ...) \
-    for (bool qt_category_enabled = category().isDebugEnabled(); qt_category_enabled; qt_category_enabled = false) \
+    for (bool qt_category_enabled = category().isDebugEnabled() && category().passesRateLimit(); qt_category_enabled; qt_category_enabled = false) \
         QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, category().categoryName()).debug(__VA_ARGS__)
 #define qCInfo(category, ...) \
-    for (bool qt_category_enabled = category().isInfoEnabled(); qt_category_enabled; qt_category_enabled = false) \
+    for (bool qt_category_enabled = category().isInfoEnabled() && category().passesRateLimit(); qt_category_enabled; qt_category_enabled = false) \
         QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, category().categoryName()).info(__VA_ARGS__)
 #define qCWarning(category, ...) \
-    for (bool qt_category_enabled = category().isWarningEnabled(); qt_category_enabled; qt_category_enabled = false) \
+    for (bool qt_category_enabled = category().isWarningEnabled() && category().passesRateLimit(); qt_category_enabled; qt_category_enabled = false) \
         QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, category().categoryName()).warning(__VA_ARGS__)
 #define qCCritical(category, ...) \
-    for (bool qt_category_enabled = category().isCriticalEnabled(); qt_category_enabled; qt_category_enabled = false) \
+    for (bool qt_category_enabled = category().isCriticalEnabled() && category().passesRateLimit(); qt_category_enabled; qt_category_enabled = false) \
         QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, category().categoryName()).critical(__VA_ARGS__)
 
 #else // defined(Q_COMPILER_VARIADIC_MACROS) || defined(Q_MOC_RUN)
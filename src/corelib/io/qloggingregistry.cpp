@@ -60,6 +60,7 @@ Q_GLOBAL_STATIC(QLoggingRegistry, qtLoggingRegistry)
     Constructs a logging rule with default values.
 */
 QLoggingRule::QLoggingRule() :
+    messageType(-1),
     enabled(false)
 {
 }
@@ -86,31 +87,29 @@ int QLoggingRule::pass(const QString &cat, QtMsgType msgType) const
     if (messageType > -1 && messageType != msgType)
         return 0;
 
-    if (flags == FullText) {
-        // full match
-        if (category == cat)
-            return (enabled ? 1 : -1);
-        else
-            return 0;
-    }
+    if (matches(cat))
+        return (enabled ? 1 : -1);
+    return 0;
+}
 
-    const int idx = cat.indexOf(category);
-    if (idx >= 0) {
-        if (flags == MidFilter) {
-            // matches somewhere
-            if (idx >= 0)
-                return (enabled ? 1 : -1);
-        } else if (flags == LeftFilter) {
-            // matches left
-            if (idx == 0)
-                return (enabled ? 1 : -1);
-        } else if (flags == RightFilter) {
-            // matches right
-            if (idx == (cat.count() - category.count()))
-                return (enabled ? 1 : -1);
-        }
+/*!
+    \internal
+    Returns \c true if the category pattern of the rule matches \a cat,
+    regardless of the message type.
+ */
+bool QLoggingRule::matches(const QString &cat) const
+{
+    switch (int(flags)) {
+    case FullText:
+        return category == cat;
+    case LeftFilter:
+        return cat.startsWith(category);
+    case RightFilter:
+        return cat.endsWith(category);
+    case MidFilter:
+        return cat.contains(category);
     }
-    return 0;
+    return false;
 }
 
 /*!
@@ -366,7 +365,11 @@ void QLoggingRegistry::setApiRules(const QString &content)
 
     const QMutexLocker locker(&registryMutex);
 
-    ruleSets[ApiRules] = parser.rules();
+    const QVector<QLoggingRule> rules = parser.rules();
+    // setting the same rules again does not change any category
+    if (rules == ruleSets[ApiRules])
+        return;
+    ruleSets[ApiRules] = rules;
 
     updateRules();
 }
@@ -438,20 +441,28 @@ void QLoggingRegistry::defaultCategoryFilter(QLoggingCategory *cat)
 
     QString categoryName = QLatin1String(cat->categoryName());
 
+    // match every rule once, then apply it to the message types it covers
     for (const auto &ruleSet : reg->ruleSets) {
         for (const auto &rule : ruleSet) {
-            int filterpass = rule.pass(categoryName, QtDebugMsg);
-            if (filterpass != 0)
-                debug = (filterpass > 0);
-            filterpass = rule.pass(categoryName, QtInfoMsg);
-            if (filterpass != 0)
-                info = (filterpass > 0);
-            filterpass = rule.pass(categoryName, QtWarningMsg);
-            if (filterpass != 0)
-                warning = (filterpass > 0);
-            filterpass = rule.pass(categoryName, QtCriticalMsg);
-            if (filterpass != 0)
-                critical = (filterpass > 0);
+            if (!rule.matches(categoryName))
+                continue;
+            switch (rule.messageType) {
+            case QtDebugMsg:
+                debug = rule.enabled;
+                break;
+            case QtInfoMsg:
+                info = rule.enabled;
+                break;
+            case QtWarningMsg:
+                warning = rule.enabled;
+                break;
+            case QtCriticalMsg:
+                critical = rule.enabled;
+                break;
+            case -1:
+                debug = info = warning = critical = rule.enabled;
+                break;
+            }
         }
     }
 
@@ -69,6 +69,14 @@ public:
     QLoggingRule();
     QLoggingRule(const QStringRef &pattern, bool enabled);
     int pass(const QString &categoryName, QtMsgType type) const;
+    bool matches(const QString &categoryName) const;
+
+    bool operator==(const QLoggingRule &other) const
+    {
+        return messageType == other.messageType && flags == other.flags
+                && enabled == other.enabled && category == other.category;
+    }
+    bool operator!=(const QLoggingRule &other) const { return !operator==(other); }
 
     enum PatternFlag {
         FullText = 0x1,
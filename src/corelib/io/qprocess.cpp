@@ -89,6 +89,7 @@ QT_END_NAMESPACE
 
 #include <qbytearray.h>
 #include <qelapsedtimer.h>
+#include <qfiledevice.h>
 #include <qcoreapplication.h>
 #include <qsocketnotifier.h>
 #include <qtimer.h>
@@ -876,6 +877,8 @@ QProcessPrivate::QProcessPrivate()
     childStartedPipe[0] = INVALID_Q_PIPE;
     childStartedPipe[1] = INVALID_Q_PIPE;
     forkfd = -1;
+    outputSink = 0;
+    outputSinkSpliceFailed = false;
     crashed = false;
     dying = false;
     emittedReadyRead = false;
@@ -1008,6 +1011,8 @@ bool QProcessPrivate::tryReadFromChannel(Channel *channel)
     Q_Q(QProcess);
     if (channel->pipe[0] == INVALID_Q_PIPE)
         return false;
+    if (outputSink && channel == &stdoutChannel)
+        return forwardToOutputSink(channel);
 
     qint64 available = bytesAvailableInChannel(channel);
     if (available == 0)
@@ -1075,6 +1080,105 @@ bool QProcessPrivate::tryReadFromChannel(Channel *channel)
     return didRead;
 }
 
+/*!
+    \internal
+
+    Moves what is available on the standard output pipe into outputSink
+    without going through the read buffer. On Linux, if the sink is a file
+    device, the data is spliced from the pipe into the sink's descriptor and
+    never copied into user space. Returns \c false, as nothing becomes
+    readable from the QProcess itself.
+*/
+bool QProcessPrivate::forwardToOutputSink(Channel *channel)
+{
+    qint64 available = bytesAvailableInChannel(channel);
+    if (available == 0)
+        available = 1;      // always try to move at least one byte, to detect EOF
+
+    qint64 moved = -1;
+    bool eof = false;
+#if defined(Q_OS_LINUX)
+    QFileDevice *file = qobject_cast<QFileDevice *>(outputSink);
+    if (!outputSinkSpliceFailed && file && file->handle() != -1) {
+        // whatever the sink buffered must reach the descriptor first
+        file->flush();
+        moved = 0;
+        bool spliceError = false;
+        while (moved < available) {
+            const qint64 chunk = available - moved;
+            ssize_t ret;
+            EINTR_LOOP(ret, ::splice(channel->pipe[0], 0, file->handle(), 0,
+                                     size_t(chunk), SPLICE_F_MOVE | SPLICE_F_NONBLOCK));
+            if (ret == -1 && errno == EAGAIN)
+                break;      // the pipe is empty but not at EOF
+            if (ret == -1 && moved == 0 && (errno == EINVAL || errno == ENOSYS)) {
+                // the sink's descriptor does not support splicing (e.g. it
+                // was opened in append mode), use plain reads and writes
+                outputSinkSpliceFailed = true;
+                moved = -1;
+                break;
+            }
+            if (ret == -1) {
+                spliceError = true;
+                break;
+            }
+            if (ret == 0) {
+                eof = true;
+                break;
+            }
+            moved += ret;
+            if (ret < chunk)
+                break;      // the pipe is drained, don't block
+        }
+
+        // splice() advanced the descriptor's offset behind the sink's
+        // back, let it catch up so that pos() and further writes agree
+        if (moved > 0 && !file->isSequential()) {
+            const QT_OFF_T offset = QT_LSEEK(file->handle(), 0, SEEK_CUR);
+            if (offset != -1)
+                file->seek(offset);
+        }
+        if (spliceError) {
+            setErrorAndEmit(QProcess::ReadError);
+            return false;
+        }
+    }
+#endif
+
+    if (moved == -1) {
+        char buffer[QRINGBUFFER_CHUNKSIZE];
+        moved = 0;
+        while (moved < available) {
+            const qint64 chunk = qMin<qint64>(available - moved, sizeof buffer);
+            qint64 readBytes = readFromChannel(channel, buffer, chunk);
+            if (readBytes == -2)
+                break;      // EWOULDBLOCK
+            if (readBytes == -1) {
+                setErrorAndEmit(QProcess::ReadError);
+                return false;
+            }
+            if (readBytes == 0) {
+                eof = true;
+                break;
+            }
+            if (outputSink->write(buffer, readBytes) != readBytes) {
+                setErrorAndEmit(QProcess::ReadError, outputSink->errorString());
+                return false;
+            }
+            moved += readBytes;
+            if (readBytes < chunk)
+                break;      // the pipe is drained, don't block
+        }
+    }
+
+    if (eof) {
+        if (channel->notifier)
+            channel->notifier->setEnabled(false);
+        closeChannel(channel);
+    }
+    return false;
+}
+
 /*!
     \internal
 */
@@ -1520,6 +1624,12 @@ void QProcess::setStandardErrorFile(const QString &fileName, OpenMode mode)
 
     Can be accomplished with QProcess with the following code:
     \snippet code/src_corelib_io_qprocess.cpp 3
+
+    The data flows from one process to the other through a single
+    operating system pipe, without passing through the calling process.
+    QProcessPipeline manages longer chains of processes.
+
+    \sa QProcessPipeline
 */
 void QProcess::setStandardOutputProcess(QProcess *destination)
 {
@@ -1951,6 +2061,10 @@ void QProcess::setProcessState(ProcessState state)
 
     \warning This function is called by QProcess on Unix and \macos
     only. On Windows and QNX, it is not called.
+
+    \note On Linux, QProcess objects that are not of a subclass start the
+    child with \c posix_spawn(), which is much faster than \c fork() if the
+    parent process uses a lot of memory. Subclasses always use \c fork().
 */
 void QProcess::setupChildProcess()
 {
@@ -325,6 +325,12 @@ public:
     void closeChannel(Channel *channel);
     void closeWriteChannel();
     bool tryReadFromChannel(Channel *channel); // obviously, only stdout and stderr
+    bool forwardToOutputSink(Channel *channel);
+
+    // set by QProcessPipeline: standard output is moved into this device
+    // instead of the read buffer
+    QIODevice *outputSink;
+    bool outputSinkSpliceFailed;
 
     QString program;
     QStringList arguments;
@@ -376,6 +382,9 @@ public:
     bool waitForReadyRead(int msecs = 30000);
     bool waitForBytesWritten(int msecs = 30000);
     bool waitForFinished(int msecs = 30000);
+#ifdef Q_OS_UNIX
+    static bool waitForAnyFinished(QProcessPrivate *const *processes, int count, int msecs);
+#endif
 
     qint64 bytesAvailableInChannel(const Channel *channel) const;
     qint64 readFromChannel(const Channel *channel, char *data, qint64 maxlen);
@@ -104,6 +104,7 @@ QT_END_NAMESPACE
 #include <qsocketnotifier.h>
 #include <qthread.h>
 #include <qelapsedtimer.h>
+#include <qvarlengtharray.h>
 
 #ifdef Q_OS_QNX
 #  include <sys/neutrino.h>
@@ -117,6 +118,16 @@ QT_END_NAMESPACE
 #include <forkfd.h>
 #endif
 
+// keep in sync with forkfd_qt.cpp
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 24)
+#  define QPROCESS_USE_SPAWN
+#  if __GLIBC__ > 2 || __GLIBC_MINOR__ >= 29
+#    define QPROCESS_SPAWN_HAS_CHDIR
+#  endif
+#  include <spawn.h>
+#  include <typeinfo>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 #if !defined(Q_OS_DARWIN)
@@ -359,6 +370,105 @@ static char **_q_dupEnvironment(const QProcessEnvironmentPrivate::Map &environme
     return envp;
 }
 
+struct ChildError
+{
+    int code;
+    char function[8];
+};
+
+#ifdef QPROCESS_USE_SPAWN
+/*
+    Starting the child with posix_spawn() instead of forkfd() avoids copying
+    the page tables of the parent, which is what makes starting processes
+    from a parent using a lot of memory slow: glibc implements it with
+    clone(CLONE_VM | CLONE_VFORK) and reports exec() failures to the caller.
+    setupChildProcess() needs a fork()ed child, so this is only done for
+    objects that are plain QProcess instances rather than of a subclass.
+*/
+static bool canSpawnChild(const QProcessPrivate *d, const char *workingDir, char **path)
+{
+    // a subclass may have reimplemented setupChildProcess(), which cannot
+    // be found out without calling it
+#ifdef __cpp_rtti
+    if (typeid(*d->q_func()) != typeid(QProcess))
+        return false;
+#else
+    return false;
+#endif
+#ifndef QPROCESS_SPAWN_HAS_CHDIR
+    if (workingDir)
+        return false;
+#else
+    Q_UNUSED(workingDir);
+#endif
+    // execvp() has a default search path if PATH is not set
+    return path || d->program.contains(QLatin1Char('/'));
+}
+
+static int spawnChild(const QProcessPrivate *d, const char *workingDir, char **path, char **argv,
+                      char **envp, pid_t *childPid, ChildError *error)
+{
+    posix_spawn_file_actions_t fileActions;
+    posix_spawnattr_t attributes;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawnattr_init(&attributes);
+
+    // reset the signal that we ignored
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    // set up the standard channels like execChild() does
+    if (d->inputChannelMode != QProcess::ForwardedInputChannel)
+        posix_spawn_file_actions_adddup2(&fileActions, d->stdinChannel.pipe[0], STDIN_FILENO);
+    if (d->processChannelMode != QProcess::ForwardedChannels) {
+        if (d->processChannelMode != QProcess::ForwardedOutputChannel)
+            posix_spawn_file_actions_adddup2(&fileActions, d->stdoutChannel.pipe[1], STDOUT_FILENO);
+        if (d->processChannelMode == QProcess::MergedChannels)
+            posix_spawn_file_actions_adddup2(&fileActions, STDOUT_FILENO, STDERR_FILENO);
+        else if (d->processChannelMode != QProcess::ForwardedErrorChannel)
+            posix_spawn_file_actions_adddup2(&fileActions, d->stderrChannel.pipe[1], STDERR_FILENO);
+    }
+#ifdef QPROCESS_SPAWN_HAS_CHDIR
+    if (workingDir)
+        posix_spawn_file_actions_addchdir_np(&fileActions, workingDir);
+#endif
+
+    char **environment = envp ? envp : environ;
+    int ffd = -1;
+    if (path) {
+        errno = ENOENT;
+        for (char **arg = path; *arg && ffd == -1; ++arg) {
+            // don't start a child for candidates that cannot be executed
+            if (::access(*arg, X_OK) != 0)
+                continue;
+            // like execChild(), only pass the full path as argv[0] along
+            // with a custom environment
+            if (envp)
+                argv[0] = *arg;
+            ffd = ::spawnfd(FFD_CLOEXEC, childPid, *arg, &fileActions, &attributes, argv, environment);
+        }
+    } else {
+        ffd = ::spawnfd(FFD_CLOEXEC, childPid, argv[0], &fileActions, &attributes, argv, environment);
+    }
+    error->code = errno;
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&fileActions);
+
+    if (ffd == -1) {
+        // posix_spawn() does not tell which step failed
+        if (workingDir && ::access(workingDir, X_OK) != 0)
+            strcpy(error->function, "chdir");
+        else
+            strcpy(error->function, "execve");
+    }
+    return ffd;
+}
+#endif // QPROCESS_USE_SPAWN
+
 void QProcessPrivate::startProcess()
 {
     Q_Q(QProcess);
@@ -467,8 +577,16 @@ void QProcessPrivate::startProcess()
     }
 
     // Start the process manager, and fork off the child process.
-    pid_t childPid;
-    forkfd = ::forkfd(FFD_CLOEXEC, &childPid);
+    pid_t childPid = 0;
+    bool spawned = false;
+#ifdef QPROCESS_USE_SPAWN
+    ChildError spawnError = { 0, {} };
+    spawned = canSpawnChild(this, workingDirPtr, path);
+    if (spawned)
+        forkfd = spawnChild(this, workingDirPtr, path, argv, envp, &childPid, &spawnError);
+    else
+#endif
+        forkfd = ::forkfd(FFD_CLOEXEC, &childPid);
     int lastForkErrno = errno;
     if (forkfd != FFD_CHILD_PROCESS) {
         // Parent process.
@@ -485,11 +603,10 @@ void QProcessPrivate::startProcess()
         delete [] path;
     }
 
-    // On QNX, if spawnChild failed, childPid will be -1 but forkfd is still 0.
-    // This is intentional because we only want to handle failure to fork()
-    // here, which is a rare occurrence. Handling of the failure to start is
-    // done elsewhere.
-    if (forkfd == -1) {
+    // Only a failure to fork() is handled here, which is a rare occurrence.
+    // If posix_spawn() failed, forkfd is -1 as well, but that is reported
+    // as a failure to start through the child-started pipe below.
+    if (forkfd == -1 && !spawned) {
         // Cleanup, report error and return
 #if defined (QPROCESS_DEBUG)
         qDebug("fork failed: %s", qPrintable(qt_error_string(lastForkErrno)));
@@ -507,6 +624,12 @@ void QProcessPrivate::startProcess()
         ::_exit(-1);
     }
 
+#ifdef QPROCESS_USE_SPAWN
+    // there is no child to report that it could not be started
+    if (spawned && forkfd == -1)
+        qt_safe_write(childStartedPipe[1], &spawnError, sizeof(spawnError));
+#endif
+
     pid = Q_PID(childPid);
 
     // parent
@@ -537,19 +660,13 @@ void QProcessPrivate::startProcess()
     if (stderrChannel.pipe[0] != -1)
         ::fcntl(stderrChannel.pipe[0], F_SETFL, ::fcntl(stderrChannel.pipe[0], F_GETFL) | O_NONBLOCK);
 
-    if (threadData->eventDispatcher) {
+    if (forkfd != -1 && threadData->eventDispatcher) {
         deathNotifier = new QSocketNotifier(forkfd, QSocketNotifier::Read, q);
         QObject::connect(deathNotifier, SIGNAL(activated(int)),
                          q, SLOT(_q_processDied()));
     }
 }
 
-struct ChildError
-{
-    int code;
-    char function[8];
-};
-
 void QProcessPrivate::execChild(const char *workingDir, char **path, char **argv, char **envp)
 {
     ::signal(SIGPIPE, SIG_DFL);         // reset the signal that we ignored
@@ -891,6 +1008,62 @@ bool QProcessPrivate::waitForFinished(int msecs)
     return false;
 }
 
+/*
+    Waits until at least one of \a processes has left the running state,
+    servicing the channels of all of them in the meantime. Used by
+    QProcessPipeline, whose stages feed each other and so cannot be waited
+    for one at a time.
+*/
+bool QProcessPrivate::waitForAnyFinished(QProcessPrivate *const *processes, int count, int msecs)
+{
+    const int n = QProcessPoller::n_pfds;
+    QVarLengthArray<pollfd, 8 * QProcessPoller::n_pfds> pfds(count * n);
+
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+
+    forever {
+        for (int i = 0; i < count; ++i) {
+            QProcessPoller poller(*processes[i]);
+            memcpy(pfds.data() + i * n, poller.pfds, sizeof(poller.pfds));
+        }
+
+        int timeout = qt_subtract_from_timeout(msecs, stopWatch.elapsed());
+        int ret = qt_poll_msecs(pfds.data(), pfds.size(), timeout);
+
+        if (ret < 0) {
+            const QString description = qt_error_string(errno);
+            for (int i = 0; i < count; ++i)
+                processes[i]->setError(QProcess::UnknownError, description);
+            return false;
+        }
+        if (ret == 0) {
+            for (int i = 0; i < count; ++i)
+                processes[i]->setError(QProcess::Timedout);
+            return false;
+        }
+
+        bool changed = false;
+        for (int i = 0; i < count; ++i) {
+            QProcessPrivate *d = processes[i];
+            const pollfd *pfd = pfds.constData() + i * n;
+
+            if (qt_pollfd_check(pfd[4], POLLIN) && !d->_q_startupNotification())
+                changed = true;
+            if (qt_pollfd_check(pfd[0], POLLOUT))
+                d->_q_canWrite();
+            if (qt_pollfd_check(pfd[1], POLLIN))
+                d->_q_canReadStandardOutput();
+            if (qt_pollfd_check(pfd[2], POLLIN))
+                d->_q_canReadStandardError();
+            if (qt_pollfd_check(pfd[3], POLLIN) && d->_q_processDied())
+                changed = true;
+        }
+        if (changed)
+            return true;
+    }
+}
+
 void QProcessPrivate::findExitCode()
 {
 }
@@ -0,0 +1,475 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qprocesspipeline.h"
+#include "qprocess_p.h"
+
+#include <qelapsedtimer.h>
+#include <qvarlengtharray.h>
+#include <qvector.h>
+#include <private/qobject_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QProcessPipelinePrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QProcessPipeline)
+public:
+    QProcessPipelinePrivate()
+        : outputMode(QIODevice::Truncate), outputDevice(0), running(false), starting(false)
+    {
+    }
+
+    static QProcessPrivate *stagePrivate(QProcess *process)
+    { return static_cast<QProcessPrivate *>(QObjectPrivate::get(process)); }
+
+    int remainingTime(const QElapsedTimer &timer, int msecs) const
+    { return msecs == -1 ? -1 : qMax(0, msecs - int(timer.elapsed())); }
+
+    void checkFinished();
+
+    // private slots
+    void _q_stageFinished();
+    void _q_stageError(QProcess::ProcessError error);
+
+    QVector<QProcess *> stages;
+    QString inputFile;
+    QString outputFile;
+    QIODevice::OpenMode outputMode;
+    QIODevice *outputDevice;
+    bool running;
+    bool starting;
+};
+
+void QProcessPipelinePrivate::checkFinished()
+{
+    Q_Q(QProcessPipeline);
+    if (!running || starting)
+        return;
+    for (const QProcess *stage : qAsConst(stages)) {
+        if (stage->state() != QProcess::NotRunning)
+            return;
+    }
+    running = false;
+    emit q->finished();
+}
+
+void QProcessPipelinePrivate::_q_stageFinished()
+{
+    Q_Q(QProcessPipeline);
+    QProcess *stage = static_cast<QProcess *>(q->sender());
+    emit q->stageFinished(stages.indexOf(stage), stage->exitCode(), stage->exitStatus());
+    checkFinished();
+}
+
+void QProcessPipelinePrivate::_q_stageError(QProcess::ProcessError error)
+{
+    Q_Q(QProcessPipeline);
+    QProcess *stage = static_cast<QProcess *>(q->sender());
+    emit q->errorOccurred(stages.indexOf(stage), error);
+    // a stage that failed to start never emits finished()
+    if (error == QProcess::FailedToStart)
+        checkFinished();
+}
+
+/*!
+    \class QProcessPipeline
+    \inmodule QtCore
+    \since 5.10
+
+    \brief The QProcessPipeline class runs a chain of external programs,
+    each one reading the output of the previous one.
+
+    \ingroup io
+
+    \reentrant
+
+    A pipeline is built by calling addStage() once for every program, in the
+    order in which the data flows through them, and is then run with
+    start(). It is the equivalent of a shell command line such as
+    \c{gzip -dc access.log.gz | sort | uniq -c}:
+
+    \snippet code/src_corelib_io_qprocesspipeline.cpp 0
+
+    The standard output of each stage is connected to the standard input of
+    the next one with a single operating system pipe, as done by
+    QProcess::setStandardOutputProcess(). The data moves directly from one
+    child process to the next and never passes through the application, so
+    a pipeline can move large amounts of data at very little cost to the
+    calling process.
+
+    The standard input of the first stage is a regular QProcess channel, so
+    data can be written to it with stage(0)->write(); remember to call
+    QProcess::closeWriteChannel() when done. Alternatively,
+    setStandardInputFile() makes the first stage read a file directly.
+
+    The output of the last stage can be consumed in one of three ways:
+
+    \list
+    \li By default, it is read through the QProcess returned by stage() for
+        the last stage, like the output of any other QProcess.
+    \li setStandardOutputFile() makes the last stage write to a file
+        directly.
+    \li setOutputDevice() makes the pipeline forward the output to a
+        QIODevice as it arrives, without buffering it in the QProcess. On
+        Linux, if the device is a QFileDevice (for instance a QFile), the
+        data is moved from the pipe into the file by the kernel and is never
+        copied into the application's memory.
+    \endlist
+
+    The standard error of every stage is forwarded to the standard error of
+    the calling process, as a shell does. This can be changed for individual
+    stages with QProcess::setProcessChannelMode(); the pipeline then reads
+    that stage's standard error like QProcess does.
+
+    Every stage reports its result separately: stageFinished() is emitted as
+    each one exits, and the exit code and status of all stages remain
+    available through stage() afterwards. finished() is emitted once no
+    stage is running any more, and failedStage() tells which stage, if any,
+    did not complete successfully.
+
+    \sa QProcess
+*/
+
+/*!
+    Constructs a QProcessPipeline object with the given \a parent. The
+    pipeline has no stages.
+*/
+QProcessPipeline::QProcessPipeline(QObject *parent)
+    : QObject(*new QProcessPipelinePrivate, parent)
+{
+}
+
+/*!
+    Destroys the QProcessPipeline object. Stages that are still running are
+    killed, as QProcess does when it is destroyed.
+*/
+QProcessPipeline::~QProcessPipeline()
+{
+    Q_D(QProcessPipeline);
+    for (QProcess *stage : qAsConst(d->stages)) {
+        stage->disconnect(this);
+        QProcessPipelinePrivate::stagePrivate(stage)->outputSink = 0;
+    }
+}
+
+/*!
+    Appends a stage that runs \a program with the given \a arguments, and
+    returns the QProcess that will run it. The returned object is owned by
+    the pipeline. It can be used to configure the stage further (for
+    instance its environment or working directory) before start() is
+    called, and to inspect its exit code and status afterwards.
+
+    Do not change the standard input of any stage but the first, or the
+    standard output of any stage but the last, since those connect the
+    stages to each other.
+
+    Stages cannot be added while the pipeline is running; \c nullptr is
+    returned in that case.
+*/
+QProcess *QProcessPipeline::addStage(const QString &program, const QStringList &arguments)
+{
+    Q_D(QProcessPipeline);
+    if (d->running) {
+        qWarning("QProcessPipeline::addStage: Cannot add a stage while the pipeline is running");
+        return Q_NULLPTR;
+    }
+
+    QProcess *stage = new QProcess(this);
+    stage->setProgram(program);
+    stage->setArguments(arguments);
+    stage->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    if (!d->stages.isEmpty())
+        d->stages.last()->setStandardOutputProcess(stage);
+
+    connect(stage, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(_q_stageFinished()));
+    connect(stage, SIGNAL(errorOccurred(QProcess::ProcessError)),
+            SLOT(_q_stageError(QProcess::ProcessError)));
+    d->stages.append(stage);
+    return stage;
+}
+
+/*!
+    Returns the number of stages in the pipeline.
+*/
+int QProcessPipeline::stageCount() const
+{
+    Q_D(const QProcessPipeline);
+    return d->stages.size();
+}
+
+/*!
+    Returns the QProcess running the stage at position \a index, or
+    \c nullptr if there is no such stage.
+*/
+QProcess *QProcessPipeline::stage(int index) const
+{
+    Q_D(const QProcessPipeline);
+    return d->stages.value(index);
+}
+
+/*!
+    Makes the first stage read its standard input from the file \a fileName,
+    as QProcess::setStandardInputFile() does. The file is opened by the
+    first stage when the pipeline is started. Passing an empty string
+    restores the default, a QProcess write channel.
+*/
+void QProcessPipeline::setStandardInputFile(const QString &fileName)
+{
+    Q_D(QProcessPipeline);
+    d->inputFile = fileName;
+}
+
+/*!
+    Makes the last stage write its standard output to the file \a fileName,
+    as QProcess::setStandardOutputFile() does; \a mode must be either
+    QIODevice::Truncate or QIODevice::Append. The last stage writes to the
+    file directly. This takes precedence over setOutputDevice(). Passing an
+    empty string restores the default.
+*/
+void QProcessPipeline::setStandardOutputFile(const QString &fileName, QIODevice::OpenMode mode)
+{
+    Q_D(QProcessPipeline);
+    Q_ASSERT(mode == QIODevice::Append || mode == QIODevice::Truncate);
+    d->outputFile = fileName;
+    d->outputMode = mode;
+}
+
+/*!
+    Makes the pipeline write the standard output of the last stage to
+    \a device as it arrives, instead of making it available for reading from
+    the last stage. \a device must be open for writing, and must stay valid
+    while the pipeline runs. Passing \c nullptr restores the default.
+
+    On Linux, if \a device is a QFileDevice, the output is transferred with
+    \c splice(), so that the data never reaches the application's memory.
+    Anything \a device has buffered is flushed first, and the device's
+    position is not updated; do not write to \a device while the pipeline
+    runs.
+
+    \sa setStandardOutputFile()
+*/
+void QProcessPipeline::setOutputDevice(QIODevice *device)
+{
+    Q_D(QProcessPipeline);
+    d->outputDevice = device;
+}
+
+/*!
+    Returns the device set with setOutputDevice(), or \c nullptr.
+*/
+QIODevice *QProcessPipeline::outputDevice() const
+{
+    Q_D(const QProcessPipeline);
+    return d->outputDevice;
+}
+
+/*!
+    Starts all stages of the pipeline. If a stage fails to start,
+    errorOccurred() is emitted for it; the stages around it see the end of
+    their input or a closed output and normally terminate on their own.
+
+    \sa waitForStarted(), waitForFinished()
+*/
+void QProcessPipeline::start()
+{
+    Q_D(QProcessPipeline);
+    if (d->running) {
+        qWarning("QProcessPipeline::start: Pipeline is already running");
+        return;
+    }
+    if (d->stages.isEmpty()) {
+        qWarning("QProcessPipeline::start: Pipeline has no stages");
+        return;
+    }
+    if (d->outputDevice && d->outputFile.isEmpty() && !d->outputDevice->isWritable()) {
+        qWarning("QProcessPipeline::start: Output device is not open for writing");
+        return;
+    }
+
+    QProcess *first = d->stages.first();
+    QProcess *last = d->stages.last();
+    if (!d->inputFile.isEmpty())
+        first->setStandardInputFile(d->inputFile);
+    if (!d->outputFile.isEmpty())
+        last->setStandardOutputFile(d->outputFile, d->outputMode);
+    QProcessPrivate *lastPrivate = QProcessPipelinePrivate::stagePrivate(last);
+    lastPrivate->outputSink = d->outputFile.isEmpty() ? d->outputDevice : Q_NULLPTR;
+    lastPrivate->outputSinkSpliceFailed = false;
+
+    d->running = true;
+    d->starting = true;
+    for (QProcess *stage : qAsConst(d->stages))
+        stage->start();
+    d->starting = false;
+    d->checkFinished();
+}
+
+/*!
+    Blocks until every stage has started, or until \a msecs milliseconds
+    have passed. Returns \c true if all stages are running; returns \c false
+    if a stage failed to start or the operation timed out. If \a msecs is
+    -1, this function will not time out.
+*/
+bool QProcessPipeline::waitForStarted(int msecs)
+{
+    Q_D(QProcessPipeline);
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+    for (QProcess *stage : qAsConst(d->stages)) {
+        if (stage->state() == QProcess::Starting
+                && !stage->waitForStarted(d->remainingTime(stopWatch, msecs)))
+            return false;
+        if (stage->state() != QProcess::Running)
+            return false;
+    }
+    return !d->stages.isEmpty();
+}
+
+/*!
+    Blocks until no stage is running any more, or until \a msecs
+    milliseconds have passed. Returns \c true if the pipeline finished;
+    otherwise returns \c false (if the operation timed out, if an error
+    occurred, or if the pipeline was not running). If \a msecs is -1, this
+    function will not time out.
+
+    While waiting, the channels of all stages are serviced together: data
+    written to the first stage is delivered and the output of the last stage
+    is read or forwarded to the output device, so the stages cannot stall
+    each other.
+
+    \sa finished(), failedStage()
+*/
+bool QProcessPipeline::waitForFinished(int msecs)
+{
+    Q_D(QProcessPipeline);
+    if (!d->running)
+        return false;
+
+    QElapsedTimer stopWatch;
+    stopWatch.start();
+    while (d->running) {
+#ifdef Q_OS_UNIX
+        QVarLengthArray<QProcessPrivate *, 8> active;
+        for (QProcess *stage : qAsConst(d->stages)) {
+            if (stage->state() != QProcess::NotRunning)
+                active.append(QProcessPipelinePrivate::stagePrivate(stage));
+        }
+        if (!QProcessPrivate::waitForAnyFinished(active.constData(), active.size(),
+                                                 d->remainingTime(stopWatch, msecs)))
+            return false;
+#else
+        // QProcess can only wait for one process at a time; give each stage
+        // a short slice so that none of them stalls on a full pipe
+        for (QProcess *stage : qAsConst(d->stages)) {
+            if (stage->state() == QProcess::NotRunning)
+                continue;
+            const int remaining = d->remainingTime(stopWatch, msecs);
+            if (remaining == 0)
+                return false;
+            stage->waitForFinished(remaining == -1 ? 10 : qMin(remaining, 10));
+        }
+#endif
+    }
+    return true;
+}
+
+/*!
+    Returns \c true if at least one stage of the pipeline is running, or
+    if finished() has not been emitted yet for the last run.
+*/
+bool QProcessPipeline::isRunning() const
+{
+    Q_D(const QProcessPipeline);
+    return d->running;
+}
+
+/*!
+    Returns the index of the first stage that failed to start, crashed, or
+    exited with a non-zero exit code, or -1 if every stage completed
+    successfully. This is the equivalent of the \c pipefail option of
+    common shells. The result is only meaningful after the pipeline has
+    finished.
+
+    \sa stageFinished()
+*/
+int QProcessPipeline::failedStage() const
+{
+    Q_D(const QProcessPipeline);
+    for (int i = 0; i < d->stages.size(); ++i) {
+        const QProcess *stage = d->stages.at(i);
+        if (stage->error() == QProcess::FailedToStart
+                || stage->exitStatus() != QProcess::NormalExit
+                || stage->exitCode() != 0)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+    \fn void QProcessPipeline::stageFinished(int stage, int exitCode, QProcess::ExitStatus exitStatus)
+
+    This signal is emitted when the stage at index \a stage finishes.
+    \a exitCode and \a exitStatus are those of the stage's process.
+
+    \sa QProcess::finished()
+*/
+
+/*!
+    \fn void QProcessPipeline::finished()
+
+    This signal is emitted when no stage of the pipeline is running any
+    more, including stages that failed to start.
+
+    \sa stageFinished(), failedStage()
+*/
+
+/*!
+    \fn void QProcessPipeline::errorOccurred(int stage, QProcess::ProcessError error)
+
+    This signal is emitted when the stage at index \a stage reports
+    \a error.
+
+    \sa QProcess::errorOccurred()
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qprocesspipeline.cpp"
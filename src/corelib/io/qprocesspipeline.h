@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QPROCESSPIPELINE_H
+#define QPROCESSPIPELINE_H
+
+#include <QtCore/qprocess.h>
+
+QT_REQUIRE_CONFIG(process);
+
+QT_BEGIN_NAMESPACE
+
+class QProcessPipelinePrivate;
+
+class Q_CORE_EXPORT QProcessPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QProcessPipeline(QObject *parent = Q_NULLPTR);
+    ~QProcessPipeline();
+
+    QProcess *addStage(const QString &program, const QStringList &arguments = QStringList());
+    int stageCount() const;
+    QProcess *stage(int index) const;
+
+    void setStandardInputFile(const QString &fileName);
+    void setStandardOutputFile(const QString &fileName, QIODevice::OpenMode mode = QIODevice::Truncate);
+    void setOutputDevice(QIODevice *device);
+    QIODevice *outputDevice() const;
+
+    void start();
+    bool waitForStarted(int msecs = 30000);
+    bool waitForFinished(int msecs = 30000);
+
+    bool isRunning() const;
+    int failedStage() const;
+
+Q_SIGNALS:
+    void stageFinished(int stage, int exitCode, QProcess::ExitStatus exitStatus);
+    void finished();
+    void errorOccurred(int stage, QProcess::ProcessError error);
+
+private:
+    Q_DECLARE_PRIVATE(QProcessPipeline)
+    Q_DISABLE_COPY(QProcessPipeline)
+
+    Q_PRIVATE_SLOT(d_func(), void _q_stageFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_stageError(QProcess::ProcessError))
+};
+
+QT_END_NAMESPACE
+
+#endif // QPROCESSPIPELINE_H
@@ -40,8 +40,10 @@
 #include "qresource.h"
 #include "qresource_p.h"
 #include "qresource_iterator_p.h"
+#include "qresourceindex_p.h"
 #include "qset.h"
 #include "qmutex.h"
+#include "qthread.h"
 #include "qdebug.h"
 #include "qlocale.h"
 #include "qglobal.h"
@@ -103,22 +105,26 @@ class QResourceRoot
         Directory = 0x02
     };
     const uchar *tree, *names, *payloads;
+    const uchar *index;
     int version;
+    quint32 indexBuckets, indexSlots;
     inline int findOffset(int node) const { return node * (14 + (version >= 0x02 ? 8 : 0)); } //sizeof each tree element
     uint hash(int node) const;
     QString name(int node) const;
+    bool nameEquals(int node, const QStringRef &segment) const;
     short flags(int node) const;
+    int findIndexedNode(const QString &path, const QLocale &locale) const;
 public:
     mutable QAtomicInt ref;
 
-    inline QResourceRoot(): tree(0), names(0), payloads(0), version(0) {}
+    inline QResourceRoot(): tree(0), names(0), payloads(0), index(0), version(0), indexBuckets(0), indexSlots(0) {}
     inline QResourceRoot(int version, const uchar *t, const uchar *n, const uchar *d) { setSource(version, t, n, d); }
     virtual ~QResourceRoot() { }
     int findNode(const QString &path, const QLocale &locale=QLocale()) const;
     inline bool isContainer(int node) const { return flags(node) & Directory; }
     inline bool isCompressed(int node) const { return flags(node) & Compressed; }
     const uchar *data(int node, qint64 *size) const;
-    QDateTime lastModified(int node) const;
+    quint64 lastModified(int node) const;
     QStringList children(int node) const;
     virtual QString mappingRoot() const { return QString(); }
     bool mappingRootSubdir(const QString &path, QString *match=0) const;
@@ -131,6 +137,17 @@ public:
 
 protected:
     inline void setSource(int v, const uchar *t, const uchar *n, const uchar *d) {
+        index = 0;
+        indexBuckets = indexSlots = 0;
+        if (v >= 0x03) {
+            // the path index precedes the tree
+            const quint32 indexSize = qFromBigEndian<quint32>(t);
+            indexBuckets = qFromBigEndian<quint32>(t + 4);
+            indexSlots = qFromBigEndian<quint32>(t + 8);
+            if (indexBuckets && indexSlots)
+                index = t + QResourceIndexHeaderSize;
+            t += 4 + indexSize;
+        }
         tree = t;
         names = n;
         payloads = d;
@@ -153,9 +170,30 @@ Q_DECLARE_TYPEINFO(QResourceRoot, Q_MOVABLE_TYPE);
 typedef QList<QResourceRoot*> ResourceList;
 struct QResourceGlobalData
 {
+    ~QResourceGlobalData();
+    void publishResourceList();
+    void retireResourceRoot(QResourceRoot *root);
+    void reclaimRetired();
+    void waitForReaders();
+
     QMutex resourceMutex{QMutex::Recursive};
     ResourceList resourceList;
     QStringList resourceSearchPaths;
+
+    // Lookups read an immutable copy of resourceList without locking.
+    // Copies and roots replaced while lookups are running are retired
+    // and deleted once no lookup is in progress any more.
+    QAtomicPointer<const ResourceList> publishedList;
+    QAtomicInt activeReaders;
+    QAtomicInt hasRetired;
+    QVector<const ResourceList *> retiredLists;
+    QVector<QResourceRoot *> retiredRoots;
+
+    // Lookups also count themselves in one of two counters, chosen by the
+    // parity of readerEpoch, so that unregistering can wait for the lookups
+    // that may still see an older list without waiting for later ones.
+    QAtomicInt readerEpoch;
+    QAtomicInt epochReaders[2];
 };
 Q_GLOBAL_STATIC(QResourceGlobalData, resourceGlobalData)
 
@@ -168,6 +206,124 @@ static inline ResourceList *resourceList()
 static inline QStringList *resourceSearchPaths()
 { return &resourceGlobalData->resourceSearchPaths; }
 
+QResourceGlobalData::~QResourceGlobalData()
+{
+    delete publishedList.load();
+    qDeleteAll(retiredLists);
+    qDeleteAll(retiredRoots);
+}
+
+// must be called with resourceMutex locked, after changing resourceList
+void QResourceGlobalData::publishResourceList()
+{
+    const ResourceList *old = publishedList.fetchAndStoreOrdered(new ResourceList(resourceList));
+    if (old) {
+        retiredLists.append(old);
+        hasRetired.storeRelease(1);
+    }
+    reclaimRetired();
+}
+
+// must be called with resourceMutex locked, once root->ref dropped to 0
+void QResourceGlobalData::retireResourceRoot(QResourceRoot *root)
+{
+    retiredRoots.append(root);
+    hasRetired.storeRelease(1);
+    reclaimRetired();
+}
+
+// must be called with resourceMutex locked
+void QResourceGlobalData::reclaimRetired()
+{
+    // A reader that increments activeReaders after this point is
+    // guaranteed to see the latest published list, so none of the
+    // retired objects can be reached from it.
+    if (activeReaders.fetchAndAddOrdered(0) != 0)
+        return;
+    qDeleteAll(retiredLists);
+    retiredLists.clear();
+    qDeleteAll(retiredRoots);
+    retiredRoots.clear();
+    hasRetired.storeRelease(0);
+}
+
+// must be called with resourceMutex locked, after publishing a list from
+// which data owned by the caller has been removed: returns once no lookup
+// can still read that data
+void QResourceGlobalData::waitForReaders()
+{
+    const int epoch = readerEpoch.fetchAndAddOrdered(1);
+    while (epochReaders[epoch & 1].fetchAndAddOrdered(0) != 0) {
+#ifndef QT_BOOTSTRAPPED
+        QThread::yieldCurrentThread();
+#endif
+    }
+}
+
+/*
+    Gives lock-free access to the registered resource roots. The roots in
+    list() stay valid for the lifetime of the reader, but must be
+    referenced with refResourceRoot() to be kept beyond that.
+*/
+class QResourceListReader
+{
+public:
+    QResourceListReader() : d(resourceGlobalData())
+    {
+        d->activeReaders.fetchAndAddOrdered(1);
+        for (;;) {
+            // a lookup counted in an epoch that has ended already might
+            // be missed by waitForReaders(), so check and retry
+            m_epoch = d->readerEpoch.fetchAndAddOrdered(0);
+            d->epochReaders[m_epoch & 1].fetchAndAddOrdered(1);
+            if (d->readerEpoch.fetchAndAddOrdered(0) == m_epoch)
+                break;
+            d->epochReaders[m_epoch & 1].fetchAndAddOrdered(-1);
+        }
+        m_list = d->publishedList.loadAcquire();
+    }
+    ~QResourceListReader()
+    {
+        d->epochReaders[m_epoch & 1].fetchAndAddOrdered(-1);
+        if (d->activeReaders.fetchAndAddOrdered(-1) == 1 && d->hasRetired.loadAcquire()) {
+            QMutexLocker lock(&d->resourceMutex);
+            d->reclaimRetired();
+        }
+    }
+    int size() const { return m_list ? m_list->size() : 0; }
+    QResourceRoot *at(int i) const { return m_list->at(i); }
+
+private:
+    Q_DISABLE_COPY(QResourceListReader)
+    QResourceGlobalData *d;
+    const ResourceList *m_list;
+    int m_epoch;
+};
+
+static bool refResourceRoot(QResourceRoot *root)
+{
+    // a root whose count dropped to zero is about to be deleted
+    int count = root->ref.load();
+    do {
+        if (count == 0)
+            return false;
+    } while (!root->ref.testAndSetOrdered(count, count + 1, count));
+    return true;
+}
+
+static bool derefResourceRoot(QResourceRoot *root)
+{
+    if (root->ref.deref())
+        return true;
+    if (resourceGlobalData.isDestroyed()) {
+        delete root;
+    } else {
+        QMutexLocker lock(resourceMutex());
+        resourceGlobalData->retireResourceRoot(root);
+    }
+    return false;
+}
+
 /*!
     \class QResource
     \inmodule QtCore
@@ -247,7 +403,7 @@ public:
     mutable qint64 size;
     mutable const uchar *data;
     mutable QStringList children;
-    mutable QDateTime lastModified;
+    mutable quint64 lastModified; // msecs since epoch, 0 if unknown
 
     QResource *q_ptr;
     Q_DECLARE_PUBLIC(QResource)
@@ -261,13 +417,10 @@ QResourcePrivate::clear()
     data = 0;
     size = 0;
     children.clear();
-    lastModified = QDateTime();
+    lastModified = 0;
     container = 0;
-    for(int i = 0; i < related.size(); ++i) {
-        QResourceRoot *root = related.at(i);
-        if(!root->ref.deref())
-            delete root;
-    }
+    for(int i = 0; i < related.size(); ++i)
+        derefResourceRoot(related.at(i));
     related.clear();
 }
 
@@ -275,13 +428,14 @@ bool
 QResourcePrivate::load(const QString &file)
 {
     related.clear();
-    QMutexLocker lock(resourceMutex());
-    const ResourceList *list = resourceList();
+    const QResourceListReader list;
     QString cleaned = cleanPath(file);
-    for(int i = 0; i < list->size(); ++i) {
-        QResourceRoot *res = list->at(i);
+    for(int i = 0; i < list.size(); ++i) {
+        QResourceRoot *res = list.at(i);
         const int node = res->findNode(cleaned, locale);
         if(node != -1) {
+            if(!refResourceRoot(res))
+                continue;
             if(related.isEmpty()) {
                 container = res->isContainer(node);
                 if(!container) {
@@ -296,15 +450,15 @@ QResourcePrivate::load(const QString &file)
             } else if(res->isContainer(node) != container) {
                 qWarning("QResourceInfo: Resource [%s] has both data and children!", file.toLatin1().constData());
             }
-            res->ref.ref();
             related.append(res);
         } else if(res->mappingRootSubdir(file)) {
+            if(!refResourceRoot(res))
+                continue;
             container = true;
             data = 0;
             size = 0;
             compressed = 0;
-            lastModified = QDateTime();
-            res->ref.ref();
+            lastModified = 0;
             related.append(res);
         }
     }
@@ -330,8 +484,11 @@ QResourcePrivate::ensureInitialized() const
     if(path.startsWith(QLatin1Char('/'))) {
         that->load(path.toString());
     } else {
-        QMutexLocker lock(resourceMutex());
-        QStringList searchPaths = *resourceSearchPaths();
+        QStringList searchPaths;
+        {
+            QMutexLocker lock(resourceMutex());
+            searchPaths = *resourceSearchPaths();
+        }
         searchPaths << QLatin1String("");
         for(int i = 0; i < searchPaths.size(); ++i) {
             const QString searchPath(searchPaths.at(i) + QLatin1Char('/') + path);
@@ -541,7 +698,8 @@ QDateTime QResource::lastModified() const
 {
     Q_D(const QResource);
     d->ensureInitialized();
-    return d->lastModified;
+    // converting to local time is expensive, so only do it on request
+    return d->lastModified ? QDateTime::fromMSecsSinceEpoch(qint64(d->lastModified)) : QDateTime();
 }
 
 /*!
@@ -645,6 +803,98 @@ inline QString QResourceRoot::name(int node) const
     return ret;
 }
 
+bool QResourceRoot::nameEquals(int node, const QStringRef &segment) const
+{
+    const int offset = findOffset(node);
+    qint32 name_offset = qFromBigEndian<qint32>(tree + offset);
+    const qint16 name_length = qFromBigEndian<qint16>(names + name_offset);
+    if (name_length != segment.size())
+        return false;
+    name_offset += 2 + 4; //jump past length and hash
+
+    const QChar *str = segment.unicode();
+    for (int i = 0; i < name_length; ++i) {
+        if (qFromBigEndian<quint16>(names + name_offset + i * 2) != str[i].unicode())
+            return false;
+    }
+    return true;
+}
+
+/*
+    Looks \a path up in the path index written by rcc for format version 3,
+    see qresourceindex_p.h. Returns -2 if \a path is not in the canonical
+    form the index was built from, in which case the caller walks the tree.
+*/
+int QResourceRoot::findIndexedNode(const QString &path, const QLocale &locale) const
+{
+    if (!path.startsWith(QLatin1Char('/')) || path.endsWith(QLatin1Char('/')))
+        return -2;
+
+    const quint64 h = qResourceIndexHash(path.constData(), path.size());
+    const uchar *displacements = index;
+    const uchar *slotTable = index + indexBuckets * 4;
+    const quint32 d = qFromBigEndian<quint32>(displacements + qResourceIndexBucket(h, indexBuckets) * 4);
+    const quint32 slot = qResourceIndexSlot(h, d, indexSlots);
+    const quint32 node = qFromBigEndian<quint32>(slotTable + slot * QResourceIndexSlotSize);
+    if (node == QResourceIndexNoSlot)
+        return -1;
+
+    // the index only tells us where the path would be, so verify every
+    // segment against the chain of parent directories
+    int parent = 0;
+    int end = path.size();
+    for (quint32 s = slot; ; ) {
+        const int start = path.lastIndexOf(QLatin1Char('/'), end - 1);
+        if (start == end - 1)
+            return -2; // empty segment
+        const quint32 n = qFromBigEndian<quint32>(slotTable + s * QResourceIndexSlotSize);
+        if (!nameEquals(n, QStringRef(&path, start + 1, end - start - 1)))
+            return -1;
+        const quint32 parentSlot = qFromBigEndian<quint32>(slotTable + s * QResourceIndexSlotSize + 4);
+        if (s == slot && parentSlot != QResourceIndexNoSlot)
+            parent = qFromBigEndian<quint32>(slotTable + parentSlot * QResourceIndexSlotSize);
+        end = start;
+        if (parentSlot == QResourceIndexNoSlot) {
+            if (end != 0)
+                return -1;
+            break;
+        }
+        if (end == 0)
+            return -1;
+        s = parentSlot;
+    }
+
+    if (flags(node) & Directory)
+        return node;
+
+    // pick the localization among the siblings sharing this name, which
+    // all have the same name offset and sit in the same run of hashes
+    int offset = findOffset(parent) + 4 + 2; //jump past name and flags
+    const qint32 child_count = qFromBigEndian<qint32>(tree + offset);
+    const qint32 child = qFromBigEndian<qint32>(tree + offset + 4);
+    const qint32 name_offset = qFromBigEndian<qint32>(tree + findOffset(node));
+    const uint node_hash = hash(node);
+
+    int sub_node = node;
+    while (sub_node > child && hash(sub_node - 1) == node_hash)
+        --sub_node;
+    int ret = -1;
+    for (; sub_node < child + child_count && hash(sub_node) == node_hash; ++sub_node) {
+        offset = findOffset(sub_node);
+        if (qFromBigEndian<qint32>(tree + offset) != name_offset)
+            continue;
+        offset += 4 + 2; //jump past name and flags
+        const qint16 country = qFromBigEndian<qint16>(tree + offset);
+        const qint16 language = qFromBigEndian<qint16>(tree + offset + 2);
+        if (country == locale.country() && language == locale.language())
+            return sub_node;
+        else if ((country == QLocale::AnyCountry && language == locale.language()) ||
+                 (country == QLocale::AnyCountry && language == QLocale::C && ret == -1))
+            ret = sub_node;
+    }
+    return ret;
+}
+
 int QResourceRoot::findNode(const QString &_path, const QLocale &locale) const
 {
     QString path = _path;
@@ -670,6 +920,12 @@ int QResourceRoot::findNode(const QString &_path, const QLocale &locale) const
     if(path == QLatin1String("/"))
         return 0;
 
+    if (index) {
+        const int node = findIndexedNode(path, locale);
+        if (node != -2)
+            return node;
+    }
+
     //the root node is always first
     qint32 child_count = qFromBigEndian<qint32>(tree + 6);
     qint32 child       = qFromBigEndian<qint32>(tree + 10);
@@ -799,18 +1055,13 @@ const uchar *QResourceRoot::data(int node, qint64 *size) const
     return 0;
 }
 
-QDateTime QResourceRoot::lastModified(int node) const
+quint64 QResourceRoot::lastModified(int node) const
 {
     if (node == -1 || version < 0x02)
-        return QDateTime();
+        return 0;
 
     const int offset = findOffset(node) + 14;
-
-    const quint64 timeStamp = qFromBigEndian<quint64>(tree + offset);
-    if (timeStamp == 0)
-        return QDateTime();
-
-    return QDateTime::fromMSecsSinceEpoch(timeStamp);
+    return qFromBigEndian<quint64>(tree + offset);
 }
 
 QStringList QResourceRoot::children(int node) const
@@ -860,7 +1111,7 @@ Q_CORE_EXPORT bool qRegisterResourceData(int version, const unsigned char *tree,
                                          const unsigned char *name, const unsigned char *data)
 {
     QMutexLocker lock(resourceMutex());
-    if ((version == 0x01 || version == 0x2) && resourceList()) {
+    if ((version >= 0x01 && version <= 0x03) && resourceList()) {
         bool found = false;
         QResourceRoot res(version, tree, name, data);
         for(int i = 0; i < resourceList()->size(); ++i) {
@@ -873,6 +1124,7 @@ Q_CORE_EXPORT bool qRegisterResourceData(int version, const unsigned char *tree,
             QResourceRoot *root = new QResourceRoot(version, tree, name, data);
             root->ref.ref();
             resourceList()->append(root);
+            resourceGlobalData->publishResourceList();
         }
         return true;
     }
@@ -886,16 +1138,21 @@ Q_CORE_EXPORT bool qUnregisterResourceData(int version, const unsigned char *tre
         return false;
 
     QMutexLocker lock(resourceMutex());
-    if ((version == 0x01 || version == 0x02) && resourceList()) {
+    if ((version >= 0x01 && version <= 0x03) && resourceList()) {
         QResourceRoot res(version, tree, name, data);
+        ResourceList removed;
         for(int i = 0; i < resourceList()->size(); ) {
-            if(*resourceList()->at(i) == res) {
-                QResourceRoot *root = resourceList()->takeAt(i);
-                if(!root->ref.deref())
-                    delete root;
-            } else {
+            if(*resourceList()->at(i) == res)
+                removed.append(resourceList()->takeAt(i));
+            else
                 ++i;
-            }
+        }
+        if(!removed.isEmpty()) {
+            resourceGlobalData->publishResourceList();
+            // the data belongs to the caller, which may free it on return
+            resourceGlobalData->waitForReaders();
+            for(int i = 0; i < removed.size(); ++i)
+                derefResourceRoot(removed.at(i));
         }
         return true;
     }
@@ -949,7 +1206,7 @@ public:
         if (size >= 0 && (tree_offset >= size || data_offset >= size || name_offset >= size))
             return false;
 
-        if (version == 0x01 || version == 0x02) {
+        if (version >= 0x01 && version <= 0x03) {
             buffer = b;
             setSource(version, b+tree_offset, b+name_offset, b+data_offset);
             return true;
@@ -1103,6 +1360,7 @@ QResource::registerResource(const QString &rccFilename, const QString &resourceR
         root->ref.ref();
         QMutexLocker lock(resourceMutex());
         resourceList()->append(root);
+        resourceGlobalData->publishResourceList();
         return true;
     }
     delete root;
@@ -1133,11 +1391,9 @@ QResource::unregisterResource(const QString &rccFilename, const QString &resourc
             QDynamicFileResourceRoot *root = reinterpret_cast<QDynamicFileResourceRoot*>(res);
             if (root->mappingFile() == rccFilename && root->mappingRoot() == r) {
                 resourceList()->removeAt(i);
-                if(!root->ref.deref()) {
-                    delete root;
-                    return true;
-                }
-                return false;
+                resourceGlobalData->publishResourceList();
+                resourceGlobalData->waitForReaders();
+                return !derefResourceRoot(root);
             }
         }
     }
@@ -1174,6 +1430,7 @@ QResource::registerResource(const uchar *rccData, const QString &resourceRoot)
         root->ref.ref();
         QMutexLocker lock(resourceMutex());
         resourceList()->append(root);
+        resourceGlobalData->publishResourceList();
         return true;
     }
     delete root;
@@ -1204,11 +1461,9 @@ QResource::unregisterResource(const uchar *rccData, const QString &resourceRoot)
             QDynamicBufferResourceRoot *root = reinterpret_cast<QDynamicBufferResourceRoot*>(res);
             if (root->mappingBuffer() == rccData && root->mappingRoot() == r) {
                 resourceList()->removeAt(i);
-                if(!root->ref.deref()) {
-                    delete root;
-                    return true;
-                }
-                return false;
+                resourceGlobalData->publishResourceList();
+                resourceGlobalData->waitForReaders();
+                return !derefResourceRoot(root);
             }
         }
     }
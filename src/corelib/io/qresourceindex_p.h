@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QRESOURCEINDEX_P_H
+#define QRESOURCEINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+#include <QtCore/qchar.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Format version 3 of the resource tree (rcc --format-version 3) prefixes
+    qt_resource_struct with a hash index over the full path of every node,
+    so that QResource does not need to walk the tree one path segment at a
+    time. All numbers are stored big-endian:
+
+        quint32 indexSize       number of bytes following this field
+        quint32 bucketCount     B, 0 if rcc could not build an index
+        quint32 slotCount       M
+        quint32 displacement[B]
+        struct { quint32 node; quint32 parentSlot; } slots[M]
+
+    The index is a perfect hash built by hash-and-displace: a path with the
+    64-bit hash h lives in slot qResourceIndexSlot(h, displacement[b], M),
+    with b = qResourceIndexBucket(h, B). Empty slots have node 0xffffffff.
+    parentSlot is the slot of the parent directory, or 0xffffffff if the
+    parent is the root node, so that lookups can verify the whole path
+    without storing it. For localized files the index refers to one of the
+    nodes carrying the name; the locale is resolved among its siblings.
+
+    The hash functions below are part of the format: rcc and QtCore must
+    agree on them, so they must never change.
+*/
+
+enum {
+    QResourceIndexHeaderSize = 12,
+    QResourceIndexSlotSize = 8
+};
+
+static const quint32 QResourceIndexNoSlot = 0xffffffff;
+
+inline quint64 qResourceIndexHash(const QChar *p, int n) Q_DECL_NOTHROW
+{
+    // FNV-1a over the UTF-16 code units
+    quint64 h = Q_UINT64_C(14695981039346656037);
+    while (n--) {
+        h ^= (*p++).unicode();
+        h *= Q_UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+inline quint32 qResourceIndexBucket(quint64 h, quint32 bucketCount) Q_DECL_NOTHROW
+{
+    return quint32(h >> 32) % bucketCount;
+}
+
+inline quint32 qResourceIndexSlot(quint64 h, quint32 displacement, quint32 slotCount) Q_DECL_NOTHROW
+{
+    // MurmurHash3 finalizer over the displaced hash
+    h ^= displacement * Q_UINT64_C(0x9e3779b97f4a7c15);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return quint32(h % slotCount);
+}
+
+QT_END_NAMESPACE
+
+#endif // QRESOURCEINDEX_P_H
@@ -69,8 +69,13 @@
 #endif
 
 #ifndef QT_BOOTSTRAPPED
+#include "qbuffer.h"
 #include "qsavefile.h"
 #include "qlockfile.h"
+#ifndef QT_NO_THREAD
+#include "qrunnable.h"
+#include "qthreadpool.h"
+#endif
 #endif
 
 #ifdef Q_OS_VXWORKS
@@ -152,7 +157,8 @@ static QBasicMutex settingsGlobalMutex;
 static QSettings::Format globalDefaultFormat = QSettings::NativeFormat;
 
 QConfFile::QConfFile(const QString &fileName, bool _userPerms)
-    : name(fileName), size(0), ref(1), userPerms(_userPerms)
+    : name(fileName), size(0), journalSize(0), ref(1), generation(0), userPerms(_userPerms),
+      compactionPending(false)
 {
     usedHashFunc()->insert(name, this);
 }
@@ -227,19 +233,93 @@ void QConfFile::clearCache()
     unusedCacheFunc()->clear();
 }
 
+/*
+    Drops a reference to \a confFile. The last reference moves the file
+    to the cache of unused files, so that its parsed contents can be
+    reused by the next QSettings object that opens it. Must be called
+    with settingsGlobalMutex held.
+*/
+static void releaseConfFile(QConfFile *confFile)
+{
+    if (confFile->ref.deref())
+        return;
+
+    ConfFileHash *usedHash = usedHashFunc();
+    ConfFileCache *unusedCache = unusedCacheFunc();
+
+    if (confFile->size == 0) {
+        delete confFile;
+    } else {
+        if (usedHash)
+            usedHash->remove(confFile->name);
+        if (unusedCache) {
+            QT_TRY {
+                // compute a better size?
+                unusedCache->insert(confFile->name, confFile,
+                                    10 + (confFile->originalKeys.size() / 4));
+            } QT_CATCH(...) {
+                // out of memory. Do not cache the file.
+                delete confFile;
+            }
+        } else {
+            // unusedCache is gone - delete the entry to prevent a memory leak
+            delete confFile;
+        }
+    }
+}
+
+#if !defined(QT_BOOTSTRAPPED) && !defined(QT_NO_THREAD)
+/*
+    Rewrites a file that has grown through incremental syncs, on a
+    thread of its own so that the QSettings::sync() that triggered it
+    only ever pays for an append. The task keeps a reference to the
+    QConfFile until it is done.
+*/
+class QConfFileCompactor : public QRunnable
+{
+public:
+    QConfFileCompactor(QConfFile *confFile, QTextCodec *codec)
+        : confFile(confFile), codec(codec)
+    {
+        confFile->ref.ref();
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QConfFileSettingsPrivate::compactConfFile(confFile, codec);
+        QMutexLocker locker(&settingsGlobalMutex);
+        releaseConfFile(confFile);
+    }
+
+private:
+    QConfFile *confFile;
+    QTextCodec *codec;
+};
+
+struct QConfFileCompactionPool : public QThreadPool
+{
+    QConfFileCompactionPool()
+    {
+        setMaxThreadCount(1);
+    }
+};
+Q_GLOBAL_STATIC(QConfFileCompactionPool, compactionPool)
+#endif
+
 // ************************************************************************
 // QSettingsPrivate
 
 QSettingsPrivate::QSettingsPrivate(QSettings::Format format)
     : format(format), scope(QSettings::UserScope /* nothing better to put */), iniCodec(0), fallbacks(true),
-      pendingChanges(false), status(QSettings::NoError)
+      incrementalSync(false), pendingChanges(false), status(QSettings::NoError)
 {
 }
 
 QSettingsPrivate::QSettingsPrivate(QSettings::Format format, QSettings::Scope scope,
                                    const QString &organization, const QString &application)
     : format(format), scope(scope), organizationName(organization), applicationName(application),
-      iniCodec(0), fallbacks(true), pendingChanges(false), status(QSettings::NoError)
+      iniCodec(0), fallbacks(true), incrementalSync(false), pendingChanges(false),
+      status(QSettings::NoError)
 {
 }
 
@@ -1199,32 +1279,8 @@ QConfFileSettingsPrivate::QConfFileSettingsPrivate(const QString &fileName,
 QConfFileSettingsPrivate::~QConfFileSettingsPrivate()
 {
     QMutexLocker locker(&settingsGlobalMutex);
-    ConfFileHash *usedHash = usedHashFunc();
-    ConfFileCache *unusedCache = unusedCacheFunc();
-
-    for (auto conf_file : qAsConst(confFiles)) {
-        if (!conf_file->ref.deref()) {
-            if (conf_file->size == 0) {
-                delete conf_file;
-            } else {
-                if (usedHash)
-                    usedHash->remove(conf_file->name);
-                if (unusedCache) {
-                    QT_TRY {
-                        // compute a better size?
-                        unusedCache->insert(conf_file->name, conf_file,
-                                            10 + (conf_file->originalKeys.size() / 4));
-                    } QT_CATCH(...) {
-                        // out of memory. Do not cache the file.
-                        delete conf_file;
-                    }
-                } else {
-                    // unusedCache is gone - delete the entry to prevent a memory leak
-                    delete conf_file;
-                }
-            }
-        }
-    }
+    for (auto conf_file : qAsConst(confFiles))
+        releaseConfFile(conf_file);
 }
 
 void QConfFileSettingsPrivate::remove(const QString &key)
@@ -1254,6 +1310,7 @@ void QConfFileSettingsPrivate::remove(const QString &key)
     }
     if (confFile->originalKeys.contains(theKey))
         confFile->removedKeys.insert(theKey, QVariant());
+    ++confFile->generation;
 }
 
 void QConfFileSettingsPrivate::set(const QString &key, const QVariant &value)
@@ -1268,6 +1325,7 @@ void QConfFileSettingsPrivate::set(const QString &key, const QVariant &value)
     QMutexLocker locker(&confFile->mutex);
     confFile->removedKeys.remove(theKey);
     confFile->addedKeys.insert(theKey, value);
+    ++confFile->generation;
 }
 
 bool QConfFileSettingsPrivate::get(const QString &key, QVariant *value) const
@@ -1353,6 +1411,7 @@ void QConfFileSettingsPrivate::clear()
     ensureAllSectionsParsed(confFile);
     confFile->addedKeys.clear();
     confFile->removedKeys = confFile->originalKeys;
+    ++confFile->generation;
 }
 
 void QConfFileSettingsPrivate::sync()
@@ -1360,10 +1419,8 @@ void QConfFileSettingsPrivate::sync()
     // people probably won't be checking the status a whole lot, so in case of
     // error we just try to go on and make the best of it
 
-    for (auto confFile : qAsConst(confFiles)) {
-        QMutexLocker locker(&confFile->mutex);
+    for (auto confFile : qAsConst(confFiles))
         syncConfFile(confFile);
-    }
 }
 
 void QConfFileSettingsPrivate::flush()
@@ -1391,17 +1448,74 @@ bool QConfFileSettingsPrivate::isWritable() const
     return confFiles.at(0)->isWritable();
 }
 
+enum {
+    // trailing bytes of a file remembered to recognize appends to it
+    TailSize = 256,
+    // appended data below this size never triggers a compaction
+    MinCompactionSize = 64 * 1024
+};
+
+static QByteArray readTail(const QString &fileName, qint64 size)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly) || !file.seek(qMax(Q_INT64_C(0), size - TailSize)))
+        return QByteArray();
+    return file.read(TailSize);
+}
+
+/*
+    Data appended to an .ini file can only be merged with what was read
+    before if it does not continue the file's last section.
+*/
+static bool startsWithSection(const QByteArray &data)
+{
+    for (char ch : data) {
+        if (ch == '[')
+            return true;
+        if (ch != '\n' && ch != '\r' && ch != ' ' && ch != '\t')
+            return false;
+    }
+    return false;
+}
+
+static void mergeIniSections(UnparsedSettingsMap *unparsedIniSections,
+                             const UnparsedSettingsMap &appendedSections)
+{
+    UnparsedSettingsMap::const_iterator i = appendedSections.constBegin();
+    for (; i != appendedSections.constEnd(); ++i) {
+        if (i.value().isEmpty())
+            continue;
+        QByteArray &sectionData = (*unparsedIniSections)[i.key()];
+        if (!sectionData.isEmpty())
+            sectionData.append('\n');
+        sectionData += i.value();
+    }
+}
+
 void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
 {
+    /*
+        Syncs of the same file are serialized, but the key maps are only
+        locked while they are copied or updated, so that threads reading
+        settings never wait for file I/O. The maps are implicitly shared,
+        so the copies taken for writing are cheap.
+    */
+    QMutexLocker syncLocker(&confFile->syncMutex);
+
+    confFile->mutex.lock();
     bool readOnly = confFile->addedKeys.isEmpty() && confFile->removedKeys.isEmpty();
+    const qint64 knownSize = confFile->size;
+    const QDateTime knownTimeStamp = confFile->timeStamp;
+    const QByteArray knownTail = confFile->tail;
+    confFile->mutex.unlock();
 
     /*
         We can often optimize the read-only case, if the file on disk
         hasn't changed.
     */
-    if (readOnly && confFile->size > 0) {
+    if (readOnly && knownSize > 0) {
         QFileInfo fileInfo(confFile->name);
-        if (confFile->size == fileInfo.size() && confFile->timeStamp == fileInfo.lastModified())
+        if (knownSize == fileInfo.size() && knownTimeStamp == fileInfo.lastModified())
             return;
     }
 
@@ -1435,12 +1549,14 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
     bool createFile = !fileInfo.exists();
 
     if (!readOnly)
-        mustReadFile = (confFile->size != fileInfo.size()
-                        || (confFile->size != 0 && confFile->timeStamp != fileInfo.lastModified()));
+        mustReadFile = (knownSize != fileInfo.size()
+                        || (knownSize != 0 && knownTimeStamp != fileInfo.lastModified()));
 
     if (mustReadFile) {
-        confFile->unparsedIniSections.clear();
-        confFile->originalKeys.clear();
+        UnparsedSettingsMap unparsedIniSections;
+        ParsedSettingsMap originalKeys;
+        QByteArray tail;
+        bool appended = false;
 
         QFile file(confFile->name);
         if (!createFile && !file.open(QFile::ReadOnly)) {
@@ -1457,12 +1573,30 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
 #ifdef Q_OS_MAC
             if (format == QSettings::NativeFormat) {
                 QByteArray data = file.readAll();
-                ok = readPlistFile(data, &confFile->originalKeys);
+                ok = readPlistFile(data, &originalKeys);
             } else
 #endif
             if (format <= QSettings::IniFormat) {
-                QByteArray data = file.readAll();
-                ok = readIniFile(data, &confFile->unparsedIniSections);
+                /*
+                    If the file has only grown since we last read it, and
+                    still holds the bytes we saw at its end back then, only
+                    the sections appended since need to be parsed.
+                */
+                QByteArray data;
+                if (knownTail.endsWith('\n') && fileInfo.size() > knownSize
+                        && file.seek(knownSize - knownTail.size())
+                        && file.read(knownTail.size()) == knownTail) {
+                    data = file.readAll();
+                    appended = startsWithSection(data);
+                }
+                if (appended) {
+                    tail = QByteArray(knownTail + data).right(TailSize);
+                } else {
+                    file.seek(0);
+                    data = file.readAll();
+                    tail = data.right(TailSize);
+                }
+                ok = readIniFile(data, &unparsedIniSections);
             } else if (readFunc) {
                 QSettings::SettingsMap tempNewKeys;
                 ok = readFunc(file, tempNewKeys);
@@ -1470,8 +1604,7 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
                 if (ok) {
                     QSettings::SettingsMap::const_iterator i = tempNewKeys.constBegin();
                     while (i != tempNewKeys.constEnd()) {
-                        confFile->originalKeys.insert(QSettingsKey(i.key(), caseSensitivity),
-                                                      i.value());
+                        originalKeys.insert(QSettingsKey(i.key(), caseSensitivity), i.value());
                         ++i;
                     }
                 }
@@ -1481,75 +1614,208 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
                 setStatus(QSettings::FormatError);
         }
 
+        QMutexLocker locker(&confFile->mutex);
+        if (appended) {
+            mergeIniSections(&confFile->unparsedIniSections, unparsedIniSections);
+            confFile->journalSize += fileInfo.size() - knownSize;
+        } else {
+            confFile->unparsedIniSections = unparsedIniSections;
+            confFile->originalKeys = originalKeys;
+            confFile->journalSize = 0;
+        }
         confFile->size = fileInfo.size();
         confFile->timeStamp = fileInfo.lastModified();
+        confFile->tail = tail;
     }
 
+    if (readOnly)
+        return;
+
+#if !defined(QT_BOOTSTRAPPED) && !defined(QT_NO_THREAD)
+    if (incrementalSync && !createFile && appendToConfFile(confFile))
+        return;
+#endif
+
     /*
         We also need to save the file. We still hold the file lock,
         so everything is under control.
     */
-    if (!readOnly) {
-        bool ok = false;
-        ensureAllSectionsParsed(confFile);
-        ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
+    bool ok = false;
+    confFile->mutex.lock();
+    ensureAllSectionsParsed(confFile);
+    ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
+    const uint generation = confFile->generation;
+    confFile->mutex.unlock();
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
-        QSaveFile sf(confFile->name);
+    QSaveFile sf(confFile->name);
 #else
-        QFile sf(confFile->name);
+    QFile sf(confFile->name);
 #endif
-        if (!sf.open(QIODevice::WriteOnly)) {
-            setStatus(QSettings::AccessError);
-            return;
-        }
+    if (!sf.open(QIODevice::WriteOnly)) {
+        setStatus(QSettings::AccessError);
+        return;
+    }
 
 #ifdef Q_OS_MAC
-        if (format == QSettings::NativeFormat) {
-            ok = writePlistFile(sf, mergedKeys);
-        } else
+    if (format == QSettings::NativeFormat) {
+        ok = writePlistFile(sf, mergedKeys);
+    } else
 #endif
-        if (format <= QSettings::IniFormat) {
-            ok = writeIniFile(sf, mergedKeys);
-        } else if (writeFunc) {
-            QSettings::SettingsMap tempOriginalKeys;
-
-            ParsedSettingsMap::const_iterator i = mergedKeys.constBegin();
-            while (i != mergedKeys.constEnd()) {
-                tempOriginalKeys.insert(i.key(), i.value());
-                ++i;
-            }
-            ok = writeFunc(sf, tempOriginalKeys);
+    if (format <= QSettings::IniFormat) {
+        ok = writeIniFile(sf, mergedKeys, iniCodec);
+    } else if (writeFunc) {
+        QSettings::SettingsMap tempOriginalKeys;
+
+        ParsedSettingsMap::const_iterator i = mergedKeys.constBegin();
+        while (i != mergedKeys.constEnd()) {
+            tempOriginalKeys.insert(i.key(), i.value());
+            ++i;
         }
+        ok = writeFunc(sf, tempOriginalKeys);
+    }
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
-        if (ok)
-            ok = sf.commit();
+    if (ok)
+        ok = sf.commit();
 #endif
 
-        if (ok) {
-            confFile->unparsedIniSections.clear();
-            confFile->originalKeys = mergedKeys;
+    if (ok) {
+        QFileInfo fileInfo(confFile->name);
+        QMutexLocker locker(&confFile->mutex);
+        confFile->unparsedIniSections.clear();
+        confFile->originalKeys = mergedKeys;
+        // changes made while we were writing stay pending for the next sync
+        if (confFile->generation == generation) {
             confFile->addedKeys.clear();
             confFile->removedKeys.clear();
+        }
 
-            QFileInfo fileInfo(confFile->name);
-            confFile->size = fileInfo.size();
-            confFile->timeStamp = fileInfo.lastModified();
+        confFile->size = fileInfo.size();
+        confFile->timeStamp = fileInfo.lastModified();
+        confFile->tail = readTail(confFile->name, confFile->size);
+        confFile->journalSize = 0;
+
+        // If we have created the file, apply the file perms
+        if (createFile) {
+            QFile::Permissions perms = fileInfo.permissions() | QFile::ReadOwner | QFile::WriteOwner;
+            if (!confFile->userPerms)
+                perms |= QFile::ReadGroup | QFile::ReadOther;
+            QFile(confFile->name).setPermissions(perms);
+        }
+    } else {
+        setStatus(QSettings::AccessError);
+    }
+}
 
-            // If we have created the file, apply the file perms
-            if (createFile) {
-                QFile::Permissions perms = fileInfo.permissions() | QFile::ReadOwner | QFile::WriteOwner;
-                if (!confFile->userPerms)
-                    perms |= QFile::ReadGroup | QFile::ReadOther;
-                QFile(confFile->name).setPermissions(perms);
-            }
-        } else {
-            setStatus(QSettings::AccessError);
+#if !defined(QT_BOOTSTRAPPED) && !defined(QT_NO_THREAD)
+/*
+    Appends the keys added since the last sync to the end of the file,
+    as sections that override the earlier ones when the file is read
+    back, and schedules a compaction once the appended data outweighs
+    the rest of the file. Returns \c false if the pending changes cannot
+    be expressed as an append, which is the case for removed keys.
+*/
+bool QConfFileSettingsPrivate::appendToConfFile(QConfFile *confFile)
+{
+#ifdef Q_OS_MAC
+    if (format == QSettings::NativeFormat)
+        return false;
+#endif
+    if (format > QSettings::IniFormat)
+        return false;
+
+    confFile->mutex.lock();
+    const ParsedSettingsMap addedKeys = confFile->addedKeys;
+    const uint generation = confFile->generation;
+    const bool canAppend = confFile->removedKeys.isEmpty() && confFile->tail.endsWith('\n');
+    confFile->mutex.unlock();
+
+    if (!canAppend)
+        return false;
+
+    QBuffer block;
+    block.open(QIODevice::WriteOnly);
+#ifdef Q_OS_WIN
+    block.write("\r\n");
+#else
+    block.write("\n");
+#endif
+    writeIniFile(block, addedKeys, iniCodec);
+
+    QFile file(confFile->name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)
+            || file.write(block.data()) != block.size()) {
+        setStatus(QSettings::AccessError);
+        return true;
+    }
+    file.close();
+
+    QFileInfo fileInfo(confFile->name);
+    QMutexLocker locker(&confFile->mutex);
+    for (ParsedSettingsMap::const_iterator i = addedKeys.constBegin(); i != addedKeys.constEnd(); ++i) {
+        // the old value must not be parsed over the new one later on
+        ensureSectionParsed(confFile, i.key());
+        confFile->originalKeys.insert(i.key(), i.value());
+    }
+    if (confFile->generation == generation)
+        confFile->addedKeys.clear();
+
+    confFile->size = fileInfo.size();
+    confFile->timeStamp = fileInfo.lastModified();
+    confFile->tail = QByteArray(confFile->tail + block.data()).right(TailSize);
+    confFile->journalSize += block.size();
+
+    if (!confFile->compactionPending
+            && confFile->journalSize >= qMax(confFile->size - confFile->journalSize,
+                                             qint64(MinCompactionSize))) {
+        if (QThreadPool *pool = compactionPool()) {
+            confFile->compactionPending = true;
+            pool->start(new QConfFileCompactor(confFile, iniCodec));
         }
     }
+    return true;
 }
 
+/*
+    Rewrites \a confFile from scratch, dropping the sections that were
+    overridden by later appends. Nothing is done if the file was changed
+    by anyone else since it was last read.
+*/
+void QConfFileSettingsPrivate::compactConfFile(QConfFile *confFile, QTextCodec *codec)
+{
+    QMutexLocker syncLocker(&confFile->syncMutex);
+    QLockFile lockFile(confFile->name + QLatin1String(".lock"));
+    const bool locked = lockFile.lock();
+    QFileInfo fileInfo(confFile->name);
+
+    confFile->mutex.lock();
+    confFile->compactionPending = false;
+    if (!locked || confFile->journalSize == 0 || confFile->size != fileInfo.size()
+            || confFile->timeStamp != fileInfo.lastModified()) {
+        confFile->mutex.unlock();
+        return;
+    }
+    UnparsedSettingsMap::const_iterator i = confFile->unparsedIniSections.constBegin();
+    for (; i != confFile->unparsedIniSections.constEnd(); ++i)
+        readIniSection(i.key(), i.value(), &confFile->originalKeys, codec);
+    confFile->unparsedIniSections.clear();
+    const ParsedSettingsMap keys = confFile->originalKeys;
+    confFile->mutex.unlock();
+
+    QSaveFile file(confFile->name);
+    if (!file.open(QIODevice::WriteOnly) || !writeIniFile(file, keys, codec) || !file.commit())
+        return;
+
+    fileInfo.refresh();
+    QMutexLocker locker(&confFile->mutex);
+    confFile->size = fileInfo.size();
+    confFile->timeStamp = fileInfo.lastModified();
+    confFile->tail = readTail(confFile->name, confFile->size);
+    confFile->journalSize = 0;
+}
+#endif
+
 enum { Space = 0x1, Special = 0x2 };
 
 static const char charTraits[256] =
@@ -1808,7 +2074,8 @@ typedef QMap<QString, QSettingsIniSection> IniMap;
     This would be more straightforward if we didn't try to remember the original
     key order in the .ini file, but we do.
 */
-bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSettingsMap &map)
+bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSettingsMap &map,
+                                            QTextCodec *codec)
 {
     IniMap iniMap;
     IniMap::const_iterator i;
@@ -1883,9 +2150,9 @@ bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSetti
             */
             if (value.type() == QVariant::StringList
                     || (value.type() == QVariant::List && value.toList().size() != 1)) {
-                iniEscapedStringList(variantListToStringList(value.toList()), block, iniCodec);
+                iniEscapedStringList(variantListToStringList(value.toList()), block, codec);
             } else {
-                iniEscapedString(variantToString(value), block, iniCodec);
+                iniEscapedString(variantToString(value), block, codec);
             }
             block += eol;
             if (device.write(block) == -1) {
@@ -3266,6 +3533,54 @@ bool QSettings::fallbacksEnabled() const
     return d->fallbacks;
 }
 
+/*!
+    \since 5.10
+
+    Sets whether sync() may write the changes to an INI file
+    incrementally to \a enable.
+
+    By default, sync() rewrites the whole file whenever a key has
+    changed. With incremental sync enabled, keys that were set since the
+    last sync are instead appended to the end of the file, in sections
+    that take precedence over the earlier ones when the file is read
+    back, so the cost of a sync depends on the size of the change rather
+    than the size of the file. Once the appended data outweighs the rest
+    of the file, the file is rewritten in full by a background thread.
+    Removing keys always rewrites the file.
+
+    Unlike a full rewrite, which replaces the file atomically, an append
+    that is interrupted (for instance by a crash) can leave an incomplete
+    last line in the file. Other applications reading the file must also
+    cope with a section appearing more than once, with the last value of
+    a key winning, as QSettings does.
+
+    This setting only has an effect on files written in IniFormat, or in
+    NativeFormat on Unix systems other than \macos and iOS.
+
+    \sa incrementalSyncEnabled(), sync()
+*/
+void QSettings::setIncrementalSyncEnabled(bool enable)
+{
+    Q_D(QSettings);
+    d->incrementalSync = enable;
+}
+
+/*!
+    \since 5.10
+
+    Returns \c true if sync() may append changes to the settings file
+    instead of rewriting it; returns \c false otherwise.
+
+    By default, incremental sync is disabled.
+
+    \sa setIncrementalSyncEnabled()
+*/
+bool QSettings::incrementalSyncEnabled() const
+{
+    Q_D(const QSettings);
+    return d->incrementalSync;
+}
+
 #ifndef QT_NO_QOBJECT
 /*!
     \reimp
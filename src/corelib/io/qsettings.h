@@ -170,6 +170,9 @@ public:
     void setFallbacksEnabled(bool b);
     bool fallbacksEnabled() const;
 
+    void setIncrementalSyncEnabled(bool enable);
+    bool incrementalSyncEnabled() const;
+
     QString fileName() const;
     Format format() const;
     Scope scope() const;
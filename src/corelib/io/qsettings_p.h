@@ -160,13 +160,18 @@ public:
     QString name;
     QDateTime timeStamp;
     qint64 size;
+    qint64 journalSize;
+    QByteArray tail;
     UnparsedSettingsMap unparsedIniSections;
     ParsedSettingsMap originalKeys;
     ParsedSettingsMap addedKeys;
     ParsedSettingsMap removedKeys;
     QAtomicInt ref;
-    QMutex mutex;
+    QMutex mutex;       // guards the maps; never held during file I/O
+    QMutex syncMutex;   // serializes reading and writing the file
+    uint generation;
     bool userPerms;
+    bool compactionPending;
 
 private:
 #ifdef Q_DISABLE_COPY
@@ -246,6 +251,7 @@ protected:
     QStack<QSettingsGroup> groupStack;
     QString groupPrefix;
     bool fallbacks;
+    bool incrementalSync;
     bool pendingChanges;
     mutable QSettings::Status status;
 };
@@ -275,12 +281,14 @@ public:
                                ParsedSettingsMap *settingsMap, QTextCodec *codec);
     static bool readIniLine(const QByteArray &data, int &dataPos, int &lineStart, int &lineLen,
                             int &equalsPos);
+    static void compactConfFile(QConfFile *confFile, QTextCodec *codec);
 
 private:
     void initFormat();
     void initAccess();
     void syncConfFile(QConfFile *confFile);
-    bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map);
+    bool appendToConfFile(QConfFile *confFile);
+    static bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map, QTextCodec *codec);
 #ifdef Q_OS_MAC
     bool readPlistFile(const QByteArray &data, ParsedSettingsMap *map) const;
     bool writePlistFile(QIODevice &file, const ParsedSettingsMap &map) const;
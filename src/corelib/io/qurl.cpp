@@ -579,6 +579,9 @@ public:
 
     Error *error;
 
+    // the default toEncoded() form, built on first use; cleared by QUrl::detach()
+    mutable QAtomicPointer<QByteArray> encodedUrl;
+
     // not used for:
     //  - Port (port == -1 means absence)
     //  - Path (there's no path delimiter, so we optimize its use out of existence)
@@ -594,6 +597,7 @@ public:
 inline QUrlPrivate::QUrlPrivate()
     : ref(1), port(-1),
       error(0),
+      encodedUrl(0),
       sectionIsPresent(0),
       flags(0)
 {
@@ -609,6 +613,7 @@ inline QUrlPrivate::QUrlPrivate(const QUrlPrivate &copy)
       query(copy.query),
       fragment(copy.fragment),
       error(copy.cloneError()),
+      encodedUrl(0),
       sectionIsPresent(copy.sectionIsPresent),
       flags(copy.flags)
 {
@@ -617,6 +622,7 @@ inline QUrlPrivate::QUrlPrivate(const QUrlPrivate &copy)
 inline QUrlPrivate::~QUrlPrivate()
 {
     delete error;
+    delete encodedUrl.load();
 }
 
 inline QUrlPrivate::Error *QUrlPrivate::cloneError() const
@@ -3418,7 +3424,22 @@ QUrl QUrl::adjusted(QUrl::FormattingOptions options) const
 QByteArray QUrl::toEncoded(FormattingOptions options) const
 {
     options &= ~(FullyDecoded | FullyEncoded);
-    return toString(options | FullyEncoded).toLatin1();
+    if (options || !d)
+        return toString(options | FullyEncoded).toLatin1();
+
+    // The default form is what gets hashed, streamed and sent over the
+    // network, often repeatedly for the same URL, so keep it around. Copies
+    // of this QUrl share it until one of them is modified.
+    if (const QByteArray *cached = d->encodedUrl.loadAcquire())
+        return *cached;
+    QByteArray *encoded = new QByteArray(toString(FullyEncoded).toLatin1());
+    QByteArray *current;
+    if (!d->encodedUrl.testAndSetOrdered(0, encoded, current)) {
+        // another thread got there first
+        delete encoded;
+        encoded = current;
+    }
+    return *encoded;
 }
 
 /*!
@@ -3760,10 +3781,15 @@ QUrl &QUrl::operator =(const QString &url)
 */
 void QUrl::detach()
 {
-    if (!d)
+    if (!d) {
         d = new QUrlPrivate;
-    else
+    } else {
         qAtomicDetach(d);
+
+        // we're the only owner and about to modify the URL
+        delete d->encodedUrl.load();
+        d->encodedUrl.store(0);
+    }
 }
 
 /*!
@@ -2495,7 +2495,9 @@ QString qt_ACE_do(const QString &domain, AceOperation op, AceLeadingDot dot)
     QString result;
     result.reserve(domain.length());
 
-    const bool isIdnEnabled = op == NormalizeAce ? qt_is_idn_enabled(domain) : false;
+    // the whitelist check is only needed for non-ASCII labels, so do it on demand
+    bool idnChecked = op != NormalizeAce;
+    bool isIdnEnabled = false;
     int lastIdx = 0;
     QString aceForm; // this variable is here for caching
 
@@ -2568,6 +2570,10 @@ QString qt_ACE_do(const QString &domain, AceOperation op, AceLeadingDot dot)
 
             // We use resize()+memcpy() here because we're overwriting the data we've copied
             bool appended = false;
+            if (!idnChecked) {
+                isIdnEnabled = qt_is_idn_enabled(domain);
+                idnChecked = true;
+            }
             if (isIdnEnabled) {
                 QString tmp = qt_punycodeDecoder(aceForm);
                 if (tmp.isEmpty())
@@ -40,6 +40,7 @@
 #include "qurl.h"
 #include "private/qutfcodec_p.h"
 #include "private/qtools_p.h"
+#include "private/qsimd_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -474,6 +475,33 @@ non_trivial:
     return 0;
 }
 
+// returns the first '%' in the range, or end if there is none
+static const ushort *findPercent(const ushort *input, const ushort *end)
+{
+#if defined(__SSE2__)
+    const __m128i percent = _mm_set1_epi16('%');
+    for ( ; end - input >= 8; input += 8) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+        uint mask = _mm_movemask_epi8(_mm_cmpeq_epi16(data, percent));
+        if (mask)
+            return input + qCountTrailingZeroBits(mask) / 2;
+    }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64) // vaddv is only available on Aarch64
+    const uint16x8_t vmask = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+    const uint16x8_t percent = vdupq_n_u16('%');
+    for ( ; end - input >= 8; input += 8) {
+        uint mask = vaddvq_u16(vandq_u16(vceqq_u16(vld1q_u16(input), percent), vmask));
+        if (mask)
+            return input + qCountTrailingZeroBits(mask);
+    }
+#endif
+    for ( ; input != end; ++input) {
+        if (*input == '%')
+            break;
+    }
+    return input;
+}
+
 /*!
     \since 5.0
     \internal
@@ -501,12 +529,15 @@ static int decode(QString &appendTo, const ushort *begin, const ushort *end)
     const ushort *input = begin;
     ushort *output = 0;
     while (input != end) {
-        if (*input != '%') {
-            if (output)
-                *output++ = *input;
-            ++input;
-            continue;
+        // copy everything up to the next percent in one go
+        const ushort *percent = findPercent(input, end);
+        if (output) {
+            memcpy(output, input, (percent - input) * sizeof(ushort));
+            output += percent - input;
         }
+        input = percent;
+        if (input == end)
+            break;
 
         if (Q_UNLIKELY(end - input < 3 || !isHex(input[1]) || !isHex(input[2]))) {
             // badly-encoded data
@@ -39,6 +39,7 @@
 
 #include "qjson_p.h"
 #include <qalgorithms.h>
+#include <qvarlengtharray.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -55,83 +56,145 @@ static const Base emptyArray = { { Q_TO_LITTLE_ENDIAN(sizeof(Base)) }, { 0 }, {
 static const Base emptyObject = { { Q_TO_LITTLE_ENDIAN(sizeof(Base)) }, { 0 }, { 0 } };
 
 
-void Data::compact()
+/*
+    Returns the size of the container when its values are stored one after the
+    other without unused space in between. Wide offsets are used if \a *wide is
+    set or if narrow ones can't address all the values; \a *wide is updated
+    accordingly. Returns 0 if the container doesn't fit into a document.
+ */
+uint Base::compactedSize(bool *wide) const
 {
-    Q_ASSERT(sizeof(Value) == sizeof(offset));
-
-    if (!compactionCounter)
-        return;
-
-    Base *base = header->root();
-    int reserve = 0;
-    if (base->is_object) {
-        Object *o = static_cast<Object *>(base);
-        for (int i = 0; i < (int)o->length; ++i)
-            reserve += o->entryAt(i)->usedStorage(o);
+    quint64 narrowEnd = sizeof(Base);
+    quint64 wideEnd = sizeof(Base);
+    if (is_object) {
+        const Object *o = static_cast<const Object *>(this);
+        for (int i = 0; i < (int)length; ++i) {
+            const Entry *e = o->entryAt(i);
+            const uint s = e->size();
+            const uint dataSize = e->value.usedStorage(this);
+            narrowEnd += s + dataSize;
+            wideEnd += s;
+            if (dataSize)
+                wideEnd = ((wideEnd + WideAlignment - 1) & ~quint64(WideAlignment - 1)) + dataSize;
+        }
     } else {
-        Array *a = static_cast<Array *>(base);
-        for (int i = 0; i < (int)a->length; ++i)
-            reserve += (*a)[i].usedStorage(a);
+        const Array *a = static_cast<const Array *>(this);
+        for (int i = 0; i < (int)length; ++i) {
+            const uint dataSize = a->at(i).usedStorage(this);
+            narrowEnd += dataSize;
+            if (dataSize)
+                wideEnd = ((wideEnd + WideAlignment - 1) & ~quint64(WideAlignment - 1)) + dataSize;
+        }
     }
 
-    int size = sizeof(Base) + reserve + base->length*sizeof(offset);
-    int alloc = sizeof(Header) + size;
-    Header *h = (Header *) malloc(alloc);
-    h->tag = QJsonDocument::BinaryFormatTag;
-    h->version = 1;
-    Base *b = h->root();
-    b->size = size;
-    b->is_object = header->root()->is_object;
-    b->length = base->length;
-    b->tableOffset = reserve + sizeof(Array);
+    if (narrowEnd > Value::MaxSize)
+        *wide = true;
+    const quint64 size = (*wide ? wideEnd : narrowEnd) + length*sizeof(offset);
+    return size > Value::MaxWideSize ? 0 : uint(size);
+}
+
+/*
+    Writes the container to \a dest, which must provide the space returned by
+    compactedSize() for the same value of \a wide.
+ */
+void Base::compactInto(Base *dest, bool wide) const
+{
+    // assign the values, copying the bitfields would copy the whole word
+    dest->_dummy = 0;
+    dest->is_object = uint(is_object);
+    dest->is_wide = wide;
+    dest->length = uint(length);
 
-    int offset = sizeof(Base);
-    if (b->is_object) {
-        Object *o = static_cast<Object *>(base);
-        Object *no = static_cast<Object *>(b);
+    uint pos = sizeof(Base);
+    if (is_object) {
+        const Object *o = static_cast<const Object *>(this);
+        Object *no = static_cast<Object *>(dest);
+        QVarLengthArray<uint, 64> entryOffsets(length);
 
-        for (int i = 0; i < (int)o->length; ++i) {
-            no->table()[i] = offset;
+        for (int i = 0; i < (int)length; ++i) {
+            entryOffsets[i] = pos;
 
             const Entry *e = o->entryAt(i);
-            Entry *ne = no->entryAt(i);
+            Entry *ne = reinterpret_cast<Entry *>((char *)no + pos);
             int s = e->size();
             memcpy(ne, e, s);
-            offset += s;
+            pos += s;
             int dataSize = e->value.usedStorage(o);
             if (dataSize) {
-                memcpy((char *)no + offset, e->value.data(o), dataSize);
-                ne->value.value = offset;
-                offset += dataSize;
+                pos = dest->alignedValueOffset(pos);
+                memcpy((char *)no + pos, e->value.data(o), dataSize);
+                ne->value.value = dest->storedOffset(pos);
+                pos += dataSize;
             }
         }
+        dest->tableOffset = pos;
+        memcpy(dest->table(), entryOffsets.constData(), length*sizeof(offset));
     } else {
-        Array *a = static_cast<Array *>(base);
-        Array *na = static_cast<Array *>(b);
+        const Array *a = static_cast<const Array *>(this);
+        Array *na = static_cast<Array *>(dest);
+        QVarLengthArray<Value, 64> values(length);
 
-        for (int i = 0; i < (int)a->length; ++i) {
-            const Value &v = (*a)[i];
-            Value &nv = (*na)[i];
+        for (int i = 0; i < (int)length; ++i) {
+            const Value v = a->at(i);
+            Value &nv = values[i];
             nv = v;
             int dataSize = v.usedStorage(a);
             if (dataSize) {
-                memcpy((char *)na + offset, v.data(a), dataSize);
-                nv.value = offset;
-                offset += dataSize;
+                pos = dest->alignedValueOffset(pos);
+                memcpy((char *)na + pos, v.data(a), dataSize);
+                nv.value = dest->storedOffset(pos);
+                pos += dataSize;
             }
         }
+        dest->tableOffset = pos;
+        memcpy(dest->table(), values.constData(), length*sizeof(offset));
     }
-    Q_ASSERT(offset == (int)b->tableOffset);
+    dest->size = pos + length*sizeof(offset);
+}
+
+void Data::compact()
+{
+    Q_ASSERT(sizeof(Value) == sizeof(offset));
 
-    free(header);
+    if (!needsCompaction())
+        return;
+
+    relayout(false);
+}
+
+/*
+    Replaces the data with a compacted copy of the root container, using wide
+    offsets if \a wide is set or required. Returns \c false if the container
+    doesn't fit.
+ */
+bool Data::relayout(bool wide)
+{
+    Base *base = header->root();
+    const uint size = base->compactedSize(&wide);
+    if (!size)
+        return false;
+
+    int alloc = sizeof(Header) + size;
+    Header *h = (Header *) malloc(alloc);
+    Q_CHECK_PTR(h);
+    h->tag = QJsonDocument::BinaryFormatTag;
+    h->version = size > uint(Value::MaxSize) ? 2 : 1;
+    base->compactInto(h->root(), wide);
+    Q_ASSERT(h->root()->size == size);
+
+    if (ownsData)
+        free(header);
     header = h;
+    ownsData = true;
     this->alloc = alloc;
     compactionCounter = 0;
+    dataEnd = 0;
+    return true;
 }
 
 bool Data::valid() const
 {
-    if (header->tag != QJsonDocument::BinaryFormatTag || header->version != 1u)
+    if (header->tag != QJsonDocument::BinaryFormatTag || (header->version != 1u && header->version != 2u))
         return false;
 
     bool res = false;
@@ -145,32 +208,86 @@ bool Data::valid() const
     return res;
 }
 
-
-int Base::reserveSpace(uint dataSize, int posInTable, uint numItems, bool replace)
+/*
+    Reserves space for a new item at \a posInTable in the root container, or for
+    the item replacing the one there if \a replace is set. The item consists of
+    \a keySize bytes of entry and key (none for arrays) followed by \a valueSize
+    bytes of value data. Returns the offset of the value data, or 0 if the
+    document would become too large.
+
+    New data is appended after the existing data, while the table is kept apart
+    from both the data and the end of the allocation, so that neither has to be
+    moved for most insertions. This can reallocate the data or convert the
+    container to wide offsets, invalidating all pointers into it.
+ */
+uint Data::reserveSpace(uint keySize, uint valueSize, int posInTable, bool replace)
 {
-    Q_ASSERT(posInTable >= 0 && posInTable <= (int)length);
-    if (size + dataSize >= Value::MaxSize) {
-        qWarning("QJson: Document too large to store in data structure %d %d %d", (uint)size, dataSize, Value::MaxSize);
-        return 0;
+    Q_ASSERT(ownsData && ref.load() == 1);
+    Base *b = header->root();
+    Q_ASSERT(posInTable >= 0 && posInTable <= (int)b->length);
+
+    if (!b->length) {
+        b->tableOffset = sizeof(Base);
+        dataEnd = 0;
     }
 
-    offset off = tableOffset;
-    // move table to new position
-    if (replace) {
-        memmove((char *)(table()) + dataSize, table(), length*sizeof(offset));
-    } else {
-        memmove((char *)(table() + posInTable + numItems) + dataSize, table() + posInTable, (length - posInTable)*sizeof(offset));
-        memmove((char *)(table()) + dataSize, table(), posInTable*sizeof(offset));
+    quint64 entryOffset = dataEnd ? dataEnd : uint(b->tableOffset);
+    quint64 valueOffset = valueSize ? b->alignedValueOffset(entryOffset + keySize) : entryOffset + keySize;
+    if (valueSize && !b->isWide() && valueOffset > Value::MaxSize) {
+        // the value data can't be addressed with narrow offsets anymore
+        if (!relayout(true)) {
+            qWarning("QJson: Document too large to store in data structure");
+            return 0;
+        }
+        b = header->root();
+        entryOffset = b->tableOffset;
+        valueOffset = b->alignedValueOffset(entryOffset + keySize);
     }
-    tableOffset += dataSize;
-    for (int i = 0; i < (int)numItems; ++i)
-        table()[posInTable + i] = off;
-    size += dataSize;
-    if (!replace) {
-        length += numItems;
-        size += numItems * sizeof(offset);
+
+    const quint64 newDataEnd = valueOffset + valueSize;
+    const uint tableSize = b->length*sizeof(offset);
+    const quint64 newTableSize = tableSize + (replace ? 0 : sizeof(offset));
+    qint64 capacity = alloc - sizeof(Header);
+    if (newDataEnd > b->tableOffset || b->tableOffset + newTableSize > quint64(capacity)) {
+        const qint64 used = newDataEnd + newTableSize;
+        if (used > Value::MaxWideSize) {
+            qWarning("QJson: Document too large to store in data structure");
+            return 0;
+        }
+        if (capacity - used < used / 2) {
+            capacity = qMin(used * 2, qint64(Value::MaxWideSize));
+            Header *h = (Header *)realloc(header, sizeof(Header) + capacity);
+            Q_CHECK_PTR(h);
+            header = h;
+            alloc = sizeof(Header) + capacity;
+            b = header->root();
+        }
+
+        // move the table to the middle of the free space
+        const uint newTableOffset = newDataEnd + (((capacity - used) / 2) & ~qint64(sizeof(offset) - 1));
+        offset *oldTable = b->table();
+        offset *newTable = reinterpret_cast<offset *>((char *)b + newTableOffset);
+        if (replace) {
+            memmove(newTable, oldTable, tableSize);
+        } else if (newTableOffset > b->tableOffset) {
+            memmove(newTable + posInTable + 1, oldTable + posInTable, (b->length - posInTable)*sizeof(offset));
+            memmove(newTable, oldTable, posInTable*sizeof(offset));
+        } else {
+            memmove(newTable, oldTable, posInTable*sizeof(offset));
+            memmove(newTable + posInTable + 1, oldTable + posInTable, (b->length - posInTable)*sizeof(offset));
+        }
+        b->tableOffset = newTableOffset;
+    } else if (!replace) {
+        memmove(b->table() + posInTable + 1, b->table() + posInTable, (b->length - posInTable)*sizeof(offset));
     }
-    return off;
+
+    if (!replace)
+        b->length = b->length + 1;
+    b->table()[posInTable] = uint(entryOffset);
+    b->size = b->tableOffset + b->length*sizeof(offset);
+    dataEnd = newDataEnd < b->tableOffset ? uint(newDataEnd) : 0;
+    header->version = b->size > uint(Value::MaxSize) ? 2 : 1;
+    return uint(valueOffset);
 }
 
 void Base::removeItems(int pos, int numItems)
@@ -344,7 +461,7 @@ bool Value::isValid(const Base *b) const
     case QJsonValue::String:
     case QJsonValue::Array:
     case QJsonValue::Object:
-        offset = value;
+        offset = b->valueOffset(value);
         break;
     case QJsonValue::Null:
     case QJsonValue::Bool:
@@ -389,10 +506,9 @@ int Value::requiredStorage(QJsonValue &v, bool *compressed)
     }
     case QJsonValue::Array:
     case QJsonValue::Object:
-        if (v.d && v.d->compactionCounter) {
-            v.detach();
-            v.d->compact();
-            v.base = static_cast<QJsonPrivate::Base *>(v.d->header->root());
+        if (needsCompaction(v)) {
+            bool wide = false;
+            return v.base->compactedSize(&wide);
         }
         return v.base ? v.base->size : sizeof(QJsonPrivate::Base);
     case QJsonValue::Undefined:
@@ -449,7 +565,13 @@ void Value::copyData(const QJsonValue &v, char *dest, bool compressed)
         const QJsonPrivate::Base *b = v.base;
         if (!b)
             b = (v.t == QJsonValue::Array ? &emptyArray : &emptyObject);
-        memcpy(dest, b, b->size);
+        if (needsCompaction(v)) {
+            bool wide = false;
+            b->compactedSize(&wide);
+            b->compactInto(reinterpret_cast<Base *>(dest), wide);
+        } else {
+            memcpy(dest, b, b->size);
+        }
         break;
     }
     default:
@@ -457,6 +579,17 @@ void Value::copyData(const QJsonValue &v, char *dest, bool compressed)
     }
 }
 
+/*!
+    \internal
+
+    Returns \c true if the container held by \a v has to be compacted when
+    copying it, because it has unused space in it.
+ */
+bool Value::needsCompaction(const QJsonValue &v)
+{
+    return v.d && v.base == v.d->header->root() && v.d->needsCompaction();
+}
+
 } // namespace QJsonPrivate
 
 QT_END_NAMESPACE
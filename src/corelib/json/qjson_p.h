@@ -121,6 +121,13 @@ QT_BEGIN_NAMESPACE
 
     Other measurements have shown a slightly bigger binary size than a compact text
     representation where all possible whitespace was stripped out.
+
+  Values store offsets into their container in 27 bits, which limits a container
+  to 128 MB. Containers growing beyond that are converted to use wide offsets
+  (the top bit of Base's length field): the values' data is then aligned to 16
+  bytes and the stored offsets count in units of 16 bytes, which allows up to
+  2 GB. Documents larger than 128 MB are tagged with version 2 of the format,
+  which older readers reject.
 */
 #define Q_DECLARE_JSONPRIVATE_TYPEINFO(Class, Flags) } Q_DECLARE_TYPEINFO(QJsonPrivate::Class, Flags); namespace QJsonPrivate {
 namespace QJsonPrivate {
@@ -595,17 +602,32 @@ public:
     union {
         uint _dummy;
         qle_bitfield<0, 1> is_object;
-        qle_bitfield<1, 31> length;
+        qle_bitfield<1, 30> length;
+        qle_bitfield<31, 1> is_wide;
     };
     offset tableOffset;
     // content follows here
 
+    enum {
+        WideShift = 4,
+        WideAlignment = 1 << WideShift
+    };
+
     inline bool isObject() const { return !!is_object; }
     inline bool isArray() const { return !isObject(); }
+    inline bool isWide() const { return !!is_wide; }
 
     inline offset *table() const { return (offset *) (((char *) this) + tableOffset); }
 
-    int reserveSpace(uint dataSize, int posInTable, uint numItems, bool replace);
+    // conversion between byte offsets and the offsets stored in Value
+    inline uint valueOffset(uint stored) const { return isWide() ? stored << WideShift : stored; }
+    inline uint storedOffset(uint offset) const { return isWide() ? offset >> WideShift : offset; }
+    // position of value data that follows \a offset bytes of other data
+    inline uint alignedValueOffset(uint offset) const
+    { return isWide() ? (offset + WideAlignment - 1) & ~uint(WideAlignment - 1) : offset; }
+
+    uint compactedSize(bool *wide) const;
+    void compactInto(Base *dest, bool wide) const;
     void removeItems(int pos, int numItems);
 };
 
@@ -636,7 +658,8 @@ class Value
 {
 public:
     enum {
-        MaxSize = (1<<27) - 1
+        MaxSize = (1<<27) - 1,
+        MaxWideSize = MaxSize << Base::WideShift
     };
     union {
         uint _dummy;
@@ -647,7 +670,7 @@ public:
         qle_signedbitfield<5, 27> int_value;
     };
 
-    inline char *data(const Base *b) const { return ((char *)b) + value; }
+    inline char *data(const Base *b) const { return ((char *)b) + b->valueOffset(value); }
     int usedStorage(const Base *b) const;
 
     bool toBoolean() const;
@@ -662,6 +685,7 @@ public:
     static int requiredStorage(QJsonValue &v, bool *compressed);
     static uint valueToStore(const QJsonValue &v, uint offset);
     static void copyData(const QJsonValue &v, char *dest, bool compressed);
+    static bool needsCompaction(const QJsonValue &v);
 };
 Q_DECLARE_JSONPRIVATE_TYPEINFO(Value, Q_PRIMITIVE_TYPE)
 
@@ -761,7 +785,7 @@ inline bool operator<(QLatin1String key, const Entry &e)
 class Header {
 public:
     qle_uint tag; // 'qbjs'
-    qle_uint version; // 1
+    qle_uint version; // 1, or 2 for documents larger than 128 MB
     Base *root() { return (Base *)(this + 1); }
 };
 
@@ -778,7 +802,7 @@ inline double Value::toDouble(const Base *b) const
     if (latinOrIntValue)
         return int_value;
 
-    quint64 i = qFromLittleEndian<quint64>((const uchar *)b + value);
+    quint64 i = qFromLittleEndian<quint64>((const uchar *)data(b));
     double d;
     memcpy(&d, &i, sizeof(double));
     return d;
@@ -826,13 +850,16 @@ public:
     };
     uint compactionCounter : 31;
     uint ownsData : 1;
+    // end of the value data of the root container when it doesn't reach up to
+    // the table, 0 otherwise
+    uint dataEnd;
 
     inline Data(char *raw, int a)
-        : alloc(a), rawData(raw), compactionCounter(0), ownsData(true)
+        : alloc(a), rawData(raw), compactionCounter(0), ownsData(true), dataEnd(0)
     {
     }
     inline Data(int reserved, QJsonValue::Type valueType)
-        : rawData(0), compactionCounter(0), ownsData(true)
+        : rawData(0), compactionCounter(0), ownsData(true), dataEnd(0)
     {
         Q_ASSERT(valueType == QJsonValue::Array || valueType == QJsonValue::Object);
 
@@ -843,9 +870,9 @@ public:
         header->version = 1;
         Base *b = header->root();
         b->size = sizeof(Base);
+        b->_dummy = 0;
         b->is_object = (valueType == QJsonValue::Object);
         b->tableOffset = sizeof(Base);
-        b->length = 0;
     }
     inline ~Data()
     { if (ownsData) free(rawData); }
@@ -864,33 +891,44 @@ public:
 
     Data *clone(Base *b, int reserve = 0)
     {
+        // reserveSpace() takes care of growing the root container in place
         int size = sizeof(Header) + b->size;
-        if (b == header->root() && ref.load() == 1 && alloc >= size + reserve)
+        if (b == header->root() && ref.load() == 1 && ownsData)
             return this;
 
         if (reserve) {
             if (reserve < 128)
                 reserve = 128;
-            size = qMax(size + reserve, qMin(size *2, (int)Value::MaxSize));
-            if (size > Value::MaxSize) {
+            if (qint64(size) + reserve > Value::MaxWideSize) {
                 qWarning("QJson: Document too large to store in data structure");
                 return 0;
             }
+            size = qMax(size + reserve, int(qMin(qint64(size) * 2, qint64(Value::MaxWideSize))));
         }
         char *raw = (char *)malloc(size);
         Q_CHECK_PTR(raw);
         memcpy(raw + sizeof(Header), b, b->size);
         Header *h = (Header *)raw;
         h->tag = QJsonDocument::BinaryFormatTag;
-        h->version = 1;
+        h->version = b->size > uint(Value::MaxSize) ? 2 : 1;
         Data *d = new Data(raw, size);
-        d->compactionCounter = (b == header->root()) ? compactionCounter : 0;
+        if (b == header->root()) {
+            d->compactionCounter = compactionCounter;
+            d->dataEnd = dataEnd;
+        }
         return d;
     }
 
+    inline bool needsCompaction() const
+    { return compactionCounter || dataEnd; }
+
+    uint reserveSpace(uint keySize, uint valueSize, int posInTable, bool replace);
     void compact();
     bool valid() const;
 
+private:
+    bool relayout(bool wide);
+
 private:
     Q_DISABLE_COPY(Data)
 };
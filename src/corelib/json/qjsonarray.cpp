@@ -265,41 +265,8 @@ QJsonArray QJsonArray::fromVariantList(const QVariantList &list)
     if (list.isEmpty())
         return array;
 
-    array.detach2(1024);
-
-    QVector<QJsonPrivate::Value> values;
-    values.resize(list.size());
-    QJsonPrivate::Value *valueData = values.data();
-    uint currentOffset = sizeof(QJsonPrivate::Base);
-
-    for (int i = 0; i < list.size(); ++i) {
-        QJsonValue val = QJsonValue::fromVariant(list.at(i));
-
-        bool latinOrIntValue;
-        int valueSize = QJsonPrivate::Value::requiredStorage(val, &latinOrIntValue);
-
-        if (!array.detach2(valueSize))
-            return QJsonArray();
-
-        QJsonPrivate::Value *v = valueData + i;
-        v->type = (val.t == QJsonValue::Undefined ? QJsonValue::Null : val.t);
-        v->latinOrIntValue = latinOrIntValue;
-        v->latinKey = false;
-        v->value = QJsonPrivate::Value::valueToStore(val, currentOffset);
-        if (valueSize)
-            QJsonPrivate::Value::copyData(val, (char *)array.a + currentOffset, latinOrIntValue);
-
-        currentOffset += valueSize;
-        array.a->size = currentOffset;
-    }
-
-    // write table
-    array.a->tableOffset = currentOffset;
-    if (!array.detach2(sizeof(QJsonPrivate::offset)*values.size()))
-        return QJsonArray();
-    memcpy(array.a->table(), values.constData(), values.size()*sizeof(uint));
-    array.a->length = values.size();
-    array.a->size = currentOffset + sizeof(QJsonPrivate::offset)*values.size();
+    for (int i = 0; i < list.size(); ++i)
+        array.append(QJsonValue::fromVariant(list.at(i)));
 
     return array;
 }
@@ -488,10 +455,8 @@ void QJsonArray::insert(int i, const QJsonValue &value)
     if (!detach2(valueSize + sizeof(QJsonPrivate::Value)))
         return;
 
-    if (!a->length)
-        a->tableOffset = sizeof(QJsonPrivate::Array);
-
-    int valueOffset = a->reserveSpace(valueSize, i, 1, false);
+    int valueOffset = d->reserveSpace(0, valueSize, i, false);
+    a = static_cast<QJsonPrivate::Array *>(d->header->root());
     if (!valueOffset)
         return;
 
@@ -499,7 +464,7 @@ void QJsonArray::insert(int i, const QJsonValue &value)
     v.type = (val.t == QJsonValue::Undefined ? QJsonValue::Null : val.t);
     v.latinOrIntValue = compressed;
     v.latinKey = false;
-    v.value = QJsonPrivate::Value::valueToStore(val, valueOffset);
+    v.value = QJsonPrivate::Value::valueToStore(val, a->storedOffset(valueOffset));
     if (valueSize)
         QJsonPrivate::Value::copyData(val, (char *)a + valueOffset, compressed);
 }
@@ -539,10 +504,8 @@ void QJsonArray::replace(int i, const QJsonValue &value)
     if (!detach2(valueSize))
         return;
 
-    if (!a->length)
-        a->tableOffset = sizeof(QJsonPrivate::Array);
-
-    int valueOffset = a->reserveSpace(valueSize, i, 1, true);
+    int valueOffset = d->reserveSpace(0, valueSize, i, true);
+    a = static_cast<QJsonPrivate::Array *>(d->header->root());
     if (!valueOffset)
         return;
 
@@ -550,7 +513,7 @@ void QJsonArray::replace(int i, const QJsonValue &value)
     v.type = (val.t == QJsonValue::Undefined ? QJsonValue::Null : val.t);
     v.latinOrIntValue = compressed;
     v.latinKey = false;
-    v.value = QJsonPrivate::Value::valueToStore(val, valueOffset);
+    v.value = QJsonPrivate::Value::valueToStore(val, a->storedOffset(valueOffset));
     if (valueSize)
         QJsonPrivate::Value::copyData(val, (char *)a + valueOffset, compressed);
 
@@ -1179,7 +1142,7 @@ void QJsonArray::detach(uint reserve)
 bool QJsonArray::detach2(uint reserve)
 {
     if (!d) {
-        if (reserve >= QJsonPrivate::Value::MaxSize) {
+        if (reserve >= QJsonPrivate::Value::MaxWideSize) {
             qWarning("QJson: Document too large to store in data structure");
             return false;
         }
@@ -1207,7 +1170,7 @@ bool QJsonArray::detach2(uint reserve)
  */
 void QJsonArray::compact()
 {
-    if (!d || !d->compactionCounter)
+    if (!d || !d->needsCompaction())
         return;
 
     detach2();
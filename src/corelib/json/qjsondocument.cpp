@@ -47,6 +47,9 @@
 #include "qjsonwriter_p.h"
 #include "qjsonparser_p.h"
 #include "qjson_p.h"
+#ifndef QT_BOOTSTRAPPED
+#include <qjsonstream.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -236,7 +239,7 @@ QJsonDocument QJsonDocument::fromBinaryData(const QByteArray &data, DataValidati
     memcpy(&root, data.constData() + sizeof(QJsonPrivate::Header), sizeof(QJsonPrivate::Base));
 
     // do basic checks here, so we don't try to allocate more memory than we can.
-    if (h.tag != QJsonDocument::BinaryFormatTag || h.version != 1u ||
+    if (h.tag != QJsonDocument::BinaryFormatTag || (h.version != 1u && h.version != 2u) ||
         sizeof(QJsonPrivate::Header) + root.size > (uint)data.size())
         return QJsonDocument();
 
@@ -363,6 +366,40 @@ QByteArray QJsonDocument::toJson(JsonFormat format) const
 }
 #endif
 
+#ifndef QT_BOOTSTRAPPED
+/*
+    The parser writes narrow offsets only, so documents containing objects or
+    arrays beyond 128 MB are built value by value, which lets the containers
+    switch to wide offsets as they grow.
+ */
+static QJsonDocument fromLargeJson(const QByteArray &json, QJsonParseError *error)
+{
+    QJsonStreamReader reader(json);
+    const QJsonStreamReader::TokenType type = reader.readNext();
+    if (type != QJsonStreamReader::StartObject && type != QJsonStreamReader::StartArray) {
+        error->error = reader.hasError() ? reader.error() : QJsonParseError::IllegalValue;
+        error->offset = int(reader.offset());
+        return QJsonDocument();
+    }
+
+    const QJsonValue value = reader.readCurrentValue();
+    if (!reader.hasError() && reader.readNext() != QJsonStreamReader::NoToken) {
+        error->error = QJsonParseError::GarbageAtEnd;
+        error->offset = int(reader.offset());
+        return QJsonDocument();
+    }
+    if (reader.hasError()) {
+        error->error = reader.error();
+        error->offset = int(reader.offset());
+        return QJsonDocument();
+    }
+
+    error->error = QJsonParseError::NoError;
+    error->offset = 0;
+    return value.isObject() ? QJsonDocument(value.toObject()) : QJsonDocument(value.toArray());
+}
+#endif
+
 /*!
  Parses \a json as a UTF-8 encoded JSON document, and creates a QJsonDocument
  from it.
@@ -376,9 +413,20 @@ QByteArray QJsonDocument::toJson(JsonFormat format) const
 QJsonDocument QJsonDocument::fromJson(const QByteArray &json, QJsonParseError *error)
 {
     QJsonPrivate::Parser parser(json.constData(), json.length());
+#ifndef QT_BOOTSTRAPPED
+    QJsonParseError parseError;
+    QJsonDocument doc = parser.parse(&parseError);
+    if (parseError.error == QJsonParseError::DocumentTooLarge)
+        doc = fromLargeJson(json, &parseError);
+    if (error)
+        *error = parseError;
+    return doc;
+#else
     return parser.parse(error);
+#endif
 }
 
+
 /*!
     Returns \c true if the document doesn't contain any data.
  */
@@ -488,9 +536,9 @@ void QJsonDocument::setObject(const QJsonObject &object)
 
     if (!d) {
         d = new QJsonPrivate::Data(0, QJsonValue::Object);
-    } else if (d->compactionCounter || object.o != d->header->root()) {
+    } else if (d->needsCompaction() || object.o != d->header->root()) {
         QJsonObject o(object);
-        if (d->compactionCounter)
+        if (d->needsCompaction())
             o.compact();
         else
             o.detach2();
@@ -515,9 +563,9 @@ void QJsonDocument::setArray(const QJsonArray &array)
 
     if (!d) {
         d = new QJsonPrivate::Data(0, QJsonValue::Array);
-    } else if (d->compactionCounter || array.a != d->header->root()) {
+    } else if (d->needsCompaction() || array.a != d->header->root()) {
         QJsonArray a(array);
-        if (d->compactionCounter)
+        if (d->needsCompaction())
             a.compact();
         else
             a.detach2();
@@ -207,49 +207,9 @@ QJsonObject QJsonObject::fromVariantMap(const QVariantMap &map)
     if (map.isEmpty())
         return object;
 
-    object.detach2(1024);
-
-    QVector<QJsonPrivate::offset> offsets;
-    QJsonPrivate::offset currentOffset;
-    currentOffset = sizeof(QJsonPrivate::Base);
-
-    // the map is already sorted, so we can simply append one entry after the other and
-    // write the offset table at the end
-    for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
-        QString key = it.key();
-        QJsonValue val = QJsonValue::fromVariant(it.value());
-
-        bool latinOrIntValue;
-        int valueSize = QJsonPrivate::Value::requiredStorage(val, &latinOrIntValue);
-
-        bool latinKey = QJsonPrivate::useCompressed(key);
-        int valueOffset = sizeof(QJsonPrivate::Entry) + QJsonPrivate::qStringSize(key, latinKey);
-        int requiredSize = valueOffset + valueSize;
-
-        if (!object.detach2(requiredSize + sizeof(QJsonPrivate::offset))) // offset for the new index entry
-            return QJsonObject();
-
-        QJsonPrivate::Entry *e = reinterpret_cast<QJsonPrivate::Entry *>(reinterpret_cast<char *>(object.o) + currentOffset);
-        e->value.type = val.t;
-        e->value.latinKey = latinKey;
-        e->value.latinOrIntValue = latinOrIntValue;
-        e->value.value = QJsonPrivate::Value::valueToStore(val, (char *)e - (char *)object.o + valueOffset);
-        QJsonPrivate::copyString((char *)(e + 1), key, latinKey);
-        if (valueSize)
-            QJsonPrivate::Value::copyData(val, (char *)e + valueOffset, latinOrIntValue);
-
-        offsets << currentOffset;
-        currentOffset += requiredSize;
-        object.o->size = currentOffset;
-    }
-
-    // write table
-    object.o->tableOffset = currentOffset;
-    if (!object.detach2(sizeof(QJsonPrivate::offset)*offsets.size()))
-        return QJsonObject();
-    memcpy(object.o->table(), offsets.constData(), offsets.size()*sizeof(uint));
-    object.o->length = offsets.size();
-    object.o->size = currentOffset + sizeof(QJsonPrivate::offset)*offsets.size();
+    // the map is already sorted, so every insertion appends to the object
+    for (QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+        object.insert(it.key(), QJsonValue::fromVariant(it.value()));
 
     return object;
 }
@@ -475,15 +435,13 @@ QJsonObject::iterator QJsonObject::insert(const QString &key, const QJsonValue &
     if (!detach2(requiredSize + sizeof(QJsonPrivate::offset))) // offset for the new index entry
         return iterator();
 
-    if (!o->length)
-        o->tableOffset = sizeof(QJsonPrivate::Object);
-
     bool keyExists = false;
     int pos = o->indexOf(key, &keyExists);
     if (keyExists)
         ++d->compactionCounter;
 
-    uint off = o->reserveSpace(requiredSize, pos, 1, keyExists);
+    uint off = d->reserveSpace(valueOffset, valueSize, pos, keyExists);
+    o = static_cast<QJsonPrivate::Object *>(d->header->root());
     if (!off)
         return end();
 
@@ -491,10 +449,10 @@ QJsonObject::iterator QJsonObject::insert(const QString &key, const QJsonValue &
     e->value.type = val.t;
     e->value.latinKey = latinKey;
     e->value.latinOrIntValue = latinOrIntValue;
-    e->value.value = QJsonPrivate::Value::valueToStore(val, (char *)e - (char *)o + valueOffset);
+    e->value.value = QJsonPrivate::Value::valueToStore(val, o->storedOffset(off));
     QJsonPrivate::copyString((char *)(e + 1), key, latinKey);
     if (valueSize)
-        QJsonPrivate::Value::copyData(val, (char *)e + valueOffset, latinOrIntValue);
+        QJsonPrivate::Value::copyData(val, (char *)o + off, latinOrIntValue);
 
     if (d->compactionCounter > 32u && d->compactionCounter >= unsigned(o->length) / 2u)
         compact();
@@ -1200,7 +1158,7 @@ void QJsonObject::detach(uint reserve)
 bool QJsonObject::detach2(uint reserve)
 {
     if (!d) {
-        if (reserve >= QJsonPrivate::Value::MaxSize) {
+        if (reserve >= QJsonPrivate::Value::MaxWideSize) {
             qWarning("QJson: Document too large to store in data structure");
             return false;
         }
@@ -1228,7 +1186,7 @@ bool QJsonObject::detach2(uint reserve)
  */
 void QJsonObject::compact()
 {
-    if (!d || !d->compactionCounter)
+    if (!d || !d->needsCompaction())
         return;
 
     detach2();
@@ -62,6 +62,8 @@ static const int nestingLimit = 1024;
 
 QT_BEGIN_NAMESPACE
 
+void qt_from_latin1(ushort *dst, const char *str, size_t size) Q_DECL_NOTHROW;
+
 // error strings for the JSON parser
 #define JSONERR_OK          QT_TRANSLATE_NOOP("QJsonParseError", "no error occurred")
 #define JSONERR_UNTERM_OBJ  QT_TRANSLATE_NOOP("QJsonParseError", "unterminated object")
@@ -78,6 +80,7 @@ QT_BEGIN_NAMESPACE
 #define JSONERR_DEEP_NEST   QT_TRANSLATE_NOOP("QJsonParseError", "too deeply nested document")
 #define JSONERR_DOC_LARGE   QT_TRANSLATE_NOOP("QJsonParseError", "too large document")
 #define JSONERR_GARBAGEEND  QT_TRANSLATE_NOOP("QJsonParseError", "garbage at the end of the document")
+#define JSONERR_PREMATURE   QT_TRANSLATE_NOOP("QJsonParseError", "premature end of document")
 
 /*!
     \class QJsonParseError
@@ -112,6 +115,9 @@ QT_BEGIN_NAMESPACE
     \value DeepNesting              The JSON document is too deeply nested for the parser to parse it
     \value DocumentTooLarge         The JSON document is too large for the parser to parse it
     \value GarbageAtEnd             The parsed document contains additional garbage characters at the end
+    \value PrematureEndOfDocument   The input ended before the document was complete. This is only
+                                    reported by QJsonStreamReader, which continues once more data
+                                    is available. This value was introduced in Qt 5.10.
 
 */
 
@@ -187,6 +193,9 @@ QString QJsonParseError::errorString() const
     case GarbageAtEnd:
         sz = JSONERR_GARBAGEEND;
         break;
+    case PrematureEndOfDocument:
+        sz = JSONERR_PREMATURE;
+        break;
     }
 #ifndef QT_BOOTSTRAPPED
     return QCoreApplication::translate("QJsonParseError", sz);
@@ -245,6 +254,118 @@ enum {
     Quote = 0x22
 };
 
+/*
+    The scanners below look at 16 (or 32) bytes at a time and return a pointer
+    to the first byte that needs attention, or \a end.
+ */
+#if defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64) // vaddv is only available on Aarch64
+static inline uint neonMoveMask(uint8x16_t chunk)
+{
+    const uint8x16_t bits = { 1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7,
+                              1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5, 1 << 6, 1 << 7 };
+    const uint8x16_t masked = vandq_u8(chunk, bits);
+    return vaddv_u8(vget_low_u8(masked)) | (uint(vaddv_u8(vget_high_u8(masked))) << 8);
+}
+#endif
+
+// skips JSON whitespace
+static inline const char *skipWhitespace(const char *ptr, const char *end)
+{
+#if defined(__SSE2__)
+#  ifdef __AVX2__
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i tab32 = _mm256_set1_epi8('\t');
+    const __m256i lf32 = _mm256_set1_epi8('\n');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    for ( ; ptr + 32 <= end; ptr += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+        const __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space32),
+                                                           _mm256_cmpeq_epi8(chunk, tab32)),
+                                           _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf32),
+                                                           _mm256_cmpeq_epi8(chunk, cr32)));
+        const uint mask = ~uint(_mm256_movemask_epi8(ws));
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#  endif
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                     _mm_cmpeq_epi8(chunk, tab)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, lf),
+                                                     _mm_cmpeq_epi8(chunk, cr)));
+        const uint mask = ~uint(_mm_movemask_epi8(ws)) & 0xffff;
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(ptr));
+        const uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab)),
+                                       vorrq_u8(vceqq_u8(chunk, lf), vceqq_u8(chunk, cr)));
+        const uint mask = ~neonMoveMask(ws) & 0xffff;
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#endif
+    while (ptr < end && (*ptr == Space || *ptr == Tab || *ptr == LineFeed || *ptr == Return))
+        ++ptr;
+    return ptr;
+}
+
+// skips characters inside a string that can be copied verbatim: ASCII except quote and backslash
+static inline const char *skipPlainAscii(const char *ptr, const char *end)
+{
+#if defined(__SSE2__)
+#  ifdef __AVX2__
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    for ( ; ptr + 32 <= end; ptr += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+        const __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32),
+                                                _mm256_cmpeq_epi8(chunk, backslash32));
+        const uint mask = uint(_mm256_movemask_epi8(_mm256_or_si256(special, chunk)));
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#  endif
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        const __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                             _mm_cmpeq_epi8(chunk, backslash));
+        // the sign bit of the bytes flags non-ASCII characters
+        const uint mask = uint(_mm_movemask_epi8(_mm_or_si128(special, chunk)));
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#elif defined(__ARM_NEON__) && defined(Q_PROCESSOR_ARM_64)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t nonAscii = vdupq_n_u8(0x7f);
+    for ( ; ptr + 16 <= end; ptr += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(ptr));
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                            vcgtq_u8(chunk, nonAscii));
+        const uint mask = neonMoveMask(special);
+        if (mask)
+            return ptr + qCountTrailingZeroBits(mask);
+    }
+#endif
+    while (ptr < end && *ptr != '"' && *ptr != '\\' && uchar(*ptr) < 0x80)
+        ++ptr;
+    return ptr;
+}
+
 void Parser::eatBOM()
 {
     // eat UTF-8 byte order mark
@@ -258,16 +379,9 @@ void Parser::eatBOM()
 
 bool Parser::eatSpace()
 {
-    while (json < end) {
-        if (*json > Space)
-            break;
-        if (*json != Space &&
-            *json != Tab &&
-            *json != LineFeed &&
-            *json != Return)
-            break;
-        ++json;
-    }
+    // most tokens are not preceded by whitespace, or by a single space
+    if (json < end && *json <= Space)
+        json = skipWhitespace(json, end);
     return (json < end);
 }
 
@@ -440,6 +554,7 @@ bool Parser::parseObject()
     QJsonPrivate::Object *o = (QJsonPrivate::Object *)(data + objectOffset);
     o->tableOffset = table - objectOffset;
     o->size = current - objectOffset;
+    o->_dummy = 0;
     o->is_object = true;
     o->length = parsedObject.offsets.size();
 
@@ -586,6 +701,7 @@ bool Parser::parseArray()
     QJsonPrivate::Array *a = (QJsonPrivate::Array *)(data + arrayOffset);
     a->tableOffset = table - arrayOffset;
     a->size = current - arrayOffset;
+    a->_dummy = 0;
     a->is_object = false;
     a->length = values.size;
 
@@ -926,7 +1042,21 @@ bool Parser::parseString(bool *latin1)
         return false;
 
     BEGIN << "parse string stringPos=" << stringPos << json;
+    // a Latin-1 string holds at most 0x7fff characters
+    const char *latin1End = (end - start > 0x7fff) ? start + 0x7fff : end;
     while (json < end) {
+        const char *plain = skipPlainAscii(json, latin1End);
+        if (plain != json) {
+            const int length = int(plain - json);
+            int pos = reserveSpace(length);
+            if (pos < 0)
+                return false;
+            memcpy(data + pos, json, length);
+            json = plain;
+            if (json >= end)
+                break;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
@@ -979,6 +1109,23 @@ bool Parser::parseString(bool *latin1)
     current = outStart + sizeof(int);
 
     while (json < end) {
+        const char *plain = skipPlainAscii(json, end);
+        if (plain != json) {
+            const int length = int(plain - json);
+            int pos = reserveSpace(2 * length);
+            if (pos < 0)
+                return false;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            qt_from_latin1(reinterpret_cast<ushort *>(data + pos), json, length);
+#else
+            for (int i = 0; i < length; ++i)
+                reinterpret_cast<QJsonPrivate::qle_ushort *>(data + pos)[i] = ushort(uchar(json[i]));
+#endif
+            json = plain;
+            if (json >= end)
+                break;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
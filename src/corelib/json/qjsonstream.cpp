@@ -0,0 +1,1359 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qjsonstream.h"
+#include "qjsonarray.h"
+#include "qjsonobject.h"
+#include "qjsonwriter_p.h"
+
+#include <qiodevice.h>
+#include <qvarlengtharray.h>
+#include <private/qlocale_p.h>
+#include <private/qutfcodec_p.h>
+
+QT_BEGIN_NAMESPACE
+
+void qt_from_latin1(ushort *dst, const char *str, size_t size) Q_DECL_NOTHROW;
+
+// same as in qjsonparser.cpp
+static const int nestingLimit = 1024;
+
+// how much is read from the device, or collected before writing to it, at once
+static const int streamChunkSize = 16384;
+
+class QJsonStreamReaderPrivate
+{
+public:
+    enum State {
+        ValueExpected,          // at the top level, after a name, or in an array after a separator
+        FirstValueExpected,     // right after '['
+        NameExpected,           // in an object after a separator
+        FirstNameExpected,      // right after '{'
+        NameSeparatorExpected,
+        SeparatorExpected
+    };
+
+    QJsonStreamReaderPrivate()
+        : device(0)
+    {
+        buffer.reserve(streamChunkSize);
+        init();
+    }
+
+    void init()
+    {
+        buffer.resize(0);
+        pos = 0;
+        tokenStart = 0;
+        consumed = 0;
+        containers.clear();
+        state = ValueExpected;
+        type = QJsonStreamReader::NoToken;
+        error = QJsonParseError::NoError;
+        atEnd = false;
+        inputComplete = false;
+        boolean = false;
+        number = 0;
+    }
+
+    bool fill();
+    int peek(int i);
+    bool noMoreData() const
+    {
+        if (inputComplete)
+            return true;
+        // a sequential device can only say so by having been closed
+        return device && device->atEnd() && (!device->isSequential() || !device->isOpen());
+    }
+
+    QJsonStreamReader::TokenType readToken();
+    QJsonStreamReader::TokenType readValue(char c);
+    QJsonStreamReader::TokenType readLiteral(const char *literal, int length, QJsonStreamReader::TokenType token);
+    QJsonStreamReader::TokenType readNumber();
+    bool readString();
+    bool skipBom();
+    bool skipSpace();
+
+    QJsonStreamReader::TokenType raiseError(QJsonParseError::ParseError e)
+    {
+        error = e;
+        atEnd = true;
+        return QJsonStreamReader::Invalid;
+    }
+    QJsonStreamReader::TokenType valueRead(QJsonStreamReader::TokenType token)
+    {
+        state = containers.isEmpty() ? ValueExpected : SeparatorExpected;
+        return token;
+    }
+    QJsonStreamReader::TokenType containerEnded(QJsonStreamReader::TokenType token)
+    {
+        ++pos;
+        containers.removeLast();
+        return valueRead(token);
+    }
+
+    QJsonValue readCurrentValue(QJsonStreamReader *q);
+
+    QIODevice *device;
+
+    // The unread input. Everything before tokenStart is dropped when more
+    // input is needed, so the buffer never holds much more than the token
+    // being read plus one chunk.
+    QByteArray buffer;
+    int pos;
+    int tokenStart;
+    qint64 consumed;
+
+    QVarLengthArray<QJsonStreamReader::TokenType, 32> containers;
+    State state;
+
+    QJsonStreamReader::TokenType type;
+    QJsonParseError::ParseError error;
+    bool atEnd;
+    bool inputComplete;
+
+    // the current token; text and numberText keep their capacity between tokens
+    QString text;
+    QVarLengthArray<char, 32> numberText;
+    double number;
+    bool boolean;
+};
+
+/*
+    Reads more input, dropping everything before tokenStart first. Returns
+    false if no more data is available at the moment.
+*/
+bool QJsonStreamReaderPrivate::fill()
+{
+    if (!device || !device->isOpen())
+        return false;
+    if (tokenStart > 0) {
+        buffer.remove(0, tokenStart);
+        consumed += tokenStart;
+        pos -= tokenStart;
+        tokenStart = 0;
+    }
+    const int size = buffer.size();
+    buffer.resize(size + streamChunkSize);
+    const qint64 bytesRead = device->read(buffer.data() + size, streamChunkSize);
+    buffer.resize(size + int(qMax(bytesRead, qint64(0))));
+    return bytesRead > 0;
+}
+
+/*
+    Returns the byte at offset \a i from the start of the current token,
+    or -1 if the input ends before it.
+*/
+int QJsonStreamReaderPrivate::peek(int i)
+{
+    while (tokenStart + i >= buffer.size()) {
+        if (!fill())
+            return -1;
+    }
+    return uchar(buffer.at(tokenStart + i));
+}
+
+/*
+    Skips the UTF-8 byte order mark at the start of the input. Returns
+    false if there is not enough data yet to tell.
+*/
+bool QJsonStreamReaderPrivate::skipBom()
+{
+    static const char utf8bom[] = "\xef\xbb\xbf";
+    tokenStart = pos;
+    for (;;) {
+        const int available = buffer.size() - pos;
+        const int n = qMin(available, 3);
+        if (memcmp(buffer.constData() + pos, utf8bom, n) != 0)
+            return true;
+        if (n == 3) {
+            pos += 3;
+            return true;
+        }
+        if (!fill())
+            return available == 0;
+    }
+}
+
+bool QJsonStreamReaderPrivate::skipSpace()
+{
+    for (;;) {
+        const char *data = buffer.constData();
+        const int size = buffer.size();
+        while (pos < size) {
+            switch (data[pos]) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                ++pos;
+                continue;
+            default:
+                return true;
+            }
+        }
+        tokenStart = pos;
+        if (!fill())
+            return false;
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readToken()
+{
+    if (consumed + pos == 0 && !skipBom())
+        return raiseError(QJsonParseError::PrematureEndOfDocument);
+
+    for (;;) {
+        if (!skipSpace()) {
+            tokenStart = pos;
+            if (containers.isEmpty() && state == ValueExpected) {
+                // between two top-level values, nothing is missing
+                atEnd = true;
+                return QJsonStreamReader::NoToken;
+            }
+            return raiseError(QJsonParseError::PrematureEndOfDocument);
+        }
+        tokenStart = pos;
+        const char c = buffer.at(pos);
+
+        switch (state) {
+        case FirstNameExpected:
+        case NameExpected:
+            if (c == '"') {
+                ++pos;
+                if (!readString())
+                    return QJsonStreamReader::Invalid;
+                state = NameSeparatorExpected;
+                return QJsonStreamReader::Name;
+            }
+            if (c == '}') {
+                if (state == FirstNameExpected)
+                    return containerEnded(QJsonStreamReader::EndObject);
+                return raiseError(QJsonParseError::MissingObject);
+            }
+            return raiseError(QJsonParseError::UnterminatedObject);
+
+        case NameSeparatorExpected:
+            if (c != ':')
+                return raiseError(QJsonParseError::MissingNameSeparator);
+            ++pos;
+            state = ValueExpected;
+            continue;
+
+        case SeparatorExpected:
+            if (containers.last() == QJsonStreamReader::StartObject) {
+                if (c == ',') {
+                    ++pos;
+                    state = NameExpected;
+                    continue;
+                }
+                if (c == '}')
+                    return containerEnded(QJsonStreamReader::EndObject);
+                return raiseError(QJsonParseError::UnterminatedObject);
+            }
+            if (c == ',') {
+                ++pos;
+                state = ValueExpected;
+                continue;
+            }
+            if (c == ']')
+                return containerEnded(QJsonStreamReader::EndArray);
+            return raiseError(QJsonParseError::MissingValueSeparator);
+
+        case FirstValueExpected:
+            if (c == ']')
+                return containerEnded(QJsonStreamReader::EndArray);
+            Q_FALLTHROUGH();
+        case ValueExpected:
+            return readValue(c);
+        }
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readValue(char c)
+{
+    switch (c) {
+    case '{':
+    case '[':
+        if (containers.size() >= nestingLimit)
+            return raiseError(QJsonParseError::DeepNesting);
+        ++pos;
+        if (c == '{') {
+            containers.append(QJsonStreamReader::StartObject);
+            state = FirstNameExpected;
+            return QJsonStreamReader::StartObject;
+        }
+        containers.append(QJsonStreamReader::StartArray);
+        state = FirstValueExpected;
+        return QJsonStreamReader::StartArray;
+    case '"':
+        ++pos;
+        if (!readString())
+            return QJsonStreamReader::Invalid;
+        return valueRead(QJsonStreamReader::String);
+    case 't':
+        boolean = true;
+        return readLiteral("true", 4, QJsonStreamReader::Bool);
+    case 'f':
+        boolean = false;
+        return readLiteral("false", 5, QJsonStreamReader::Bool);
+    case 'n':
+        return readLiteral("null", 4, QJsonStreamReader::Null);
+    case ',':
+        // Essentially missing value, but after a colon, not after a comma
+        return raiseError(QJsonParseError::IllegalValue);
+    case '}':
+    case ']':
+        return raiseError(QJsonParseError::MissingObject);
+    default:
+        return readNumber();
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readLiteral(const char *literal, int length,
+                                                                   QJsonStreamReader::TokenType token)
+{
+    for (int i = 1; i < length; ++i) {
+        const int c = peek(i);
+        if (c < 0) {
+            pos = tokenStart;
+            return raiseError(QJsonParseError::PrematureEndOfDocument);
+        }
+        if (c != literal[i]) {
+            pos = tokenStart + i;
+            return raiseError(QJsonParseError::IllegalValue);
+        }
+    }
+    pos = tokenStart + length;
+    return valueRead(token);
+}
+
+/*
+        number = [ minus ] int [ frac ] [ exp ]
+
+    A number can only be told complete by the character following it, so
+    a number at the end of the available input is incomplete unless no
+    more input can follow.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::readNumber()
+{
+    int i = 0;
+    int c = peek(i);
+
+    // minus
+    if (c == '-')
+        c = peek(++i);
+
+    // int = zero / ( digit1-9 *DIGIT )
+    if (c == '0') {
+        c = peek(++i);
+    } else {
+        while (c >= '0' && c <= '9')
+            c = peek(++i);
+    }
+
+    // frac = decimal-point 1*DIGIT
+    if (c == '.') {
+        c = peek(++i);
+        while (c >= '0' && c <= '9')
+            c = peek(++i);
+    }
+
+    // exp = e [ minus / plus ] 1*DIGIT
+    if (c == 'e' || c == 'E') {
+        c = peek(++i);
+        if (c == '-' || c == '+')
+            c = peek(++i);
+        while (c >= '0' && c <= '9')
+            c = peek(++i);
+    }
+
+    if (c < 0 && !noMoreData()) {
+        pos = tokenStart;
+        return raiseError(QJsonParseError::PrematureEndOfDocument);
+    }
+
+    numberText.resize(i + 1);
+    memcpy(numberText.data(), buffer.constData() + tokenStart, i);
+    numberText[i] = '\0';
+    pos = tokenStart + i;
+
+    bool ok;
+    number = QLocaleData::bytearrayToDouble(numberText.constData(), &ok);
+    if (!ok)
+        return raiseError(QJsonParseError::IllegalNumber);
+    return valueRead(QJsonStreamReader::Number);
+}
+
+static inline bool addHexDigit(uchar digit, uint *result)
+{
+    *result <<= 4;
+    if (digit >= '0' && digit <= '9')
+        *result |= (digit - '0');
+    else if (digit >= 'a' && digit <= 'f')
+        *result |= (digit - 'a') + 10;
+    else if (digit >= 'A' && digit <= 'F')
+        *result |= (digit - 'A') + 10;
+    else
+        return false;
+    return true;
+}
+
+/*
+    Reads the string starting at pos, which is just after the opening quote,
+    into text. Strings without escape sequences and non-ASCII characters are
+    converted in one go.
+*/
+bool QJsonStreamReaderPrivate::readString()
+{
+    int end = pos - tokenStart;
+    bool plain = true;
+    for (;;) {
+        const char *data = buffer.constData() + tokenStart;
+        const int size = buffer.size() - tokenStart;
+        while (end < size) {
+            const uchar c = data[end];
+            if (c == '"')
+                break;
+            if (c == '\\') {
+                plain = false;
+                end += 2;
+                continue;
+            }
+            if (c >= 0x80)
+                plain = false;
+            ++end;
+        }
+        if (end < size)
+            break;
+        if (!fill()) {
+            pos = tokenStart;
+            raiseError(QJsonParseError::PrematureEndOfDocument);
+            return false;
+        }
+    }
+
+    const uchar *src = reinterpret_cast<const uchar *>(buffer.constData() + pos);
+    const uchar *const srcEnd = reinterpret_cast<const uchar *>(buffer.constData() + tokenStart + end);
+    const int length = int(srcEnd - src);
+
+    // no character takes up more UTF-16 code units than it takes bytes
+    text.resize(length);
+    ushort *dst = reinterpret_cast<ushort *>(text.data());
+    if (plain) {
+        qt_from_latin1(dst, reinterpret_cast<const char *>(src), length);
+        pos = tokenStart + end + 1;
+        return true;
+    }
+
+    ushort *const dstBegin = dst;
+    while (src < srcEnd) {
+        uint ch = *src++;
+        if (ch == '\\') {
+            switch (*src++) {
+            case '"':
+                ch = '"'; break;
+            case '\\':
+                ch = '\\'; break;
+            case '/':
+                ch = '/'; break;
+            case 'b':
+                ch = 0x8; break;
+            case 'f':
+                ch = 0xc; break;
+            case 'n':
+                ch = 0xa; break;
+            case 'r':
+                ch = 0xd; break;
+            case 't':
+                ch = 0x9; break;
+            case 'u':
+                ch = 0;
+                for (int i = 0; i < 4; ++i) {
+                    if (src == srcEnd || !addHexDigit(*src, &ch)) {
+                        pos = int(reinterpret_cast<const char *>(src) - buffer.constData());
+                        raiseError(QJsonParseError::IllegalEscapeSequence);
+                        return false;
+                    }
+                    ++src;
+                }
+                break;
+            default:
+                // this is not as strict as one could be, but allows for more Json files
+                // to be parsed correctly (same as QJsonDocument::fromJson)
+                ch = src[-1];
+                break;
+            }
+            *dst++ = ushort(ch);
+        } else if (QUtf8Functions::fromUtf8<QUtf8BaseTraits>(ch, dst, src, srcEnd) < 0) {
+            pos = int(reinterpret_cast<const char *>(src) - buffer.constData()) - 1;
+            raiseError(QJsonParseError::IllegalUTF8String);
+            return false;
+        }
+    }
+    text.resize(int(dst - dstBegin));
+    pos = tokenStart + end + 1;
+    return true;
+}
+
+QJsonValue QJsonStreamReaderPrivate::readCurrentValue(QJsonStreamReader *q)
+{
+    switch (type) {
+    case QJsonStreamReader::StartObject: {
+        QJsonObject object;
+        while (q->readNext() == QJsonStreamReader::Name) {
+            const QString name = text;
+            q->readNext();
+            const QJsonValue value = readCurrentValue(q);
+            if (value.isUndefined())
+                return value;
+            object.insert(name, value);
+        }
+        if (type != QJsonStreamReader::EndObject)
+            return QJsonValue(QJsonValue::Undefined);
+        return object;
+    }
+    case QJsonStreamReader::StartArray: {
+        QJsonArray array;
+        for (;;) {
+            if (q->readNext() == QJsonStreamReader::EndArray)
+                return array;
+            const QJsonValue value = readCurrentValue(q);
+            if (value.isUndefined())
+                return value;
+            array.append(value);
+        }
+    }
+    default:
+        return q->value();
+    }
+}
+
+/*!
+    \class QJsonStreamReader
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonStreamReader class reads JSON text as a stream of tokens.
+
+    QJsonDocument::fromJson() needs the complete text of a document in
+    memory and builds the complete document before the caller can look at
+    any of it. QJsonStreamReader instead reports the document piece by
+    piece: the application calls readNext() in a loop, and each call returns
+    the next token, such as the start of an object, the name of a member or
+    a string value. Only the token being read is kept in memory, so
+    arbitrarily large documents can be processed with a small, constant
+    amount of memory.
+
+    The reader takes its input either from a QIODevice (see setDevice()),
+    which it reads in chunks as needed, or from data passed to addData().
+    If the input ends in the middle of a document, readNext() returns
+    Invalid and error() returns QJsonParseError::PrematureEndOfDocument.
+    This is not fatal: once more data has been added, or has arrived on the
+    device, the next call to readNext() continues where the previous one
+    stopped. For sequential devices such as sockets, this is typically done
+    in a slot connected to QIODevice::readyRead(). All other errors are
+    final.
+
+    The input may contain any number of JSON values one after the other,
+    separated by whitespace, as for instance in newline-delimited JSON.
+    When the end of the input is reached between two values, readNext()
+    returns NoToken and atEnd() returns \c true without an error being
+    set. Values other than objects and arrays are accepted at the top
+    level; a number at the very end of the input is only complete once the
+    reader knows that no more input follows. That is the case for a
+    QByteArray passed to the constructor, for a random-access device at
+    its end and for a sequential device that has been closed; otherwise,
+    call setInputComplete() once all data has been added or has arrived.
+
+    A typical loop looks like this:
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 0
+
+    The text of names and strings is available as text(), numbers with
+    toDouble(), and booleans with toBool(). value() returns any scalar
+    token as a QJsonValue, while readCurrentValue() reads a complete object
+    or array into a QJsonValue, which is convenient for processing a long
+    sequence of small records.
+
+    The reader accepts the same input as QJsonDocument::fromJson() and
+    reports the same errors for it.
+
+    \sa QJsonStreamWriter, QJsonDocument, {JSON Support in Qt}
+*/
+
+/*!
+    \enum QJsonStreamReader::TokenType
+
+    This enum specifies the type of token the reader just read.
+
+    \value NoToken      The reader has not read anything yet, or is at the
+                        end of the input between two values.
+    \value Invalid      An error has occurred, reported in error() and
+                        errorString().
+    \value StartObject  The start of an object.
+    \value EndObject    The end of an object.
+    \value StartArray   The start of an array.
+    \value EndArray     The end of an array.
+    \value Name         The name of an object member. text() returns the
+                        name; the member's value is the next token.
+    \value String       A string; text() returns its contents.
+    \value Number       A number; toDouble() returns its value and text()
+                        its literal representation.
+    \value Bool         \c true or \c false, as returned by toBool().
+    \value Null         \c null.
+*/
+
+/*!
+    Constructs a stream reader without input.
+
+    \sa setDevice(), addData()
+*/
+QJsonStreamReader::QJsonStreamReader()
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+}
+
+/*!
+    Constructs a stream reader that reads from \a device.
+
+    \sa setDevice()
+*/
+QJsonStreamReader::QJsonStreamReader(QIODevice *device)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Constructs a stream reader that reads from \a data. The input is
+    considered complete, as if setInputComplete() had been called, until
+    more data is added.
+
+    \sa addData()
+*/
+QJsonStreamReader::QJsonStreamReader(const QByteArray &data)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    addData(data);
+    setInputComplete();
+}
+
+/*!
+    Destroys the reader.
+*/
+QJsonStreamReader::~QJsonStreamReader()
+{
+}
+
+/*!
+    Sets the current device to \a device and resets the reader to its
+    initial state. The reader does not take ownership of the device.
+
+    \sa device(), clear()
+*/
+void QJsonStreamReader::setDevice(QIODevice *device)
+{
+    Q_D(QJsonStreamReader);
+    d->init();
+    d->device = device;
+}
+
+/*!
+    Returns the current device, or 0 if no device has been set.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamReader::device() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->device;
+}
+
+/*!
+    Adds more \a data for the reader to read. This function does nothing
+    if the reader has a device(). atEnd() returns \c false afterwards, and
+    the input is no longer considered complete.
+
+    \sa readNext(), setInputComplete(), clear()
+*/
+void QJsonStreamReader::addData(const QByteArray &data)
+{
+    Q_D(QJsonStreamReader);
+    if (d->device) {
+        qWarning("QJsonStreamReader: addData() with device()");
+        return;
+    }
+    if (d->pos > 0) {
+        d->buffer.remove(0, d->pos);
+        d->consumed += d->pos;
+        d->pos = 0;
+        d->tokenStart = 0;
+    }
+    d->buffer += data;
+    d->atEnd = false;
+    d->inputComplete = false;
+}
+
+/*!
+    Tells the reader that no more input follows what has been added with
+    addData() or what the device() currently delivers, as for instance
+    after a socket has been disconnected.
+
+    Only the end of a number cannot be recognized without this, so it
+    matters when the input ends with a top-level number such as \c{42}:
+    until this function has been called, readNext() returns Invalid with
+    the error QJsonParseError::PrematureEndOfDocument for it, waiting for
+    more digits. Calling addData() or setDevice() clears the flag.
+
+    \sa addData(), atEnd()
+*/
+void QJsonStreamReader::setInputComplete()
+{
+    Q_D(QJsonStreamReader);
+    d->inputComplete = true;
+}
+
+/*!
+    Removes any device() or data from the reader and resets its internal
+    state to the initial state.
+
+    \sa addData()
+*/
+void QJsonStreamReader::clear()
+{
+    Q_D(QJsonStreamReader);
+    d->init();
+    d->device = 0;
+}
+
+/*!
+    Returns \c true if the reader has read until the end of the input
+    that is currently available, or if an error has occurred; otherwise
+    returns \c false.
+
+    When the reader stopped in the middle of a document, error() returns
+    QJsonParseError::PrematureEndOfDocument and reading can continue once
+    more data is available.
+
+    \sa hasError(), readNext()
+*/
+bool QJsonStreamReader::atEnd() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->atEnd;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    If an error other than QJsonParseError::PrematureEndOfDocument has
+    occurred, reading is no longer possible and this function returns
+    Invalid.
+
+    \sa tokenType(), atEnd()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::readNext()
+{
+    Q_D(QJsonStreamReader);
+    if (d->error != QJsonParseError::NoError) {
+        if (d->error != QJsonParseError::PrematureEndOfDocument)
+            return Invalid;
+        d->error = QJsonParseError::NoError;
+    }
+    d->atEnd = false;
+    d->type = d->readToken();
+    return d->type;
+}
+
+/*!
+    If the current token is the start of an object or an array, reads
+    until the end of it. Otherwise this function does nothing.
+
+    \sa readCurrentValue()
+*/
+void QJsonStreamReader::skipCurrentValue()
+{
+    Q_D(QJsonStreamReader);
+    if (d->type != StartObject && d->type != StartArray)
+        return;
+    const int level = d->containers.size();
+    while (d->containers.size() >= level) {
+        if (readNext() == Invalid)
+            return;
+    }
+}
+
+/*!
+    Reads the value that starts with the current token, including all
+    of its contents if it is an object or an array, and returns it. The
+    current token is then the last token of the value.
+
+    If the current token does not start a value, or if the value could not
+    be read completely, an undefined QJsonValue is returned. In the latter
+    case hasError() returns \c true. If the input ended in the middle of the
+    value, reading can continue once more data is available, but the part
+    of the value read so far is lost. This function is therefore best used
+    with a device that delivers data as it is asked for, such as a file.
+
+    \sa skipCurrentValue(), value()
+*/
+QJsonValue QJsonStreamReader::readCurrentValue()
+{
+    Q_D(QJsonStreamReader);
+    return d->readCurrentValue(this);
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa readNext()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::tokenType() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type;
+}
+
+/*!
+    Returns the number of objects and arrays that are open at the current
+    token. The start of an object or array already counts, the end no
+    longer does.
+*/
+int QJsonStreamReader::depth() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->containers.size();
+}
+
+/*!
+    Returns the number of bytes of input the reader has read up to the
+    end of the current token, or up to the position of the error if an
+    error occurred.
+*/
+qint64 QJsonStreamReader::offset() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->consumed + d->pos;
+}
+
+/*!
+    Returns the name for Name tokens, the contents for String tokens and
+    the literal text for Number tokens. Returns an empty string for other
+    tokens.
+
+    \sa tokenType()
+*/
+QString QJsonStreamReader::text() const
+{
+    Q_D(const QJsonStreamReader);
+    switch (d->type) {
+    case Name:
+    case String:
+        return d->text;
+    case Number:
+        return QString::fromLatin1(d->numberText.constData(), d->numberText.size() - 1);
+    default:
+        return QString();
+    }
+}
+
+/*!
+    Returns the value of a Number token, or 0 for other tokens.
+*/
+double QJsonStreamReader::toDouble() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type == Number ? d->number : 0;
+}
+
+/*!
+    Returns the value of a Bool token, or \c false for other tokens.
+*/
+bool QJsonStreamReader::toBool() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type == Bool && d->boolean;
+}
+
+/*!
+    Returns the current token as a QJsonValue if it is a string, a number,
+    a boolean or null. Returns an undefined QJsonValue for other tokens.
+
+    \sa readCurrentValue()
+*/
+QJsonValue QJsonStreamReader::value() const
+{
+    Q_D(const QJsonStreamReader);
+    switch (d->type) {
+    case String:
+        return d->text;
+    case Number:
+        return d->number;
+    case Bool:
+        return d->boolean;
+    case Null:
+        return QJsonValue();
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+/*!
+    Returns the type of the current error, or QJsonParseError::NoError if
+    no error occurred.
+
+    \sa errorString(), hasError()
+*/
+QJsonParseError::ParseError QJsonStreamReader::error() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->error;
+}
+
+/*!
+    Returns the message for the current error.
+
+    \sa error()
+*/
+QString QJsonStreamReader::errorString() const
+{
+    Q_D(const QJsonStreamReader);
+    QJsonParseError error;
+    error.error = d->error;
+    error.offset = int(d->consumed + d->pos);
+    return error.errorString();
+}
+
+/*!
+    Returns \c true if an error has occurred, otherwise \c false.
+
+    \sa error()
+*/
+bool QJsonStreamReader::hasError() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->error != QJsonParseError::NoError;
+}
+
+class QJsonStreamWriterPrivate
+{
+public:
+    struct Container {
+        bool object;
+        bool empty;
+    };
+
+    QJsonStreamWriterPrivate()
+        : device(0), output(&buffer), compact(false), nameWritten(false), hasError(false)
+    {
+    }
+
+    void writeSeparator();
+    bool beginValue(const char *function);
+    void endValue();
+    void endContainer(bool object);
+    void writeBuffer();
+
+    QIODevice *device;
+    QByteArray buffer;
+    QByteArray *output;
+    QVarLengthArray<Container, 32> containers;
+    bool compact;
+    bool nameWritten;
+    bool hasError;
+};
+
+void QJsonStreamWriterPrivate::writeSeparator()
+{
+    Container &container = containers.last();
+    if (container.empty)
+        container.empty = false;
+    else
+        *output += compact ? "," : ",\n";
+    if (!compact)
+        output->append(4*containers.size(), ' ');
+}
+
+bool QJsonStreamWriterPrivate::beginValue(const char *function)
+{
+    if (containers.isEmpty())
+        return true;
+    if (!containers.last().object) {
+        writeSeparator();
+        return true;
+    }
+    if (!nameWritten) {
+        qWarning("QJsonStreamWriter::%s: No name written for the value", function);
+        return false;
+    }
+    nameWritten = false;
+    return true;
+}
+
+void QJsonStreamWriterPrivate::endValue()
+{
+    if (containers.isEmpty())
+        *output += '\n';
+    if (device && buffer.size() >= streamChunkSize)
+        writeBuffer();
+}
+
+void QJsonStreamWriterPrivate::endContainer(bool object)
+{
+    const char *function = object ? "writeEndObject" : "writeEndArray";
+    if (containers.isEmpty() || containers.last().object != object) {
+        qWarning("QJsonStreamWriter::%s: Not inside an %s", function, object ? "object" : "array");
+        return;
+    }
+    if (nameWritten) {
+        qWarning("QJsonStreamWriter::%s: No value written for the last name", function);
+        return;
+    }
+    const Container container = containers.last();
+    containers.removeLast();
+    if (!compact) {
+        if (!container.empty)
+            *output += '\n';
+        output->append(4*containers.size(), ' ');
+    }
+    *output += object ? '}' : ']';
+    endValue();
+}
+
+void QJsonStreamWriterPrivate::writeBuffer()
+{
+    if (!device || buffer.isEmpty())
+        return;
+    if (device->write(buffer) != buffer.size())
+        hasError = true;
+    buffer.resize(0);
+}
+
+/*!
+    \class QJsonStreamWriter
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.10
+
+    \brief The QJsonStreamWriter class writes JSON text piece by piece.
+
+    QJsonDocument::toJson() needs the complete document in memory and
+    returns all of its text in one QByteArray. QJsonStreamWriter writes a
+    document while it is being produced, directly to a QIODevice (see
+    setDevice()) or appended to a QByteArray. Only a small buffer is held
+    before the text is passed on to the device.
+
+    Objects and arrays are opened with writeStartObject() and
+    writeStartArray() and closed with writeEndObject() and writeEndArray().
+    Inside an object, every value is preceded by writeName(). Values are
+    written with writeString(), writeDouble(), writeBool(), writeNull() or,
+    for complete values that are already available as QJsonValue,
+    writeValue().
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 1
+
+    The layout of the text is selected with setFormat(). In the
+    QJsonDocument::Indented format, a document is written exactly as
+    QJsonDocument::toJson() would write it. Any number of values can be
+    written one after the other; each top-level value is followed by a
+    newline, so that with the QJsonDocument::Compact format the output is
+    newline-delimited JSON.
+
+    \sa QJsonStreamReader, QJsonDocument, {JSON Support in Qt}
+*/
+
+/*!
+    Constructs a stream writer without a device.
+
+    \sa setDevice()
+*/
+QJsonStreamWriter::QJsonStreamWriter()
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+}
+
+/*!
+    Constructs a stream writer that writes to \a device.
+
+    \sa setDevice()
+*/
+QJsonStreamWriter::QJsonStreamWriter(QIODevice *device)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Constructs a stream writer that appends to \a array.
+*/
+QJsonStreamWriter::QJsonStreamWriter(QByteArray *array)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    Q_D(QJsonStreamWriter);
+    d->output = array;
+}
+
+/*!
+    Writes out any buffered text and destroys the writer.
+*/
+QJsonStreamWriter::~QJsonStreamWriter()
+{
+    Q_D(QJsonStreamWriter);
+    d->writeBuffer();
+}
+
+/*!
+    Sets the current device to \a device. Text still buffered for the
+    previous device is written to it first. The writer does not take
+    ownership of the device.
+
+    \sa device()
+*/
+void QJsonStreamWriter::setDevice(QIODevice *device)
+{
+    Q_D(QJsonStreamWriter);
+    d->writeBuffer();
+    d->device = device;
+    d->output = &d->buffer;
+    if (device)
+        d->buffer.reserve(2*streamChunkSize);
+}
+
+/*!
+    Returns the current device, or 0 if no device is set.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamWriter::device() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->device;
+}
+
+/*!
+    Sets the layout of the written text to \a format. The default is
+    QJsonDocument::Indented. The format should not be changed in the
+    middle of a value.
+
+    \sa format()
+*/
+void QJsonStreamWriter::setFormat(QJsonDocument::JsonFormat format)
+{
+    Q_D(QJsonStreamWriter);
+    d->compact = format == QJsonDocument::Compact;
+}
+
+/*!
+    Returns the layout of the written text.
+
+    \sa setFormat()
+*/
+QJsonDocument::JsonFormat QJsonStreamWriter::format() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->compact ? QJsonDocument::Compact : QJsonDocument::Indented;
+}
+
+/*!
+    Writes the start of an object. Each value written inside the object
+    must be preceded by writeName().
+
+    \sa writeEndObject()
+*/
+void QJsonStreamWriter::writeStartObject()
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeStartObject"))
+        return;
+    *d->output += d->compact ? "{" : "{\n";
+    const QJsonStreamWriterPrivate::Container container = { true, true };
+    d->containers.append(container);
+}
+
+/*!
+    Closes the object opened by the matching writeStartObject().
+*/
+void QJsonStreamWriter::writeEndObject()
+{
+    Q_D(QJsonStreamWriter);
+    d->endContainer(true);
+}
+
+/*!
+    Writes the start of an array.
+
+    \sa writeEndArray()
+*/
+void QJsonStreamWriter::writeStartArray()
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeStartArray"))
+        return;
+    *d->output += d->compact ? "[" : "[\n";
+    const QJsonStreamWriterPrivate::Container container = { false, true };
+    d->containers.append(container);
+}
+
+/*!
+    Closes the array opened by the matching writeStartArray().
+*/
+void QJsonStreamWriter::writeEndArray()
+{
+    Q_D(QJsonStreamWriter);
+    d->endContainer(false);
+}
+
+/*!
+    Writes \a name as the name of the next member of the current object.
+    The member's value has to be written next.
+*/
+void QJsonStreamWriter::writeName(const QString &name)
+{
+    Q_D(QJsonStreamWriter);
+    if (d->containers.isEmpty() || !d->containers.last().object) {
+        qWarning("QJsonStreamWriter::writeName: Not inside an object");
+        return;
+    }
+    if (d->nameWritten) {
+        qWarning("QJsonStreamWriter::writeName: No value written for the last name");
+        return;
+    }
+    d->writeSeparator();
+    QJsonPrivate::Writer::stringToJson(name, *d->output);
+    *d->output += d->compact ? ":" : ": ";
+    d->nameWritten = true;
+}
+
+/*!
+    Writes the string \a value.
+*/
+void QJsonStreamWriter::writeString(const QString &value)
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeString"))
+        return;
+    QJsonPrivate::Writer::stringToJson(value, *d->output);
+    d->endValue();
+}
+
+/*!
+    Writes the number \a value. As with QJsonDocument::toJson(), infinite
+    values and NaN are written as \c null.
+*/
+void QJsonStreamWriter::writeDouble(double value)
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeDouble"))
+        return;
+    QJsonPrivate::Writer::doubleToJson(value, *d->output);
+    d->endValue();
+}
+
+/*!
+    Writes the boolean \a value.
+*/
+void QJsonStreamWriter::writeBool(bool value)
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeBool"))
+        return;
+    *d->output += value ? "true" : "false";
+    d->endValue();
+}
+
+/*!
+    Writes \c null.
+*/
+void QJsonStreamWriter::writeNull()
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeNull"))
+        return;
+    *d->output += "null";
+    d->endValue();
+}
+
+/*!
+    Writes \a value, including all contents if it is an object or an
+    array. An undefined value is written as \c null.
+*/
+void QJsonStreamWriter::writeValue(const QJsonValue &value)
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeValue"))
+        return;
+    QJsonPrivate::Writer::valueToJson(value, *d->output, d->compact ? 0 : d->containers.size(), d->compact);
+    d->endValue();
+}
+
+/*!
+    Returns the number of objects and arrays that are currently open.
+*/
+int QJsonStreamWriter::depth() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->containers.size();
+}
+
+/*!
+    Writes any buffered text to the device(). The text is also written
+    when enough of it has been collected, when the device is changed and
+    when the writer is destroyed.
+*/
+void QJsonStreamWriter::flush()
+{
+    Q_D(QJsonStreamWriter);
+    d->writeBuffer();
+}
+
+/*!
+    Returns \c true if writing to the device() failed, otherwise \c false.
+*/
+bool QJsonStreamWriter::hasError() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->hasError;
+}
+
+QT_END_NAMESPACE
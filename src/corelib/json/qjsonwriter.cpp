@@ -40,6 +40,8 @@
 
 #include <cmath>
 #include <qlocale.h>
+#include <qjsonarray.h>
+#include <qjsonobject.h>
 #include "qjsonwriter_p.h"
 #include "qjson_p.h"
 #include "private/qutfcodec_p.h"
@@ -56,23 +58,26 @@ static inline uchar hexdig(uint u)
     return (u < 0xa ? '0' + u : 'a' + u - 0xa);
 }
 
-static QByteArray escapedString(const QString &s)
+void Writer::stringToJson(const QString &s, QByteArray &json)
 {
     const uchar replacement = '?';
-    QByteArray ba(s.length(), Qt::Uninitialized);
+    int pos = json.size();
+    json.resize(pos + s.length() + 2);
 
-    uchar *cursor = reinterpret_cast<uchar *>(const_cast<char *>(ba.constData()));
-    const uchar *ba_end = cursor + ba.length();
+    uchar *cursor = reinterpret_cast<uchar *>(json.data()) + pos;
+    const uchar *ba_end = reinterpret_cast<const uchar *>(json.constData()) + json.length();
     const ushort *src = reinterpret_cast<const ushort *>(s.constBegin());
     const ushort *const end = reinterpret_cast<const ushort *>(s.constEnd());
 
+    *cursor++ = '"';
     while (src != end) {
         if (cursor >= ba_end - 6) {
-            // ensure we have enough space
-            int pos = cursor - (const uchar *)ba.constData();
-            ba.resize(ba.size()*2);
-            cursor = (uchar *)ba.data() + pos;
-            ba_end = (const uchar *)ba.constData() + ba.length();
+            // ensure we have enough space, relative to what is left of the
+            // string: json may already hold a lot of unrelated output
+            pos = cursor - (const uchar *)json.constData();
+            json.resize(pos + 2*(end - src) + 8);
+            cursor = (uchar *)json.data() + pos;
+            ba_end = (const uchar *)json.constData() + json.length();
         }
 
         uint u = *src++;
@@ -116,9 +121,24 @@ static QByteArray escapedString(const QString &s)
                 *cursor++ = replacement;
         }
     }
+    if (cursor >= ba_end) {
+        pos = cursor - (const uchar *)json.constData();
+        json.resize(pos + 1);
+        cursor = (uchar *)json.data() + pos;
+    }
+    *cursor++ = '"';
+
+    json.resize(cursor - (const uchar *)json.constData());
+}
 
-    ba.resize(cursor - (const uchar *)ba.constData());
-    return ba;
+void Writer::doubleToJson(double d, QByteArray &json)
+{
+    if (qIsFinite(d)) { // +2 to format to ensure the expected precision
+        const double abs = std::abs(d);
+        json += QByteArray::number(d, abs == static_cast<quint64>(abs) ? 'f' : 'g', QLocale::FloatingPointShortest);
+    } else {
+        json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
+    }
 }
 
 static void valueToJson(const QJsonPrivate::Base *b, const QJsonPrivate::Value &v, QByteArray &json, int indent, bool compact)
@@ -128,20 +148,11 @@ static void valueToJson(const QJsonPrivate::Base *b, const QJsonPrivate::Value &
     case QJsonValue::Bool:
         json += v.toBoolean() ? "true" : "false";
         break;
-    case QJsonValue::Double: {
-        const double d = v.toDouble(b);
-        if (qIsFinite(d)) { // +2 to format to ensure the expected precision
-            const double abs = std::abs(d);
-            json += QByteArray::number(d, abs == static_cast<quint64>(abs) ? 'f' : 'g', QLocale::FloatingPointShortest);
-        } else {
-            json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
-        }
+    case QJsonValue::Double:
+        Writer::doubleToJson(v.toDouble(b), json);
         break;
-    }
     case QJsonValue::String:
-        json += '"';
-        json += escapedString(v.toString(b));
-        json += '"';
+        Writer::stringToJson(v.toString(b), json);
         break;
     case QJsonValue::Array:
         json += compact ? "[" : "[\n";
@@ -195,9 +206,8 @@ static void objectContentToJson(const QJsonPrivate::Object *o, QByteArray &json,
     while (1) {
         QJsonPrivate::Entry *e = o->entryAt(i);
         json += indentString;
-        json += '"';
-        json += escapedString(e->key());
-        json += compact ? "\":" : "\": ";
+        Writer::stringToJson(e->key(), json);
+        json += compact ? ":" : ": ";
         valueToJson(o, e->value, json, indent, compact);
 
         if (++i == o->length) {
@@ -228,4 +238,62 @@ void Writer::arrayToJson(const QJsonPrivate::Array *a, QByteArray &json, int ind
     json += compact ? "]" : "]\n";
 }
 
+void Writer::valueToJson(const QJsonValue &value, QByteArray &json, int indent, bool compact)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        json += value.toBool() ? "true" : "false";
+        break;
+    case QJsonValue::Double:
+        doubleToJson(value.toDouble(), json);
+        break;
+    case QJsonValue::String:
+        stringToJson(value.toString(), json);
+        break;
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        json += compact ? "[" : "[\n";
+        if (!array.isEmpty()) {
+            const int innerIndent = indent + (compact ? 0 : 1);
+            const QByteArray indentString(4*innerIndent, ' ');
+            for (int i = 0; i < array.size(); ++i) {
+                if (i)
+                    json += compact ? "," : ",\n";
+                json += indentString;
+                valueToJson(array.at(i), json, innerIndent, compact);
+            }
+            if (!compact)
+                json += '\n';
+        }
+        json += QByteArray(4*indent, ' ');
+        json += ']';
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        json += compact ? "{" : "{\n";
+        if (!object.isEmpty()) {
+            const int innerIndent = indent + (compact ? 0 : 1);
+            const QByteArray indentString(4*innerIndent, ' ');
+            for (QJsonObject::const_iterator it = object.begin(); it != object.end(); ++it) {
+                if (it != object.begin())
+                    json += compact ? "," : ",\n";
+                json += indentString;
+                stringToJson(it.key(), json);
+                json += compact ? ":" : ": ";
+                valueToJson(it.value(), json, innerIndent, compact);
+            }
+            if (!compact)
+                json += '\n';
+        }
+        json += QByteArray(4*indent, ' ');
+        json += '}';
+        break;
+    }
+    case QJsonValue::Null:
+    default:
+        json += "null";
+    }
+}
+
 QT_END_NAMESPACE
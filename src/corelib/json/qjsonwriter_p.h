@@ -64,6 +64,9 @@ class Writer
 public:
     static void objectToJson(const QJsonPrivate::Object *o, QByteArray &json, int indent, bool compact = false);
     static void arrayToJson(const QJsonPrivate::Array *a, QByteArray &json, int indent, bool compact = false);
+    static void valueToJson(const QJsonValue &value, QByteArray &json, int indent, bool compact = false);
+    static void stringToJson(const QString &string, QByteArray &json);
+    static void doubleToJson(double d, QByteArray &json);
 };
 
 }
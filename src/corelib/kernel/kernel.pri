@@ -180,6 +180,13 @@ unix|integrity {
     integrity: QMAKE_CXXFLAGS += --pending_instantiations=128
 }
 
+linux:!android {
+        SOURCES += \
+                kernel/qsharedmemorychannel.cpp
+        HEADERS += \
+                kernel/qsharedmemorychannel.h
+}
+
 vxworks {
         SOURCES += \
                 kernel/qfunctions_vxworks.cpp
@@ -46,6 +46,10 @@
 #include <private/qcoreapplication_p.h>
 #include <private/qfreelist_p.h>
 
+#include <algorithm>
+#include <atomic>
+#include <string.h> // memcpy
+
 QT_BEGIN_NAMESPACE
 
 // we allow for 2^24 = 8^8 = 16777216 simultaneously running timers
@@ -101,6 +105,108 @@ void QAbstractEventDispatcherPrivate::releaseTimerId(int timerId)
         fl->release(timerId);
 }
 
+QEventDispatcherStatisticsRecorder::QEventDispatcherStatisticsRecorder()
+    : depth(0), iterationStart(0), blockedAtIterationStart(0), blockingStart(0), counters()
+{
+}
+
+// A sequence lock: the (only) writer makes the sequence number odd while it
+// modifies the counters, readers retry until they see the same even number
+// before and after copying them.
+void QEventDispatcherStatisticsRecorder::beginUpdate()
+{
+    sequence.store(sequence.load() + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void QEventDispatcherStatisticsRecorder::endUpdate()
+{
+    sequence.storeRelease(sequence.load() + 1);
+}
+
+QEventDispatcherStatisticsRecorder::Counters QEventDispatcherStatisticsRecorder::snapshot() const
+{
+    Counters result;
+    for (;;) {
+        const int before = sequence.loadAcquire();
+        if (before & 1) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        memcpy(&result, &counters, sizeof(result));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load() == before)
+            return result;
+    }
+}
+
+void QEventDispatcherStatisticsRecorder::beginIteration()
+{
+    if (depth++ == 0) {
+        iterationStart = currentTime();
+        blockedAtIterationStart = counters.blockedTime;
+    }
+}
+
+void QEventDispatcherStatisticsRecorder::endIteration()
+{
+    Q_ASSERT(depth > 0);
+    beginUpdate();
+    ++counters.iterations;
+    if (--depth == 0) {
+        // time blocked in nested event loops does not count as busy either
+        const qint64 elapsed = currentTime() - iterationStart;
+        const qint64 blocked = counters.blockedTime - blockedAtIterationStart;
+        counters.busyTime += qMax(Q_INT64_C(0), elapsed - blocked);
+    }
+    endUpdate();
+}
+
+void QEventDispatcherStatisticsRecorder::endBlocking()
+{
+    // event dispatchers that cannot wrap the wait itself may end it
+    // without having begun it
+    if (!blockingStart)
+        return;
+    const qint64 blocked = currentTime() - blockingStart;
+    blockingStart = 0;
+    beginUpdate();
+    counters.blockedTime += blocked;
+    endUpdate();
+}
+
+void QEventDispatcherStatisticsRecorder::recordEvent(int type, qint64 time)
+{
+    EventTypeCounters &entry = counters.eventTypes[uint(type) < uint(EventTypeEntries - 1)
+                                                   ? type : EventTypeEntries - 1];
+    beginUpdate();
+    ++entry.count;
+    entry.totalTime += time;
+    entry.maximumTime = qMax(entry.maximumTime, time);
+    endUpdate();
+}
+
+void QEventDispatcherStatisticsRecorder::recordPostedEventDelivery(qint64 latency)
+{
+    beginUpdate();
+    ++counters.deliveredPostedEvents;
+    counters.totalPostedEventLatency += latency;
+    counters.maximumPostedEventLatency = qMax(counters.maximumPostedEventLatency, latency);
+    endUpdate();
+}
+
+void QEventDispatcherStatisticsRecorder::recordTimerLateness(qint64 lateness)
+{
+    // bucket i counts timers that were less than 2^i ms late
+    const qint64 msecs = lateness / (1000 * 1000);
+    int bucket = 0;
+    while (bucket < TimerLatenessBuckets - 1 && msecs >= (Q_INT64_C(1) << bucket))
+        ++bucket;
+    beginUpdate();
+    ++counters.timerLateness[bucket];
+    endUpdate();
+}
+
 /*!
     \class QAbstractEventDispatcher
     \inmodule QtCore
@@ -520,6 +626,284 @@ bool QAbstractEventDispatcher::filterNativeEvent(const QByteArray &eventType, vo
     \sa awake()
 */
 
+/*!
+    \since 5.10
+
+    Returns the statistics collected by this event dispatcher since it
+    was created.
+
+    The counters are updated by the thread the dispatcher belongs to, as
+    part of its normal operation, and are cheap enough to be always
+    enabled. This function can be called from any thread; it returns a
+    consistent copy of them together with the current state of the posted
+    event queue of that thread. To monitor the event loop of a QThread,
+    call this function on the object returned by QThread::eventDispatcher().
+
+    The iteration, blocking and timer counters are maintained by the
+    implementation of processEvents(). Only the event and posted event
+    counters are available with event dispatchers that do not maintain
+    them, such as the ones used on \macos, iOS and WinRT.
+
+    \sa QEventDispatcherStatistics
+*/
+QEventDispatcherStatistics QAbstractEventDispatcher::statistics() const
+{
+    Q_D(const QAbstractEventDispatcher);
+    QEventDispatcherStatistics result;
+    QEventDispatcherStatisticsPrivate *s = result.d.data();
+    s->counters = d->statistics.snapshot();
+
+    QThreadData *data = d->threadData;
+    QMutexLocker locker(&data->postEventList.mutex);
+    const qint64 now = QEventDispatcherStatisticsRecorder::currentTime();
+    for (int i = data->postEventList.startOffset; i < data->postEventList.size(); ++i) {
+        const QPostEvent &pe = data->postEventList.at(i);
+        if (!pe.event)
+            continue;
+        ++s->postedEventCount;
+        s->oldestPostedEventAge = qMax(s->oldestPostedEventAge, now - pe.postTime);
+    }
+    return result;
+}
+
+/*!
+    \class QEventDispatcherStatistics
+    \inmodule QtCore
+    \since 5.10
+    \ingroup events
+    \ingroup shared
+
+    \brief The QEventDispatcherStatistics class holds load and latency
+    counters of an event dispatcher.
+
+    Objects of this class are returned by QAbstractEventDispatcher::statistics().
+    They are a snapshot of the counters taken at the time of the call: the
+    counters only ever grow, so the load of an event loop over a period of
+    time is the difference between two snapshots.
+
+    All times are in nanoseconds.
+
+    \list
+    \li iterations(), busyTime() and blockedTime() tell how often the event
+        loop ran and how its time was split between handling events and
+        waiting for them. An event loop that is rarely blocked is saturated.
+    \li postedEventCount() and oldestPostedEventAge() describe the queue of
+        posted events waiting to be delivered, while
+        deliveredPostedEventCount(), averagePostedEventLatency() and
+        maximumPostedEventLatency() describe how long delivered events
+        waited in it.
+    \li timerLatenessHistogram() shows how late timers fired.
+    \li eventCount(), eventHandlingTime() and maximumEventHandlingTime()
+        show where the time handling events was spent.
+    \endlist
+
+    \sa QAbstractEventDispatcher::statistics()
+*/
+
+/*!
+    Constructs an object with all counters set to zero.
+*/
+QEventDispatcherStatistics::QEventDispatcherStatistics()
+    : d(new QEventDispatcherStatisticsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QEventDispatcherStatistics::QEventDispatcherStatistics(const QEventDispatcherStatistics &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to this object.
+*/
+QEventDispatcherStatistics &QEventDispatcherStatistics::operator=(const QEventDispatcherStatistics &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn QEventDispatcherStatistics &QEventDispatcherStatistics::operator=(QEventDispatcherStatistics &&other)
+
+    Move-assigns \a other to this object.
+*/
+
+/*!
+    Destroys this object.
+*/
+QEventDispatcherStatistics::~QEventDispatcherStatistics()
+{
+}
+
+/*!
+    \fn void QEventDispatcherStatistics::swap(QEventDispatcherStatistics &other)
+
+    Swaps this object with \a other. This operation is very fast and never fails.
+*/
+
+/*!
+    Returns the number of times events were processed, that is, the number
+    of calls to QAbstractEventDispatcher::processEvents(), including the
+    ones made by nested event loops.
+*/
+quint64 QEventDispatcherStatistics::iterations() const
+{
+    return d->counters.iterations;
+}
+
+/*!
+    Returns the time spent processing events, excluding the time spent
+    waiting for them.
+
+    \sa blockedTime()
+*/
+qint64 QEventDispatcherStatistics::busyTime() const
+{
+    return d->counters.busyTime;
+}
+
+/*!
+    Returns the time spent waiting for events.
+
+    \sa busyTime(), QAbstractEventDispatcher::aboutToBlock()
+*/
+qint64 QEventDispatcherStatistics::blockedTime() const
+{
+    return d->counters.blockedTime;
+}
+
+/*!
+    Returns the number of posted events that were waiting to be delivered
+    when the statistics were taken.
+
+    \sa oldestPostedEventAge(), QCoreApplication::postEvent()
+*/
+int QEventDispatcherStatistics::postedEventCount() const
+{
+    return d->postedEventCount;
+}
+
+/*!
+    Returns how long the oldest of the posted events counted by
+    postedEventCount() had been waiting, or 0 if there were none.
+*/
+qint64 QEventDispatcherStatistics::oldestPostedEventAge() const
+{
+    return d->oldestPostedEventAge;
+}
+
+/*!
+    Returns the number of posted events that were delivered.
+
+    \sa averagePostedEventLatency()
+*/
+quint64 QEventDispatcherStatistics::deliveredPostedEventCount() const
+{
+    return d->counters.deliveredPostedEvents;
+}
+
+/*!
+    Returns the average time between posting an event and the start of its
+    delivery, or 0 if no posted event was delivered yet.
+
+    \sa maximumPostedEventLatency()
+*/
+qint64 QEventDispatcherStatistics::averagePostedEventLatency() const
+{
+    const quint64 count = d->counters.deliveredPostedEvents;
+    return count ? d->counters.totalPostedEventLatency / qint64(count) : 0;
+}
+
+/*!
+    Returns the longest time between posting an event and the start of its
+    delivery.
+
+    \sa averagePostedEventLatency()
+*/
+qint64 QEventDispatcherStatistics::maximumPostedEventLatency() const
+{
+    return d->counters.maximumPostedEventLatency;
+}
+
+/*!
+    Returns how late timers fired, as a histogram with 12 entries: entry \c i
+    counts the timer events that were sent less than 2\sup{i} milliseconds
+    after the timer expired, and the last entry counts all the later ones.
+    The first entry thus counts the timers that fired on time.
+*/
+QVector<quint64> QEventDispatcherStatistics::timerLatenessHistogram() const
+{
+    QVector<quint64> result(QEventDispatcherStatisticsRecorder::TimerLatenessBuckets);
+    std::copy(d->counters.timerLateness,
+              d->counters.timerLateness + QEventDispatcherStatisticsRecorder::TimerLatenessBuckets,
+              result.begin());
+    return result;
+}
+
+/*!
+    Returns the types of the events that were handled, in increasing order.
+
+    The types starting at QEvent::User are reported together as QEvent::User.
+
+    \sa eventCount()
+*/
+QVector<QEvent::Type> QEventDispatcherStatistics::eventTypes() const
+{
+    QVector<QEvent::Type> result;
+    for (int i = 0; i < QEventDispatcherStatisticsRecorder::EventTypeEntries; ++i) {
+        if (d->counters.eventTypes[i].count)
+            result.append(i < QEventDispatcherStatisticsRecorder::EventTypeEntries - 1
+                          ? QEvent::Type(i) : QEvent::User);
+    }
+    return result;
+}
+
+static const QEventDispatcherStatisticsRecorder::EventTypeCounters &
+eventTypeCounters(const QEventDispatcherStatisticsRecorder::Counters &counters, QEvent::Type type)
+{
+    const int last = QEventDispatcherStatisticsRecorder::EventTypeEntries - 1;
+    return counters.eventTypes[uint(type) < uint(last) ? int(type) : last];
+}
+
+/*!
+    Returns how many events of type \a type were handled, including the
+    ones sent with QCoreApplication::sendEvent().
+
+    All the types starting at QEvent::User are counted together, so passing
+    any of them returns the same number.
+
+    \sa eventHandlingTime()
+*/
+quint64 QEventDispatcherStatistics::eventCount(QEvent::Type type) const
+{
+    return eventTypeCounters(d->counters, type).count;
+}
+
+/*!
+    Returns the total time spent handling events of type \a type, measured
+    around QCoreApplication::notify(). The time spent handling events sent
+    while handling an event is included.
+
+    \sa maximumEventHandlingTime(), eventCount()
+*/
+qint64 QEventDispatcherStatistics::eventHandlingTime(QEvent::Type type) const
+{
+    return eventTypeCounters(d->counters, type).totalTime;
+}
+
+/*!
+    Returns the longest time spent handling a single event of type \a type.
+
+    \sa eventHandlingTime()
+*/
+qint64 QEventDispatcherStatistics::maximumEventHandlingTime(QEvent::Type type) const
+{
+    return eventTypeCounters(d->counters, type).maximumTime;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qabstracteventdispatcher.cpp"
@@ -42,12 +42,54 @@
 
 #include <QtCore/qobject.h>
 #include <QtCore/qeventloop.h>
+#include <QtCore/qcoreevent.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
 class QAbstractNativeEventFilter;
 class QAbstractEventDispatcherPrivate;
 class QSocketNotifier;
+class QEventDispatcherStatisticsPrivate;
+
+class Q_CORE_EXPORT QEventDispatcherStatistics
+{
+public:
+    QEventDispatcherStatistics();
+    QEventDispatcherStatistics(const QEventDispatcherStatistics &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    QEventDispatcherStatistics &operator=(QEventDispatcherStatistics &&other) Q_DECL_NOTHROW
+    { swap(other); return *this; }
+#endif
+    QEventDispatcherStatistics &operator=(const QEventDispatcherStatistics &other);
+    ~QEventDispatcherStatistics();
+
+    void swap(QEventDispatcherStatistics &other) Q_DECL_NOTHROW { d.swap(other.d); }
+
+    quint64 iterations() const;
+    qint64 busyTime() const;
+    qint64 blockedTime() const;
+
+    int postedEventCount() const;
+    qint64 oldestPostedEventAge() const;
+    quint64 deliveredPostedEventCount() const;
+    qint64 averagePostedEventLatency() const;
+    qint64 maximumPostedEventLatency() const;
+
+    QVector<quint64> timerLatenessHistogram() const;
+
+    QVector<QEvent::Type> eventTypes() const;
+    quint64 eventCount(QEvent::Type type) const;
+    qint64 eventHandlingTime(QEvent::Type type) const;
+    qint64 maximumEventHandlingTime(QEvent::Type type) const;
+
+private:
+    friend class QAbstractEventDispatcher;
+    QSharedDataPointer<QEventDispatcherStatisticsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QEventDispatcherStatistics)
 
 #ifdef Q_OS_WIN
 class QWinEventNotifier;
@@ -110,6 +152,9 @@ public:
     void installNativeEventFilter(QAbstractNativeEventFilter *filterObj);
     void removeNativeEventFilter(QAbstractNativeEventFilter *filterObj);
     bool filterNativeEvent(const QByteArray &eventType, void *message, long *result);
+
+    QEventDispatcherStatistics statistics() const;
+
 #if QT_DEPRECATED_SINCE(5, 0)
     QT_DEPRECATED bool filterEvent(void *message)
     { return filterNativeEvent("", message, Q_NULLPTR); }
@@ -52,12 +52,103 @@
 //
 
 #include "QtCore/qabstracteventdispatcher.h"
+#include "QtCore/qdeadlinetimer.h"
 #include "private/qobject_p.h"
 
 QT_BEGIN_NAMESPACE
 
 Q_CORE_EXPORT uint qGlobalPostedEventsCount();
 
+/*
+    Collects the counters behind QAbstractEventDispatcher::statistics().
+
+    Only the thread of the event dispatcher updates them; other threads
+    take a consistent copy with snapshot(). Updates are guarded by a
+    sequence number that is odd while they are in progress, so recording
+    never takes a lock.
+*/
+class QEventDispatcherStatisticsRecorder
+{
+public:
+    enum {
+        // built-in event types are below 256; the last entry counts the others
+        EventTypeEntries = 256,
+        TimerLatenessBuckets = 12
+    };
+
+    struct EventTypeCounters {
+        quint64 count;
+        qint64 totalTime;
+        qint64 maximumTime;
+    };
+
+    struct Counters {
+        quint64 iterations;
+        qint64 busyTime;
+        qint64 blockedTime;
+        quint64 deliveredPostedEvents;
+        qint64 totalPostedEventLatency;
+        qint64 maximumPostedEventLatency;
+        quint64 timerLateness[TimerLatenessBuckets];
+        EventTypeCounters eventTypes[EventTypeEntries];
+    };
+
+    QEventDispatcherStatisticsRecorder();
+
+    // all times are in nanoseconds
+    static qint64 currentTime()
+    { return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs(); }
+
+    // called around each processEvents() call, and around the wait for events
+    void beginIteration();
+    void endIteration();
+    void beginBlocking() { blockingStart = currentTime(); }
+    void endBlocking();
+
+    void recordEvent(int type, qint64 time);
+    void recordPostedEventDelivery(qint64 latency);
+    void recordTimerLateness(qint64 lateness);
+
+    Counters snapshot() const;
+
+private:
+    void beginUpdate();
+    void endUpdate();
+
+    QAtomicInt sequence;
+    int depth;
+    qint64 iterationStart;
+    qint64 blockedAtIterationStart;
+    qint64 blockingStart;
+    Counters counters;
+};
+
+class QScopedEventDispatcherIteration
+{
+public:
+    explicit QScopedEventDispatcherIteration(QEventDispatcherStatisticsRecorder &recorder)
+        : recorder(recorder)
+    { recorder.beginIteration(); }
+    ~QScopedEventDispatcherIteration()
+    { recorder.endIteration(); }
+
+private:
+    Q_DISABLE_COPY(QScopedEventDispatcherIteration)
+    QEventDispatcherStatisticsRecorder &recorder;
+};
+
+class QEventDispatcherStatisticsPrivate : public QSharedData
+{
+public:
+    QEventDispatcherStatisticsPrivate()
+        : counters(), postedEventCount(0), oldestPostedEventAge(0)
+    { }
+
+    QEventDispatcherStatisticsRecorder::Counters counters;
+    int postedEventCount;
+    qint64 oldestPostedEventAge;
+};
+
 class Q_CORE_EXPORT QAbstractEventDispatcherPrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QAbstractEventDispatcher)
@@ -65,7 +156,11 @@ public:
     inline QAbstractEventDispatcherPrivate()
     { }
 
+    static QEventDispatcherStatisticsRecorder *statisticsRecorder(QAbstractEventDispatcher *dispatcher)
+    { return dispatcher ? &dispatcher->d_func()->statistics : Q_NULLPTR; }
+
     QList<QAbstractNativeEventFilter *> eventFilters;
+    QEventDispatcherStatisticsRecorder statistics;
 
     static int allocateTimerId();
     static void releaseTimerId(int id);
@@ -43,6 +43,7 @@
 
 #ifndef QT_NO_QOBJECT
 #include "qabstracteventdispatcher.h"
+#include "qabstracteventdispatcher_p.h"
 #include "qcoreevent.h"
 #include "qeventloop.h"
 #endif
@@ -69,6 +70,7 @@
 #include <private/qfunctions_p.h>
 #include <private/qlocale_p.h>
 #include <private/qhooks_p.h>
+#include <private/qtrace_p.h>
 
 #ifndef QT_NO_QOBJECT
 #if defined(Q_OS_UNIX)
@@ -1013,9 +1015,22 @@ bool QCoreApplication::notifyInternal2(QObject *receiver, QEvent *event)
     QObjectPrivate *d = receiver->d_func();
     QThreadData *threadData = d->threadData;
     QScopedScopeLevelCounter scopeLevelCounter(threadData);
-    if (!selfRequired)
-        return doNotify(receiver, event);
-    return self->notify(receiver, event);
+
+    // the event may be deleted or the dispatcher replaced while it is
+    // being handled, so remember both the type and the dispatcher
+    QAbstractEventDispatcher *dispatcher = threadData->eventDispatcher.load();
+    const int type = event->type();
+    const qint64 start = dispatcher ? QEventDispatcherStatisticsRecorder::currentTime() : 0;
+
+    Q_TRACE(QCoreApplication_notify_entry, receiver, event, type);
+    const bool consumed = selfRequired ? self->notify(receiver, event) : doNotify(receiver, event);
+    Q_TRACE(QCoreApplication_notify_exit, consumed);
+
+    if (dispatcher && dispatcher == threadData->eventDispatcher.load()) {
+        QAbstractEventDispatcherPrivate::statisticsRecorder(dispatcher)->recordEvent(
+                    type, QEventDispatcherStatisticsRecorder::currentTime() - start);
+    }
+    return consumed;
 }
 
 /*!
@@ -1395,6 +1410,8 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
         return;
     }
 
+    Q_TRACE(QCoreApplication_postEvent, receiver, event, event->type());
+
     QThreadData * volatile * pdata = &receiver->d_func()->threadData;
     QThreadData *data = *pdata;
     if (!data) {
@@ -1425,6 +1442,7 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
     // if this is one of the compressible events, do compression
     if (receiver->d_func()->postedEvents
         && self && self->compressEvent(event, receiver, &data->postEventList)) {
+        Q_TRACE(QCoreApplication_postEvent_event_compressed, receiver, event);
         return;
     }
 
@@ -1453,7 +1471,8 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
     // delete the event on exceptions to protect against memory leaks till the event is
     // properly owned in the postEventList
     QScopedPointer<QEvent> eventDeleter(event);
-    data->postEventList.addEvent(QPostEvent(receiver, event, priority));
+    data->postEventList.addEvent(QPostEvent(receiver, event, priority,
+                                            QEventDispatcherStatisticsRecorder::currentTime()));
     eventDeleter.take();
     event->posted = true;
     ++receiver->d_func()->postedEvents;
@@ -1561,6 +1580,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
     }
 
     data->canWait = true;
+    Q_TRACE(QCoreApplication_sendPostedEvents_entry, receiver, event_type);
 
     // okay. here is the tricky loop. be careful about optimizing
     // this, it looks the way it does for good reasons.
@@ -1598,6 +1618,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
                 Q_ASSERT(data->postEventList.insertionOffset >= 0);
                 data->postEventList.startOffset = 0;
             }
+            Q_TRACE(QCoreApplication_sendPostedEvents_exit);
         }
     };
     CleanUp cleanup(receiver, event_type, data);
@@ -1656,6 +1677,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
         pe.event->posted = false;
         QEvent *e = pe.event;
         QObject * r = pe.receiver;
+        const qint64 postTime = pe.postTime;
 
         --r->d_func()->postedEvents;
         Q_ASSERT(r->d_func()->postedEvents >= 0);
@@ -1674,6 +1696,11 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
 
         QScopedPointer<QEvent> event_deleter(e); // will delete the event (with the mutex unlocked)
 
+        if (QEventDispatcherStatisticsRecorder *statistics =
+                QAbstractEventDispatcherPrivate::statisticsRecorder(data->eventDispatcher.load())) {
+            statistics->recordPostedEventDelivery(QEventDispatcherStatisticsRecorder::currentTime() - postTime);
+        }
+
         // after all that work, it's time to deliver the event.
         QCoreApplication::sendEvent(r, e);
 
@@ -253,19 +253,25 @@ static gboolean postEventSourcePrepare(GSource *s, gint *timeout)
     if (!data)
         return false;
 
+    GPostEventSource *source = reinterpret_cast<GPostEventSource *>(s);
+
+    // glib polls between prepare and check; that is the time we spend blocked
+    if (timeout)
+        source->d->statistics.beginBlocking();
+
     gint dummy;
     if (!timeout)
         timeout = &dummy;
     const bool canWait = data->canWaitLocked();
     *timeout = canWait ? -1 : 0;
 
-    GPostEventSource *source = reinterpret_cast<GPostEventSource *>(s);
     return (!canWait
             || (source->serialNumber.load() != source->lastSerialNumber));
 }
 
 static gboolean postEventSourceCheck(GSource *source)
 {
+    reinterpret_cast<GPostEventSource *>(source)->d->statistics.endBlocking();
     return postEventSourcePrepare(source, 0);
 }
 
@@ -336,6 +342,7 @@ QEventDispatcherGlibPrivate::QEventDispatcherGlibPrivate(GMainContext *context)
     timerSource = reinterpret_cast<GTimerSource *>(g_source_new(&timerSourceFuncs,
                                                                 sizeof(GTimerSource)));
     (void) new (&timerSource->timerList) QTimerInfoList();
+    timerSource->timerList.statistics = &statistics;
     timerSource->processEventsFlags = QEventLoop::AllEvents;
     timerSource->runWithIdlePriority = false;
     g_source_set_can_recurse(&timerSource->source, true);
@@ -404,6 +411,7 @@ QEventDispatcherGlib::~QEventDispatcherGlib()
 bool QEventDispatcherGlib::processEvents(QEventLoop::ProcessEventsFlags flags)
 {
     Q_D(QEventDispatcherGlib);
+    QScopedEventDispatcherIteration iteration(d->statistics);
 
     const bool canWait = (flags & QEventLoop::WaitForMoreEvents);
     if (canWait)
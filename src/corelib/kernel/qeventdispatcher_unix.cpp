@@ -226,6 +226,7 @@ QEventDispatcherUNIXPrivate::QEventDispatcherUNIXPrivate()
 {
     if (Q_UNLIKELY(threadPipe.init() == false))
         qFatal("QEventDispatcherUNIXPrivate(): Can not continue without a thread pipe");
+    timerList.statistics = &statistics;
 }
 
 QEventDispatcherUNIXPrivate::~QEventDispatcherUNIXPrivate()
@@ -459,6 +460,7 @@ void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
 bool QEventDispatcherUNIX::processEvents(QEventLoop::ProcessEventsFlags flags)
 {
     Q_D(QEventDispatcherUNIX);
+    QScopedEventDispatcherIteration iteration(d->statistics);
     d->interrupt.store(0);
 
     // we are awake, broadcast it
@@ -497,7 +499,11 @@ bool QEventDispatcherUNIX::processEvents(QEventLoop::ProcessEventsFlags flags)
 
     int nevents = 0;
 
-    switch (qt_safe_poll(d->pollfds.data(), d->pollfds.size(), tm)) {
+    d->statistics.beginBlocking();
+    const int pollResult = qt_safe_poll(d->pollfds.data(), d->pollfds.size(), tm);
+    d->statistics.endBlocking();
+
+    switch (pollResult) {
     case -1:
         perror("qt_safe_poll");
         break;
@@ -523,6 +523,7 @@ QEventDispatcherWin32::~QEventDispatcherWin32()
 bool QEventDispatcherWin32::processEvents(QEventLoop::ProcessEventsFlags flags)
 {
     Q_D(QEventDispatcherWin32);
+    QScopedEventDispatcherIteration iteration(d->statistics);
 
     if (!d->internalHwnd) {
         createInternalHwnd();
@@ -646,7 +647,9 @@ bool QEventDispatcherWin32::processEvents(QEventLoop::ProcessEventsFlags flags)
                 pHandles[i] = d->winEventNotifierList.at(i)->handle();
 
             emit aboutToBlock();
+            d->statistics.beginBlocking();
             waitRet = MsgWaitForMultipleObjectsEx(nCount, pHandles, INFINITE, QS_ALLINPUT, MWMO_ALERTABLE | MWMO_INPUTAVAILABLE);
+            d->statistics.endBlocking();
             emit awake();
             if (waitRet - WAIT_OBJECT_0 < nCount) {
                 d->activateEventNotifier(d->winEventNotifierList.at(waitRet - WAIT_OBJECT_0));
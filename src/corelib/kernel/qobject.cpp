@@ -62,6 +62,7 @@
 
 #include <private/qorderedmutexlocker_p.h>
 #include <private/qhooks_p.h>
+#include <private/qtrace_p.h>
 
 #include <new>
 
@@ -3657,6 +3658,8 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                                                          argv ? argv : empty_argv);
     }
 
+    Q_TRACE(QMetaObject_activate_entry, sender, signal_index);
+
     {
     QMutexLocker locker(signalSlotLock(sender));
     struct ConnectionListsRef {
@@ -3686,6 +3689,7 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
         locker.unlock();
         if (qt_signal_spy_callback_set.signal_end_callback != 0)
             qt_signal_spy_callback_set.signal_end_callback(sender, signal_index);
+        Q_TRACE(QMetaObject_activate_exit);
         return;
     }
 
@@ -3746,7 +3750,9 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                 c->slotObj->ref();
                 QScopedPointer<QtPrivate::QSlotObjectBase, QSlotObjectBaseDeleter> obj(c->slotObj);
                 locker.unlock();
+                Q_TRACE(QMetaObject_activate_slot_entry, receiver, -1);
                 obj->call(receiver, argv ? argv : empty_argv);
+                Q_TRACE(QMetaObject_activate_slot_exit);
 
                 // Make sure the slot object gets destroyed before the mutex is locked again, as the
                 // destructor of the slot object might also lock a mutex from the signalSlotLock() mutex pool,
@@ -3763,7 +3769,9 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                 if (qt_signal_spy_callback_set.slot_begin_callback != 0)
                     qt_signal_spy_callback_set.slot_begin_callback(receiver, methodIndex, argv ? argv : empty_argv);
 
+                Q_TRACE(QMetaObject_activate_slot_entry, receiver, methodIndex);
                 callFunction(receiver, QMetaObject::InvokeMetaMethod, method_relative, argv ? argv : empty_argv);
+                Q_TRACE(QMetaObject_activate_slot_exit);
 
                 if (qt_signal_spy_callback_set.slot_end_callback != 0)
                     qt_signal_spy_callback_set.slot_end_callback(receiver, methodIndex);
@@ -3778,7 +3786,9 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                                                                 argv ? argv : empty_argv);
                 }
 
+                Q_TRACE(QMetaObject_activate_slot_entry, receiver, method);
                 metacall(receiver, QMetaObject::InvokeMetaMethod, method, argv ? argv : empty_argv);
+                Q_TRACE(QMetaObject_activate_slot_exit);
 
                 if (qt_signal_spy_callback_set.slot_end_callback != 0)
                     qt_signal_spy_callback_set.slot_end_callback(receiver, method);
@@ -3801,6 +3811,7 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
     if (qt_signal_spy_callback_set.signal_end_callback != 0)
         qt_signal_spy_callback_set.signal_end_callback(sender, signal_index);
 
+    Q_TRACE(QMetaObject_activate_exit);
 }
 
 /*!
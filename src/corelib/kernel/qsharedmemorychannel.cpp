@@ -0,0 +1,1008 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qsharedmemorychannel.h"
+
+#include "qelapsedtimer.h"
+#include "qmath.h"
+#include "qsemaphore.h"
+#include "qsharedmemory.h"
+#include "qsocketnotifier.h"
+#include "qthread.h"
+#include <private/qcore_unix_p.h>
+#include <private/qobject_p.h>
+#include <private/qthread_p.h>
+
+#include <atomic>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+QT_BEGIN_NAMESPACE
+
+#ifndef QT_NO_SHAREDMEMORY
+
+/*
+    Layout of the shared memory segment: a ChannelHeader, followed by the
+    ring of capacity bytes. Each message in the ring is a RecordHeader
+    followed by the payload, padded to a multiple of 8 bytes. A record
+    that would wrap around the end of the ring is preceded by a padding
+    record covering the rest of the ring.
+
+    Senders reserve space by advancing head (with a compare-and-swap if
+    there can be several of them), write the record, and publish it by
+    storing its length with release semantics. The receiver consumes the
+    record at tail once its length is non-zero, clears it, and advances
+    tail. The ring is only ever accessed through these atomics; no lock is
+    taken after the channel has been set up.
+
+    messageSeq and spaceSeq are futex words: they are bumped after a
+    record has been published or consumed. A side about to sleep sets the
+    matching sleeping flag; the other side only makes a system call to wake
+    it if it finds the flag set, and clears it, so that a sleeper costs one
+    wakeup and not one per message.
+*/
+namespace {
+enum { ChannelMagic = 0x434d5351, ChannelVersion = 1, CacheLineSize = 64, SpinCount = 200 };
+
+struct ChannelHeader
+{
+    // constant after create(), except for the two counters
+    QBasicAtomicInt magic;
+    quint32 version;
+    quint32 mode;
+    quint32 capacity;
+    QBasicAtomicInt senders;
+    QBasicAtomicInt receiverClosed;
+    char padding0[CacheLineSize - 6 * sizeof(int)];
+
+    QBasicAtomicInteger<quint64> head;
+    char padding1[CacheLineSize - sizeof(quint64)];
+
+    QBasicAtomicInteger<quint64> tail;
+    char padding2[CacheLineSize - sizeof(quint64)];
+
+    QBasicAtomicInt messageSeq;
+    QBasicAtomicInt receiverSleeping;
+    char padding3[CacheLineSize - 2 * sizeof(int)];
+
+    QBasicAtomicInt spaceSeq;
+    QBasicAtomicInt sendersSleeping;
+    char padding4[CacheLineSize - 2 * sizeof(int)];
+};
+Q_STATIC_ASSERT(sizeof(ChannelHeader) == 5 * CacheLineSize);
+// Other processes use head and tail too; atomics that are not lock-free
+// are protected by a lock private to each process.
+Q_STATIC_ASSERT(QAtomicOpsSupport<8>::IsSupported);
+Q_STATIC_ASSERT_X(ATOMIC_LLONG_LOCK_FREE == 2, "QSharedMemoryChannel needs lock-free 64-bit atomics");
+
+struct RecordHeader
+{
+    QBasicAtomicInt length;     // of the whole record; 0 until published
+    int size;                   // of the payload; -1 for padding
+};
+Q_STATIC_ASSERT(sizeof(RecordHeader) == 8);
+
+static inline quint64 recordLength(int size)
+{
+    return (sizeof(RecordHeader) + quint64(size) + 7) & ~Q_UINT64_C(7);
+}
+
+static inline int futexWait(QBasicAtomicInt *futex, int expectedValue, int msecs)
+{
+    struct timespec ts;
+    struct timespec *pts = 0;
+    if (msecs >= 0) {
+        ts.tv_sec = msecs / 1000;
+        ts.tv_nsec = (msecs % 1000) * 1000 * 1000;
+        pts = &ts;
+    }
+    // the futex lives in memory shared with other processes, so it must
+    // not be FUTEX_PRIVATE_FLAG
+    return syscall(__NR_futex, reinterpret_cast<int *>(futex), FUTEX_WAIT,
+                   expectedValue, pts, 0, 0);
+}
+
+static inline void futexWakeAll(QBasicAtomicInt *futex)
+{
+    syscall(__NR_futex, reinterpret_cast<int *>(futex), FUTEX_WAKE, INT_MAX, 0, 0, 0);
+}
+
+// called after publishing or consuming a record
+static inline void notify(QBasicAtomicInt &sequence, QBasicAtomicInt &sleeping)
+{
+    sequence.fetchAndAddOrdered(1);
+    if (sleeping.loadAcquire() && sleeping.fetchAndStoreOrdered(0))
+        futexWakeAll(&sequence);
+}
+
+static bool canSpin()
+{
+    // spinning only helps if the other side can run at the same time
+    static const bool multipleCpus = QThread::idealThreadCount() > 1;
+    return multipleCpus;
+}
+
+/*
+    Blocks until condition() returns true or msecs have passed, sleeping on
+    the futex sequence. Setting sleeping and then checking condition() is
+    ordered against the other side's publish-then-notify(), so that a
+    wakeup cannot be lost.
+*/
+template <typename Condition>
+static bool waitForCondition(QBasicAtomicInt &sequence, QBasicAtomicInt &sleeping,
+                             int msecs, Condition condition)
+{
+    // the other side is often only moments away from making progress;
+    // polling the ring briefly is cheaper than a futex round trip
+    if (canSpin()) {
+        for (int i = 0; i < SpinCount; ++i) {
+            if (condition())
+                return true;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        sleeping.fetchAndStoreOrdered(1);
+        const int value = sequence.loadAcquire();
+        bool done = condition();
+        if (!done) {
+            const int timeout = msecs < 0 ? -1 : qMax(0, msecs - int(timer.elapsed()));
+            if (timeout != 0)
+                futexWait(&sequence, value, timeout);
+            done = condition();
+        }
+        if (done)
+            return true;
+        if (msecs >= 0 && timer.elapsed() >= msecs)
+            return false;
+    }
+}
+
+/*
+    Turns new messages into activity on an eventfd that the receiver's
+    event loop watches. After each notification the thread waits to be
+    re-armed by the receiver, so that senders do not pay for a wakeup per
+    message while the receiver is busy.
+*/
+class QSharedMemoryChannelWaiter : public QThread
+{
+public:
+    QSharedMemoryChannelWaiter(ChannelHeader *header, int eventFd)
+        : header(header), eventFd(eventFd), armed(1)
+    {
+        stopping.store(0);
+    }
+
+    void stop()
+    {
+        stopping.storeRelease(1);
+        armed.release();
+        header->receiverSleeping.storeRelease(1);
+        notify(header->messageSeq, header->receiverSleeping);
+        wait();
+    }
+
+    void run() Q_DECL_OVERRIDE;
+
+    ChannelHeader *header;
+    int eventFd;
+    QSemaphore armed;
+    QAtomicInt stopping;
+};
+
+void QSharedMemoryChannelWaiter::run()
+{
+    int seen = 0;
+    forever {
+        armed.acquire();
+        if (stopping.loadAcquire())
+            return;
+
+        forever {
+            header->receiverSleeping.fetchAndStoreOrdered(1);
+            int value = header->messageSeq.loadAcquire();
+            if (value == seen && !stopping.loadAcquire())
+                futexWait(&header->messageSeq, value, -1);
+            value = header->messageSeq.loadAcquire();
+            if (stopping.loadAcquire())
+                return;
+            if (value != seen) {
+                seen = value;
+                break;
+            }
+        }
+
+        const quint64 one = 1;
+        qt_safe_write(eventFd, &one, sizeof one);
+    }
+}
+} // unnamed namespace
+
+class QSharedMemoryChannelPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QSharedMemoryChannel)
+public:
+    QSharedMemoryChannelPrivate()
+        : header(0), ring(0), mask(0), receiver(false),
+          eventFd(-1), notifier(0), waiter(0),
+          corrupted(false), error(QSharedMemoryChannel::NoError)
+    {
+    }
+
+    RecordHeader *recordAt(quint64 position) const
+    { return reinterpret_cast<RecordHeader *>(ring + (position & mask)); }
+
+    bool setup(const char *function);
+    void setError(QSharedMemoryChannel::ChannelError e, const QString &message);
+    void setErrorFromMemory(const char *function);
+    bool checkAttached(bool asReceiver, const char *function);
+
+    bool reserve(quint64 length, quint64 *position, quint64 *padding);
+    bool hasSpace(quint64 length) const;
+    RecordHeader *nextRecord(const char *function, int *size = 0, quint64 *length = 0);
+    void releaseRecord(RecordHeader *record, quint64 length);
+
+    void startNotifier();
+    void stopNotifier();
+
+    // private slot
+    void _q_notified();
+
+    QSharedMemory memory;
+    ChannelHeader *header;
+    char *ring;
+    quint64 mask;
+    bool receiver;
+
+    int eventFd;
+    QSocketNotifier *notifier;
+    QSharedMemoryChannelWaiter *waiter;
+
+    // set once an invalid record was found; nothing is consumed after that
+    bool corrupted;
+    QSharedMemoryChannel::ChannelError error;
+    QString errorString;
+};
+
+void QSharedMemoryChannelPrivate::setError(QSharedMemoryChannel::ChannelError e,
+                                           const QString &message)
+{
+    error = e;
+    errorString = message;
+}
+
+void QSharedMemoryChannelPrivate::setErrorFromMemory(const char *function)
+{
+    QSharedMemoryChannel::ChannelError e;
+    switch (memory.error()) {
+    case QSharedMemory::NoError:
+        e = QSharedMemoryChannel::NoError;
+        break;
+    case QSharedMemory::PermissionDenied:
+        e = QSharedMemoryChannel::PermissionDenied;
+        break;
+    case QSharedMemory::InvalidSize:
+        e = QSharedMemoryChannel::InvalidSize;
+        break;
+    case QSharedMemory::KeyError:
+        e = QSharedMemoryChannel::KeyError;
+        break;
+    case QSharedMemory::AlreadyExists:
+        e = QSharedMemoryChannel::AlreadyExists;
+        break;
+    case QSharedMemory::NotFound:
+        e = QSharedMemoryChannel::NotFound;
+        break;
+    case QSharedMemory::OutOfResources:
+        e = QSharedMemoryChannel::OutOfResources;
+        break;
+    default:
+        e = QSharedMemoryChannel::UnknownError;
+        break;
+    }
+    QString message = memory.errorString();
+    const int colon = message.indexOf(QLatin1String(": "));
+    if (colon >= 0)
+        message = message.mid(colon + 2);
+    setError(e, QLatin1String(function) + QLatin1String(": ") + message);
+}
+
+bool QSharedMemoryChannelPrivate::checkAttached(bool asReceiver, const char *function)
+{
+    if (header && receiver == asReceiver)
+        return true;
+    setError(QSharedMemoryChannel::UnknownError,
+             asReceiver
+             ? QSharedMemoryChannel::tr("%1: not attached as the receiver").arg(QLatin1String(function))
+             : QSharedMemoryChannel::tr("%1: not attached as a sender").arg(QLatin1String(function)));
+    return false;
+}
+
+bool QSharedMemoryChannelPrivate::setup(const char *function)
+{
+    ChannelHeader *h = static_cast<ChannelHeader *>(memory.data());
+    if (memory.size() < int(sizeof(ChannelHeader))
+            || h->magic.loadAcquire() != ChannelMagic
+            || h->version != ChannelVersion
+            || h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0
+            || quint64(memory.size()) < sizeof(ChannelHeader) + h->capacity) {
+        memory.detach();
+        setError(QSharedMemoryChannel::IncompatibleChannel,
+                 QSharedMemoryChannel::tr("%1: the segment is not a compatible channel")
+                 .arg(QLatin1String(function)));
+        return false;
+    }
+
+    header = h;
+    ring = static_cast<char *>(memory.data()) + sizeof(ChannelHeader);
+    mask = h->capacity - 1;
+    corrupted = false;
+    return true;
+}
+
+bool QSharedMemoryChannelPrivate::reserve(quint64 length, quint64 *position, quint64 *padding)
+{
+    const quint64 capacity = mask + 1;
+    quint64 head = header->head.loadAcquire();
+    forever {
+        const quint64 tail = header->tail.loadAcquire();
+        const quint64 offset = head & mask;
+        const quint64 pad = offset + length > capacity ? capacity - offset : 0;
+        if (head + pad + length - tail > capacity)
+            return false;
+
+        if (header->mode == QSharedMemoryChannel::SingleSender) {
+            header->head.storeRelease(head + pad + length);
+        } else if (!header->head.testAndSetOrdered(head, head + pad + length, head)) {
+            continue;
+        }
+        *position = head;
+        *padding = pad;
+        return true;
+    }
+}
+
+bool QSharedMemoryChannelPrivate::hasSpace(quint64 length) const
+{
+    const quint64 capacity = mask + 1;
+    const quint64 head = header->head.loadAcquire();
+    const quint64 tail = header->tail.loadAcquire();
+    const quint64 offset = head & mask;
+    const quint64 pad = offset + length > capacity ? capacity - offset : 0;
+    return head + pad + length - tail <= capacity;
+}
+
+/*
+    Returns the record at tail, or 0 if there is none, skipping padding.
+    The length and size of a record are written by other processes, so they
+    are read once, checked against the ring and passed on through size and
+    length; a record that does not fit sets an error and stops the receiver
+    from consuming anything further.
+*/
+RecordHeader *QSharedMemoryChannelPrivate::nextRecord(const char *function, int *size,
+                                                     quint64 *length)
+{
+    if (corrupted)
+        return 0;
+    forever {
+        const quint64 offset = header->tail.load() & mask;
+        RecordHeader *record = recordAt(offset);
+        const int recordLength = record->length.loadAcquire();
+        if (recordLength == 0)
+            return 0;
+        const int recordSize = record->size;
+        const quint64 room = mask + 1 - offset;
+        const bool padding = recordSize == -1;
+        if (recordLength < int(sizeof(RecordHeader)) || (recordLength & 7) != 0
+                || quint64(recordLength) > room
+                || (padding ? quint64(recordLength) != room
+                            : recordSize < 0 || recordSize > recordLength - int(sizeof(RecordHeader)))) {
+            corrupted = true;
+            setError(QSharedMemoryChannel::CorruptedChannel,
+                     QSharedMemoryChannel::tr("%1: the channel contains an invalid message")
+                     .arg(QLatin1String(function)));
+            return 0;
+        }
+        if (!padding) {
+            if (size)
+                *size = recordSize;
+            if (length)
+                *length = quint64(recordLength);
+            return record;
+        }
+        releaseRecord(record, quint64(recordLength));  // up to the end of the ring
+    }
+}
+
+void QSharedMemoryChannelPrivate::releaseRecord(RecordHeader *record, quint64 length)
+{
+    // only the receiver writes tail
+    memset(record, 0, length);
+    header->tail.storeRelease(header->tail.load() + length);
+
+    notify(header->spaceSeq, header->sendersSleeping);
+}
+
+void QSharedMemoryChannelPrivate::startNotifier()
+{
+    Q_Q(QSharedMemoryChannel);
+    if (!threadData->hasEventDispatcher())
+        return;
+
+    eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (eventFd == -1) {
+        qErrnoWarning("QSharedMemoryChannel: Cannot create eventfd");
+        return;
+    }
+    notifier = new QSocketNotifier(eventFd, QSocketNotifier::Read, q);
+    QObject::connect(notifier, SIGNAL(activated(int)), q, SLOT(_q_notified()));
+
+    waiter = new QSharedMemoryChannelWaiter(header, eventFd);
+    waiter->start();
+}
+
+void QSharedMemoryChannelPrivate::stopNotifier()
+{
+    if (waiter) {
+        waiter->stop();
+        delete waiter;
+        waiter = 0;
+    }
+    delete notifier;
+    notifier = 0;
+    if (eventFd != -1) {
+        qt_safe_close(eventFd);
+        eventFd = -1;
+    }
+}
+
+void QSharedMemoryChannelPrivate::_q_notified()
+{
+    Q_Q(QSharedMemoryChannel);
+    quint64 value;
+    qt_safe_read(eventFd, &value, sizeof value);
+    if (waiter)
+        waiter->armed.release();
+    if (header && nextRecord("QSharedMemoryChannel"))
+        emit q->messageAvailable();
+}
+
+/*!
+  \class QSharedMemoryChannel
+  \inmodule QtCore
+  \since 5.10
+
+  \brief The QSharedMemoryChannel class passes messages between processes
+  through a ring buffer in shared memory.
+
+  QSharedMemoryChannel is meant for high message rates between processes
+  on the same host. Messages are copied once into a QSharedMemory segment
+  by the sender and once out of it by the receiver; in between, no system
+  call is made unless one side has to sleep.
+
+  A channel has exactly one receiver, which creates it with create(), and
+  one or more senders, which attach to it with attach() using the same
+  key:
+
+  \snippet code/src_corelib_kernel_qsharedmemorychannel.cpp 0
+
+  The mode passed to create() decides how many senders may attach. With
+  \l SingleSender, the sender reserves space in the ring with plain
+  stores; with \l MultipleSenders, senders reserve space with an atomic
+  compare-and-swap and messages from different senders may interleave,
+  while the messages of each sender stay in order.
+
+  send() copies a message into the ring. If the ring is full it fails
+  with \l ChannelFull, or waits for the receiver to make room if a timeout
+  is given. The largest message that can be sent is a little less than
+  half of capacity().
+
+  In the receiving thread, messageAvailable() is emitted when new messages
+  arrive, and they are read with receive(). Like readyRead() for a
+  QIODevice, the signal is not emitted again for messages that were
+  already pending, so all available messages should be read in the slot.
+  Without an event loop, waitForMessage() blocks until a message arrives.
+
+  Sleeping and waking up use futexes on the shared segment. The receiver
+  has a helper thread that sleeps while the ring is empty and signals the
+  event loop through an eventfd, so the event loop does not poll the
+  ring.
+
+  \note QSharedMemoryChannel is currently only available on Linux.
+
+  \note The shared ring is not protected against misbehaving processes. A
+  sender that dies while writing a message can block the channel, and
+  the number of senders of a \l SingleSender channel is not reset if the
+  sender crashes. The receiver checks that every message lies within the
+  ring before reading it; if one does not, it sets \l CorruptedChannel
+  and stops receiving.
+
+  \sa QSharedMemory
+*/
+
+/*!
+  \enum QSharedMemoryChannel::Mode
+
+  \value SingleSender Only one sender can be attached at a time.
+  \value MultipleSenders Any number of senders can be attached.
+*/
+
+/*!
+  \enum QSharedMemoryChannel::ChannelError
+
+  \value NoError No error occurred.
+  \value PermissionDenied The operation failed because the caller didn't
+  have the required permissions.
+  \value InvalidSize A create operation failed because the requested
+  capacity was invalid.
+  \value KeyError The operation failed because of an invalid key.
+  \value AlreadyExists A create() operation failed because a segment with
+  the specified key already existed, or attach() failed because a
+  \l SingleSender channel already has a sender.
+  \value NotFound An attach() failed because a channel with the specified
+  key could not be found.
+  \value OutOfResources The operation failed because there was not enough
+  memory available.
+  \value IncompatibleChannel An attach() failed because the segment with
+  the specified key is not a channel, or was created by an incompatible
+  version of Qt.
+  \value ChannelFull A send() failed because there was no room for the
+  message in the ring.
+  \value MessageTooLarge A send() failed because the message can never fit
+  in the ring, or receive() failed because the buffer was too small.
+  \value ChannelClosed A send() or attach() failed because the receiver has
+  detached.
+  \value CorruptedChannel The receiver found a message whose length or size
+  does not fit in the ring. Nothing more is received from the channel
+  until it is created again.
+  \value UnknownError Something else happened.
+*/
+
+/*!
+  Constructs a channel object with the given \a parent. Call setKey()
+  before create() or attach().
+*/
+QSharedMemoryChannel::QSharedMemoryChannel(QObject *parent)
+    : QObject(*new QSharedMemoryChannelPrivate, parent)
+{
+}
+
+/*!
+  Constructs a channel object with the given \a parent and with its key
+  set to \a key.
+*/
+QSharedMemoryChannel::QSharedMemoryChannel(const QString &key, QObject *parent)
+    : QObject(*new QSharedMemoryChannelPrivate, parent)
+{
+    setKey(key);
+}
+
+/*!
+  Destroys the channel object, detaching from the channel.
+
+  \sa detach()
+*/
+QSharedMemoryChannel::~QSharedMemoryChannel()
+{
+    detach();
+}
+
+/*!
+  Sets the key of the channel to \a key, detaching from the current
+  channel first. The key is used as the key of the underlying
+  QSharedMemory segment.
+*/
+void QSharedMemoryChannel::setKey(const QString &key)
+{
+    Q_D(QSharedMemoryChannel);
+    if (key == d->memory.key())
+        return;
+    detach();
+    d->memory.setKey(key);
+}
+
+/*!
+  Returns the key of the channel.
+*/
+QString QSharedMemoryChannel::key() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->memory.key();
+}
+
+/*!
+  Creates the channel with a ring of at least \a capacity bytes, and
+  attaches to it as its receiver. \a mode decides how many senders may
+  attach. The capacity is rounded up to a power of two and must be
+  between 256 bytes and 1 GB.
+
+  Returns \c true if the channel was created; otherwise sets error() and
+  returns \c false.
+*/
+bool QSharedMemoryChannel::create(int capacity, Mode mode)
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::create";
+    if (d->header) {
+        d->setError(AlreadyExists, tr("%1: already attached").arg(QLatin1String(function)));
+        return false;
+    }
+    if (capacity < 256 || capacity > (1 << 30)) {
+        d->setError(InvalidSize, tr("%1: capacity must be between 256 bytes and 1 GB")
+                    .arg(QLatin1String(function)));
+        return false;
+    }
+
+    const quint32 ringSize = qNextPowerOfTwo(quint32(capacity - 1));
+    if (!d->memory.create(int(sizeof(ChannelHeader) + ringSize))) {
+        d->setErrorFromMemory(function);
+        return false;
+    }
+
+    ChannelHeader *h = static_cast<ChannelHeader *>(d->memory.data());
+    memset(h, 0, sizeof(ChannelHeader) + ringSize);
+    h->version = ChannelVersion;
+    h->mode = mode;
+    h->capacity = ringSize;
+    h->magic.storeRelease(ChannelMagic);
+
+    if (!d->setup(function))
+        return false;
+    d->receiver = true;
+    d->startNotifier();
+    d->setError(NoError, QString());
+    return true;
+}
+
+/*!
+  Attaches to the channel identified by key() as a sender.
+
+  Returns \c true if attached; otherwise sets error() and returns
+  \c false.
+*/
+bool QSharedMemoryChannel::attach()
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::attach";
+    if (d->header) {
+        d->setError(AlreadyExists, tr("%1: already attached").arg(QLatin1String(function)));
+        return false;
+    }
+    if (!d->memory.attach()) {
+        d->setErrorFromMemory(function);
+        return false;
+    }
+    if (!d->setup(function))
+        return false;
+
+    ChannelHeader *h = d->header;
+    if (h->receiverClosed.loadAcquire()) {
+        d->setError(ChannelClosed, tr("%1: the receiver has detached").arg(QLatin1String(function)));
+    } else if (h->mode == SingleSender && !h->senders.testAndSetOrdered(0, 1)) {
+        d->setError(AlreadyExists, tr("%1: the channel already has a sender")
+                    .arg(QLatin1String(function)));
+    } else {
+        if (h->mode != SingleSender)
+            h->senders.fetchAndAddOrdered(1);
+        d->receiver = false;
+        d->setError(NoError, QString());
+        return true;
+    }
+
+    d->header = 0;
+    d->memory.detach();
+    return false;
+}
+
+/*!
+  Returns \c true if this object is attached to a channel, either as the
+  receiver or as a sender.
+*/
+bool QSharedMemoryChannel::isAttached() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header != 0;
+}
+
+/*!
+  Returns \c true if this object created the channel and receives its
+  messages.
+*/
+bool QSharedMemoryChannel::isReceiver() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header && d->receiver;
+}
+
+/*!
+  Detaches from the channel. If this object is the receiver, senders
+  can no longer send messages, and the segment is destroyed once the last
+  sender has detached as well.
+
+  Returns \c false if this object was not attached.
+*/
+bool QSharedMemoryChannel::detach()
+{
+    Q_D(QSharedMemoryChannel);
+    if (!d->header)
+        return false;
+
+    if (d->receiver) {
+        d->stopNotifier();
+        d->header->receiverClosed.storeRelease(1);
+        d->header->sendersSleeping.storeRelease(1);
+        notify(d->header->spaceSeq, d->header->sendersSleeping);
+    } else {
+        d->header->senders.fetchAndAddOrdered(-1);
+    }
+    d->header = 0;
+    d->ring = 0;
+    d->mask = 0;
+    d->receiver = false;
+    return d->memory.detach();
+}
+
+/*!
+  Returns the mode the channel was created with.
+*/
+QSharedMemoryChannel::Mode QSharedMemoryChannel::mode() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header ? Mode(d->header->mode) : MultipleSenders;
+}
+
+/*!
+  Returns the size of the ring in bytes, or 0 if not attached.
+*/
+int QSharedMemoryChannel::capacity() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->header ? int(d->mask + 1) : 0;
+}
+
+/*!
+  \fn bool QSharedMemoryChannel::send(const QByteArray &message, int msecs)
+  \overload
+*/
+
+/*!
+  Sends the message of \a size bytes starting at \a data. If there is no
+  room for it in the ring, waits up to \a msecs milliseconds for the
+  receiver to make room; by default it does not wait. If \a msecs is -1,
+  this function will not time out.
+
+  Returns \c true if the message was sent; otherwise sets error() and
+  returns \c false. This function can only be called by a sender.
+*/
+bool QSharedMemoryChannel::send(const char *data, int size, int msecs)
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::send";
+    if (!d->checkAttached(false, function))
+        return false;
+
+    const quint64 length = recordLength(size);
+    if (size < 0 || length > (d->mask + 1) / 2) {
+        d->setError(MessageTooLarge, tr("%1: message does not fit in the channel")
+                    .arg(QLatin1String(function)));
+        return false;
+    }
+
+    ChannelHeader *h = d->header;
+    QElapsedTimer timer;
+    quint64 position;
+    quint64 padding;
+    forever {
+        if (h->receiverClosed.loadAcquire()) {
+            d->setError(ChannelClosed, tr("%1: the receiver has detached")
+                        .arg(QLatin1String(function)));
+            return false;
+        }
+        if (d->reserve(length, &position, &padding))
+            break;
+
+        if (msecs != 0 && !timer.isValid())
+            timer.start();
+        const int timeout = msecs <= 0 ? msecs : qMax(0, msecs - int(timer.elapsed()));
+        if (timeout == 0 || !waitForCondition(h->spaceSeq, h->sendersSleeping, timeout, [d, h, length]() {
+                    return h->receiverClosed.loadAcquire() || d->hasSpace(length);
+                })) {
+            d->setError(ChannelFull, tr("%1: the channel is full").arg(QLatin1String(function)));
+            return false;
+        }
+    }
+
+    if (padding) {
+        RecordHeader *record = d->recordAt(position);
+        record->size = -1;
+        record->length.storeRelease(int(padding));
+    }
+    RecordHeader *record = d->recordAt(position + padding);
+    record->size = size;
+    memcpy(record + 1, data, size);
+    record->length.storeRelease(int(length));
+
+    notify(h->messageSeq, h->receiverSleeping);
+    return true;
+}
+
+/*!
+  Returns \c true if a message is waiting to be received. This function
+  can only be called by the receiver.
+*/
+bool QSharedMemoryChannel::hasPendingMessages() const
+{
+    // may find an invalid message and set the error
+    QSharedMemoryChannelPrivate *d = const_cast<QSharedMemoryChannelPrivate *>(d_func());
+    return d->header && d->receiver && d->nextRecord("QSharedMemoryChannel::hasPendingMessages");
+}
+
+/*!
+  Returns the size of the next message, or -1 if there is none. This
+  function can only be called by the receiver.
+*/
+int QSharedMemoryChannel::nextMessageSize() const
+{
+    QSharedMemoryChannelPrivate *d = const_cast<QSharedMemoryChannelPrivate *>(d_func());
+    if (!d->header || !d->receiver)
+        return -1;
+    int size;
+    return d->nextRecord("QSharedMemoryChannel::nextMessageSize", &size) ? size : -1;
+}
+
+/*!
+  Receives the next message into \a data, which can hold \a maxSize bytes,
+  and returns its size. Returns -1 if there is no message, or if the
+  message is larger than \a maxSize; in that case it is left in the
+  channel. This function can only be called by the receiver.
+
+  \sa nextMessageSize()
+*/
+int QSharedMemoryChannel::receive(char *data, int maxSize)
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::receive";
+    if (!d->checkAttached(true, function))
+        return -1;
+
+    int size;
+    quint64 length;
+    RecordHeader *record = d->nextRecord(function, &size, &length);
+    if (!record)
+        return -1;
+    if (size > maxSize) {
+        d->setError(MessageTooLarge, tr("%1: buffer is too small for the message")
+                    .arg(QLatin1String(function)));
+        return -1;
+    }
+    memcpy(data, record + 1, size);
+    d->releaseRecord(record, length);
+    return size;
+}
+
+/*!
+  \overload
+
+  Receives the next message and returns it, or returns a null QByteArray
+  if there is none.
+*/
+QByteArray QSharedMemoryChannel::receive()
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::receive";
+    if (!d->checkAttached(true, function))
+        return QByteArray();
+
+    int size;
+    quint64 length;
+    RecordHeader *record = d->nextRecord(function, &size, &length);
+    if (!record)
+        return QByteArray();
+    QByteArray message(reinterpret_cast<const char *>(record + 1), size);
+    d->releaseRecord(record, length);
+    return message;
+}
+
+/*!
+  Blocks until a message is waiting to be received, or until \a msecs
+  milliseconds have passed. Returns \c true if a message is available. If
+  \a msecs is -1, this function will not time out. This function can only
+  be called by the receiver.
+
+  \sa messageAvailable()
+*/
+bool QSharedMemoryChannel::waitForMessage(int msecs)
+{
+    Q_D(QSharedMemoryChannel);
+    const char *function = "QSharedMemoryChannel::waitForMessage";
+    if (!d->checkAttached(true, function))
+        return false;
+    if (d->nextRecord(function))
+        return true;
+    if (d->corrupted)
+        return false;
+    return waitForCondition(d->header->messageSeq, d->header->receiverSleeping, msecs,
+                            [d, function]() { return d->corrupted || d->nextRecord(function) != 0; })
+            && !d->corrupted;
+}
+
+/*!
+  Returns a value indicating whether an error occurred, and, if so, which
+  error it was.
+
+  \sa errorString()
+*/
+QSharedMemoryChannel::ChannelError QSharedMemoryChannel::error() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->error;
+}
+
+/*!
+  Returns a text description of the last error that occurred.
+
+  \sa error()
+*/
+QString QSharedMemoryChannel::errorString() const
+{
+    Q_D(const QSharedMemoryChannel);
+    return d->errorString;
+}
+
+/*!
+  \fn void QSharedMemoryChannel::messageAvailable()
+
+  This signal is emitted in the receiver's thread when new messages have
+  arrived. It is only emitted if that thread runs an event loop.
+
+  \sa receive(), waitForMessage()
+*/
+
+#endif // QT_NO_SHAREDMEMORY
+
+QT_END_NAMESPACE
+
+#include "moc_qsharedmemorychannel.cpp"
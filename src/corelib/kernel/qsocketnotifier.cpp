@@ -46,6 +46,7 @@
 
 #include "qobject_p.h"
 #include <private/qthread_p.h>
+#include <private/qtrace_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -263,7 +264,9 @@ bool QSocketNotifier::event(QEvent *e)
     }
     QObject::event(e);                        // will activate filters
     if ((e->type() == QEvent::SockAct) || (e->type() == QEvent::SockClose)) {
+        Q_TRACE(QSocketNotifier_activated_entry, this, int(d->sockfd), int(d->sntype));
         emit activated(d->sockfd, QPrivateSignal());
+        Q_TRACE(QSocketNotifier_activated_exit);
         return true;
     }
     return false;
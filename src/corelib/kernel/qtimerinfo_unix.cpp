@@ -45,6 +45,7 @@
 #include "private/qtimerinfo_unix_p.h"
 #include "private/qobject_p.h"
 #include "private/qabstracteventdispatcher_p.h"
+#include "private/qtrace_p.h"
 
 #ifdef QTIMERINFO_DEBUG
 #  include <QDebug>
@@ -63,6 +64,7 @@ Q_CORE_EXPORT bool qt_disable_lowpriority_timers=false;
  */
 
 QTimerInfoList::QTimerInfoList()
+    : statistics(nullptr)
 {
 #if (_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC) && !defined(Q_OS_NACL)
     if (!QElapsedTimer::isMonotonic()) {
@@ -562,6 +564,13 @@ QList<QAbstractEventDispatcher::TimerInfo> QTimerInfoList::registeredTimers(QObj
     return list;
 }
 
+// how late a timer that was due at \a timeout fires at \a now
+static inline qint64 latenessInNanoseconds(const timespec &now, const timespec &timeout)
+{
+    const timespec late = now - timeout;
+    return qint64(late.tv_sec) * 1000 * 1000 * 1000 + late.tv_nsec;
+}
+
 /*
     Activate pending timers, returning how many where activated.
 */
@@ -607,6 +616,12 @@ int QTimerInfoList::activateTimers()
         // remove from list
         removeFirst();
 
+        const qint64 lateness = latenessInNanoseconds(currentTime, currentTimerInfo->timeout);
+        if (statistics)
+            statistics->recordTimerLateness(lateness);
+        Q_TRACE(QTimerInfoList_activateTimer_entry, currentTimerInfo->obj, currentTimerInfo->id,
+                int(qMin<qint64>(lateness / 1000, INT_MAX)));
+
 #ifdef QTIMERINFO_DEBUG
         float diff;
         if (currentTime < currentTimerInfo->expected) {
@@ -645,6 +660,7 @@ int QTimerInfoList::activateTimers()
             if (currentTimerInfo)
                 currentTimerInfo->activateRef = 0;
         }
+        Q_TRACE(QTimerInfoList_activateTimer_exit);
     }
 
     firstTimerInfo = 0;
@@ -61,6 +61,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QEventDispatcherStatisticsRecorder;
+
 // internal timer info
 struct QTimerInfo {
     int id;           // - timer identifier
@@ -98,6 +100,9 @@ public:
     timespec currentTime;
     timespec updateCurrentTime();
 
+    // set by the event dispatcher owning the list
+    QEventDispatcherStatisticsRecorder *statistics;
+
     // must call updateCurrentTime() first!
     void repairTimersIfNeeded();
 
@@ -22,4 +22,17 @@ qtConfig(mimetype) {
         mimetypes/qmimeprovider.cpp
 
     RESOURCES += mimetypes/mimetypes.qrc
+
+    qtConfig(mimetype-cache) {
+        QMAKE_QMIME_CACHE_GENERATE = mimetypes/mime/packages/freedesktop.org.xml
+
+        qtPrepareTool(QMAKE_QMIME_CACHE, qmime-cache)
+
+        qmime_cache.commands = $$QMAKE_QMIME_CACHE ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+        qmime_cache.output = mimetypes/qmimecache_data.cpp
+        qmime_cache.depends = $$QMAKE_QMIME_CACHE
+        qmime_cache.input = QMAKE_QMIME_CACHE_GENERATE
+        qmime_cache.variable_out = SOURCES
+        QMAKE_EXTRA_COMPILERS += qmime_cache
+    }
 }
@@ -182,12 +182,16 @@ QMimeType QMimeDatabasePrivate::mimeTypeForFileNameAndData(const QString &fileNa
     }
 
     // Extension is unknown, or matches multiple mimetypes.
-    // Pass 2) Match on content, if we can read the data
+    // Pass 2) Match on content, if we can read the data.
+    // Files are only opened here, most of them are settled by their name.
+    const bool openedByUs = !device->isOpen() && device->open(QIODevice::ReadOnly);
     if (device->isOpen()) {
 
         // Read 16K in one go (QIODEVICE_BUFFERSIZE in qiodevice_p.h).
         // This is much faster than seeking back and forth into QIODevice.
         const QByteArray data = device->peek(16384);
+        if (openedByUs)
+            device->close();
 
         int magicAccuracy = 0;
         QMimeType candidateByData(findByData(data, &magicAccuracy));
@@ -220,6 +224,55 @@ QMimeType QMimeDatabasePrivate::mimeTypeForFileNameAndData(const QString &fileNa
     return mimeTypeForName(defaultMimeType());
 }
 
+QMimeType QMimeDatabasePrivate::mimeTypeForFileExtension(const QString &fileName)
+{
+    const QStringList matches = mimeTypeForFileName(fileName);
+    if (matches.isEmpty())
+        return mimeTypeForName(defaultMimeType());
+    // If several match, we have to pick one.
+    return mimeTypeForName(matches.first());
+}
+
+QMimeType QMimeDatabasePrivate::mimeTypeForFile(const QString &fileName, const QFileInfo &fileInfo, QMimeDatabase::MatchMode mode)
+{
+    if (mode == QMimeDatabase::MatchExtension)
+        return mimeTypeForFileExtension(fileName);
+
+#ifdef Q_OS_UNIX
+    // Cannot access statBuf.st_mode from the filesystem engine, so we stat
+    // ourselves, and only ask QFileInfo about paths stat() can't see (resources).
+    // In addition we want to follow symlinks.
+    const QByteArray nativeFilePath = QFile::encodeName(fileName);
+    QT_STATBUF statBuffer;
+    if (QT_STAT(nativeFilePath.constData(), &statBuffer) == 0) {
+        if (S_ISDIR(statBuffer.st_mode))
+            return mimeTypeForName(QLatin1String("inode/directory"));
+        if (S_ISCHR(statBuffer.st_mode))
+            return mimeTypeForName(QLatin1String("inode/chardevice"));
+        if (S_ISBLK(statBuffer.st_mode))
+            return mimeTypeForName(QLatin1String("inode/blockdevice"));
+        if (S_ISFIFO(statBuffer.st_mode))
+            return mimeTypeForName(QLatin1String("inode/fifo"));
+        if (S_ISSOCK(statBuffer.st_mode))
+            return mimeTypeForName(QLatin1String("inode/socket"));
+    } else if (fileInfo.isDir()) {
+        return mimeTypeForName(QLatin1String("inode/directory"));
+    }
+#else
+    if (fileInfo.isDir())
+        return mimeTypeForName(QLatin1String("inode/directory"));
+#endif
+
+    QFile file(fileName);
+    int accuracy = 0;
+    if (mode == QMimeDatabase::MatchContent) {
+        if (!file.open(QIODevice::ReadOnly))
+            return mimeTypeForName(defaultMimeType());
+        return findByData(file.peek(16384), &accuracy);
+    }
+    return mimeTypeForFileNameAndData(fileName, &file, &accuracy);
+}
+
 QList<QMimeType> QMimeDatabasePrivate::allMimeTypes()
 {
     return provider()->allMimeTypes();
@@ -359,47 +412,7 @@ QMimeType QMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, MatchMode mo
 {
     QMutexLocker locker(&d->mutex);
 
-    if (fileInfo.isDir())
-        return d->mimeTypeForName(QLatin1String("inode/directory"));
-
-    QFile file(fileInfo.absoluteFilePath());
-
-#ifdef Q_OS_UNIX
-    // Cannot access statBuf.st_mode from the filesystem engine, so we have to stat again.
-    // In addition we want to follow symlinks.
-    const QByteArray nativeFilePath = QFile::encodeName(file.fileName());
-    QT_STATBUF statBuffer;
-    if (QT_STAT(nativeFilePath.constData(), &statBuffer) == 0) {
-        if (S_ISCHR(statBuffer.st_mode))
-            return d->mimeTypeForName(QLatin1String("inode/chardevice"));
-        if (S_ISBLK(statBuffer.st_mode))
-            return d->mimeTypeForName(QLatin1String("inode/blockdevice"));
-        if (S_ISFIFO(statBuffer.st_mode))
-            return d->mimeTypeForName(QLatin1String("inode/fifo"));
-        if (S_ISSOCK(statBuffer.st_mode))
-            return d->mimeTypeForName(QLatin1String("inode/socket"));
-    }
-#endif
-
-    int priority = 0;
-    switch (mode) {
-    case MatchDefault:
-        file.open(QIODevice::ReadOnly); // isOpen() will be tested by method below
-        return d->mimeTypeForFileNameAndData(fileInfo.absoluteFilePath(), &file, &priority);
-    case MatchExtension:
-        locker.unlock();
-        return mimeTypeForFile(fileInfo.absoluteFilePath(), mode);
-    case MatchContent:
-        if (file.open(QIODevice::ReadOnly)) {
-            locker.unlock();
-            return mimeTypeForData(&file);
-        } else {
-            return d->mimeTypeForName(d->defaultMimeType());
-        }
-    default:
-        Q_ASSERT(false);
-    }
-    return d->mimeTypeForName(d->defaultMimeType());
+    return d->mimeTypeForFile(fileInfo.filePath(), fileInfo, mode);
 }
 
 /*!
@@ -409,23 +422,39 @@ QMimeType QMimeDatabase::mimeTypeForFile(const QFileInfo &fileInfo, MatchMode mo
 */
 QMimeType QMimeDatabase::mimeTypeForFile(const QString &fileName, MatchMode mode) const
 {
-    if (mode == MatchExtension) {
-        QMutexLocker locker(&d->mutex);
-        const QStringList matches = d->mimeTypeForFileName(fileName);
-        const int matchCount = matches.count();
-        if (matchCount == 0) {
-            return d->mimeTypeForName(d->defaultMimeType());
-        } else if (matchCount == 1) {
-            return d->mimeTypeForName(matches.first());
-        } else {
-            // We have to pick one.
-            return d->mimeTypeForName(matches.first());
-        }
-    } else {
-        // Implemented as a wrapper around mimeTypeForFile(QFileInfo), so no mutex.
-        QFileInfo fileInfo(fileName);
-        return mimeTypeForFile(fileInfo, mode);
+    QMutexLocker locker(&d->mutex);
+
+    if (mode == MatchExtension)
+        return d->mimeTypeForFileExtension(fileName);
+    return d->mimeTypeForFile(fileName, QFileInfo(fileName), mode);
+}
+
+/*!
+    \since 5.10
+
+    Returns a MIME type for each of the files in \a fileNames, in the same
+    order, using \a mode.
+
+    This is equivalent to calling mimeTypeForFile() for every file, but
+    cheaper when classifying many files at once, such as the contents of
+    a directory.
+
+    \sa mimeTypeForFile()
+*/
+QList<QMimeType> QMimeDatabase::mimeTypesForFiles(const QStringList &fileNames, MatchMode mode) const
+{
+    QList<QMimeType> result;
+    result.reserve(fileNames.size());
+
+    QMutexLocker locker(&d->mutex);
+
+    for (const QString &fileName : fileNames) {
+        if (mode == MatchExtension)
+            result.append(d->mimeTypeForFileExtension(fileName));
+        else
+            result.append(d->mimeTypeForFile(fileName, QFileInfo(fileName), mode));
     }
+    return result;
 }
 
 /*!
@@ -551,11 +580,7 @@ QMimeType QMimeDatabase::mimeTypeForUrl(const QUrl &url) const
 QMimeType QMimeDatabase::mimeTypeForFileNameAndData(const QString &fileName, QIODevice *device) const
 {
     int accuracy = 0;
-    const bool openedByUs = !device->isOpen() && device->open(QIODevice::ReadOnly);
-    const QMimeType result = d->mimeTypeForFileNameAndData(fileName, device, &accuracy);
-    if (openedByUs)
-        device->close();
-    return result;
+    return d->mimeTypeForFileNameAndData(fileName, device, &accuracy);
 }
 
 /*!
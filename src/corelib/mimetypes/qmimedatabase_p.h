@@ -52,6 +52,7 @@
 // We mean it.
 //
 
+#include "qmimedatabase.h"
 #include "qmimetype.h"
 
 #ifndef QT_NO_MIMETYPE
@@ -63,6 +64,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QFileInfo;
 class QIODevice;
 class QMimeDatabase;
 class QMimeProviderBase;
@@ -91,6 +93,8 @@ public:
     QMimeType mimeTypeForFileNameAndData(const QString &fileName, QIODevice *device, int *priorityPtr);
     QMimeType findByData(const QByteArray &data, int *priorityPtr);
     QStringList mimeTypeForFileName(const QString &fileName);
+    QMimeType mimeTypeForFileExtension(const QString &fileName);
+    QMimeType mimeTypeForFile(const QString &fileName, const QFileInfo &fileInfo, QMimeDatabase::MatchMode mode);
 
     mutable QMimeProviderBase *m_provider;
     const QString m_defaultMimeType;
@@ -54,6 +54,8 @@
 #include <QDateTime>
 #include <QtEndian>
 
+#include <algorithm>
+
 static void initResources()
 {
     Q_INIT_RESOURCE(mimetypes);
@@ -93,7 +95,7 @@ bool QMimeProviderBase::shouldCheck()
 }
 
 QMimeBinaryProvider::QMimeBinaryProvider(QMimeDatabasePrivate *db)
-    : QMimeProviderBase(db), m_mimetypeListLoaded(false)
+    : QMimeProviderBase(db), m_builtInCache(0), m_mimetypeListLoaded(false)
 {
 }
 
@@ -101,19 +103,27 @@ QMimeBinaryProvider::QMimeBinaryProvider(QMimeDatabasePrivate *db)
 #define QT_USE_MMAP
 #endif
 
+#if QT_CONFIG(mimetype_cache)
+// Generated from freedesktop.org.xml by src/tools/qmime-cache
+extern const uchar qt_mime_cache_data[];
+extern const uint qt_mime_cache_size;
+#endif
+
 struct QMimeBinaryProvider::CacheFile
 {
     CacheFile(const QString &fileName);
+    CacheFile(const uchar *builtInData, uint size);
     ~CacheFile();
 
     bool isValid() const { return m_valid; }
+    bool isBuiltIn() const { return m_builtIn; }
     inline quint16 getUint16(int offset) const
     {
-        return qFromBigEndian(*reinterpret_cast<quint16 *>(data + offset));
+        return qFromBigEndian(*reinterpret_cast<const quint16 *>(data + offset));
     }
     inline quint32 getUint32(int offset) const
     {
-        return qFromBigEndian(*reinterpret_cast<quint32 *>(data + offset));
+        return qFromBigEndian(*reinterpret_cast<const quint32 *>(data + offset));
     }
     inline const char *getCharStar(int offset) const
     {
@@ -123,17 +133,26 @@ struct QMimeBinaryProvider::CacheFile
     bool reload();
 
     QFile file;
-    uchar *data;
+    const uchar *data;
     QDateTime m_mtime;
     bool m_valid;
+    bool m_builtIn;
 };
 
 QMimeBinaryProvider::CacheFile::CacheFile(const QString &fileName)
-    : file(fileName), m_valid(false)
+    : file(fileName), m_valid(false), m_builtIn(false)
 {
     load();
 }
 
+// The built-in cache lives in QtCore's read-only data; it is used in place
+// and never changes, so there is nothing to map, check or reload.
+QMimeBinaryProvider::CacheFile::CacheFile(const uchar *builtInData, uint size)
+    : data(builtInData), m_valid(false), m_builtIn(true)
+{
+    m_valid = size >= 44 && getUint16(0) == 1 && getUint16(2) == 2;
+}
+
 QMimeBinaryProvider::CacheFile::~CacheFile()
 {
 }
@@ -187,37 +206,52 @@ enum {
     PosMagicListOffset = 24,
     // PosNamespaceListOffset = 28,
     PosIconsListOffset = 32,
-    PosGenericIconsListOffset = 36
+    PosGenericIconsListOffset = 36,
+    PosMimeTypeListOffset = 40 // only in the built-in cache, see src/tools/qmime-cache
 };
 
 bool QMimeBinaryProvider::isValid()
 {
-#if defined(QT_USE_MMAP)
     if (!qEnvironmentVariableIsEmpty("QT_NO_MIME_CACHE"))
         return false;
 
+#if defined(QT_USE_MMAP)
     Q_ASSERT(m_cacheFiles.isEmpty()); // this method is only ever called once
     checkCache();
 
     if (m_cacheFiles.count() > 1)
         return true;
-    if (m_cacheFiles.isEmpty())
-        return false;
-
-    // We found exactly one file; is it the user-modified mimes, or a system file?
-    const QString foundFile = m_cacheFiles.constFirst()->file.fileName();
-    const QString localCacheFile = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/mime/mime.cache");
+    if (m_cacheFiles.count() == 1) {
+        // We found exactly one file; is it the user-modified mimes, or a system file?
+        const QString foundFile = m_cacheFiles.constFirst()->file.fileName();
+        const QString localCacheFile = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/mime/mime.cache");
+        if (foundFile != localCacheFile)
+            return true;
+    }
+#endif
 
-    return foundFile != localCacheFile;
-#else
-    return false;
+#if QT_CONFIG(mimetype_cache)
+    // No system database: use the one built into QtCore, unless there are
+    // XML packages around, which only QMimeXMLProvider knows how to read.
+    if (QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QLatin1String("mime/packages"), QStandardPaths::LocateDirectory).isEmpty()) {
+        m_builtInCache = new CacheFile(qt_mime_cache_data, qt_mime_cache_size);
+        if (m_builtInCache->isValid()) {
+            m_cacheFiles.append(m_builtInCache); // always searched last
+            return true;
+        }
+        delete m_builtInCache;
+        m_builtInCache = 0;
+    }
 #endif
+    return false;
 }
 
 bool QMimeBinaryProvider::CacheFileList::checkCacheChanged()
 {
     bool somethingChanged = false;
     for (CacheFile *cacheFile : qAsConst(*this)) {
+        if (cacheFile->isBuiltIn())
+            continue;
         QFileInfo fileInfo(cacheFile->file);
         if (!fileInfo.exists() || fileInfo.lastModified() > cacheFile->m_mtime) {
             // Deletion can't happen by just running update-mime-database.
@@ -256,7 +290,7 @@ void QMimeBinaryProvider::checkCache()
                 //qDebug() << "new file:" << cacheFileName;
                 cacheFile = new CacheFile(cacheFileName);
                 if (cacheFile->isValid()) // verify version
-                    m_cacheFiles.append(cacheFile);
+                    m_cacheFiles.insert(m_cacheFiles.count() - (m_builtInCache ? 1 : 0), cacheFile);
                 else
                     delete cacheFile;
             }
@@ -386,13 +420,29 @@ bool QMimeBinaryProvider::matchMagicRule(QMimeBinaryProvider::CacheFile *cacheFi
         const int off = firstOffset + matchlet * 32;
         const int rangeStart = cacheFile->getUint32(off);
         const int rangeLength = cacheFile->getUint32(off + 4);
-        //const int wordSize = cacheFile->getUint32(off + 8);
+        const int wordSize = cacheFile->getUint32(off + 8);
         const int valueLength = cacheFile->getUint32(off + 12);
         const int valueOffset = cacheFile->getUint32(off + 16);
         const int maskOffset = cacheFile->getUint32(off + 20);
+        const char *value = cacheFile->getCharStar(valueOffset);
         const char *mask = maskOffset ? cacheFile->getCharStar(maskOffset) : NULL;
 
-        if (!QMimeMagicRule::matchSubstring(dataPtr, dataSize, rangeStart, rangeLength, valueLength, cacheFile->getCharStar(valueOffset), mask))
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        // host16 and host32 values are stored big-endian, tagged with their word size
+        char swapped[2][4];
+        if (wordSize > 1 && wordSize == valueLength && wordSize <= 4) {
+            std::reverse_copy(value, value + valueLength, swapped[0]);
+            value = swapped[0];
+            if (mask) {
+                std::reverse_copy(mask, mask + valueLength, swapped[1]);
+                mask = swapped[1];
+            }
+        }
+#else
+        Q_UNUSED(wordSize);
+#endif
+
+        if (!QMimeMagicRule::matchSubstring(dataPtr, dataSize, rangeStart, rangeLength, valueLength, value, mask))
             continue;
 
         const int numChildren = cacheFile->getUint32(off + 24);
@@ -544,6 +594,14 @@ void QMimeBinaryProvider::loadMimeTypeList()
                     m_mimetypeNames.insert(line);
             }
         }
+        if (m_builtInCache) {
+            const int mimeTypeListOffset = m_builtInCache->getUint32(PosMimeTypeListOffset);
+            const int numEntries = m_builtInCache->getUint32(mimeTypeListOffset);
+            for (int i = 0; i < numEntries; ++i) {
+                const int mimeOffset = m_builtInCache->getUint32(mimeTypeListOffset + 4 + 12 * i);
+                m_mimetypeNames.insert(QLatin1String(m_builtInCache->getCharStar(mimeOffset)));
+            }
+        }
     }
 }
 
@@ -571,12 +629,18 @@ void QMimeBinaryProvider::loadMimeTypePrivate(QMimeTypePrivate &data)
     data.loaded = true;
     // load comment and globPatterns
 
+    // Without other cache files there are no per-type XML files to look for
+    if (m_builtInCache && m_cacheFiles.count() == 1 && loadBuiltInMimeTypePrivate(data))
+        return;
+
     const QString file = data.name + QLatin1String(".xml");
     // shared-mime-info since 1.3 lowercases the xml files
     QStringList mimeFiles = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QLatin1String("mime/") + file.toLower());
     if (mimeFiles.isEmpty())
         mimeFiles = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QLatin1String("mime/") + file); // pre-1.3
     if (mimeFiles.isEmpty()) {
+        if (m_builtInCache && loadBuiltInMimeTypePrivate(data))
+            return;
         qWarning() << "No file found for" << file << ", even though update-mime-info said it would exist.\n"
                       "Either it was just removed, or the directory doesn't have executable permission..."
                    << QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, QLatin1String("mime"), QStandardPaths::LocateDirectory);
@@ -654,6 +718,45 @@ void QMimeBinaryProvider::loadMimeTypePrivate(QMimeTypePrivate &data)
 #endif //QT_NO_XMLSTREAMREADER
 }
 
+// Binary search in the MIME type list of the built-in cache
+bool QMimeBinaryProvider::loadBuiltInMimeTypePrivate(QMimeTypePrivate &data)
+{
+    const QByteArray inputMime = data.name.toLatin1();
+    const int mimeTypeListOffset = m_builtInCache->getUint32(PosMimeTypeListOffset);
+    const int numEntries = m_builtInCache->getUint32(mimeTypeListOffset);
+    int begin = 0;
+    int end = numEntries - 1;
+    while (begin <= end) {
+        const int medium = (begin + end) / 2;
+        const int off = mimeTypeListOffset + 4 + 12 * medium;
+        const int mimeOffset = m_builtInCache->getUint32(off);
+        const int cmp = qstrcmp(m_builtInCache->getCharStar(mimeOffset), inputMime);
+        if (cmp < 0) {
+            begin = medium + 1;
+        } else if (cmp > 0) {
+            end = medium - 1;
+        } else {
+            const int commentsOffset = m_builtInCache->getUint32(off + 4);
+            const int numComments = m_builtInCache->getUint32(commentsOffset);
+            for (int i = 0; i < numComments; ++i) {
+                const int langOffset = m_builtInCache->getUint32(commentsOffset + 4 + 8 * i);
+                const int textOffset = m_builtInCache->getUint32(commentsOffset + 8 + 8 * i);
+                data.localeComments.insert(QLatin1String(m_builtInCache->getCharStar(langOffset)),
+                                           QString::fromUtf8(m_builtInCache->getCharStar(textOffset)));
+            }
+            const int patternsOffset = m_builtInCache->getUint32(off + 8);
+            const int numPatterns = m_builtInCache->getUint32(patternsOffset);
+            data.globPatterns.reserve(numPatterns);
+            for (int i = 0; i < numPatterns; ++i) {
+                const int patternOffset = m_builtInCache->getUint32(patternsOffset + 4 + 4 * i);
+                data.globPatterns.append(QLatin1String(m_builtInCache->getCharStar(patternOffset)));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 // Binary search in the icons or generic-icons list
 QString QMimeBinaryProvider::iconForMime(CacheFile *cacheFile, int posListOffset, const QByteArray &inputMime)
 {
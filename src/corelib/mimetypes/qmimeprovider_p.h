@@ -90,7 +90,8 @@ protected:
 };
 
 /*
-   Parses the files 'mime.cache' and 'types' on demand
+   Parses the files 'mime.cache' and 'types' on demand,
+   or the copy of the cache built into QtCore
  */
 class QMimeBinaryProvider : public QMimeProviderBase
 {
@@ -117,6 +118,7 @@ private:
     bool matchSuffixTree(QMimeGlobMatchResult &result, CacheFile *cacheFile, int numEntries, int firstOffset, const QString &fileName, int charPos, bool caseSensitiveCheck);
     bool matchMagicRule(CacheFile *cacheFile, int numMatchlets, int firstOffset, const QByteArray &data);
     QString iconForMime(CacheFile *cacheFile, int posListOffset, const QByteArray &inputMime);
+    bool loadBuiltInMimeTypePrivate(QMimeTypePrivate &data);
     void loadMimeTypeList();
     void checkCache();
 
@@ -127,6 +129,7 @@ private:
         bool checkCacheChanged();
     };
     CacheFileList m_cacheFiles;
+    CacheFile *m_builtInCache; // also in m_cacheFiles, always last
     QStringList m_cacheFileNames;
     QSet<QString> m_mimetypeNames;
     bool m_mimetypeListLoaded;
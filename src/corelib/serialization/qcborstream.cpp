@@ -0,0 +1,1972 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qcborstream.h"
+
+#include <qcoreapplication.h>
+#include <qdatetime.h>
+#include <qendian.h>
+#include <qiodevice.h>
+#include <qjsonarray.h>
+#include <qjsondocument.h>
+#include <qjsonobject.h>
+#include <qlocale.h>
+#include <qnumeric.h>
+#include <qstringlist.h>
+#include <qurl.h>
+#include <quuid.h>
+#include <qvarlengtharray.h>
+#include <private/qutfcodec_p.h>
+
+#include <limits>
+#include <math.h>
+
+QT_BEGIN_NAMESPACE
+
+// same as in qjsonparser.cpp
+static const int nestingLimit = 1024;
+
+// how much is read from the device, or collected before writing to it, at once
+static const int streamChunkSize = 16384;
+
+// the largest string that fits into a QByteArray
+static const quint64 maxStringSize = quint64(std::numeric_limits<int>::max()) - 64;
+
+// CBOR major types (RFC 7049, section 2.1)
+enum MajorType {
+    UnsignedIntegerType = 0,
+    NegativeIntegerType = 1,
+    ByteStringType = 2,
+    TextStringType = 3,
+    ArrayType = 4,
+    MapType = 5,
+    TagType = 6,
+    SimpleTypesType = 7
+};
+
+// additional information values with a special meaning
+enum {
+    SmallValueLimit = 24,
+    Value8Bit = 24,
+    Value16Bit = 25,
+    Value32Bit = 26,
+    Value64Bit = 27,
+    IndefiniteLength = 31,
+
+    FalseValue = 20,
+    TrueValue = 21,
+    NullValue = 22,
+    UndefinedValue = 23,
+    SimpleTypeInNextByte = 24,
+    HalfPrecisionFloat = 25,
+    SinglePrecisionFloat = 26,
+    DoublePrecisionFloat = 27,
+
+    BreakByte = 0xff
+};
+
+// tags that are converted to and from QVariant types (RFC 7049, section 2.4)
+enum {
+    DateTimeStringTag = 0,
+    EpochDateTimeTag = 1,
+    ExpectedBase64urlTag = 21,
+    ExpectedBase64Tag = 22,
+    ExpectedBase16Tag = 23,
+    UrlTag = 32,
+    UuidTag = 37
+};
+
+// from RFC 7049, Appendix D
+static double decodeHalf(quint16 half)
+{
+    const int exponent = (half >> 10) & 0x1f;
+    const int mantissa = half & 0x3ff;
+    double value;
+    if (exponent == 0)
+        value = ldexp(double(mantissa), -24);
+    else if (exponent != 31)
+        value = ldexp(double(mantissa + 1024), exponent - 25);
+    else
+        value = mantissa == 0 ? qInf() : qQNaN();
+    return half & 0x8000 ? -value : value;
+}
+
+static bool isAscii(const char *data, int size)
+{
+    uchar bits = 0;
+    for (int i = 0; i < size; ++i)
+        bits |= uchar(data[i]);
+    return bits < 0x80;
+}
+
+class QCborStreamReaderPrivate
+{
+public:
+    struct Container {
+        QCborStreamReader::TokenType type;
+        bool indefinite;
+        quint64 remaining;      // items left in a definite container, items read in an indefinite one
+    };
+
+    QCborStreamReaderPrivate()
+        : device(0)
+    {
+        init();
+    }
+
+    void init()
+    {
+        buffer.clear();
+        pos = 0;
+        tokenStart = 0;
+        consumed = 0;
+        containers.clear();
+        pendingTag = false;
+        type = QCborStreamReader::NoToken;
+        error = QCborStreamReader::NoError;
+        atEnd = false;
+        number = 0;
+        dbl = 0;
+        clearString();
+    }
+
+    void clearString()
+    {
+        stringOffset = -1;
+        stringLength = 0;
+        textDecoded = false;
+    }
+
+    bool fill();
+    bool ensure(int size);
+    int peek(int i);
+    bool readArgument(int offset, quint64 *value, int *headerSize);
+
+    QCborStreamReader::TokenType readToken();
+    QCborStreamReader::TokenType readString(int major, int info, quint64 length, int headerSize);
+    QCborStreamReader::TokenType readSimpleType(int info, quint64 value);
+    void itemRead();
+
+    QCborStreamReader::TokenType raiseError(QCborStreamReader::Error e)
+    {
+        error = e;
+        atEnd = true;
+        return QCborStreamReader::Invalid;
+    }
+
+    QJsonValue readJsonValue(QCborStreamReader *q, quint64 tagValue = ExpectedBase64urlTag);
+    QString readJsonKey(QCborStreamReader *q);
+    QVariant readVariant(QCborStreamReader *q);
+
+    const char *stringData() const
+    {
+        return stringOffset < 0 ? chunkedString.constData() : buffer.constData() + stringOffset;
+    }
+
+    QIODevice *device;
+
+    // The unread input. Everything before tokenStart is dropped when more
+    // input is needed. Data passed to addData() is shared, not copied, as
+    // long as nothing is left from earlier data.
+    QByteArray buffer;
+    int pos;
+    int tokenStart;
+    qint64 consumed;
+
+    QVarLengthArray<Container, 32> containers;
+    bool pendingTag;
+
+    QCborStreamReader::TokenType type;
+    QCborStreamReader::Error error;
+    bool atEnd;
+
+    // the current token; a definite-length string is not copied out of
+    // buffer, the chunks of an indefinite-length one are joined in chunkedString
+    quint64 number;
+    double dbl;
+    int stringOffset;
+    int stringLength;
+    QByteArray chunkedString;
+    bool textDecoded;
+    QString text;
+};
+
+/*
+    Reads more input, dropping everything before tokenStart first. Returns
+    false if no more data is available at the moment.
+*/
+bool QCborStreamReaderPrivate::fill()
+{
+    if (!device)
+        return false;
+    if (tokenStart > 0) {
+        buffer.remove(0, tokenStart);
+        consumed += tokenStart;
+        pos -= tokenStart;
+        tokenStart = 0;
+    }
+    const int size = buffer.size();
+    buffer.resize(size + streamChunkSize);
+    const qint64 bytesRead = device->read(buffer.data() + size, streamChunkSize);
+    buffer.resize(size + int(qMax(bytesRead, qint64(0))));
+    return bytesRead > 0;
+}
+
+/*
+    Makes sure that \a size bytes from the start of the current token are
+    in the buffer.
+*/
+bool QCborStreamReaderPrivate::ensure(int size)
+{
+    while (buffer.size() - tokenStart < size) {
+        if (!fill())
+            return false;
+    }
+    return true;
+}
+
+/*
+    Returns the byte at offset \a i from the start of the current token,
+    or -1 if the input ends before it.
+*/
+int QCborStreamReaderPrivate::peek(int i)
+{
+    if (!ensure(i + 1))
+        return -1;
+    return uchar(buffer.at(tokenStart + i));
+}
+
+/*
+    Reads the argument of the item header at \a offset from the start of
+    the current token. The caller has handled indefinite lengths.
+*/
+bool QCborStreamReaderPrivate::readArgument(int offset, quint64 *value, int *headerSize)
+{
+    const int info = peek(offset) & 0x1f;
+    if (info < SmallValueLimit) {
+        *value = info;
+        *headerSize = 1;
+        return true;
+    }
+    if (info > Value64Bit) {
+        raiseError(QCborStreamReader::IllegalNumber);
+        return false;
+    }
+    const int bytes = 1 << (info - Value8Bit);
+    if (!ensure(offset + 1 + bytes)) {
+        raiseError(QCborStreamReader::UnexpectedEndOfData);
+        return false;
+    }
+    const uchar *data = reinterpret_cast<const uchar *>(buffer.constData()) + tokenStart + offset + 1;
+    switch (bytes) {
+    case 1:
+        *value = *data;
+        break;
+    case 2:
+        *value = qFromBigEndian<quint16>(data);
+        break;
+    case 4:
+        *value = qFromBigEndian<quint32>(data);
+        break;
+    default:
+        *value = qFromBigEndian<quint64>(data);
+        break;
+    }
+    *headerSize = 1 + bytes;
+    return true;
+}
+
+// counts a data item in the enclosing container; arrays and maps count when they start
+void QCborStreamReaderPrivate::itemRead()
+{
+    pendingTag = false;
+    if (containers.isEmpty())
+        return;
+    Container &container = containers.last();
+    if (container.indefinite)
+        ++container.remaining;
+    else
+        --container.remaining;
+}
+
+QCborStreamReader::TokenType QCborStreamReaderPrivate::readToken()
+{
+    tokenStart = pos;
+    clearString();
+
+    if (!containers.isEmpty() && !containers.last().indefinite && containers.last().remaining == 0) {
+        const QCborStreamReader::TokenType end = containers.last().type == QCborStreamReader::StartArray
+                ? QCborStreamReader::EndArray : QCborStreamReader::EndMap;
+        containers.removeLast();
+        return end;
+    }
+
+    const int initialByte = peek(0);
+    if (initialByte < 0) {
+        if (containers.isEmpty() && !pendingTag) {
+            atEnd = true;
+            return QCborStreamReader::NoToken;
+        }
+        return raiseError(QCborStreamReader::UnexpectedEndOfData);
+    }
+
+    if (initialByte == BreakByte) {
+        if (containers.isEmpty() || !containers.last().indefinite || pendingTag)
+            return raiseError(QCborStreamReader::UnexpectedBreak);
+        const Container container = containers.last();
+        if (container.type == QCborStreamReader::StartMap && (container.remaining & 1))
+            return raiseError(QCborStreamReader::UnexpectedBreak);
+        ++pos;
+        containers.removeLast();
+        return container.type == QCborStreamReader::StartArray
+                ? QCborStreamReader::EndArray : QCborStreamReader::EndMap;
+    }
+
+    const int major = initialByte >> 5;
+    const int info = initialByte & 0x1f;
+    quint64 value = 0;
+    int headerSize = 1;
+    if (info == IndefiniteLength) {
+        if (major != ByteStringType && major != TextStringType && major != ArrayType && major != MapType)
+            return raiseError(QCborStreamReader::IllegalNumber);
+    } else if (!readArgument(0, &value, &headerSize)) {
+        return QCborStreamReader::Invalid;
+    }
+
+    switch (major) {
+    case UnsignedIntegerType:
+    case NegativeIntegerType:
+        number = value;
+        pos += headerSize;
+        itemRead();
+        return major == UnsignedIntegerType ? QCborStreamReader::UnsignedInteger
+                                            : QCborStreamReader::NegativeInteger;
+    case ByteStringType:
+    case TextStringType:
+        return readString(major, info, value, headerSize);
+    case ArrayType:
+    case MapType: {
+        if (containers.size() >= nestingLimit)
+            return raiseError(QCborStreamReader::NestingTooDeep);
+        if (major == MapType && value > std::numeric_limits<quint64>::max() / 2)
+            return raiseError(QCborStreamReader::DataTooLarge);
+        pos += headerSize;
+        itemRead();
+        number = value;
+        Container container;
+        container.type = major == ArrayType ? QCborStreamReader::StartArray : QCborStreamReader::StartMap;
+        container.indefinite = info == IndefiniteLength;
+        container.remaining = container.indefinite ? 0 : major == MapType ? 2 * value : value;
+        containers.append(container);
+        return container.type;
+    }
+    case TagType:
+        number = value;
+        pos += headerSize;
+        pendingTag = true;
+        return QCborStreamReader::Tag;
+    default:
+        return readSimpleType(info, value);
+    }
+}
+
+QCborStreamReader::TokenType QCborStreamReaderPrivate::readString(int major, int info, quint64 length, int headerSize)
+{
+    int size;
+    if (info != IndefiniteLength) {
+        if (length > maxStringSize)
+            return raiseError(QCborStreamReader::DataTooLarge);
+        if (!ensure(headerSize + int(length)))
+            return raiseError(QCborStreamReader::UnexpectedEndOfData);
+        stringOffset = tokenStart + headerSize;
+        stringLength = int(length);
+        size = headerSize + int(length);
+    } else {
+        // make sure all chunks are available before joining them
+        QVarLengthArray<QPair<int, int>, 16> chunks;
+        quint64 total = 0;
+        int offset = 1;
+        for (;;) {
+            const int chunkByte = peek(offset);
+            if (chunkByte < 0)
+                return raiseError(QCborStreamReader::UnexpectedEndOfData);
+            if (chunkByte == BreakByte) {
+                ++offset;
+                break;
+            }
+            if (chunkByte >> 5 != major)
+                return raiseError(QCborStreamReader::IllegalType);
+            if ((chunkByte & 0x1f) == IndefiniteLength)
+                return raiseError(QCborStreamReader::IllegalNumber);
+            quint64 chunkLength;
+            int chunkHeaderSize;
+            if (!readArgument(offset, &chunkLength, &chunkHeaderSize))
+                return QCborStreamReader::Invalid;
+            total += chunkLength;
+            if (chunkLength > maxStringSize || total > maxStringSize
+                    || quint64(offset) + chunkHeaderSize + total > maxStringSize) {
+                return raiseError(QCborStreamReader::DataTooLarge);
+            }
+            offset += chunkHeaderSize;
+            if (!ensure(offset + int(chunkLength)))
+                return raiseError(QCborStreamReader::UnexpectedEndOfData);
+            // each chunk of a text string has to be valid UTF-8 on its own
+            const char *chunkData = buffer.constData() + tokenStart + offset;
+            if (major == TextStringType && !QUtf8::isValidUtf8(chunkData, int(chunkLength)))
+                return raiseError(QCborStreamReader::InvalidUtf8String);
+            chunks.append(qMakePair(offset, int(chunkLength)));
+            offset += int(chunkLength);
+        }
+        chunkedString.resize(int(total));
+        char *out = chunkedString.data();
+        for (const QPair<int, int> &chunk : qAsConst(chunks)) {
+            memcpy(out, buffer.constData() + tokenStart + chunk.first, chunk.second);
+            out += chunk.second;
+        }
+        stringLength = int(total);
+        size = offset;
+    }
+
+    if (major == TextStringType && !isAscii(stringData(), stringLength)) {
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        text = QUtf8::convertToUnicode(stringData(), stringLength, &state);
+        if (state.invalidChars || state.remainingChars)
+            return raiseError(QCborStreamReader::InvalidUtf8String);
+        textDecoded = true;
+    }
+
+    pos = tokenStart + size;
+    itemRead();
+    return major == ByteStringType ? QCborStreamReader::ByteString : QCborStreamReader::TextString;
+}
+
+QCborStreamReader::TokenType QCborStreamReaderPrivate::readSimpleType(int info, quint64 value)
+{
+    QCborStreamReader::TokenType token;
+    int size = 1;
+    switch (info) {
+    case FalseValue:
+    case TrueValue:
+        number = info == TrueValue;
+        token = QCborStreamReader::Bool;
+        break;
+    case NullValue:
+        token = QCborStreamReader::Null;
+        break;
+    case UndefinedValue:
+        token = QCborStreamReader::Undefined;
+        break;
+    case SimpleTypeInNextByte:
+        // the values below 32 must be encoded in the initial byte
+        if (value < 32)
+            return raiseError(QCborStreamReader::IllegalSimpleType);
+        number = value;
+        token = QCborStreamReader::SimpleType;
+        size = 2;
+        break;
+    case HalfPrecisionFloat:
+        dbl = decodeHalf(quint16(value));
+        token = QCborStreamReader::Double;
+        size = 3;
+        break;
+    case SinglePrecisionFloat: {
+        const quint32 bits = quint32(value);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        dbl = f;
+        token = QCborStreamReader::Double;
+        size = 5;
+        break;
+    }
+    case DoublePrecisionFloat:
+        memcpy(&dbl, &value, sizeof(dbl));
+        token = QCborStreamReader::Double;
+        size = 9;
+        break;
+    default:
+        number = value;
+        token = QCborStreamReader::SimpleType;
+        break;
+    }
+    pos += size;
+    itemRead();
+    return token;
+}
+
+static QString bytesToJson(const QByteArray &data, quint64 encoding)
+{
+    switch (encoding) {
+    case ExpectedBase64Tag:
+        return QString::fromLatin1(data.toBase64());
+    case ExpectedBase16Tag:
+        return QString::fromLatin1(data.toHex());
+    default:
+        return QString::fromLatin1(data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+    }
+}
+
+/*
+    Converts the item that starts with the current token as described in
+    RFC 7049, section 4.1. Returns an undefined value on errors.
+*/
+QJsonValue QCborStreamReaderPrivate::readJsonValue(QCborStreamReader *q, quint64 tagValue)
+{
+    switch (type) {
+    case QCborStreamReader::UnsignedInteger:
+        return double(number);
+    case QCborStreamReader::NegativeInteger:
+        return -1 - double(number);
+    case QCborStreamReader::ByteString:
+        return bytesToJson(q->rawStringData(), tagValue);
+    case QCborStreamReader::TextString:
+        return q->text();
+    case QCborStreamReader::StartArray: {
+        QJsonArray array;
+        while (q->readNext() != QCborStreamReader::EndArray) {
+            const QJsonValue value = readJsonValue(q, tagValue);
+            if (value.isUndefined())
+                return value;
+            array.append(value);
+        }
+        return array;
+    }
+    case QCborStreamReader::StartMap: {
+        QJsonObject object;
+        while (q->readNext() != QCborStreamReader::EndMap) {
+            const QString key = readJsonKey(q);
+            if (error != QCborStreamReader::NoError)
+                return QJsonValue(QJsonValue::Undefined);
+            q->readNext();
+            const QJsonValue value = readJsonValue(q, tagValue);
+            if (value.isUndefined())
+                return value;
+            object.insert(key, value);
+        }
+        return object;
+    }
+    case QCborStreamReader::Tag: {
+        // the encoding hints for byte strings apply to all nested items,
+        // all other tags are ignored
+        const quint64 tag = number;
+        q->readNext();
+        return readJsonValue(q, tag >= ExpectedBase64urlTag && tag <= ExpectedBase16Tag ? tag : tagValue);
+    }
+    case QCborStreamReader::Bool:
+        return number != 0;
+    case QCborStreamReader::Double:
+        return dbl;
+    case QCborStreamReader::SimpleType:
+    case QCborStreamReader::Null:
+    case QCborStreamReader::Undefined:
+        return QJsonValue();
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+// JSON only has string keys; other keys are written as JSON text
+QString QCborStreamReaderPrivate::readJsonKey(QCborStreamReader *q)
+{
+    if (type == QCborStreamReader::TextString)
+        return q->text();
+    const QJsonValue key = readJsonValue(q);
+    switch (key.type()) {
+    case QJsonValue::String:
+        return key.toString();
+    case QJsonValue::Double:
+        return QString::number(key.toDouble(), 'g', QLocale::FloatingPointShortest);
+    case QJsonValue::Bool:
+        return key.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case QJsonValue::Null:
+        return QStringLiteral("null");
+    case QJsonValue::Array:
+        return QString::fromUtf8(QJsonDocument(key.toArray()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Object:
+        return QString::fromUtf8(QJsonDocument(key.toObject()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Undefined:
+        break;
+    }
+    return QString();
+}
+
+QVariant QCborStreamReaderPrivate::readVariant(QCborStreamReader *q)
+{
+    switch (type) {
+    case QCborStreamReader::UnsignedInteger:
+        if (number > quint64(std::numeric_limits<qint64>::max()))
+            return number;
+        return qint64(number);
+    case QCborStreamReader::NegativeInteger:
+        if (number > quint64(std::numeric_limits<qint64>::max()))
+            return -1 - double(number);
+        return -1 - qint64(number);
+    case QCborStreamReader::ByteString:
+        return q->byteArray();
+    case QCborStreamReader::TextString:
+        return q->text();
+    case QCborStreamReader::StartArray: {
+        QVariantList list;
+        while (q->readNext() != QCborStreamReader::EndArray) {
+            const QVariant value = readVariant(q);
+            if (error != QCborStreamReader::NoError)
+                return QVariant();
+            list.append(value);
+        }
+        return list;
+    }
+    case QCborStreamReader::StartMap: {
+        QVariantMap map;
+        while (q->readNext() != QCborStreamReader::EndMap) {
+            const QString key = readJsonKey(q);
+            if (error != QCborStreamReader::NoError)
+                return QVariant();
+            q->readNext();
+            const QVariant value = readVariant(q);
+            if (error != QCborStreamReader::NoError)
+                return QVariant();
+            map.insert(key, value);
+        }
+        return map;
+    }
+    case QCborStreamReader::Tag: {
+        const quint64 tag = number;
+        q->readNext();
+        const QVariant value = readVariant(q);
+        if (error != QCborStreamReader::NoError)
+            return QVariant();
+        switch (tag) {
+        case DateTimeStringTag:
+            if (value.type() == QVariant::String)
+                return QDateTime::fromString(value.toString(), Qt::ISODateWithMs);
+            break;
+        case EpochDateTimeTag:
+            if (type == QCborStreamReader::UnsignedInteger || type == QCborStreamReader::NegativeInteger
+                    || type == QCborStreamReader::Double)
+                return QDateTime::fromMSecsSinceEpoch(qint64(value.toDouble() * 1000), Qt::UTC);
+            break;
+        case UrlTag:
+            if (value.type() == QVariant::String)
+                return QUrl(value.toString());
+            break;
+        case UuidTag:
+            if (value.type() == QVariant::ByteArray && value.toByteArray().size() == 16)
+                return QUuid::fromRfc4122(value.toByteArray());
+            break;
+        }
+        return value;
+    }
+    case QCborStreamReader::Bool:
+        return number != 0;
+    case QCborStreamReader::Double:
+        return dbl;
+    case QCborStreamReader::Null:
+        return QVariant::fromValue(nullptr);
+    default:
+        return QVariant();
+    }
+}
+
+/*!
+    \class QCborStreamReader
+    \inmodule QtCore
+    \ingroup io
+    \reentrant
+    \since 5.10
+
+    \brief The QCborStreamReader class reads CBOR data as a stream of tokens.
+
+    The Concise Binary Object Representation (CBOR, RFC 7049) is a compact
+    binary data format with the data model of JSON, extended by byte
+    strings, integers, tags and a few other simple types. It is well
+    suited for exchanging data between processes and over the network,
+    because it needs neither the text conversion of JSON nor a Qt-specific
+    format such as the one of QDataStream on the other side.
+
+    Like QJsonStreamReader, the reader reports the data piece by piece:
+    the application calls readNext() in a loop, and each call returns the
+    next token, such as the start of an array or map, an integer or a
+    string. The input is taken either from a QIODevice (see setDevice()),
+    which is read in chunks as needed, or from data passed to addData().
+    If the input ends in the middle of an item, readNext() returns Invalid
+    and error() returns UnexpectedEndOfData. This is not fatal: once more
+    data has been added, or has arrived on the device, the next call to
+    readNext() continues where the previous one stopped. All other errors
+    are final. Any number of items can follow each other in the input.
+
+    \snippet code/src_corelib_serialization_qcborstream.cpp 0
+
+    Arrays and maps are reported with StartArray and StartMap tokens,
+    followed by their contents and an EndArray or EndMap token, no matter
+    whether their length is encoded in the data or they are terminated by
+    a break. The contents of a map alternate between keys and values.
+    A Tag token is followed by the item that it tags.
+
+    Strings are not copied out of the input when their length is encoded
+    in the data: rawStringData() refers directly to the bytes of the
+    current string, text() decodes a text string, and byteArray() returns
+    a copy of the data. Text strings are checked to be valid UTF-8.
+
+    readCurrentJsonValue() and readCurrentVariant() read a complete item,
+    including the contents of arrays and maps, and convert it to a
+    QJsonValue or a QVariant.
+
+    \sa QCborStreamWriter, QJsonStreamReader, QDataStream
+*/
+
+/*!
+    \enum QCborStreamReader::TokenType
+
+    This enum specifies the type of token the reader just read.
+
+    \value NoToken          The reader has not read anything yet, or is at
+                            the end of the input between two items.
+    \value Invalid          An error has occurred, reported in error() and
+                            errorString().
+    \value UnsignedInteger  An integer; toUnsignedInteger() returns its value.
+    \value NegativeInteger  A negative integer; toInteger() returns its value
+                            if it fits into a qint64, toDouble() in any case.
+    \value ByteString       A byte string, returned by byteArray() and
+                            rawStringData().
+    \value TextString       A UTF-8 text string, returned by text().
+    \value StartArray       The start of an array.
+    \value EndArray         The end of an array.
+    \value StartMap         The start of a map. The keys and values follow
+                            in turn.
+    \value EndMap           The end of a map.
+    \value Tag              A tag, as returned by tag(), for the next item.
+    \value SimpleType       A simple type without a meaning in CBOR, as
+                            returned by simpleType().
+    \value Bool             \c true or \c false, as returned by toBool().
+    \value Null             \c null.
+    \value Undefined        \c undefined.
+    \value Double           A floating point number of any precision, as
+                            returned by toDouble().
+*/
+
+/*!
+    \enum QCborStreamReader::Error
+
+    This enum specifies the errors the reader can report.
+
+    \value NoError              No error occurred.
+    \value UnexpectedEndOfData  The input ended in the middle of an item.
+                                Reading can continue once more data is
+                                available.
+    \value IllegalType          A chunk of an indefinite-length string has
+                                a different type than the string.
+    \value IllegalNumber        An item header uses a reserved encoding.
+    \value IllegalSimpleType    A simple type below 32 was encoded in two
+                                bytes.
+    \value UnexpectedBreak      A break appeared outside of an
+                                indefinite-length container, right after a
+                                tag or after a map key.
+    \value InvalidUtf8String    A text string is not valid UTF-8.
+    \value DataTooLarge         A string is too large to be held in memory,
+                                or a map has too many entries.
+    \value NestingTooDeep       Arrays and maps are nested more than 1024
+                                levels deep.
+*/
+
+/*!
+    Constructs a stream reader without input.
+
+    \sa setDevice(), addData()
+*/
+QCborStreamReader::QCborStreamReader()
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+}
+
+/*!
+    Constructs a stream reader that reads from \a device.
+
+    \sa setDevice()
+*/
+QCborStreamReader::QCborStreamReader(QIODevice *device)
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Constructs a stream reader that reads from \a data. The data is not
+    copied.
+
+    \sa addData()
+*/
+QCborStreamReader::QCborStreamReader(const QByteArray &data)
+    : d_ptr(new QCborStreamReaderPrivate)
+{
+    addData(data);
+}
+
+/*!
+    Destroys the reader.
+*/
+QCborStreamReader::~QCborStreamReader()
+{
+}
+
+/*!
+    Sets the current device to \a device and resets the reader to its
+    initial state. The reader does not take ownership of the device.
+
+    \sa device(), clear()
+*/
+void QCborStreamReader::setDevice(QIODevice *device)
+{
+    Q_D(QCborStreamReader);
+    d->init();
+    d->device = device;
+    if (device)
+        d->buffer.reserve(streamChunkSize);
+}
+
+/*!
+    Returns the current device, or 0 if no device has been set.
+
+    \sa setDevice()
+*/
+QIODevice *QCborStreamReader::device() const
+{
+    Q_D(const QCborStreamReader);
+    return d->device;
+}
+
+/*!
+    Adds more \a data for the reader to read. This function does nothing
+    if the reader has a device(). atEnd() returns \c false afterwards.
+
+    If all previous data has been read, \a data is shared rather than
+    copied.
+
+    \sa readNext(), clear()
+*/
+void QCborStreamReader::addData(const QByteArray &data)
+{
+    Q_D(QCborStreamReader);
+    if (d->device) {
+        qWarning("QCborStreamReader: addData() with device()");
+        return;
+    }
+    if (d->pos > 0) {
+        d->consumed += d->pos;
+        if (d->pos == d->buffer.size())
+            d->buffer.clear();
+        else
+            d->buffer.remove(0, d->pos);
+        d->pos = 0;
+        d->tokenStart = 0;
+        d->clearString();
+    }
+    d->buffer += data;
+    d->atEnd = false;
+}
+
+/*!
+    Removes any device() or data from the reader and resets its internal
+    state to the initial state.
+
+    \sa addData()
+*/
+void QCborStreamReader::clear()
+{
+    Q_D(QCborStreamReader);
+    d->init();
+    d->device = 0;
+}
+
+/*!
+    Returns \c true if the reader has read until the end of the input
+    that is currently available, or if an error has occurred; otherwise
+    returns \c false.
+
+    \sa hasError(), readNext()
+*/
+bool QCborStreamReader::atEnd() const
+{
+    Q_D(const QCborStreamReader);
+    return d->atEnd;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    If an error other than UnexpectedEndOfData has occurred, reading is no
+    longer possible and this function returns Invalid.
+
+    \sa tokenType(), atEnd()
+*/
+QCborStreamReader::TokenType QCborStreamReader::readNext()
+{
+    Q_D(QCborStreamReader);
+    if (d->error != NoError) {
+        if (d->error != UnexpectedEndOfData)
+            return Invalid;
+        d->error = NoError;
+    }
+    d->atEnd = false;
+    d->type = d->readToken();
+    return d->type;
+}
+
+/*!
+    If the current token starts an array or a map, reads until the end of
+    it. If it is a tag, reads the tagged item. Otherwise this function does
+    nothing.
+
+    \sa readCurrentJsonValue(), readCurrentVariant()
+*/
+void QCborStreamReader::skipCurrentValue()
+{
+    Q_D(QCborStreamReader);
+    if (d->type == Tag) {
+        readNext();
+        skipCurrentValue();
+        return;
+    }
+    if (d->type != StartArray && d->type != StartMap)
+        return;
+    const int level = d->containers.size();
+    while (d->containers.size() >= level) {
+        if (readNext() == Invalid)
+            return;
+    }
+}
+
+/*!
+    Reads the item that starts with the current token, including all of
+    its contents if it is an array or a map, and converts it to a
+    QJsonValue as recommended in RFC 7049, section 4.1. The current token
+    is then the last token of the item.
+
+    Integers become doubles, byte strings are encoded in base64url (or in
+    base64 or hex, as requested by tag 22 or 23), keys of maps that are not
+    text strings are converted to their JSON text, and \c null,
+    \c undefined and all simple types become \c null. Other tags are
+    ignored.
+
+    If the current token does not start an item, or if the item could not
+    be read completely, an undefined QJsonValue is returned.
+
+    \sa readCurrentVariant(), QCborStreamWriter::writeJsonValue()
+*/
+QJsonValue QCborStreamReader::readCurrentJsonValue()
+{
+    Q_D(QCborStreamReader);
+    return d->readJsonValue(this);
+}
+
+/*!
+    Reads the item that starts with the current token, including all of
+    its contents if it is an array or a map, and converts it to a
+    QVariant. The current token is then the last token of the item.
+
+    Integers become \c qlonglong (or \c qulonglong if they are too large),
+    byte strings QByteArray, text strings QString, arrays QVariantList and
+    maps QVariantMap. Tagged date and time strings (tag 0), epoch-based
+    dates (tag 1), URLs (tag 32) and UUIDs (tag 37) are converted to
+    QDateTime, QUrl and QUuid; other tags are ignored. \c null becomes a
+    QVariant holding a \c nullptr, and \c undefined an invalid QVariant.
+
+    If the current token does not start an item, or if the item could not
+    be read completely, an invalid QVariant is returned and hasError()
+    returns \c true.
+
+    \sa readCurrentJsonValue(), QCborStreamWriter::writeVariant()
+*/
+QVariant QCborStreamReader::readCurrentVariant()
+{
+    Q_D(QCborStreamReader);
+    return d->readVariant(this);
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa readNext()
+*/
+QCborStreamReader::TokenType QCborStreamReader::tokenType() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type;
+}
+
+/*!
+    Returns the number of arrays and maps that are open at the current
+    token. The start of an array or map already counts, the end no longer
+    does.
+*/
+int QCborStreamReader::depth() const
+{
+    Q_D(const QCborStreamReader);
+    return d->containers.size();
+}
+
+/*!
+    Returns the number of bytes of input the reader has read up to the
+    end of the current token, or up to the start of the item where the
+    error occurred.
+*/
+qint64 QCborStreamReader::offset() const
+{
+    Q_D(const QCborStreamReader);
+    return d->consumed + d->pos;
+}
+
+/*!
+    Returns \c true if the current token is a string, or the start of an
+    array or map, whose length is encoded in the data. Strings are always
+    read completely, so their length is always known.
+
+    \sa length()
+*/
+bool QCborStreamReader::isLengthKnown() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->type) {
+    case ByteString:
+    case TextString:
+        return true;
+    case StartArray:
+    case StartMap:
+        return !d->containers.last().indefinite;
+    default:
+        return false;
+    }
+}
+
+/*!
+    Returns the number of bytes of the current string, or the number of
+    entries of the current array or map if isLengthKnown(). Returns 0
+    otherwise.
+*/
+quint64 QCborStreamReader::length() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->type) {
+    case ByteString:
+    case TextString:
+        return quint64(d->stringLength);
+    case StartArray:
+    case StartMap:
+        return d->containers.last().indefinite ? 0 : d->number;
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Returns the value of an UnsignedInteger token, or the encoded value
+    \c{n} of a NegativeInteger token, which stands for \c{-1 - n}. Returns
+    0 for other tokens.
+
+    \sa toInteger()
+*/
+quint64 QCborStreamReader::toUnsignedInteger() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == UnsignedInteger || d->type == NegativeInteger ? d->number : 0;
+}
+
+/*!
+    Returns the value of an UnsignedInteger or NegativeInteger token,
+    converted to a qint64. Values outside of the range of a qint64 are
+    clamped to it. Returns 0 for other tokens.
+
+    \sa toUnsignedInteger(), toDouble()
+*/
+qint64 QCborStreamReader::toInteger() const
+{
+    Q_D(const QCborStreamReader);
+    const quint64 max = quint64(std::numeric_limits<qint64>::max());
+    switch (d->type) {
+    case UnsignedInteger:
+        return qint64(qMin(d->number, max));
+    case NegativeInteger:
+        return -1 - qint64(qMin(d->number, max));
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Returns the value of a Double, UnsignedInteger or NegativeInteger
+    token, or 0 for other tokens.
+*/
+double QCborStreamReader::toDouble() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->type) {
+    case Double:
+        return d->dbl;
+    case UnsignedInteger:
+        return double(d->number);
+    case NegativeInteger:
+        return -1 - double(d->number);
+    default:
+        return 0;
+    }
+}
+
+/*!
+    Returns the value of a Bool token, or \c false for other tokens.
+*/
+bool QCborStreamReader::toBool() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == Bool && d->number;
+}
+
+/*!
+    Returns the value of a Tag token, or 0 for other tokens.
+*/
+quint64 QCborStreamReader::tag() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == Tag ? d->number : 0;
+}
+
+/*!
+    Returns the value of a SimpleType token, or 0 for other tokens.
+*/
+quint8 QCborStreamReader::simpleType() const
+{
+    Q_D(const QCborStreamReader);
+    return d->type == SimpleType ? quint8(d->number) : 0;
+}
+
+/*!
+    Returns the contents of a TextString token, or an empty string for
+    other tokens.
+
+    \sa rawStringData()
+*/
+QString QCborStreamReader::text() const
+{
+    Q_D(const QCborStreamReader);
+    if (d->type != TextString)
+        return QString();
+    if (d->textDecoded)
+        return d->text;
+    // checked to be ASCII
+    return QString::fromLatin1(d->stringData(), d->stringLength);
+}
+
+/*!
+    Returns a copy of the contents of a ByteString token, or the UTF-8 data
+    of a TextString token. Returns an empty array for other tokens.
+
+    \sa rawStringData()
+*/
+QByteArray QCborStreamReader::byteArray() const
+{
+    Q_D(const QCborStreamReader);
+    if (d->type != ByteString && d->type != TextString)
+        return QByteArray();
+    if (d->stringOffset < 0)
+        return d->chunkedString;
+    return QByteArray(d->stringData(), d->stringLength);
+}
+
+/*!
+    Returns the contents of a ByteString token, or the UTF-8 data of a
+    TextString token, without copying them. Returns an empty array for
+    other tokens.
+
+    The returned array refers to the reader's internal buffer, or to the
+    data passed to addData(). It is only valid until the next call to
+    readNext(), addData(), setDevice() or clear(), and must be copied with
+    QByteArray(const char *, int) if it is to be kept for longer.
+
+    \sa byteArray(), text(), QByteArray::fromRawData()
+*/
+QByteArray QCborStreamReader::rawStringData() const
+{
+    Q_D(const QCborStreamReader);
+    if (d->type != ByteString && d->type != TextString)
+        return QByteArray();
+    return QByteArray::fromRawData(d->stringData(), d->stringLength);
+}
+
+/*!
+    Returns the type of the current error, or NoError if no error
+    occurred.
+
+    \sa errorString(), hasError()
+*/
+QCborStreamReader::Error QCborStreamReader::error() const
+{
+    Q_D(const QCborStreamReader);
+    return d->error;
+}
+
+/*!
+    Returns the message for the current error.
+
+    \sa error()
+*/
+QString QCborStreamReader::errorString() const
+{
+    Q_D(const QCborStreamReader);
+    switch (d->error) {
+    case NoError:
+        return QCoreApplication::translate("QCborStreamReader", "No error");
+    case UnexpectedEndOfData:
+        return QCoreApplication::translate("QCborStreamReader", "Unexpected end of data");
+    case IllegalType:
+        return QCoreApplication::translate("QCborStreamReader", "Illegal chunk type in string");
+    case IllegalNumber:
+        return QCoreApplication::translate("QCborStreamReader", "Illegal number encoding");
+    case IllegalSimpleType:
+        return QCoreApplication::translate("QCborStreamReader", "Illegal simple type");
+    case UnexpectedBreak:
+        return QCoreApplication::translate("QCborStreamReader", "Unexpected break");
+    case InvalidUtf8String:
+        return QCoreApplication::translate("QCborStreamReader", "Invalid UTF-8 string");
+    case DataTooLarge:
+        return QCoreApplication::translate("QCborStreamReader", "Data too large");
+    case NestingTooDeep:
+        return QCoreApplication::translate("QCborStreamReader", "Nesting too deep");
+    }
+    return QString();
+}
+
+/*!
+    Returns \c true if an error has occurred, otherwise \c false.
+
+    \sa error()
+*/
+bool QCborStreamReader::hasError() const
+{
+    Q_D(const QCborStreamReader);
+    return d->error != NoError;
+}
+
+class QCborStreamWriterPrivate
+{
+public:
+    struct Container {
+        bool map;
+        bool indefinite;
+        quint64 remaining;      // items left in a definite container, items written to an indefinite one
+    };
+
+    QCborStreamWriterPrivate()
+        : device(0), output(&buffer), hasError(false)
+    {
+    }
+
+    void writeHeader(int major, quint64 value);
+    void writeData(const char *data, int size);
+    bool beginItem(const char *function);
+    void endItem();
+    void endContainer(bool map);
+    void writeBuffer();
+
+    QIODevice *device;
+    QByteArray buffer;
+    QByteArray *output;
+    QVarLengthArray<Container, 32> containers;
+    bool hasError;
+};
+
+void QCborStreamWriterPrivate::writeHeader(int major, quint64 value)
+{
+    uchar header[9];
+    int size;
+    if (value < SmallValueLimit) {
+        header[0] = uchar((major << 5) | value);
+        size = 1;
+    } else if (value <= 0xff) {
+        header[0] = uchar((major << 5) | Value8Bit);
+        header[1] = uchar(value);
+        size = 2;
+    } else if (value <= 0xffff) {
+        header[0] = uchar((major << 5) | Value16Bit);
+        qToBigEndian(quint16(value), header + 1);
+        size = 3;
+    } else if (value <= 0xffffffffU) {
+        header[0] = uchar((major << 5) | Value32Bit);
+        qToBigEndian(quint32(value), header + 1);
+        size = 5;
+    } else {
+        header[0] = uchar((major << 5) | Value64Bit);
+        qToBigEndian(value, header + 1);
+        size = 9;
+    }
+    output->append(reinterpret_cast<const char *>(header), size);
+}
+
+// large strings are passed to the device directly instead of being copied
+void QCborStreamWriterPrivate::writeData(const char *data, int size)
+{
+    if (device && size >= streamChunkSize) {
+        writeBuffer();
+        if (device->write(data, size) != size)
+            hasError = true;
+    } else {
+        output->append(data, size);
+    }
+}
+
+bool QCborStreamWriterPrivate::beginItem(const char *function)
+{
+    if (containers.isEmpty())
+        return true;
+    Container &container = containers.last();
+    if (container.indefinite) {
+        ++container.remaining;
+        return true;
+    }
+    if (container.remaining == 0) {
+        qWarning("QCborStreamWriter::%s: Too many items in the %s", function, container.map ? "map" : "array");
+        return false;
+    }
+    --container.remaining;
+    return true;
+}
+
+void QCborStreamWriterPrivate::endItem()
+{
+    if (device && buffer.size() >= streamChunkSize)
+        writeBuffer();
+}
+
+void QCborStreamWriterPrivate::endContainer(bool map)
+{
+    const char *function = map ? "writeEndMap" : "writeEndArray";
+    if (containers.isEmpty() || containers.last().map != map) {
+        qWarning("QCborStreamWriter::%s: Not inside a%s", function, map ? " map" : "n array");
+        return;
+    }
+    const Container container = containers.last();
+    if (container.indefinite) {
+        if (map && (container.remaining & 1)) {
+            qWarning("QCborStreamWriter::%s: No value written for the last key", function);
+            return;
+        }
+        *output += char(BreakByte);
+    } else if (container.remaining) {
+        qWarning("QCborStreamWriter::%s: %llu items missing", function, container.remaining);
+        return;
+    }
+    containers.removeLast();
+    endItem();
+}
+
+void QCborStreamWriterPrivate::writeBuffer()
+{
+    if (!device || buffer.isEmpty())
+        return;
+    if (device->write(buffer) != buffer.size())
+        hasError = true;
+    buffer.resize(0);
+}
+
+/*!
+    \class QCborStreamWriter
+    \inmodule QtCore
+    \ingroup io
+    \reentrant
+    \since 5.10
+
+    \brief The QCborStreamWriter class writes CBOR data item by item.
+
+    QCborStreamWriter writes data in the Concise Binary Object
+    Representation (CBOR, RFC 7049), directly to a QIODevice (see
+    setDevice()) or appended to a QByteArray. Only a small buffer is held
+    before the data is passed on to the device, and large strings are
+    passed on without being copied.
+
+    Arrays and maps are opened with writeStartArray() and writeStartMap()
+    and closed with writeEndArray() and writeEndMap(). If the number of
+    entries is passed when opening them, it is encoded in the data, which
+    makes it a little more compact and lets the reader allocate memory in
+    advance; otherwise the end is marked with a break. Inside a map, keys
+    and values are written in turn; keys may be of any type, though text
+    strings are the most portable choice.
+
+    \snippet code/src_corelib_serialization_qcborstream.cpp 1
+
+    Integers are always written in the shortest encoding. Floating point
+    numbers are written in single precision if that does not lose
+    precision. writeJsonValue() and writeVariant() write complete values,
+    including the contents of arrays, objects and maps.
+
+    \sa QCborStreamReader, QJsonStreamWriter, QDataStream
+*/
+
+/*!
+    Constructs a stream writer without a device.
+
+    \sa setDevice()
+*/
+QCborStreamWriter::QCborStreamWriter()
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+}
+
+/*!
+    Constructs a stream writer that writes to \a device.
+
+    \sa setDevice()
+*/
+QCborStreamWriter::QCborStreamWriter(QIODevice *device)
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Constructs a stream writer that appends to \a array.
+*/
+QCborStreamWriter::QCborStreamWriter(QByteArray *array)
+    : d_ptr(new QCborStreamWriterPrivate)
+{
+    Q_D(QCborStreamWriter);
+    d->output = array;
+}
+
+/*!
+    Writes out any buffered data and destroys the writer.
+*/
+QCborStreamWriter::~QCborStreamWriter()
+{
+    Q_D(QCborStreamWriter);
+    d->writeBuffer();
+}
+
+/*!
+    Sets the current device to \a device. Data still buffered for the
+    previous device is written to it first. The writer does not take
+    ownership of the device.
+
+    \sa device()
+*/
+void QCborStreamWriter::setDevice(QIODevice *device)
+{
+    Q_D(QCborStreamWriter);
+    d->writeBuffer();
+    d->device = device;
+    d->output = &d->buffer;
+    if (device)
+        d->buffer.reserve(2*streamChunkSize);
+}
+
+/*!
+    Returns the current device, or 0 if no device is set.
+
+    \sa setDevice()
+*/
+QIODevice *QCborStreamWriter::device() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->device;
+}
+
+/*!
+    Writes the unsigned integer \a value.
+*/
+void QCborStreamWriter::writeUnsignedInteger(quint64 value)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeUnsignedInteger"))
+        return;
+    d->writeHeader(UnsignedIntegerType, value);
+    d->endItem();
+}
+
+/*!
+    Writes the integer \a value.
+*/
+void QCborStreamWriter::writeInteger(qint64 value)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeInteger"))
+        return;
+    if (value < 0)
+        d->writeHeader(NegativeIntegerType, quint64(-1 - value));
+    else
+        d->writeHeader(UnsignedIntegerType, quint64(value));
+    d->endItem();
+}
+
+/*!
+    Writes the floating point number \a value. It is written in single
+    precision if that represents it exactly, otherwise in double
+    precision. Infinite values and NaN are written in half precision.
+*/
+void QCborStreamWriter::writeDouble(double value)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeDouble"))
+        return;
+    uchar data[9];
+    int size;
+    if (qIsNaN(value) || qIsInf(value)) {
+        data[0] = (SimpleTypesType << 5) | HalfPrecisionFloat;
+        qToBigEndian(quint16(qIsNaN(value) ? 0x7e00 : value < 0 ? 0xfc00 : 0x7c00), data + 1);
+        size = 3;
+    } else if (qAbs(value) <= std::numeric_limits<float>::max() && double(float(value)) == value) {
+        // converting a double outside of float's range is undefined
+        const float f = float(value);
+        quint32 bits;
+        memcpy(&bits, &f, sizeof(bits));
+        data[0] = (SimpleTypesType << 5) | SinglePrecisionFloat;
+        qToBigEndian(bits, data + 1);
+        size = 5;
+    } else {
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        data[0] = (SimpleTypesType << 5) | DoublePrecisionFloat;
+        qToBigEndian(bits, data + 1);
+        size = 9;
+    }
+    d->output->append(reinterpret_cast<const char *>(data), size);
+    d->endItem();
+}
+
+/*!
+    Writes the boolean \a value.
+*/
+void QCborStreamWriter::writeBool(bool value)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeBool"))
+        return;
+    *d->output += char((SimpleTypesType << 5) | (value ? TrueValue : FalseValue));
+    d->endItem();
+}
+
+/*!
+    Writes \c null.
+*/
+void QCborStreamWriter::writeNull()
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeNull"))
+        return;
+    *d->output += char((SimpleTypesType << 5) | NullValue);
+    d->endItem();
+}
+
+/*!
+    Writes \c undefined.
+*/
+void QCborStreamWriter::writeUndefined()
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeUndefined"))
+        return;
+    *d->output += char((SimpleTypesType << 5) | UndefinedValue);
+    d->endItem();
+}
+
+/*!
+    Writes the simple type \a type. The values 20 to 31 are reserved for
+    booleans, \c null, \c undefined, floating point numbers and the break
+    and cannot be written with this function.
+*/
+void QCborStreamWriter::writeSimpleType(quint8 type)
+{
+    Q_D(QCborStreamWriter);
+    if (type >= FalseValue && type < 32) {
+        qWarning("QCborStreamWriter::writeSimpleType: Reserved simple type %u", uint(type));
+        return;
+    }
+    if (!d->beginItem("writeSimpleType"))
+        return;
+    d->writeHeader(SimpleTypesType, type);
+    d->endItem();
+}
+
+/*!
+    Writes \a tag. The item it tags has to be written next.
+*/
+void QCborStreamWriter::writeTag(quint64 tag)
+{
+    Q_D(QCborStreamWriter);
+    d->writeHeader(TagType, tag);
+}
+
+/*!
+    Writes \a value as a text string.
+*/
+void QCborStreamWriter::writeTextString(const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    writeTextString(utf8.constData(), utf8.size());
+}
+
+/*!
+    \overload
+
+    Writes the \a size bytes of UTF-8 text at \a utf8 as a text string.
+    The text is not checked to be valid UTF-8.
+*/
+void QCborStreamWriter::writeTextString(const char *utf8, int size)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeTextString"))
+        return;
+    d->writeHeader(TextStringType, quint64(size));
+    d->writeData(utf8, size);
+    d->endItem();
+}
+
+/*!
+    Writes \a value as a byte string.
+*/
+void QCborStreamWriter::writeByteString(const QByteArray &value)
+{
+    writeByteString(value.constData(), value.size());
+}
+
+/*!
+    \overload
+
+    Writes the \a size bytes at \a data as a byte string.
+*/
+void QCborStreamWriter::writeByteString(const char *data, int size)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeByteString"))
+        return;
+    d->writeHeader(ByteStringType, quint64(size));
+    d->writeData(data, size);
+    d->endItem();
+}
+
+/*!
+    Writes the start of an array whose end is marked by writeEndArray().
+
+    \sa writeEndArray()
+*/
+void QCborStreamWriter::writeStartArray()
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeStartArray"))
+        return;
+    *d->output += char((ArrayType << 5) | IndefiniteLength);
+    const QCborStreamWriterPrivate::Container container = { false, true, 0 };
+    d->containers.append(container);
+}
+
+/*!
+    \overload
+
+    Writes the start of an array of \a length items. Exactly \a length
+    items have to be written before writeEndArray() is called.
+*/
+void QCborStreamWriter::writeStartArray(quint64 length)
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeStartArray"))
+        return;
+    d->writeHeader(ArrayType, length);
+    const QCborStreamWriterPrivate::Container container = { false, false, length };
+    d->containers.append(container);
+}
+
+/*!
+    Closes the array opened by the matching writeStartArray().
+*/
+void QCborStreamWriter::writeEndArray()
+{
+    Q_D(QCborStreamWriter);
+    d->endContainer(false);
+}
+
+/*!
+    Writes the start of a map whose end is marked by writeEndMap().
+
+    \sa writeEndMap()
+*/
+void QCborStreamWriter::writeStartMap()
+{
+    Q_D(QCborStreamWriter);
+    if (!d->beginItem("writeStartMap"))
+        return;
+    *d->output += char((MapType << 5) | IndefiniteLength);
+    const QCborStreamWriterPrivate::Container container = { true, true, 0 };
+    d->containers.append(container);
+}
+
+/*!
+    \overload
+
+    Writes the start of a map of \a length entries. Exactly \a length keys
+    and \a length values have to be written before writeEndMap() is
+    called.
+*/
+void QCborStreamWriter::writeStartMap(quint64 length)
+{
+    Q_D(QCborStreamWriter);
+    if (length > std::numeric_limits<quint64>::max() / 2) {
+        qWarning("QCborStreamWriter::writeStartMap: Too many entries");
+        return;
+    }
+    if (!d->beginItem("writeStartMap"))
+        return;
+    d->writeHeader(MapType, length);
+    const QCborStreamWriterPrivate::Container container = { true, false, 2 * length };
+    d->containers.append(container);
+}
+
+/*!
+    Closes the map opened by the matching writeStartMap().
+*/
+void QCborStreamWriter::writeEndMap()
+{
+    Q_D(QCborStreamWriter);
+    d->endContainer(true);
+}
+
+/*!
+    Writes \a value, including all contents if it is an object or an
+    array. Numbers that are integers are written as integers. Objects are
+    written as maps with text string keys, and an undefined value as
+    \c undefined.
+
+    \sa QCborStreamReader::readCurrentJsonValue()
+*/
+void QCborStreamWriter::writeJsonValue(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Null:
+        writeNull();
+        break;
+    case QJsonValue::Bool:
+        writeBool(value.toBool());
+        break;
+    case QJsonValue::Double: {
+        // integers up to 2^53 are exact in a double
+        const double d = value.toDouble();
+        if (d == floor(d) && fabs(d) <= 9007199254740992.)
+            writeInteger(qint64(d));
+        else
+            writeDouble(d);
+        break;
+    }
+    case QJsonValue::String:
+        writeTextString(value.toString());
+        break;
+    case QJsonValue::Array: {
+        const QJsonArray array = value.toArray();
+        writeStartArray(quint64(array.size()));
+        for (const QJsonValue &v : array)
+            writeJsonValue(v);
+        writeEndArray();
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonObject object = value.toObject();
+        writeStartMap(quint64(object.size()));
+        for (QJsonObject::const_iterator it = object.constBegin(), end = object.constEnd(); it != end; ++it) {
+            writeTextString(it.key());
+            writeJsonValue(it.value());
+        }
+        writeEndMap();
+        break;
+    }
+    case QJsonValue::Undefined:
+        writeUndefined();
+        break;
+    }
+}
+
+/*!
+    Writes \a value, including all contents if it is a list or a map.
+
+    Integers, booleans, floating point numbers, strings and byte arrays
+    are written as the corresponding CBOR types, QVariantList and
+    QStringList as arrays, and QVariantMap and QVariantHash as maps with
+    text string keys. QDateTime, QUrl and QUuid are written as tagged
+    items as described in RFC 7049, and JSON types as with
+    writeJsonValue(). A QVariant holding a \c nullptr is written as \c
+    null, an invalid one as \c undefined. Other types are written as text
+    strings if they can be converted to a QString, and as \c undefined
+    otherwise.
+
+    \sa QCborStreamReader::readCurrentVariant()
+*/
+void QCborStreamWriter::writeVariant(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::UnknownType:
+        writeUndefined();
+        break;
+    case QMetaType::Nullptr:
+        writeNull();
+        break;
+    case QMetaType::Bool:
+        writeBool(value.toBool());
+        break;
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+    case QMetaType::SChar:
+        writeInteger(value.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+    case QMetaType::UChar:
+        writeUnsignedInteger(value.toULongLong());
+        break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        writeDouble(value.toDouble());
+        break;
+    case QMetaType::QString:
+        writeTextString(value.toString());
+        break;
+    case QMetaType::QByteArray:
+        writeByteString(value.toByteArray());
+        break;
+    case QMetaType::QStringList: {
+        const QStringList list = value.toStringList();
+        writeStartArray(quint64(list.size()));
+        for (const QString &s : list)
+            writeTextString(s);
+        writeEndArray();
+        break;
+    }
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        writeStartArray(quint64(list.size()));
+        for (const QVariant &v : list)
+            writeVariant(v);
+        writeEndArray();
+        break;
+    }
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        writeStartMap(quint64(map.size()));
+        for (QVariantMap::const_iterator it = map.constBegin(), end = map.constEnd(); it != end; ++it) {
+            writeTextString(it.key());
+            writeVariant(it.value());
+        }
+        writeEndMap();
+        break;
+    }
+    case QMetaType::QVariantHash: {
+        const QVariantHash hash = value.toHash();
+        writeStartMap(quint64(hash.size()));
+        for (QVariantHash::const_iterator it = hash.constBegin(), end = hash.constEnd(); it != end; ++it) {
+            writeTextString(it.key());
+            writeVariant(it.value());
+        }
+        writeEndMap();
+        break;
+    }
+    case QMetaType::QDateTime:
+        writeTag(DateTimeStringTag);
+        writeTextString(value.toDateTime().toString(Qt::ISODateWithMs));
+        break;
+    case QMetaType::QUrl:
+        writeTag(UrlTag);
+        writeTextString(value.toUrl().toString(QUrl::FullyEncoded));
+        break;
+    case QMetaType::QUuid:
+        writeTag(UuidTag);
+        writeByteString(value.toUuid().toRfc4122());
+        break;
+    case QMetaType::QJsonValue:
+        writeJsonValue(value.toJsonValue());
+        break;
+    case QMetaType::QJsonObject:
+        writeJsonValue(value.toJsonObject());
+        break;
+    case QMetaType::QJsonArray:
+        writeJsonValue(value.toJsonArray());
+        break;
+    case QMetaType::QJsonDocument: {
+        const QJsonDocument document = value.toJsonDocument();
+        if (document.isArray())
+            writeJsonValue(document.array());
+        else if (document.isObject())
+            writeJsonValue(document.object());
+        else
+            writeNull();
+        break;
+    }
+    default:
+        if (value.canConvert<QString>())
+            writeTextString(value.toString());
+        else
+            writeUndefined();
+        break;
+    }
+}
+
+/*!
+    Returns the number of arrays and maps that are currently open.
+*/
+int QCborStreamWriter::depth() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->containers.size();
+}
+
+/*!
+    Writes any buffered data to the device(). The data is also written
+    when enough of it has been collected, when the device is changed and
+    when the writer is destroyed.
+*/
+void QCborStreamWriter::flush()
+{
+    Q_D(QCborStreamWriter);
+    d->writeBuffer();
+}
+
+/*!
+    Returns \c true if writing to the device() failed, otherwise \c false.
+*/
+bool QCborStreamWriter::hasError() const
+{
+    Q_D(const QCborStreamWriter);
+    return d->hasError;
+}
+
+QT_END_NAMESPACE
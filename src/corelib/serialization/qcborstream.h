@@ -0,0 +1,180 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QCBORSTREAM_H
+#define QCBORSTREAM_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qjsonvalue.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+class QCborStreamReaderPrivate;
+class Q_CORE_EXPORT QCborStreamReader
+{
+public:
+    enum TokenType {
+        NoToken = 0,
+        Invalid,
+        UnsignedInteger,
+        NegativeInteger,
+        ByteString,
+        TextString,
+        StartArray,
+        EndArray,
+        StartMap,
+        EndMap,
+        Tag,
+        SimpleType,
+        Bool,
+        Null,
+        Undefined,
+        Double
+    };
+
+    enum Error {
+        NoError = 0,
+        UnexpectedEndOfData,
+        IllegalType,
+        IllegalNumber,
+        IllegalSimpleType,
+        UnexpectedBreak,
+        InvalidUtf8String,
+        DataTooLarge,
+        NestingTooDeep
+    };
+
+    QCborStreamReader();
+    explicit QCborStreamReader(QIODevice *device);
+    explicit QCborStreamReader(const QByteArray &data);
+    ~QCborStreamReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+    void addData(const QByteArray &data);
+    void clear();
+
+    bool atEnd() const;
+    TokenType readNext();
+
+    void skipCurrentValue();
+    QJsonValue readCurrentJsonValue();
+    QVariant readCurrentVariant();
+
+    TokenType tokenType() const;
+    int depth() const;
+    qint64 offset() const;
+
+    bool isLengthKnown() const;
+    quint64 length() const;
+
+    quint64 toUnsignedInteger() const;
+    qint64 toInteger() const;
+    double toDouble() const;
+    bool toBool() const;
+    quint64 tag() const;
+    quint8 simpleType() const;
+    QString text() const;
+    QByteArray byteArray() const;
+    QByteArray rawStringData() const;
+
+    Error error() const;
+    QString errorString() const;
+    bool hasError() const;
+
+private:
+    Q_DISABLE_COPY(QCborStreamReader)
+    Q_DECLARE_PRIVATE(QCborStreamReader)
+    QScopedPointer<QCborStreamReaderPrivate> d_ptr;
+};
+
+class QCborStreamWriterPrivate;
+class Q_CORE_EXPORT QCborStreamWriter
+{
+public:
+    QCborStreamWriter();
+    explicit QCborStreamWriter(QIODevice *device);
+    explicit QCborStreamWriter(QByteArray *array);
+    ~QCborStreamWriter();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void writeUnsignedInteger(quint64 value);
+    void writeInteger(qint64 value);
+    void writeDouble(double value);
+    void writeBool(bool value);
+    void writeNull();
+    void writeUndefined();
+    void writeSimpleType(quint8 type);
+    void writeTag(quint64 tag);
+
+    void writeTextString(const QString &value);
+    void writeTextString(const char *utf8, int size);
+    void writeByteString(const QByteArray &value);
+    void writeByteString(const char *data, int size);
+
+    void writeStartArray();
+    void writeStartArray(quint64 length);
+    void writeEndArray();
+    void writeStartMap();
+    void writeStartMap(quint64 length);
+    void writeEndMap();
+
+    void writeJsonValue(const QJsonValue &value);
+    void writeVariant(const QVariant &value);
+
+    int depth() const;
+    void flush();
+    bool hasError() const;
+
+private:
+    Q_DISABLE_COPY(QCborStreamWriter)
+    Q_DECLARE_PRIVATE(QCborStreamWriter)
+    QScopedPointer<QCborStreamWriterPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QCBORSTREAM_H
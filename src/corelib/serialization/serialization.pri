@@ -0,0 +1,7 @@
+# Qt data serialization formats
+
+HEADERS += \
+    serialization/qcborstream.h
+
+SOURCES += \
+    serialization/qcborstream.cpp
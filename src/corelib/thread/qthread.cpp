@@ -780,6 +780,9 @@ QThread::QThread(QThreadPrivate &dd, QObject *parent)
 
     Returns a pointer to the event dispatcher object for the thread. If no event
     dispatcher exists for the thread, this function returns 0.
+
+    The load of the event loop of the thread can be monitored with
+    QAbstractEventDispatcher::statistics().
 */
 QAbstractEventDispatcher *QThread::eventDispatcher() const
 {
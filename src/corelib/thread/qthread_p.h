@@ -85,11 +85,12 @@ public:
     QObject *receiver;
     QEvent *event;
     int priority;
+    qint64 postTime; // QEventDispatcherStatisticsRecorder::currentTime() when posted
     inline QPostEvent()
-        : receiver(0), event(0), priority(0)
+        : receiver(0), event(0), priority(0), postTime(0)
     { }
-    inline QPostEvent(QObject *r, QEvent *e, int p)
-        : receiver(r), event(e), priority(p)
+    inline QPostEvent(QObject *r, QEvent *e, int p, qint64 t = 0)
+        : receiver(r), event(e), priority(p), postTime(t)
     { }
 };
 Q_DECLARE_TYPEINFO(QPostEvent, Q_MOVABLE_TYPE);
@@ -40,6 +40,7 @@
 #include "qthreadpool.h"
 #include "qthreadpool_p.h"
 #include "qelapsedtimer.h"
+#include <private/qtrace_p.h>
 
 #include <algorithm>
 
@@ -96,7 +97,9 @@ void QThreadPoolThread::run()
 #ifndef QT_NO_EXCEPTIONS
                 try {
 #endif
+                    Q_TRACE(QThreadPool_runnable_entry, r);
                     r->run();
+                    Q_TRACE(QThreadPool_runnable_exit);
 #ifndef QT_NO_EXCEPTIONS
                 } catch (...) {
                     qWarning("Qt Concurrent has caught an exception thrown from a worker thread.\n"
@@ -371,7 +374,9 @@ void QThreadPoolPrivate::stealAndRunRunnable(QRunnable *runnable)
         return;
     const bool del = runnable->autoDelete() && !runnable->ref; // tryTake already deref'ed
 
+    Q_TRACE(QThreadPool_runnable_entry, runnable);
     runnable->run();
+    Q_TRACE(QThreadPool_runnable_exit);
 
     if (del) {
         delete runnable;
@@ -475,6 +480,8 @@ void QThreadPool::start(QRunnable *runnable, int priority)
     if (!runnable)
         return;
 
+    Q_TRACE(QThreadPool_start, this, runnable);
+
     Q_D(QThreadPool);
     QMutexLocker locker(&d->mutex);
     if (!d->tryStart(runnable)) {
@@ -513,6 +520,7 @@ bool QThreadPool::tryStart(QRunnable *runnable)
     if (d->allThreads.isEmpty() == false && d->activeThreadCount() >= d->maxThreadCount)
         return false;
 
+    Q_TRACE(QThreadPool_start, this, runnable);
     return d->tryStart(runnable);
 }
 
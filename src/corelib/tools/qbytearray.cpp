@@ -4433,37 +4433,49 @@ static void q_fromPercentEncoding(QByteArray *ba, char percent)
 
     char *data = ba->data();
     const char *inputPtr = data;
+    const char *const end = data + ba->size();
 
-    int i = 0;
-    int len = ba->count();
-    int outlen = 0;
     int a, b;
-    char c;
-    while (i < len) {
-        c = inputPtr[i];
-        if (c == percent && i + 2 < len) {
-            a = inputPtr[++i];
-            b = inputPtr[++i];
+    while (inputPtr != end) {
+        // copy everything up to the next percent: short runs byte by byte,
+        // longer ones in one go
+        const char *shortEnd = inputPtr + qMin<qptrdiff>(end - inputPtr, 16);
+        while (inputPtr != shortEnd && *inputPtr != percent)
+            *data++ = *inputPtr++;
+        if (inputPtr == shortEnd && inputPtr != end) {
+            const char *next = static_cast<const char *>(memchr(inputPtr, percent, end - inputPtr));
+            if (!next)
+                next = end;
+            memmove(data, inputPtr, next - inputPtr);
+            data += next - inputPtr;
+            inputPtr = next;
+        }
+        if (inputPtr == end)
+            break;
 
-            if (a >= '0' && a <= '9') a -= '0';
-            else if (a >= 'a' && a <= 'f') a = a - 'a' + 10;
-            else if (a >= 'A' && a <= 'F') a = a - 'A' + 10;
+        if (end - inputPtr < 3) {
+            // too close to the end to be a percent-encoded sequence
+            *data++ = *inputPtr++;
+            continue;
+        }
 
-            if (b >= '0' && b <= '9') b -= '0';
-            else if (b >= 'a' && b <= 'f') b  = b - 'a' + 10;
-            else if (b >= 'A' && b <= 'F') b  = b - 'A' + 10;
+        a = inputPtr[1];
+        b = inputPtr[2];
+        inputPtr += 3;
 
-            *data++ = (char)((a << 4) | b);
-        } else {
-            *data++ = c;
-        }
+        if (a >= '0' && a <= '9') a -= '0';
+        else if (a >= 'a' && a <= 'f') a = a - 'a' + 10;
+        else if (a >= 'A' && a <= 'F') a = a - 'A' + 10;
+
+        if (b >= '0' && b <= '9') b -= '0';
+        else if (b >= 'a' && b <= 'f') b  = b - 'a' + 10;
+        else if (b >= 'A' && b <= 'F') b  = b - 'A' + 10;
 
-        ++i;
-        ++outlen;
+        *data++ = (char)((a << 4) | b);
     }
 
-    if (outlen != len)
-        ba->truncate(outlen);
+    if (data != end)
+        ba->truncate(data - ba->constData());
 }
 
 void q_fromPercentEncoding(QByteArray *ba)
@@ -51,6 +51,8 @@
 #endif
 #include "qregexp.h"
 #include "qdebug.h"
+#include "qthreadstorage.h"
+#include "private/qlocale_p.h"
 #ifndef Q_OS_WIN
 #include <locale.h>
 #endif
@@ -242,15 +244,40 @@ static ParsedRfcDateTime rfcDateImpl(const QString &s)
 }
 #endif // QT_NO_DATESTRING
 
+// Write the non-negative value in decimal, zero-padded to at least width digits
+template <typename Char>
+static inline Char *writeDigits(Char *p, int value, int width)
+{
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n < width)
+        digits[n++] = '0';
+    while (n)
+        *p++ = Char(digits[--n]);
+    return p;
+}
+
+// Write offset in [+-]HH:mm format
+static char *writeOffset(char *p, int offset, bool withColon)
+{
+    *p++ = offset >= 0 ? '+' : '-';
+    p = writeDigits(p, qAbs(offset) / SECS_PER_HOUR, 2);
+    if (withColon)
+        *p++ = ':';
+    return writeDigits(p, (qAbs(offset) / 60) % 60, 2);
+}
+
 // Return offset in [+-]HH:mm format
 static QString toOffsetString(Qt::DateFormat format, int offset)
 {
-    return QString::asprintf("%c%02d%s%02d",
-                             offset >= 0 ? '+' : '-',
-                             qAbs(offset) / SECS_PER_HOUR,
-                             // Qt::ISODate puts : between the hours and minutes, but Qt:TextDate does not:
-                             format == Qt::TextDate ? "" : ":",
-                             (qAbs(offset) / 60) % 60);
+    char buffer[16];
+    // Qt::ISODate puts : between the hours and minutes, but Qt:TextDate does not:
+    const char *end = writeOffset(buffer, offset, format != Qt::TextDate);
+    return QString::fromLatin1(buffer, int(end - buffer));
 }
 
 // Parse offset in [+-]HH[[:]mm] format
@@ -298,6 +325,519 @@ static int fromOffsetString(const QStringRef &offsetString, bool *valid) Q_DECL_
     return sign * ((hour * 60) + minute) * 60;
 }
 
+#ifndef QT_NO_DATESTRING
+/*****************************************************************************
+  ISO 8601 fast paths and compiled format patterns
+ *****************************************************************************/
+
+static inline uint charValue(char c) { return uchar(c); }
+static inline uint charValue(QChar c) { return c.unicode(); }
+
+// Read count decimal digits; returns -1 if any of them is not a digit
+template <typename Char>
+static inline int readDigits(const Char *p, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        const uint digit = charValue(p[i]) - '0';
+        if (digit > 9)
+            return -1;
+        value = value * 10 + int(digit);
+    }
+    return value;
+}
+
+static inline bool isAsciiDigit(uint c)
+{
+    return c - '0' < 10;
+}
+
+// Exact powers of ten, so that the millisecond rounding below matches
+// fromIsoTimeString(), which uses std::pow()
+static const double powersOfTen[] = { 1, 10, 100, 1000, 10000 };
+
+/*
+    Parses the canonical ISO 8601 / RFC 3339 forms of a date-time:
+
+        YYYY-MM-DD[(T|t| )hh:mm[:ss[(.|,)f...]][Z|z|(+|-)hh[[:]mm]]]
+
+    Anything else, including out-of-range fields, makes this return false so
+    that the caller can fall back to the general parser, which is more
+    lenient; whenever this returns true the result is the one the general
+    parser would have produced.
+*/
+template <typename Char>
+static bool fromIsoDateTimeFast(const Char *s, int size, QDateTime *result)
+{
+    if (size < 10 || charValue(s[4]) != '-' || charValue(s[7]) != '-')
+        return false;
+    const int year = readDigits(s, 4);
+    const int month = readDigits(s + 5, 2);
+    const int day = readDigits(s + 8, 2);
+    if (year <= 0 || month < 0 || day < 0 || !QDate::isValid(year, month, day))
+        return false;
+    QDate date(year, month, day);
+    if (size == 10) {
+        *result = QDateTime(date);
+        return true;
+    }
+
+    const uint separator = charValue(s[10]);
+    if (separator != 'T' && separator != 't' && separator != ' ')
+        return false;
+
+    const Char *p = s + 11;
+    const Char *const end = s + size;
+    if (end - p < 5 || charValue(p[2]) != ':')
+        return false;
+    int hour = readDigits(p, 2);
+    const int minute = readDigits(p + 3, 2);
+    if (hour < 0 || minute < 0)
+        return false;
+    p += 5;
+
+    int second = 0;
+    int msec = 0;
+    if (p != end && charValue(*p) == ':') {
+        if (end - p < 3 || (second = readDigits(p + 1, 2)) < 0)
+            return false;
+        p += 3;
+        if (p != end && (charValue(*p) == '.' || charValue(*p) == ',')) {
+            const Char *fraction = ++p;
+            while (p != end && isAsciiDigit(charValue(*p)))
+                ++p;
+            const int digits = qMin(int(p - fraction), 4);
+            if (digits == 0)
+                return false;
+            const double secondFraction(readDigits(fraction, digits) / powersOfTen[digits]);
+            msec = qMin(qRound(secondFraction * 1000.0), 999);
+        }
+    }
+
+    Qt::TimeSpec spec = Qt::LocalTime;
+    int offset = 0;
+    if (p != end) {
+        const uint c = charValue(*p);
+        if ((c == 'Z' || c == 'z') && end - p == 1) {
+            spec = Qt::UTC;
+        } else if (c == '+' || c == '-') {
+            int offsetMinutes = 0;
+            switch (end - p) {
+            case 3: // [+-]hh
+                break;
+            case 5: // [+-]hhmm
+                offsetMinutes = readDigits(p + 3, 2);
+                break;
+            case 6: // [+-]hh:mm
+                offsetMinutes = charValue(p[3]) == ':' ? readDigits(p + 4, 2) : -1;
+                break;
+            default:
+                return false;
+            }
+            const int offsetHours = readDigits(p + 1, 2);
+            if (offsetHours < 0 || offsetMinutes < 0 || offsetMinutes > 59)
+                return false;
+            offset = (offsetHours * 60 + offsetMinutes) * 60;
+            if (c == '-')
+                offset = -offset;
+            spec = Qt::OffsetFromUTC;
+        } else {
+            return false;
+        }
+    }
+
+    // ISO 8601 (section 4.2.3) says that 24:00 is equivalent to 00:00 the next day.
+    if (hour == 24 && minute == 0 && second == 0 && msec == 0) {
+        hour = 0;
+        date = date.addDays(1);
+    }
+    if (!QTime::isValid(hour, minute, second, msec))
+        return false;
+
+    *result = QDateTime(date, QTime(hour, minute, second, msec), spec, offset);
+    return true;
+}
+
+// Write YYYY-MM-DD; the caller makes sure that 0 <= year <= 9999
+static char *writeIsoDate(char *p, int year, int month, int day)
+{
+    p = writeDigits(p, year, 4);
+    *p++ = '-';
+    p = writeDigits(p, month, 2);
+    *p++ = '-';
+    return writeDigits(p, day, 2);
+}
+
+// Write hh:mm:ss[.zzz]
+static char *writeIsoTime(char *p, const QTime &time, bool withMs)
+{
+    p = writeDigits(p, time.hour(), 2);
+    *p++ = ':';
+    p = writeDigits(p, time.minute(), 2);
+    *p++ = ':';
+    p = writeDigits(p, time.second(), 2);
+    if (withMs) {
+        *p++ = '.';
+        p = writeDigits(p, time.msec(), 3);
+    }
+    return p;
+}
+
+namespace {
+struct QDateTimeFormatCache
+{
+    enum { Size = 8 };
+    QDateTimeFormatPattern entries[Size];
+    int next;
+
+    QDateTimeFormatCache() : next(0) {}
+};
+}
+
+#ifndef QT_NO_THREAD
+Q_GLOBAL_STATIC(QThreadStorage<QDateTimeFormatCache *>, dateTimeFormatCaches)
+#endif
+
+/*
+    Returns the compiled form of \a format for \a mode, compiling it if it is
+    not in this thread's cache.  The pointer is valid until the next call in
+    the same thread.
+*/
+const QDateTimeFormatPattern *QDateTimeFormatPattern::lookup(const QString &format, Mode mode)
+{
+#ifndef QT_NO_THREAD
+    QThreadStorage<QDateTimeFormatCache *> *storage = dateTimeFormatCaches();
+    if (!storage) {
+        static const QDateTimeFormatPattern unusable;
+        return &unusable;
+    }
+    QDateTimeFormatCache *cache = storage->localData();
+    if (!cache) {
+        cache = new QDateTimeFormatCache;
+        storage->setLocalData(cache);
+    }
+#else
+    static QDateTimeFormatCache staticCache;
+    QDateTimeFormatCache *cache = &staticCache;
+#endif
+
+    for (const QDateTimeFormatPattern &pattern : cache->entries) {
+        if (pattern.mode == mode && pattern.format == format)
+            return &pattern;
+    }
+
+    QDateTimeFormatPattern &pattern = cache->entries[cache->next];
+    cache->next = (cache->next + 1) % QDateTimeFormatCache::Size;
+    pattern.format = format;
+    pattern.mode = mode;
+    pattern.usable = true;
+    pattern.sections.clear();
+    pattern.literals.clear();
+    if (mode & Parse)
+        pattern.compileForParsing();
+    else
+        pattern.compileForFormatting();
+    if (!pattern.usable) {
+        pattern.sections.clear();
+        pattern.literals.clear();
+    }
+    return &pattern;
+}
+
+void QDateTimeFormatPattern::appendLiteral(const QString &text)
+{
+    if (text.isEmpty())
+        return;
+    if (!sections.isEmpty() && sections.last().type == Literal) {
+        sections.last().width += text.size();
+    } else {
+        const Section section = { Literal, text.size(), literals.size() };
+        sections.append(section);
+    }
+    literals += text;
+}
+
+void QDateTimeFormatPattern::appendSection(SectionType type, int width)
+{
+    const Section section = { type, width, 0 };
+    sections.append(section);
+}
+
+/*
+    Mirrors the interpretation of the format in
+    QLocalePrivate::dateTimeToString(); gives up on sections that depend on
+    the locale's names, which are left to that function.
+*/
+void QDateTimeFormatPattern::compileForFormatting()
+{
+    int i = 0;
+    while (i < format.size()) {
+        if (format.at(i).unicode() == '\'') {
+            appendLiteral(qt_readEscapedFormatString(format, &i));
+            continue;
+        }
+
+        const QChar c = format.at(i);
+        int repeat = qt_repeatCount(format, i);
+        bool used = false;
+        if (mode & FormatDate) {
+            switch (c.unicode()) {
+            case 'y':
+                used = true;
+                if (repeat >= 4) {
+                    repeat = 4;
+                    appendSection(Year, 4);
+                } else if (repeat >= 2) {
+                    repeat = 2;
+                    appendSection(Year2Digits, 2);
+                } else {
+                    appendLiteral(c);
+                }
+                break;
+            case 'M':
+            case 'd':
+                used = true;
+                repeat = qMin(repeat, 4);
+                if (repeat > 2) {
+                    usable = false;
+                    return;
+                }
+                appendSection(c.unicode() == 'M' ? Month : Day, repeat);
+                break;
+            default:
+                break;
+            }
+        }
+        if (!used && (mode & FormatTime)) {
+            switch (c.unicode()) {
+            case 'h':
+            case 'H':
+            case 'm':
+            case 's':
+                used = true;
+                repeat = qMin(repeat, 2);
+                appendSection(c.unicode() == 'm' ? Minute : c.unicode() == 's' ? Second : Hour,
+                              repeat);
+                break;
+            case 'z':
+                used = true;
+                repeat = repeat >= 3 ? 3 : 1;
+                appendSection(repeat == 3 ? MSec : MSecTrimmed, 3);
+                break;
+            case 'a':
+            case 'A':
+            case 't':
+                usable = false;
+                return;
+            default:
+                break;
+            }
+        }
+        if (!used)
+            appendLiteral(QString(repeat, c));
+        i += repeat;
+    }
+}
+
+/*
+    Mirrors QDateTimeParser::parseFormat(), but only accepts formats whose
+    sections all have a fixed number of digits and which contain no quoting;
+    each section may appear only once.
+*/
+void QDateTimeFormatPattern::compileForParsing()
+{
+    const bool parseDate = mode & FormatDate;
+    const bool parseTime = mode & FormatTime;
+    uint seen = 0;
+    for (int i = 0; i < format.size(); ++i) {
+        const QChar c = format.at(i);
+        const int repeat = qMin(qt_repeatCount(format, i), 4);
+        SectionType type = Literal;
+        int width = 2;
+        switch (c.unicode()) {
+        case '\'':
+            usable = false;
+            return;
+        case 'h':
+        case 'H':
+            if (parseTime)
+                type = Hour;
+            break;
+        case 'm':
+            if (parseTime)
+                type = Minute;
+            break;
+        case 's':
+            if (parseTime)
+                type = Second;
+            break;
+        case 'z':
+            if (parseTime) {
+                type = MSec;
+                width = 3;
+            }
+            break;
+        case 'a':
+        case 'A':
+            if (parseTime) {
+                usable = false;
+                return;
+            }
+            break;
+        case 'y':
+            if (parseDate && repeat >= 2) {
+                type = repeat == 4 ? Year : Year2Digits;
+                width = repeat == 4 ? 4 : 2;
+            }
+            break;
+        case 'M':
+            if (parseDate)
+                type = Month;
+            break;
+        case 'd':
+            if (parseDate)
+                type = Day;
+            break;
+        default:
+            break;
+        }
+
+        if (type == Literal) {
+            appendLiteral(c);
+            continue;
+        }
+        // The general parser reads at most two digits for h, m, s, d and M;
+        // fewer digits, names or the one-digit z all need it.
+        const uint bit = 1u << (type == Year2Digits ? Year : type);
+        if ((type != Year && type != Year2Digits && repeat < width)
+            || (width == 2 && type != Year2Digits && repeat > 2) || (seen & bit)) {
+            usable = false;
+            return;
+        }
+        seen |= bit;
+        appendSection(type, width);
+        i += width - 1;
+    }
+}
+
+bool QDateTimeFormatPattern::toString(const QDate &date, const QTime &time, QString *result) const
+{
+    if (!usable)
+        return false;
+
+    int year = 0, month = 0, day = 0;
+    if (mode & FormatDate) {
+        date.getDate(&year, &month, &day);
+        if (year < 0 || year > 9999)
+            return false;
+    }
+
+    int maximumSize = 0;
+    for (const Section &section : sections)
+        maximumSize += section.type == Literal ? section.width : 4;
+    result->resize(maximumSize);
+    ushort *const begin = reinterpret_cast<ushort *>(result->data());
+    ushort *out = begin;
+
+    for (const Section &section : sections) {
+        switch (section.type) {
+        case Literal:
+            memcpy(out, literals.constData() + section.position, section.width * sizeof(ushort));
+            out += section.width;
+            break;
+        case Year:
+            out = writeDigits(out, year, 4);
+            break;
+        case Year2Digits:
+            out = writeDigits(out, year % 100, 2);
+            break;
+        case Month:
+            out = writeDigits(out, month, section.width);
+            break;
+        case Day:
+            out = writeDigits(out, day, section.width);
+            break;
+        case Hour:
+            out = writeDigits(out, time.hour(), section.width);
+            break;
+        case Minute:
+            out = writeDigits(out, time.minute(), section.width);
+            break;
+        case Second:
+            out = writeDigits(out, time.second(), section.width);
+            break;
+        case MSec:
+            out = writeDigits(out, time.msec(), 3);
+            break;
+        case MSecTrimmed:
+            // the milliseconds are the decimal part of the seconds, so only
+            // trailing zeroes are dropped: 2 is "002", 200 is "2"
+            out = writeDigits(out, time.msec(), 3);
+            if (out[-1] == '0')
+                --out;
+            if (out[-1] == '0')
+                --out;
+            break;
+        }
+    }
+    result->truncate(int(out - begin));
+    return true;
+}
+
+bool QDateTimeFormatPattern::fromString(const QString &string, QDate *date, QTime *time) const
+{
+    if (!usable)
+        return false;
+
+    const QChar *const s = string.constData();
+    const int size = string.size();
+    int pos = 0;
+    // Defaults as in QDateTimeParser::fromString()
+    int year = 1900, month = 1, day = 1;
+    int hour = 0, minute = 0, second = 0, msec = 0;
+    for (const Section &section : sections) {
+        if (size - pos < section.width)
+            return false;
+        if (section.type == Literal) {
+            if (memcmp(s + pos, literals.constData() + section.position,
+                       section.width * sizeof(QChar)) != 0) {
+                return false;
+            }
+        } else {
+            const int value = readDigits(s + pos, section.width);
+            switch (section.type) {
+            case Year: year = value; break;
+            case Year2Digits: year = 1900 + value; break;
+            case Month: month = value; break;
+            case Day: day = value; break;
+            case Hour: hour = value; break;
+            case Minute: minute = value; break;
+            case Second: second = value; break;
+            default: msec = value; break;
+            }
+            if (value < 0)
+                return false;
+        }
+        pos += section.width;
+    }
+    if (pos != size)
+        return false;
+
+    if (mode & FormatDate) {
+        // QDateTimeParser does not go beyond the end of 7999
+        if (year > 7999 || !QDate::isValid(year, month, day))
+            return false;
+        *date = QDate(year, month, day);
+    }
+    if (mode & FormatTime) {
+        if (!QTime::isValid(hour, minute, second, msec))
+            return false;
+        *time = QTime(hour, minute, second, msec);
+    }
+    return true;
+}
+#endif // QT_NO_DATESTRING
+
 /*****************************************************************************
   QDate member functions
  *****************************************************************************/
@@ -797,10 +1337,13 @@ static QString toStringTextDate(QDate date)
 static QString toStringIsoDate(qint64 jd)
 {
     const ParsedDate pd = getDateFromJulianDay(jd);
-    if (pd.year >= 0 && pd.year <= 9999)
-        return QString::asprintf("%04d-%02d-%02d", pd.year, pd.month, pd.day);
-    else
+    if (pd.year >= 0 && pd.year <= 9999) {
+        char buffer[10];
+        writeIsoDate(buffer, pd.year, pd.month, pd.day);
+        return QString::fromLatin1(buffer, sizeof buffer);
+    } else {
         return QString();
+    }
 }
 
 /*!
@@ -1332,6 +1875,12 @@ QDate QDate::fromString(const QString &string, const QString &format)
 {
     QDate date;
 #if QT_CONFIG(timezone)
+    if (QLocale().zeroDigit() == QLatin1Char('0')
+        && QDateTimeFormatPattern::lookup(format, QDateTimeFormatPattern::ParseDate)
+               ->fromString(string, &date, 0)) {
+        return date;
+    }
+
     QDateTimeParser dt(QVariant::Date, QDateTimeParser::FromString);
     // dt.setDefaultLocale(QLocale::c()); ### Qt 6
     if (dt.parseFormat(format))
@@ -1615,12 +2164,14 @@ QString QTime::toString(Qt::DateFormat format) const
     case Qt::DefaultLocaleLongDate:
         return QLocale().toString(*this, QLocale::LongFormat);
     case Qt::ISODateWithMs:
-        return QString::asprintf("%02d:%02d:%02d.%03d", hour(), minute(), second(), msec());
     case Qt::RFC2822Date:
     case Qt::ISODate:
     case Qt::TextDate:
-    default:
-        return QString::asprintf("%02d:%02d:%02d", hour(), minute(), second());
+    default: {
+        char buffer[12];
+        const char *end = writeIsoTime(buffer, *this, format == Qt::ISODateWithMs);
+        return QString::fromLatin1(buffer, int(end - buffer));
+    }
     }
 }
 
@@ -2038,6 +2589,12 @@ QTime QTime::fromString(const QString &string, const QString &format)
 {
     QTime time;
 #if QT_CONFIG(timezone)
+    if (QLocale().zeroDigit() == QLatin1Char('0')
+        && QDateTimeFormatPattern::lookup(format, QDateTimeFormatPattern::ParseTime)
+               ->fromString(string, 0, &time)) {
+        return time;
+    }
+
     QDateTimeParser dt(QVariant::Time, QDateTimeParser::FromString);
     // dt.setDefaultLocale(QLocale::c()); ### Qt 6
     if (dt.parseFormat(format))
@@ -3836,27 +4393,29 @@ QString QDateTime::toString(Qt::DateFormat format) const
     case Qt::ISODate:
     case Qt::ISODateWithMs: {
         const QPair<QDate, QTime> p = getDateTime(d);
-        const QDate &dt = p.first;
-        const QTime &tm = p.second;
-        buf = dt.toString(Qt::ISODate);
-        if (buf.isEmpty())
+        int year, month, day;
+        p.first.getDate(&year, &month, &day);
+        if (year < 0 || year > 9999)
             return QString();   // failed to convert
-        buf += QLatin1Char('T');
-        buf += tm.toString(format);
+
+        char buffer[40];
+        char *end = writeIsoDate(buffer, year, month, day);
+        *end++ = 'T';
+        end = writeIsoTime(end, p.second, format == Qt::ISODateWithMs);
         switch (getSpec(d)) {
         case Qt::UTC:
-            buf += QLatin1Char('Z');
+            *end++ = 'Z';
             break;
         case Qt::OffsetFromUTC:
 #if QT_CONFIG(timezone)
         case Qt::TimeZone:
 #endif
-            buf += toOffsetString(Qt::ISODate, offsetFromUtc());
+            end = writeOffset(end, offsetFromUtc(), true);
             break;
         default:
             break;
         }
-        return buf;
+        return QString::fromLatin1(buffer, int(end - buffer));
     }
     }
 }
@@ -4691,6 +5250,12 @@ QDateTime QDateTime::fromString(const QString& string, Qt::DateFormat format)
     if (string.isEmpty())
         return QDateTime();
 
+    if (format == Qt::ISODate || format == Qt::ISODateWithMs) {
+        QDateTime result;
+        if (fromIsoDateTimeFast(string.constData(), string.size(), &result))
+            return result;
+    }
+
     switch (format) {
     case Qt::SystemLocaleDate:
     case Qt::SystemLocaleShortDate:
@@ -4730,7 +5295,7 @@ QDateTime QDateTime::fromString(const QString& string, Qt::DateFormat format)
         isoString = isoString.right(isoString.length() - 11);
         int offset = 0;
         // Check end of string for Time Zone definition, either Z for UTC or [+-]HH:mm for Offset
-        if (isoString.endsWith(QLatin1Char('Z'))) {
+        if (isoString.endsWith(QLatin1Char('Z'), Qt::CaseInsensitive)) {
             spec = Qt::UTC;
             isoString = isoString.left(isoString.size() - 1);
         } else {
@@ -4883,6 +5448,31 @@ QDateTime QDateTime::fromString(const QString& string, Qt::DateFormat format)
     return QDateTime();
 }
 
+/*!
+    \since 5.10
+    \overload
+
+    Returns the QDateTime represented by the Latin-1 \a string, using the
+    \a format given, or an invalid datetime if this is not possible.
+
+    For Qt::ISODate and Qt::ISODateWithMs, the common forms of ISO 8601 and
+    \l{RFC 3339} timestamps, such as \c{2017-07-24T15:46:29.739Z} or
+    \c{2017-07-24 15:46:29+02:00}, are parsed directly from the Latin-1 data
+    without first converting it to a QString. This makes it suitable for
+    reading large numbers of timestamps, for example from log files.
+
+    \sa toString()
+*/
+QDateTime QDateTime::fromString(QLatin1String string, Qt::DateFormat format)
+{
+    if (format == Qt::ISODate || format == Qt::ISODateWithMs) {
+        QDateTime result;
+        if (fromIsoDateTimeFast(string.data(), string.size(), &result))
+            return result;
+    }
+    return fromString(QString(string), format);
+}
+
 /*!
     \fn QDateTime::fromString(const QString &string, const QString &format)
 
@@ -5001,6 +5591,12 @@ QDateTime QDateTime::fromString(const QString &string, const QString &format)
     QTime time;
     QDate date;
 
+    if (QLocale().zeroDigit() == QLatin1Char('0')
+        && QDateTimeFormatPattern::lookup(format, QDateTimeFormatPattern::ParseDateTime)
+               ->fromString(string, &date, &time)) {
+        return QDateTime(date, time);
+    }
+
     QDateTimeParser dt(QVariant::DateTime, QDateTimeParser::FromString);
     // dt.setDefaultLocale(QLocale::c()); ### Qt 6
     if (dt.parseFormat(format) && dt.fromString(string, &date, &time))
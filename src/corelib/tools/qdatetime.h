@@ -332,6 +332,7 @@ public:
 #ifndef QT_NO_DATESTRING
     static QDateTime fromString(const QString &s, Qt::DateFormat f = Qt::TextDate);
     static QDateTime fromString(const QString &s, const QString &format);
+    static QDateTime fromString(QLatin1String s, Qt::DateFormat f = Qt::TextDate);
 #endif
 
 #if QT_DEPRECATED_SINCE(5, 8)
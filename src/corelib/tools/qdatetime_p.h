@@ -57,6 +57,8 @@
 #include "QtCore/qatomic.h"
 #include "QtCore/qdatetime.h"
 #include "QtCore/qpair.h"
+#include "QtCore/qstring.h"
+#include "QtCore/qvector.h"
 
 #if QT_CONFIG(timezone)
 #include "qtimezone.h"
@@ -142,6 +144,70 @@ public:
 #endif // timezone
 };
 
+#ifndef QT_NO_DATESTRING
+/*
+    A date/time format string compiled once into a list of sections, so that
+    repeated formatting and parsing with the same format does not have to
+    interpret the string again.  Only purely numeric formats are compiled;
+    for anything else (names, AM/PM, time zones, quoting when parsing) the
+    pattern is not usable and callers fall back to QLocale/QDateTimeParser.
+    Compiled patterns are kept in a small per-thread cache, see lookup().
+*/
+class QDateTimeFormatPattern
+{
+public:
+    enum Mode {
+        FormatDate = 0x1,
+        FormatTime = 0x2,
+        FormatDateTime = FormatDate | FormatTime,
+        Parse = 0x4,
+        ParseDate = Parse | FormatDate,
+        ParseTime = Parse | FormatTime,
+        ParseDateTime = Parse | FormatDateTime
+    };
+
+    enum SectionType {
+        Literal,
+        Year,
+        Year2Digits,
+        Month,
+        Day,
+        Hour,
+        Minute,
+        Second,
+        MSec,
+        MSecTrimmed
+    };
+
+    struct Section {
+        SectionType type;
+        int width;      // field width, or length of the literal
+        int position;   // offset of the literal in literals
+    };
+
+    QDateTimeFormatPattern() : mode(0), usable(false) {}
+
+    static const QDateTimeFormatPattern *lookup(const QString &format, Mode mode);
+
+    bool toString(const QDate &date, const QTime &time, QString *result) const;
+    bool fromString(const QString &string, QDate *date, QTime *time) const;
+
+    QString format;
+    int mode;
+    bool usable;
+    QVector<Section> sections;
+    QString literals;
+
+private:
+    void compileForFormatting();
+    void compileForParsing();
+    void appendLiteral(const QString &text);
+    void appendSection(SectionType type, int width);
+};
+
+Q_DECLARE_TYPEINFO(QDateTimeFormatPattern::Section, Q_PRIMITIVE_TYPE);
+#endif // QT_NO_DATESTRING
+
 QT_END_NAMESPACE
 
 #endif // QDATETIME_P_H
@@ -55,6 +55,7 @@
 #include "qlocale_p.h"
 #include "qlocale_tools_p.h"
 #include "qdatetimeparser_p.h"
+#include "qdatetime_p.h"
 #include "qnamespace.h"
 #include "qdatetime.h"
 #include "qstringlist.h"
@@ -2574,6 +2575,18 @@ QString QLocalePrivate::dateTimeToString(const QString &format, const QDateTime
 
     QString result;
 
+#ifndef QT_NO_DATESTRING
+    // Purely numeric formats are compiled once and reused
+    if (m_data->m_zero == '0') {
+        const int mode = (formatDate ? QDateTimeFormatPattern::FormatDate : 0)
+                | (formatTime ? QDateTimeFormatPattern::FormatTime : 0);
+        if (QDateTimeFormatPattern::lookup(format, QDateTimeFormatPattern::Mode(mode))
+                ->toString(date, time, &result)) {
+            return result;
+        }
+    }
+#endif
+
     int i = 0;
     while (i < format.size()) {
         if (format.at(i).unicode() == '\'') {
@@ -54,6 +54,7 @@
 
 #include "qtimezone.h"
 #include "qlocale_p.h"
+#include "qmutex.h"
 #include "qvector.h"
 
 #if QT_CONFIG(icu)
@@ -285,6 +286,35 @@ Q_DECL_CONSTEXPR inline bool operator==(const QTzTransitionRule &lhs, const QTzT
 Q_DECL_CONSTEXPR inline bool operator!=(const QTzTransitionRule &lhs, const QTzTransitionRule &rhs) Q_DECL_NOTHROW
 { return !operator==(lhs, rhs); }
 
+struct QTzTimeZoneCacheEntry
+{
+    QTzTimeZoneCacheEntry() : m_posixFrom(0), m_posixTo(0) {}
+
+    QVector<QTzTransitionTime> m_tranTimes;
+    QVector<QTzTransitionRule> m_tranRules;
+    QList<QString> m_abbreviations;
+    QByteArray m_posixRule;
+    // transitions of m_posixRule, valid for times in [m_posixFrom, m_posixTo)
+    QVector<QTimeZonePrivate::Data> m_posixTransitions;
+    qint64 m_posixFrom;
+    qint64 m_posixTo;
+};
+
+// The POSIX rule transitions most recently computed outside the cached range
+struct QTzPosixYearCache
+{
+    QTzPosixYearCache() : year(INT_MIN) {}
+    // not copied: each QTzTimeZonePrivate has its own
+    QTzPosixYearCache(const QTzPosixYearCache &) : year(INT_MIN) {}
+
+    QMutex mutex;
+    int year;
+    QVector<QTimeZonePrivate::Data> transitions;
+
+private:
+    QTzPosixYearCache &operator=(const QTzPosixYearCache &) Q_DECL_EQ_DELETE;
+};
+
 class Q_AUTOTEST_EXPORT QTzTimeZonePrivate Q_DECL_FINAL : public QTimeZonePrivate
 {
     QTzTimeZonePrivate(const QTzTimeZonePrivate &) = default;
@@ -329,14 +359,14 @@ public:
 private:
     void init(const QByteArray &ianaId);
 
+    QVector<QTimeZonePrivate::Data> getPosixTransitions(qint64 msNear) const;
+
     Data dataForTzTransition(QTzTransitionTime tran) const;
-    QVector<QTzTransitionTime> m_tranTimes;
-    QVector<QTzTransitionRule> m_tranRules;
-    QList<QByteArray> m_abbreviations;
 #if QT_CONFIG(icu)
     mutable QSharedDataPointer<QTimeZonePrivate> m_icu;
 #endif
-    QByteArray m_posixRule;
+    QTzTimeZoneCacheEntry cached_data;
+    mutable QTzPosixYearCache m_posixYearCache;
 };
 #endif // Q_OS_UNIX
 
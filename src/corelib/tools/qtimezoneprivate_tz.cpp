@@ -40,10 +40,12 @@
 #include "qtimezone.h"
 #include "qtimezoneprivate_p.h"
 
+#include <QtCore/QCache>
 #include <QtCore/QFile>
 #include <QtCore/QHash>
 #include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
+#include <QtCore/QMutex>
 
 #include <qdebug.h>
 
@@ -361,8 +363,8 @@ static QDate calculatePosixDate(const QByteArray &dateRule, int year)
         int month = dateParts.at(0).mid(1).toInt();
         int week = dateParts.at(1).toInt();
         int dow = dateParts.at(2).toInt();
-        if (dow == 0)
-            ++dow;
+        if (dow == 0) // POSIX counts Sunday as 0, Qt::DayOfWeek as 7
+            dow = Qt::Sunday;
         return calculateDowDate(year, month, dow, week);
     } else if (dateRule.at(0) == 'J') {
         // Day of Year ignores Feb 29
@@ -613,42 +615,45 @@ static QVector<QTimeZonePrivate::Data> calculatePosixTransitions(const QByteArra
     return result;
 }
 
-// Create the system default time zone
-QTzTimeZonePrivate::QTzTimeZonePrivate()
-{
-    init(systemTimeZoneId());
-}
-
-// Create a named time zone
-QTzTimeZonePrivate::QTzTimeZonePrivate(const QByteArray &ianaId)
+/*
+    Parsed zone files are shared by all QTzTimeZonePrivate instances. The
+    entries consist of implicitly shared containers, so handing out copies is
+    cheap. The tz database has fewer than 600 zones, so the cache can hold all
+    of them.
+*/
+class QTzTimeZoneCache
 {
-    init(ianaId);
-}
+public:
+    QTzTimeZoneCache() : m_cache(600) {}
+    QTzTimeZoneCacheEntry fetchEntry(const QByteArray &ianaId);
+
+private:
+    QTzTimeZoneCacheEntry findEntry(const QByteArray &ianaId);
+    QCache<QByteArray, QTzTimeZoneCacheEntry> m_cache;
+    QMutex m_mutex;
+};
 
-QTzTimeZonePrivate::~QTzTimeZonePrivate()
-{
-}
+Q_GLOBAL_STATIC(QTzTimeZoneCache, tzCache)
 
-QTzTimeZonePrivate *QTzTimeZonePrivate::clone() const
-{
-    return new QTzTimeZonePrivate(*this);
-}
+// first year whose POSIX rule transitions are computed on demand rather than cached
+static const int posixCacheEndYear = 2038;
 
-void QTzTimeZonePrivate::init(const QByteArray &ianaId)
+QTzTimeZoneCacheEntry QTzTimeZoneCache::findEntry(const QByteArray &ianaId)
 {
+    QTzTimeZoneCacheEntry ret;
     QFile tzif;
     if (ianaId.isEmpty()) {
         // Open system tz
         tzif.setFileName(QStringLiteral("/etc/localtime"));
         if (!tzif.open(QIODevice::ReadOnly))
-            return;
+            return ret;
     } else {
         // Open named tz, try modern path first, if fails try legacy path
         tzif.setFileName(QLatin1String("/usr/share/zoneinfo/") + QString::fromLocal8Bit(ianaId));
         if (!tzif.open(QIODevice::ReadOnly)) {
             tzif.setFileName(QLatin1String("/usr/lib/zoneinfo/") + QString::fromLocal8Bit(ianaId));
             if (!tzif.open(QIODevice::ReadOnly))
-                return;
+                return ret;
         }
     }
 
@@ -658,59 +663,60 @@ void QTzTimeZonePrivate::init(const QByteArray &ianaId)
     bool ok = false;
     QTzHeader hdr = parseTzHeader(ds, &ok);
     if (!ok || ds.status() != QDataStream::Ok)
-        return;
+        return ret;
     QVector<QTzTransition> tranList = parseTzTransitions(ds, hdr.tzh_timecnt, false);
     if (ds.status() != QDataStream::Ok)
-        return;
+        return ret;
     QVector<QTzType> typeList = parseTzTypes(ds, hdr.tzh_typecnt);
     if (ds.status() != QDataStream::Ok)
-        return;
+        return ret;
     QMap<int, QByteArray> abbrevMap = parseTzAbbreviations(ds, hdr.tzh_charcnt, typeList);
     if (ds.status() != QDataStream::Ok)
-        return;
+        return ret;
     parseTzLeapSeconds(ds, hdr.tzh_leapcnt, false);
     if (ds.status() != QDataStream::Ok)
-        return;
+        return ret;
     typeList = parseTzIndicators(ds, typeList, hdr.tzh_ttisstdcnt, hdr.tzh_ttisgmtcnt);
     if (ds.status() != QDataStream::Ok)
-        return;
+        return ret;
 
     // If version 2 then parse the second block of data
     if (hdr.tzh_version == '2' || hdr.tzh_version == '3') {
         ok = false;
         QTzHeader hdr2 = parseTzHeader(ds, &ok);
         if (!ok || ds.status() != QDataStream::Ok)
-            return;
+            return ret;
         tranList = parseTzTransitions(ds, hdr2.tzh_timecnt, true);
         if (ds.status() != QDataStream::Ok)
-            return;
+            return ret;
         typeList = parseTzTypes(ds, hdr2.tzh_typecnt);
         if (ds.status() != QDataStream::Ok)
-            return;
+            return ret;
         abbrevMap = parseTzAbbreviations(ds, hdr2.tzh_charcnt, typeList);
         if (ds.status() != QDataStream::Ok)
-            return;
+            return ret;
         parseTzLeapSeconds(ds, hdr2.tzh_leapcnt, true);
         if (ds.status() != QDataStream::Ok)
-            return;
+            return ret;
         typeList = parseTzIndicators(ds, typeList, hdr2.tzh_ttisstdcnt, hdr2.tzh_ttisgmtcnt);
         if (ds.status() != QDataStream::Ok)
-            return;
-        m_posixRule = parseTzPosixRule(ds);
-        if (ds.status() != QDataStream::Ok)
-            return;
+            return ret;
+        ret.m_posixRule = parseTzPosixRule(ds);
+        if (ds.status() != QDataStream::Ok) {
+            ret.m_posixRule.clear();
+            return ret;
+        }
     }
 
     // Translate the TZ file into internal format
 
     // Translate the array index based tz_abbrind into list index
     const int size = abbrevMap.size();
-    m_abbreviations.clear();
-    m_abbreviations.reserve(size);
+    ret.m_abbreviations.reserve(size);
     QVector<int> abbrindList;
     abbrindList.reserve(size);
     for (auto it = abbrevMap.cbegin(), end = abbrevMap.cend(); it != end; ++it) {
-        m_abbreviations.append(it.value());
+        ret.m_abbreviations.append(QString::fromUtf8(it.value()));
         abbrindList.append(it.key());
     }
     for (int i = 0; i < typeList.size(); ++i)
@@ -728,7 +734,7 @@ void QTzTimeZonePrivate::init(const QByteArray &ianaId)
 
     // Now for each transition time calculate and store our rule:
     const int tranCount = tranList.count();;
-    m_tranTimes.reserve(tranCount);
+    ret.m_tranTimes.reserve(tranCount);
     // The DST offset when in effect: usually stable, usually an hour:
     int lastDstOff = 3600;
     for (int i = 0; i < tranCount; i++) {
@@ -782,10 +788,10 @@ void QTzTimeZonePrivate::init(const QByteArray &ianaId)
         rule.abbreviationIndex = tz_type.tz_abbrind;
 
         // If the rule already exist then use that, otherwise add it
-        int ruleIndex = m_tranRules.indexOf(rule);
+        int ruleIndex = ret.m_tranRules.indexOf(rule);
         if (ruleIndex == -1) {
-            m_tranRules.append(rule);
-            tran.ruleIndex = m_tranRules.size() - 1;
+            ret.m_tranRules.append(rule);
+            tran.ruleIndex = ret.m_tranRules.size() - 1;
         } else {
             tran.ruleIndex = ruleIndex;
         }
@@ -798,9 +804,73 @@ void QTzTimeZonePrivate::init(const QByteArray &ianaId)
         else
             tran.atMSecsSinceEpoch = tz_tran.tz_time * 1000;
 
-        m_tranTimes.append(tran);
+        ret.m_tranTimes.append(tran);
+    }
+
+    // Lookups past the last transition use the POSIX rule. Work out its
+    // transitions once for the years where lookups are most likely: up to the
+    // end of the 32-bit time_t range, which is where fat TZif files stop
+    // listing them explicitly.
+    if (!ret.m_posixRule.isEmpty() && !ret.m_tranTimes.isEmpty()) {
+        const qint64 lastTran = ret.m_tranTimes.last().atMSecsSinceEpoch;
+        const int firstYear = QDateTime::fromMSecsSinceEpoch(qMax(lastTran, qint64(0)), Qt::UTC).date().year();
+        if (firstYear < posixCacheEndYear) {
+            // calculatePosixTransitions() looks at the years either side of the
+            // one asked for, so the first and last years only serve as margins
+            ret.m_posixTransitions = calculatePosixTransitions(ret.m_posixRule, firstYear - 1,
+                                                               posixCacheEndYear, lastTran);
+            ret.m_posixFrom = QDateTime(QDate(firstYear, 1, 1), QTime(0, 0), Qt::UTC).toMSecsSinceEpoch();
+            ret.m_posixTo = QDateTime(QDate(posixCacheEndYear, 1, 1), QTime(0, 0), Qt::UTC).toMSecsSinceEpoch();
+        }
     }
+    return ret;
+}
+
+QTzTimeZoneCacheEntry QTzTimeZoneCache::fetchEntry(const QByteArray &ianaId)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // search the cache...
+    QTzTimeZoneCacheEntry *obj = m_cache.object(ianaId);
+    if (obj)
+        return *obj;
+
+    // ... or build a new entry from scratch
+    QTzTimeZoneCacheEntry ret = findEntry(ianaId);
+    m_cache.insert(ianaId, new QTzTimeZoneCacheEntry(ret));
+    return ret;
+}
+
+
+
+// Create the system default time zone
+QTzTimeZonePrivate::QTzTimeZonePrivate()
+{
+    init(systemTimeZoneId());
+}
+
+// Create a named time zone
+QTzTimeZonePrivate::QTzTimeZonePrivate(const QByteArray &ianaId)
+{
+    init(ianaId);
+}
+
+QTzTimeZonePrivate::~QTzTimeZonePrivate()
+{
+}
+
+QTzTimeZonePrivate *QTzTimeZonePrivate::clone() const
+{
+    return new QTzTimeZonePrivate(*this);
+}
 
+void QTzTimeZonePrivate::init(const QByteArray &ianaId)
+{
+    const QTzTimeZoneCacheEntry entry = tzCache()->fetchEntry(ianaId);
+    if (entry.m_tranTimes.isEmpty() && entry.m_posixRule.isEmpty())
+        return; // Invalid after all !
+
+    cached_data = entry;
     if (ianaId.isEmpty())
         m_id = systemTimeZoneId();
     else
@@ -884,9 +954,9 @@ QString QTzTimeZonePrivate::displayName(QTimeZone::TimeType timeType,
     }
 
     // Otherwise is strange sequence, so work backwards through trans looking for first match, if any
-    for (int i = m_tranTimes.size() - 1; i >= 0; --i) {
-        if (m_tranTimes.at(i).atMSecsSinceEpoch <= currentMSecs) {
-            tran = dataForTzTransition(m_tranTimes.at(i));
+    for (int i = cached_data.m_tranTimes.size() - 1; i >= 0; --i) {
+        if (cached_data.m_tranTimes.at(i).atMSecsSinceEpoch <= currentMSecs) {
+            tran = dataForTzTransition(cached_data.m_tranTimes.at(i));
             if ((timeType == QTimeZone::DaylightTime && tran.daylightTimeOffset != 0)
                 || (timeType == QTimeZone::StandardTime && tran.daylightTimeOffset == 0)) {
                 return tran.abbreviation;
@@ -922,7 +992,7 @@ int QTzTimeZonePrivate::daylightTimeOffset(qint64 atMSecsSinceEpoch) const
 bool QTzTimeZonePrivate::hasDaylightTime() const
 {
     // TODO Perhaps cache as frequently accessed?
-    for (const QTzTransitionRule &rule : m_tranRules) {
+    for (const QTzTransitionRule &rule : cached_data.m_tranRules) {
         if (rule.dstOffset != 0)
             return true;
     }
@@ -938,44 +1008,77 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::dataForTzTransition(QTzTransitionTime
 {
     QTimeZonePrivate::Data data;
     data.atMSecsSinceEpoch = tran.atMSecsSinceEpoch;
-    QTzTransitionRule rule = m_tranRules.at(tran.ruleIndex);
+    QTzTransitionRule rule = cached_data.m_tranRules.at(tran.ruleIndex);
     data.standardTimeOffset = rule.stdOffset;
     data.daylightTimeOffset = rule.dstOffset;
     data.offsetFromUtc = rule.stdOffset + rule.dstOffset;
-    data.abbreviation = QString::fromUtf8(m_abbreviations.at(rule.abbreviationIndex));
+    data.abbreviation = cached_data.m_abbreviations.at(rule.abbreviationIndex);
     return data;
 }
 
+QVector<QTimeZonePrivate::Data> QTzTimeZonePrivate::getPosixTransitions(qint64 msNear) const
+{
+    // The cached list is a superset of what we'd compute for the years around msNear
+    if (msNear >= cached_data.m_posixFrom && msNear < cached_data.m_posixTo)
+        return cached_data.m_posixTransitions;
+
+    // Otherwise, successive lookups tend to be in the same year
+    const int year = QDateTime::fromMSecsSinceEpoch(msNear, Qt::UTC).date().year();
+    {
+        QMutexLocker locker(&m_posixYearCache.mutex);
+        if (m_posixYearCache.year == year)
+            return m_posixYearCache.transitions;
+    }
+
+    const QVector<QTimeZonePrivate::Data> result =
+        calculatePosixTransitions(cached_data.m_posixRule, year - 1, year + 1,
+                                  cached_data.m_tranTimes.last().atMSecsSinceEpoch);
+    QMutexLocker locker(&m_posixYearCache.mutex);
+    m_posixYearCache.year = year;
+    m_posixYearCache.transitions = result;
+    return result;
+}
+
+namespace {
+struct AtMSecsLess
+{
+    template <typename T> bool operator()(const T &tran, qint64 msecs) const
+    { return tran.atMSecsSinceEpoch < msecs; }
+    template <typename T> bool operator()(qint64 msecs, const T &tran) const
+    { return msecs < tran.atMSecsSinceEpoch; }
+};
+}
+
 QTimeZonePrivate::Data QTzTimeZonePrivate::data(qint64 forMSecsSinceEpoch) const
 {
+    const QVector<QTzTransitionTime> &tranTimes = cached_data.m_tranTimes;
+
     // If the required time is after the last transition and we have a POSIX rule then use it
-    if (m_tranTimes.size() > 0 && m_tranTimes.last().atMSecsSinceEpoch < forMSecsSinceEpoch
-        && !m_posixRule.isEmpty() && forMSecsSinceEpoch >= 0) {
-        const int year = QDateTime::fromMSecsSinceEpoch(forMSecsSinceEpoch, Qt::UTC).date().year();
-        QVector<QTimeZonePrivate::Data> posixTrans =
-            calculatePosixTransitions(m_posixRule, year - 1, year + 1,
-                                      m_tranTimes.last().atMSecsSinceEpoch);
-        for (int i = posixTrans.size() - 1; i >= 0; --i) {
-            if (posixTrans.at(i).atMSecsSinceEpoch <= forMSecsSinceEpoch) {
-                QTimeZonePrivate::Data data = posixTrans.at(i);
-                data.atMSecsSinceEpoch = forMSecsSinceEpoch;
-                return data;
-            }
+    if (tranTimes.size() > 0 && tranTimes.last().atMSecsSinceEpoch < forMSecsSinceEpoch
+        && !cached_data.m_posixRule.isEmpty() && forMSecsSinceEpoch >= 0) {
+        const QVector<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(forMSecsSinceEpoch);
+        // last transition at or before the required time
+        auto it = std::upper_bound(posixTrans.cbegin(), posixTrans.cend(),
+                                   forMSecsSinceEpoch, AtMSecsLess());
+        if (it != posixTrans.cbegin()) {
+            QTimeZonePrivate::Data data = *--it;
+            data.atMSecsSinceEpoch = forMSecsSinceEpoch;
+            return data;
         }
     }
 
     // Otherwise if we can find a valid tran then use its rule
-    for (int i = m_tranTimes.size() - 1; i >= 0; --i) {
-        if (m_tranTimes.at(i).atMSecsSinceEpoch <= forMSecsSinceEpoch) {
-            Data data = dataForTzTransition(m_tranTimes.at(i));
-            data.atMSecsSinceEpoch = forMSecsSinceEpoch;
-            return data;
-        }
+    auto it = std::upper_bound(tranTimes.cbegin(), tranTimes.cend(),
+                               forMSecsSinceEpoch, AtMSecsLess());
+    if (it != tranTimes.cbegin()) {
+        Data data = dataForTzTransition(*--it);
+        data.atMSecsSinceEpoch = forMSecsSinceEpoch;
+        return data;
     }
 
     // Otherwise use the earliest transition we have
-    if (m_tranTimes.size() > 0) {
-        Data data = dataForTzTransition(m_tranTimes.at(0));
+    if (tranTimes.size() > 0) {
+        Data data = dataForTzTransition(tranTimes.at(0));
         data.atMSecsSinceEpoch = forMSecsSinceEpoch;
         return data;
     }
@@ -991,25 +1094,24 @@ bool QTzTimeZonePrivate::hasTransitions() const
 
 QTimeZonePrivate::Data QTzTimeZonePrivate::nextTransition(qint64 afterMSecsSinceEpoch) const
 {
+    const QVector<QTzTransitionTime> &tranTimes = cached_data.m_tranTimes;
+
     // If the required time is after the last transition and we have a POSIX rule then use it
-    if (m_tranTimes.size() > 0 && m_tranTimes.last().atMSecsSinceEpoch < afterMSecsSinceEpoch
-        && !m_posixRule.isEmpty() && afterMSecsSinceEpoch >= 0) {
-        const int year = QDateTime::fromMSecsSinceEpoch(afterMSecsSinceEpoch, Qt::UTC).date().year();
-        QVector<QTimeZonePrivate::Data> posixTrans =
-            calculatePosixTransitions(m_posixRule, year - 1, year + 1,
-                                      m_tranTimes.last().atMSecsSinceEpoch);
-        for (int i = 0; i < posixTrans.size(); ++i) {
-            if (posixTrans.at(i).atMSecsSinceEpoch > afterMSecsSinceEpoch)
-                return posixTrans.at(i);
-        }
+    if (tranTimes.size() > 0 && tranTimes.last().atMSecsSinceEpoch < afterMSecsSinceEpoch
+        && !cached_data.m_posixRule.isEmpty() && afterMSecsSinceEpoch >= 0) {
+        const QVector<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(afterMSecsSinceEpoch);
+        // first transition after the required time
+        auto it = std::upper_bound(posixTrans.cbegin(), posixTrans.cend(),
+                                   afterMSecsSinceEpoch, AtMSecsLess());
+        if (it != posixTrans.cend())
+            return *it;
     }
 
     // Otherwise if we can find a valid tran then use its rule
-    for (int i = 0; i < m_tranTimes.size(); ++i) {
-        if (m_tranTimes.at(i).atMSecsSinceEpoch > afterMSecsSinceEpoch) {
-            return dataForTzTransition(m_tranTimes.at(i));
-        }
-    }
+    auto it = std::upper_bound(tranTimes.cbegin(), tranTimes.cend(),
+                               afterMSecsSinceEpoch, AtMSecsLess());
+    if (it != tranTimes.cend())
+        return dataForTzTransition(*it);
 
     // Otherwise we have no rule, or there is no next transition, so return invalid data
     return invalidData();
@@ -1017,25 +1119,24 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::nextTransition(qint64 afterMSecsSince
 
 QTimeZonePrivate::Data QTzTimeZonePrivate::previousTransition(qint64 beforeMSecsSinceEpoch) const
 {
+    const QVector<QTzTransitionTime> &tranTimes = cached_data.m_tranTimes;
+
     // If the required time is after the last transition and we have a POSIX rule then use it
-    if (m_tranTimes.size() > 0 && m_tranTimes.last().atMSecsSinceEpoch < beforeMSecsSinceEpoch
-        && !m_posixRule.isEmpty() && beforeMSecsSinceEpoch > 0) {
-        const int year = QDateTime::fromMSecsSinceEpoch(beforeMSecsSinceEpoch, Qt::UTC).date().year();
-        QVector<QTimeZonePrivate::Data> posixTrans =
-            calculatePosixTransitions(m_posixRule, year - 1, year + 1,
-                                      m_tranTimes.last().atMSecsSinceEpoch);
-        for (int i = posixTrans.size() - 1; i >= 0; --i) {
-            if (posixTrans.at(i).atMSecsSinceEpoch < beforeMSecsSinceEpoch)
-                return posixTrans.at(i);
-        }
+    if (tranTimes.size() > 0 && tranTimes.last().atMSecsSinceEpoch < beforeMSecsSinceEpoch
+        && !cached_data.m_posixRule.isEmpty() && beforeMSecsSinceEpoch > 0) {
+        const QVector<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(beforeMSecsSinceEpoch);
+        // last transition before the required time
+        auto it = std::lower_bound(posixTrans.cbegin(), posixTrans.cend(),
+                                   beforeMSecsSinceEpoch, AtMSecsLess());
+        if (it != posixTrans.cbegin())
+            return *--it;
     }
 
     // Otherwise if we can find a valid tran then use its rule
-    for (int i = m_tranTimes.size() - 1; i >= 0; --i) {
-        if (m_tranTimes.at(i).atMSecsSinceEpoch < beforeMSecsSinceEpoch) {
-            return dataForTzTransition(m_tranTimes.at(i));
-        }
-    }
+    auto it = std::lower_bound(tranTimes.cbegin(), tranTimes.cend(),
+                               beforeMSecsSinceEpoch, AtMSecsLess());
+    if (it != tranTimes.cbegin())
+        return dataForTzTransition(*--it);
 
     // Otherwise we have no rule, so return invalid data
     return invalidData();
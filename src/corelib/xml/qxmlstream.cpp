@@ -46,6 +46,9 @@
 #include <qfile.h>
 #include <stdio.h>
 #include <qtextcodec.h>
+#ifndef QT_NO_TEXTCODEC
+#include <private/qutfcodec_p.h>
+#endif
 #include <qstack.h>
 #include <qbuffer.h>
 #ifndef QT_BOOTSTRAPPED
@@ -756,6 +759,57 @@ bool QXmlStreamReader::namespaceProcessing() const
     return d->namespaceProcessing;
 }
 
+/*!
+    \property  QXmlStreamReader::nameInterning
+    \since 5.10
+    The name-interning flag of the stream reader
+
+    If this property is enabled, the reader keeps a single copy of every
+    element and attribute name that it reads, and name(), qualifiedName()
+    and prefix() of elements, as well as name() and qualifiedName() of
+    attributes, refer to these copies. Equal names then share the same
+    data, so that they can be compared by comparing QStringRef::unicode(),
+    for instance with a name returned by internedName(). It also saves
+    copying the names of open elements.
+
+    The copies are kept until the reader is destroyed, so the memory they
+    use grows with the number of distinct names in the documents read.
+
+    By default, name-interning is disabled.
+
+    \sa internedName()
+*/
+
+void QXmlStreamReader::setNameInterning(bool enable)
+{
+    Q_D(QXmlStreamReader);
+    d->internNames = enable;
+}
+
+bool QXmlStreamReader::nameInterning() const
+{
+    Q_D(const QXmlStreamReader);
+    return d->internNames;
+}
+
+/*!
+    \since 5.10
+
+    Returns the reader's shared copy of \a name, adding one if the reader
+    has none yet. If the \l nameInterning property is enabled, names that
+    are read and equal to \a name refer to the same data as the returned
+    reference:
+
+    \snippet code/src_corelib_xml_qxmlstream.cpp 3
+
+    \sa nameInterning
+*/
+QStringRef QXmlStreamReader::internedName(const QString &name)
+{
+    Q_D(QXmlStreamReader);
+    return d->internName(QStringRef(&name));
+}
+
 /*! Returns the reader's current token as string.
 
 \sa tokenType()
@@ -790,6 +844,8 @@ QXmlStreamReaderPrivate::QXmlStreamReaderPrivate(QXmlStreamReader *q)
 #ifndef QT_NO_TEXTCODEC
     decoder = 0;
 #endif
+    internNames = false;
+    atomSeed = uint(qGlobalQHashSeed());
     stack_size = 64;
     sym_stack = 0;
     state_stack = 0;
@@ -831,6 +887,9 @@ void QXmlStreamReaderPrivate::init()
     codec = QTextCodec::codecForMib(106); // utf8
     delete decoder;
     decoder = 0;
+    utf8State.flags = QTextCodec::DefaultConversion;
+    utf8State.remainingChars = 0;
+    utf8State.invalidChars = 0;
 #endif
     attributeStack.clear();
     attributeStack.reserve(16);
@@ -895,6 +954,7 @@ QXmlStreamReaderPrivate::~QXmlStreamReaderPrivate()
 #ifndef QT_NO_TEXTCODEC
     delete decoder;
 #endif
+    qDeleteAll(atoms);
     free(sym_stack);
     free(state_stack);
     delete entityParser;
@@ -1142,11 +1202,50 @@ bool QXmlStreamReaderPrivate::scanAttType()
  encountered.
 
  */
+/*!
+ \internal
+
+ Appends the characters at the current position of the read buffer to
+ textBuffer, up to the first one that is a control character, U+FFFE,
+ U+FFFF or one of \a stop1 to \a stop4, and returns how many there
+ were. If \a whitespace is set and one of them is not a space, it is
+ set to false. This copies the runs of characters that need no
+ special handling in one go, and leaves the rest to the callers.
+ */
+inline int QXmlStreamReaderPrivate::fastScanPlainChars(ushort stop1, ushort stop2, ushort stop3,
+                                                       ushort stop4, bool *whitespace)
+{
+    if (putStack.size())
+        return 0;
+    const QChar *const begin = readBuffer.constData() + readBufferPos;
+    const QChar *const end = readBuffer.constData() + readBuffer.size();
+    const QChar *ptr = begin;
+    bool space = true;
+    for ( ; ptr != end; ++ptr) {
+        const ushort c = ptr->unicode();
+        if (c < 0x20 || c == stop1 || c == stop2 || c == stop3 || c == stop4 || c >= 0xfffe)
+            break;
+        if (c != ' ')
+            space = false;
+    }
+    const int n = int(ptr - begin);
+    if (n) {
+        textBuffer.append(begin, n);
+        readBufferPos += n;
+        if (whitespace && !space)
+            *whitespace = false;
+    }
+    return n;
+}
+
 inline int QXmlStreamReaderPrivate::fastScanLiteralContent()
 {
     int n = 0;
     uint c;
-    while ((c = getChar()) != StreamEOF) {
+    for (;;) {
+        n += fastScanPlainChars('&', '<', '\"', '\'');
+        if ((c = getChar()) == StreamEOF)
+            break;
         switch (ushort(c)) {
         case 0xfffe:
         case 0xffff:
@@ -1229,7 +1328,13 @@ inline int QXmlStreamReaderPrivate::fastScanContentCharList()
 {
     int n = 0;
     uint c;
-    while ((c = getChar()) != StreamEOF) {
+    for (;;) {
+        bool whitespace = true;
+        n += fastScanPlainChars('&', '<', ']', ']', &whitespace);
+        if (!whitespace)
+            isWhitespace = false;
+        if ((c = getChar()) == StreamEOF)
+            break;
         switch (ushort(c)) {
         case 0xfffe:
         case 0xffff:
@@ -1465,6 +1570,26 @@ void QXmlStreamReaderPrivate::putReplacementInAttributeValue(const QString &s)
     }
 }
 
+/*
+  Converts the nbytesread bytes in rawReadBuffer to readBuffer. UTF-8, the
+  most common encoding by far, is decoded directly into readBuffer, which
+  keeps its capacity between calls.
+ */
+#ifndef QT_NO_TEXTCODEC
+void QXmlStreamReaderPrivate::decodeReadBuffer()
+{
+    if (codec->mibEnum() == 106) {
+        const int length = int(nbytesread);
+        readBuffer.resize(length + 1);
+        const QChar *end = QUtf8::convertToUnicode(readBuffer.data(), rawReadBuffer.constData(),
+                                                   length, &utf8State);
+        readBuffer.resize(end ? int(end - readBuffer.constData()) : 0);
+    } else {
+        decoder->toUnicode(&readBuffer, rawReadBuffer.constData(), nbytesread);
+    }
+}
+#endif // QT_NO_TEXTCODEC
+
 uint QXmlStreamReaderPrivate::getChar_helper()
 {
     const int BUFFER_SIZE = 8192;
@@ -1525,9 +1650,9 @@ uint QXmlStreamReaderPrivate::getChar_helper()
         decoder = codec->makeDecoder();
     }
 
-    decoder->toUnicode(&readBuffer, rawReadBuffer.constData(), nbytesread);
+    decodeReadBuffer();
 
-    if(lockEncoding && decoder->hasFailure()) {
+    if (lockEncoding && (decoder->hasFailure() || utf8State.invalidChars)) {
         raiseWellFormedError(QXmlStream::tr("Encountered incorrectly encoded content."));
         readBuffer.clear();
         return StreamEOF;
@@ -1622,6 +1747,10 @@ void QXmlStreamReaderPrivate::resolveTag()
         QStringRef name(symString(attrib.key));
         QStringRef qualifiedName(symName(attrib.key));
         QStringRef value(symString(attrib.value));
+        if (internNames) {
+            name = internName(name);
+            qualifiedName = internName(qualifiedName);
+        }
 
         attribute.m_name = QXmlStreamStringRef(name);
         attribute.m_qualifiedName = QXmlStreamStringRef(qualifiedName);
@@ -1671,6 +1800,40 @@ void QXmlStreamReaderPrivate::resolveTag()
     attributeStack.clear();
 }
 
+/*
+  Returns the shared copy of \a name, adding one if there is none yet.
+  The copies are found through an open-addressing hash table of indexes
+  into atoms, so that looking up a name does not allocate memory.
+ */
+QStringRef QXmlStreamReaderPrivate::internName(const QStringRef &name)
+{
+    if (atoms.size() * 2 >= atomTable.size()) {
+        // keep the table at most half full
+        const int size = qMax(64, atomTable.size() * 2);
+        atomTable.fill(0, size);
+        for (int i = 0; i < atoms.size(); ++i) {
+            uint h = qHash(*atoms.at(i), atomSeed) & (size - 1);
+            while (atomTable.at(h))
+                h = (h + 1) & (size - 1);
+            atomTable[h] = i + 1;
+        }
+    }
+
+    const int mask = atomTable.size() - 1;
+    uint h = qHash(name, atomSeed) & mask;
+    while (const int index = atomTable.at(h)) {
+        const QString *atom = atoms.at(index - 1);
+        if (*atom == name)
+            return QStringRef(atom);
+        h = (h + 1) & mask;
+    }
+
+    QString *atom = new QString(name.toString());
+    atoms.append(atom);
+    atomTable[h] = atoms.size();
+    return QStringRef(atom);
+}
+
 void QXmlStreamReaderPrivate::resolvePublicNamespaces()
 {
     const Tag &tag = tagStack.top();
@@ -1816,7 +1979,10 @@ void QXmlStreamReaderPrivate::startDocument()
                     codec = newCodec;
                     delete decoder;
                     decoder = codec->makeDecoder();
-                    decoder->toUnicode(&readBuffer, rawReadBuffer.data(), nbytesread);
+                    utf8State.flags = QTextCodec::DefaultConversion;
+                    utf8State.remainingChars = 0;
+                    utf8State.invalidChars = 0;
+                    decodeReadBuffer();
                 }
 #endif // QT_NO_TEXTCODEC
             }
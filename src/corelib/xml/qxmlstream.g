@@ -273,6 +273,20 @@ public:
     };
     QHash<QString, Entity> entityHash;
     QHash<QString, Entity> parameterEntityHash;
+    static inline ushort predefinedEntity(const QStringRef &name)
+    {
+        if (name == QLatin1String("lt"))
+            return '<';
+        if (name == QLatin1String("gt"))
+            return '>';
+        if (name == QLatin1String("amp"))
+            return '&';
+        if (name == QLatin1String("apos"))
+            return '\'';
+        if (name == QLatin1String("quot"))
+            return '"';
+        return 0;
+    }
     QXmlStreamSimpleStack<Entity *>entityReferenceStack;
     inline bool referenceEntity(Entity &entity) {
         if (entity.isCurrentlyReferenced) {
@@ -291,6 +305,8 @@ public:
 #ifndef QT_NO_TEXTCODEC
     QTextCodec *codec;
     QTextDecoder *decoder;
+    QTextCodec::ConverterState utf8State;
+    void decodeReadBuffer();
 #endif
     bool atEnd;
 
@@ -311,6 +327,12 @@ public:
 
     QXmlStreamAttributes attributes;
     QStringRef namespaceForPrefix(const QStringRef &prefix);
+
+    bool internNames;
+    uint atomSeed;
+    QVector<QString *> atoms;
+    QVector<int> atomTable;
+    QStringRef internName(const QStringRef &name);
     void resolveTag();
     void resolvePublicNamespaces();
     void resolveDtd();
@@ -487,6 +509,8 @@ public:
 
     // scan optimization functions. Not strictly necessary but LALR is
     // not very well suited for scanning fast
+    inline int fastScanPlainChars(ushort stop1, ushort stop2, ushort stop3, ushort stop4,
+                                  bool *whitespace = 0);
     int fastScanLiteralContent();
     int fastScanSpace();
     int fastScanContentCharList();
@@ -579,7 +603,7 @@ bool QXmlStreamReaderPrivate::parse()
         documentVersion.clear();
         documentEncoding.clear();
 #ifndef QT_NO_TEXTCODEC
-        if (decoder->hasFailure()) {
+        if (decoder->hasFailure() || utf8State.invalidChars) {
             raiseWellFormedError(QXmlStream::tr("Encountered incorrectly encoded content."));
             readBuffer.clear();
             return false;
@@ -1554,9 +1578,15 @@ stag_start ::= LANGLE qname;
         case $rule_number: {
             normalizeLiterals = true;
             Tag &tag = tagStack_push();
-            prefix = tag.namespaceDeclaration.prefix  = addToStringStorage(symPrefix(2));
-            name = tag.name = addToStringStorage(symString(2));
-            qualifiedName = tag.qualifiedName = addToStringStorage(symName(2));
+            if (internNames) {
+                prefix = tag.namespaceDeclaration.prefix = internName(symPrefix(2));
+                name = tag.name = internName(symString(2));
+                qualifiedName = tag.qualifiedName = internName(symName(2));
+            } else {
+                prefix = tag.namespaceDeclaration.prefix  = addToStringStorage(symPrefix(2));
+                name = tag.name = addToStringStorage(symString(2));
+                qualifiedName = tag.qualifiedName = addToStringStorage(symName(2));
+            }
             if ((!prefix.isEmpty() && !QXmlUtils::isNCName(prefix)) || !QXmlUtils::isNCName(name))
                 raiseWellFormedError(QXmlStream::tr("Invalid XML name."));
         } break;
@@ -1614,6 +1644,13 @@ entity_ref ::= AMPERSAND name SEMICOLON;
 /.
         case $rule_number: {
             sym(1).len += sym(2).len + 1;
+            if (const ushort c = predefinedEntity(symString(2))) {
+                // the predefined entities cannot be redeclared
+                putChar(uint((LETTER << 16) | c));
+                textBuffer.chop(2 + sym(2).len);
+                clearSym();
+                break;
+            }
             QString reference = symString(2).toString();
             if (entityHash.contains(reference)) {
                 Entity &entity = entityHash[reference];
@@ -1687,6 +1724,13 @@ entity_ref_in_attribute_value ::= AMPERSAND name SEMICOLON;
 /.
         case $rule_number: {
             sym(1).len += sym(2).len + 1;
+            if (const ushort c = predefinedEntity(symString(2))) {
+                // the predefined entities cannot be redeclared
+                putChar(uint((LETTER << 16) | c));
+                textBuffer.chop(2 + sym(2).len);
+                clearSym();
+                break;
+            }
             QString reference = symString(2).toString();
             if (entityHash.contains(reference)) {
                 Entity &entity = entityHash[reference];
@@ -341,6 +341,7 @@ public:
 #ifndef QT_NO_XMLSTREAMREADER
 class Q_CORE_EXPORT QXmlStreamReader {
     QDOC_PROPERTY(bool namespaceProcessing READ namespaceProcessing WRITE setNamespaceProcessing)
+    QDOC_PROPERTY(bool nameInterning READ nameInterning WRITE setNameInterning)
 public:
     enum TokenType {
         NoToken = 0,
@@ -384,6 +385,10 @@ public:
     void setNamespaceProcessing(bool);
     bool namespaceProcessing() const;
 
+    void setNameInterning(bool);
+    bool nameInterning() const;
+    QStringRef internedName(const QString &name);
+
     inline bool isStartDocument() const { return tokenType() == StartDocument; }
     inline bool isEndDocument() const { return tokenType() == EndDocument; }
     inline bool isStartElement() const { return tokenType() == StartElement; }
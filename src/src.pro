@@ -25,11 +25,20 @@ src_tools_qfloat16_tables.subdir = tools/qfloat16-tables
 src_tools_qfloat16_tables.target = sub-qfloat16-tables
 src_tools_qfloat16_tables.depends = src_tools_bootstrap
 
+src_tools_qmime_cache.subdir = tools/qmime-cache
+src_tools_qmime_cache.target = sub-qmime-cache
+src_tools_qmime_cache.depends = src_tools_bootstrap
+
 src_tools_qlalr.subdir = tools/qlalr
 src_tools_qlalr.target = sub-qlalr
 force_bootstrap: src_tools_qlalr.depends = src_tools_bootstrap
 else: src_tools_qlalr.depends = src_corelib
 
+src_tools_qlogdecode.subdir = tools/qlogdecode
+src_tools_qlogdecode.target = sub-qlogdecode
+force_bootstrap: src_tools_qlogdecode.depends = src_tools_bootstrap
+else: src_tools_qlogdecode.depends = src_corelib
+
 src_tools_uic.subdir = tools/uic
 src_tools_uic.target = sub-uic
 force_bootstrap: src_tools_uic.depends = src_tools_bootstrap
@@ -143,12 +152,17 @@ src_android.subdir = $$PWD/android
     }
 }
 SUBDIRS += src_tools_bootstrap src_tools_moc src_tools_rcc src_tools_qfloat16_tables
+qtConfig(mimetype-cache) {
+    SUBDIRS += src_tools_qmime_cache
+    src_corelib.depends += src_tools_qmime_cache
+}
 qtConfig(regularexpression):pcre2 {
     SUBDIRS += src_3rdparty_pcre2
     src_corelib.depends += src_3rdparty_pcre2
 }
-SUBDIRS += src_corelib src_tools_qlalr
-TOOLS = src_tools_moc src_tools_rcc src_tools_qlalr src_tools_qfloat16_tables
+SUBDIRS += src_corelib src_tools_qlalr src_tools_qlogdecode
+TOOLS = src_tools_moc src_tools_rcc src_tools_qlalr src_tools_qlogdecode src_tools_qfloat16_tables
+qtConfig(mimetype-cache): TOOLS += src_tools_qmime_cache
 win32:SUBDIRS += src_winmain
 qtConfig(network) {
     SUBDIRS += src_network
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <qcommandlineparser.h>
+#include <qcoreapplication.h>
+#include <qdatetime.h>
+#include <qstringlist.h>
+#include <private/qbinarylog_p.h>
+
+#include <stdio.h>
+
+QT_USE_NAMESPACE
+
+static const char *typeName(QtMsgType type)
+{
+    switch (type) {
+    case QtDebugMsg: return "debug";
+    case QtInfoMsg: return "info";
+    case QtWarningMsg: return "warning";
+    case QtCriticalMsg: return "critical";
+    case QtFatalMsg: return "fatal";
+    }
+    return "unknown";
+}
+
+static QString formatTime(qint64 nsecs, bool utc)
+{
+    const qint64 msecs = nsecs / 1000000;
+    const QDateTime dateTime = utc ? QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC)
+                                   : QDateTime::fromMSecsSinceEpoch(msecs);
+    // milliseconds come from the date/time, the rest are appended
+    return dateTime.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ss.zzz"))
+            + QString::number(nsecs % 1000000 + 1000000).mid(1);
+}
+
+static bool categoryMatches(const QByteArray &category, const QStringList &filters)
+{
+    if (filters.isEmpty())
+        return true;
+    const QString name = QString::fromLatin1(category);
+    for (const QString &filter : filters) {
+        if (filter.endsWith(QLatin1Char('*'))) {
+            if (name.startsWith(filter.leftRef(filter.size() - 1)))
+                return true;
+        } else if (name == filter) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationVersion(QStringLiteral(QT_VERSION_STR));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+            "Prints the messages of a binary log written by a Qt application "
+            "with QT_LOGGING_BINARY_FILE set, oldest first."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption categoryOption(QStringList() << QStringLiteral("c") << QStringLiteral("category"),
+            QStringLiteral("Only print messages of <category>; a trailing '*' matches any "
+                           "category starting with the text before it. Can be given more "
+                           "than once."),
+            QStringLiteral("category"));
+    parser.addOption(categoryOption);
+    QCommandLineOption locationOption(QStringList() << QStringLiteral("l") << QStringLiteral("location"),
+            QStringLiteral("Print the source location of the messages, where recorded."));
+    parser.addOption(locationOption);
+    QCommandLineOption utcOption(QStringLiteral("utc"),
+            QStringLiteral("Print times in UTC instead of local time."));
+    parser.addOption(utcOption);
+    parser.addPositionalArgument(QStringLiteral("file"), QStringLiteral("The binary log file."));
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.size() != 1)
+        parser.showHelp(1);
+
+    QBinaryLogReader reader;
+    if (!reader.open(files.first())) {
+        fprintf(stderr, "qlogdecode: %s: %s\n", qPrintable(files.first()),
+                qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    const QStringList categories = parser.values(categoryOption);
+    const bool printLocation = parser.isSet(locationOption);
+    const bool utc = parser.isSet(utcOption);
+
+    for (const QBinaryLogReader::Entry &entry : reader.entries()) {
+        if (!categoryMatches(entry.category, categories))
+            continue;
+        QString line = formatTime(entry.timestamp, utc)
+                + QLatin1String(" [") + QString::number(entry.threadId) + QLatin1String("] ")
+                + QString::fromLatin1(entry.category) + QLatin1Char('.')
+                + QLatin1String(typeName(entry.type)) + QLatin1String(": ") + entry.message;
+        if (printLocation && !entry.file.isEmpty()) {
+            line += QLatin1String(" (") + QString::fromUtf8(entry.file) + QLatin1Char(':')
+                    + QString::number(entry.line);
+            if (!entry.function.isEmpty())
+                line += QLatin1String(", ") + QString::fromUtf8(entry.function);
+            line += QLatin1Char(')');
+        }
+        fprintf(stdout, "%s\n", line.toLocal8Bit().constData());
+    }
+
+    if (reader.skippedBytes()) {
+        fprintf(stderr, "qlogdecode: %llu bytes could not be decoded "
+                        "(overwritten or unfinished records)\n",
+                static_cast<unsigned long long>(reader.skippedBytes()));
+    }
+    return 0;
+}
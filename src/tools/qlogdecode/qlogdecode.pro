@@ -0,0 +1,8 @@
+option(host_build)
+QT = core-private
+
+SOURCES += qlogdecode.cpp
+
+QMAKE_TARGET_DESCRIPTION = "Qt Binary Log Decoder"
+
+load(qt_tool)
@@ -0,0 +1,671 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// Compiles the shared-mime-info database bundled with QtCore
+// (freedesktop.org.xml) into the binary mime.cache format, version 1.2,
+// as described in the shared-mime-info specification. mime.cache does not
+// carry the list of MIME types, nor their comments and glob patterns, so a
+// table with those is appended and its offset stored right after the
+// standard header. The result is written out as a C++ array that
+// QMimeBinaryProvider reads in place.
+
+#include <qbytearray.h>
+#include <qendian.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qmap.h>
+#include <qvector.h>
+#include <qxmlstream.h>
+#include <qdebug.h>
+
+#include <algorithm>
+#include <iterator>
+
+struct Glob
+{
+    QString pattern;
+    QByteArray mimeType;
+    int weight;
+    bool caseSensitive;
+};
+
+struct Matchlet
+{
+    int rangeStart;
+    int rangeLength;
+    int wordSize;
+    QByteArray value;
+    QByteArray mask;
+    QVector<Matchlet> children;
+};
+
+struct Match
+{
+    int priority;
+    QByteArray mimeType;
+    QVector<Matchlet> matchlets;
+};
+
+struct MimeType
+{
+    QMap<QByteArray, QByteArray> comments; // lang -> UTF-8 text
+    QVector<QByteArray> globPatterns;
+};
+
+struct Database
+{
+    QMap<QByteArray, MimeType> mimeTypes;
+    QMap<QByteArray, QByteArray> aliases;
+    QMap<QByteArray, QVector<QByteArray> > parents;
+    QMap<QByteArray, QByteArray> icons;
+    QMap<QByteArray, QByteArray> genericIcons;
+    QVector<Glob> globs;
+    QVector<Match> matches;
+};
+
+// Same escapes as makePattern() in qmimemagicrule.cpp
+static QByteArray makePattern(const QByteArray &value)
+{
+    QByteArray pattern;
+    const char *p = value.constData();
+    const char *e = p + value.size();
+    for ( ; p < e; ++p) {
+        if (*p == '\\' && ++p < e) {
+            if (*p == 'x') { // hex (\\xff)
+                char c = 0;
+                for (int i = 0; i < 2 && p + 1 < e; ++i) {
+                    ++p;
+                    if (*p >= '0' && *p <= '9')
+                        c = (c << 4) + *p - '0';
+                    else if (*p >= 'a' && *p <= 'f')
+                        c = (c << 4) + *p - 'a' + 10;
+                    else if (*p >= 'A' && *p <= 'F')
+                        c = (c << 4) + *p - 'A' + 10;
+                    else
+                        continue;
+                }
+                pattern += c;
+            } else if (*p >= '0' && *p <= '7') { // oct (\\7, or \\77, or \\377)
+                char c = *p - '0';
+                if (p + 1 < e && p[1] >= '0' && p[1] <= '7') {
+                    c = (c << 3) + *(++p) - '0';
+                    if (p + 1 < e && p[1] >= '0' && p[1] <= '7' && p[-1] <= '3')
+                        c = (c << 3) + *(++p) - '0';
+                }
+                pattern += c;
+            } else if (*p == 'n') {
+                pattern += '\n';
+            } else if (*p == 'r') {
+                pattern += '\r';
+            } else if (*p == 't') {
+                pattern += '\t';
+            } else { // escaped
+                pattern += *p;
+            }
+        } else {
+            pattern += *p;
+        }
+    }
+    return pattern;
+}
+
+static QByteArray numberBytes(quint32 number, int size, bool littleEndian)
+{
+    QByteArray result(size, '\0');
+    for (int i = 0; i < size; ++i) {
+        const int shift = littleEndian ? 8 * i : 8 * (size - 1 - i);
+        result[i] = char(number >> shift);
+    }
+    return result;
+}
+
+static bool parseMatchlet(const QXmlStreamAttributes &atts, Matchlet *matchlet, QString *errorMessage)
+{
+    const QString type = atts.value(QLatin1String("type")).toString();
+    const QByteArray value = atts.value(QLatin1String("value")).toUtf8();
+    const QByteArray mask = atts.value(QLatin1String("mask")).toLatin1();
+    const QStringRef offset = atts.value(QLatin1String("offset"));
+
+    const int colonIndex = offset.indexOf(QLatin1Char(':'));
+    bool startOk, endOk = true;
+    const int start = offset.left(colonIndex).toInt(&startOk);
+    const int end = colonIndex == -1 ? start : offset.mid(colonIndex + 1).toInt(&endOk);
+    if (!startOk || (colonIndex != -1 && !endOk) || end < start) {
+        *errorMessage = QLatin1String("Invalid offset ") + offset;
+        return false;
+    }
+    if (value.isEmpty()) {
+        *errorMessage = QLatin1String("Invalid empty magic rule value");
+        return false;
+    }
+    matchlet->rangeStart = start;
+    matchlet->rangeLength = end - start + 1;
+    matchlet->wordSize = 1;
+
+    if (type == QLatin1String("string")) {
+        matchlet->value = makePattern(value);
+        if (!mask.isEmpty()) {
+            matchlet->mask = QByteArray::fromHex(mask.mid(2));
+            if (!mask.startsWith("0x") || matchlet->mask.size() != matchlet->value.size()) {
+                *errorMessage = QLatin1String("Invalid magic rule mask ") + QLatin1String(mask);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static const struct {
+        char name[9];
+        int size;
+        bool littleEndian;
+        bool host;
+    } numberTypes[] = {
+        { "byte", 1, false, false },
+        { "big16", 2, false, false },
+        { "big32", 4, false, false },
+        { "little16", 2, true, false },
+        { "little32", 4, true, false },
+        { "host16", 2, false, true },
+        { "host32", 4, false, true }
+    };
+    const auto *numberType = std::begin(numberTypes);
+    while (numberType != std::end(numberTypes) && type != QLatin1String(numberType->name))
+        ++numberType;
+    if (numberType == std::end(numberTypes)) {
+        *errorMessage = QLatin1String("Type ") + type + QLatin1String(" is not supported");
+        return false;
+    }
+    const int size = numberType->size;
+    const bool littleEndian = numberType->littleEndian;
+    // Host-endian values are stored big-endian; the word size tells the
+    // reader that they need swapping on little-endian machines.
+    if (numberType->host)
+        matchlet->wordSize = size;
+
+    bool ok;
+    const quint32 number = value.toUInt(&ok, 0); // autodetect base
+    const quint32 limit = size == 4 ? quint32(-1) : (1u << (8 * size)) - 1;
+    if (!ok || number > limit) {
+        *errorMessage = QLatin1String("Invalid magic rule value ") + QLatin1String(value);
+        return false;
+    }
+    matchlet->value = numberBytes(number, size, littleEndian);
+    if (!mask.isEmpty()) {
+        const quint32 numberMask = mask.toUInt(&ok, 0);
+        if (!ok) {
+            *errorMessage = QLatin1String("Invalid magic rule mask ") + QLatin1String(mask);
+            return false;
+        }
+        matchlet->mask = numberBytes(numberMask, size, littleEndian);
+    }
+    return true;
+}
+
+static bool parseMatchlets(QXmlStreamReader &xml, QVector<Matchlet> *matchlets)
+{
+    while (xml.readNextStartElement()) {
+        if (xml.name() != QLatin1String("match")) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        Matchlet matchlet;
+        QString errorMessage;
+        if (!parseMatchlet(xml.attributes(), &matchlet, &errorMessage)) {
+            xml.raiseError(errorMessage);
+            return false;
+        }
+        if (!parseMatchlets(xml, &matchlet.children))
+            return false;
+        matchlets->append(matchlet);
+    }
+    return !xml.hasError();
+}
+
+static bool parseMimeType(QXmlStreamReader &xml, Database *db)
+{
+    const QByteArray name = xml.attributes().value(QLatin1String("type")).toLatin1();
+    if (name.isEmpty()) {
+        xml.raiseError(QStringLiteral("Missing 'type'-attribute"));
+        return false;
+    }
+    MimeType &mimeType = db->mimeTypes[name];
+    QString mainPattern;
+
+    while (xml.readNextStartElement()) {
+        const QStringRef tag = xml.name();
+        const QXmlStreamAttributes atts = xml.attributes();
+        if (tag == QLatin1String("comment")) {
+            QByteArray lang = atts.value(QLatin1String("xml:lang")).toLatin1();
+            if (lang.isEmpty())
+                lang = "en_US";
+            mimeType.comments.insert(lang, xml.readElementText().toUtf8());
+            continue; // we called readElementText, so we're at the EndElement already.
+        } else if (tag == QLatin1String("glob")) {
+            const QString pattern = atts.value(QLatin1String("pattern")).toString();
+            int weight = atts.value(QLatin1String("weight")).toInt();
+            if (weight == 0)
+                weight = 50;
+            const bool caseSensitive = atts.value(QLatin1String("case-sensitive")) == QLatin1String("true");
+            db->globs.append({ pattern, name, weight, caseSensitive });
+            if (mainPattern.isEmpty() && pattern.startsWith(QLatin1Char('*')))
+                mainPattern = pattern;
+            if (!mimeType.globPatterns.contains(pattern.toLatin1()))
+                mimeType.globPatterns.append(pattern.toLatin1());
+        } else if (tag == QLatin1String("sub-class-of")) {
+            const QByteArray parent = atts.value(QLatin1String("type")).toLatin1();
+            if (!parent.isEmpty())
+                db->parents[name].append(parent);
+        } else if (tag == QLatin1String("alias")) {
+            const QByteArray alias = atts.value(QLatin1String("type")).toLatin1();
+            if (!alias.isEmpty())
+                db->aliases.insert(alias, name);
+        } else if (tag == QLatin1String("icon")) {
+            db->icons.insert(name, atts.value(QLatin1String("name")).toLatin1());
+        } else if (tag == QLatin1String("generic-icon")) {
+            db->genericIcons.insert(name, atts.value(QLatin1String("name")).toLatin1());
+        } else if (tag == QLatin1String("magic")) {
+            Match match;
+            match.mimeType = name;
+            match.priority = 50;
+            const QStringRef priority = atts.value(QLatin1String("priority"));
+            bool ok = true;
+            if (!priority.isEmpty())
+                match.priority = priority.toInt(&ok);
+            if (!ok) {
+                xml.raiseError(QLatin1String("Not a number '") + priority + QLatin1String("'."));
+                return false;
+            }
+            if (!parseMatchlets(xml, &match.matchlets))
+                return false;
+            db->matches.append(match);
+            continue; // parseMatchlets stopped at the EndElement already.
+        }
+        xml.skipCurrentElement();
+    }
+
+    // Like QMimeBinaryProvider::loadMimeTypePrivate, list the main pattern first
+    if (!mainPattern.isEmpty()) {
+        const QByteArray main = mainPattern.toLatin1();
+        mimeType.globPatterns.removeAll(main);
+        mimeType.globPatterns.prepend(main);
+    }
+    return !xml.hasError();
+}
+
+static bool parseDatabase(QIODevice *device, Database *db, QString *errorMessage)
+{
+    QXmlStreamReader xml(device);
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("mime-info")) {
+        while (xml.readNextStartElement()) {
+            if (xml.name() == QLatin1String("mime-type")) {
+                if (!parseMimeType(xml, db))
+                    break;
+            } else {
+                xml.skipCurrentElement();
+            }
+        }
+    } else if (!xml.hasError()) {
+        xml.raiseError(QStringLiteral("Expected a mime-info element"));
+    }
+    if (xml.hasError()) {
+        *errorMessage = QString::fromLatin1("line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    return true;
+}
+
+class CacheWriter
+{
+public:
+    QByteArray data;
+
+    int allocate(int size)
+    {
+        while (data.size() % 4)
+            data.append('\0');
+        const int offset = data.size();
+        data.append(QByteArray(size, '\0'));
+        return offset;
+    }
+    void setUint16(int offset, quint16 value) { qToBigEndian(value, data.data() + offset); }
+    void setUint32(int offset, quint32 value) { qToBigEndian(value, data.data() + offset); }
+
+    int string(const QByteArray &str)
+    {
+        QHash<QByteArray, int>::const_iterator it = m_strings.constFind(str);
+        if (it != m_strings.constEnd())
+            return it.value();
+        const int offset = data.size();
+        data.append(str.constData(), str.size() + 1); // including '\0'
+        m_strings.insert(str, offset);
+        return offset;
+    }
+    int bytes(const QByteArray &value)
+    {
+        const int offset = data.size();
+        data.append(value);
+        return offset;
+    }
+
+private:
+    QHash<QByteArray, int> m_strings;
+};
+
+// Position of the "list offsets" values, at the beginning of the mime.cache file
+enum {
+    PosAliasListOffset = 4,
+    PosParentListOffset = 8,
+    PosLiteralListOffset = 12,
+    PosReverseSuffixTreeOffset = 16,
+    PosGlobListOffset = 20,
+    PosMagicListOffset = 24,
+    PosNamespaceListOffset = 28,
+    PosIconsListOffset = 32,
+    PosGenericIconsListOffset = 36,
+    PosMimeTypeListOffset = 40, // not in mime.cache
+    HeaderSize = 44
+};
+
+static int writeStringMap(CacheWriter &w, const QMap<QByteArray, QByteArray> &map)
+{
+    const int offset = w.allocate(4 + 8 * map.size());
+    w.setUint32(offset, map.size());
+    int entry = offset + 4;
+    for (QMap<QByteArray, QByteArray>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+        w.setUint32(entry, w.string(it.key()));
+        w.setUint32(entry + 4, w.string(it.value()));
+        entry += 8;
+    }
+    return offset;
+}
+
+static int writeParents(CacheWriter &w, const Database &db)
+{
+    const int offset = w.allocate(4 + 8 * db.parents.size());
+    w.setUint32(offset, db.parents.size());
+    int entry = offset + 4;
+    for (QMap<QByteArray, QVector<QByteArray> >::const_iterator it = db.parents.constBegin(); it != db.parents.constEnd(); ++it) {
+        const QVector<QByteArray> &parents = it.value();
+        const int listOffset = w.allocate(4 + 4 * parents.size());
+        w.setUint32(listOffset, parents.size());
+        for (int i = 0; i < parents.size(); ++i)
+            w.setUint32(listOffset + 4 + 4 * i, w.string(parents.at(i)));
+        w.setUint32(entry, w.string(it.key()));
+        w.setUint32(entry + 4, listOffset);
+        entry += 8;
+    }
+    return offset;
+}
+
+static quint32 flagsAndWeight(const Glob &glob)
+{
+    return glob.weight | (glob.caseSensitive ? 0x100 : 0);
+}
+
+static int writeGlobList(CacheWriter &w, const QVector<Glob> &globs)
+{
+    const int offset = w.allocate(4 + 12 * globs.size());
+    w.setUint32(offset, globs.size());
+    for (int i = 0; i < globs.size(); ++i) {
+        const Glob &glob = globs.at(i);
+        const int entry = offset + 4 + 12 * i;
+        w.setUint32(entry, w.string(glob.pattern.toLatin1()));
+        w.setUint32(entry + 4, w.string(glob.mimeType));
+        w.setUint32(entry + 8, flagsAndWeight(glob));
+    }
+    return offset;
+}
+
+struct SuffixNode
+{
+    QMap<ushort, int> children; // character -> index in the node pool
+    QVector<QPair<QByteArray, quint32> > leaves; // MIME type, flags and weight
+};
+
+static int writeSuffixNodes(CacheWriter &w, const QVector<SuffixNode> &pool, int index)
+{
+    const SuffixNode &node = pool.at(index);
+    const int count = node.leaves.size() + node.children.size();
+    const int offset = w.allocate(12 * count);
+    int entry = offset;
+    // Leaves have the character 0, so they sort first
+    for (const auto &leaf : node.leaves) {
+        w.setUint32(entry + 4, w.string(leaf.first));
+        w.setUint32(entry + 8, leaf.second);
+        entry += 12;
+    }
+    for (QMap<ushort, int>::const_iterator it = node.children.constBegin(); it != node.children.constEnd(); ++it) {
+        const SuffixNode &child = pool.at(it.value());
+        const int childrenOffset = writeSuffixNodes(w, pool, it.value());
+        w.setUint32(entry, it.key());
+        w.setUint32(entry + 4, child.leaves.size() + child.children.size());
+        w.setUint32(entry + 8, childrenOffset);
+        entry += 12;
+    }
+    return offset;
+}
+
+static int writeSuffixTree(CacheWriter &w, const QVector<Glob> &suffixGlobs)
+{
+    QVector<SuffixNode> pool(1);
+    for (const Glob &glob : suffixGlobs) {
+        int node = 0;
+        for (int i = glob.pattern.size() - 1; i > 0; --i) { // skip the leading '*'
+            const ushort ch = glob.pattern.at(i).unicode();
+            int child = pool.at(node).children.value(ch, -1);
+            if (child == -1) {
+                child = pool.size();
+                pool.append(SuffixNode());
+                pool[node].children.insert(ch, child);
+            }
+            node = child;
+        }
+        const QPair<QByteArray, quint32> leaf(glob.mimeType, flagsAndWeight(glob));
+        if (!pool.at(node).leaves.contains(leaf))
+            pool[node].leaves.append(leaf);
+    }
+
+    const int offset = w.allocate(8);
+    w.setUint32(offset, pool.at(0).children.size());
+    w.setUint32(offset + 4, writeSuffixNodes(w, pool, 0));
+    return offset;
+}
+
+static int maxExtent(const QVector<Matchlet> &matchlets)
+{
+    int extent = 0;
+    for (const Matchlet &matchlet : matchlets) {
+        extent = qMax(extent, matchlet.rangeStart + matchlet.rangeLength + matchlet.value.size() - 1);
+        extent = qMax(extent, maxExtent(matchlet.children));
+    }
+    return extent;
+}
+
+static int writeMatchlets(CacheWriter &w, const QVector<Matchlet> &matchlets)
+{
+    const int offset = w.allocate(32 * matchlets.size());
+    for (int i = 0; i < matchlets.size(); ++i) {
+        const Matchlet &matchlet = matchlets.at(i);
+        const int entry = offset + 32 * i;
+        w.setUint32(entry, matchlet.rangeStart);
+        w.setUint32(entry + 4, matchlet.rangeLength);
+        w.setUint32(entry + 8, matchlet.wordSize);
+        w.setUint32(entry + 12, matchlet.value.size());
+        w.setUint32(entry + 16, w.bytes(matchlet.value));
+        w.setUint32(entry + 20, matchlet.mask.isEmpty() ? 0 : w.bytes(matchlet.mask));
+        w.setUint32(entry + 24, matchlet.children.size());
+        w.setUint32(entry + 28, matchlet.children.isEmpty() ? 0 : writeMatchlets(w, matchlet.children));
+    }
+    return offset;
+}
+
+static int writeMagic(CacheWriter &w, QVector<Match> matches)
+{
+    // QMimeBinaryProvider returns the first match. Keep the file order among
+    // equal priorities, which is what the XML provider picks too.
+    std::stable_sort(matches.begin(), matches.end(), [](const Match &lhs, const Match &rhs) {
+        return lhs.priority > rhs.priority;
+    });
+
+    const int offset = w.allocate(12 + 16 * matches.size());
+    int extent = 0;
+    for (int i = 0; i < matches.size(); ++i) {
+        const Match &match = matches.at(i);
+        const int entry = offset + 12 + 16 * i;
+        w.setUint32(entry, match.priority);
+        w.setUint32(entry + 4, w.string(match.mimeType));
+        w.setUint32(entry + 8, match.matchlets.size());
+        w.setUint32(entry + 12, writeMatchlets(w, match.matchlets));
+        extent = qMax(extent, maxExtent(match.matchlets));
+    }
+    w.setUint32(offset, matches.size());
+    w.setUint32(offset + 4, extent);
+    w.setUint32(offset + 8, offset + 12);
+    return offset;
+}
+
+static int writeMimeTypes(CacheWriter &w, const Database &db)
+{
+    const int offset = w.allocate(4 + 12 * db.mimeTypes.size());
+    w.setUint32(offset, db.mimeTypes.size());
+    int entry = offset + 4;
+    for (QMap<QByteArray, MimeType>::const_iterator it = db.mimeTypes.constBegin(); it != db.mimeTypes.constEnd(); ++it) {
+        const MimeType &mimeType = it.value();
+        const int commentsOffset = writeStringMap(w, mimeType.comments);
+        const int patternsOffset = w.allocate(4 + 4 * mimeType.globPatterns.size());
+        w.setUint32(patternsOffset, mimeType.globPatterns.size());
+        for (int i = 0; i < mimeType.globPatterns.size(); ++i)
+            w.setUint32(patternsOffset + 4 + 4 * i, w.string(mimeType.globPatterns.at(i)));
+        w.setUint32(entry, w.string(it.key()));
+        w.setUint32(entry + 4, commentsOffset);
+        w.setUint32(entry + 8, patternsOffset);
+        entry += 12;
+    }
+    return offset;
+}
+
+static QByteArray writeCache(const Database &db)
+{
+    // Sort the globs like update-mime-database does: literals ("Makefile"),
+    // simple "*.suffix" patterns for the reverse suffix tree, and the rest
+    QVector<Glob> literals, suffixes, globs;
+    for (Glob glob : db.globs) {
+        if (!glob.caseSensitive)
+            glob.pattern = glob.pattern.toLower();
+        const QStringRef rest = glob.pattern.midRef(1);
+        const auto isWildcard = [](QChar ch) {
+            return ch == QLatin1Char('*') || ch == QLatin1Char('?') || ch == QLatin1Char('[');
+        };
+        if (std::none_of(glob.pattern.cbegin(), glob.pattern.cend(), isWildcard))
+            literals.append(glob);
+        else if (glob.pattern.startsWith(QLatin1Char('*')) && !rest.isEmpty()
+                 && std::none_of(rest.cbegin(), rest.cend(), isWildcard))
+            suffixes.append(glob);
+        else
+            globs.append(glob);
+    }
+    std::stable_sort(literals.begin(), literals.end(), [](const Glob &lhs, const Glob &rhs) {
+        return lhs.pattern < rhs.pattern;
+    });
+
+    CacheWriter w;
+    const int header = w.allocate(HeaderSize);
+    w.setUint16(header, 1); // major
+    w.setUint16(header + 2, 2); // minor
+    w.setUint32(header + PosAliasListOffset, writeStringMap(w, db.aliases));
+    w.setUint32(header + PosParentListOffset, writeParents(w, db));
+    w.setUint32(header + PosLiteralListOffset, writeGlobList(w, literals));
+    w.setUint32(header + PosReverseSuffixTreeOffset, writeSuffixTree(w, suffixes));
+    w.setUint32(header + PosGlobListOffset, writeGlobList(w, globs));
+    w.setUint32(header + PosMagicListOffset, writeMagic(w, db.matches));
+    w.setUint32(header + PosNamespaceListOffset, writeStringMap(w, QMap<QByteArray, QByteArray>()));
+    w.setUint32(header + PosIconsListOffset, writeStringMap(w, db.icons));
+    w.setUint32(header + PosGenericIconsListOffset, writeStringMap(w, db.genericIcons));
+    w.setUint32(header + PosMimeTypeListOffset, writeMimeTypes(w, db));
+    w.allocate(0); // pad to a multiple of 4
+    return w.data;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        qWarning("Usage: %s freedesktop.org.xml output.cpp", argv[0]);
+        return 1;
+    }
+
+    QFile input(QFile::decodeName(argv[1]));
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning() << "Abort: Failed to open" << input.fileName();
+        return 1;
+    }
+    Database db;
+    QString errorMessage;
+    if (!parseDatabase(&input, &db, &errorMessage)) {
+        qWarning("Abort: Error parsing %s, %s", argv[1], qPrintable(errorMessage));
+        return 1;
+    }
+    for (const Glob &glob : qAsConst(db.globs)) {
+        if (glob.pattern.toLatin1() != glob.pattern.toUtf8()) {
+            qWarning() << "Abort: Glob pattern" << glob.pattern << "is not ASCII";
+            return 1;
+        }
+    }
+
+    const QByteArray cache = writeCache(db);
+
+    QFile output(QFile::decodeName(argv[2]));
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Abort: Failed to open/create file" << output.fileName();
+        return 1;
+    }
+
+    output.write("/* This file was generated by gen_qmime_cache.cpp */\n\n");
+    output.write("#include <QtCore/qglobal.h>\n\n");
+    output.write("QT_BEGIN_NAMESPACE\n\n");
+    output.write("extern const uchar qt_mime_cache_data[];\n");
+    output.write("extern const uint qt_mime_cache_size;\n\n");
+    output.write("Q_DECL_ALIGN(4) const uchar qt_mime_cache_data[] = {\n");
+    static const char hexDigits[] = "0123456789abcdef";
+    QByteArray line;
+    for (int i = 0; i < cache.size(); ++i) {
+        const uchar c = uchar(cache.at(i));
+        line += "0x";
+        line += hexDigits[c >> 4];
+        line += hexDigits[c & 0xf];
+        line += ',';
+        if (i % 16 == 15 || i == cache.size() - 1) {
+            line += '\n';
+            output.write(line);
+            line.clear();
+        }
+    }
+    output.write("};\n\n");
+    output.write("const uint qt_mime_cache_size = sizeof(qt_mime_cache_data);\n\n");
+    output.write("QT_END_NAMESPACE\n");
+    return 0;
+}
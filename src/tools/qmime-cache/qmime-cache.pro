@@ -0,0 +1,9 @@
+option(host_build)
+
+CONFIG += force_bootstrap
+SOURCES += gen_qmime_cache.cpp
+
+load(qt_tool)
+
+lib.CONFIG = dummy_install
+INSTALLS = lib
@@ -38,6 +38,9 @@
 #include <qlocale.h>
 #include <qstack.h>
 #include <qxmlstream.h>
+#include <qvector.h>
+
+#include <private/qresourceindex_p.h>
 
 #include <algorithm>
 
@@ -121,6 +124,7 @@ public:
     qint64 m_nameOffset;
     qint64 m_dataOffset;
     qint64 m_childOffset;
+    int m_node;
 };
 
 RCCFileInfo::RCCFileInfo(const QString &name, const QFileInfo &fileInfo,
@@ -136,6 +140,7 @@ RCCFileInfo::RCCFileInfo(const QString &name, const QFileInfo &fileInfo,
     m_nameOffset = 0;
     m_dataOffset = 0;
     m_childOffset = 0;
+    m_node = 0;
     m_compressLevel = compressLevel;
     m_compressThreshold = compressThreshold;
 }
@@ -1009,12 +1014,16 @@ bool RCCResourceLibrary::writeDataStructure()
         //write out the actual data now
         for (int i = 0; i < m_children.size(); ++i) {
             RCCFileInfo *child = m_children.at(i);
-            ++offset;
+            child->m_node = offset++;
             if (child->m_flags & RCCFileInfo::Directory)
                 pending.push(child);
         }
     }
 
+    //write out the path index in front of the tree
+    if (m_formatVersion >= 3)
+        writeDataIndex();
+
     //write out the structure (ie iterate again!)
     pending.push(m_root);
     m_root->writeDataInfo(*this);
@@ -1039,6 +1048,161 @@ bool RCCResourceLibrary::writeDataStructure()
     return true;
 }
 
+struct RCCIndexEntry
+{
+    quint64 hash;
+    int node;
+    int parent; // index of the parent directory's entry, -1 for the root
+};
+Q_DECLARE_TYPEINFO(RCCIndexEntry, Q_PRIMITIVE_TYPE);
+
+struct qt_rcc_compare_bucket_size
+{
+    typedef bool result_type;
+    result_type operator()(const QVector<int> &left, const QVector<int> &right) const
+    {
+        return left.size() > right.size();
+    }
+};
+
+static bool buildDataIndex(const QVector<RCCIndexEntry> &entries, quint32 slotCount,
+                           QVector<quint32> *displacements, QVector<int> *slotTable)
+{
+    const quint32 bucketCount = displacements->size();
+    QVector<QVector<int> > buckets(bucketCount);
+    for (int i = 0; i < entries.size(); ++i)
+        buckets[qResourceIndexBucket(entries.at(i).hash, bucketCount)].append(i);
+    for (quint32 b = 0; b < bucketCount; ++b) {
+        if (!buckets.at(b).isEmpty())
+            buckets[b].prepend(int(b)); // remember the bucket number across the sort
+    }
+    // place the biggest buckets first, while the table is still empty
+    std::stable_sort(buckets.begin(), buckets.end(), qt_rcc_compare_bucket_size());
+
+    slotTable->fill(-1, slotCount);
+    QVector<quint32> candidate;
+    for (const QVector<int> &bucket : qAsConst(buckets)) {
+        if (bucket.isEmpty())
+            break;
+        bool placed = false;
+        for (quint32 d = 0; d < (1u << 20) && !placed; ++d) {
+            candidate.clear();
+            placed = true;
+            for (int i = 1; i < bucket.size(); ++i) {
+                const quint32 slot = qResourceIndexSlot(entries.at(bucket.at(i)).hash, d, slotCount);
+                if (slotTable->at(slot) != -1 || candidate.contains(slot)) {
+                    placed = false;
+                    break;
+                }
+                candidate.append(slot);
+            }
+            if (placed) {
+                for (int i = 1; i < bucket.size(); ++i)
+                    (*slotTable)[candidate.at(i - 1)] = bucket.at(i);
+                (*displacements)[bucket.at(0)] = d;
+            }
+        }
+        if (!placed)
+            return false;
+    }
+    return true;
+}
+
+bool RCCResourceLibrary::writeDataIndex()
+{
+    const bool text = m_format == C_Code || m_format == Pass1;
+
+    // collect one entry per path; localized files share the entry of
+    // the first node carrying their name
+    struct PendingDir {
+        RCCFileInfo *file;
+        QString path;
+        int entry;
+    };
+    QVector<RCCIndexEntry> entries;
+    QHash<QString, int> entryForPath;
+    QStack<PendingDir> pending;
+    pending.push({ m_root, QString(), -1 });
+    while (!pending.isEmpty()) {
+        const PendingDir dir = pending.pop();
+        for (QHash<QString, RCCFileInfo*>::const_iterator it = dir.file->m_children.cbegin();
+             it != dir.file->m_children.cend(); ++it) {
+            RCCFileInfo *child = it.value();
+            const QString path = dir.path + QLatin1Char('/') + child->m_name;
+            QHash<QString, int>::iterator existing = entryForPath.find(path);
+            if (existing != entryForPath.end()) {
+                RCCIndexEntry &entry = entries[existing.value()];
+                entry.node = qMin(entry.node, child->m_node);
+                continue;
+            }
+            const RCCIndexEntry entry = { qResourceIndexHash(path.constData(), path.size()),
+                                          child->m_node, dir.entry };
+            entryForPath.insert(path, entries.size());
+            entries.append(entry);
+            if (child->m_flags & RCCFileInfo::Directory)
+                pending.push({ child, path, entries.size() - 1 });
+        }
+    }
+
+    quint32 bucketCount = 0;
+    quint32 slotCount = 0;
+    QVector<quint32> displacements;
+    QVector<int> slotTable;
+    if (!entries.isEmpty()) {
+        QVector<quint64> hashes;
+        hashes.reserve(entries.size());
+        for (const RCCIndexEntry &entry : qAsConst(entries))
+            hashes.append(entry.hash);
+        std::sort(hashes.begin(), hashes.end());
+        if (std::adjacent_find(hashes.cbegin(), hashes.cend()) == hashes.cend()) {
+            bucketCount = entries.size() / 4 + 1;
+            slotCount = entries.size() + entries.size() / 4 + 1;
+            displacements.fill(0, bucketCount);
+            if (!buildDataIndex(entries, slotCount, &displacements, &slotTable))
+                bucketCount = slotCount = 0;
+        }
+        if (!bucketCount)
+            m_errorDevice->write("Could not build a resource path index, resources will be looked up through the tree\n");
+    }
+
+    if (text)
+        writeString("  // path index\n  ");
+    writeNumber4(QResourceIndexHeaderSize - 4 + bucketCount * 4 + slotCount * QResourceIndexSlotSize);
+    writeNumber4(bucketCount);
+    writeNumber4(slotCount);
+    if (text)
+        writeString("\n  ");
+    for (quint32 b = 0; b < bucketCount; ++b) {
+        writeNumber4(displacements.at(b));
+        if (text && b % 4 == 3)
+            writeString("\n  ");
+    }
+    if (text && bucketCount)
+        writeString("\n  ");
+
+    QVector<quint32> slotOfEntry(entries.size());
+    for (quint32 slot = 0; slot < slotCount; ++slot) {
+        if (slotTable.at(slot) != -1)
+            slotOfEntry[slotTable.at(slot)] = slot;
+    }
+    for (quint32 slot = 0; slot < slotCount; ++slot) {
+        const int e = slotTable.at(slot);
+        if (e == -1) {
+            writeNumber4(QResourceIndexNoSlot);
+            writeNumber4(QResourceIndexNoSlot);
+        } else {
+            const int parent = entries.at(e).parent;
+            writeNumber4(entries.at(e).node);
+            writeNumber4(parent == -1 ? QResourceIndexNoSlot : slotOfEntry.at(parent));
+        }
+        if (text && slot % 2 == 1)
+            writeString("\n  ");
+    }
+    if (text)
+        writeString("\n");
+    return true;
+}
+
 void RCCResourceLibrary::writeMangleNamespaceFunction(const QByteArray &name)
 {
     if (m_useNameSpace) {
@@ -114,6 +114,7 @@ private:
     bool writeDataBlobs();
     bool writeDataNames();
     bool writeDataStructure();
+    bool writeDataIndex();
     bool writeInitializer();
     void writeMangleNamespaceFunction(const QByteArray &name);
     void writeAddNamespaceFunction(const QByteArray &name);
@@ -55,9 +55,20 @@
 #include "private/qxml_p.h"
 #include <qvariant.h>
 #include <qmap.h>
+#include <qmutex.h>
 #include <qshareddata.h>
+#include <qthread.h>
+#include <qxmlstream.h>
 #include <qdebug.h>
 #include <stdio.h>
+#include <stdlib.h>
+#if defined(Q_OS_WIN)
+#  include <malloc.h>
+#endif
+
+#if defined(Q_OS_UNIX) || defined(Q_OS_WIN)
+#  define QT_DOM_NODE_POOL
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -189,8 +200,23 @@ public:
 
     void setLocation(int lineNumber, int columnNumber);
 
+    inline void ensureChildren() const
+    {
+        if (Q_UNLIKELY(hasLazyChildren))
+            const_cast<QDomNodePrivate *>(this)->buildLazyChildren();
+    }
+    void buildLazyChildren();
+
+#ifdef QT_DOM_NODE_POOL
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+#endif
+
     // Variables
     QAtomicInt ref;
+    bool createdWithDom1Interface : 1;
+    bool hasParent                : 1;
+    bool hasLazyChildren          : 1; // children not built yet, see QDomLazySubtree
     QDomNodePrivate* prev;
     QDomNodePrivate* next;
     QDomNodePrivate* ownerNode; // either the node's parent or the node's owner document
@@ -201,8 +227,6 @@ public:
     QString value;
     QString prefix; // set this only for ElementNode and AttributeNode
     QString namespaceURI; // set this only for ElementNode and AttributeNode
-    bool createdWithDom1Interface : 1;
-    bool hasParent                : 1;
 
     int lineNumber;
     int columnNumber;
@@ -491,6 +515,21 @@ public:
     virtual void save(QTextStream& s, int, int) const Q_DECL_OVERRIDE;
 };
 
+/*
+  Keeps one copy of every distinct name seen while building a document, so
+  that all elements and attributes with the same name share their string
+  data instead of each holding a private copy.
+*/
+class QDomNameTable
+{
+public:
+    QString intern(const QStringRef &name);
+    void clear() { names.clear(); }
+
+private:
+    QMultiHash<uint, QString> names;
+};
+
 class QDomDocumentPrivate : public QDomNodePrivate
 {
 public:
@@ -502,6 +541,8 @@ public:
 
     bool setContent(QXmlInputSource *source, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn);
     bool setContent(QXmlInputSource *source, QXmlReader *reader, QXmlSimpleReader *simpleReader, QString *errorMsg, int *errorLine, int *errorColumn);
+    bool setContent(QXmlStreamReader *reader, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn);
+    bool setContentLazily(const QString &text, int depth, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn);
 
     // Attributes
     QDomDocumentTypePrivate* doctype() { return type.data(); }
@@ -617,6 +658,89 @@ private:
     QXmlSimpleReader *reader;
 };
 
+/**************************************************************
+ *
+ * QDomBuilder
+ *
+ **************************************************************/
+
+/*
+  The source text of a document read with QDomDocument::setContentLazily(),
+  shared by all subtrees of that document that have not been built yet.
+*/
+class QDomLazySource : public QSharedData
+{
+public:
+    QString text;
+    QDomNameTable names;
+    bool namespaceProcessing;
+};
+
+/*
+  An element whose children have not been built yet. The content of the
+  element is the range [begin, end) of the source text, end including the
+  element's end tag; lineNumber and columnNumber give the position of begin.
+
+  The subtrees are kept in a table indexed by element rather than in the
+  element itself, so that nodes do not grow for a feature most documents do
+  not use, and so that they stay valid when the element is moved to another
+  document or outlives its document.
+*/
+struct QDomLazySubtree
+{
+    QExplicitlySharedDataPointer<QDomLazySource> source;
+    int begin;
+    int end;
+    int lineNumber;
+    int columnNumber;
+    QXmlStreamNamespaceDeclarations namespaceDeclarations;
+
+    static void insert(const QDomNodePrivate *element, const QDomLazySubtree &subtree);
+    static bool take(const QDomNodePrivate *element, QDomLazySubtree *subtree);
+};
+
+class QDomBuilder
+{
+public:
+    QDomBuilder(QDomDocumentPrivate *d, QXmlStreamReader *reader, QDomNameTable *names, bool namespaceProcessing);
+
+    bool parseDocument(QDomLazySource *source = 0, int deferDepth = 0);
+    void parseSubtree(QDomNodePrivate *element, int lineNumber, int columnNumber);
+
+    QString errorMsg;
+    int errorLine;
+    int errorColumn;
+
+private:
+    void parseContent();
+    void startDocument();
+    void doctype();
+    void startElement();
+    void endElement();
+    void deferContent();
+    void characters();
+    void flushText();
+    void appendChild(QDomNodePrivate *n);
+    void setLocation(QDomNodePrivate *n, int line, int column);
+
+    QDomDocumentPrivate *doc;
+    QDomNodePrivate *node;
+    QXmlStreamReader *reader;
+    QDomNameTable *names;
+    QString text;
+    int textLine;
+    int textColumn;
+    bool nsProcessing;
+    int lineOffset;
+    int columnOffset;
+
+    QDomLazySource *lazySource;
+    int lazyDepth;
+    int depth;
+    QXmlStreamNamespaceDeclarations namespaceScope;
+    QVector<int> namespaceScopeSizes;
+};
+
 /**************************************************************
  *
  * Functions for verifying legal data
@@ -1192,6 +1316,7 @@ void QDomNodeListPrivate::createList()
     if (doc && timestamp != doc->nodeListTime)
         timestamp = doc->nodeListTime;
 
+    node_impl->ensureChildren();
     QDomNodePrivate* p = node_impl->first;
 
     list.clear();
@@ -1205,6 +1330,7 @@ void QDomNodeListPrivate::createList()
             if (p->isElement() && p->nodeName() == tagname) {
                 list.append(p);
             }
+            p->ensureChildren();
             if (p->first)
                 p = p->first;
             else if (p->next)
@@ -1222,6 +1348,7 @@ void QDomNodeListPrivate::createList()
             if (p->isElement() && p->name==tagname && p->namespaceURI==nsURI) {
                 list.append(p);
             }
+            p->ensureChildren();
             if (p->first)
                 p = p->first;
             else if (p->next)
@@ -1427,6 +1554,182 @@ int QDomNodeList::length() const
  *
  **************************************************************/
 
+#ifdef QT_DOM_NODE_POOL
+/*
+  Parsing creates a large number of small nodes of only a handful of
+  different sizes. Instead of going through the general purpose allocator
+  for every one of them, nodes are carved out of 64 KB blocks that each
+  serve a single size. This saves the allocator's per-object overhead and
+  keeps the nodes of a document close together in memory.
+
+  The block a node lives in is found by masking the node's address, so
+  blocks are aligned to their own size. A block is returned to the system
+  when its last node is deleted, unless it is the only block left with
+  free slots for its size in its pool.
+
+  There are several pools with a lock each, and every thread allocates
+  from the pool it was assigned on first use, so that threads building
+  documents at the same time do not serialize on a single lock. Nodes may
+  be deleted in another thread than the one that created them, so a block
+  remembers its pool, and a node is always returned to that pool.
+*/
+namespace {
+enum {
+    NodeBlockSize = 64 * 1024,
+    NodeSizeGranularity = 8,
+    MaxPooledNodeSize = 256,
+    NodePoolCount = 16
+};
+
+struct QDomNodePool;
+
+struct QDomNodeBlock
+{
+    QDomNodePool *pool;
+    QDomNodeBlock *prev; // in the pool's list of blocks with free slots
+    QDomNodeBlock *next;
+    void *freeSlots;
+    char *unusedSlots;
+    int slotSize;
+    int usedSlots;
+    bool available;
+
+    char *firstSlot() { return reinterpret_cast<char *>(this) + ((sizeof(QDomNodeBlock) + 15) & ~15); }
+    char *end() { return reinterpret_cast<char *>(this) + NodeBlockSize; }
+    bool isFull() { return !freeSlots && unusedSlots + slotSize > end(); }
+};
+
+struct QDomNodePool
+{
+    void *allocate(int sizeClass);
+    void release(QDomNodeBlock *block, void *ptr);
+
+    QBasicMutex mutex;
+    QDomNodeBlock *available[MaxPooledNodeSize / NodeSizeGranularity + 1];
+};
+}
+
+// not a Q_GLOBAL_STATIC: nodes may still be deleted during static destruction
+static QDomNodePool qt_domNodePools[NodePoolCount];
+static QBasicAtomicInt qt_domNextNodePool = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static QDomNodePool *currentNodePool()
+{
+#ifdef Q_COMPILER_THREAD_LOCAL
+    static thread_local QDomNodePool *pool =
+            &qt_domNodePools[uint(qt_domNextNodePool.fetchAndAddRelaxed(1)) % NodePoolCount];
+    return pool;
+#else
+    const quintptr id = quintptr(QThread::currentThreadId());
+    return &qt_domNodePools[(id ^ (id >> 12)) % NodePoolCount];
+#endif
+}
+
+static QDomNodeBlock *allocateNodeBlock()
+{
+    void *ptr;
+#if defined(Q_OS_WIN)
+    ptr = _aligned_malloc(NodeBlockSize, NodeBlockSize);
+#else
+    if (posix_memalign(&ptr, NodeBlockSize, NodeBlockSize) != 0)
+        ptr = 0;
+#endif
+    Q_CHECK_PTR(ptr);
+    return static_cast<QDomNodeBlock *>(ptr);
+}
+
+static void freeNodeBlock(QDomNodeBlock *block)
+{
+#if defined(Q_OS_WIN)
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+void *QDomNodePool::allocate(int sizeClass)
+{
+    QMutexLocker locker(&mutex);
+    QDomNodeBlock *block = available[sizeClass];
+    if (!block) {
+        block = allocateNodeBlock();
+        block->pool = this;
+        block->prev = 0;
+        block->next = 0;
+        block->freeSlots = 0;
+        block->unusedSlots = block->firstSlot();
+        block->slotSize = sizeClass * NodeSizeGranularity;
+        block->usedSlots = 0;
+        block->available = true;
+        available[sizeClass] = block;
+    }
+
+    void *ptr;
+    if (block->freeSlots) {
+        ptr = block->freeSlots;
+        block->freeSlots = *static_cast<void **>(ptr);
+    } else {
+        ptr = block->unusedSlots;
+        block->unusedSlots += block->slotSize;
+    }
+    ++block->usedSlots;
+
+    if (block->isFull()) {
+        available[sizeClass] = block->next;
+        if (block->next)
+            block->next->prev = 0;
+        block->next = 0;
+        block->available = false;
+    }
+    return ptr;
+}
+
+void QDomNodePool::release(QDomNodeBlock *block, void *ptr)
+{
+    const int sizeClass = block->slotSize / NodeSizeGranularity;
+    QMutexLocker locker(&mutex);
+    *static_cast<void **>(ptr) = block->freeSlots;
+    block->freeSlots = ptr;
+    --block->usedSlots;
+
+    if (!block->available) {
+        block->prev = 0;
+        block->next = available[sizeClass];
+        if (block->next)
+            block->next->prev = block;
+        available[sizeClass] = block;
+        block->available = true;
+    } else if (block->usedSlots == 0 && (block->prev || block->next)) {
+        if (block->prev)
+            block->prev->next = block->next;
+        else
+            available[sizeClass] = block->next;
+        if (block->next)
+            block->next->prev = block->prev;
+        locker.unlock();
+        freeNodeBlock(block);
+    }
+}
+
+void *QDomNodePrivate::operator new(size_t size)
+{
+    if (size > MaxPooledNodeSize)
+        return ::operator new(size);
+    const int sizeClass = int((size + NodeSizeGranularity - 1) / NodeSizeGranularity);
+    return currentNodePool()->allocate(sizeClass);
+}
+
+void QDomNodePrivate::operator delete(void *ptr, size_t size)
+{
+    if (size > MaxPooledNodeSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    QDomNodeBlock *block = reinterpret_cast<QDomNodeBlock *>(quintptr(ptr) & ~quintptr(NodeBlockSize - 1));
+    block->pool->release(block, ptr);
+}
+#endif // QT_DOM_NODE_POOL
+
 inline void QDomNodePrivate::setOwnerDocument(QDomDocumentPrivate *doc)
 {
     ownerNode = doc;
@@ -1444,6 +1747,7 @@ QDomNodePrivate::QDomNodePrivate(QDomDocumentPrivate *doc, QDomNodePrivate *par)
     first = 0;
     last = 0;
     createdWithDom1Interface = true;
+    hasLazyChildren = false;
     lineNumber = -1;
     columnNumber = -1;
 }
@@ -1461,18 +1765,25 @@ QDomNodePrivate::QDomNodePrivate(QDomNodePrivate *n, bool deep) : ref(1)
     prefix = n->prefix;
     namespaceURI = n->namespaceURI;
     createdWithDom1Interface = n->createdWithDom1Interface;
+    hasLazyChildren = false;
     lineNumber = -1;
     columnNumber = -1;
 
     if (!deep)
         return;
 
+    n->ensureChildren();
     for (QDomNodePrivate* x = n->first; x; x = x->next)
         appendChild(x->cloneNode(true));
 }
 
 QDomNodePrivate::~QDomNodePrivate()
 {
+    if (hasLazyChildren) {
+        QDomLazySubtree subtree;
+        QDomLazySubtree::take(this, &subtree);
+    }
+
     QDomNodePrivate* p = first;
     QDomNodePrivate* n;
 
@@ -1505,6 +1816,7 @@ void QDomNodePrivate::clear()
 
 QDomNodePrivate* QDomNodePrivate::namedItem(const QString &n)
 {
+    ensureChildren();
     QDomNodePrivate* p = first;
     while (p) {
         if (p->nodeName() == n)
@@ -1529,6 +1841,8 @@ QDomNodePrivate* QDomNodePrivate::insertBefore(QDomNodePrivate* newChild, QDomNo
     if (refChild && refChild->parent() != this)
         return 0;
 
+    ensureChildren();
+
     // "mark lists as dirty"
     QDomDocumentPrivate *const doc = ownerDocument();
     if(doc)
@@ -1624,6 +1938,8 @@ QDomNodePrivate* QDomNodePrivate::insertAfter(QDomNodePrivate* newChild, QDomNod
     if (refChild && refChild->parent() != this)
         return 0;
 
+    ensureChildren();
+
     // "mark lists as dirty"
     QDomDocumentPrivate *const doc = ownerDocument();
     if(doc)
@@ -1715,6 +2031,10 @@ QDomNodePrivate* QDomNodePrivate::replaceChild(QDomNodePrivate* newChild, QDomNo
     if (newChild == oldChild)
         return 0;
 
+    // The old child may end up in another document, so it cannot be left
+    // to build its children from this one later.
+    oldChild->ensureChildren();
+
     // mark lists as dirty
     QDomDocumentPrivate *const doc = ownerDocument();
     if(doc)
@@ -1806,6 +2126,9 @@ QDomNodePrivate* QDomNodePrivate::removeChild(QDomNodePrivate* oldChild)
     if (oldChild->parent() != this)
         return 0;
 
+    // See replaceChild()
+    oldChild->ensureChildren();
+
     // "mark lists as dirty"
     QDomDocumentPrivate *const doc = ownerDocument();
     if(doc)
@@ -1864,6 +2187,7 @@ QDomNodePrivate* QDomNodePrivate::cloneNode(bool deep)
 
 static void qNormalizeNode(QDomNodePrivate* n)
 {
+    n->ensureChildren();
     QDomNodePrivate* p = n->first;
     QDomTextPrivate* t = 0;
 
@@ -1896,6 +2220,7 @@ void QDomNodePrivate::normalize()
  */
 void QDomNodePrivate::save(QTextStream& s, int depth, int indent) const
 {
+    ensureChildren();
     const QDomNodePrivate* n = first;
     while (n) {
         n->save(s, depth, indent);
@@ -1909,6 +2234,32 @@ void QDomNodePrivate::setLocation(int lineNumber, int columnNumber)
     this->columnNumber = columnNumber;
 }
 
+void QDomNodePrivate::buildLazyChildren()
+{
+    hasLazyChildren = false;
+    QDomLazySubtree subtree;
+    if (!QDomLazySubtree::take(this, &subtree))
+        return;
+
+    // Parse the content behind a copy of the element's start tag, so that
+    // the reader checks the end tag against it.
+    const QString qName = prefix.isEmpty() ? name : prefix + QLatin1Char(':') + name;
+    const QStringRef content = subtree.source->text.midRef(subtree.begin, subtree.end - subtree.begin);
+    QString fragment;
+    fragment.reserve(qName.size() + 2 + content.size());
+    fragment += QLatin1Char('<');
+    fragment += qName;
+    fragment += QLatin1Char('>');
+    fragment += content;
+
+    QXmlStreamReader reader(fragment);
+    reader.setNamespaceProcessing(subtree.source->namespaceProcessing);
+    reader.addExtraNamespaceDeclarations(subtree.namespaceDeclarations);
+
+    QDomBuilder builder(ownerDocument(), &reader, &subtree.source->names, subtree.source->namespaceProcessing);
+    builder.parseSubtree(this, subtree.lineNumber, subtree.columnNumber - qName.size() - 2);
+}
+
 /**************************************************************
  *
  * QDomNode
@@ -2251,6 +2602,7 @@ QDomNode QDomNode::firstChild() const
 {
     if (!impl)
         return QDomNode();
+    IMPL->ensureChildren();
     return QDomNode(IMPL->first);
 }
 
@@ -2265,6 +2617,7 @@ QDomNode QDomNode::lastChild() const
 {
     if (!impl)
         return QDomNode();
+    IMPL->ensureChildren();
     return QDomNode(IMPL->last);
 }
 
@@ -2615,7 +2968,8 @@ bool QDomNode::hasChildNodes() const
 {
     if (!impl)
         return false;
-    return IMPL->first != 0;
+    // a subtree is only left unbuilt if it has child nodes
+    return IMPL->hasLazyChildren || IMPL->first != 0;
 }
 
 /*!
@@ -4542,6 +4896,7 @@ QString QDomElementPrivate::text()
 {
     QString t(QLatin1String(""));
 
+    ensureChildren();
     QDomNodePrivate* p = first;
     while (p) {
         if (p->isText() || p->isCDATASection())
@@ -4556,6 +4911,8 @@ QString QDomElementPrivate::text()
 
 void QDomElementPrivate::save(QTextStream& s, int depth, int indent) const
 {
+    ensureChildren();
+
     if (!(prev && prev->isText()))
         s << QString(indent < 1 ? 0 : depth * indent, QLatin1Char(' '));
 
@@ -6241,6 +6598,56 @@ bool QDomDocumentPrivate::setContent(QXmlInputSource *source, QXmlReader *reader
     return true;
 }
 
+bool QDomDocumentPrivate::setContent(QXmlStreamReader *reader, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn)
+{
+    clear();
+    impl = new QDomImplementationPrivate;
+    type = new QDomDocumentTypePrivate(this, this);
+    type->ref.deref();
+
+    QDomNameTable names;
+    reader->setNamespaceProcessing(namespaceProcessing);
+    QDomBuilder builder(this, reader, &names, namespaceProcessing);
+    if (!builder.parseDocument()) {
+        if (errorMsg)
+            *errorMsg = builder.errorMsg;
+        if (errorLine)
+            *errorLine = builder.errorLine;
+        if (errorColumn)
+            *errorColumn = builder.errorColumn;
+        return false;
+    }
+
+    return true;
+}
+
+bool QDomDocumentPrivate::setContentLazily(const QString &text, int depth, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn)
+{
+    clear();
+    impl = new QDomImplementationPrivate;
+    type = new QDomDocumentTypePrivate(this, this);
+    type->ref.deref();
+
+    QExplicitlySharedDataPointer<QDomLazySource> source(new QDomLazySource);
+    source->text = text;
+    source->namespaceProcessing = namespaceProcessing;
+
+    QXmlStreamReader reader(text);
+    reader.setNamespaceProcessing(namespaceProcessing);
+    QDomBuilder builder(this, &reader, &source->names, namespaceProcessing);
+    if (!builder.parseDocument(source.data(), depth)) {
+        if (errorMsg)
+            *errorMsg = builder.errorMsg;
+        if (errorLine)
+            *errorLine = builder.errorLine;
+        if (errorColumn)
+            *errorColumn = builder.errorColumn;
+        return false;
+    }
+
+    return true;
+}
+
 QDomNodePrivate* QDomDocumentPrivate::cloneNode(bool deep)
 {
     QDomNodePrivate *p = new QDomDocumentPrivate(this, deep);
@@ -6823,6 +7230,74 @@ bool QDomDocument::setContent(QXmlInputSource *source, QXmlReader *reader, QStri
     return IMPL->setContent(source, reader, 0, errorMsg, errorLine, errorColumn);
 }
 
+/*!
+    \overload
+    \since 5.10
+
+    This function reads the XML document from the QXmlStreamReader \a reader,
+    returning \c true if the content was successfully parsed; otherwise
+    returns \c false. The meaning of \a namespaceProcessing, \a errorMsg,
+    \a errorLine and \a errorColumn is the same as for the QByteArray
+    overload; the reader's \l{QXmlStreamReader::}{namespaceProcessing}
+    property is set according to \a namespaceProcessing.
+
+    Unlike the other overloads, this function does not go through
+    QXmlSimpleReader. Names are shared between all elements and attributes
+    that have the same name, and nodes are allocated in bulk, so the document
+    needs considerably less memory than one built from the same data by the
+    other overloads. The resulting tree is mostly the same, but
+    QXmlStreamReader is stricter about well-formedness and namespaces,
+    normalizes line breaks and attribute values as required by the XML
+    specification, and reports its own error messages. An XML declaration
+    with \c{standalone='no'} loses that part.
+
+    Reading starts at the reader's current position, and stops at the end of
+    the document or at the first error.
+
+    \sa setContentLazily()
+*/
+bool QDomDocument::setContent(QXmlStreamReader *reader, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn)
+{
+    if (!impl)
+        impl = new QDomDocumentPrivate();
+    return IMPL->setContent(reader, namespaceProcessing, errorMsg, errorLine, errorColumn);
+}
+
+/*!
+    \since 5.10
+
+    This function reads the XML document from the string \a text like
+    setContent() does, but only builds the nodes of the document down to the
+    elements at level \a depth, the document element being at level 1. The
+    content of each element at that level is only parsed and built the first
+    time its child nodes are accessed. Returns \c true if the document is
+    well-formed; otherwise returns \c false.
+
+    This allows working on large documents of which only a few parts are ever
+    looked at with a fraction of the memory: the document keeps a reference to
+    \a text, which is much smaller than the nodes that would be built from it.
+    Any access to the children of an element, directly or through functions
+    such as elementsByTagName(), text() or toString(), builds them, so those
+    functions should be used with care on the upper levels of the document.
+
+    The whole of \a text is checked for well-formedness up front, so parsing
+    errors are reported by this function. The meaning of \a namespaceProcessing,
+    \a errorMsg, \a errorLine and \a errorColumn is the same as for
+    setContent().
+
+    Documents with a document type declaration are always built completely,
+    as entities declared in it could not be resolved when only part of the
+    document is parsed again.
+
+    \sa setContent(), QDomNode::hasChildNodes()
+*/
+bool QDomDocument::setContentLazily(const QString &text, int depth, bool namespaceProcessing, QString *errorMsg, int *errorLine, int *errorColumn)
+{
+    if (!impl)
+        impl = new QDomDocumentPrivate();
+    return IMPL->setContentLazily(text, qMax(depth, 1), namespaceProcessing, errorMsg, errorLine, errorColumn);
+}
+
 /*!
     Converts the parsed document back to its textual representation.
 
@@ -7553,6 +8028,399 @@ void QDomHandler::setDocumentLocator(QXmlLocator *locator)
     this->locator = locator;
 }
 
+/**************************************************************
+ *
+ * QDomNameTable
+ *
+ **************************************************************/
+
+// Unlike QStringRef::toString(), never shares the reader's buffers, which
+// have spare capacity that would then be kept alive by each node.
+static QString copyOf(const QStringRef &s)
+{
+    return s.string() ? QString(s.unicode(), s.size()) : QString();
+}
+
+QString QDomNameTable::intern(const QStringRef &name)
+{
+    const uint h = qHash(name);
+    for (QMultiHash<uint, QString>::const_iterator it = names.constFind(h);
+         it != names.cend() && it.key() == h; ++it) {
+        // a null and an empty string compare equal, but are different names
+        if (*it == name && it->isNull() == name.isNull())
+            return *it;
+    }
+    const QString s = copyOf(name);
+    names.insert(h, s);
+    return s;
+}
+
+/**************************************************************
+ *
+ * QDomLazySubtree
+ *
+ **************************************************************/
+
+typedef QHash<const QDomNodePrivate *, QDomLazySubtree> QDomLazySubtreeHash;
+Q_GLOBAL_STATIC(QDomLazySubtreeHash, qt_domLazySubtrees)
+static QBasicMutex qt_domLazySubtreesMutex;
+
+void QDomLazySubtree::insert(const QDomNodePrivate *element, const QDomLazySubtree &subtree)
+{
+    QMutexLocker locker(&qt_domLazySubtreesMutex);
+    if (QDomLazySubtreeHash *subtrees = qt_domLazySubtrees())
+        subtrees->insert(element, subtree);
+}
+
+bool QDomLazySubtree::take(const QDomNodePrivate *element, QDomLazySubtree *subtree)
+{
+    QMutexLocker locker(&qt_domLazySubtreesMutex);
+    QDomLazySubtreeHash *subtrees = qt_domLazySubtrees();
+    if (!subtrees)
+        return false;
+    const QDomLazySubtreeHash::iterator it = subtrees->find(element);
+    if (it == subtrees->end())
+        return false;
+    *subtree = *it;
+    subtrees->erase(it);
+    return true;
+}
+
+/**************************************************************
+ *
+ * QDomBuilder
+ *
+ **************************************************************/
+
+static QString nullIfEmpty(const QStringRef &s)
+{
+    return s.isEmpty() ? QString() : copyOf(s);
+}
+
+static QString nonNullString(const QStringRef &s)
+{
+    return s.isEmpty() ? QString(QLatin1String("")) : copyOf(s);
+}
+
+// whitespace as QXmlSimpleReader sees it, which is not only XML whitespace
+static bool isWhitespaceOnly(const QStringRef &s)
+{
+    for (const QChar c : s) {
+        if (!c.isSpace())
+            return false;
+    }
+    return true;
+}
+
+QDomBuilder::QDomBuilder(QDomDocumentPrivate *d, QXmlStreamReader *r, QDomNameTable *n, bool namespaceProcessing)
+    : errorLine(0), errorColumn(0), doc(d), node(d), reader(r), names(n),
+      textLine(0), textColumn(0), nsProcessing(namespaceProcessing),
+      lineOffset(0), columnOffset(0), lazySource(0), lazyDepth(0), depth(0)
+{
+}
+
+/*
+  Builds the whole document. If \a source is set, the content of the
+  elements at \a deferDepth (the document element being at depth 1) is not
+  built, but recorded as a QDomLazySubtree.
+*/
+bool QDomBuilder::parseDocument(QDomLazySource *source, int deferDepth)
+{
+    lazySource = source;
+    lazyDepth = source ? deferDepth : 0;
+    parseContent();
+
+    if (reader->hasError()) {
+        errorMsg = reader->errorString();
+        errorLine = int(reader->lineNumber());
+        errorColumn = int(reader->columnNumber());
+        return false;
+    }
+    return true;
+}
+
+/*
+  Builds the children of \a element from the reader, which must start with
+  a copy of the element's start tag. \a lineNumber and \a columnNumber give
+  the position of the start of that tag in the document.
+*/
+void QDomBuilder::parseSubtree(QDomNodePrivate *element, int lineNumber, int columnNumber)
+{
+    while (!reader->atEnd() && reader->readNext() != QXmlStreamReader::StartElement) {
+    }
+    node = element;
+    depth = 1;
+    lineOffset = lineNumber - 1;
+    columnOffset = columnNumber;
+    parseContent();
+}
+
+void QDomBuilder::parseContent()
+{
+    while (!reader->atEnd()) {
+        const QXmlStreamReader::TokenType token = reader->readNext();
+        if (token == QXmlStreamReader::Characters && !reader->isCDATA()) {
+            characters();
+            continue;
+        }
+        flushText();
+
+        switch (token) {
+        case QXmlStreamReader::StartDocument:
+            startDocument();
+            break;
+        case QXmlStreamReader::DTD:
+            doctype();
+            break;
+        case QXmlStreamReader::StartElement:
+            startElement();
+            if (depth == lazyDepth)
+                deferContent();
+            break;
+        case QXmlStreamReader::EndElement:
+            endElement();
+            break;
+        case QXmlStreamReader::Characters:
+            appendChild(doc->createCDATASection(copyOf(reader->text())));
+            break;
+        case QXmlStreamReader::Comment:
+            appendChild(doc->createComment(copyOf(reader->text())));
+            break;
+        case QXmlStreamReader::ProcessingInstruction:
+            appendChild(doc->createProcessingInstruction(copyOf(reader->processingInstructionTarget()),
+                                                         nonNullString(reader->processingInstructionData())));
+            break;
+        case QXmlStreamReader::EntityReference:
+            // an entity the reader could not resolve
+            if (node != doc)
+                appendChild(doc->createEntityReference(copyOf(reader->name())));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void QDomBuilder::startDocument()
+{
+    // QXmlSimpleReader reports the XML declaration as a processing instruction
+    const QStringRef version = reader->documentVersion();
+    if (version.isEmpty())
+        return;
+
+    QString data = QLatin1String("version='") + version + QLatin1Char('\'');
+    const QStringRef encoding = reader->documentEncoding();
+    if (!encoding.isEmpty())
+        data += QLatin1String(" encoding='") + encoding + QLatin1Char('\'');
+    if (reader->isStandaloneDocument())
+        data += QLatin1String(" standalone='yes'");
+    appendChild(doc->createProcessingInstruction(QLatin1String("xml"), data));
+}
+
+void QDomBuilder::doctype()
+{
+    // Entities declared in the DTD cannot be resolved when only a part of
+    // the document is parsed again, so such documents are built completely.
+    lazyDepth = 0;
+
+    QDomDocumentTypePrivate *doctype = doc->doctype();
+    doctype->name = copyOf(reader->dtdName());
+    doctype->publicId = copyOf(reader->dtdPublicId());
+    doctype->systemId = copyOf(reader->dtdSystemId());
+
+    // QXmlSimpleReader only reports external and unparsed entities
+    const QXmlStreamEntityDeclarations entities = reader->entityDeclarations();
+    for (const QXmlStreamEntityDeclaration &entity : entities) {
+        if (entity.systemId().isEmpty() && entity.notationName().isEmpty())
+            continue;
+        QDomEntityPrivate *e = new QDomEntityPrivate(doc, 0, copyOf(entity.name()),
+                                                     nullIfEmpty(entity.publicId()),
+                                                     nullIfEmpty(entity.systemId()),
+                                                     nullIfEmpty(entity.notationName()));
+        // keep the refcount balanced: appendChild() does a ref anyway.
+        e->ref.deref();
+        doctype->appendChild(e);
+    }
+
+    const QXmlStreamNotationDeclarations notations = reader->notationDeclarations();
+    for (const QXmlStreamNotationDeclaration &notation : notations) {
+        QDomNotationPrivate *n = new QDomNotationPrivate(doc, 0, copyOf(notation.name()),
+                                                         nullIfEmpty(notation.publicId()),
+                                                         nullIfEmpty(notation.systemId()));
+        // keep the refcount balanced: appendChild() does a ref anyway.
+        n->ref.deref();
+        doctype->appendChild(n);
+    }
+}
+
+void QDomBuilder::startElement()
+{
+    // The names are set directly rather than through createElementNS() and
+    // setAttributeNS(): the reader has validated them already, and this way
+    // they are shared through the name table instead of being split into
+    // new strings for every node.
+    QDomElementPrivate *e;
+    if (nsProcessing) {
+        e = new QDomElementPrivate(doc, 0, names->intern(reader->name()));
+        const QStringRef uri = reader->namespaceUri();
+        const QStringRef prefix = reader->prefix();
+        if (!uri.isNull())
+            e->namespaceURI = names->intern(uri);
+        if (!prefix.isEmpty())
+            e->prefix = names->intern(prefix);
+        else if (!uri.isNull())
+            e->prefix = QLatin1String("");
+        e->createdWithDom1Interface = false;
+    } else {
+        e = new QDomElementPrivate(doc, 0, names->intern(reader->qualifiedName()));
+    }
+    e->ref.deref();
+    appendChild(e);
+    node = e;
+    ++depth;
+
+    const QXmlStreamAttributes attributes = reader->attributes();
+    for (const QXmlStreamAttribute &attribute : attributes) {
+        // QXmlSimpleReader does not add default values declared in the DTD
+        if (attribute.isDefault())
+            continue;
+
+        QDomAttrPrivate *a;
+        if (nsProcessing) {
+            a = new QDomAttrPrivate(doc, e, names->intern(attribute.name()));
+            const QStringRef uri = attribute.namespaceUri();
+            const QStringRef prefix = attribute.prefix();
+            if (!uri.isNull())
+                a->namespaceURI = names->intern(uri);
+            if (!prefix.isEmpty())
+                a->prefix = names->intern(prefix);
+            else if (!uri.isNull())
+                a->prefix = QLatin1String("");
+            a->createdWithDom1Interface = false;
+        } else {
+            a = new QDomAttrPrivate(doc, e, names->intern(attribute.qualifiedName()));
+        }
+        a->setNodeValue(copyOf(attribute.value()));
+
+        // Referencing is done by the map, so we set the reference counter back
+        // to 0 here. This is ok since we created the QDomAttrPrivate.
+        a->ref.deref();
+        e->m_attr->setNamedItem(a);
+    }
+
+    if (lazyDepth) {
+        namespaceScopeSizes.append(namespaceScope.size());
+        const QXmlStreamNamespaceDeclarations declarations = reader->namespaceDeclarations();
+        for (const QXmlStreamNamespaceDeclaration &declaration : declarations) {
+            namespaceScope.append(QXmlStreamNamespaceDeclaration(names->intern(declaration.prefix()),
+                                                                 names->intern(declaration.namespaceUri())));
+        }
+    }
+}
+
+void QDomBuilder::endElement()
+{
+    node = node->parent();
+    --depth;
+
+    if (lazyDepth && !namespaceScopeSizes.isEmpty()) {
+        const int size = namespaceScopeSizes.takeLast();
+        if (size != namespaceScope.size())
+            namespaceScope.resize(size);
+    }
+}
+
+/*
+  Skips the content of the element that was just started, recording where
+  it is in the source so that it can be built when it is first accessed.
+*/
+void QDomBuilder::deferContent()
+{
+    QDomLazySubtree subtree;
+    subtree.begin = int(reader->characterOffset());
+    subtree.lineNumber = int(reader->lineNumber());
+    subtree.columnNumber = int(reader->columnNumber());
+
+    // Whitespace on its own does not produce any nodes; an element with
+    // nothing else in it is left as it is.
+    bool hasChildren = false;
+    int level = 1;
+    while (level && !reader->atEnd()) {
+        switch (reader->readNext()) {
+        case QXmlStreamReader::StartElement:
+            ++level;
+            hasChildren = true;
+            break;
+        case QXmlStreamReader::EndElement:
+            --level;
+            break;
+        case QXmlStreamReader::Characters:
+            if (reader->isCDATA() || !isWhitespaceOnly(reader->text()))
+                hasChildren = true;
+            break;
+        case QXmlStreamReader::Comment:
+        case QXmlStreamReader::ProcessingInstruction:
+        case QXmlStreamReader::EntityReference:
+            hasChildren = true;
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader->hasError())
+        return;
+
+    if (hasChildren) {
+        subtree.source = lazySource;
+        subtree.end = int(reader->characterOffset());
+        subtree.namespaceDeclarations = namespaceScope;
+        node->hasLazyChildren = true;
+        QDomLazySubtree::insert(node, subtree);
+    }
+    endElement();
+}
+
+void QDomBuilder::characters()
+{
+    // Consecutive character data is collected into one text node, and, like
+    // QXmlSimpleReader does by default, dropped if it is whitespace only.
+    if (text.isEmpty())
+        text = copyOf(reader->text());
+    else
+        text += reader->text();
+    textLine = int(reader->lineNumber());
+    textColumn = int(reader->columnNumber());
+}
+
+void QDomBuilder::flushText()
+{
+    if (text.isEmpty())
+        return;
+    if (node != doc && !isWhitespaceOnly(QStringRef(&text))) {
+        QDomNodePrivate *n = doc->createTextNode(text);
+        if (n) {
+            setLocation(n, textLine, textColumn);
+            node->appendChild(n);
+        }
+    }
+    text.clear();
+}
+
+void QDomBuilder::appendChild(QDomNodePrivate *n)
+{
+    if (!n)
+        return;
+    setLocation(n, int(reader->lineNumber()), int(reader->columnNumber()));
+    node->appendChild(n);
+}
+
+void QDomBuilder::setLocation(QDomNodePrivate *n, int line, int column)
+{
+    if (line == 1)
+        column += columnOffset;
+    n->setLocation(line + lineOffset, column);
+}
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_DOM
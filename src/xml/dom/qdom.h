@@ -53,6 +53,7 @@ class QTextStream;
 
 class QXmlInputSource;
 class QXmlReader;
+class QXmlStreamReader;
 
 class QDomDocumentPrivate;
 class QDomDocumentTypePrivate;
@@ -343,6 +344,8 @@ public:
     bool setContent(const QString& text, QString *errorMsg=Q_NULLPTR, int *errorLine=Q_NULLPTR, int *errorColumn=Q_NULLPTR );
     bool setContent(QIODevice* dev, QString *errorMsg=Q_NULLPTR, int *errorLine=Q_NULLPTR, int *errorColumn=Q_NULLPTR );
     bool setContent(QXmlInputSource *source, QXmlReader *reader, QString *errorMsg=Q_NULLPTR, int *errorLine=Q_NULLPTR, int *errorColumn=Q_NULLPTR );
+    bool setContent(QXmlStreamReader *reader, bool namespaceProcessing, QString *errorMsg = Q_NULLPTR, int *errorLine = Q_NULLPTR, int *errorColumn = Q_NULLPTR);
+    bool setContentLazily(const QString &text, int depth, bool namespaceProcessing, QString *errorMsg = Q_NULLPTR, int *errorLine = Q_NULLPTR, int *errorColumn = Q_NULLPTR);
 
     // Qt extensions
     QString toString(int = 1) const;
@@ -94,6 +94,9 @@ private slots:
     void moreToFromUnicode_data();
     void moreToFromUnicode();
 
+    void singleByteCodecs_data();
+    void singleByteCodecs();
+
     void shiftJis();
     void userCodec();
 };
@@ -2389,6 +2392,62 @@ void tst_QTextCodec::moreToFromUnicode()
     QCOMPARE(testData, cStr);
 }
 
+void tst_QTextCodec::singleByteCodecs_data()
+{
+    QTest::addColumn<QByteArray>("codecName");
+
+    const char *const codecs[] = {
+        "ISO-8859-15", "KOI8-R", "KOI8-U", "windows-1250", "windows-1251", "windows-1252",
+        "windows-1253", "windows-1254", "windows-1255", "windows-1256", "windows-1257",
+        "windows-1258", "ISO-8859-2", "ISO-8859-5", "ISO-8859-7", "IBM866", "TIS-620"
+    };
+    for (const char *codec : codecs)
+        QTest::newRow(codec) << QByteArray(codec);
+}
+
+void tst_QTextCodec::singleByteCodecs()
+{
+    QFETCH(QByteArray, codecName);
+
+    QTextCodec *c = QTextCodec::codecForName(codecName);
+    if (!c)
+        QSKIP("Codec not available");
+
+    // every byte, alone and in long runs of ASCII, so that the conversions
+    // go in and out of their fast paths at all positions
+    QByteArray data;
+    for (int i = 0; i < 256; ++i) {
+        data += char(i);
+        data += QByteArray(i % 37, char('a' + i % 26));
+    }
+    for (int i = 255; i >= 0; --i)
+        data += char(i);
+
+    QString expected;
+    for (int i = 0; i < data.size(); ++i)
+        expected += c->toUnicode(data.constData() + i, 1);
+    const QString decoded = c->toUnicode(data);
+    QCOMPARE(decoded, expected);
+
+    // add characters that no single-byte codec can encode
+    QString text = decoded;
+    for (int i = 0; i < text.size(); i += 23)
+        text[i] = QChar(0x4e00 + i);
+
+    QByteArray expectedBytes;
+    int expectedInvalid = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        expectedBytes += c->fromUnicode(text.constData() + i, 1, &state);
+        expectedInvalid += state.invalidChars;
+    }
+    QVERIFY(expectedInvalid >= text.size() / 23);
+
+    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+    QCOMPARE(c->fromUnicode(text.constData(), text.size(), &state), expectedBytes);
+    QCOMPARE(state.invalidChars, expectedInvalid);
+}
+
 void tst_QTextCodec::shiftJis()
 {
     QByteArray backslashTilde("\\~");
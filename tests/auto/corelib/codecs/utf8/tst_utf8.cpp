@@ -30,6 +30,7 @@
 
 #include <qtextcodec.h>
 #include <QScopedPointer>
+#include <private/qutfcodec_p.h>
 
 static const char utf8bom[] = "\xEF\xBB\xBF";
 
@@ -61,6 +62,9 @@ private slots:
 
     void nonCharacters_data();
     void nonCharacters();
+
+    void longText_data();
+    void longText();
 };
 
 void tst_Utf8::initTestCase()
@@ -230,6 +234,11 @@ void tst_Utf8::invalidUtf8()
         QVERIFY(decoder->hasFailure());
     else if (!decoder->hasFailure())
         qWarning("System codec does not report failure when it should. Should report bug upstream.");
+
+    QVERIFY(!QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+    const QByteArray padding(64, 'x');
+    utf8 = padding + utf8 + padding;
+    QVERIFY(!QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
 }
 
 void tst_Utf8::nonCharacters_data()
@@ -262,6 +271,96 @@ void tst_Utf8::nonCharacters()
         QVERIFY(!encoder->hasFailure());
     else if (encoder->hasFailure())
         qWarning("System codec reports failure when it shouldn't. Should report bug upstream.");
+
+    QVERIFY(QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+    const QByteArray padding(64, 'x');
+    utf8 = padding + utf8 + padding;
+    QVERIFY(QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+}
+
+void tst_Utf8::longText_data()
+{
+    QTest::addColumn<QString>("text");
+
+    // long enough runs of a single script to be converted in blocks,
+    // see qutfcodec.cpp
+    QTest::newRow("latin1") << QString::fromUtf8("Größenwahn, café naïve à l'œuvre; ");
+    QTest::newRow("greek") << QString::fromUtf8("Ξεσκεπάζω την ψυχοφθόρα βδελυγμία. ");
+    QTest::newRow("cyrillic") << QString::fromUtf8("Съешь же ещё этих мягких французских булок. ");
+    QTest::newRow("cyrillic-nospace") << QString::fromUtf8("СъешьжеещёэтихмягкихфранцузскихбулокЖ");
+    QTest::newRow("cjk") << QString::fromUtf8("我能吞下玻璃而不伤身体。私はガラスを食べられます。");
+    QTest::newRow("mixed") << QString::fromUtf8("abc Ωμέγα 漢字 ÿ\x7f\u07ff\u0800\uffff ");
+}
+
+static QByteArray encodeCodePoints(const QString &text)
+{
+    QByteArray result;
+    const QVector<uint> ucs4 = text.toUcs4();
+    for (uint c : ucs4) {
+        if (c < 0x80) {
+            result += char(c);
+        } else if (c < 0x800) {
+            result += char(0xc0 | c >> 6);
+            result += char(0x80 | (c & 0x3f));
+        } else if (c < 0x10000) {
+            result += char(0xe0 | c >> 12);
+            result += char(0x80 | ((c >> 6) & 0x3f));
+            result += char(0x80 | (c & 0x3f));
+        } else {
+            result += char(0xf0 | c >> 18);
+            result += char(0x80 | ((c >> 12) & 0x3f));
+            result += char(0x80 | ((c >> 6) & 0x3f));
+            result += char(0x80 | (c & 0x3f));
+        }
+    }
+    return result;
+}
+
+void tst_Utf8::longText()
+{
+    QFETCH(QString, text);
+    while (text.size() < 200)
+        text += text;
+
+    QByteArray utf8 = encodeCodePoints(text);
+    QCOMPARE(to8Bit(text), utf8);
+    QCOMPARE(from8Bit(utf8), text);
+    QVERIFY(QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+
+    // interrupt the run anywhere with something that needs the slow path
+    const QString emoji = QString::fromUcs4(QVector<uint>(1, 0x1f600).constData(), 1);
+    for (int i = 0; i <= text.size(); ++i) {
+        const QString before = text.left(i);
+        const QString after = text.mid(i);
+        const QByteArray utf8Before = encodeCodePoints(before);
+        const QByteArray utf8After = encodeCodePoints(after);
+
+        // a character outside the BMP
+        QString utf16 = before + emoji + after;
+        utf8 = utf8Before + "\xf0\x9f\x98\x80" + utf8After;
+        QCOMPARE(to8Bit(utf16), utf8);
+        QCOMPARE(from8Bit(utf8), utf16);
+        QVERIFY(QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+
+        // a stray continuation byte
+        utf8 = utf8Before + '\x80' + utf8After;
+        QCOMPARE(from8Bit(utf8), before + QChar(QChar::ReplacementCharacter) + after);
+        QVERIFY(!QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+
+        // a truncated sequence
+        utf8 = utf8Before + '\xe2' + utf8After;
+        QCOMPARE(from8Bit(utf8), before + QChar(QChar::ReplacementCharacter) + after);
+        QVERIFY(!QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+
+        // an overlong sequence
+        utf8 = utf8Before + "\xc1\xbf" + utf8After;
+        QVERIFY(!QUtf8::isValidUtf8(utf8.constData(), utf8.size()));
+
+        // a lone surrogate, which cannot be encoded (the codecs differ in
+        // what they replace it with)
+        utf16 = before + QChar(0xd800) + after;
+        QCOMPARE(utf16.toUtf8(), utf8Before + '?' + utf8After);
+    }
 }
 
 QTEST_MAIN(tst_Utf8)
@@ -12,6 +12,7 @@ SUBDIRS = \
    json \
    mimetypes \
    plugin \
+   serialization \
    statemachine \
    thread \
    tools \
@@ -28,6 +28,7 @@
 
 #include <QCoreApplication>
 #include <QLoggingCategory>
+#include <QThread>
 
 #ifdef Q_CC_GNU
 #define NEVER_INLINE __attribute__((__noinline__))
@@ -60,6 +61,20 @@ void MyClass::myFunction(int a)
     qDebug() << "from_a_function" << a;
 }
 
+class Logger : public QThread
+{
+public:
+    explicit Logger(int id) : id(id) {}
+    void run() Q_DECL_OVERRIDE
+    {
+        for (int i = 0; i < 100; ++i)
+            qDebug("thread %d message %d", id, i);
+    }
+
+private:
+    int id;
+};
+
 int main(int argc, char **argv)
 {
     QCoreApplication app(argc, argv);
@@ -82,6 +97,19 @@ int main(int argc, char **argv)
     MyClass cl;
     QMetaObject::invokeMethod(&cl, "mySlot1");
 
+    if (argc > 1 && qstrcmp(argv[1], "fatal") == 0) {
+        // everything logged before the fatal message has to be written
+        qSetMessagePattern("%{message}");
+        Logger first(1), second(2);
+        first.start();
+        second.start();
+        for (int i = 0; i < 100; ++i)
+            qDebug("thread 0 message %d", i);
+        first.wait();
+        second.wait();
+        qFatal("fatal");
+    }
+
     return 0;
 }
 
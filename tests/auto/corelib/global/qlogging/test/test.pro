@@ -3,7 +3,7 @@ CONFIG -= debug_and_release_target
 qtConfig(c++11): CONFIG += c++11
 qtConfig(c++14): CONFIG += c++14
 TARGET = ../tst_qlogging
-QT = core testlib
+QT = core-private testlib
 SOURCES = ../tst_qlogging.cpp
 
 DEFINES += QT_MESSAGELOGCONTEXT
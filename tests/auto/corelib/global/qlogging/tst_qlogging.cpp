@@ -33,6 +33,8 @@
 # include <QtCore/QProcess>
 #endif
 #include <QtTest/QTest>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/private/qbinarylog_p.h>
 
 class tst_qmessagehandler : public QObject
 {
@@ -59,6 +61,14 @@ private slots:
     void qMessagePattern_data();
     void qMessagePattern();
     void setMessagePattern();
+    void asyncOutput_data();
+    void asyncOutput();
+    void asyncOutputFatal();
+    void binaryLog();
+    void binaryLogFatal();
+    void binaryLogFormat_data();
+    void binaryLogFormat();
+    void binaryLogWrap();
 
     void formatLogMessage_data();
     void formatLogMessage();
@@ -722,16 +732,16 @@ void tst_qmessagehandler::qMessagePattern_data()
 
     // %{file} is tricky because of shadow builds
     QTest::newRow("basic") << "%{type} %{appname} %{line} %{function} %{message}" << true << (QList<QByteArray>()
-            << "debug  39 T::T static constructor"
+            << "debug  40 T::T static constructor"
             //  we can't be sure whether the QT_MESSAGE_PATTERN is already destructed
             << "static destructor"
-            << "debug tst_qlogging 60 MyClass::myFunction from_a_function 34"
-            << "debug tst_qlogging 70 main qDebug"
-            << "info tst_qlogging 71 main qInfo"
-            << "warning tst_qlogging 72 main qWarning"
-            << "critical tst_qlogging 73 main qCritical"
-            << "warning tst_qlogging 76 main qDebug with category"
-            << "debug tst_qlogging 80 main qDebug2");
+            << "debug tst_qlogging 61 MyClass::myFunction from_a_function 34"
+            << "debug tst_qlogging 85 main qDebug"
+            << "info tst_qlogging 86 main qInfo"
+            << "warning tst_qlogging 87 main qWarning"
+            << "critical tst_qlogging 88 main qCritical"
+            << "warning tst_qlogging 91 main qDebug with category"
+            << "debug tst_qlogging 95 main qDebug2");
 
 
     QTest::newRow("invalid") << "PREFIX: %{unknown} %{message}" << false << (QList<QByteArray>()
@@ -897,6 +907,332 @@ void tst_qmessagehandler::setMessagePattern()
 #endif // QT_CONFIG(process)
 }
 
+void tst_qmessagehandler::asyncOutput_data()
+{
+    QTest::addColumn<QByteArray>("mode");
+
+    QTest::newRow("drop") << QByteArray("1");
+    QTest::newRow("block") << QByteArray("block");
+}
+
+void tst_qmessagehandler::asyncOutput()
+{
+#if !QT_CONFIG(process)
+    QSKIP("This test requires QProcess support");
+#else
+    QFETCH(QByteArray, mode);
+
+    // same output as in setMessagePattern(), but written by the background thread
+    QProcess process;
+    const QString appExe = m_appDir + "/app";
+
+    QStringList environment = m_baseEnvironment;
+    environment.prepend("QT_LOGGING_ASYNC=" + QString::fromLatin1(mode));
+    process.setEnvironment(environment);
+
+    process.start(appExe);
+    QVERIFY2(process.waitForStarted(), qPrintable(
+        QString::fromLatin1("Could not start %1: %2").arg(appExe, process.errorString())));
+    process.waitForFinished();
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+
+    QByteArray output = process.readAllStandardError();
+    QByteArray expected = "static constructor\n"
+            "[debug] qDebug\n"
+            "[info] qInfo\n"
+            "[warning] qWarning\n"
+            "[critical] qCritical\n"
+            "[warning] qDebug with category\n";
+#ifdef Q_OS_WIN
+    output.replace("\r\n", "\n");
+#endif
+    QCOMPARE(QString::fromLatin1(output), QString::fromLatin1(expected));
+#endif // QT_CONFIG(process)
+}
+
+void tst_qmessagehandler::asyncOutputFatal()
+{
+#if !QT_CONFIG(process)
+    QSKIP("This test requires QProcess support");
+#else
+    QProcess process;
+    const QString appExe = m_appDir + "/app";
+
+    QStringList environment = m_baseEnvironment;
+    environment.prepend("QT_LOGGING_ASYNC=block");
+    process.setEnvironment(environment);
+
+    process.start(appExe, QStringList() << "fatal");
+    QVERIFY2(process.waitForStarted(), qPrintable(
+        QString::fromLatin1("Could not start %1: %2").arg(appExe, process.errorString())));
+    process.waitForFinished();
+#ifdef Q_OS_UNIX
+    // abort() raises SIGABRT
+    QCOMPARE(process.exitStatus(), QProcess::CrashExit);
+#endif
+
+    QByteArray output = process.readAllStandardError();
+#ifdef Q_OS_WIN
+    output.replace("\r\n", "\n");
+#endif
+    QList<QByteArray> lines = output.split('\n');
+    QVERIFY(!lines.isEmpty());
+    if (lines.last().isEmpty())
+        lines.removeLast();
+    QCOMPARE(lines.last(), QByteArray("fatal"));
+
+    // all messages are there, and each thread's messages are in order
+    int next[3] = { 0, 0, 0 };
+    for (const QByteArray &line : qAsConst(lines)) {
+        int thread, message;
+        if (sscanf(line.constData(), "thread %d message %d", &thread, &message) != 2)
+            continue;
+        QVERIFY2(thread >= 0 && thread < 3, line.constData());
+        QCOMPARE(message, next[thread]);
+        ++next[thread];
+    }
+    QCOMPARE(next[0], 100);
+    QCOMPARE(next[1], 100);
+    QCOMPARE(next[2], 100);
+#endif // QT_CONFIG(process)
+}
+
+void tst_qmessagehandler::binaryLog()
+{
+#if !QT_CONFIG(process) || !defined(QBINARYLOG_HAVE_WRITER)
+    QSKIP("This test requires QProcess support and the binary log");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logFile = dir.filePath("log");
+
+    QProcess process;
+    const QString appExe = m_appDir + "/app";
+
+    QStringList environment = m_baseEnvironment;
+    environment.prepend("QT_LOGGING_BINARY_FILE=" + logFile);
+    process.setEnvironment(environment);
+
+    process.start(appExe);
+    QVERIFY2(process.waitForStarted(), qPrintable(
+        QString::fromLatin1("Could not start %1: %2").arg(appExe, process.errorString())));
+    const qint64 pid = process.processId();
+    process.waitForFinished();
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(process.readAllStandardError(), QByteArray());
+
+    QBinaryLogReader reader;
+    QVERIFY2(reader.open(logFile), qPrintable(reader.errorString()));
+    QCOMPARE(reader.processId(), quint64(pid));
+    QCOMPARE(reader.skippedBytes(), quint64(0));
+
+    // the message pattern does not apply
+    const QVector<QBinaryLogReader::Entry> entries = reader.entries();
+    QCOMPARE(entries.size(), 9);
+    const struct {
+        QtMsgType type;
+        const char *category;
+        const char *message;
+    } expected[] = {
+        { QtDebugMsg, "default", "static constructor" },
+        { QtDebugMsg, "default", "qDebug" },
+        { QtInfoMsg, "default", "qInfo" },
+        { QtWarningMsg, "default", "qWarning" },
+        { QtCriticalMsg, "default", "qCritical" },
+        { QtWarningMsg, "category", "qDebug with category" },
+        { QtDebugMsg, "default", "qDebug2" },
+        { QtDebugMsg, "default", "from_a_function 34" },
+        { QtDebugMsg, "default", "static destructor" }
+    };
+    for (int i = 0; i < entries.size(); ++i) {
+        const QBinaryLogReader::Entry &entry = entries.at(i);
+        QCOMPARE(entry.type, expected[i].type);
+        QCOMPARE(entry.category, QByteArray(expected[i].category));
+        QCOMPARE(entry.message, QString::fromLatin1(expected[i].message));
+        QVERIFY(entry.file.endsWith("main.cpp"));
+        QVERIFY(entry.line > 0);
+        QVERIFY(entry.timestamp >= reader.startTime());
+        if (i)
+            QVERIFY(entry.timestamp >= entries.at(i - 1).timestamp);
+    }
+    QCOMPARE(entries.at(1).function, QByteArray("int main(int, char**)"));
+#endif
+}
+
+void tst_qmessagehandler::binaryLogFatal()
+{
+#if !QT_CONFIG(process) || !defined(QBINARYLOG_HAVE_WRITER)
+    QSKIP("This test requires QProcess support and the binary log");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString logFile = dir.filePath("log");
+
+    QProcess process;
+    const QString appExe = m_appDir + "/app";
+
+    QStringList environment = m_baseEnvironment;
+    environment.prepend("QT_LOGGING_BINARY_FILE=" + logFile);
+    process.setEnvironment(environment);
+
+    process.start(appExe, QStringList() << "fatal");
+    QVERIFY2(process.waitForStarted(), qPrintable(
+        QString::fromLatin1("Could not start %1: %2").arg(appExe, process.errorString())));
+    process.waitForFinished();
+    QCOMPARE(process.exitStatus(), QProcess::CrashExit);
+
+    // the fatal message is printed, and recorded like everything before it
+    QByteArray output = process.readAllStandardError();
+#ifdef Q_OS_WIN
+    output.replace("\r\n", "\n");
+#endif
+    QCOMPARE(output, QByteArray("fatal\n"));
+
+    QBinaryLogReader reader;
+    QVERIFY2(reader.open(logFile), qPrintable(reader.errorString()));
+    const QVector<QBinaryLogReader::Entry> entries = reader.entries();
+    QVERIFY(!entries.isEmpty());
+    QCOMPARE(entries.last().type, QtFatalMsg);
+    QCOMPARE(entries.last().message, QString::fromLatin1("fatal"));
+
+    int next[3] = { 0, 0, 0 };
+    for (const QBinaryLogReader::Entry &entry : entries) {
+        int thread, message;
+        if (sscanf(entry.message.toLatin1().constData(), "thread %d message %d", &thread, &message) != 2)
+            continue;
+        QVERIFY(thread >= 0 && thread < 3);
+        QCOMPARE(message, next[thread]);
+        ++next[thread];
+    }
+    QCOMPARE(next[0], 100);
+    QCOMPARE(next[1], 100);
+    QCOMPARE(next[2], 100);
+#endif
+}
+
+#ifdef QBINARYLOG_HAVE_WRITER
+static void writeFormatted(QBinaryLogWriter *writer, const char *format, ...)
+{
+    QMessageLogContext context;
+    va_list ap;
+    va_start(ap, format);
+    writer->writeFormattedMessage(QtDebugMsg, context, 1, format, ap);
+    va_end(ap);
+}
+#endif
+
+void tst_qmessagehandler::binaryLogFormat_data()
+{
+    QTest::addColumn<int>("index");
+    for (int i = 0; i < 14; ++i)
+        QTest::newRow(QByteArray::number(i).constData()) << i;
+}
+
+void tst_qmessagehandler::binaryLogFormat()
+{
+#ifndef QBINARYLOG_HAVE_WRITER
+    QSKIP("This test requires the binary log");
+#else
+    QFETCH(int, index);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QBinaryLogWriter writer;
+    QString errorString;
+    QVERIFY2(writer.open(QFile::encodeName(dir.filePath("log")), 0, &errorString),
+             qPrintable(errorString));
+
+    // the decoded message has to be what QString::asprintf() makes of it
+    const QString text = QStringLiteral("\u00e9t\u00e9");
+    int width = 6;
+    QString expected;
+    // not a literal, so that the compiler does not complain about the odd ones
+    const char *format;
+#define FORMAT(f, ...) \
+    do { \
+        format = f; \
+        writeFormatted(&writer, format, __VA_ARGS__); \
+        expected = QString::asprintf(format, __VA_ARGS__); \
+    } while (false)
+    switch (index) {
+    case 0: FORMAT("no arguments%s", ""); break;
+    case 1: FORMAT("%d %i %u %5d|%-5d|%05d %+d", -1, 42, 4000000000u, 7, 7, 7, 7); break;
+    case 2: FORMAT("%x %X %o %#x %hhd %hd", 255, 255, 8, 255, 300, 70000); break;
+    case 3: FORMAT("%ld %lu %lld %llu %zu", -5L, 5UL, -Q_INT64_C(1099511627776),
+                   Q_UINT64_C(1) << 63, size_t(12345)); break;
+    case 4: FORMAT("%f %.2f %10.3e %g %G %Lf", 3.14159, 2.5, 12345.678, 0.0001, 1e20,
+                   static_cast<long double>(1.5)); break;
+    case 5: FORMAT("%s|%10s|%-10s|%.3s", "utf-8 \xc3\xa9", "right", "left", "truncated"); break;
+    case 6: FORMAT("%c%c %lc", 'o', 'k', 0xe9); break;
+    case 7: FORMAT("%ls and %s", text.utf16(), "ascii"); break;
+    case 8: FORMAT("%*d|%-*d|%.*s|%*.*f", width, 1, width, 2, 3, "abcdef", 8, 2, 1.0); break;
+    case 9: FORMAT("%*d", -4, 5); break;
+    case 10: FORMAT("%p", static_cast<void *>(&writer)); break;
+    case 11: FORMAT("100%% done, %s", "really"); break;
+    case 12: FORMAT("bad %y escape %d", 5); break;
+    case 13: FORMAT("trailing %", 0); break;
+    }
+#undef FORMAT
+
+    QBinaryLogReader reader;
+    QVERIFY2(reader.open(dir.filePath("log")), qPrintable(reader.errorString()));
+    QCOMPARE(reader.entries().size(), 1);
+    QCOMPARE(reader.entries().first().message, expected);
+#endif
+}
+
+void tst_qmessagehandler::binaryLogWrap()
+{
+#ifndef QBINARYLOG_HAVE_WRITER
+    QSKIP("This test requires the binary log");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QBinaryLogWriter writer;
+    QVERIFY(writer.open(QFile::encodeName(dir.filePath("log")), QBinaryLog::MinimumCapacity));
+
+    // write several times the capacity, with records of varying size
+    QMessageLogContext context("file.cpp", 1, "function", "category");
+    const int count = 20000;
+    for (int i = 0; i < count; ++i) {
+        if (i % 3)
+            writeFormatted(&writer, "message %d %s", i, i % 7 ? "" : "with some more text");
+        else
+            writer.writeMessage(QtInfoMsg, context, 2, QString::fromLatin1("message %1").arg(i));
+    }
+    // too large for a record: cut
+    writer.writeMessage(QtWarningMsg, context, 2, QString(50000, QLatin1Char('x')));
+
+    QBinaryLogReader reader;
+    QVERIFY2(reader.open(dir.filePath("log")), qPrintable(reader.errorString()));
+    const QVector<QBinaryLogReader::Entry> entries = reader.entries();
+    QVERIFY(entries.size() > 100);
+    QVERIFY(entries.size() < count);
+    QVERIFY(reader.skippedBytes() < QBinaryLog::BlockSize);
+
+    // the most recent messages are kept, without gaps
+    int next = -1;
+    for (int i = 0; i < entries.size() - 1; ++i) {
+        int number;
+        QVERIFY(sscanf(entries.at(i).message.toLatin1().constData(), "message %d", &number) == 1);
+        if (next >= 0)
+            QCOMPARE(number, next);
+        next = number + 1;
+    }
+    QCOMPARE(next, count);
+
+    const QBinaryLogReader::Entry &last = entries.last();
+    QCOMPARE(last.type, QtWarningMsg);
+    QCOMPARE(last.category, QByteArray("category"));
+    QCOMPARE(last.file, QByteArray("file.cpp"));
+    QCOMPARE(last.function, QByteArray("function"));
+    QCOMPARE(last.threadId, quint64(2));
+    QVERIFY(last.message.size() > 1000);
+    QVERIFY(last.message.size() < int(QBinaryLog::MaximumRecordSize));
+    QCOMPARE(last.message, QString(last.message.size(), QLatin1Char('x')));
+#endif
+}
+
 Q_DECLARE_METATYPE(QtMsgType)
 
 void tst_qmessagehandler::formatLogMessage_data()
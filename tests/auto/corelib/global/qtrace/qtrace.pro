@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qtrace
+QT = core-private testlib
+SOURCES = tst_qtrace.cpp
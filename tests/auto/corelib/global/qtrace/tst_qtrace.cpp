@@ -0,0 +1,339 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QThreadPool>
+#include <QtCore/private/qmetaobject_p.h>
+#include <QtCore/private/qtrace_p.h>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+class Receiver : public QObject
+{
+    Q_OBJECT
+public slots:
+    void slot() { ++calls; }
+
+public:
+    int calls = 0;
+};
+
+class tst_QTrace : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanup();
+    void recorder();
+    void sendEvent();
+    void postEvent();
+    void compressedEvent();
+    void signalActivation();
+    void threadPool();
+    void timer();
+    void socketNotifier();
+};
+
+#if QT_CONFIG(tracerecorder)
+typedef QVector<QTraceRecorder::Event> Events;
+
+// the events of \a name whose first argument is \a object
+static Events eventsOf(const Events &events, const char *name, const void *object)
+{
+    Events result;
+    for (const QTraceRecorder::Event &event : events) {
+        if (qstrcmp(event.name, name) == 0 && event.arguments[0] == quintptr(object))
+            result.append(event);
+    }
+    return result;
+}
+
+static int indexOf(const Events &events, const char *name, int from = 0)
+{
+    for (int i = from; i < events.size(); ++i) {
+        if (qstrcmp(events.at(i).name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+#endif
+
+void tst_QTrace::initTestCase()
+{
+#if !QT_CONFIG(tracerecorder)
+    QSKIP("Qt was not configured with -trace recorder");
+#endif
+}
+
+void tst_QTrace::cleanup()
+{
+#if QT_CONFIG(tracerecorder)
+    QTraceRecorder::stop();
+#endif
+}
+
+void tst_QTrace::recorder()
+{
+#if QT_CONFIG(tracerecorder)
+    QVERIFY(!QTraceRecorder::isRecording());
+    QTraceRecorder::start(3); // rounded up to 4
+    QVERIFY(QTraceRecorder::isRecording());
+    for (int i = 0; i < 10; ++i)
+        QTraceRecorder::record("test", quintptr(i), quintptr(i * 2), quintptr(-i));
+    QTraceRecorder::stop();
+    QVERIFY(!QTraceRecorder::isRecording());
+    QTraceRecorder::record("test", 100);
+
+    // only the last four are kept
+    const Events events = QTraceRecorder::events();
+    QCOMPARE(events.size(), 4);
+    for (int i = 0; i < events.size(); ++i) {
+        const QTraceRecorder::Event &event = events.at(i);
+        QCOMPARE(event.name, "test");
+        QCOMPARE(event.arguments[0], quintptr(6 + i));
+        QCOMPARE(event.arguments[1], quintptr((6 + i) * 2));
+        QCOMPARE(qintptr(event.arguments[2]), qintptr(-6 - i));
+        QCOMPARE(event.threadId, QThread::currentThreadId());
+        if (i)
+            QVERIFY(event.timestamp >= events.at(i - 1).timestamp);
+    }
+
+    // starting again discards them
+    QTraceRecorder::start();
+    QTraceRecorder::record("again");
+    QTraceRecorder::stop();
+    QCOMPARE(QTraceRecorder::events().size(), 1);
+#endif
+}
+
+void tst_QTrace::sendEvent()
+{
+#if QT_CONFIG(tracerecorder)
+    QObject object;
+    QEvent event(QEvent::User);
+    QTraceRecorder::start();
+    QCoreApplication::sendEvent(&object, &event);
+    QTraceRecorder::stop();
+
+    const Events events = QTraceRecorder::events();
+    const Events entries = eventsOf(events, "QCoreApplication_notify_entry", &object);
+    QCOMPARE(entries.size(), 1);
+    QCOMPARE(entries.first().arguments[1], quintptr(&event));
+    QCOMPARE(int(entries.first().arguments[2]), int(QEvent::User));
+
+    const int entry = indexOf(events, "QCoreApplication_notify_entry");
+    const int exit = indexOf(events, "QCoreApplication_notify_exit", entry);
+    QVERIFY(exit > entry);
+    QCOMPARE(events.at(exit).arguments[0], quintptr(true)); // QObject::event() calls customEvent()
+#endif
+}
+
+void tst_QTrace::postEvent()
+{
+#if QT_CONFIG(tracerecorder)
+    QObject object;
+    QEvent *event = new QEvent(QEvent::User);
+    QTraceRecorder::start();
+    QCoreApplication::postEvent(&object, event);
+    QCoreApplication::sendPostedEvents(&object, QEvent::User);
+    QTraceRecorder::stop();
+
+    const Events events = QTraceRecorder::events();
+    const Events posted = eventsOf(events, "QCoreApplication_postEvent", &object);
+    QCOMPARE(posted.size(), 1);
+    QCOMPARE(posted.first().arguments[1], quintptr(event));
+    QCOMPARE(int(posted.first().arguments[2]), int(QEvent::User));
+
+    const Events sent = eventsOf(events, "QCoreApplication_sendPostedEvents_entry", &object);
+    QCOMPARE(sent.size(), 1);
+    QCOMPARE(int(sent.first().arguments[1]), int(QEvent::User));
+
+    // the same event is delivered, between entry and exit of sendPostedEvents()
+    const int begin = indexOf(events, "QCoreApplication_sendPostedEvents_entry");
+    const int notify = indexOf(events, "QCoreApplication_notify_entry", begin);
+    const int end = indexOf(events, "QCoreApplication_sendPostedEvents_exit", begin);
+    QVERIFY(begin > indexOf(events, "QCoreApplication_postEvent"));
+    QVERIFY(notify > begin);
+    QVERIFY(end > notify);
+    QCOMPARE(events.at(notify).arguments[0], quintptr(&object));
+    QCOMPARE(events.at(notify).arguments[1], quintptr(event));
+    QVERIFY(events.at(notify).timestamp >= posted.first().timestamp);
+#endif
+}
+
+void tst_QTrace::compressedEvent()
+{
+#if QT_CONFIG(tracerecorder)
+    // QCoreApplication compresses posted Quit events
+    QObject object;
+    QTraceRecorder::start();
+    QCoreApplication::postEvent(&object, new QEvent(QEvent::Quit));
+    QCoreApplication::postEvent(&object, new QEvent(QEvent::Quit));
+    QTraceRecorder::stop();
+    QCoreApplication::removePostedEvents(&object);
+
+    const Events events = QTraceRecorder::events();
+    const Events posted = eventsOf(events, "QCoreApplication_postEvent", &object);
+    QCOMPARE(posted.size(), 2);
+    const Events compressed = eventsOf(events, "QCoreApplication_postEvent_event_compressed", &object);
+    QCOMPARE(compressed.size(), 1);
+    QCOMPARE(compressed.first().arguments[1], posted.last().arguments[1]);
+#endif
+}
+
+void tst_QTrace::signalActivation()
+{
+#if QT_CONFIG(tracerecorder)
+    QObject sender;
+    Receiver receiver;
+    connect(&sender, SIGNAL(objectNameChanged(QString)), &receiver, SLOT(slot()));
+    connect(&sender, &QObject::objectNameChanged, &receiver, &Receiver::slot);
+
+    QTraceRecorder::start();
+    sender.setObjectName("sender");
+    QTraceRecorder::stop();
+    QCOMPARE(receiver.calls, 2);
+
+    const Events events = QTraceRecorder::events();
+    const Events activations = eventsOf(events, "QMetaObject_activate_entry", &sender);
+    QCOMPARE(activations.size(), 1);
+    const int signalIndex =
+        QMetaObjectPrivate::signalIndex(QMetaMethod::fromSignal(&QObject::objectNameChanged));
+    QCOMPARE(int(activations.first().arguments[1]), signalIndex);
+
+    const Events slotCalls = eventsOf(events, "QMetaObject_activate_slot_entry", &receiver);
+    QCOMPARE(slotCalls.size(), 2);
+    QCOMPARE(int(slotCalls.at(0).arguments[1]), receiver.metaObject()->indexOfSlot("slot()"));
+    QCOMPARE(int(slotCalls.at(1).arguments[1]), -1); // a pointer to member function
+
+    const int entry = indexOf(events, "QMetaObject_activate_entry");
+    const int slotEntry = indexOf(events, "QMetaObject_activate_slot_entry", entry);
+    const int slotExit = indexOf(events, "QMetaObject_activate_slot_exit", slotEntry);
+    const int exit = indexOf(events, "QMetaObject_activate_exit", slotExit);
+    QVERIFY(entry >= 0);
+    QVERIFY(slotEntry > entry);
+    QVERIFY(slotExit > slotEntry);
+    QVERIFY(exit > slotExit);
+#endif
+}
+
+void tst_QTrace::threadPool()
+{
+#if QT_CONFIG(tracerecorder)
+    class Runnable : public QRunnable
+    {
+    public:
+        void run() Q_DECL_OVERRIDE { threadId = QThread::currentThreadId(); }
+        Qt::HANDLE threadId = 0;
+    } runnable;
+    runnable.setAutoDelete(false);
+
+    QThreadPool pool;
+    QTraceRecorder::start();
+    pool.start(&runnable);
+    QVERIFY(pool.waitForDone());
+    QTraceRecorder::stop();
+
+    const Events events = QTraceRecorder::events();
+    const Events started = eventsOf(events, "QThreadPool_start", &pool);
+    QCOMPARE(started.size(), 1);
+    QCOMPARE(started.first().arguments[1], quintptr(&runnable));
+    QCOMPARE(started.first().threadId, QThread::currentThreadId());
+
+    const Events ran = eventsOf(events, "QThreadPool_runnable_entry", &runnable);
+    QCOMPARE(ran.size(), 1);
+    QCOMPARE(ran.first().threadId, runnable.threadId);
+    QVERIFY(ran.first().timestamp >= started.first().timestamp);
+
+    bool finished = false;
+    for (const QTraceRecorder::Event &event : events) {
+        if (qstrcmp(event.name, "QThreadPool_runnable_exit") == 0)
+            finished = event.threadId == runnable.threadId;
+    }
+    QVERIFY(finished);
+#endif
+}
+
+void tst_QTrace::timer()
+{
+#if !QT_CONFIG(tracerecorder) || !defined(Q_OS_UNIX)
+    QSKIP("Timer tracepoints are only in the Unix event dispatchers");
+#else
+    QTimer timer;
+    timer.setSingleShot(true);
+    QSignalSpy spy(&timer, &QTimer::timeout);
+    QTraceRecorder::start();
+    timer.start(10);
+    const int timerId = timer.timerId();
+    QTRY_COMPARE(spy.count(), 1);
+    QTraceRecorder::stop();
+
+    const Events events = QTraceRecorder::events();
+    const Events activations = eventsOf(events, "QTimerInfoList_activateTimer_entry", &timer);
+    QCOMPARE(activations.size(), 1);
+    QCOMPARE(int(activations.first().arguments[1]), timerId);
+    QVERIFY(int(activations.first().arguments[2]) >= 0);
+
+    const int entry = indexOf(events, "QTimerInfoList_activateTimer_entry");
+    QVERIFY(indexOf(events, "QTimerInfoList_activateTimer_exit", entry) > entry);
+#endif
+}
+
+void tst_QTrace::socketNotifier()
+{
+#if !QT_CONFIG(tracerecorder) || !defined(Q_OS_UNIX)
+    QSKIP("This test requires pipes");
+#else
+    int fds[2];
+    QCOMPARE(::pipe(fds), 0);
+    {
+        QSocketNotifier notifier(fds[0], QSocketNotifier::Read);
+        QSignalSpy spy(&notifier, &QSocketNotifier::activated);
+        QTraceRecorder::start();
+        QCOMPARE(::write(fds[1], "x", 1), ssize_t(1));
+        QTRY_VERIFY(spy.count() > 0);
+        QTraceRecorder::stop();
+
+        const Events events = QTraceRecorder::events();
+        const Events activations = eventsOf(events, "QSocketNotifier_activated_entry", &notifier);
+        QVERIFY(activations.size() > 0);
+        QCOMPARE(int(activations.first().arguments[1]), fds[0]);
+        QCOMPARE(int(activations.first().arguments[2]), int(QSocketNotifier::Read));
+
+        const int entry = indexOf(events, "QSocketNotifier_activated_entry");
+        QVERIFY(indexOf(events, "QSocketNotifier_activated_exit", entry) > entry);
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+#endif
+}
+
+QTEST_MAIN(tst_QTrace)
+#include "tst_qtrace.moc"
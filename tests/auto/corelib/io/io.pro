@@ -1,6 +1,7 @@
 TEMPLATE=subdirs
 SUBDIRS=\
     qabstractfileengine \
+    qasyncfileio \
     qbuffer \
     qdatastream \
     qdataurl \
@@ -22,6 +23,7 @@ SUBDIRS=\
     qnodebug \
     qprocess \
     qprocess-noapplication \
+    qprocesspipeline \
     qprocessenvironment \
     qresourceengine \
     qsettings \
@@ -57,6 +59,7 @@ SUBDIRS=\
 
 !qtConfig(private_tests): SUBDIRS -= \
     qabstractfileengine \
+    qasyncfileio \
     qfileinfo \
     qipaddress \
     qurlinternal \
@@ -70,7 +73,8 @@ win32:!qtConfig(private_tests): SUBDIRS -= \
 
 !qtConfig(process): SUBDIRS -= \
     qprocess \
-    qprocess-noapplication
+    qprocess-noapplication \
+    qprocesspipeline
 
 winrt: SUBDIRS -= \
     qstorageinfo \
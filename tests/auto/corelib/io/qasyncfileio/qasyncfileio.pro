@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qasyncfileio
+QT = core testlib
+SOURCES = tst_qasyncfileio.cpp
@@ -0,0 +1,284 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QAsyncFileIO>
+#include <QTemporaryDir>
+#include <QFile>
+
+Q_DECLARE_METATYPE(QFileDevice::FileError)
+
+class tst_QAsyncFileIO : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void read_data();
+    void read();
+    void readPastEnd_data() { read_data(); }
+    void readPastEnd();
+    void write_data() { read_data(); }
+    void write();
+    void deliveredByEventLoop_data() { read_data(); }
+    void deliveredByEventLoop();
+    void emptyRequestsDeliveredByEventLoop_data() { read_data(); }
+    void emptyRequestsDeliveredByEventLoop();
+    void deviceNotOpen_data() { read_data(); }
+    void deviceNotOpen();
+    void invalidArguments();
+    void destroyWithPendingRequests_data() { read_data(); }
+    void destroyWithPendingRequests();
+
+private:
+    void selectBackend();
+    QByteArray m_content;
+    QTemporaryDir m_tempDir;
+    QString m_fileName;
+};
+
+void tst_QAsyncFileIO::initTestCase()
+{
+    qRegisterMetaType<QFileDevice::FileError>();
+    QVERIFY2(m_tempDir.isValid(), qPrintable(m_tempDir.errorString()));
+
+    m_content.reserve(1024 * 1024);
+    for (int i = 0; m_content.size() < 1024 * 1024; ++i)
+        m_content += QByteArray::number(i) + '\n';
+    m_content.truncate(1024 * 1024);
+
+    m_fileName = m_tempDir.path() + QStringLiteral("/content");
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(m_content), qint64(m_content.size()));
+}
+
+void tst_QAsyncFileIO::cleanup()
+{
+    qunsetenv("QT_NO_IO_URING");
+}
+
+void tst_QAsyncFileIO::read_data()
+{
+    QTest::addColumn<bool>("threadPool");
+
+    QTest::newRow("default") << false;
+    QTest::newRow("thread pool") << true;
+}
+
+void tst_QAsyncFileIO::selectBackend()
+{
+    QFETCH(bool, threadPool);
+    if (threadPool)
+        qputenv("QT_NO_IO_URING", "1");
+}
+
+void tst_QAsyncFileIO::read()
+{
+    selectBackend();
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+
+    QAsyncFileIO io;
+    QFETCH(bool, threadPool);
+    if (threadPool)
+        QCOMPARE(io.backend(), QAsyncFileIO::ThreadPoolBackend);
+    QSignalSpy spy(&io, &QAsyncFileIO::readFinished);
+
+    const int chunkSize = 64 * 1024;
+    QHash<int, qint64> offsets;
+    for (qint64 offset = 0; offset < m_content.size(); offset += chunkSize) {
+        const int id = io.read(&file, offset, chunkSize);
+        QVERIFY(id >= 0);
+        offsets.insert(id, offset);
+    }
+    QCOMPARE(io.pendingRequests(), offsets.size());
+    QVERIFY(io.waitForFinished());
+    QCOMPARE(io.pendingRequests(), 0);
+    QCOMPARE(spy.count(), offsets.size());
+
+    for (const QList<QVariant> &arguments : qAsConst(spy)) {
+        const int id = arguments.at(0).toInt();
+        QVERIFY(offsets.contains(id));
+        QCOMPARE(arguments.at(1).toByteArray(), m_content.mid(int(offsets.take(id)), chunkSize));
+    }
+    QVERIFY(offsets.isEmpty());
+}
+
+void tst_QAsyncFileIO::readPastEnd()
+{
+    selectBackend();
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QAsyncFileIO io;
+    QSignalSpy spy(&io, &QAsyncFileIO::readFinished);
+    const int partial = io.read(&file, m_content.size() - 10, 100);
+    const int beyond = io.read(&file, m_content.size() + 10, 100);
+    QVERIFY(io.waitForFinished());
+    QCOMPARE(spy.count(), 2);
+    for (const QList<QVariant> &arguments : qAsConst(spy)) {
+        if (arguments.at(0).toInt() == partial)
+            QCOMPARE(arguments.at(1).toByteArray(), m_content.right(10));
+        else if (arguments.at(0).toInt() == beyond)
+            QVERIFY(arguments.at(1).toByteArray().isEmpty());
+        else
+            QFAIL("unexpected request id");
+    }
+}
+
+void tst_QAsyncFileIO::write()
+{
+    selectBackend();
+    const QString fileName = m_tempDir.path() + QStringLiteral("/written");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Unbuffered));
+
+    QAsyncFileIO io;
+    QSignalSpy spy(&io, &QAsyncFileIO::writeFinished);
+    QSignalSpy errorSpy(&io, &QAsyncFileIO::errorOccurred);
+
+    // written back to front, so that every request extends the file
+    const int chunkSize = 100 * 1000;
+    int requests = 0;
+    for (int offset = (m_content.size() / chunkSize) * chunkSize; offset >= 0; offset -= chunkSize) {
+        QVERIFY(io.write(&file, offset, m_content.mid(offset, chunkSize)) >= 0);
+        ++requests;
+    }
+    QVERIFY(io.waitForFinished());
+    QCOMPARE(errorSpy.count(), 0);
+    QCOMPARE(spy.count(), requests);
+    qint64 total = 0;
+    for (const QList<QVariant> &arguments : qAsConst(spy))
+        total += arguments.at(1).toLongLong();
+    QCOMPARE(total, qint64(m_content.size()));
+    file.close();
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), m_content);
+}
+
+void tst_QAsyncFileIO::deliveredByEventLoop()
+{
+    selectBackend();
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QAsyncFileIO io;
+    QSignalSpy spy(&io, &QAsyncFileIO::readFinished);
+    const int id = io.read(&file, 4, 12);
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), id);
+    QCOMPARE(spy.at(0).at(1).toByteArray(), m_content.mid(4, 12));
+    QCOMPARE(io.pendingRequests(), 0);
+}
+
+void tst_QAsyncFileIO::emptyRequestsDeliveredByEventLoop()
+{
+    selectBackend();
+    const QString fileName = m_tempDir.path() + QStringLiteral("/empty");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+
+    QAsyncFileIO io;
+    QSignalSpy readSpy(&io, &QAsyncFileIO::readFinished);
+    QSignalSpy writeSpy(&io, &QAsyncFileIO::writeFinished);
+    QSignalSpy errorSpy(&io, &QAsyncFileIO::errorOccurred);
+    const int readId = io.read(&file, 0, 0);
+    const int writeId = io.write(&file, 0, QByteArray());
+    QTRY_COMPARE(readSpy.count(), 1);
+    QTRY_COMPARE(writeSpy.count(), 1);
+    QCOMPARE(errorSpy.count(), 0);
+    QCOMPARE(readSpy.at(0).at(0).toInt(), readId);
+    QVERIFY(readSpy.at(0).at(1).toByteArray().isEmpty());
+    QCOMPARE(writeSpy.at(0).at(0).toInt(), writeId);
+    QCOMPARE(writeSpy.at(0).at(1).toLongLong(), qint64(0));
+    QCOMPARE(io.pendingRequests(), 0);
+}
+
+void tst_QAsyncFileIO::deviceNotOpen()
+{
+    selectBackend();
+    QFile file(m_fileName);
+
+    QAsyncFileIO io;
+    QSignalSpy spy(&io, &QAsyncFileIO::errorOccurred);
+    const int closedId = io.read(&file, 0, 10);
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const int wrongModeId = io.write(&file, 0, QByteArray("data"));
+    QVERIFY(io.waitForFinished());
+
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(0).at(0).toInt(), closedId);
+    QCOMPARE(spy.at(0).at(1).value<QFileDevice::FileError>(), QFileDevice::OpenError);
+    QCOMPARE(spy.at(1).at(0).toInt(), wrongModeId);
+    QCOMPARE(spy.at(1).at(1).value<QFileDevice::FileError>(), QFileDevice::OpenError);
+}
+
+void tst_QAsyncFileIO::invalidArguments()
+{
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+
+    QAsyncFileIO io;
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFileIO::read: Negative offset or size");
+    QCOMPARE(io.read(&file, -1, 10), -1);
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFileIO::read: Negative offset or size");
+    QCOMPARE(io.read(&file, 0, -10), -1);
+    QTest::ignoreMessage(QtWarningMsg, "QAsyncFileIO::write: Negative offset");
+    QCOMPARE(io.write(&file, -1, QByteArray("data")), -1);
+    QCOMPARE(io.pendingRequests(), 0);
+}
+
+void tst_QAsyncFileIO::destroyWithPendingRequests()
+{
+    selectBackend();
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QScopedPointer<QAsyncFileIO> io(new QAsyncFileIO);
+    QSignalSpy spy(io.data(), &QAsyncFileIO::readFinished);
+    for (int i = 0; i < 100; ++i)
+        io->read(&file, i * 1024, 1024);
+    io->submit();
+    for (int i = 0; i < 100; ++i)
+        io->read(&file, i * 1024, 1024);
+    io.reset();
+
+    // nothing is delivered to a deleted object
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 0);
+}
+
+QTEST_MAIN(tst_QAsyncFileIO)
+#include "tst_qasyncfileio.moc"
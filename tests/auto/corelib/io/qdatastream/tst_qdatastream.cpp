@@ -35,6 +35,9 @@
 #include <QtGui/QPainter>
 #include <QtGui/QPen>
 
+Q_DECLARE_METATYPE(QDataStream::ByteOrder)
+Q_DECLARE_METATYPE(QDataStream::FloatingPointPrecision)
+
 class tst_QDataStream : public QObject
 {
 Q_OBJECT
@@ -170,6 +173,10 @@ private slots:
 
     void streamToAndFromQByteArray();
 
+    void arrays_data();
+    void arrays();
+    void status_arrays();
+
     void streamRealDataTypes();
 
     void floatingPointPrecision();
@@ -2956,6 +2963,208 @@ void tst_QDataStream::streamToAndFromQByteArray()
     QCOMPARE(y, x);
 }
 
+template <typename T>
+static QByteArray streamElementByElement(const QVector<T> &v, QDataStream::ByteOrder byteOrder,
+                                         QDataStream::FloatingPointPrecision precision, int version)
+{
+    QByteArray ba;
+    QDataStream stream(&ba, QIODevice::WriteOnly);
+    stream.setByteOrder(byteOrder);
+    stream.setFloatingPointPrecision(precision);
+    stream.setVersion(version);
+    stream << quint32(v.size());
+    for (const T &t : v)
+        stream << t;
+    return ba;
+}
+
+template <typename T>
+static void compareArrayStreaming(int count, QDataStream::ByteOrder byteOrder,
+                                  QDataStream::FloatingPointPrecision precision, int version)
+{
+    QVector<T> vector;
+    QList<T> list;
+    for (int i = 0; i < count; ++i) {
+        // fill all the bytes of integers, and keep floating point values exact in single precision
+        const T t = std::is_floating_point<T>::value
+                ? T(i / 4.0 - 100)
+                : T(quint64(i) * Q_UINT64_C(0x0102030405060708) >> (64 - 8 * sizeof(T) + 1));
+        vector.append(t);
+        list.append(t);
+    }
+    const QByteArray expected = streamElementByElement(vector, byteOrder, precision, version);
+
+    QByteArray ba;
+    {
+        QDataStream stream(&ba, QIODevice::WriteOnly);
+        stream.setByteOrder(byteOrder);
+        stream.setFloatingPointPrecision(precision);
+        stream.setVersion(version);
+        stream << vector;
+        QCOMPARE(stream.status(), QDataStream::Ok);
+    }
+    QCOMPARE(ba, expected);
+    ba.clear();
+    {
+        QDataStream stream(&ba, QIODevice::WriteOnly);
+        stream.setByteOrder(byteOrder);
+        stream.setFloatingPointPrecision(precision);
+        stream.setVersion(version);
+        stream << list;
+    }
+    QCOMPARE(ba, expected);
+
+    QDataStream stream(expected);
+    stream.setByteOrder(byteOrder);
+    stream.setFloatingPointPrecision(precision);
+    stream.setVersion(version);
+
+    // compare with reading element by element, as not all versions round-trip 64-bit integers
+    quint32 size;
+    stream >> size;
+    QCOMPARE(size, quint32(count));
+    vector.clear();
+    list.clear();
+    for (int i = 0; i < count; ++i) {
+        T t;
+        stream >> t;
+        vector.append(t);
+        list.append(t);
+    }
+    QCOMPARE(stream.status(), QDataStream::Ok);
+
+    stream.device()->seek(0);
+    QVector<T> readVector;
+    stream >> readVector;
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QCOMPARE(readVector, vector);
+    QVERIFY(stream.atEnd());
+
+    stream.device()->seek(0);
+    QList<T> readList;
+    stream >> readList;
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QCOMPARE(readList, list);
+
+    // the raw span API writes the same data without the size
+    stream.device()->seek(sizeof(quint32));
+    QVector<T> span(count);
+    stream.readArray(span.data(), count);
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QCOMPARE(span, vector);
+}
+
+void tst_QDataStream::arrays_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QDataStream::ByteOrder>("byteOrder");
+    QTest::addColumn<QDataStream::FloatingPointPrecision>("precision");
+    QTest::addColumn<int>("version");
+
+    const int counts[] = { 0, 1, 3, 17, 5000 };
+    for (int count : counts) {
+        QTest::newRow(qPrintable(QString("BigEndian-%1").arg(count)))
+                << count << QDataStream::BigEndian << QDataStream::DoublePrecision << int(QDataStream::Qt_DefaultCompiledVersion);
+        QTest::newRow(qPrintable(QString("LittleEndian-%1").arg(count)))
+                << count << QDataStream::LittleEndian << QDataStream::DoublePrecision << int(QDataStream::Qt_DefaultCompiledVersion);
+        QTest::newRow(qPrintable(QString("BigEndian-single-%1").arg(count)))
+                << count << QDataStream::BigEndian << QDataStream::SinglePrecision << int(QDataStream::Qt_DefaultCompiledVersion);
+        QTest::newRow(qPrintable(QString("LittleEndian-single-%1").arg(count)))
+                << count << QDataStream::LittleEndian << QDataStream::SinglePrecision << int(QDataStream::Qt_DefaultCompiledVersion);
+        QTest::newRow(qPrintable(QString("Qt_1_0-%1").arg(count)))
+                << count << QDataStream::BigEndian << QDataStream::DoublePrecision << int(QDataStream::Qt_1_0);
+        QTest::newRow(qPrintable(QString("Qt_4_5-%1").arg(count)))
+                << count << QDataStream::LittleEndian << QDataStream::SinglePrecision << int(QDataStream::Qt_4_5);
+    }
+}
+
+void tst_QDataStream::arrays()
+{
+    QFETCH(int, count);
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(QDataStream::FloatingPointPrecision, precision);
+    QFETCH(int, version);
+
+    compareArrayStreaming<qint8>(count, byteOrder, precision, version);
+    compareArrayStreaming<quint8>(count, byteOrder, precision, version);
+    compareArrayStreaming<qint16>(count, byteOrder, precision, version);
+    compareArrayStreaming<quint16>(count, byteOrder, precision, version);
+    compareArrayStreaming<qint32>(count, byteOrder, precision, version);
+    compareArrayStreaming<quint32>(count, byteOrder, precision, version);
+    compareArrayStreaming<qint64>(count, byteOrder, precision, version);
+    compareArrayStreaming<quint64>(count, byteOrder, precision, version);
+    compareArrayStreaming<float>(count, byteOrder, precision, version);
+    compareArrayStreaming<double>(count, byteOrder, precision, version);
+}
+
+void tst_QDataStream::status_arrays()
+{
+    // a truncated vector is not returned
+    {
+        QByteArray ba("\x00\x00\x00\x03\x00\x00\x00\x01\x00\x00\x00\x02\x00\x00", 14);
+        QDataStream stream(ba);
+        QVector<qint32> vector;
+        vector << 42;
+        stream >> vector;
+        QCOMPARE(stream.status(), QDataStream::ReadPastEnd);
+        QVERIFY(vector.isEmpty());
+    }
+    {
+        QByteArray ba("\x00\x00\x00\x02\x00\x00\x00\x01\x00\x00", 10);
+        QDataStream stream(ba);
+        QList<qint32> list;
+        stream >> list;
+        QCOMPARE(stream.status(), QDataStream::ReadPastEnd);
+        QVERIFY(list.isEmpty());
+    }
+
+    // a corrupt size does not make the stream allocate memory for it
+    {
+        QByteArray ba("\x7f\xff\xff\xff\x00\x00\x00\x01", 8);
+        QDataStream stream(ba);
+        QVector<double> vector;
+        stream >> vector;
+        QCOMPARE(stream.status(), QDataStream::ReadPastEnd);
+        QVERIFY(vector.isEmpty());
+    }
+
+    // the raw span API returns the elements that were read completely
+    {
+        QByteArray ba("\x00\x01\x00\x02\x00", 5);
+        QDataStream stream(ba);
+        qint16 data[4] = { -1, -1, -1, -1 };
+        stream.readArray(data, 4);
+        QCOMPARE(stream.status(), QDataStream::ReadPastEnd);
+        QCOMPARE(data[0], qint16(1));
+        QCOMPARE(data[1], qint16(2));
+        QCOMPARE(data[2], qint16(0));
+        QCOMPARE(data[3], qint16(0));
+    }
+
+    // reading fails after a previous error in a transaction
+    {
+        QByteArray ba("\x00\x01\x00\x02", 4);
+        QDataStream stream(ba);
+        stream.startTransaction();
+        stream.setStatus(QDataStream::ReadCorruptData);
+        qint16 data[2] = { -1, -1 };
+        stream.readArray(data, 2);
+        QCOMPARE(data[0], qint16(0));
+        QCOMPARE(data[1], qint16(0));
+        QVERIFY(!stream.commitTransaction());
+    }
+
+    // writing stops at the first error
+    {
+        QByteArray ba;
+        QDataStream stream(&ba, QIODevice::WriteOnly);
+        stream.setStatus(QDataStream::WriteFailed);
+        const qint32 data[2] = { 1, 2 };
+        stream.writeArray(data, 2);
+        QVERIFY(ba.isEmpty());
+    }
+}
+
 void tst_QDataStream::streamRealDataTypes()
 {
     // Generate QPicture from pixmap.
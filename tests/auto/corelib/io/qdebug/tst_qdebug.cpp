@@ -56,6 +56,7 @@ private slots:
     void qDebugQFlags() const;
     void textStreamModifiers() const;
     void resetFormat() const;
+    void reusedStreams() const;
     void defaultMessagehandler() const;
     void threadSafety() const;
 };
@@ -634,6 +635,45 @@ void tst_QDebug::resetFormat() const
     QCOMPARE(QString::fromLatin1(s_function), function);
 }
 
+struct NestedDebug {};
+
+static QDebug operator<<(QDebug debug, NestedDebug)
+{
+    qDebug() << "nested" << hex << 255;
+    return debug << "outer";
+}
+
+void tst_QDebug::reusedStreams() const
+{
+    MessageHandlerSetter mhs(myMessageHandler);
+    { qDebug().nospace().noquote() << hex << 255 << QStringLiteral("a") << QStringLiteral("b"); }
+    QCOMPARE(s_msg, QString::fromLatin1("ffab"));
+    { qDebug().setVerbosity(0); }
+
+    // no formatting state is carried over from the previous message
+    { qDebug() << 255 << QStringLiteral("a") << QStringLiteral("b"); }
+    QCOMPARE(s_msgType, QtDebugMsg);
+    QCOMPARE(s_msg, QString::fromLatin1("255 \"a\" \"b\""));
+    { QDebug d = qDebug(); QCOMPARE(d.verbosity(), 2); }
+
+    { QDebug(QtWarningMsg) << "no context"; }
+    QCOMPARE(s_msgType, QtWarningMsg);
+    QCOMPARE(s_msg, QString::fromLatin1("no context"));
+    QVERIFY(s_file.isEmpty());
+    QCOMPARE(s_line, 0);
+
+    // a stream used while another one is being written
+    { qDebug() << "first" << NestedDebug() << 255; }
+    QCOMPARE(s_msg, QString::fromLatin1("first outer 255"));
+
+    // a long message does not stay attached to the thread, but works
+    const QString longString(100000, QLatin1Char('x'));
+    { qDebug().noquote() << longString; }
+    QCOMPARE(s_msg, longString);
+    { qDebug() << "short"; }
+    QCOMPARE(s_msg, QString::fromLatin1("short"));
+}
+
 void tst_QDebug::defaultMessagehandler() const
 {
     MessageHandlerSetter mhs(0); // set 0, should set default handler
@@ -58,6 +58,7 @@ private slots:
     void addPaths();
     void removePaths();
     void removePathsFilesInSameDirectory();
+    void pathsKeepInsertionOrder();
 
     void watchFileAndItsDirectory_data() { basicTest_data(); }
     void watchFileAndItsDirectory();
@@ -75,6 +76,12 @@ private slots:
 
     void watchUnicodeCharacters();
 
+    void watchSubdirectories_data() { basicTest_data(); }
+    void watchSubdirectories();
+    void notificationDelay_data() { basicTest_data(); }
+    void notificationDelay();
+    void removePathDropsPendingChanges();
+
 private:
     QString m_tempDirPattern;
 #endif // QT_NO_FILESYSTEMWATCHER
@@ -475,6 +482,37 @@ void tst_QFileSystemWatcher::removePathsFilesInSameDirectory()
     QCOMPARE(watcher.files().size(), 0);
 }
 
+void tst_QFileSystemWatcher::pathsKeepInsertionOrder()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    const QDir root(temporaryDirectory.path());
+    QStringList directories;
+    QStringList files;
+    for (int i = 9; i >= 0; --i) {
+        const QString name = QString::number(i);
+        QVERIFY(root.mkdir(name));
+        directories << root.filePath(name);
+        QFile file(root.filePath(name + QLatin1String(".txt")));
+        QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+        files << file.fileName();
+    }
+
+    QFileSystemWatcher watcher;
+    QCOMPARE(watcher.addPaths(directories), QStringList());
+    for (const QString &file : qAsConst(files))
+        QVERIFY(watcher.addPath(file));
+    QCOMPARE(watcher.directories(), directories);
+    QCOMPARE(watcher.files(), files);
+
+    // a path that is watched again goes to the end
+    QVERIFY(watcher.removePath(directories.first()));
+    QVERIFY(watcher.addPath(directories.first()));
+    directories.append(directories.takeFirst());
+    QCOMPARE(watcher.directories(), directories);
+}
+
 static QByteArray msgFileOperationFailed(const char *what, const QFile &f)
 {
     return what + QByteArrayLiteral(" failed on \"")
@@ -773,6 +811,106 @@ void tst_QFileSystemWatcher::watchUnicodeCharacters()
     QVERIFY(testDir.mkdir("creme"));
     QTRY_COMPARE(changedSpy.count(), 1);
 }
+
+void tst_QFileSystemWatcher::watchSubdirectories()
+{
+    QFETCH(QString, backend);
+
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    const QString root = temporaryDirectory.path() + QStringLiteral("/root");
+    QDir dir(temporaryDirectory.path());
+    QVERIFY(dir.mkpath(QStringLiteral("root/a/b")));
+    QVERIFY(dir.mkpath(QStringLiteral("root/c")));
+
+    QFileSystemWatcher watcher;
+    watcher.setObjectName(QLatin1String("_qt_autotest_force_engine_") + backend);
+    QVERIFY(watcher.addPath(root, QFileSystemWatcher::WatchSubdirectories));
+    QCOMPARE(watcher.directories().count(), 4);
+    QVERIFY(watcher.directories().contains(root + QStringLiteral("/a/b")));
+
+    QSignalSpy changedSpy(&watcher, &QFileSystemWatcher::directoryChanged);
+    QVERIFY(changedSpy.isValid());
+
+    // changes deep down in the tree are reported
+    QVERIFY(dir.mkdir(QStringLiteral("root/a/b/d")));
+    QTRY_VERIFY(!changedSpy.isEmpty());
+    QCOMPARE(changedSpy.first().first().toString(), root + QStringLiteral("/a/b"));
+
+    // and so are changes in directories created afterwards
+    QTRY_COMPARE(watcher.directories().count(), 5);
+    changedSpy.clear();
+    QVERIFY(dir.mkdir(QStringLiteral("root/a/b/d/e")));
+    QTRY_VERIFY(!changedSpy.isEmpty());
+    QCOMPARE(changedSpy.first().first().toString(), root + QStringLiteral("/a/b/d"));
+
+    // removing the root stops watching everything below it
+    QVERIFY(watcher.removePath(root));
+    QVERIFY(watcher.directories().isEmpty());
+}
+
+void tst_QFileSystemWatcher::notificationDelay()
+{
+    QFETCH(QString, backend);
+
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    QStringList fileNames;
+    for (int i = 0; i < 3; ++i) {
+        QFile testFile(temporaryDirectory.path() + QStringLiteral("/file") + QString::number(i));
+        QVERIFY(testFile.open(QIODevice::WriteOnly));
+        fileNames.append(testFile.fileName());
+    }
+
+    QFileSystemWatcher watcher;
+    watcher.setObjectName(QLatin1String("_qt_autotest_force_engine_") + backend);
+    QCOMPARE(watcher.notificationDelay(), 0);
+    watcher.setNotificationDelay(backend == QLatin1String("poller") ? 3000 : 500);
+    QVERIFY(watcher.addPaths(fileNames).isEmpty());
+
+    QSignalSpy changedSpy(&watcher, &QFileSystemWatcher::fileChanged);
+    QSignalSpy batchSpy(&watcher, &QFileSystemWatcher::filesChanged);
+    QVERIFY(changedSpy.isValid());
+    QVERIFY(batchSpy.isValid());
+
+    // several changes to the same files are coalesced
+    for (int round = 0; round < 3; ++round) {
+        for (const QString &fileName : qAsConst(fileNames)) {
+            QFile testFile(fileName);
+            QVERIFY(testFile.open(QIODevice::Append));
+            testFile.write(QByteArray("hello"));
+        }
+        QTest::qWait(50);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(batchSpy.count(), 1, 10000);
+    QStringList changed = batchSpy.first().first().toStringList();
+    changed.sort();
+    QCOMPARE(changed, fileNames);
+    QCOMPARE(changedSpy.count(), fileNames.count());
+}
+
+void tst_QFileSystemWatcher::removePathDropsPendingChanges()
+{
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+
+    const QString dirName = temporaryDirectory.path();
+    QFileSystemWatcher watcher;
+    watcher.setNotificationDelay(500);
+    QVERIFY(watcher.addPath(dirName));
+
+    QSignalSpy changedSpy(&watcher, &QFileSystemWatcher::directoryChanged);
+    QSignalSpy batchSpy(&watcher, &QFileSystemWatcher::directoriesChanged);
+    QVERIFY(QDir(dirName).mkdir(QStringLiteral("sub")));
+    QTest::qWait(200);
+    QVERIFY(watcher.removePath(dirName));
+    QTest::qWait(800);
+    QCOMPARE(changedSpy.count(), 0);
+    QCOMPARE(batchSpy.count(), 0);
+}
 #endif // QT_NO_FILESYSTEMWATCHER
 
 QTEST_MAIN(tst_QFileSystemWatcher)
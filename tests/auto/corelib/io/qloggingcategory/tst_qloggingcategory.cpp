@@ -881,6 +881,62 @@ private slots:
         QCOMPARE(cleanLogLine(logMessage), cleanLogLine(buf));
     }
 
+    void checkRateLimit()
+    {
+        QLoggingCategory category("RateLimited");
+        QCOMPARE(category.rateLimit(), 0);
+        category.setRateLimit(-1);
+        QCOMPARE(category.rateLimit(), 0);
+
+        category.setRateLimit(3);
+        QCOMPARE(category.rateLimit(), 3);
+
+        // the limiter counts per second of the monotonic clock; start early
+        // in a second so that the burst below does not straddle two
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.msecsSinceReference() % 1000 > 500) {
+            QThread::msleep(10);
+            timer.start();
+        }
+
+        multithreadtest = true;
+        threadtest.clear();
+        int evaluated = 0;
+        for (int i = 0; i < 10; ++i)
+            qCDebug(category) << "message" << ++evaluated;
+        QCOMPARE(threadtest.count(), 3);
+        QCOMPARE(evaluated, 3);
+        QCOMPARE(threadtest.at(2), QStringLiteral("RateLimited.debug: message 3"));
+
+        QThread::msleep(1100);
+        threadtest.clear();
+        qCWarning(category, "next second");
+        QCOMPARE(threadtest.count(), 2);
+        QVERIFY(threadtest.at(0).startsWith(QLatin1String("RateLimited.info: 7 messages suppressed")));
+        QCOMPARE(threadtest.at(1), QStringLiteral("RateLimited.warning: next second"));
+
+        // the report is an informational message, and obeys its setting
+        category.setEnabled(QtInfoMsg, false);
+        for (int i = 0; i < 10; ++i)
+            qCDebug(category) << "message";
+        QThread::msleep(1100);
+        threadtest.clear();
+        qCWarning(category, "next second");
+        QCOMPARE(threadtest.count(), 1);
+        QCOMPARE(threadtest.at(0), QStringLiteral("RateLimited.warning: next second"));
+        category.setEnabled(QtInfoMsg, true);
+
+        category.setRateLimit(0);
+        QCOMPARE(category.rateLimit(), 0);
+        threadtest.clear();
+        for (int i = 0; i < 10; ++i)
+            qCDebug(category) << "unlimited";
+        QCOMPARE(threadtest.count(), 10);
+        multithreadtest = false;
+        threadtest.clear();
+    }
+
     void checkMultithreading()
     {
         multithreadtest = true;
@@ -0,0 +1,4 @@
+CONFIG += testcase
+TARGET = tst_qprocesspipeline
+QT = core testlib
+SOURCES = tst_qprocesspipeline.cpp
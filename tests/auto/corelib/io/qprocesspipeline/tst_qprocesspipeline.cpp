@@ -0,0 +1,285 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QProcessPipeline>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QTemporaryDir>
+
+class tst_QProcessPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void stages();
+    void writeAndRead();
+    void inputAndOutputFile();
+    void outputDevice_data();
+    void outputDevice();
+    void outputHeldOpen();
+    void failedStage();
+    void failedToStart();
+    void eventLoop();
+
+private:
+    QByteArray makeData(int size);
+
+    QTemporaryDir tempDir;
+};
+
+void tst_QProcessPipeline::initTestCase()
+{
+    qRegisterMetaType<QProcess::ExitStatus>();
+    qRegisterMetaType<QProcess::ProcessError>();
+    QVERIFY2(tempDir.isValid(), qPrintable(tempDir.errorString()));
+    for (const char *tool : { "cat", "sort", "false" }) {
+        if (QStandardPaths::findExecutable(QLatin1String(tool)).isEmpty())
+            QSKIP("This test needs the cat, sort and false tools");
+    }
+}
+
+QByteArray tst_QProcessPipeline::makeData(int size)
+{
+    QByteArray data;
+    data.reserve(size);
+    for (int i = 0; data.size() < size; ++i)
+        data += QByteArray::number(i * 7919 % 100003) + '\n';
+    data.truncate(size);
+    return data;
+}
+
+void tst_QProcessPipeline::stages()
+{
+    QProcessPipeline pipeline;
+    QCOMPARE(pipeline.stageCount(), 0);
+    QVERIFY(!pipeline.isRunning());
+
+    QProcess *first = pipeline.addStage("cat");
+    QProcess *second = pipeline.addStage("sort", QStringList() << "-r");
+    QCOMPARE(pipeline.stageCount(), 2);
+    QCOMPARE(pipeline.stage(0), first);
+    QCOMPARE(pipeline.stage(1), second);
+    QVERIFY(!pipeline.stage(2));
+    QCOMPARE(first->parent(), &pipeline);
+    QCOMPARE(second->program(), QString("sort"));
+    QCOMPARE(second->arguments(), QStringList() << "-r");
+    QCOMPARE(second->processChannelMode(), QProcess::ForwardedErrorChannel);
+}
+
+void tst_QProcessPipeline::writeAndRead()
+{
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("sort");
+    QSignalSpy stageSpy(&pipeline, &QProcessPipeline::stageFinished);
+    QSignalSpy finishedSpy(&pipeline, &QProcessPipeline::finished);
+
+    pipeline.start();
+    QVERIFY(pipeline.isRunning());
+    QVERIFY(pipeline.waitForStarted());
+    pipeline.stage(0)->write("pear\napple\nfig\n");
+    pipeline.stage(0)->closeWriteChannel();
+    QVERIFY(pipeline.waitForFinished());
+
+    QVERIFY(!pipeline.isRunning());
+    QCOMPARE(pipeline.stage(1)->readAllStandardOutput(), QByteArray("apple\nfig\npear\n"));
+    QCOMPARE(pipeline.failedStage(), -1);
+    QCOMPARE(stageSpy.count(), 2);
+    QCOMPARE(finishedSpy.count(), 1);
+    for (const QList<QVariant> &arguments : qAsConst(stageSpy)) {
+        QCOMPARE(arguments.at(1).toInt(), 0);
+        QCOMPARE(arguments.at(2).value<QProcess::ExitStatus>(), QProcess::NormalExit);
+    }
+}
+
+void tst_QProcessPipeline::inputAndOutputFile()
+{
+    const QByteArray data = makeData(1024 * 1024);
+    const QString inputName = tempDir.path() + "/input";
+    const QString outputName = tempDir.path() + "/output";
+    QFile input(inputName);
+    QVERIFY(input.open(QIODevice::WriteOnly));
+    QCOMPARE(input.write(data), qint64(data.size()));
+    input.close();
+
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("cat");
+    pipeline.addStage("cat");
+    pipeline.setStandardInputFile(inputName);
+    pipeline.setStandardOutputFile(outputName);
+    pipeline.start();
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.failedStage(), -1);
+
+    QFile output(outputName);
+    QVERIFY(output.open(QIODevice::ReadOnly));
+    QVERIFY(output.readAll() == data);
+}
+
+void tst_QProcessPipeline::outputDevice_data()
+{
+    QTest::addColumn<bool>("toFile");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("file-small") << true << 100;
+    QTest::newRow("file-large") << true << 8 * 1024 * 1024;
+    QTest::newRow("buffer-small") << false << 100;
+    QTest::newRow("buffer-large") << false << 8 * 1024 * 1024;
+}
+
+void tst_QProcessPipeline::outputDevice()
+{
+    QFETCH(bool, toFile);
+    QFETCH(int, size);
+
+    const QByteArray data = makeData(size);
+    const QString inputName = tempDir.path() + "/input";
+    QFile input(inputName);
+    QVERIFY(input.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(input.write(data), qint64(data.size()));
+    input.close();
+
+    QFile file(tempDir.path() + "/forwarded");
+    QBuffer buffer;
+    QIODevice *device = toFile ? static_cast<QIODevice *>(&file) : &buffer;
+    QVERIFY(device->open(QIODevice::WriteOnly | QIODevice::Truncate));
+    if (toFile)
+        QCOMPARE(file.write("header\n"), qint64(7));
+
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("cat");
+    pipeline.setStandardInputFile(inputName);
+    pipeline.setOutputDevice(device);
+    QCOMPARE(pipeline.outputDevice(), device);
+    pipeline.start();
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.failedStage(), -1);
+
+    // nothing is left for reading from the last stage
+    QCOMPARE(pipeline.stage(1)->bytesAvailable(), qint64(0));
+
+    if (toFile) {
+        // the file device knows about the data written past its back
+        QCOMPARE(file.pos(), qint64(7 + size));
+        QCOMPARE(file.size(), qint64(7 + size));
+        QCOMPARE(file.write("trailer\n"), qint64(8));
+        file.close();
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll() == "header\n" + data + "trailer\n");
+    } else {
+        QVERIFY(buffer.data() == data);
+    }
+}
+
+void tst_QProcessPipeline::outputHeldOpen()
+{
+    if (QStandardPaths::findExecutable(QLatin1String("sh")).isEmpty())
+        QSKIP("This test needs a shell");
+
+    QFile file(tempDir.path() + "/heldopen");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+    // the last stage exits while a child of it keeps the output pipe open,
+    // so the pipe is empty but not at its end when the stage has finished
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("sh", QStringList() << "-c" << "cat; sleep 1 &");
+    pipeline.setStandardInputFile(QProcess::nullDevice());
+    pipeline.setOutputDevice(&file);
+    QSignalSpy errorSpy(&pipeline, &QProcessPipeline::errorOccurred);
+    pipeline.start();
+    QVERIFY(pipeline.waitForFinished());
+    QCOMPARE(pipeline.failedStage(), -1);
+    QCOMPARE(errorSpy.count(), 0);
+}
+
+void tst_QProcessPipeline::failedStage()
+{
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("false");
+    pipeline.addStage("cat");
+    pipeline.setStandardInputFile(QProcess::nullDevice());
+    pipeline.start();
+    QVERIFY(pipeline.waitForFinished());
+
+    QCOMPARE(pipeline.failedStage(), 1);
+    QCOMPARE(pipeline.stage(0)->exitCode(), 0);
+    QVERIFY(pipeline.stage(1)->exitCode() != 0);
+    QCOMPARE(pipeline.stage(2)->exitCode(), 0);
+}
+
+void tst_QProcessPipeline::failedToStart()
+{
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("this-program-does-not-exist-qprocesspipeline");
+    pipeline.addStage("cat");
+    pipeline.setStandardInputFile(QProcess::nullDevice());
+    QSignalSpy errorSpy(&pipeline, &QProcessPipeline::errorOccurred);
+    QSignalSpy finishedSpy(&pipeline, &QProcessPipeline::finished);
+
+    pipeline.start();
+    QVERIFY(!pipeline.waitForStarted());
+    if (pipeline.isRunning())
+        QVERIFY(pipeline.waitForFinished());
+
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(pipeline.failedStage(), 1);
+    QVERIFY(errorSpy.count() >= 1);
+    QCOMPARE(errorSpy.first().at(0).toInt(), 1);
+    QCOMPARE(errorSpy.first().at(1).value<QProcess::ProcessError>(), QProcess::FailedToStart);
+}
+
+void tst_QProcessPipeline::eventLoop()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+
+    QProcessPipeline pipeline;
+    pipeline.addStage("cat");
+    pipeline.addStage("sort");
+    pipeline.setOutputDevice(&buffer);
+    QSignalSpy finishedSpy(&pipeline, &QProcessPipeline::finished);
+
+    connect(pipeline.stage(0), &QProcess::started, [&pipeline]() {
+        pipeline.stage(0)->write("3\n1\n2\n");
+        pipeline.stage(0)->closeWriteChannel();
+    });
+    pipeline.start();
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(buffer.data(), QByteArray("1\n2\n3\n"));
+    QCOMPARE(pipeline.failedStage(), -1);
+}
+
+QTEST_MAIN(tst_QProcessPipeline)
+#include "tst_qprocesspipeline.moc"
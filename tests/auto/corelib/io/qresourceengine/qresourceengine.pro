@@ -8,14 +8,17 @@ RESOURCES += testqrc/test.qrc
 runtime_resource.target = runtime_resource.rcc
 runtime_resource.depends = $$PWD/testqrc/test.qrc
 runtime_resource.commands = $$[QT_INSTALL_BINS]/rcc -root /runtime_resource/ -binary $${runtime_resource.depends} -o $${runtime_resource.target}
-QMAKE_EXTRA_TARGETS = runtime_resource
-PRE_TARGETDEPS += $${runtime_resource.target}
-QMAKE_DISTCLEAN += $${runtime_resource.target}
+indexed_resource.target = indexed_resource.rcc
+indexed_resource.depends = $$PWD/testqrc/test.qrc
+indexed_resource.commands = $$[QT_INSTALL_BINS]/rcc -root /runtime_resource/ -binary -format-version 3 $${indexed_resource.depends} -o $${indexed_resource.target}
+QMAKE_EXTRA_TARGETS = runtime_resource indexed_resource
+PRE_TARGETDEPS += $${runtime_resource.target} $${indexed_resource.target}
+QMAKE_DISTCLEAN += $${runtime_resource.target} $${indexed_resource.target}
 
 TESTDATA += \
     parentdir.txt \
     testqrc/*
-GENERATED_TESTDATA = $${runtime_resource.target}
+GENERATED_TESTDATA = $${runtime_resource.target} $${indexed_resource.target}
 
 android {
     RESOURCES += android_testdata.qrc
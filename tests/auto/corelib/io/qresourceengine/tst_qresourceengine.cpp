@@ -37,9 +37,11 @@ class tst_QResourceEngine: public QObject
 public:
     tst_QResourceEngine()
 #if defined(Q_OS_ANDROID)
-        : m_runtimeResourceRcc(QFileInfo(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/runtime_resource.rcc")).absoluteFilePath())
+        : m_runtimeResourceRcc(QFileInfo(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/runtime_resource.rcc")).absoluteFilePath()),
+          m_indexedResourceRcc(QFileInfo(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/indexed_resource.rcc")).absoluteFilePath())
 #else
-        : m_runtimeResourceRcc(QFINDTESTDATA("runtime_resource.rcc"))
+        : m_runtimeResourceRcc(QFINDTESTDATA("runtime_resource.rcc")),
+          m_indexedResourceRcc(QFINDTESTDATA("indexed_resource.rcc"))
 #endif
     {}
 
@@ -49,6 +51,7 @@ private slots:
 
     void checkUnregisterResource_data();
     void checkUnregisterResource();
+    void unregisterBufferWhileLookingUp();
     void checkStructure_data();
     void checkStructure();
     void searchPath_data();
@@ -59,6 +62,7 @@ private slots:
 
 private:
     const QString m_runtimeResourceRcc;
+    const QString m_indexedResourceRcc;
 };
 
 
@@ -90,6 +94,8 @@ void tst_QResourceEngine::initTestCase()
     QVERIFY(!m_runtimeResourceRcc.isEmpty());
     QVERIFY(QResource::registerResource(m_runtimeResourceRcc));
     QVERIFY(QResource::registerResource(m_runtimeResourceRcc, "/secondary_root/"));
+    QVERIFY(!m_indexedResourceRcc.isEmpty());
+    QVERIFY(QResource::registerResource(m_indexedResourceRcc, "/indexed_root/"));
 }
 
 void tst_QResourceEngine::cleanupTestCase()
@@ -97,6 +103,7 @@ void tst_QResourceEngine::cleanupTestCase()
     // make sure we don't leak memory
     QVERIFY(QResource::unregisterResource(m_runtimeResourceRcc));
     QVERIFY(QResource::unregisterResource(m_runtimeResourceRcc, "/secondary_root/"));
+    QVERIFY(QResource::unregisterResource(m_indexedResourceRcc, "/indexed_root/"));
 }
 
 void tst_QResourceEngine::checkStructure_data()
@@ -112,6 +119,7 @@ void tst_QResourceEngine::checkStructure_data()
 
     QStringList rootContents;
     rootContents << QLatin1String("aliasdir")
+                 << QLatin1String("indexed_root")
                  << QLatin1String("otherdir")
                  << QLatin1String("qt-project.org")
                  << QLatin1String("runtime_resource")
@@ -139,8 +147,16 @@ void tst_QResourceEngine::checkStructure_data()
                                      << QLocale::c()
                                      << qlonglong(0);
 
+    QTest::newRow("indexed root")    << QString(":/indexed_root/")
+                                     << QString()
+                                     << QStringList()
+                                     << (QStringList() << QLatin1String("runtime_resource"))
+                                     << QLocale::c()
+                                     << qlonglong(0);
+
     QStringList roots;
-    roots << QString(":/") << QString(":/runtime_resource/") << QString(":/secondary_root/runtime_resource/");
+    roots << QString(":/") << QString(":/runtime_resource/") << QString(":/secondary_root/runtime_resource/")
+          << QString(":/indexed_root/runtime_resource/");
     for(int i = 0; i < roots.size(); ++i) {
         const QString root = roots.at(i);
 
@@ -463,6 +479,54 @@ void tst_QResourceEngine::checkUnregisterResource()
     QCOMPARE((int)fileInfo.size(), size);
 }
 
+class ResourceLookupThread : public QThread
+{
+public:
+    void run() override
+    {
+        while (!stop.load()) {
+            QResource resource(QStringLiteral(":/buffer_root/runtime_resource/search_file.txt"));
+            if (resource.isValid())
+                found.ref();
+            QResource missing(QStringLiteral(":/buffer_root/runtime_resource/no_such_file.txt"));
+            if (missing.isValid())
+                broken.ref();
+        }
+    }
+
+    QAtomicInt stop;
+    QAtomicInt found;
+    QAtomicInt broken;
+};
+
+void tst_QResourceEngine::unregisterBufferWhileLookingUp()
+{
+    QFile file(m_runtimeResourceRcc);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray rcc = file.readAll();
+
+    ResourceLookupThread threads[4];
+    for (ResourceLookupThread &thread : threads)
+        thread.start();
+
+    // once unregisterResource() has returned, the buffer may be freed
+    for (int i = 0; i < 100; ++i) {
+        uchar *buffer = new uchar[rcc.size()];
+        memcpy(buffer, rcc.constData(), rcc.size());
+        QVERIFY(QResource::registerResource(buffer, "/buffer_root/"));
+        QThread::yieldCurrentThread();
+        QResource::unregisterResource(buffer, "/buffer_root/");
+        memset(buffer, 0xff, rcc.size());
+        delete [] buffer;
+    }
+
+    for (ResourceLookupThread &thread : threads) {
+        thread.stop.store(1);
+        QVERIFY(thread.wait());
+        QCOMPARE(thread.broken.load(), 0);
+    }
+}
+
 void tst_QResourceEngine::doubleSlashInRoot()
 {
     QVERIFY(QFile::exists(":/secondary_root/runtime_resource/search_file.txt"));
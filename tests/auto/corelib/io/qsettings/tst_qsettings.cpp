@@ -171,6 +171,8 @@ private slots:
     void testVariantTypes();
     void testMetaTypes_data();
     void testMetaTypes();
+    void incrementalSync();
+    void incrementalSyncCompaction();
 #endif
     void rainersSyncBugOnMac_data();
     void rainersSyncBugOnMac();
@@ -183,6 +185,7 @@ private slots:
     void bom();
     void embeddedZeroByte_data();
     void embeddedZeroByte();
+    void appendedSections();
 
     void testXdg();
 private:
@@ -201,6 +204,13 @@ void tst_QSettings::getSetCheck()
     QCOMPARE(false, obj1.fallbacksEnabled());
     obj1.setFallbacksEnabled(true);
     QCOMPARE(true, obj1.fallbacksEnabled());
+    // bool QSettings::incrementalSyncEnabled()
+    // void QSettings::setIncrementalSyncEnabled(bool)
+    QCOMPARE(false, obj1.incrementalSyncEnabled());
+    obj1.setIncrementalSyncEnabled(true);
+    QCOMPARE(true, obj1.incrementalSyncEnabled());
+    obj1.setIncrementalSyncEnabled(false);
+    QCOMPARE(false, obj1.incrementalSyncEnabled());
 }
 
 static QString settingsPath(const char *path = Q_NULLPTR)
@@ -760,6 +770,38 @@ void tst_QSettings::embeddedZeroByte()
     }
 }
 
+void tst_QSettings::appendedSections()
+{
+    const QString fileName = settingsPath("appended.ini");
+    QSettings settings(fileName, QSettings::IniFormat);
+    settings.setValue("section/a", 1);
+    settings.setValue("section/b", 2);
+    settings.sync();
+    QCOMPARE(settings.value("section/a").toInt(), 1);
+
+    // sections appended by someone else override the ones read before
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("\n[section]\nb=20\nc=30\n");
+    file.close();
+
+    settings.sync();
+    QCOMPARE(settings.value("section/a").toInt(), 1);
+    QCOMPARE(settings.value("section/b").toInt(), 20);
+    QCOMPARE(settings.value("section/c").toInt(), 30);
+    QCOMPARE(settings.allKeys().size(), 3);
+
+    // keys that continue the last section are picked up as well
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("d=40\n");
+    file.close();
+
+    settings.sync();
+    QCOMPARE(settings.value("section/b").toInt(), 20);
+    QCOMPARE(settings.value("section/d").toInt(), 40);
+    QCOMPARE(settings.allKeys().size(), 4);
+}
+
 void tst_QSettings::testErrorHandling_data()
 {
     QTest::addColumn<int>("filePerms"); // -1 means file should not exist
@@ -1239,6 +1281,84 @@ void tst_QSettings::testVariantTypes_data()
 {
     populateWithFormats();
 }
+
+void tst_QSettings::incrementalSync()
+{
+    const QString fileName = settingsPath("incremental.ini");
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setValue("group/key1", 1);
+        settings.setValue("key2", "two");
+    }
+    const qint64 initialSize = QFileInfo(fileName).size();
+
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setIncrementalSyncEnabled(true);
+        settings.setValue("group/key1", 10);
+        settings.setValue("group/key3", QStringList() << "a" << "b");
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+        QCOMPARE(settings.value("group/key1").toInt(), 10);
+    }
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray contents = file.readAll();
+    file.close();
+    QVERIFY(contents.size() > initialSize);
+    QVERIFY(contents.startsWith("[General]\nkey2=two\n"));
+    QCOMPARE(contents.count("[group]"), 2);
+
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("group/key1").toInt(), 10);
+        QCOMPARE(settings.value("group/key3").toStringList(), QStringList() << "a" << "b");
+        QCOMPARE(settings.value("key2").toString(), QString("two"));
+        QCOMPARE(settings.allKeys().size(), 3);
+
+        // removing a key rewrites the file
+        settings.setIncrementalSyncEnabled(true);
+        settings.remove("key2");
+        settings.sync();
+        QCOMPARE(settings.status(), QSettings::NoError);
+    }
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    contents = file.readAll();
+    file.close();
+    QCOMPARE(contents.count("[group]"), 1);
+    QVERIFY(!contents.contains("key2"));
+}
+
+void tst_QSettings::incrementalSyncCompaction()
+{
+    const QString fileName = settingsPath("compaction.ini");
+    const QByteArray value(20000, 'x');
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setIncrementalSyncEnabled(true);
+        settings.setValue("key", 1);
+        settings.sync();
+
+        // the appended data soon outweighs the rest of the file
+        for (int i = 0; i < 5; ++i) {
+            settings.setValue("group/value", value + QByteArray::number(i));
+            settings.sync();
+            QCOMPARE(settings.status(), QSettings::NoError);
+        }
+        QTRY_VERIFY(QFileInfo(fileName).size() < 3 * value.size());
+
+        QCOMPARE(settings.value("group/value").toByteArray(), value + '4');
+        settings.setValue("group/value", value + '5');
+    }
+
+    QConfFile::clearCache();
+    QSettings settings(fileName, QSettings::IniFormat);
+    QCOMPARE(settings.value("key").toInt(), 1);
+    QCOMPARE(settings.value("group/value").toByteArray(), value + '5');
+}
 #endif
 
 #ifdef QT_BUILD_INTERNAL
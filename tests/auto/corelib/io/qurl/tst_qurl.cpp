@@ -166,6 +166,7 @@ private slots:
     void fileName();
     void isEmptyForEncodedUrl();
     void toEncodedNotUsingUninitializedPath();
+    void toEncodedAfterModification();
     void emptyAuthorityRemovesExistingAuthority_data();
     void emptyAuthorityRemovesExistingAuthority();
     void acceptEmptyAuthoritySegments();
@@ -3213,6 +3214,39 @@ void tst_QUrl::toEncodedNotUsingUninitializedPath()
     QCOMPARE(url.toEncoded().constData(), "//example.com/test.txt");
 }
 
+void tst_QUrl::toEncodedAfterModification()
+{
+    QUrl url("http://example.com/a%20b?q=1#frag");
+    const QByteArray original("http://example.com/a%20b?q=1#frag");
+    QCOMPARE(url.toEncoded(), original);
+    QCOMPARE(url.toEncoded(), original);
+
+    // copies share the encoded form until one of them changes
+    QUrl copy = url;
+    QCOMPARE(copy.toEncoded(), original);
+    copy.setPath("/c");
+    QCOMPARE(copy.toEncoded(), QByteArray("http://example.com/c?q=1#frag"));
+    QCOMPARE(url.toEncoded(), original);
+
+    url.setHost("qt-project.org");
+    QCOMPARE(url.toEncoded(), QByteArray("http://qt-project.org/a%20b?q=1#frag"));
+    url.setPort(8080);
+    QCOMPARE(url.toEncoded(), QByteArray("http://qt-project.org:8080/a%20b?q=1#frag"));
+    url.setQuery(QString());
+    url.setFragment(QString());
+    QCOMPARE(url.toEncoded(), QByteArray("http://qt-project.org:8080/a%20b"));
+    QCOMPARE(url.toEncoded(QUrl::RemovePort), QByteArray("http://qt-project.org/a%20b"));
+    url.setUrl("ftp://example.net/");
+    QCOMPARE(url.toEncoded(), QByteArray("ftp://example.net/"));
+    url = QUrl::fromEncoded("file:///tmp/x");
+    QCOMPARE(url.toEncoded(), QByteArray("file:///tmp/x"));
+    url.clear();
+    QCOMPARE(url.toEncoded(), QByteArray());
+    url.setScheme("mailto");
+    url.setPath("user@example.com");
+    QCOMPARE(url.toEncoded(), QByteArray("mailto:user@example.com"));
+}
+
 void tst_QUrl::resolvedWithAbsoluteSchemes() const
 {
     QFETCH(QUrl, base);
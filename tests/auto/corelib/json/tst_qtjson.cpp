@@ -32,6 +32,7 @@
 #include "qjsonobject.h"
 #include "qjsonvalue.h"
 #include "qjsondocument.h"
+#include "qjsonstream.h"
 #include "qregularexpression.h"
 #include <limits>
 
@@ -39,6 +40,9 @@
 #define UNICODE_NON_CHARACTER "\xEF\xBF\xBF"
 #define UNICODE_DJE "\320\202" // Character from the Serbian Cyrillic alphabet
 
+Q_DECLARE_METATYPE(QJsonParseError::ParseError)
+Q_DECLARE_METATYPE(QJsonDocument::JsonFormat)
+
 class tst_QtJson: public QObject
 {
     Q_OBJECT
@@ -110,10 +114,13 @@ private Q_SLOTS:
 
     void testDuplicateKeys();
     void testCompaction();
+    void incrementalBuild();
+    void largeDocument();
     void testDebugStream();
     void testCompactionError();
 
     void parseUnicodeEscapes();
+    void parseAcrossBlockBoundaries();
 
     void assignObjects();
     void assignArrays();
@@ -145,6 +152,17 @@ private Q_SLOTS:
     void parseErrorOffset_data();
     void parseErrorOffset();
 
+    void streamReaderTokens();
+    void streamReaderDocument();
+    void streamReaderIncremental();
+    void streamReaderSequence();
+    void streamReaderTopLevelNumber();
+    void streamReaderErrors_data();
+    void streamReaderErrors();
+    void streamWriter_data();
+    void streamWriter();
+    void streamWriterDevice();
+
 private:
     QString testDataDir;
 };
@@ -2174,6 +2192,105 @@ void tst_QtJson::testCompaction()
     QCOMPARE(doc.object(), obj);
 }
 
+void tst_QtJson::incrementalBuild()
+{
+    // inserting in all kinds of positions moves the table around in the data
+    QJsonObject object;
+    for (int i = 0; i < 2000; ++i) {
+        const int n = (i * 7919) % 2000;
+        if (n % 3 == 0)
+            object.insert(QString::number(n), QString(n % 50, QLatin1Char('x')));
+        else if (n % 3 == 1)
+            object.insert(QString::number(n), n + 0.5);
+        else
+            object.insert(QString::number(n), QJsonArray() << n << QString::number(n));
+    }
+    QJsonArray array;
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 3 == 0)
+            array.prepend(i);
+        else if (i % 3 == 1)
+            array.insert(array.size() / 2, QString(i % 70, QChar(0x2603)));
+        else
+            array.append(object.value(QString::number(i)));
+    }
+    QCOMPARE(object.size(), 2000);
+    QCOMPARE(array.size(), 2000);
+    for (int i = 0; i < 2000; ++i) {
+        const QJsonValue value = object.value(QString::number(i));
+        if (i % 3 == 0)
+            QCOMPARE(value.toString(), QString(i % 50, QLatin1Char('x')));
+        else if (i % 3 == 1)
+            QCOMPARE(value.toDouble(), i + 0.5);
+        else
+            QCOMPARE(value.toArray(), QJsonArray() << i << QString::number(i));
+    }
+    QCOMPARE(array.first().toInt(), 1998);
+    QCOMPARE(array.last(), object.value(QLatin1String("1997")));
+
+    // copies of the containers drop the unused space
+    QJsonObject outer;
+    outer.insert(QLatin1String("object"), object);
+    outer.insert(QLatin1String("array"), array);
+    QCOMPARE(outer.value(QLatin1String("object")).toObject(), object);
+    QCOMPARE(outer.value(QLatin1String("array")).toArray(), array);
+
+    const QByteArray binary = QJsonDocument(outer).toBinaryData();
+    QJsonDocument doc = QJsonDocument::fromBinaryData(binary);
+    QVERIFY(!doc.isNull());
+    QCOMPARE(doc.object(), outer);
+    doc = QJsonDocument::fromRawData(binary.constData(), binary.size());
+    QVERIFY(!doc.isNull());
+    QCOMPARE(doc.object(), outer);
+    QCOMPARE(QJsonDocument::fromJson(doc.toJson()).object(), outer);
+}
+
+void tst_QtJson::largeDocument()
+{
+    if (sizeof(void *) < 8)
+        QSKIP("This test needs a 64 bit address space");
+
+    // beyond 128 MB the array switches to wide offsets
+    const QString chunk(128 * 1024, QLatin1Char('a'));
+    const int count = 1100;
+    QJsonArray array;
+    for (int i = 0; i < count; ++i) {
+        array.append(i);
+        array.append(chunk + QString::number(i));
+    }
+    array.append(QJsonObject{{QLatin1String("last"), 42.5}});
+    QCOMPARE(array.size(), 2 * count + 1);
+    QCOMPARE(array.at(2 * count - 1).toString(), chunk + QString::number(count - 1));
+    QCOMPARE(array.last().toObject().value(QLatin1String("last")).toDouble(), 42.5);
+
+    QByteArray binary = QJsonDocument(array).toBinaryData();
+    QVERIFY(binary.size() > 128 * 1024 * 1024);
+    QCOMPARE(qFromLittleEndian<quint32>(binary.constData() + 4), 2u);
+    {
+        QJsonDocument doc = QJsonDocument::fromRawData(binary.constData(), binary.size());
+        QVERIFY(doc.isArray());
+        QCOMPARE(doc.array().size(), 2 * count + 1);
+        QCOMPARE(doc.array().at(2 * count - 1).toString(), chunk + QString::number(count - 1));
+        QCOMPARE(doc.array().last(), array.last());
+    }
+
+    // documents too large for the parser are read value by value
+    QByteArray json = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(doc.array(), array);
+    json.clear();
+    doc = QJsonDocument();
+
+    // once small enough again, the array goes back to the version 1 format
+    while (array.size() > 11)
+        array.removeFirst();
+    binary = QJsonDocument(array).toBinaryData();
+    QCOMPARE(qFromLittleEndian<quint32>(binary.constData() + 4), 1u);
+    QCOMPARE(QJsonDocument::fromBinaryData(binary).array(), array);
+}
+
 void tst_QtJson::testDebugStream()
 {
     {
@@ -2303,6 +2420,41 @@ void tst_QtJson::parseUnicodeEscapes()
     QCOMPARE(array.first().toString(), result);
 }
 
+void tst_QtJson::parseAcrossBlockBoundaries()
+{
+    // the parser scans whitespace and strings in blocks of up to 32 bytes,
+    // so move every kind of interesting character across such a block
+    const QString specials[] = {
+        QStringLiteral("\""), QStringLiteral("\\"), QStringLiteral("/"),
+        QString(QChar(0xe4)), QString(QChar(0x20ac)), QStringLiteral("\U0001F600")
+    };
+    for (int length = 0; length < 70; ++length) {
+        const QString prefix(length, QLatin1Char('x'));
+        const QByteArray space(length, length % 2 ? ' ' : '\n');
+        for (const QString &special : specials) {
+            const QString expected = prefix + special + prefix;
+            QJsonObject object;
+            object.insert(expected, expected);
+            QByteArray json = QJsonDocument(object).toJson(QJsonDocument::Compact);
+            json.replace(':', space + ':' + space);
+            json.prepend(space);
+            json.append(space);
+
+            QJsonParseError error;
+            QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+            QCOMPARE(error.error, QJsonParseError::NoError);
+            QCOMPARE(doc.object().value(expected).toString(), expected);
+        }
+    }
+
+    // an unterminated string must not be read past its end
+    for (int length = 0; length < 70; ++length) {
+        QJsonParseError error;
+        QJsonDocument::fromJson("[\"" + QByteArray(length, 'x'), &error);
+        QCOMPARE(error.error, QJsonParseError::UnterminatedString);
+    }
+}
+
 void tst_QtJson::assignObjects()
 {
     const char *json =
@@ -2908,5 +3060,403 @@ void tst_QtJson::parseErrorOffset()
     QCOMPARE(error.offset, errorOffset);
 }
 
+void tst_QtJson::streamReaderTokens()
+{
+    QJsonStreamReader reader(QByteArray("\xef\xbb\xbf{ \"a\\u00e9\": [1.5, -2e3, \"x\\n\\\"y\", \"" UNICODE_DJE "\"],"
+                                        "\"b\": {}, \"c\": true, \"d\": false, \"e\": null }"));
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.depth(), 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.text(), QString::fromUtf8("a\xc3\xa9"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.depth(), 2);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 1.5);
+    QCOMPARE(reader.text(), QString("1.5"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.value(), QJsonValue(-2000));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), QString("x\n\"y"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), QString::fromUtf8(UNICODE_DJE));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.depth(), 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.text(), QString("b"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Bool);
+    QCOMPARE(reader.toBool(), true);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Bool);
+    QCOMPARE(reader.toBool(), false);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Name);
+    QCOMPARE(reader.text(), QString("e"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Null);
+    QCOMPARE(reader.value(), QJsonValue());
+    QVERIFY(!reader.atEnd());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+}
+
+void tst_QtJson::streamReaderDocument()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QJsonDocument expected = QJsonDocument::fromJson(file.readAll());
+    QVERIFY(!expected.isNull());
+    QVERIFY(file.seek(0));
+
+    QJsonStreamReader reader(&file);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.readCurrentValue(), QJsonValue(expected.array()));
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+    QCOMPARE(reader.offset(), file.size());
+
+    // skipping gets to the same place
+    QVERIFY(file.seek(0));
+    const qint64 end = file.readAll().lastIndexOf(']') + 1;
+    QVERIFY(file.seek(0));
+    reader.setDevice(&file);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    reader.skipCurrentValue();
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.offset(), end);
+}
+
+static QList<QJsonStreamReader::TokenType> readTokens(QJsonStreamReader &reader, QStringList *texts)
+{
+    QList<QJsonStreamReader::TokenType> tokens;
+    while (!reader.atEnd()) {
+        const QJsonStreamReader::TokenType token = reader.readNext();
+        if (token == QJsonStreamReader::NoToken || token == QJsonStreamReader::Invalid)
+            break;
+        tokens << token;
+        *texts << reader.text();
+    }
+    return tokens;
+}
+
+void tst_QtJson::streamReaderIncremental()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QByteArray json = file.readAll();
+
+    QStringList expectedTexts;
+    QJsonStreamReader reader(json);
+    const QList<QJsonStreamReader::TokenType> expectedTokens = readTokens(reader, &expectedTexts);
+    QVERIFY(!reader.hasError());
+    QVERIFY(expectedTokens.size() > 100);
+
+    // one byte at a time: every token is interrupted at every possible place
+    QStringList texts;
+    QList<QJsonStreamReader::TokenType> tokens;
+    reader.clear();
+    for (int i = 0; i < json.size(); ++i) {
+        reader.addData(json.mid(i, 1));
+        tokens += readTokens(reader, &texts);
+        QVERIFY2(!reader.hasError() || reader.error() == QJsonParseError::PrematureEndOfDocument,
+                 qPrintable(reader.errorString()));
+    }
+    QCOMPARE(tokens, expectedTokens);
+    QCOMPARE(texts, expectedTexts);
+    QVERIFY(!reader.hasError());
+}
+
+void tst_QtJson::streamReaderSequence()
+{
+    QJsonStreamReader reader(QByteArray("{\"id\":1}\n{\"id\":2}\n[3]\n\"four\"\n"));
+    QList<QJsonValue> values;
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QJsonStreamReader::NoToken)
+            values << reader.readCurrentValue();
+    }
+    QVERIFY(!reader.hasError());
+    QCOMPARE(values.size(), 4);
+    QCOMPARE(values.at(0).toObject().value("id").toInt(), 1);
+    QCOMPARE(values.at(1).toObject().value("id").toInt(), 2);
+    QCOMPARE(values.at(2), QJsonValue(QJsonArray{3}));
+    QCOMPARE(values.at(3), QJsonValue("four"));
+
+    // a number at the end can only be told complete by the device
+    QBuffer buffer;
+    buffer.setData("1 2");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    reader.setDevice(&buffer);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 2.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    reader.clear();
+    reader.addData("1 2");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), QJsonParseError::PrematureEndOfDocument);
+    reader.addData(" ");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 2.);
+}
+
+// like a socket: it cannot tell whether more data will arrive
+class SequentialBuffer : public QIODevice
+{
+public:
+    void setData(const QByteArray &data) { m_data = data; }
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_data.size() + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const int size = int(qMin(maxSize, qint64(m_data.size())));
+        memcpy(data, m_data.constData(), size);
+        m_data.remove(0, size);
+        return size;
+    }
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QByteArray m_data;
+};
+
+void tst_QtJson::streamReaderTopLevelNumber()
+{
+    // a QByteArray passed to the constructor is the complete input
+    QJsonStreamReader reader(QByteArray("42"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 42.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+
+    // added data is complete once the reader is told so
+    reader.clear();
+    reader.addData("4");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), QJsonParseError::PrematureEndOfDocument);
+    reader.addData("2");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), QJsonParseError::PrematureEndOfDocument);
+    reader.setInputComplete();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 42.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    // a random-access device is complete at its end
+    QBuffer buffer;
+    buffer.setData("42");
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    reader.setDevice(&buffer);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 42.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    // a sequential device is complete once it has been closed...
+    SequentialBuffer sequential;
+    sequential.setData("42");
+    QVERIFY(sequential.open(QIODevice::ReadOnly));
+    reader.setDevice(&sequential);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), QJsonParseError::PrematureEndOfDocument);
+    sequential.close();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 42.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    // ...or when the reader is told so
+    sequential.setData("42");
+    QVERIFY(sequential.open(QIODevice::ReadOnly));
+    reader.setDevice(&sequential);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), QJsonParseError::PrematureEndOfDocument);
+    reader.setInputComplete();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Number);
+    QCOMPARE(reader.toDouble(), 42.);
+    QVERIFY(!reader.hasError());
+}
+
+void tst_QtJson::streamReaderErrors_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QJsonParseError::ParseError>("error");
+
+    QTest::newRow("missing name separator") << QByteArray("{ \"key\" 10 }") << QJsonParseError::MissingNameSeparator;
+    QTest::newRow("missing value separator") << QByteArray("[ 1 true ]") << QJsonParseError::MissingValueSeparator;
+    QTest::newRow("trailing comma in object") << QByteArray("{ \"value\": false, }") << QJsonParseError::MissingObject;
+    QTest::newRow("trailing comma in array") << QByteArray("[ false, ]") << QJsonParseError::MissingObject;
+    QTest::newRow("missing value") << QByteArray("{ \"value\": , }") << QJsonParseError::IllegalValue;
+    QTest::newRow("unterminated object") << QByteArray("{ 1 }") << QJsonParseError::UnterminatedObject;
+    QTest::newRow("illegal literal") << QByteArray("[ ture ]") << QJsonParseError::IllegalValue;
+    QTest::newRow("illegal number") << QByteArray("[ -x ]") << QJsonParseError::IllegalNumber;
+    QTest::newRow("illegal escape") << QByteArray("[ \"\\u12x4\" ]") << QJsonParseError::IllegalEscapeSequence;
+    QTest::newRow("illegal utf8") << QByteArray("[ \"" INVALID_UNICODE "\" ]") << QJsonParseError::IllegalUTF8String;
+    QTest::newRow("deep nesting") << QByteArray(1025, '[') << QJsonParseError::DeepNesting;
+    QTest::newRow("premature end") << QByteArray("{ \"a\": [ \"b") << QJsonParseError::PrematureEndOfDocument;
+}
+
+void tst_QtJson::streamReaderErrors()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QJsonParseError::ParseError, error);
+
+    QJsonStreamReader reader(json);
+    while (!reader.atEnd())
+        reader.readNext();
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::Invalid);
+    QCOMPARE(reader.error(), error);
+    QVERIFY(!reader.errorString().isEmpty());
+
+    // the document parser agrees, except that it knows the input is complete
+    if (error != QJsonParseError::PrematureEndOfDocument) {
+        QJsonParseError parseError;
+        QJsonDocument::fromJson(json, &parseError);
+        QCOMPARE(parseError.error, error);
+    }
+}
+
+static void copyTokens(QJsonStreamReader &reader, QJsonStreamWriter &writer)
+{
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QJsonStreamReader::StartObject:
+            writer.writeStartObject();
+            break;
+        case QJsonStreamReader::EndObject:
+            writer.writeEndObject();
+            break;
+        case QJsonStreamReader::StartArray:
+            writer.writeStartArray();
+            break;
+        case QJsonStreamReader::EndArray:
+            writer.writeEndArray();
+            break;
+        case QJsonStreamReader::Name:
+            writer.writeName(reader.text());
+            break;
+        case QJsonStreamReader::String:
+            writer.writeString(reader.text());
+            break;
+        case QJsonStreamReader::Number:
+            writer.writeDouble(reader.toDouble());
+            break;
+        case QJsonStreamReader::Bool:
+            writer.writeBool(reader.toBool());
+            break;
+        case QJsonStreamReader::Null:
+            writer.writeNull();
+            break;
+        case QJsonStreamReader::NoToken:
+        case QJsonStreamReader::Invalid:
+            break;
+        }
+    }
+}
+
+void tst_QtJson::streamWriter_data()
+{
+    QTest::addColumn<QJsonDocument::JsonFormat>("format");
+    QTest::newRow("indented") << QJsonDocument::Indented;
+    QTest::newRow("compact") << QJsonDocument::Compact;
+}
+
+void tst_QtJson::streamWriter()
+{
+    QFETCH(QJsonDocument::JsonFormat, format);
+
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QByteArray expected = doc.toJson(format);
+    if (format == QJsonDocument::Compact)
+        expected += '\n';
+
+    // the same text as QJsonDocument, token by token (QJsonObject sorts
+    // the keys, so copy what QJsonDocument wrote)...
+    const QByteArray json = doc.toJson();
+    QByteArray output;
+    {
+        QJsonStreamReader reader(json);
+        QJsonStreamWriter writer(&output);
+        writer.setFormat(format);
+        copyTokens(reader, writer);
+        QVERIFY(!reader.hasError());
+        QCOMPARE(writer.depth(), 0);
+    }
+    QCOMPARE(output, expected);
+
+    // ...and for values written in one go, also nested ones
+    output.clear();
+    {
+        QJsonStreamWriter writer(&output);
+        writer.setFormat(format);
+        writer.writeValue(doc.array());
+        writer.writeStartObject();
+        writer.writeName(QString::fromUtf8("\"" UNICODE_DJE));
+        writer.writeValue(QJsonObject());
+        writer.writeName("nested");
+        writer.writeValue(doc.array());
+        writer.writeEndObject();
+    }
+    QJsonObject nested;
+    nested.insert("nested", doc.array());
+    nested.insert(QString::fromUtf8("\"" UNICODE_DJE), QJsonObject());
+    QByteArray expectedNested = QJsonDocument(nested).toJson(format);
+    if (format == QJsonDocument::Compact)
+        expectedNested += '\n';
+    QCOMPARE(output, expected + expectedNested);
+}
+
+void tst_QtJson::streamWriterDevice()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+
+    QJsonArray expected;
+    {
+        QJsonStreamWriter writer(&buffer);
+        writer.setFormat(QJsonDocument::Compact);
+        for (int i = 0; i < 10000; ++i) {
+            writer.writeStartObject();
+            writer.writeName("id");
+            writer.writeDouble(i);
+            writer.writeName("name");
+            writer.writeString(QString::number(i));
+            writer.writeEndObject();
+
+            QJsonObject record;
+            record.insert("id", i);
+            record.insert("name", QString::number(i));
+            expected.append(record);
+        }
+        // text is passed on in chunks, not only at the end
+        QVERIFY(buffer.size() > 0);
+        writer.flush();
+        QVERIFY(!writer.hasError());
+        QVERIFY(buffer.data().endsWith("}\n"));
+    }
+
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QJsonStreamReader reader(&buffer);
+    QJsonArray records;
+    while (reader.readNext() == QJsonStreamReader::StartObject)
+        records.append(reader.readCurrentValue());
+    QVERIFY(!reader.hasError());
+    QCOMPARE(records, expected);
+}
+
 QTEST_MAIN(tst_QtJson)
 #include "tst_qtjson.moc"
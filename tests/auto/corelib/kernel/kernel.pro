@@ -16,6 +16,7 @@ SUBDIRS=\
     qobject \
     qpointer \
     qsharedmemory \
+    qsharedmemorychannel \
     qsignalblocker \
     qsignalmapper \
     qsocketnotifier \
@@ -37,6 +38,9 @@ SUBDIRS=\
     qsocketnotifier \
     qsharedmemory
 
+# This class is only available on Linux
+!linux|android|!qtConfig(sharedmemory): SUBDIRS -= qsharedmemorychannel
+
 # This test is only applicable on Windows
 !win32*|winrt: SUBDIRS -= qwineventnotifier
 
@@ -66,6 +66,8 @@ private slots:
     void sendPostedEvents_data();
     void sendPostedEvents();
     void processEventsOnlySendsQueuedEvents();
+    void statistics();
+    void statisticsFromOtherThread();
 };
 
 bool tst_QEventDispatcher::event(QEvent *e)
@@ -239,5 +241,105 @@ void tst_QEventDispatcher::processEventsOnlySendsQueuedEvents()
     QCOMPARE(object.eventsReceived, 4);
 }
 
+void tst_QEventDispatcher::statistics()
+{
+    const QEventDispatcherStatistics before = eventDispatcher->statistics();
+
+    QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+    QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 1)));
+    QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::MaxUser)));
+    QTest::qSleep(20);
+
+    QEventDispatcherStatistics statistics = eventDispatcher->statistics();
+    QVERIFY(statistics.postedEventCount() >= 3);
+    QVERIFY(statistics.oldestPostedEventAge() >= 20 * 1000 * 1000);
+    QCOMPARE(statistics.eventCount(QEvent::User), before.eventCount(QEvent::User));
+
+    QVERIFY(eventDispatcher->processEvents(QEventLoop::AllEvents));
+    statistics = eventDispatcher->statistics();
+    QCOMPARE(statistics.postedEventCount(), 0);
+    QCOMPARE(statistics.oldestPostedEventAge(), qint64(0));
+    QVERIFY(statistics.deliveredPostedEventCount() >= before.deliveredPostedEventCount() + 3);
+    QVERIFY(statistics.maximumPostedEventLatency() >= 20 * 1000 * 1000);
+    QVERIFY(statistics.averagePostedEventLatency() > 0);
+    QVERIFY(statistics.averagePostedEventLatency() <= statistics.maximumPostedEventLatency());
+
+    // all user types are counted together
+    QCOMPARE(statistics.eventCount(QEvent::User), before.eventCount(QEvent::User) + 3);
+    QCOMPARE(statistics.eventCount(QEvent::MaxUser), statistics.eventCount(QEvent::User));
+    QVERIFY(statistics.eventTypes().contains(QEvent::User));
+    QVERIFY(!statistics.eventTypes().contains(QEvent::MaxUser));
+    QVERIFY(statistics.eventHandlingTime(QEvent::User) >= statistics.maximumEventHandlingTime(QEvent::User));
+
+    // sent events are counted too
+    QEvent event(QEvent::Type(QEvent::User + 2));
+    QCoreApplication::sendEvent(this, &event);
+    QCOMPARE(eventDispatcher->statistics().eventCount(QEvent::User), statistics.eventCount(QEvent::User) + 1);
+
+#if defined(Q_OS_DARWIN) || defined(Q_OS_WINRT)
+    QSKIP("This event dispatcher does not maintain the iteration, blocking and timer counters");
+#endif
+    QVERIFY(statistics.iterations() > before.iterations());
+    QVERIFY(statistics.busyTime() > before.busyTime());
+
+    // wait for a timer, which blocks in the event dispatcher
+    const QVector<quint64> histogramBefore = statistics.timerLatenessHistogram();
+    QCOMPARE(histogramBefore.size(), 12);
+    const int timerId = eventDispatcher->registerTimer(PreciseTimerInterval, Qt::PreciseTimer, this);
+    receivedEventType = -1;
+    while (receivedEventType != QEvent::Timer)
+        eventDispatcher->processEvents(QEventLoop::WaitForMoreEvents);
+    eventDispatcher->unregisterTimer(timerId);
+
+    const QEventDispatcherStatistics after = eventDispatcher->statistics();
+    QVERIFY(after.blockedTime() > statistics.blockedTime());
+    QVERIFY(after.eventCount(QEvent::Timer) > statistics.eventCount(QEvent::Timer));
+    const QVector<quint64> histogramAfter = after.timerLatenessHistogram();
+    QCOMPARE(histogramAfter.size(), histogramBefore.size());
+    quint64 timersBefore = 0, timersAfter = 0;
+    for (int i = 0; i < histogramAfter.size(); ++i) {
+        QVERIFY(histogramAfter.at(i) >= histogramBefore.at(i));
+        timersBefore += histogramBefore.at(i);
+        timersAfter += histogramAfter.at(i);
+    }
+    QCOMPARE(timersAfter, timersBefore + 1);
+}
+
+class StatisticsWorker : public QObject
+{
+    Q_OBJECT
+public:
+    bool event(QEvent *event) Q_DECL_OVERRIDE
+    {
+        if (event->type() == QEvent::User)
+            QTest::qSleep(10);
+        return QObject::event(event);
+    }
+};
+
+void tst_QEventDispatcher::statisticsFromOtherThread()
+{
+    QThread thread;
+    StatisticsWorker worker;
+    worker.moveToThread(&thread);
+    thread.start();
+    QTRY_VERIFY(thread.eventDispatcher());
+    QAbstractEventDispatcher *dispatcher = thread.eventDispatcher();
+
+    for (int i = 0; i < 5; ++i)
+        QCoreApplication::postEvent(&worker, new QEvent(QEvent::User));
+
+    QTRY_COMPARE(dispatcher->statistics().eventCount(QEvent::User), quint64(5));
+    const QEventDispatcherStatistics statistics = dispatcher->statistics();
+    QCOMPARE(statistics.deliveredPostedEventCount(), quint64(5));
+    QVERIFY(statistics.eventHandlingTime(QEvent::User) >= 5 * 10 * 1000 * 1000);
+    QVERIFY(statistics.maximumEventHandlingTime(QEvent::User) >= 10 * 1000 * 1000);
+    // the last event waited for the four others to be handled
+    QVERIFY(statistics.maximumPostedEventLatency() >= 4 * 10 * 1000 * 1000);
+
+    thread.quit();
+    thread.wait();
+}
+
 QTEST_MAIN(tst_QEventDispatcher)
 #include "tst_qeventdispatcher.moc"
@@ -0,0 +1,382 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QSharedMemoryChannel>
+
+#include <functional>
+
+class FunctionThread : public QThread
+{
+public:
+    explicit FunctionThread(std::function<void()> function)
+        : function(std::move(function))
+    {
+    }
+
+protected:
+    void run() Q_DECL_OVERRIDE { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+class tst_QSharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void createAndAttach();
+    void attachNotFound();
+    void singleSender();
+    void sendReceive();
+    void wrapAround();
+    void full();
+    void messageTooLarge();
+    void receiverClosed();
+    void corruptedRecord_data();
+    void corruptedRecord();
+    void blockingSend();
+    void multipleSenders();
+    void messageAvailable();
+
+private:
+    QString key;
+};
+
+void tst_QSharedMemoryChannel::init()
+{
+    key = QString("tst_qsharedmemorychannel_%1_%2")
+            .arg(QCoreApplication::applicationPid())
+            .arg(QTest::currentTestFunction());
+}
+
+void tst_QSharedMemoryChannel::createAndAttach()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(!receiver.isAttached());
+    QCOMPARE(receiver.capacity(), 0);
+    QVERIFY2(receiver.create(1000, QSharedMemoryChannel::SingleSender),
+             qPrintable(receiver.errorString()));
+    QVERIFY(receiver.isAttached());
+    QVERIFY(receiver.isReceiver());
+    QCOMPARE(receiver.capacity(), 1024);
+    QCOMPARE(receiver.mode(), QSharedMemoryChannel::SingleSender);
+    QVERIFY(!receiver.create(1000));
+    QCOMPARE(receiver.error(), QSharedMemoryChannel::AlreadyExists);
+
+    QSharedMemoryChannel sender;
+    sender.setKey(key);
+    QCOMPARE(sender.key(), key);
+    QVERIFY2(sender.attach(), qPrintable(sender.errorString()));
+    QVERIFY(sender.isAttached());
+    QVERIFY(!sender.isReceiver());
+    QCOMPARE(sender.capacity(), 1024);
+    QCOMPARE(sender.mode(), QSharedMemoryChannel::SingleSender);
+
+    QVERIFY(sender.detach());
+    QVERIFY(!sender.isAttached());
+    QVERIFY(!sender.detach());
+    QVERIFY(receiver.detach());
+
+    QSharedMemoryChannel tooSmall(key);
+    QVERIFY(!tooSmall.create(16));
+    QCOMPARE(tooSmall.error(), QSharedMemoryChannel::InvalidSize);
+}
+
+void tst_QSharedMemoryChannel::attachNotFound()
+{
+    QSharedMemoryChannel sender(key);
+    QVERIFY(!sender.attach());
+    QCOMPARE(sender.error(), QSharedMemoryChannel::NotFound);
+    QVERIFY(!sender.isAttached());
+}
+
+void tst_QSharedMemoryChannel::singleSender()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(4096, QSharedMemoryChannel::SingleSender));
+
+    QSharedMemoryChannel first(key);
+    QVERIFY(first.attach());
+    QSharedMemoryChannel second(key);
+    QVERIFY(!second.attach());
+    QCOMPARE(second.error(), QSharedMemoryChannel::AlreadyExists);
+
+    first.detach();
+    QVERIFY2(second.attach(), qPrintable(second.errorString()));
+}
+
+void tst_QSharedMemoryChannel::sendReceive()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(4096));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+
+    QVERIFY(!receiver.hasPendingMessages());
+    QCOMPARE(receiver.nextMessageSize(), -1);
+    QVERIFY(receiver.receive().isNull());
+
+    QVERIFY(sender.send(QByteArray("hello")));
+    QVERIFY(sender.send(QByteArray()));
+    QVERIFY(sender.send(QByteArray(100, 'x')));
+
+    // only the receiver can receive, only senders can send
+    QVERIFY(!receiver.send(QByteArray("nope")));
+    QVERIFY(sender.receive().isNull());
+
+    QVERIFY(receiver.hasPendingMessages());
+    QCOMPARE(receiver.nextMessageSize(), 5);
+    QCOMPARE(receiver.receive(), QByteArray("hello"));
+    QCOMPARE(receiver.nextMessageSize(), 0);
+    QCOMPARE(receiver.receive(), QByteArray(""));
+
+    char buffer[100];
+    QCOMPARE(receiver.receive(buffer, 10), -1);
+    QCOMPARE(receiver.error(), QSharedMemoryChannel::MessageTooLarge);
+    QCOMPARE(receiver.nextMessageSize(), 100);
+    QCOMPARE(receiver.receive(buffer, sizeof buffer), 100);
+    QCOMPARE(QByteArray(buffer, 100), QByteArray(100, 'x'));
+
+    QVERIFY(!receiver.hasPendingMessages());
+    QVERIFY(!receiver.waitForMessage(10));
+}
+
+void tst_QSharedMemoryChannel::wrapAround()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(512));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+
+    for (int i = 0; i < 2000; ++i) {
+        const QByteArray message(i % 97, char('a' + i % 26));
+        QVERIFY2(sender.send(message), qPrintable(sender.errorString()));
+        if (i % 3 == 2) {
+            for (int j = i - 2; j <= i; ++j)
+                QCOMPARE(receiver.receive(), QByteArray(j % 97, char('a' + j % 26)));
+        }
+    }
+    for (int j = 1998; j < 2000; ++j)
+        QCOMPARE(receiver.receive(), QByteArray(j % 97, char('a' + j % 26)));
+    QVERIFY(!receiver.hasPendingMessages());
+}
+
+void tst_QSharedMemoryChannel::full()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(1024));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+
+    const QByteArray message(56, 'm');      // 64 bytes per record
+    for (int i = 0; i < 1024 / 64; ++i)
+        QVERIFY(sender.send(message));
+    QVERIFY(!sender.send(message));
+    QCOMPARE(sender.error(), QSharedMemoryChannel::ChannelFull);
+    QVERIFY(!sender.send(message, 20));
+    QCOMPARE(sender.error(), QSharedMemoryChannel::ChannelFull);
+
+    QCOMPARE(receiver.receive(), message);
+    QVERIFY(sender.send(message));
+}
+
+void tst_QSharedMemoryChannel::messageTooLarge()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(1024));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+
+    QVERIFY(sender.send(QByteArray(512 - 8, 'a')));
+    QVERIFY(!sender.send(QByteArray(512, 'a')));
+    QCOMPARE(sender.error(), QSharedMemoryChannel::MessageTooLarge);
+}
+
+void tst_QSharedMemoryChannel::receiverClosed()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(1024));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+    QVERIFY(sender.send(QByteArray("before")));
+
+    receiver.detach();
+    QVERIFY(!sender.send(QByteArray("after")));
+    QCOMPARE(sender.error(), QSharedMemoryChannel::ChannelClosed);
+
+    QSharedMemoryChannel late(key);
+    QVERIFY(!late.attach());
+    QCOMPARE(late.error(), QSharedMemoryChannel::ChannelClosed);
+}
+
+void tst_QSharedMemoryChannel::corruptedRecord_data()
+{
+    QTest::addColumn<int>("length");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("length-too-short") << 4 << 0;
+    QTest::newRow("length-unaligned") << 20 << 4;
+    QTest::newRow("length-past-ring") << 2048 << 8;
+    QTest::newRow("size-negative") << 16 << -5;
+    QTest::newRow("size-past-length") << 16 << 9;
+    QTest::newRow("padding-before-end") << 16 << -1;
+}
+
+void tst_QSharedMemoryChannel::corruptedRecord()
+{
+    QFETCH(int, length);
+    QFETCH(int, size);
+
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(1024));
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+    QVERIFY(sender.send(QByteArray("first")));
+    QVERIFY(sender.send(QByteArray("second")));
+
+    // overwrite the first record, which follows the 320 byte channel header
+    QSharedMemory memory(key);
+    QVERIFY2(memory.attach(), qPrintable(memory.errorString()));
+    int *record = reinterpret_cast<int *>(static_cast<char *>(memory.data()) + 320);
+    record[0] = length;
+    record[1] = size;
+
+    QCOMPARE(receiver.nextMessageSize(), -1);
+    QCOMPARE(receiver.error(), QSharedMemoryChannel::CorruptedChannel);
+    QVERIFY(!receiver.hasPendingMessages());
+    QVERIFY(receiver.receive().isNull());
+    char buffer[16];
+    QCOMPARE(receiver.receive(buffer, sizeof buffer), -1);
+    QVERIFY(!receiver.waitForMessage(10));
+    QCOMPARE(receiver.error(), QSharedMemoryChannel::CorruptedChannel);
+}
+
+void tst_QSharedMemoryChannel::blockingSend()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(1024));
+
+    const int count = 1000;
+    bool ok = true;
+    FunctionThread thread([this, count, &ok]() {
+        QSharedMemoryChannel sender(key);
+        ok = sender.attach();
+        for (int i = 0; ok && i < count; ++i)
+            ok = sender.send(QByteArray::number(i).leftJustified(100, ' '), -1);
+    });
+    thread.start();
+
+    for (int i = 0; i < count; ++i) {
+        QVERIFY(receiver.waitForMessage(5000));
+        QCOMPARE(receiver.receive(), QByteArray::number(i).leftJustified(100, ' '));
+    }
+    QVERIFY(thread.wait(5000));
+    QVERIFY(ok);
+}
+
+void tst_QSharedMemoryChannel::multipleSenders()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(4096, QSharedMemoryChannel::MultipleSenders));
+
+    const int senderCount = 4;
+    const int count = 20000;
+    QAtomicInt failures;
+    QVector<QThread *> threads;
+    for (int s = 0; s < senderCount; ++s) {
+        threads << new FunctionThread([this, s, count, &failures]() {
+            QSharedMemoryChannel sender(key);
+            if (!sender.attach()) {
+                failures.ref();
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                const int message[2] = { s, i };
+                if (!sender.send(reinterpret_cast<const char *>(message), sizeof message, -1)) {
+                    failures.ref();
+                    return;
+                }
+            }
+        });
+        threads.last()->start();
+    }
+
+    QVector<int> next(senderCount, 0);
+    for (int received = 0; received < senderCount * count; ++received) {
+        QVERIFY(receiver.waitForMessage(5000));
+        int message[2];
+        QCOMPARE(receiver.receive(reinterpret_cast<char *>(message), sizeof message),
+                 int(sizeof message));
+        QVERIFY(message[0] >= 0 && message[0] < senderCount);
+        QCOMPARE(message[1], next[message[0]]);
+        ++next[message[0]];
+    }
+
+    for (QThread *thread : qAsConst(threads))
+        QVERIFY(thread->wait(5000));
+    qDeleteAll(threads);
+    QCOMPARE(failures.load(), 0);
+    QVERIFY(!receiver.hasPendingMessages());
+}
+
+void tst_QSharedMemoryChannel::messageAvailable()
+{
+    QSharedMemoryChannel receiver(key);
+    QVERIFY(receiver.create(4096));
+    QSignalSpy spy(&receiver, &QSharedMemoryChannel::messageAvailable);
+
+    FunctionThread thread([this]() {
+        QSharedMemoryChannel sender(key);
+        if (!sender.attach())
+            return;
+        QThread::msleep(50);
+        sender.send(QByteArray("ping"));
+    });
+    thread.start();
+
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(receiver.receive(), QByteArray("ping"));
+    QVERIFY(thread.wait(5000));
+
+    // not emitted again for nothing
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 1);
+
+    // and emitted again for the next message
+    QSharedMemoryChannel sender(key);
+    QVERIFY(sender.attach());
+    QVERIFY(sender.send(QByteArray("pong")));
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(receiver.receive(), QByteArray("pong"));
+}
+
+QTEST_MAIN(tst_QSharedMemoryChannel)
+#include "tst_qsharedmemorychannel.moc"
@@ -1,5 +1,9 @@
 TEMPLATE = subdirs
+QT_FOR_CONFIG += core-private
 qtHaveModule(concurrent) {
     SUBDIRS = qmimedatabase-xml
-    unix:!darwin:!qnx: SUBDIRS += qmimedatabase-cache
+    unix:!darwin:!qnx {
+        SUBDIRS += qmimedatabase-cache
+        qtConfig(mimetype-cache): SUBDIRS += qmimedatabase-builtin
+    }
 }
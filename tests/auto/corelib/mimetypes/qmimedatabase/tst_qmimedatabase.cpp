@@ -523,6 +523,48 @@ void tst_QMimeDatabase::mimeTypeForFileWithContent()
     QVERIFY(mime.isDefault());
 }
 
+void tst_QMimeDatabase::mimeTypesForFiles()
+{
+    QMimeDatabase db;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.path() + QLatin1Char('/');
+    const auto writeFile = [](const QString &fileName, const QByteArray &contents) {
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+    };
+    QVERIFY(writeFile(path + QLatin1String("doc.pdf"), "%PDF-"));
+    QVERIFY(writeFile(path + QLatin1String("noextension"), "%PDF-"));
+    QVERIFY(writeFile(path + QLatin1String("pdf.txt"), "%PDF-"));
+    QVERIFY(QDir(path).mkdir(QLatin1String("dir")));
+
+    const QStringList fileNames = {
+        path + QLatin1String("doc.pdf"),
+        path + QLatin1String("noextension"),
+        path + QLatin1String("pdf.txt"),
+        path + QLatin1String("dir"),
+        path + QLatin1String("missing.png"),
+        QLatin1String(RESOURCE_PREFIX "test.qml")
+    };
+
+    for (QMimeDatabase::MatchMode mode : { QMimeDatabase::MatchDefault, QMimeDatabase::MatchExtension, QMimeDatabase::MatchContent }) {
+        const QList<QMimeType> mimes = db.mimeTypesForFiles(fileNames, mode);
+        QCOMPARE(mimes.size(), fileNames.size());
+        for (int i = 0; i < fileNames.size(); ++i)
+            QCOMPARE(mimes.at(i).name(), db.mimeTypeForFile(fileNames.at(i), mode).name());
+    }
+
+    const QList<QMimeType> mimes = db.mimeTypesForFiles(fileNames);
+    QCOMPARE(mimes.at(0).name(), QString::fromLatin1("application/pdf"));
+    QCOMPARE(mimes.at(1).name(), QString::fromLatin1("application/pdf"));
+    QCOMPARE(mimes.at(2).name(), QString::fromLatin1("text/plain"));
+    QCOMPARE(mimes.at(3).name(), QString::fromLatin1("inode/directory"));
+    QCOMPARE(mimes.at(4).name(), QString::fromLatin1("image/png"));
+
+    QVERIFY(db.mimeTypesForFiles(QStringList()).isEmpty());
+}
+
 void tst_QMimeDatabase::mimeTypeForUrl()
 {
     QMimeDatabase db;
@@ -57,6 +57,7 @@ private slots:
     void icons();
     void comment();
     void mimeTypeForFileWithContent();
+    void mimeTypesForFiles();
     void mimeTypeForUrl();
     void mimeTypeForData_data();
     void mimeTypeForData();
@@ -0,0 +1,580 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/qcborstream.h>
+
+Q_DECLARE_METATYPE(QCborStreamReader::Error)
+
+class tst_QCborStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decode_data();
+    void decode();
+    void decodeNaN();
+    void decodeIncremental_data();
+    void decodeIncremental();
+    void decodeDevice();
+    void rawStringData();
+    void errors_data();
+    void errors();
+    void encode_data();
+    void encode();
+    void encodeDevice();
+    void variantRoundTrip_data();
+    void variantRoundTrip();
+    void jsonRoundTrip();
+    void toJson_data();
+    void toJson();
+    void writerMisuse();
+};
+
+// the examples from RFC 7049, Appendix A
+static void addExamples()
+{
+    QVariantList oneToTwentyFive;
+    for (int i = 1; i <= 25; ++i)
+        oneToTwentyFive << i;
+    const QVariantList nested = QVariantList() << 1 << QVariant(QVariantList() << 2 << 3)
+                                               << QVariant(QVariantList() << 4 << 5);
+    QVariantMap ab;
+    ab["a"] = 1;
+    ab["b"] = QVariantList() << 2 << 3;
+    QVariantMap bc;
+    bc["b"] = "c";
+    QVariantMap letters;
+    letters["a"] = "A";
+    letters["b"] = "B";
+    letters["c"] = "C";
+    letters["d"] = "D";
+    letters["e"] = "E";
+    QVariantMap numbers;
+    numbers["1"] = 2;
+    numbers["3"] = 4;
+    QVariantMap fun;
+    fun["Fun"] = true;
+    fun["Amt"] = -2;
+
+    QTest::newRow("0") << QByteArray("00") << QVariant(0);
+    QTest::newRow("1") << QByteArray("01") << QVariant(1);
+    QTest::newRow("10") << QByteArray("0a") << QVariant(10);
+    QTest::newRow("23") << QByteArray("17") << QVariant(23);
+    QTest::newRow("24") << QByteArray("1818") << QVariant(24);
+    QTest::newRow("25") << QByteArray("1819") << QVariant(25);
+    QTest::newRow("100") << QByteArray("1864") << QVariant(100);
+    QTest::newRow("1000") << QByteArray("1903e8") << QVariant(1000);
+    QTest::newRow("1000000") << QByteArray("1a000f4240") << QVariant(1000000);
+    QTest::newRow("1000000000000") << QByteArray("1b000000e8d4a51000") << QVariant(Q_INT64_C(1000000000000));
+    QTest::newRow("18446744073709551615") << QByteArray("1bffffffffffffffff") << QVariant(Q_UINT64_C(18446744073709551615));
+    QTest::newRow("-1") << QByteArray("20") << QVariant(-1);
+    QTest::newRow("-10") << QByteArray("29") << QVariant(-10);
+    QTest::newRow("-100") << QByteArray("3863") << QVariant(-100);
+    QTest::newRow("-1000") << QByteArray("3903e7") << QVariant(-1000);
+    QTest::newRow("-18446744073709551616") << QByteArray("3bffffffffffffffff") << QVariant(-18446744073709551616.);
+    QTest::newRow("0.0") << QByteArray("f90000") << QVariant(0.);
+    QTest::newRow("-0.0") << QByteArray("f98000") << QVariant(-0.);
+    QTest::newRow("1.0") << QByteArray("f93c00") << QVariant(1.);
+    QTest::newRow("1.1") << QByteArray("fb3ff199999999999a") << QVariant(1.1);
+    QTest::newRow("1.5") << QByteArray("f93e00") << QVariant(1.5);
+    QTest::newRow("65504.0") << QByteArray("f97bff") << QVariant(65504.);
+    QTest::newRow("100000.0") << QByteArray("fa47c35000") << QVariant(100000.);
+    QTest::newRow("3.4028234663852886e+38") << QByteArray("fa7f7fffff") << QVariant(3.4028234663852886e+38);
+    QTest::newRow("1.0e+300") << QByteArray("fb7e37e43c8800759c") << QVariant(1.0e+300);
+    QTest::newRow("5.960464477539063e-8") << QByteArray("f90001") << QVariant(5.960464477539063e-8);
+    QTest::newRow("0.00006103515625") << QByteArray("f90400") << QVariant(0.00006103515625);
+    QTest::newRow("-4.0") << QByteArray("f9c400") << QVariant(-4.);
+    QTest::newRow("-4.1") << QByteArray("fbc010666666666666") << QVariant(-4.1);
+    QTest::newRow("Infinity") << QByteArray("f97c00") << QVariant(qInf());
+    QTest::newRow("-Infinity") << QByteArray("f9fc00") << QVariant(-qInf());
+    QTest::newRow("Infinity single") << QByteArray("fa7f800000") << QVariant(qInf());
+    QTest::newRow("Infinity double") << QByteArray("fb7ff0000000000000") << QVariant(qInf());
+    QTest::newRow("false") << QByteArray("f4") << QVariant(false);
+    QTest::newRow("true") << QByteArray("f5") << QVariant(true);
+    QTest::newRow("null") << QByteArray("f6") << QVariant::fromValue(nullptr);
+    QTest::newRow("undefined") << QByteArray("f7") << QVariant();
+    QTest::newRow("simple(16)") << QByteArray("f0") << QVariant();
+    QTest::newRow("simple(255)") << QByteArray("f8ff") << QVariant();
+    QTest::newRow("0(\"2013-03-21T20:04:00Z\")")
+            << QByteArray("c074323031332d30332d32315432303a30343a30305a")
+            << QVariant(QDateTime(QDate(2013, 3, 21), QTime(20, 4), Qt::UTC));
+    QTest::newRow("1(1363896240)") << QByteArray("c11a514b67b0")
+            << QVariant(QDateTime(QDate(2013, 3, 21), QTime(20, 4), Qt::UTC));
+    QTest::newRow("1(1363896240.5)") << QByteArray("c1fb41d452d9ec200000")
+            << QVariant(QDateTime(QDate(2013, 3, 21), QTime(20, 4, 0, 500), Qt::UTC));
+    QTest::newRow("23(h'01020304')") << QByteArray("d74401020304") << QVariant(QByteArray("\1\2\3\4"));
+    QTest::newRow("24(h'6449455446')") << QByteArray("d818456449455446") << QVariant(QByteArray("dIETF"));
+    QTest::newRow("32(\"http://www.example.com\")")
+            << QByteArray("d82076687474703a2f2f7777772e6578616d706c652e636f6d")
+            << QVariant(QUrl("http://www.example.com"));
+    QTest::newRow("h''") << QByteArray("40") << QVariant(QByteArray(""));
+    QTest::newRow("h'01020304'") << QByteArray("4401020304") << QVariant(QByteArray("\1\2\3\4"));
+    QTest::newRow("\"\"") << QByteArray("60") << QVariant(QString(""));
+    QTest::newRow("\"a\"") << QByteArray("6161") << QVariant(QString("a"));
+    QTest::newRow("\"IETF\"") << QByteArray("6449455446") << QVariant(QString("IETF"));
+    QTest::newRow("\"\\\"\\\\\"") << QByteArray("62225c") << QVariant(QString("\"\\"));
+    QTest::newRow("\"\\u00fc\"") << QByteArray("62c3bc") << QVariant(QString(QChar(0xfc)));
+    QTest::newRow("\"\\u6c34\"") << QByteArray("63e6b0b4") << QVariant(QString(QChar(0x6c34)));
+    QTest::newRow("\"\\ud800\\udd51\"") << QByteArray("64f0908591") << QVariant(QString::fromUtf8("\xf0\x90\x85\x91"));
+    QTest::newRow("[]") << QByteArray("80") << QVariant(QVariantList());
+    QTest::newRow("[1, 2, 3]") << QByteArray("83010203") << QVariant(QVariantList() << 1 << 2 << 3);
+    QTest::newRow("[1, [2, 3], [4, 5]]") << QByteArray("8301820203820405") << QVariant(nested);
+    QTest::newRow("[1, 2, ..., 25]") << QByteArray("98190102030405060708090a0b0c0d0e0f101112131415161718181819")
+            << QVariant(oneToTwentyFive);
+    QTest::newRow("{}") << QByteArray("a0") << QVariant(QVariantMap());
+    QTest::newRow("{1: 2, 3: 4}") << QByteArray("a201020304") << QVariant(numbers);
+    QTest::newRow("{\"a\": 1, \"b\": [2, 3]}") << QByteArray("a26161016162820203") << QVariant(ab);
+    QTest::newRow("[\"a\", {\"b\": \"c\"}]") << QByteArray("826161a161626163")
+            << QVariant(QVariantList() << "a" << QVariant(bc));
+    QTest::newRow("{\"a\": \"A\", ...}") << QByteArray("a56161614161626142616361436164614461656145")
+            << QVariant(letters);
+    QTest::newRow("(_ h'0102', h'030405')") << QByteArray("5f42010243030405ff")
+            << QVariant(QByteArray("\1\2\3\4\5"));
+    QTest::newRow("(_ \"strea\", \"ming\")") << QByteArray("7f657374726561646d696e67ff")
+            << QVariant(QString("streaming"));
+    QTest::newRow("[_ ]") << QByteArray("9fff") << QVariant(QVariantList());
+    QTest::newRow("[_ 1, [2, 3], [_ 4, 5]]") << QByteArray("9f018202039f0405ffff") << QVariant(nested);
+    QTest::newRow("[_ 1, [2, 3], [4, 5]]") << QByteArray("9f01820203820405ff") << QVariant(nested);
+    QTest::newRow("[1, [2, 3], [_ 4, 5]]") << QByteArray("83018202039f0405ff") << QVariant(nested);
+    QTest::newRow("[1, [_ 2, 3], [4, 5]]") << QByteArray("83019f0203ff820405") << QVariant(nested);
+    QTest::newRow("[_ 1, 2, ..., 25]") << QByteArray("9f0102030405060708090a0b0c0d0e0f101112131415161718181819ff")
+            << QVariant(oneToTwentyFive);
+    QTest::newRow("{_ \"a\": 1, \"b\": [_ 2, 3]}") << QByteArray("bf61610161629f0203ffff") << QVariant(ab);
+    QTest::newRow("[\"a\", {_ \"b\": \"c\"}]") << QByteArray("826161bf61626163ff")
+            << QVariant(QVariantList() << "a" << QVariant(bc));
+    QTest::newRow("{_ \"Fun\": true, \"Amt\": -2}") << QByteArray("bf6346756ef563416d7421ff") << QVariant(fun);
+}
+
+// describes the tokens of the input, one per entry
+static QStringList tokens(QCborStreamReader &reader, bool *complete)
+{
+    QStringList result;
+    for (;;) {
+        const QCborStreamReader::TokenType type = reader.readNext();
+        QString token = QString::number(type);
+        switch (type) {
+        case QCborStreamReader::NoToken:
+            *complete = true;
+            return result;
+        case QCborStreamReader::Invalid:
+            *complete = false;
+            return result;
+        case QCborStreamReader::UnsignedInteger:
+        case QCborStreamReader::NegativeInteger:
+            token += QLatin1Char(':') + QString::number(reader.toUnsignedInteger());
+            break;
+        case QCborStreamReader::ByteString:
+            token += QLatin1Char(':') + QString::fromLatin1(reader.byteArray().toHex());
+            break;
+        case QCborStreamReader::TextString:
+            token += QLatin1Char(':') + reader.text();
+            break;
+        case QCborStreamReader::StartArray:
+        case QCborStreamReader::StartMap:
+            if (reader.isLengthKnown())
+                token += QLatin1Char(':') + QString::number(reader.length());
+            break;
+        case QCborStreamReader::Tag:
+            token += QLatin1Char(':') + QString::number(reader.tag());
+            break;
+        case QCborStreamReader::SimpleType:
+            token += QLatin1Char(':') + QString::number(reader.simpleType());
+            break;
+        case QCborStreamReader::Bool:
+            token += QLatin1Char(':') + QString::number(reader.toBool());
+            break;
+        case QCborStreamReader::Double:
+            token += QLatin1Char(':') + QString::number(reader.toDouble(), 'g', 17);
+            break;
+        default:
+            break;
+        }
+        token += QLatin1Char('@') + QString::number(reader.depth());
+        result << token;
+    }
+}
+
+void tst_QCborStream::decode_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QVariant>("expected");
+    addExamples();
+}
+
+void tst_QCborStream::decode()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QVariant, expected);
+
+    QCborStreamReader reader(QByteArray::fromHex(data));
+    reader.readNext();
+    QVERIFY(!reader.hasError());
+    const QVariant value = reader.readCurrentVariant();
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QCOMPARE(value, expected);
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+    QCOMPARE(reader.depth(), 0);
+    QCOMPARE(reader.offset(), qint64(data.size() / 2));
+}
+
+void tst_QCborStream::decodeNaN()
+{
+    const char *encodings[] = { "f97e00", "fa7fc00000", "fb7ff8000000000000" };
+    for (const char *encoding : encodings) {
+        QCborStreamReader reader(QByteArray::fromHex(encoding));
+        QCOMPARE(reader.readNext(), QCborStreamReader::Double);
+        QVERIFY(qIsNaN(reader.toDouble()));
+    }
+}
+
+void tst_QCborStream::decodeIncremental_data()
+{
+    decode_data();
+}
+
+void tst_QCborStream::decodeIncremental()
+{
+    QFETCH(QByteArray, data);
+
+    // the same data twice, to test the transition between two items
+    const QByteArray bytes = QByteArray::fromHex(data + data);
+    QCborStreamReader reader(bytes);
+    bool complete = false;
+    const QStringList expected = tokens(reader, &complete);
+    QVERIFY(complete);
+
+    QCborStreamReader incremental;
+    QStringList result;
+    for (int i = 0; i < bytes.size(); ++i) {
+        incremental.addData(bytes.mid(i, 1));
+        result += tokens(incremental, &complete);
+        if (!complete)
+            QCOMPARE(incremental.error(), QCborStreamReader::UnexpectedEndOfData);
+    }
+    QVERIFY(complete);
+    QCOMPARE(result, expected);
+    QCOMPARE(incremental.offset(), qint64(bytes.size()));
+}
+
+void tst_QCborStream::decodeDevice()
+{
+    // strings larger than the reader's buffer, in one piece and in chunks
+    const QByteArray bytes(100000, 'x');
+    QByteArray data;
+    {
+        QCborStreamWriter writer(&data);
+        writer.writeStartArray();
+        writer.writeByteString(bytes);
+        writer.writeInteger(-5);
+        writer.writeEndArray();
+    }
+    // (_ "xxx...", "\u00fc")
+    data += QByteArray::fromHex("7f7a000186a0") + bytes + QByteArray::fromHex("62c3bcff");
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QCborStreamReader reader(&buffer);
+    QCOMPARE(reader.readNext(), QCborStreamReader::StartArray);
+    QVERIFY(!reader.isLengthKnown());
+    QCOMPARE(reader.readNext(), QCborStreamReader::ByteString);
+    QCOMPARE(reader.length(), quint64(bytes.size()));
+    QCOMPARE(reader.byteArray(), bytes);
+    QCOMPARE(reader.readNext(), QCborStreamReader::NegativeInteger);
+    QCOMPARE(reader.toInteger(), qint64(-5));
+    QCOMPARE(reader.readNext(), QCborStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QCborStreamReader::TextString);
+    QCOMPARE(reader.text(), QString::fromLatin1(bytes) + QChar(0xfc));
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+    QCOMPARE(reader.offset(), qint64(data.size()));
+}
+
+void tst_QCborStream::rawStringData()
+{
+    const QByteArray data = QByteArray::fromHex("826449455446426162");
+    QCborStreamReader reader(data);
+    QCOMPARE(reader.readNext(), QCborStreamReader::StartArray);
+    QCOMPARE(reader.readNext(), QCborStreamReader::TextString);
+    QByteArray raw = reader.rawStringData();
+    QCOMPARE(raw, QByteArray("IETF"));
+    // no copy of the input
+    QCOMPARE(raw.constData(), data.constData() + 2);
+    QCOMPARE(reader.readNext(), QCborStreamReader::ByteString);
+    raw = reader.rawStringData();
+    QCOMPARE(raw, QByteArray("ab"));
+    QCOMPARE(raw.constData(), data.constData() + 7);
+    QCOMPARE(reader.text(), QString());
+}
+
+void tst_QCborStream::errors_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QCborStreamReader::Error>("error");
+
+    QTest::newRow("reserved-28") << QByteArray("1c") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("reserved-30") << QByteArray("5e") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("indefinite-integer") << QByteArray("1f") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("indefinite-tag") << QByteArray("df") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("nested-indefinite-string") << QByteArray("5f5f4100ffff") << QCborStreamReader::IllegalNumber;
+    QTest::newRow("chunk-type") << QByteArray("5f6161ff") << QCborStreamReader::IllegalType;
+    QTest::newRow("simple-type") << QByteArray("f801") << QCborStreamReader::IllegalSimpleType;
+    QTest::newRow("break") << QByteArray("ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break-definite") << QByteArray("81ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break-after-tag") << QByteArray("9fc1ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("break-after-key") << QByteArray("bf6161ff") << QCborStreamReader::UnexpectedBreak;
+    QTest::newRow("utf8-invalid") << QByteArray("62c328") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("utf8-truncated") << QByteArray("7f61c361bcff") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("utf8-surrogate") << QByteArray("63eda080") << QCborStreamReader::InvalidUtf8String;
+    QTest::newRow("string-too-large") << QByteArray("5bffffffffffffffff") << QCborStreamReader::DataTooLarge;
+    QTest::newRow("map-too-large") << QByteArray("bbffffffffffffffff") << QCborStreamReader::DataTooLarge;
+    QTest::newRow("eod-integer") << QByteArray("19ff") << QCborStreamReader::UnexpectedEndOfData;
+    QTest::newRow("eod-string") << QByteArray("6261") << QCborStreamReader::UnexpectedEndOfData;
+    QTest::newRow("eod-chunked-string") << QByteArray("5f41") << QCborStreamReader::UnexpectedEndOfData;
+    QTest::newRow("eod-array") << QByteArray("8201") << QCborStreamReader::UnexpectedEndOfData;
+    QTest::newRow("eod-tag") << QByteArray("c1") << QCborStreamReader::UnexpectedEndOfData;
+    QTest::newRow("nesting") << QByteArray(1025 * 2, '8').replace("88", "81") << QCborStreamReader::NestingTooDeep;
+}
+
+void tst_QCborStream::errors()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QCborStreamReader::Error, error);
+
+    QCborStreamReader reader(QByteArray::fromHex(data));
+    while (reader.readNext() != QCborStreamReader::Invalid)
+        QVERIFY(!reader.atEnd());
+    QVERIFY(reader.atEnd());
+    QCOMPARE(reader.error(), error);
+    QVERIFY(reader.hasError());
+    QVERIFY(!reader.errorString().isEmpty());
+    if (error != QCborStreamReader::UnexpectedEndOfData)
+        QCOMPARE(reader.readNext(), QCborStreamReader::Invalid);
+}
+
+void tst_QCborStream::encode_data()
+{
+    QTest::addColumn<QVariant>("value");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("0") << QVariant(0) << QByteArray("00");
+    QTest::newRow("23") << QVariant(23) << QByteArray("17");
+    QTest::newRow("24") << QVariant(24) << QByteArray("1818");
+    QTest::newRow("1000") << QVariant(1000) << QByteArray("1903e8");
+    QTest::newRow("1000000") << QVariant(1000000) << QByteArray("1a000f4240");
+    QTest::newRow("1000000000000") << QVariant(Q_INT64_C(1000000000000)) << QByteArray("1b000000e8d4a51000");
+    QTest::newRow("18446744073709551615") << QVariant(Q_UINT64_C(18446744073709551615)) << QByteArray("1bffffffffffffffff");
+    QTest::newRow("-1") << QVariant(-1) << QByteArray("20");
+    QTest::newRow("-1000") << QVariant(-1000) << QByteArray("3903e7");
+    QTest::newRow("min") << QVariant(std::numeric_limits<qint64>::min()) << QByteArray("3b7fffffffffffffff");
+    QTest::newRow("1.5") << QVariant(1.5) << QByteArray("fa3fc00000");
+    QTest::newRow("1.1") << QVariant(1.1) << QByteArray("fb3ff199999999999a");
+    QTest::newRow("float") << QVariant(1.5f) << QByteArray("fa3fc00000");
+    QTest::newRow("float max") << QVariant(double(std::numeric_limits<float>::max())) << QByteArray("fa7f7fffff");
+    QTest::newRow("1e300") << QVariant(1e300) << QByteArray("fb7e37e43c8800759c");
+    QTest::newRow("-1e300") << QVariant(-1e300) << QByteArray("fbfe37e43c8800759c");
+    QTest::newRow("Infinity") << QVariant(qInf()) << QByteArray("f97c00");
+    QTest::newRow("-Infinity") << QVariant(-qInf()) << QByteArray("f9fc00");
+    QTest::newRow("NaN") << QVariant(qQNaN()) << QByteArray("f97e00");
+    QTest::newRow("false") << QVariant(false) << QByteArray("f4");
+    QTest::newRow("true") << QVariant(true) << QByteArray("f5");
+    QTest::newRow("null") << QVariant::fromValue(nullptr) << QByteArray("f6");
+    QTest::newRow("undefined") << QVariant() << QByteArray("f7");
+    QTest::newRow("bytes") << QVariant(QByteArray("\1\2\3\4")) << QByteArray("4401020304");
+    QTest::newRow("text") << QVariant(QString("IETF")) << QByteArray("6449455446");
+    QTest::newRow("text-unicode") << QVariant(QString(QChar(0x6c34))) << QByteArray("63e6b0b4");
+    QTest::newRow("list") << QVariant(QVariantList() << 1 << QVariant(QVariantList() << 2 << 3))
+                          << QByteArray("8201820203");
+    QTest::newRow("stringlist") << QVariant(QStringList() << "a" << "b") << QByteArray("8261616162");
+    QVariantMap map;
+    map["a"] = 1;
+    map["b"] = QVariantList() << 2 << 3;
+    QTest::newRow("map") << QVariant(map) << QByteArray("a26161016162820203");
+    QTest::newRow("datetime") << QVariant(QDateTime(QDate(2013, 3, 21), QTime(20, 4), Qt::UTC))
+                              << QByteArray("c07818323031332d30332d32315432303a30343a30302e3030305a");
+    QTest::newRow("url") << QVariant(QUrl("http://www.example.com"))
+                         << QByteArray("d82076687474703a2f2f7777772e6578616d706c652e636f6d");
+    QTest::newRow("uuid") << QVariant(QUuid("{67c8770b-44f1-410a-ab9a-f9b5446f13ee}"))
+                          << QByteArray("d8255067c8770b44f1410aab9af9b5446f13ee");
+    QTest::newRow("json") << QVariant(QJsonValue(QJsonArray{ 1, 1.5, "a" })) << QByteArray("8301fa3fc000006161");
+}
+
+void tst_QCborStream::encode()
+{
+    QFETCH(QVariant, value);
+    QFETCH(QByteArray, expected);
+
+    QByteArray data;
+    {
+        QCborStreamWriter writer(&data);
+        writer.writeVariant(value);
+        QCOMPARE(writer.depth(), 0);
+    }
+    QCOMPARE(data.toHex(), expected);
+}
+
+void tst_QCborStream::encodeDevice()
+{
+    const QByteArray bytes(100000, 'x');
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QCborStreamWriter writer(&buffer);
+        writer.writeStartMap();
+        for (int i = 0; i < 10000; ++i) {
+            writer.writeInteger(i);
+            writer.writeTextString(QString::number(i));
+        }
+        writer.writeTextString("bytes", 5);
+        writer.writeByteString(bytes);
+        writer.writeEndMap();
+        QVERIFY(!writer.hasError());
+    }
+
+    QCborStreamReader reader(buffer.data());
+    QCOMPARE(reader.readNext(), QCborStreamReader::StartMap);
+    for (int i = 0; i < 10000; ++i) {
+        QCOMPARE(reader.readNext(), QCborStreamReader::UnsignedInteger);
+        QCOMPARE(reader.toInteger(), qint64(i));
+        QCOMPARE(reader.readNext(), QCborStreamReader::TextString);
+        QCOMPARE(reader.text(), QString::number(i));
+    }
+    QCOMPARE(reader.readNext(), QCborStreamReader::TextString);
+    QCOMPARE(reader.readNext(), QCborStreamReader::ByteString);
+    QCOMPARE(reader.byteArray(), bytes);
+    QCOMPARE(reader.readNext(), QCborStreamReader::EndMap);
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+}
+
+void tst_QCborStream::variantRoundTrip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QVariant>("expected");
+    addExamples();
+}
+
+void tst_QCborStream::variantRoundTrip()
+{
+    QFETCH(QVariant, expected);
+
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    writer.writeVariant(expected);
+    QCborStreamReader reader(data);
+    reader.readNext();
+    QCOMPARE(reader.readCurrentVariant(), expected);
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+}
+
+void tst_QCborStream::jsonRoundTrip()
+{
+    const QJsonDocument document = QJsonDocument::fromJson(
+        "{ \"name\": \"Bj\\u00f6rn\", \"id\": 12, \"large\": 1e100, \"negative\": -3.25,"
+        "  \"flags\": [ true, false, null ], \"empty\": {}, \"nested\": { \"list\": [ [], [ 1, 2 ] ] } }");
+    QVERIFY(document.isObject());
+
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    writer.writeJsonValue(document.object());
+    QVERIFY(data.size() < document.toJson(QJsonDocument::Compact).size());
+
+    QCborStreamReader reader(data);
+    QCOMPARE(reader.readNext(), QCborStreamReader::StartMap);
+    QCOMPARE(reader.readCurrentJsonValue(), QJsonValue(document.object()));
+    QCOMPARE(reader.readNext(), QCborStreamReader::NoToken);
+}
+
+void tst_QCborStream::toJson_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("integers") << QByteArray("8301203903e7") << QByteArray("[1,-1,-1000]");
+    QTest::newRow("bytes") << QByteArray("43fbff00") << QByteArray("[\"-_8A\"]");
+    QTest::newRow("bytes-base64") << QByteArray("d643fbff00") << QByteArray("[\"+/8A\"]");
+    QTest::newRow("bytes-base16") << QByteArray("d743fbff00") << QByteArray("[\"fbff00\"]");
+    QTest::newRow("bytes-in-array") << QByteArray("d78243fbff0041ff") << QByteArray("[\"fbff00\",\"ff\"]");
+    QTest::newRow("other-tag") << QByteArray("c11864") << QByteArray("[100]");
+    QTest::newRow("simple") << QByteArray("84f6f7f0f8ff") << QByteArray("[null,null,null,null]");
+    QTest::newRow("keys") << QByteArray("a4016161f5616220616381016164")
+                          << QByteArray("{\"-1\":\"c\",\"1\":\"a\",\"[1]\":\"d\",\"true\":\"b\"}");
+}
+
+void tst_QCborStream::toJson()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QByteArray, expected);
+
+    QCborStreamReader reader(QByteArray::fromHex(data));
+    reader.readNext();
+    QJsonValue value = reader.readCurrentJsonValue();
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    QJsonDocument document = value.isObject() ? QJsonDocument(value.toObject())
+                                              : QJsonDocument(value.isArray() ? value.toArray() : QJsonArray{ value });
+    QCOMPARE(document.toJson(QJsonDocument::Compact), expected);
+}
+
+void tst_QCborStream::writerMisuse()
+{
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+
+    QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::writeEndArray: Not inside an array");
+    writer.writeEndArray();
+    QVERIFY(data.isEmpty());
+
+    writer.writeStartArray(1);
+    writer.writeNull();
+    QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::writeNull: Too many items in the array");
+    writer.writeNull();
+    writer.writeEndArray();
+
+    writer.writeStartMap(1);
+    writer.writeTextString(QStringLiteral("key"));
+    QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::writeEndMap: 1 items missing");
+    writer.writeEndMap();
+    writer.writeBool(true);
+    writer.writeEndMap();
+
+    writer.writeStartMap();
+    writer.writeTextString(QStringLiteral("key"));
+    QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::writeEndMap: No value written for the last key");
+    writer.writeEndMap();
+    writer.writeSimpleType(32);
+    writer.writeEndMap();
+    QTest::ignoreMessage(QtWarningMsg, "QCborStreamWriter::writeSimpleType: Reserved simple type 22");
+    writer.writeSimpleType(22);
+    QCOMPARE(writer.depth(), 0);
+
+    QCOMPARE(data.toHex(), QByteArray("81f6a1636b6579f5bf636b6579f820ff"));
+}
+
+QTEST_MAIN(tst_QCborStream)
+#include "tst_qcborstream.moc"
@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+SUBDIRS = \
+    qcborstream
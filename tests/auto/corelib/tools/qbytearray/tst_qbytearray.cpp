@@ -1642,6 +1642,9 @@ void tst_QByteArray::fromPercentEncoding_data()
     QTest::newRow("HTTPUrlEncoded") << QByteArray("http://qt-project%20org") << QByteArray("http://qt-project org");
     QTest::newRow("EmptyString") << QByteArray("") << QByteArray("");
     QTest::newRow("Task27166") << QByteArray("Fran%C3%A7aise") << QByteArray("Française");
+    QTest::newRow("LongRuns") << QByteArray("a-long-run-without-any-escapes%2Fand%20another-long-run-to-the-end")
+                              << QByteArray("a-long-run-without-any-escapes/and another-long-run-to-the-end");
+    QTest::newRow("TrailingPercent") << QByteArray("0123456789abcdefgh%2") << QByteArray("0123456789abcdefgh%2");
 }
 
 void tst_QByteArray::fromPercentEncoding()
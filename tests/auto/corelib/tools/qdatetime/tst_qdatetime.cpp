@@ -117,6 +117,8 @@ private slots:
     void currentDateTimeUtc2();
     void fromStringDateFormat_data();
     void fromStringDateFormat();
+    void fromStringLatin1_data();
+    void fromStringLatin1();
     void fromStringStringFormat_data();
     void fromStringStringFormat();
     void fromStringStringFormatLocale_data();
@@ -2100,6 +2102,16 @@ void tst_QDateTime::toString_strformat()
     QCOMPARE(testDate.toString("yyyy-MM-dd"), QString("2013-01-01"));
     QCOMPARE(testTime.toString("hh:mm:ss"), QString("01:02:03"));
     QCOMPARE(testDateTime.toString("yyyy-MM-dd hh:mm:ss t"), QString("2013-01-01 01:02:03 UTC"));
+
+    // Numeric formats, repeated so that the compiled form gets reused
+    const QDateTime msecDateTime(QDate(2013, 1, 9), QTime(1, 2, 3, 50), Qt::UTC);
+    for (int i = 0; i < 2; ++i) {
+        QCOMPARE(msecDateTime.toString("d.M.yy h:m:s.z"), QString("9.1.13 1:2:3.05"));
+        QCOMPARE(msecDateTime.toString("yyyy-MM-dd'T'HH:mm:ss.zzz"), QString("2013-01-09T01:02:03.050"));
+        QCOMPARE(msecDateTime.toString("yyy''y"), QString("13y'y"));
+        QCOMPARE(msecDateTime.date().toString("yyyy-MM-dd hh"), QString("2013-01-09 hh"));
+        QCOMPARE(msecDateTime.time().toString("yyyy hh:mm"), QString("yyyy 01:02"));
+    }
 }
 
 void tst_QDateTime::fromStringDateFormat_data()
@@ -2252,6 +2264,21 @@ void tst_QDateTime::fromStringDateFormat_data()
         << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 0), Qt::LocalTime);
     QTest::newRow("ISO no fract specified") << QString::fromLatin1("2012-01-01T08:00:00.")
         << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 0), Qt::LocalTime);
+    // RFC 3339 variants
+    QTest::newRow("RFC 3339 space separator") << QString::fromLatin1("2012-01-01 08:00:00.25Z")
+        << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 250), Qt::UTC);
+    QTest::newRow("RFC 3339 lower case") << QString::fromLatin1("2012-01-01t08:00:00z")
+        << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 0), Qt::UTC);
+    QTest::newRow("RFC 3339 microseconds") << QString::fromLatin1("2012-01-01T08:00:00.123456-05:30")
+        << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(13, 30, 0, 123), Qt::UTC);
+    QTest::newRow("RFC 3339 minus zero offset") << QString::fromLatin1("2012-01-01T08:00:00-00:00")
+        << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 0), Qt::UTC);
+    QTest::newRow("RFC 3339 end of day") << QString::fromLatin1("2012-12-31T24:00:00Z")
+        << Qt::ISODate << QDateTime(QDate(2013, 1, 1), QTime(0, 0, 0, 0), Qt::UTC);
+    QTest::newRow("RFC 3339 bad offset minutes") << QString::fromLatin1("2012-01-01T08:00:00+01:60")
+        << Qt::ISODate << invalidDateTime();
+    QTest::newRow("RFC 3339 bad day") << QString::fromLatin1("2012-02-30T08:00:00Z")
+        << Qt::ISODate << invalidDateTime();
     // Test invalid characters (should ignore invalid characters at end of string).
     QTest::newRow("ISO invalid character at end") << QString::fromLatin1("2012-01-01T08:00:00!")
         << Qt::ISODate << QDateTime(QDate(2012, 1, 1), QTime(8, 0, 0, 0), Qt::LocalTime);
@@ -2362,6 +2389,23 @@ void tst_QDateTime::fromStringDateFormat()
     QCOMPARE(dateTime, expected);
 }
 
+void tst_QDateTime::fromStringLatin1_data()
+{
+    fromStringDateFormat_data();
+}
+
+void tst_QDateTime::fromStringLatin1()
+{
+    QFETCH(QString, dateTimeStr);
+    QFETCH(Qt::DateFormat, dateFormat);
+    QFETCH(QDateTime, expected);
+
+    const QByteArray latin1 = dateTimeStr.toLatin1();
+    QDateTime dateTime = QDateTime::fromString(QLatin1String(latin1.constData(), latin1.size()),
+                                               dateFormat);
+    QCOMPARE(dateTime, expected);
+}
+
 void tst_QDateTime::fromStringStringFormat_data()
 {
     QTest::addColumn<QString>("string");
@@ -2389,6 +2433,25 @@ void tst_QDateTime::fromStringStringFormat_data()
     QTest::newRow("data16") << QString("2005-06-28T07:57:30.001Z")
                             << QString("yyyy-MM-ddThh:mm:ss.zZ")
                             << QDateTime(QDate(2005, 06, 28), QTime(07, 57, 30, 1));
+    // fixed-width numeric formats
+    QTest::newRow("numeric") << QString("2017-07-24 15:46:29.739")
+                             << QString("yyyy-MM-dd hh:mm:ss.zzz")
+                             << QDateTime(QDate(2017, 7, 24), QTime(15, 46, 29, 739));
+    QTest::newRow("numeric short field") << QString("24.7.2017")
+                                         << QString("dd.MM.yyyy")
+                                         << QDateTime(QDate(2017, 7, 24), QTime());
+    QTest::newRow("numeric bad day") << QString("2017-02-30 15:46:29.739")
+                                     << QString("yyyy-MM-dd hh:mm:ss.zzz") << invalidDateTime();
+    QTest::newRow("numeric after 7999") << QString("8000-01-01 00:00:00.000")
+                                        << QString("yyyy-MM-dd hh:mm:ss.zzz") << invalidDateTime();
+    QTest::newRow("numeric trailing") << QString("2017-07-24 15:46:29.739 ")
+                                      << QString("yyyy-MM-dd hh:mm:ss.zzz") << invalidDateTime();
+    QTest::newRow("numeric two-digit year") << QString("24.07.17")
+                                            << QString("dd.MM.yy")
+                                            << QDateTime(QDate(1917, 7, 24), QTime());
+    QTest::newRow("numeric time only") << QString("154629")
+                                       << QString("HHmmss")
+                                       << QDateTime(QDate(1900, 1, 1), QTime(15, 46, 29));
 }
 
 void tst_QDateTime::fromStringStringFormat()
@@ -47,6 +47,7 @@ private slots:
     void availableTimeZoneIds();
     void transitionEachZone_data();
     void transitionEachZone();
+    void transitionsFromRule();
     void stressTest();
     void windowsId();
     void isValidId_data();
@@ -436,6 +437,42 @@ void tst_QTimeZone::transitionEachZone()
     }
 }
 
+void tst_QTimeZone::transitionsFromRule()
+{
+    // Transitions past those listed explicitly come from a rule; check they are
+    // the same whether or not a lookup in the same year came first, and on
+    // either side of 2038.
+    const QTimeZone berlin("Europe/Berlin");
+    if (!berlin.isValid() || !berlin.hasTransitions())
+        QSKIP("Time zone data for Europe/Berlin not available");
+
+    for (int year = 2030; year <= 2045; ++year) {
+        const QTimeZone zone("Europe/Berlin");
+        const QDateTime summer(QDate(year, 7, 1), QTime(12, 0), Qt::UTC);
+        const QDateTime winter(QDate(year, 1, 1), QTime(12, 0), Qt::UTC);
+        if (year % 2)
+            QCOMPARE(zone.offsetFromUtc(summer), 7200);
+        QCOMPARE(zone.offsetFromUtc(winter), 3600);
+        QCOMPARE(berlin.offsetFromUtc(summer), 7200);
+
+        // last Sundays of March and October, at 01:00 UTC
+        QDate march(year, 3, 31);
+        march = march.addDays(-(march.dayOfWeek() % 7));
+        QDate october(year, 10, 31);
+        october = october.addDays(-(october.dayOfWeek() % 7));
+
+        QTimeZone::OffsetData tran = zone.nextTransition(winter);
+        QCOMPARE(tran.atUtc, QDateTime(march, QTime(1, 0), Qt::UTC));
+        QCOMPARE(tran.offsetFromUtc, 7200);
+        tran = zone.nextTransition(tran.atUtc);
+        QCOMPARE(tran.atUtc, QDateTime(october, QTime(1, 0), Qt::UTC));
+        QCOMPARE(tran.offsetFromUtc, 3600);
+        tran = berlin.previousTransition(tran.atUtc);
+        QCOMPARE(tran.atUtc, QDateTime(march, QTime(1, 0), Qt::UTC));
+        QCOMPARE(tran.daylightTimeOffset, 3600);
+    }
+}
+
 void tst_QTimeZone::availableTimeZoneIds()
 {
     if (debug) {
@@ -867,25 +904,25 @@ void tst_QTimeZone::tzTest()
     QCOMPARE(dat.daylightTimeOffset, 3600);
 
     dat = tzp.previousTransition(stdHi);
-    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4096659600000);
+    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4096573200000);
     QCOMPARE(dat.offsetFromUtc, 3600);
     QCOMPARE(dat.standardTimeOffset, 3600);
     QCOMPARE(dat.daylightTimeOffset, 0);
 
     dat = tzp.previousTransition(dstHi);
-    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4109965200000);
+    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4109878800000);
     QCOMPARE(dat.offsetFromUtc, 7200);
     QCOMPARE(dat.standardTimeOffset, 3600);
     QCOMPARE(dat.daylightTimeOffset, 3600);
 
     dat = tzp.nextTransition(stdHi);
-    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4109965200000);
+    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4109878800000);
     QCOMPARE(dat.offsetFromUtc, 7200);
     QCOMPARE(dat.standardTimeOffset, 3600);
     QCOMPARE(dat.daylightTimeOffset, 3600);
 
     dat = tzp.nextTransition(dstHi);
-    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4128109200000);
+    QCOMPARE(dat.atMSecsSinceEpoch, (qint64)4128627600000);
     QCOMPARE(dat.offsetFromUtc, 3600);
     QCOMPARE(dat.standardTimeOffset, 3600);
     QCOMPARE(dat.daylightTimeOffset, 0);
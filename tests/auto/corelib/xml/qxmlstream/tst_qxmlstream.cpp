@@ -576,6 +576,10 @@ private slots:
     void invalidStringCharacters_data() const;
     void invalidStringCharacters() const;
     void hasError() const;
+    void utf8AcrossChunks() const;
+    void textAcrossChunks() const;
+    void predefinedEntities() const;
+    void nameInterning() const;
 
 private:
     static QByteArray readFile(const QString &filename);
@@ -1695,5 +1699,157 @@ void tst_QXmlStream::invalidStringCharacters_data() const
     //
 }
 
+void tst_QXmlStream::utf8AcrossChunks() const
+{
+    const QString text = QString::fromUtf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 na\xc3\xafve");
+    const QByteArray xml = "<a b=\"" + text.toUtf8() + "\">" + text.toUtf8() + "</a>";
+
+    // every multi-byte sequence is split at every position
+    QXmlStreamReader reader;
+    for (int i = 0; i < xml.size(); ++i)
+        reader.addData(xml.mid(i, 1));
+    QCOMPARE(reader.readNext(), QXmlStreamReader::StartDocument);
+    QCOMPARE(reader.readNext(), QXmlStreamReader::StartElement);
+    QCOMPARE(reader.attributes().value(QLatin1String("b")).toString(), text);
+    QString characters;
+    while (reader.readNext() == QXmlStreamReader::Characters)
+        characters += reader.text();
+    QCOMPARE(characters, text);
+    QCOMPARE(reader.tokenType(), QXmlStreamReader::EndElement);
+    QVERIFY(!reader.hasError());
+
+    // the byte order mark is skipped
+    QXmlStreamReader withBom("\xef\xbb\xbf<a/>");
+    QCOMPARE(withBom.readNext(), QXmlStreamReader::StartDocument);
+    QCOMPARE(withBom.readNext(), QXmlStreamReader::StartElement);
+    QCOMPARE(withBom.name().toString(), QString("a"));
+
+    // invalid sequences are errors, also when they arrive later
+    QXmlStreamReader invalid("<a>x\xff\xfey</a>");
+    while (!invalid.atEnd())
+        invalid.readNext();
+    QCOMPARE(invalid.error(), QXmlStreamReader::NotWellFormedError);
+
+    QXmlStreamReader invalidLater;
+    invalidLater.addData("<a>x");
+    QCOMPARE(invalidLater.readNext(), QXmlStreamReader::StartDocument);
+    QCOMPARE(invalidLater.readNext(), QXmlStreamReader::StartElement);
+    invalidLater.addData("\xc3y</a>");
+    while (!invalidLater.atEnd())
+        invalidLater.readNext();
+    QCOMPARE(invalidLater.error(), QXmlStreamReader::NotWellFormedError);
+}
+
+void tst_QXmlStream::textAcrossChunks() const
+{
+    // longer than the read buffer, with whitespace, line breaks and
+    // brackets that the reader has to look at
+    QByteArray line("plain text with spaces and a ] bracket\tand a tab ]] twice\n");
+    QByteArray text;
+    while (text.size() < 20000)
+        text += line;
+    const QByteArray xml = "<a attr=\"" + text + "\">" + text + "</a>";
+
+    QBuffer buffer;
+    buffer.setData(xml);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QXmlStreamReader reader(&buffer);
+    QVERIFY(reader.readNextStartElement());
+    // attribute values are normalized
+    QString attribute = QString::fromLatin1(text);
+    attribute.replace(QLatin1Char('\t'), QLatin1Char(' '));
+    attribute.replace(QLatin1Char('\n'), QLatin1Char(' '));
+    QCOMPARE(reader.attributes().value(QLatin1String("attr")).toString(), attribute);
+    QString characters;
+    while (reader.readNext() == QXmlStreamReader::Characters) {
+        QVERIFY(!reader.isWhitespace());
+        characters += reader.text();
+    }
+    QCOMPARE(characters, QString::fromLatin1(text));
+    QCOMPARE(reader.tokenType(), QXmlStreamReader::EndElement);
+    QCOMPARE(reader.lineNumber(), qint64(xml.count('\n') + 1));
+
+    QXmlStreamReader whitespace("<a> \t\n </a>");
+    QVERIFY(whitespace.readNextStartElement());
+    QCOMPARE(whitespace.readNext(), QXmlStreamReader::Characters);
+    QVERIFY(whitespace.isWhitespace());
+
+    QXmlStreamReader invalid("<a>text ]]> text</a>");
+    while (!invalid.atEnd())
+        invalid.readNext();
+    QCOMPARE(invalid.error(), QXmlStreamReader::NotWellFormedError);
+}
+
+void tst_QXmlStream::predefinedEntities() const
+{
+    QXmlStreamReader reader("<!DOCTYPE a [<!ENTITY e \"&lt;value&gt;\">]>"
+                            "<a b=\"&lt;&gt;&amp;&apos;&quot;&e;\">&lt;&gt;&amp;&apos;&quot;&e;</a>");
+    QVERIFY(reader.readNextStartElement());
+    QCOMPARE(reader.attributes().value(QLatin1String("b")).toString(), QString("<>&'\"<value>"));
+    QString characters;
+    while (reader.readNext() == QXmlStreamReader::Characters)
+        characters += reader.text();
+    QCOMPARE(characters, QString("<>&'\"<value>"));
+    QVERIFY(!reader.hasError());
+
+    QXmlStreamReader undeclared("<a>&lt;&lx;</a>");
+    while (!undeclared.atEnd())
+        undeclared.readNext();
+    QCOMPARE(undeclared.error(), QXmlStreamReader::NotWellFormedError);
+}
+
+void tst_QXmlStream::nameInterning() const
+{
+    const QString xml("<root xmlns:p=\"urn:p\"><item id=\"1\" p:id=\"2\"/>"
+                      "<p:item id=\"3\"><item id=\"4\"/></p:item></root>");
+    QXmlStreamReader reader(xml);
+    QVERIFY(!reader.nameInterning());
+    reader.setNameInterning(true);
+    QVERIFY(reader.nameInterning());
+
+    const QStringRef item = reader.internedName(QStringLiteral("item"));
+    QCOMPARE(item.toString(), QString("item"));
+    QCOMPARE(reader.internedName(QString("item")).unicode(), item.unicode());
+    const QStringRef id = reader.internedName(QStringLiteral("id"));
+
+    QStringList names;
+    int itemCount = 0;
+    int idCount = 0;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            names << reader.qualifiedName().toString();
+            if (reader.name().unicode() == item.unicode())
+                ++itemCount;
+            const QXmlStreamAttributes attributes = reader.attributes();
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                if (attribute.name().unicode() == id.unicode()) {
+                    QCOMPARE(attribute.name().toString(), QString("id"));
+                    ++idCount;
+                }
+            }
+        } else if (reader.isEndElement()) {
+            names << QLatin1Char('/') + reader.qualifiedName().toString();
+            if (reader.name().unicode() == item.unicode())
+                QCOMPARE(reader.name().toString(), QString("item"));
+        }
+    }
+    QVERIFY(!reader.hasError());
+    QCOMPARE(names, QStringList() << "root" << "item" << "/item" << "p:item" << "item"
+                                  << "/item" << "/p:item" << "/root");
+    QCOMPARE(itemCount, 3);
+    QCOMPARE(idCount, 4);
+
+    // the prefix of interned names is still available
+    reader.clear();
+    reader.addData(QByteArray("<p:a xmlns:p=\"urn:p\" p:b=\"c\"/>"));
+    QVERIFY(reader.readNextStartElement());
+    QCOMPARE(reader.prefix().toString(), QString("p"));
+    QCOMPARE(reader.namespaceUri().toString(), QString("urn:p"));
+    QCOMPARE(reader.attributes().at(0).prefix().toString(), QString("p"));
+    QCOMPARE(reader.attributes().at(0).qualifiedName().toString(), QString("p:b"));
+    QCOMPARE(reader.attributes().at(0).namespaceUri().toString(), QString("urn:p"));
+}
+
 #include "tst_qxmlstream.moc"
 // vim: et:ts=4:sw=4:sts=4
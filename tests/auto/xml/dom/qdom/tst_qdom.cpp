@@ -115,6 +115,14 @@ private slots:
     void DTDNotationDecl();
     void DTDEntityDecl();
     void QTBUG49113_dontCrashWithNegativeIndex() const;
+    void setContentQXmlStreamReader_data() const;
+    void setContentQXmlStreamReader() const;
+    void setContentLazily_data() const;
+    void setContentLazily() const;
+    void setContentLazilyNamespaces() const;
+    void setContentLazilyDetachedSubtree() const;
+    void setContentLazilyDTD() const;
+    void setContentLazilyError() const;
 
     void cleanupTestCase() const;
 
@@ -1983,5 +1991,180 @@ void tst_QDom::QTBUG49113_dontCrashWithNegativeIndex() const
     QVERIFY(node.isNull());
 }
 
+void tst_QDom::setContentQXmlStreamReader_data() const
+{
+    QTest::addColumn<QString>("xml");
+    QTest::addColumn<bool>("namespaceProcessing");
+
+    const QString plain = QLatin1String(
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<!-- leading comment -->\n"
+        "<root a=\"1\" b=\"two\">\n"
+        "  <child>text &amp; more</child>\n"
+        "  <child><![CDATA[<raw>]]></child>\n"
+        "  <?target data?>\n"
+        "  <empty/>\n"
+        "</root>\n");
+    const QString ns = QLatin1String(
+        "<a:root xmlns:a=\"urn:a\" xmlns=\"urn:default\">"
+        "<child a:attr=\"x\"><a:leaf>y</a:leaf></child>"
+        "</a:root>");
+
+    QTest::newRow("plain") << plain << false;
+    QTest::newRow("plain-ns") << plain << true;
+    QTest::newRow("namespaces") << ns << false;
+    QTest::newRow("namespaces-ns") << ns << true;
+}
+
+void tst_QDom::setContentQXmlStreamReader() const
+{
+    QFETCH(QString, xml);
+    QFETCH(bool, namespaceProcessing);
+
+    QDomDocument expected;
+    QVERIFY(expected.setContent(xml, namespaceProcessing));
+
+    QDomDocument doc;
+    QXmlStreamReader reader(xml);
+    QString errorMsg;
+    QVERIFY2(doc.setContent(&reader, namespaceProcessing, &errorMsg), qPrintable(errorMsg));
+
+    QCOMPARE(doc.toString(), expected.toString());
+    QVERIFY(isDeepEqual(doc, expected));
+
+    const QDomNodeList expectedElements = expected.elementsByTagName(QLatin1String("*"));
+    const QDomNodeList elements = doc.elementsByTagName(QLatin1String("*"));
+    QCOMPARE(elements.count(), expectedElements.count());
+    for (int i = 0; i < elements.count(); ++i) {
+        const QDomNode n = elements.at(i);
+        const QDomNode e = expectedElements.at(i);
+        QCOMPARE(n.namespaceURI(), e.namespaceURI());
+        QCOMPARE(n.prefix(), e.prefix());
+        QCOMPARE(n.localName(), e.localName());
+        QCOMPARE(n.lineNumber(), e.lineNumber());
+    }
+}
+
+void tst_QDom::setContentLazily_data() const
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("depth 1") << 1;
+    QTest::newRow("depth 2") << 2;
+    QTest::newRow("depth 3") << 3;
+}
+
+void tst_QDom::setContentLazily() const
+{
+    QFETCH(int, depth);
+
+    const QString xml = QLatin1String(
+        "<root>\n"
+        "  <section id=\"1\">\n"
+        "    <item>one</item>\n"
+        "    <item>two<!-- c --></item>\n"
+        "  </section>\n"
+        "  <section id=\"2\"><item>three</item></section>\n"
+        "  <section id=\"3\"/>\n"
+        "</root>\n");
+
+    QDomDocument eager;
+    QVERIFY(eager.setContent(xml));
+
+    QDomDocument doc;
+    QString errorMsg;
+    QVERIFY2(doc.setContentLazily(xml, depth, false, &errorMsg), qPrintable(errorMsg));
+
+    const QDomElement root = doc.documentElement();
+    QVERIFY(root.hasChildNodes());
+    const QDomElement first = root.firstChildElement();
+    QCOMPARE(first.attribute(QLatin1String("id")), QLatin1String("1"));
+    QVERIFY(first.hasChildNodes());
+    QVERIFY(!root.lastChildElement().hasChildNodes());
+
+    QCOMPARE(doc.elementsByTagName(QLatin1String("item")).count(), 3);
+    QCOMPARE(first.firstChildElement().text(), QLatin1String("one"));
+    QCOMPARE(doc.toString(), eager.toString());
+    QVERIFY(isDeepEqual(doc, eager));
+
+    const QDomNodeList items = doc.elementsByTagName(QLatin1String("item"));
+    const QDomNodeList eagerItems = eager.elementsByTagName(QLatin1String("item"));
+    for (int i = 0; i < items.count(); ++i) {
+        QCOMPARE(items.at(i).lineNumber(), eagerItems.at(i).lineNumber());
+        QCOMPARE(items.at(i).columnNumber(), eagerItems.at(i).columnNumber());
+    }
+}
+
+void tst_QDom::setContentLazilyNamespaces() const
+{
+    const QString xml = QLatin1String(
+        "<p:root xmlns:p=\"urn:p\" xmlns=\"urn:default\">"
+        "<p:outer><inner p:attr=\"v\"><p:leaf/></inner></p:outer>"
+        "</p:root>");
+
+    QDomDocument doc;
+    QVERIFY(doc.setContentLazily(xml, 1, true));
+
+    const QDomElement inner = doc.documentElement().firstChildElement().firstChildElement();
+    QCOMPARE(inner.namespaceURI(), QLatin1String("urn:default"));
+    QCOMPARE(inner.attributeNS(QLatin1String("urn:p"), QLatin1String("attr")), QLatin1String("v"));
+
+    const QDomElement leaf = inner.firstChildElement();
+    QCOMPARE(leaf.namespaceURI(), QLatin1String("urn:p"));
+    QCOMPARE(leaf.prefix(), QLatin1String("p"));
+    QCOMPARE(leaf.localName(), QLatin1String("leaf"));
+}
+
+void tst_QDom::setContentLazilyDetachedSubtree() const
+{
+    const QString xml = QLatin1String("<root><a><b>1</b></a><c><d>2</d></c></root>");
+
+    QDomDocument doc;
+    QVERIFY(doc.setContentLazily(xml, 1, false));
+
+    QDomElement root = doc.documentElement();
+    QDomNode a = root.removeChild(root.firstChild());
+    QCOMPARE(a.firstChild().toElement().text(), QLatin1String("1"));
+
+    QDomDocument other;
+    QDomNode imported = other.importNode(root.firstChild(), true);
+    QCOMPARE(imported.firstChild().toElement().text(), QLatin1String("2"));
+
+    QDomDocument again;
+    QVERIFY(again.setContentLazily(xml, 1, false));
+    QDomElement c = again.documentElement().lastChildElement();
+    again.clear();
+    QCOMPARE(c.firstChildElement().text(), QLatin1String("2"));
+}
+
+void tst_QDom::setContentLazilyDTD() const
+{
+    const QString xml = QLatin1String(
+        "<!DOCTYPE root [<!ENTITY e \"value\">]>"
+        "<root><a>&e;</a></root>");
+
+    QDomDocument eager;
+    QVERIFY(eager.setContent(xml));
+
+    QDomDocument doc;
+    QVERIFY(doc.setContentLazily(xml, 1, false));
+    QCOMPARE(doc.doctype().name(), QLatin1String("root"));
+    QCOMPARE(doc.documentElement().firstChildElement().text(), QLatin1String("value"));
+    QCOMPARE(doc.toString(), eager.toString());
+}
+
+void tst_QDom::setContentLazilyError() const
+{
+    QDomDocument doc;
+    QString errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+    QVERIFY(!doc.setContentLazily(QLatin1String("<root>\n<a></b></root>"), 1, false,
+                                  &errorMsg, &errorLine, &errorColumn));
+    QVERIFY(!errorMsg.isEmpty());
+    QCOMPARE(errorLine, 2);
+    QVERIFY(errorColumn > 0);
+}
+
 QTEST_MAIN(tst_QDom)
 #include "tst_qdom.moc"
@@ -4,6 +4,7 @@ SUBDIRS = \
         sql \
 
 # removed-by-refactor qtHaveModule(opengl): SUBDIRS += opengl
+qtHaveModule(xml): SUBDIRS += xml
 qtHaveModule(dbus): SUBDIRS += dbus
 qtHaveModule(network): SUBDIRS += network
 qtHaveModule(gui): SUBDIRS += gui
@@ -27,7 +27,9 @@
 ****************************************************************************/
 #include <QTextCodec>
 #include <QFile>
+#include <QVector>
 #include <qtest.h>
+#include <private/qutfcodec_p.h>
 
 Q_DECLARE_METATYPE(QTextCodec *)
 
@@ -42,6 +44,16 @@ private slots:
     void fromUnicode() const;
     void toUnicode_data() const;
     void toUnicode() const;
+    void utf8ToUnicode_data() const;
+    void utf8ToUnicode() const;
+    void utf8FromUnicode_data() const;
+    void utf8FromUnicode() const;
+    void utf8Validate_data() const;
+    void utf8Validate() const;
+    void singleByteToUnicode_data() const;
+    void singleByteToUnicode() const;
+    void singleByteFromUnicode_data() const;
+    void singleByteFromUnicode() const;
 };
 
 void tst_QTextCodec::codecForName() const
@@ -162,7 +174,127 @@ void tst_QTextCodec::toUnicode() const
 }
 
 
+void tst_QTextCodec::utf8ToUnicode_data() const
+{
+    QTest::addColumn<QByteArray>("utf8");
+
+    // the text of each file, repeated to about 1 MB
+    const char *const files[] = {
+        "utf-8.txt",            // short lines in several scripts
+        "utf-8-cjk.txt",        // Chinese, three-byte sequences with some ASCII
+        "utf-8-cyrillic.txt",   // Russian, two-byte sequences with spaces
+        "utf-8-mixed.txt"       // Latin, Greek, Cyrillic, Japanese, Korean and emoji
+    };
+    for (const char *name : files) {
+        QFile file(QFINDTESTDATA(name));
+        QVERIFY2(file.open(QFile::ReadOnly), name);
+        const QByteArray data = file.readAll();
+        QByteArray utf8;
+        utf8.reserve(1024 * 1024 + data.size());
+        while (utf8.size() < 1024 * 1024)
+            utf8 += data;
+        QTest::newRow(name) << utf8;
+    }
+}
+
+void tst_QTextCodec::utf8ToUnicode() const
+{
+    QFETCH(QByteArray, utf8);
+
+    QBENCHMARK {
+        QString s = QString::fromUtf8(utf8);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QTextCodec::utf8FromUnicode_data() const
+{
+    utf8ToUnicode_data();
+}
 
+void tst_QTextCodec::utf8FromUnicode() const
+{
+    QFETCH(QByteArray, utf8);
+    const QString s = QString::fromUtf8(utf8);
+
+    QBENCHMARK {
+        QByteArray ba = s.toUtf8();
+        Q_UNUSED(ba);
+    }
+}
+
+void tst_QTextCodec::utf8Validate_data() const
+{
+    utf8ToUnicode_data();
+}
+
+void tst_QTextCodec::utf8Validate() const
+{
+    QFETCH(QByteArray, utf8);
+
+    bool valid = false;
+    QBENCHMARK {
+        valid = QUtf8::isValidUtf8(utf8.constData(), utf8.size());
+    }
+    QVERIFY(valid);
+}
+
+void tst_QTextCodec::singleByteToUnicode_data() const
+{
+    QTest::addColumn<QTextCodec *>("codec");
+    QTest::addColumn<QString>("text");
+
+    // the lines of the test files that each codec can encode, repeated to
+    // about one million characters
+    QString lines;
+    for (const char *name : { "utf-8.txt", "utf-8-cyrillic.txt", "utf-8-mixed.txt" }) {
+        QFile file(QFINDTESTDATA(name));
+        QVERIFY2(file.open(QFile::ReadOnly), name);
+        lines += QString::fromUtf8(file.readAll());
+    }
+    const char *const codecs[] = { "windows-1252", "ISO-8859-15", "KOI8-R", "windows-1251" };
+    for (const char *name : codecs) {
+        QTextCodec *codec = QTextCodec::codecForName(name);
+        QString encodable;
+        for (const QStringRef &line : lines.splitRef(QLatin1Char('\n'))) {
+            if (codec->canEncode(line.toString()))
+                encodable += line + QLatin1Char('\n');
+        }
+        QVERIFY2(!encodable.isEmpty(), name);
+        QString text;
+        while (text.size() < 1024 * 1024)
+            text += encodable;
+        QTest::newRow(name) << codec << text;
+    }
+}
+
+void tst_QTextCodec::singleByteToUnicode() const
+{
+    QFETCH(QTextCodec *, codec);
+    QFETCH(QString, text);
+    const QByteArray encoded = codec->fromUnicode(text);
+
+    QBENCHMARK {
+        QString s = codec->toUnicode(encoded);
+        Q_UNUSED(s);
+    }
+}
+
+void tst_QTextCodec::singleByteFromUnicode_data() const
+{
+    singleByteToUnicode_data();
+}
+
+void tst_QTextCodec::singleByteFromUnicode() const
+{
+    QFETCH(QTextCodec *, codec);
+    QFETCH(QString, text);
+
+    QBENCHMARK {
+        QByteArray ba = codec->fromUnicode(text);
+        Q_UNUSED(ba);
+    }
+}
 
 QTEST_MAIN(tst_QTextCodec)
 
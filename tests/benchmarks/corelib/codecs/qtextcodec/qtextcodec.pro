@@ -1,6 +1,6 @@
 TARGET = tst_bench_qtextcodec
-QT = core testlib
+QT = core-private testlib
 SOURCES += main.cpp
 
-TESTDATA = utf-8.txt
+TESTDATA = utf-8.txt utf-8-cjk.txt utf-8-cyrillic.txt utf-8-mixed.txt
 
@@ -1,5 +1,6 @@
 TEMPLATE = subdirs
 SUBDIRS = \
+        global \
         io \
         json \
         mimetypes \
@@ -7,7 +8,9 @@ SUBDIRS = \
         thread \
         tools \
         codecs \
-        plugin
+        plugin \
+        serialization \
+        xml
 
 TRUSTED_BENCHMARKS += \
     kernel/qmetaobject \
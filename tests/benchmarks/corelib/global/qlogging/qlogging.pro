@@ -0,0 +1,4 @@
+TEMPLATE = app
+TARGET = tst_bench_qlogging
+QT = core-private testlib
+SOURCES += tst_qlogging.cpp
@@ -0,0 +1,158 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/private/qlogging_p.h>
+#include <QtTest/QtTest>
+
+#ifdef Q_OS_UNIX
+#  include <unistd.h>
+#endif
+
+Q_LOGGING_CATEGORY(lcBenchmark, "bench.logging")
+
+Q_DECLARE_METATYPE(QMessageOutputMode)
+
+enum { MessagesPerThread = 2000 };
+
+class LoggingThread : public QThread
+{
+public:
+    explicit LoggingThread(int id) : id(id) {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        for (int i = 0; i < MessagesPerThread; ++i)
+            qCDebug(lcBenchmark, "message %d from thread %d", i, id);
+    }
+
+private:
+    int id;
+};
+
+class tst_QLogging : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QLogging();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void throughput_data();
+    void throughput();
+
+private:
+    QTemporaryFile output;
+    QtMessageHandler testlibHandler;
+    int savedStderr;
+};
+
+tst_QLogging::tst_QLogging()
+    : testlibHandler(0), savedStderr(-1)
+{
+    // log to stderr, which is redirected to a file during the test
+    qputenv("QT_LOGGING_TO_CONSOLE", "1");
+}
+
+void tst_QLogging::initTestCase()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("This benchmark redirects stderr, which is only implemented on Unix");
+#else
+    QVERIFY(output.open());
+    fflush(stderr);
+    savedStderr = ::dup(STDERR_FILENO);
+    QVERIFY(savedStderr != -1);
+    QVERIFY(::dup2(output.handle(), STDERR_FILENO) != -1);
+
+    // measure the default message handler, not the one of testlib
+    testlibHandler = qInstallMessageHandler(0);
+#endif
+}
+
+void tst_QLogging::cleanupTestCase()
+{
+#ifdef Q_OS_UNIX
+    qt_set_message_output_mode(QMessageOutputMode::Synchronous);
+    qInstallMessageHandler(testlibHandler);
+    if (savedStderr != -1) {
+        fflush(stderr);
+        ::dup2(savedStderr, STDERR_FILENO);
+        ::close(savedStderr);
+    }
+#endif
+}
+
+void tst_QLogging::throughput_data()
+{
+    QTest::addColumn<QMessageOutputMode>("mode");
+    QTest::addColumn<int>("threadCount");
+
+    for (int threadCount : { 1, 4 }) {
+        const QByteArray suffix = ", " + QByteArray::number(threadCount) + " thread(s)";
+        QTest::newRow(("synchronous" + suffix).constData())
+                << QMessageOutputMode::Synchronous << threadCount;
+        QTest::newRow(("asynchronous" + suffix).constData())
+                << QMessageOutputMode::Asynchronous << threadCount;
+        QTest::newRow(("asynchronous-blocking" + suffix).constData())
+                << QMessageOutputMode::AsynchronousBlocking << threadCount;
+    }
+}
+
+void tst_QLogging::throughput()
+{
+    QFETCH(QMessageOutputMode, mode);
+    QFETCH(int, threadCount);
+
+    qt_set_message_output_mode(mode);
+
+    // time until everything is written, including what is still queued
+    QBENCHMARK {
+        QVector<LoggingThread *> threads;
+        for (int i = 0; i < threadCount; ++i)
+            threads.append(new LoggingThread(i));
+        for (LoggingThread *thread : qAsConst(threads))
+            thread->start();
+        for (LoggingThread *thread : qAsConst(threads))
+            thread->wait();
+        qt_flush_message_output();
+        qDeleteAll(threads);
+    }
+
+    qt_set_message_output_mode(QMessageOutputMode::Synchronous);
+}
+
+QTEST_MAIN(tst_QLogging)
+
+#include "tst_qlogging.moc"
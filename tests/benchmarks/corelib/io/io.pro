@@ -1,10 +1,14 @@
 TEMPLATE = subdirs
 SUBDIRS = \
+        qasyncfileio \
+        qdatastream \
         qdir \
         qdiriterator \
         qfile \
         qfileinfo \
         qiodevice \
+        qresourceengine \
+        qsettings \
         qtemporaryfile \
         qtextstream
 
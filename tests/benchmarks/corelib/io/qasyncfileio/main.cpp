@@ -0,0 +1,190 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QAsyncFileIO>
+#include <QEventLoop>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <qtest.h>
+
+// Reads and writes a file in chunks from a thread running an event loop,
+// once with blocking QFile calls and once through QAsyncFileIO, which
+// returns to the event loop while the requests are carried out.
+class tst_qasyncfileio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void readBlocking_data();
+    void readBlocking();
+    void readAsync_data();
+    void readAsync();
+    void writeBlocking_data() { readBlocking_data(); }
+    void writeBlocking();
+    void writeAsync_data() { readAsync_data(); }
+    void writeAsync();
+
+private:
+    QTemporaryDir tempDir;
+    QString fileName;
+};
+
+static const int FileSize = 32 * 1024 * 1024;
+
+void tst_qasyncfileio::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+    fileName = tempDir.path() + QStringLiteral("/data");
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    const QByteArray block(1024 * 1024, 'x');
+    for (int i = 0; i < FileSize / block.size(); ++i)
+        QCOMPARE(file.write(block), qint64(block.size()));
+}
+
+void tst_qasyncfileio::cleanup()
+{
+    qunsetenv("QT_NO_IO_URING");
+}
+
+void tst_qasyncfileio::readBlocking_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("4k") << 4 * 1024;
+    QTest::newRow("64k") << 64 * 1024;
+    QTest::newRow("1M") << 1024 * 1024;
+}
+
+void tst_qasyncfileio::readAsync_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<bool>("threadPool");
+
+    QTest::newRow("4k") << 4 * 1024 << false;
+    QTest::newRow("64k") << 64 * 1024 << false;
+    QTest::newRow("1M") << 1024 * 1024 << false;
+    QTest::newRow("4k-threadpool") << 4 * 1024 << true;
+    QTest::newRow("64k-threadpool") << 64 * 1024 << true;
+    QTest::newRow("1M-threadpool") << 1024 * 1024 << true;
+}
+
+void tst_qasyncfileio::readBlocking()
+{
+    QFETCH(int, chunkSize);
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    QByteArray buffer(chunkSize, Qt::Uninitialized);
+
+    QBENCHMARK {
+        for (qint64 offset = 0; offset < FileSize; offset += chunkSize) {
+            file.seek(offset);
+            QCOMPARE(file.read(buffer.data(), chunkSize), qint64(chunkSize));
+        }
+    }
+}
+
+void tst_qasyncfileio::readAsync()
+{
+    QFETCH(int, chunkSize);
+    QFETCH(bool, threadPool);
+    if (threadPool)
+        qputenv("QT_NO_IO_URING", "1");
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    QAsyncFileIO io;
+
+    QEventLoop loop;
+    qint64 bytesRead = 0;
+    connect(&io, &QAsyncFileIO::readFinished, [&](int, const QByteArray &data) {
+        bytesRead += data.size();
+        if (!io.pendingRequests())
+            loop.quit();
+    });
+
+    QBENCHMARK {
+        bytesRead = 0;
+        for (qint64 offset = 0; offset < FileSize; offset += chunkSize)
+            io.read(&file, offset, chunkSize);
+        loop.exec();
+        QCOMPARE(bytesRead, qint64(FileSize));
+    }
+}
+
+void tst_qasyncfileio::writeBlocking()
+{
+    QFETCH(int, chunkSize);
+    QFile file(tempDir.path() + QStringLiteral("/written"));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Unbuffered));
+    const QByteArray chunk(chunkSize, 'y');
+
+    QBENCHMARK {
+        for (qint64 offset = 0; offset < FileSize; offset += chunkSize) {
+            file.seek(offset);
+            QCOMPARE(file.write(chunk), qint64(chunkSize));
+        }
+    }
+}
+
+void tst_qasyncfileio::writeAsync()
+{
+    QFETCH(int, chunkSize);
+    QFETCH(bool, threadPool);
+    if (threadPool)
+        qputenv("QT_NO_IO_URING", "1");
+
+    QFile file(tempDir.path() + QStringLiteral("/written"));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Unbuffered));
+    const QByteArray chunk(chunkSize, 'y');
+    QAsyncFileIO io;
+
+    QEventLoop loop;
+    qint64 bytesWritten = 0;
+    connect(&io, &QAsyncFileIO::writeFinished, [&](int, qint64 written) {
+        bytesWritten += written;
+        if (!io.pendingRequests())
+            loop.quit();
+    });
+
+    QBENCHMARK {
+        bytesWritten = 0;
+        for (qint64 offset = 0; offset < FileSize; offset += chunkSize)
+            io.write(&file, offset, chunk);
+        loop.exec();
+        QCOMPARE(bytesWritten, qint64(FileSize));
+    }
+}
+
+QTEST_MAIN(tst_qasyncfileio)
+
+#include "main.moc"
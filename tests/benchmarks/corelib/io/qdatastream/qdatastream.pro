@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qdatastream
+QT = core testlib
+CONFIG += release
+
+SOURCES += tst_bench_qdatastream.cpp
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QDataStream>
+#include <QVector>
+
+Q_DECLARE_METATYPE(QDataStream::ByteOrder)
+
+class tst_QDataStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void writeVector_data();
+    void writeVector();
+    void readVector_data();
+    void readVector();
+
+private:
+    template <typename T> void writeVectorImpl();
+    template <typename T> void readVectorImpl();
+
+    int elementCount;
+};
+
+void tst_QDataStream::initTestCase()
+{
+    // use e.g. QT_BENCH_DATASTREAM_ELEMENTS=100000000 for vectors that do not fit in the caches
+    elementCount = qEnvironmentVariableIsSet("QT_BENCH_DATASTREAM_ELEMENTS")
+            ? qEnvironmentVariableIntValue("QT_BENCH_DATASTREAM_ELEMENTS") : 1000000;
+    QVERIFY(elementCount > 0);
+}
+
+static void addRows()
+{
+    QTest::addColumn<QString>("type");
+    QTest::addColumn<QDataStream::ByteOrder>("byteOrder");
+    QTest::addColumn<bool>("elementwise");
+
+    const char *types[] = { "int", "double" };
+    for (const char *type : types) {
+        const QString typeName = QLatin1String(type);
+        QTest::newRow(qPrintable(typeName + "-BigEndian"))
+                << typeName << QDataStream::BigEndian << false;
+        QTest::newRow(qPrintable(typeName + "-LittleEndian"))
+                << typeName << QDataStream::LittleEndian << false;
+        QTest::newRow(qPrintable(typeName + "-BigEndian-elementwise"))
+                << typeName << QDataStream::BigEndian << true;
+        QTest::newRow(qPrintable(typeName + "-LittleEndian-elementwise"))
+                << typeName << QDataStream::LittleEndian << true;
+    }
+}
+
+template <typename T>
+static QVector<T> makeVector(int count)
+{
+    QVector<T> vector(count);
+    for (int i = 0; i < count; ++i)
+        vector[i] = T(i * 7 - count);
+    return vector;
+}
+
+template <typename T>
+void tst_QDataStream::writeVectorImpl()
+{
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(bool, elementwise);
+
+    const QVector<T> vector = makeVector<T>(elementCount);
+    QByteArray data;
+    data.reserve(int(sizeof(quint32) + elementCount * sizeof(T)));
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QDataStream stream(&buffer);
+    stream.setByteOrder(byteOrder);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        if (elementwise) {
+            // what operator<< used to do for all element types
+            stream << quint32(vector.size());
+            for (const T &t : vector)
+                stream << t;
+        } else {
+            stream << vector;
+        }
+    }
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QCOMPARE(data.size(), int(sizeof(quint32) + elementCount * sizeof(T)));
+}
+
+void tst_QDataStream::writeVector_data()
+{
+    addRows();
+}
+
+void tst_QDataStream::writeVector()
+{
+    QFETCH(QString, type);
+    if (type == QLatin1String("int"))
+        writeVectorImpl<int>();
+    else
+        writeVectorImpl<double>();
+}
+
+template <typename T>
+void tst_QDataStream::readVectorImpl()
+{
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+    QFETCH(bool, elementwise);
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(byteOrder);
+        stream << makeVector<T>(elementCount);
+    }
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream stream(&buffer);
+    stream.setByteOrder(byteOrder);
+    QVector<T> vector;
+
+    QBENCHMARK {
+        buffer.seek(0);
+        if (elementwise) {
+            // what operator>> used to do for all element types
+            vector.clear();
+            quint32 n;
+            stream >> n;
+            vector.reserve(n);
+            for (quint32 i = 0; i < n; ++i) {
+                T t;
+                stream >> t;
+                vector.append(t);
+            }
+        } else {
+            stream >> vector;
+        }
+    }
+    QCOMPARE(stream.status(), QDataStream::Ok);
+    QCOMPARE(vector.size(), elementCount);
+    QCOMPARE(vector.last(), T((elementCount - 1) * 7 - elementCount));
+}
+
+void tst_QDataStream::readVector_data()
+{
+    addRows();
+}
+
+void tst_QDataStream::readVector()
+{
+    QFETCH(QString, type);
+    if (type == QLatin1String("int"))
+        readVectorImpl<int>();
+    else
+        readVectorImpl<double>();
+}
+
+QTEST_MAIN(tst_QDataStream)
+
+#include "tst_bench_qdatastream.moc"
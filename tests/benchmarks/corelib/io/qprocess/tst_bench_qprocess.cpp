@@ -36,6 +36,8 @@ class tst_QProcess : public QObject
 private slots:
 
     void echoTest_performance();
+    void spawnRate_data();
+    void spawnRate();
 };
 
 void tst_QProcess::echoTest_performance()
@@ -83,5 +85,41 @@ void tst_QProcess::echoTest_performance()
     QVERIFY(process.waitForFinished());
 }
 
+// Reimplementing setupChildProcess() makes QProcess fork() the child
+class SetupChildProcess : public QProcess
+{
+protected:
+    void setupChildProcess() Q_DECL_OVERRIDE { }
+};
+
+void tst_QProcess::spawnRate_data()
+{
+    QTest::addColumn<bool>("reimplementSetup");
+    QTest::addColumn<int>("heapMegabytes");
+
+    QTest::newRow("default") << false << 0;
+    QTest::newRow("setupChildProcess") << true << 0;
+    QTest::newRow("default, 256 MB heap") << false << 256;
+    QTest::newRow("setupChildProcess, 256 MB heap") << true << 256;
+}
+
+// how many short-lived processes can be started per second
+void tst_QProcess::spawnRate()
+{
+    QFETCH(bool, reimplementSetup);
+    QFETCH(int, heapMegabytes);
+
+    // fork() has to copy the page tables of the parent, so make it big
+    const QByteArray heap(heapMegabytes * 1024 * 1024, 'x');
+
+    QScopedPointer<QProcess> process(reimplementSetup ? new SetupChildProcess : new QProcess);
+    QBENCHMARK {
+        process->start("testProcessLoopback/testProcessLoopback");
+        process->closeWriteChannel();
+        QVERIFY(process->waitForFinished());
+        QCOMPARE(process->exitCode(), 0);
+    }
+}
+
 QTEST_MAIN(tst_QProcess)
 #include "tst_bench_qprocess.moc"
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QResource>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThreadPool>
+
+#include <qtest.h>
+
+// 500 directories of 100 files each
+static const int dirCount = 500;
+static const int filesPerDir = 100;
+
+class tst_qresourceengine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void registerResource_data();
+    void registerResource();
+    void openAll_data();
+    void openAll();
+    void openAllConcurrently_data();
+    void openAllConcurrently();
+    void missing_data();
+    void missing();
+
+private:
+    void addColumns();
+    QString m_rcc;
+    QTemporaryDir m_dir;
+    QStringList m_paths;
+};
+
+void tst_qresourceengine::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QVERIFY(QDir(m_dir.path()).mkdir(QStringLiteral("files")));
+
+    QFile qrc(m_dir.filePath(QStringLiteral("bench.qrc")));
+    QVERIFY(qrc.open(QIODevice::WriteOnly | QIODevice::Text));
+    qrc.write("<!DOCTYPE RCC><RCC version=\"1.0\">\n<qresource>\n");
+    for (int d = 0; d < dirCount; ++d) {
+        const QString dir = QStringLiteral("files/dir%1").arg(d);
+        QVERIFY(QDir(m_dir.path()).mkdir(dir));
+        for (int f = 0; f < filesPerDir; ++f) {
+            const QString name = dir + QStringLiteral("/file%1.txt").arg(f);
+            QFile file(m_dir.filePath(name));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(name.toLatin1());
+            qrc.write("<file>" + name.toLatin1() + "</file>\n");
+            m_paths << QStringLiteral(":/bench") + QLatin1Char('/') + name;
+        }
+    }
+    qrc.write("</qresource>\n</RCC>\n");
+    qrc.close();
+
+    m_rcc = QLibraryInfo::location(QLibraryInfo::BinariesPath) + QLatin1String("/rcc");
+    for (int version = 2; version <= 3; ++version) {
+        QProcess process;
+        process.setWorkingDirectory(m_dir.path());
+        process.start(m_rcc, QStringList() << QStringLiteral("-binary") << QStringLiteral("-no-compress")
+                      << QStringLiteral("-format-version") << QString::number(version)
+                      << QStringLiteral("-o") << QStringLiteral("bench%1.rcc").arg(version)
+                      << QStringLiteral("bench.qrc"));
+        QVERIFY2(process.waitForFinished(600000), qPrintable(process.errorString()));
+        QVERIFY2(process.exitCode() == 0, process.readAllStandardError().constData());
+    }
+}
+
+void tst_qresourceengine::cleanupTestCase()
+{
+    m_paths.clear();
+}
+
+void tst_qresourceengine::addColumns()
+{
+    QTest::addColumn<QString>("rccFile");
+    QTest::newRow("tree") << m_dir.filePath(QStringLiteral("bench2.rcc"));
+    QTest::newRow("index") << m_dir.filePath(QStringLiteral("bench3.rcc"));
+}
+
+void tst_qresourceengine::registerResource_data()
+{
+    addColumns();
+}
+
+void tst_qresourceengine::registerResource()
+{
+    QFETCH(QString, rccFile);
+    const QString first = m_paths.first();
+    QBENCHMARK {
+        QVERIFY(QResource::registerResource(rccFile, QStringLiteral("/bench")));
+        {
+            QFile file(first);
+            QVERIFY(file.open(QIODevice::ReadOnly));
+        }
+        QVERIFY(QResource::unregisterResource(rccFile, QStringLiteral("/bench")));
+    }
+}
+
+void tst_qresourceengine::openAll_data()
+{
+    addColumns();
+}
+
+void tst_qresourceengine::openAll()
+{
+    QFETCH(QString, rccFile);
+    QVERIFY(QResource::registerResource(rccFile, QStringLiteral("/bench")));
+    QBENCHMARK {
+        for (const QString &path : qAsConst(m_paths)) {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly))
+                QFAIL(qPrintable(path));
+        }
+    }
+    QVERIFY(QResource::unregisterResource(rccFile, QStringLiteral("/bench")));
+}
+
+void tst_qresourceengine::openAllConcurrently_data()
+{
+    addColumns();
+}
+
+class OpenTask : public QRunnable
+{
+public:
+    OpenTask(const QStringList &paths, int start, int step)
+        : m_paths(paths), m_start(start), m_step(step) {}
+    void run() override
+    {
+        for (int i = m_start; i < m_paths.size(); i += m_step) {
+            QFile file(m_paths.at(i));
+            file.open(QIODevice::ReadOnly);
+        }
+    }
+
+private:
+    const QStringList &m_paths;
+    int m_start, m_step;
+};
+
+void tst_qresourceengine::openAllConcurrently()
+{
+    QFETCH(QString, rccFile);
+    QVERIFY(QResource::registerResource(rccFile, QStringLiteral("/bench")));
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int threads = qMax(2, pool->maxThreadCount());
+    QBENCHMARK {
+        for (int i = 0; i < threads; ++i)
+            pool->start(new OpenTask(m_paths, i, threads));
+        pool->waitForDone();
+    }
+    QVERIFY(QResource::unregisterResource(rccFile, QStringLiteral("/bench")));
+}
+
+void tst_qresourceengine::missing_data()
+{
+    addColumns();
+}
+
+void tst_qresourceengine::missing()
+{
+    QFETCH(QString, rccFile);
+    QVERIFY(QResource::registerResource(rccFile, QStringLiteral("/bench")));
+    QStringList missing;
+    missing.reserve(m_paths.size());
+    for (const QString &path : qAsConst(m_paths))
+        missing << path + QLatin1Char('~');
+    QBENCHMARK {
+        for (const QString &path : qAsConst(missing)) {
+            if (QFile::exists(path))
+                QFAIL(qPrintable(path));
+        }
+    }
+    QVERIFY(QResource::unregisterResource(rccFile, QStringLiteral("/bench")));
+}
+
+QTEST_MAIN(tst_qresourceengine)
+
+#include "main.moc"
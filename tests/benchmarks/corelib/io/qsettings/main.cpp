@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QtCore/QSettings>
+#include <QtCore/QTemporaryDir>
+
+class tst_QSettings : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+
+    void sync_data();
+    void sync();
+    void construct();
+    void value();
+    void reloadAppended();
+
+private:
+    QTemporaryDir dir;
+    QString fileName;
+};
+
+enum { GroupCount = 100, KeysPerGroup = 50 };
+
+void tst_QSettings::initTestCase()
+{
+    QVERIFY(dir.isValid());
+    fileName = dir.path() + QLatin1String("/bench.ini");
+}
+
+void tst_QSettings::init()
+{
+    QFile::remove(fileName);
+    QSettings settings(fileName, QSettings::IniFormat);
+    for (int i = 0; i < GroupCount; ++i) {
+        settings.beginGroup(QLatin1String("group") + QString::number(i));
+        for (int j = 0; j < KeysPerGroup; ++j)
+            settings.setValue(QLatin1String("key") + QString::number(j), QString(40, QLatin1Char('v')));
+        settings.endGroup();
+    }
+    settings.sync();
+    QCOMPARE(settings.status(), QSettings::NoError);
+}
+
+void tst_QSettings::sync_data()
+{
+    QTest::addColumn<bool>("incremental");
+
+    QTest::newRow("rewrite") << false;
+    QTest::newRow("incremental") << true;
+}
+
+void tst_QSettings::sync()
+{
+    QFETCH(bool, incremental);
+
+    QSettings settings(fileName, QSettings::IniFormat);
+    settings.setIncrementalSyncEnabled(incremental);
+    int i = 0;
+    QBENCHMARK {
+        settings.setValue(QStringLiteral("group7/key3"), ++i);
+        settings.sync();
+    }
+    QCOMPARE(settings.status(), QSettings::NoError);
+}
+
+void tst_QSettings::construct()
+{
+    // keep the file shared and parsed, as a long-running application would
+    QSettings keeper(fileName, QSettings::IniFormat);
+    keeper.value(QStringLiteral("group42/key7"));
+
+    QBENCHMARK {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.value(QStringLiteral("group42/key7"));
+    }
+}
+
+void tst_QSettings::value()
+{
+    QSettings settings(fileName, QSettings::IniFormat);
+    QBENCHMARK {
+        for (int i = 0; i < GroupCount; ++i)
+            settings.value(QLatin1String("group") + QString::number(i) + QLatin1String("/key3"));
+    }
+}
+
+void tst_QSettings::reloadAppended()
+{
+    // another process appending to the file makes the next sync read the new sections only
+    QSettings settings(fileName, QSettings::IniFormat);
+    settings.value(QStringLiteral("group42/key7"));
+
+    QFile file(fileName);
+    int i = 0;
+    QBENCHMARK {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("\n[group7]\nkey3=" + QByteArray::number(++i) + '\n');
+        file.close();
+        settings.sync();
+        QCOMPARE(settings.value(QStringLiteral("group7/key3")).toInt(), i);
+    }
+}
+
+QTEST_MAIN(tst_QSettings)
+
+#include "main.moc"
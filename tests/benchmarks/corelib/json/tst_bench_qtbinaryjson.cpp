@@ -29,6 +29,8 @@
 #include <QtTest>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
+#include <qjsonarray.h>
+#include <qjsonstream.h>
 
 class BenchmarkQtBinaryJson: public QObject
 {
@@ -45,12 +47,35 @@ private Q_SLOTS:
     void parseNumbers();
     void parseJson();
     void parseJsonToVariant();
+    void parseJsonStream();
+    void parseThroughput_data();
+    void parseThroughput();
+
+    void readNdjson_data();
+    void readNdjson();
+    void writeNdjson_data();
+    void writeNdjson();
 
     void toByteArray();
     void fromByteArray();
 
     void jsonObjectInsert();
     void variantMapInsert();
+
+    void buildArray_data();
+    void buildArray();
+    void buildObject_data();
+    void buildObject();
+    void modifyObject_data();
+    void modifyObject();
+    void iterateArray_data();
+    void iterateArray();
+
+private:
+    QByteArray ndjson;
+    QByteArray tweets;
+    QByteArray coordinates;
+    QByteArray catalog;
 };
 
 BenchmarkQtBinaryJson::BenchmarkQtBinaryJson(QObject *parent) : QObject(parent)
@@ -60,7 +85,70 @@ BenchmarkQtBinaryJson::BenchmarkQtBinaryJson(QObject *parent) : QObject(parent)
 
 void BenchmarkQtBinaryJson::initTestCase()
 {
+    // an export of 20000 small records, one per line
+    for (int i = 0; i < 20000; ++i) {
+        QJsonObject record;
+        record.insert("id", i);
+        record.insert("name", QString("record %1").arg(i));
+        record.insert("score", i / 7.);
+        record.insert("tags", QJsonArray{ "a", "b", i % 2 == 0 });
+        ndjson += QJsonDocument(record).toJson(QJsonDocument::Compact);
+        ndjson += '\n';
+    }
+
+    // the shapes of the usual parser benchmark corpora: text heavy social
+    // media messages, GeoJSON polygons and an indented event catalog
+    const QString texts[] = {
+        QStringLiteral("Just landed in Berlin, the weather is great. Meeting the team for dinner tonight at 8 http://example.com/a/b"),
+        QStringLiteral("\"Quoted\" replies and a backslash \\ and a\nsecond line, because people paste all kinds of things"),
+        QString::fromUtf8("Caf\xc3\xa9 cr\xc3\xa8me br\xc3\xbbl\xc3\xa9e in M\xc3\xbcnchen \xe2\x80\x94 \xe6\x9d\xb1\xe4\xba\xac\xe3\x81\xab\xe8\xa1\x8c\xe3\x81\x8d\xe3\x81\x9f\xe3\x81\x84 \xf0\x9f\x98\x80"),
+        QStringLiteral("Release notes: fixed the crash when opening large files, improved startup time, updated translations")
+    };
+    QJsonArray statuses;
+    for (int i = 0; i < 10000; ++i) {
+        QJsonObject user;
+        user.insert("id", 1000000 + i % 500);
+        user.insert("screen_name", QString("user_%1").arg(i % 500));
+        user.insert("description", texts[(i + 3) % 4]);
+        user.insert("followers_count", i * 37 % 100000);
+        user.insert("verified", i % 50 == 0);
+        QJsonObject status;
+        status.insert("created_at", "Sun Aug 31 00:29:15 +0000 2014");
+        status.insert("id_str", QString::number(505874924095815681LL + i));
+        status.insert("text", texts[i % 4]);
+        status.insert("source", "<a href=\"http://example.com\" rel=\"nofollow\">client</a>");
+        status.insert("in_reply_to_status_id", QJsonValue());
+        status.insert("user", user);
+        status.insert("retweet_count", i % 100);
+        status.insert("favorited", false);
+        status.insert("lang", i % 4 == 2 ? "ja" : "en");
+        statuses.append(status);
+    }
+    tweets = QJsonDocument(QJsonObject{ { "statuses", statuses } }).toJson(QJsonDocument::Indented);
 
+    QJsonArray rings;
+    for (int r = 0; r < 100; ++r) {
+        QJsonArray ring;
+        for (int i = 0; i < 2000; ++i)
+            ring.append(QJsonArray{ -65.613616999999977 + r + i / 1000., 43.420273000000009 - i / 3000. });
+        rings.append(ring);
+    }
+    QJsonObject geometry{ { "type", "Polygon" }, { "coordinates", rings } };
+    coordinates = QJsonDocument(QJsonObject{ { "type", "Feature" }, { "geometry", geometry } }).toJson(QJsonDocument::Compact);
+
+    QJsonObject events;
+    for (int i = 0; i < 20000; ++i) {
+        QJsonObject event;
+        event.insert("id", 138586341 + i);
+        event.insert("name", QString("Concert %1 - Orchestre Philharmonique").arg(i));
+        event.insert("description", QJsonValue());
+        event.insert("logo", QString("/images/UE0AAAAACEKo%1QAAAAVDSVRN").arg(i));
+        event.insert("subTopicIds", QJsonArray{ 337184269, 337184283 + i % 10 });
+        event.insert("topicIds", QJsonArray{ 324846099, 107888604 });
+        event.insert("subjectCode", QJsonValue());
+        events.insert(QString::number(138586341 + i), event);
+    }
+    catalog = QJsonDocument(QJsonObject{ { "events", events } }).toJson(QJsonDocument::Indented);
 }
 
 void BenchmarkQtBinaryJson::cleanupTestCase()
@@ -120,6 +208,143 @@ void BenchmarkQtBinaryJson::parseJsonToVariant()
     }
 }
 
+void BenchmarkQtBinaryJson::parseJsonStream()
+{
+    QString testFile = QFINDTESTDATA("test.json");
+    QVERIFY2(!testFile.isEmpty(), "cannot find test file test.json!");
+    QFile file(testFile);
+    file.open(QFile::ReadOnly);
+    QByteArray testJson = file.readAll();
+
+    QBENCHMARK {
+        QJsonStreamReader reader(testJson);
+        while (!reader.atEnd())
+            reader.readNext();
+    }
+}
+
+void BenchmarkQtBinaryJson::parseThroughput_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::newRow("tweets") << tweets;
+    QTest::newRow("coordinates") << coordinates;
+    QTest::newRow("catalog") << catalog;
+    QTest::newRow("ndjson") << QByteArray('[' + QByteArray(ndjson).replace('\n', ',') + "{}]");
+
+    // add real world files, e.g. twitter.json, canada.json and citm_catalog.json
+    const QString corpus = QString::fromLocal8Bit(qgetenv("QT_BENCH_JSON_CORPUS"));
+    if (!corpus.isEmpty()) {
+        QDirIterator it(corpus, QStringList() << "*.json", QDir::Files);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (file.open(QFile::ReadOnly))
+                QTest::newRow(qPrintable(it.fileName())) << file.readAll();
+        }
+    }
+}
+
+void BenchmarkQtBinaryJson::parseThroughput()
+{
+    QFETCH(QByteArray, json);
+
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+    timer.start();
+    do {
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(json, &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        bytes += json.size();
+    } while (timer.elapsed() < 1000);
+    QTest::setBenchmarkResult(bytes * 1e9 / timer.nsecsElapsed(), QTest::BytesPerSecond);
+}
+
+void BenchmarkQtBinaryJson::readNdjson_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::newRow("QJsonDocument per line") << 0;
+    QTest::newRow("QJsonStreamReader tokens") << 1;
+    QTest::newRow("QJsonStreamReader values") << 2;
+}
+
+void BenchmarkQtBinaryJson::readNdjson()
+{
+    QFETCH(int, method);
+
+    QBENCHMARK {
+        QBuffer buffer(&ndjson);
+        buffer.open(QIODevice::ReadOnly);
+        double sum = 0;
+        if (method == 0) {
+            while (!buffer.atEnd())
+                sum += QJsonDocument::fromJson(buffer.readLine()).object().value("score").toDouble();
+        } else {
+            QJsonStreamReader reader(&buffer);
+            while (!reader.atEnd()) {
+                const QJsonStreamReader::TokenType token = reader.readNext();
+                if (method == 1) {
+                    if (token == QJsonStreamReader::Name && reader.text() == QLatin1String("score")) {
+                        reader.readNext();
+                        sum += reader.toDouble();
+                    }
+                } else if (token == QJsonStreamReader::StartObject) {
+                    sum += reader.readCurrentValue().toObject().value("score").toDouble();
+                }
+            }
+            QVERIFY(!reader.hasError());
+        }
+        QVERIFY(sum > 0);
+    }
+}
+
+void BenchmarkQtBinaryJson::writeNdjson_data()
+{
+    QTest::addColumn<bool>("stream");
+    QTest::newRow("QJsonDocument::toJson") << false;
+    QTest::newRow("QJsonStreamWriter") << true;
+}
+
+void BenchmarkQtBinaryJson::writeNdjson()
+{
+    QFETCH(bool, stream);
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        if (stream) {
+            QJsonStreamWriter writer(&buffer);
+            writer.setFormat(QJsonDocument::Compact);
+            for (int i = 0; i < 20000; ++i) {
+                writer.writeStartObject();
+                writer.writeName("id");
+                writer.writeDouble(i);
+                writer.writeName("name");
+                writer.writeString(QString("record %1").arg(i));
+                writer.writeName("score");
+                writer.writeDouble(i / 7.);
+                writer.writeName("tags");
+                writer.writeStartArray();
+                writer.writeString("a");
+                writer.writeString("b");
+                writer.writeBool(i % 2 == 0);
+                writer.writeEndArray();
+                writer.writeEndObject();
+            }
+        } else {
+            for (int i = 0; i < 20000; ++i) {
+                QJsonObject record;
+                record.insert("id", i);
+                record.insert("name", QString("record %1").arg(i));
+                record.insert("score", i / 7.);
+                record.insert("tags", QJsonArray{ "a", "b", i % 2 == 0 });
+                buffer.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+                buffer.write("\n", 1);
+            }
+        }
+        QCOMPARE(buffer.size(), qint64(ndjson.size()));
+    }
+}
+
 void BenchmarkQtBinaryJson::toByteArray()
 {
     // Example: send information over a datastream to another process
@@ -174,6 +399,112 @@ void BenchmarkQtBinaryJson::variantMapInsert()
     }
 }
 
+static QJsonObject record(int i)
+{
+    QJsonObject record;
+    record.insert("id", i);
+    record.insert("name", QString("record %1").arg(i));
+    record.insert("score", i / 7.);
+    return record;
+}
+
+void BenchmarkQtBinaryJson::buildArray_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BenchmarkQtBinaryJson::buildArray()
+{
+    QFETCH(int, count);
+
+    QBENCHMARK {
+        QJsonArray array;
+        for (int i = 0; i < count; ++i)
+            array.append(record(i));
+        QCOMPARE(array.size(), count);
+    }
+}
+
+void BenchmarkQtBinaryJson::buildObject_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("reversed");
+    QTest::newRow("1000") << 1000 << false;
+    QTest::newRow("10000") << 10000 << false;
+    QTest::newRow("100000") << 100000 << false;
+    QTest::newRow("10000-reversed") << 10000 << true;
+}
+
+void BenchmarkQtBinaryJson::buildObject()
+{
+    QFETCH(int, count);
+    QFETCH(bool, reversed);
+
+    QBENCHMARK {
+        QJsonObject object;
+        for (int i = 0; i < count; ++i) {
+            const int key = reversed ? count - i : i;
+            object.insert(QString::asprintf("key%06d", key), QString::number(key));
+        }
+        QCOMPARE(object.size(), count);
+    }
+}
+
+void BenchmarkQtBinaryJson::modifyObject_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void BenchmarkQtBinaryJson::modifyObject()
+{
+    QFETCH(int, count);
+
+    QJsonObject object;
+    QStringList keys;
+    for (int i = 0; i < count; ++i) {
+        keys << QString::asprintf("key%06d", i);
+        object.insert(keys.last(), i);
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i)
+            object.insert(keys.at(i), QString::number(i));
+        for (int i = 0; i < count; ++i)
+            object.remove(keys.at(i));
+        for (int i = 0; i < count; ++i)
+            object.insert(keys.at(i), i);
+    }
+    QCOMPARE(object.size(), count);
+}
+
+void BenchmarkQtBinaryJson::iterateArray_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BenchmarkQtBinaryJson::iterateArray()
+{
+    QFETCH(int, count);
+
+    QJsonArray array;
+    for (int i = 0; i < count; ++i)
+        array.append(record(i));
+
+    QBENCHMARK {
+        double sum = 0;
+        for (const QJsonValue &value : qAsConst(array))
+            sum += value.toObject().value("score").toDouble();
+        QVERIFY(sum > 0);
+    }
+}
+
 QTEST_MAIN(BenchmarkQtBinaryJson)
 #include "tst_bench_qtbinaryjson.moc"
 
@@ -4,9 +4,13 @@ SUBDIRS = \
         qmetaobject \
         qmetatype \
         qobject \
+        qsharedmemorychannel \
         qvariant \
         qcoreapplication
 
 !qtHaveModule(widgets): SUBDIRS -= \
     qmetaobject \
     qobject
+
+!linux|android|!qtConfig(sharedmemory): SUBDIRS -= \
+    qsharedmemorychannel
@@ -0,0 +1,383 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QProcess>
+#include <QtCore/QSharedMemoryChannel>
+#include <QtTest/QtTest>
+#ifdef QT_NETWORK_LIB
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+#endif
+
+#include <stdio.h>
+
+/*
+    Each benchmark talks to a peer process, started from this same binary
+    with "-peer <transport> <name> <size>". The peer understands three
+    requests: 'E' followed by a message of <size> bytes, which it sends
+    back; 'S' followed by a count, to which it answers with that many
+    messages of <size> bytes; and 'Q', to quit.
+*/
+
+static const int channelCapacity = 1 << 20;
+
+static int runChannelPeer(const QString &name, int size)
+{
+    QSharedMemoryChannel requests(name + QLatin1String("-req"));
+    if (!requests.create(channelCapacity, QSharedMemoryChannel::SingleSender))
+        return 1;
+    QSharedMemoryChannel replies(name + QLatin1String("-resp"));
+    if (!replies.attach())
+        return 1;
+    fputs("ready\n", stdout);
+    fflush(stdout);
+
+    const QByteArray payload(size, 'p');
+    QByteArray request(size + 32, Qt::Uninitialized);
+    forever {
+        if (!requests.waitForMessage(30000))
+            return 1;
+        const int length = requests.receive(request.data(), request.size());
+        if (length < 1)
+            return 1;
+        switch (request.at(0)) {
+        case 'E':
+            if (!replies.send(request.constData() + 1, length - 1, -1))
+                return 1;
+            break;
+        case 'S': {
+            const qint64 count = QByteArray(request.constData() + 1, length - 1).toLongLong();
+            for (qint64 i = 0; i < count; ++i) {
+                if (!replies.send(payload, -1))
+                    return 1;
+            }
+            break;
+        }
+        default:
+            return 0;
+        }
+    }
+}
+
+#ifdef QT_NETWORK_LIB
+static bool readFully(QLocalSocket *socket, char *data, qint64 size, int msecs = 30000)
+{
+    while (size > 0) {
+        if (socket->bytesAvailable() == 0 && !socket->waitForReadyRead(msecs))
+            return false;
+        const qint64 read = socket->read(data, size);
+        if (read < 0)
+            return false;
+        data += read;
+        size -= read;
+    }
+    return true;
+}
+
+static bool writeFully(QLocalSocket *socket, const QByteArray &data)
+{
+    if (socket->write(data) != data.size())
+        return false;
+    while (socket->bytesToWrite() > 0) {
+        if (!socket->waitForBytesWritten(30000))
+            return false;
+    }
+    return true;
+}
+
+static int runLocalSocketPeer(const QString &name, int size)
+{
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (!socket.waitForConnected(10000))
+        return 1;
+
+    QByteArray payload(size, 'p');
+    forever {
+        char command;
+        if (!readFully(&socket, &command, 1))
+            return 0;
+        switch (command) {
+        case 'E':
+            if (!readFully(&socket, payload.data(), size) || !writeFully(&socket, payload))
+                return 1;
+            break;
+        case 'S': {
+            qint64 count;
+            if (!readFully(&socket, reinterpret_cast<char *>(&count), sizeof count))
+                return 1;
+            for (qint64 i = 0; i < count; ++i) {
+                socket.write(payload);
+                if (socket.bytesToWrite() > channelCapacity && !socket.waitForBytesWritten(30000))
+                    return 1;
+            }
+            if (!writeFully(&socket, QByteArray()))
+                return 1;
+            break;
+        }
+        default:
+            return 0;
+        }
+    }
+}
+#endif // QT_NETWORK_LIB
+
+class Peer
+{
+public:
+    virtual ~Peer() {}
+    virtual bool start(int size) = 0;
+    virtual bool echo() = 0;
+    virtual bool stream(qint64 count) = 0;
+
+protected:
+    bool startProcess(const char *transport, const QString &name, int size)
+    {
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(QCoreApplication::applicationFilePath(),
+                      QStringList() << "-peer" << transport << name << QString::number(size));
+        return process.waitForStarted();
+    }
+
+    static QString peerName()
+    {
+        return QString("tst_bench_qsharedmemorychannel_%1").arg(QCoreApplication::applicationPid());
+    }
+
+    QProcess process;
+};
+
+class ChannelPeer : public Peer
+{
+public:
+    ~ChannelPeer()
+    {
+        if (requests.isAttached())
+            requests.send(QByteArray("Q"), 1000);
+        process.waitForFinished();
+    }
+
+    bool start(int size) Q_DECL_OVERRIDE
+    {
+        const QString name = peerName();
+        replies.setKey(name + QLatin1String("-resp"));
+        if (!replies.create(channelCapacity, QSharedMemoryChannel::SingleSender))
+            return false;
+        if (!startProcess("channel", name, size) || !process.waitForReadyRead(10000))
+            return false;
+        requests.setKey(name + QLatin1String("-req"));
+        if (!requests.attach())
+            return false;
+
+        request = 'E' + QByteArray(size, 'm');
+        buffer.resize(size);
+        return true;
+    }
+
+    bool echo() Q_DECL_OVERRIDE
+    {
+        return requests.send(request, -1)
+                && replies.waitForMessage(10000)
+                && replies.receive(buffer.data(), buffer.size()) == buffer.size();
+    }
+
+    bool stream(qint64 count) Q_DECL_OVERRIDE
+    {
+        if (!requests.send('S' + QByteArray::number(count), -1))
+            return false;
+        for (qint64 i = 0; i < count; ++i) {
+            if (!replies.waitForMessage(10000)
+                    || replies.receive(buffer.data(), buffer.size()) != buffer.size())
+                return false;
+        }
+        return true;
+    }
+
+private:
+    QSharedMemoryChannel requests;
+    QSharedMemoryChannel replies;
+    QByteArray request;
+    QByteArray buffer;
+};
+
+#ifdef QT_NETWORK_LIB
+class LocalSocketPeer : public Peer
+{
+public:
+    LocalSocketPeer() : socket(0) {}
+
+    ~LocalSocketPeer()
+    {
+        if (socket)
+            writeFully(socket, QByteArray("Q"));
+        process.waitForFinished();
+    }
+
+    bool start(int size) Q_DECL_OVERRIDE
+    {
+        const QString name = peerName();
+        QLocalServer::removeServer(name);
+        if (!server.listen(name))
+            return false;
+        if (!startProcess("localsocket", name, size) || !server.waitForNewConnection(10000))
+            return false;
+        socket = server.nextPendingConnection();
+
+        request = 'E' + QByteArray(size, 'm');
+        buffer.resize(size);
+        return true;
+    }
+
+    bool echo() Q_DECL_OVERRIDE
+    {
+        return writeFully(socket, request)
+                && readFully(socket, buffer.data(), buffer.size(), 10000);
+    }
+
+    bool stream(qint64 count) Q_DECL_OVERRIDE
+    {
+        if (!writeFully(socket, 'S' + QByteArray(reinterpret_cast<const char *>(&count), sizeof count)))
+            return false;
+        for (qint64 i = 0; i < count; ++i) {
+            if (!readFully(socket, buffer.data(), buffer.size(), 10000))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    QLocalServer server;
+    QLocalSocket *socket;
+    QByteArray request;
+    QByteArray buffer;
+};
+#endif // QT_NETWORK_LIB
+
+class tst_QSharedMemoryChannel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void throughput_data();
+    void throughput();
+
+private:
+    void addRows(const QList<int> &sizes);
+    Peer *createPeer(const QString &transport);
+};
+
+void tst_QSharedMemoryChannel::addRows(const QList<int> &sizes)
+{
+    QTest::addColumn<QString>("transport");
+    QTest::addColumn<int>("size");
+
+    QStringList transports;
+    transports << "channel";
+#ifdef QT_NETWORK_LIB
+    transports << "localsocket";
+#endif
+    for (const QString &transport : qAsConst(transports)) {
+        for (int size : sizes) {
+            const QByteArray name = transport.toLatin1() + ':' + QByteArray::number(size);
+            QTest::newRow(name.constData()) << transport << size;
+        }
+    }
+}
+
+Peer *tst_QSharedMemoryChannel::createPeer(const QString &transport)
+{
+#ifdef QT_NETWORK_LIB
+    if (transport == QLatin1String("localsocket"))
+        return new LocalSocketPeer;
+#endif
+    Q_UNUSED(transport);
+    return new ChannelPeer;
+}
+
+void tst_QSharedMemoryChannel::roundTrip_data()
+{
+    addRows(QList<int>() << 16 << 256 << 4096);
+}
+
+// time for 1000 round trips of one message to the peer and back
+void tst_QSharedMemoryChannel::roundTrip()
+{
+    QFETCH(QString, transport);
+    QFETCH(int, size);
+
+    QScopedPointer<Peer> peer(createPeer(transport));
+    QVERIFY(peer->start(size));
+
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            if (!peer->echo())
+                QFAIL("round trip failed");
+        }
+    }
+}
+
+void tst_QSharedMemoryChannel::throughput_data()
+{
+    addRows(QList<int>() << 64 << 1024 << 16384);
+}
+
+// time to receive 16 MB from the peer, in messages of the given size
+void tst_QSharedMemoryChannel::throughput()
+{
+    QFETCH(QString, transport);
+    QFETCH(int, size);
+
+    QScopedPointer<Peer> peer(createPeer(transport));
+    QVERIFY(peer->start(size));
+
+    const qint64 count = (16 << 20) / size;
+    QBENCHMARK {
+        QVERIFY(peer->stream(count));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    if (argc == 5 && qstrcmp(argv[1], "-peer") == 0) {
+        const QString name = QString::fromLocal8Bit(argv[3]);
+        const int size = atoi(argv[4]);
+#ifdef QT_NETWORK_LIB
+        if (qstrcmp(argv[2], "localsocket") == 0)
+            return runLocalSocketPeer(name, size);
+#endif
+        return runChannelPeer(name, size);
+    }
+
+    tst_QSharedMemoryChannel tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "main.moc"
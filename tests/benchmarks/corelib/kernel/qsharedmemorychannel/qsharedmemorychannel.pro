@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = tst_bench_qsharedmemorychannel
+
+QT = core testlib
+# compare against QLocalSocket when QtNetwork is available
+qtHaveModule(network): QT += network
+
+SOURCES += main.cpp
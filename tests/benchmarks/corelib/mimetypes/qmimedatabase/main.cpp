@@ -28,15 +28,59 @@
 
 #include <QtTest/QtTest>
 
+Q_DECLARE_METATYPE(QMimeDatabase::MatchMode)
+
 class tst_QMimeDatabase: public QObject
 {
 
     Q_OBJECT
 
 private slots:
+    void initTestCase();
     void inheritsPerformance();
+    void firstLookup_data();
+    void firstLookup();
+    void mimeTypeForFiles_data();
+    void mimeTypeForFiles();
+
+private:
+    QTemporaryDir m_emptyDataDir;
+    QTemporaryDir m_filesDir;
+    QStringList m_fileNames;
 };
 
+static const char firstLookupArgument[] = "-first-lookup";
+
+// Run in a child process, so that the database is loaded from scratch
+static int firstLookup()
+{
+    QMimeDatabase db;
+    return db.mimeTypeForFile(QStringLiteral("main.cpp"), QMimeDatabase::MatchExtension).isDefault() ? 1 : 0;
+}
+
+void tst_QMimeDatabase::initTestCase()
+{
+    QVERIFY(m_emptyDataDir.isValid());
+    QVERIFY(m_filesDir.isValid());
+
+    // A directory listing of 1000 files: mostly known extensions, some of
+    // which need their contents to be looked at
+    static const char *const extensions[] = { "txt", "png", "cpp", "h", "html", "pdf", "bak", "" };
+    static const char *const contents[] = { "plain text\n", "\x89PNG\r\n\x1a\n", "int main() {}\n", "#pragma once\n",
+                                            "<html></html>\n", "%PDF-1.4\n", "%PDF-1.4\n", "%!PS-Adobe-3.0\n" };
+    const int numExtensions = int(sizeof(extensions) / sizeof(extensions[0]));
+    for (int i = 0; i < 1000; ++i) {
+        const int type = i % numExtensions;
+        QString fileName = m_filesDir.path() + QLatin1String("/file") + QString::number(i);
+        if (*extensions[type])
+            fileName += QLatin1Char('.') + QLatin1String(extensions[type]);
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(contents[type]);
+        m_fileNames.append(fileName);
+    }
+}
+
 void tst_QMimeDatabase::inheritsPerformance()
 {
     // Check performance of inherits().
@@ -70,5 +114,82 @@ void tst_QMimeDatabase::inheritsPerformance()
     // parsing XML, and then keeps being around 4.5 MB for all the in-memory hashes.
 }
 
-QTEST_MAIN(tst_QMimeDatabase)
+void tst_QMimeDatabase::firstLookup_data()
+{
+    QTest::addColumn<bool>("builtInCache");
+
+    QTest::newRow("built-in cache") << true;
+    QTest::newRow("XML") << false;
+}
+
+void tst_QMimeDatabase::firstLookup()
+{
+#if !QT_CONFIG(process)
+    QSKIP("No QProcess support");
+#else
+    QFETCH(bool, builtInCache);
+
+    // Hide the system database, as in a minimal installation without shared-mime-info
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("XDG_DATA_HOME"), m_emptyDataDir.path());
+    environment.insert(QStringLiteral("XDG_DATA_DIRS"), m_emptyDataDir.path());
+    if (builtInCache)
+        environment.remove(QStringLiteral("QT_NO_MIME_CACHE"));
+    else
+        environment.insert(QStringLiteral("QT_NO_MIME_CACHE"), QStringLiteral("1"));
+
+    // Includes starting the process, compare the rows with each other
+    QBENCHMARK {
+        QProcess process;
+        process.setProcessEnvironment(environment);
+        process.start(QCoreApplication::applicationFilePath(), QStringList(QLatin1String(firstLookupArgument)));
+        QVERIFY(process.waitForFinished());
+        QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+        QCOMPARE(process.exitCode(), 0);
+    }
+#endif
+}
+
+void tst_QMimeDatabase::mimeTypeForFiles_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::addColumn<QMimeDatabase::MatchMode>("mode");
+
+    QTest::newRow("one by one, default") << false << QMimeDatabase::MatchDefault;
+    QTest::newRow("batched, default") << true << QMimeDatabase::MatchDefault;
+    QTest::newRow("one by one, extension") << false << QMimeDatabase::MatchExtension;
+    QTest::newRow("batched, extension") << true << QMimeDatabase::MatchExtension;
+}
+
+void tst_QMimeDatabase::mimeTypeForFiles()
+{
+    QFETCH(bool, batched);
+    QFETCH(QMimeDatabase::MatchMode, mode);
+
+    QMimeDatabase db;
+    db.mimeTypeForFile(m_fileNames.first(), mode); // load the database
+
+    if (batched) {
+        QBENCHMARK {
+            const QList<QMimeType> mimes = db.mimeTypesForFiles(m_fileNames, mode);
+            QCOMPARE(mimes.size(), m_fileNames.size());
+        }
+    } else {
+        QBENCHMARK {
+            for (const QString &fileName : qAsConst(m_fileNames))
+                db.mimeTypeForFile(fileName, mode);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    if (argc == 2 && qstrcmp(argv[1], firstLookupArgument) == 0)
+        return firstLookup();
+
+    tst_QMimeDatabase tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
 #include "main.moc"
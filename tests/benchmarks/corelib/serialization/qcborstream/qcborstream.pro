@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = tst_bench_qcborstream
+
+QT = core testlib
+
+CONFIG += release
+
+SOURCES += tst_bench_qcborstream.cpp
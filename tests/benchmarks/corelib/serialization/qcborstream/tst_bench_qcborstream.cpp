@@ -0,0 +1,193 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <qcborstream.h>
+#include <qjsonarray.h>
+#include <qjsondocument.h>
+#include <qjsonobject.h>
+
+enum Format {
+    CborVariant,
+    CborJson,
+    CborTokens,
+    JsonText,
+    JsonTextVariant,
+    BinaryJson,
+    DataStreamVariant
+};
+Q_DECLARE_METATYPE(Format)
+
+class tst_bench_QCborStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void encode_data();
+    void encode();
+    void decode_data();
+    void decode();
+
+private:
+    QVariant records;
+    QJsonValue jsonRecords;
+};
+
+void tst_bench_QCborStream::initTestCase()
+{
+    // a message with 5000 small records, as sent between processes
+    QVariantList list;
+    for (int i = 0; i < 5000; ++i) {
+        QVariantMap record;
+        record.insert("id", i);
+        record.insert("name", QString("record %1").arg(i));
+        record.insert("score", i / 7.);
+        record.insert("enabled", i % 2 == 0);
+        record.insert("tags", QStringList() << "alpha" << "beta");
+        list.append(record);
+    }
+    records = list;
+    jsonRecords = QJsonValue::fromVariant(records);
+}
+
+static QByteArray encoded(Format format, const QVariant &records, const QJsonValue &jsonRecords)
+{
+    QByteArray data;
+    switch (format) {
+    case CborVariant:
+    case CborTokens: {
+        QCborStreamWriter writer(&data);
+        writer.writeVariant(records);
+        break;
+    }
+    case CborJson: {
+        QCborStreamWriter writer(&data);
+        writer.writeJsonValue(jsonRecords);
+        break;
+    }
+    case JsonText:
+    case JsonTextVariant:
+        data = QJsonDocument(jsonRecords.toArray()).toJson(QJsonDocument::Compact);
+        break;
+    case BinaryJson:
+        data = QJsonDocument(jsonRecords.toArray()).toBinaryData();
+        break;
+    case DataStreamVariant: {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << records;
+        break;
+    }
+    }
+    return data;
+}
+
+static void addFormats(bool decoding)
+{
+    QTest::addColumn<Format>("format");
+    QTest::newRow("CBOR, QVariant") << CborVariant;
+    QTest::newRow("CBOR, QJsonValue") << CborJson;
+    if (decoding)
+        QTest::newRow("CBOR, tokens only") << CborTokens;
+    QTest::newRow("JSON text") << JsonText;
+    if (decoding)
+        QTest::newRow("JSON text, QVariant") << JsonTextVariant;
+    QTest::newRow("binary JSON") << BinaryJson;
+    QTest::newRow("QDataStream, QVariant") << DataStreamVariant;
+}
+
+void tst_bench_QCborStream::encode_data()
+{
+    addFormats(false);
+}
+
+void tst_bench_QCborStream::encode()
+{
+    QFETCH(Format, format);
+
+    QBENCHMARK {
+        QByteArray data = encoded(format, records, jsonRecords);
+        QVERIFY(!data.isEmpty());
+    }
+}
+
+void tst_bench_QCborStream::decode_data()
+{
+    addFormats(true);
+}
+
+void tst_bench_QCborStream::decode()
+{
+    QFETCH(Format, format);
+
+    const QByteArray data = encoded(format, records, jsonRecords);
+    QBENCHMARK {
+        switch (format) {
+        case CborVariant: {
+            QCborStreamReader reader(data);
+            reader.readNext();
+            QCOMPARE(reader.readCurrentVariant().toList().size(), 5000);
+            break;
+        }
+        case CborJson: {
+            QCborStreamReader reader(data);
+            reader.readNext();
+            QCOMPARE(reader.readCurrentJsonValue().toArray().size(), 5000);
+            break;
+        }
+        case CborTokens: {
+            QCborStreamReader reader(data);
+            while (reader.readNext() != QCborStreamReader::NoToken) {
+                if (reader.tokenType() == QCborStreamReader::TextString)
+                    reader.rawStringData();
+            }
+            QVERIFY(!reader.hasError());
+            break;
+        }
+        case JsonText:
+            QCOMPARE(QJsonDocument::fromJson(data).array().size(), 5000);
+            break;
+        case JsonTextVariant:
+            QCOMPARE(QJsonDocument::fromJson(data).toVariant().toList().size(), 5000);
+            break;
+        case BinaryJson:
+            QCOMPARE(QJsonDocument::fromBinaryData(data).array().size(), 5000);
+            break;
+        case DataStreamVariant: {
+            QDataStream stream(data);
+            QVariant value;
+            stream >> value;
+            QCOMPARE(value.toList().size(), 5000);
+            break;
+        }
+        }
+    }
+}
+
+QTEST_MAIN(tst_bench_QCborStream)
+#include "tst_bench_qcborstream.moc"
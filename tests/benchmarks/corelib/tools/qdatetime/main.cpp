@@ -44,6 +44,7 @@ class tst_QDateTime : public QObject
         MSECS_PER_DAY = 86400000,
         JULIAN_DAY_1950 = 2433283,
         JULIAN_DAY_1960 = 2436935,
+        JULIAN_DAY_1970 = 2440588,
         JULIAN_DAY_2010 = 2455198,
         JULIAN_DAY_2011 = 2455563,
         JULIAN_DAY_2020 = 2458850,
@@ -75,6 +76,8 @@ private Q_SLOTS:
     void toString();
     void toStringTextFormat();
     void toStringIsoFormat();
+    void toStringIsoFormatUtc();
+    void toStringNumericFormat();
     void addDays();
     void addDaysTz();
     void addMSecs();
@@ -95,9 +98,13 @@ private Q_SLOTS:
     void fromString();
     void fromStringText();
     void fromStringIso();
+    void fromStringIsoLatin1();
+    void fromStringRfc3339();
     void fromMSecsSinceEpoch();
     void fromMSecsSinceEpochUtc();
     void fromMSecsSinceEpochTz();
+    void createTimeZones();
+    void convertAcrossTimeZones();
 };
 
 void tst_QDateTime::create()
@@ -357,6 +364,29 @@ void tst_QDateTime::toStringIsoFormat()
     }
 }
 
+void tst_QDateTime::toStringIsoFormatUtc()
+{
+    QList<QDateTime> list;
+    for (int jd = JULIAN_DAY_2010; jd < JULIAN_DAY_2011; ++jd)
+        list.append(QDateTime(QDate::fromJulianDay(jd), QTime(13, 28, 34, 999), Qt::UTC));
+    QBENCHMARK {
+        foreach (const QDateTime &test, list)
+            test.toString(Qt::ISODateWithMs);
+    }
+}
+
+void tst_QDateTime::toStringNumericFormat()
+{
+    const QString format = QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz");
+    QList<QDateTime> list;
+    for (int jd = JULIAN_DAY_2010; jd < JULIAN_DAY_2011; ++jd)
+        list.append(QDateTime(QDate::fromJulianDay(jd), QTime::fromMSecsSinceStartOfDay(0)));
+    QBENCHMARK {
+        foreach (const QDateTime &test, list)
+            test.toString(format);
+    }
+}
+
 void tst_QDateTime::addDays()
 {
     QList<QDateTime> list;
@@ -574,6 +604,27 @@ void tst_QDateTime::fromStringIso()
     }
 }
 
+void tst_QDateTime::fromStringIsoLatin1()
+{
+    const QByteArray input = "2010-01-01T13:28:34.999Z";
+    const QLatin1String latin1(input.constData(), input.size());
+    QVERIFY(QDateTime::fromString(latin1, Qt::ISODate).isValid());
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            QDateTime::fromString(latin1, Qt::ISODate);
+    }
+}
+
+void tst_QDateTime::fromStringRfc3339()
+{
+    QString input = "2010-01-01 13:28:34.999123+01:00";
+    QVERIFY(QDateTime::fromString(input, Qt::ISODate).isValid());
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            QDateTime::fromString(input, Qt::ISODate);
+    }
+}
+
 void tst_QDateTime::fromMSecsSinceEpoch()
 {
     QBENCHMARK {
@@ -599,6 +650,34 @@ void tst_QDateTime::fromMSecsSinceEpochTz()
     }
 }
 
+void tst_QDateTime::createTimeZones()
+{
+    const QList<QByteArray> ids = QTimeZone::availableTimeZoneIds();
+    QBENCHMARK {
+        foreach (const QByteArray &id, ids)
+            QTimeZone zone(id);
+    }
+}
+
+void tst_QDateTime::convertAcrossTimeZones()
+{
+    QList<QTimeZone> zones;
+    foreach (const QByteArray &id, QTimeZone::availableTimeZoneIds())
+        zones.append(QTimeZone(id));
+    QList<qint64> stamps;
+    for (int jd = JULIAN_DAY_2010; jd < JULIAN_DAY_2020; jd += 73)
+        stamps.append((jd - JULIAN_DAY_1970) * MSECS_PER_DAY + 12345678);
+    QBENCHMARK {
+        foreach (const QTimeZone &zone, zones) {
+            foreach (qint64 msecs, stamps) {
+                const QDateTime local = QDateTime::fromMSecsSinceEpoch(msecs, zone);
+                qint64 result = local.toMSecsSinceEpoch();
+                Q_UNUSED(result);
+            }
+        }
+    }
+}
+
 QTEST_MAIN(tst_QDateTime)
 
 #include "main.moc"
@@ -0,0 +1,200 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QFile>
+#include <QTextCodec>
+#include <QXmlStreamReader>
+
+class tst_QXmlStreamReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void readAll_data();
+    void readAll();
+    void readAttributes_data();
+    void readAttributes();
+    void compareNames_data();
+    void compareNames();
+
+private:
+    void addRows();
+
+    QByteArray feed;
+};
+
+/*
+    Generates a feed of \a count entries resembling an Atom feed, with
+    attributes on most elements and some non-ASCII text.
+*/
+static QByteArray generateFeed(int count)
+{
+    QByteArray xml;
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<feed xmlns=\"http://www.w3.org/2005/Atom\" xml:lang=\"en\">\n";
+    for (int i = 0; i < count; ++i) {
+        const QByteArray n = QByteArray::number(i);
+        xml += "  <entry id=\"urn:uuid:" + n + "\" type=\"post\" rank=\"" + QByteArray::number(i % 17) + "\">\n"
+               "    <title type=\"text\">Entry number " + n + " of the feed</title>\n"
+               "    <link rel=\"alternate\" href=\"http://example.org/2017/entries/" + n + ".html\"/>\n"
+               "    <author><name>Ren\xc3\xa9 M\xc3\xbcller</name><uri>http://example.org/~user" + n + "</uri></author>\n"
+               "    <updated>2017-06-12T18:30:02Z</updated>\n"
+               "    <summary type=\"html\">Some &lt;b&gt;markup&lt;/b&gt; and a longer run of plain text "
+               "that makes up most of the content of a typical feed entry, na\xc3\xafve caf\xc3\xa9.</summary>\n"
+               "  </entry>\n";
+    }
+    xml += "</feed>\n";
+    return xml;
+}
+
+void tst_QXmlStreamReader::initTestCase()
+{
+    feed = generateFeed(5000);
+}
+
+void tst_QXmlStreamReader::addRows()
+{
+    QTest::addColumn<QByteArray>("xml");
+    QTest::addColumn<bool>("interned");
+
+    const QByteArray utf16 = QTextCodec::codecForName("UTF-16")->fromUnicode(
+                QString::fromUtf8(feed).replace(QLatin1String("UTF-8"), QLatin1String("UTF-16")));
+    QTest::newRow("utf8") << feed << false;
+    QTest::newRow("utf8-interned") << feed << true;
+    QTest::newRow("utf16") << utf16 << false;
+
+    // use e.g. QT_BENCH_XML_CORPUS=/path/to/feed.xml to measure with real data as well
+    const QString corpus = QFile::decodeName(qgetenv("QT_BENCH_XML_CORPUS"));
+    if (!corpus.isEmpty()) {
+        QFile file(corpus);
+        if (!file.open(QIODevice::ReadOnly))
+            QFAIL(qPrintable(file.errorString()));
+        const QByteArray data = file.readAll();
+        QTest::newRow("corpus") << data << false;
+        QTest::newRow("corpus-interned") << data << true;
+    }
+}
+
+void tst_QXmlStreamReader::readAll_data()
+{
+    addRows();
+}
+
+void tst_QXmlStreamReader::readAll()
+{
+    QFETCH(QByteArray, xml);
+    QFETCH(bool, interned);
+
+    QBENCHMARK {
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::ReadOnly);
+        QXmlStreamReader reader(&buffer);
+        reader.setNameInterning(interned);
+        while (!reader.atEnd())
+            reader.readNext();
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+}
+
+void tst_QXmlStreamReader::readAttributes_data()
+{
+    addRows();
+}
+
+void tst_QXmlStreamReader::readAttributes()
+{
+    QFETCH(QByteArray, xml);
+    QFETCH(bool, interned);
+
+    int attributeCount = 0;
+    QBENCHMARK {
+        attributeCount = 0;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::ReadOnly);
+        QXmlStreamReader reader(&buffer);
+        reader.setNameInterning(interned);
+        while (!reader.atEnd()) {
+            if (reader.readNext() == QXmlStreamReader::StartElement) {
+                const QXmlStreamAttributes attributes = reader.attributes();
+                for (const QXmlStreamAttribute &attribute : attributes)
+                    attributeCount += attribute.value().size() ? 1 : 0;
+            }
+        }
+        QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+    }
+    QVERIFY(attributeCount > 0);
+}
+
+void tst_QXmlStreamReader::compareNames_data()
+{
+    addRows();
+}
+
+void tst_QXmlStreamReader::compareNames()
+{
+    QFETCH(QByteArray, xml);
+    QFETCH(bool, interned);
+
+    int entryCount = 0;
+    QBENCHMARK {
+        entryCount = 0;
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::ReadOnly);
+        QXmlStreamReader reader(&buffer);
+        reader.setNameInterning(interned);
+        if (interned) {
+            // interned names are compared by their data pointer
+            const QChar *entry = reader.internedName(QStringLiteral("entry")).unicode();
+            const QChar *link = reader.internedName(QStringLiteral("link")).unicode();
+            while (!reader.atEnd()) {
+                if (reader.readNext() != QXmlStreamReader::StartElement)
+                    continue;
+                const QChar *name = reader.name().unicode();
+                if (name == entry || name == link)
+                    ++entryCount;
+            }
+        } else {
+            while (!reader.atEnd()) {
+                if (reader.readNext() != QXmlStreamReader::StartElement)
+                    continue;
+                const QStringRef name = reader.name();
+                if (name == QLatin1String("entry") || name == QLatin1String("link"))
+                    ++entryCount;
+            }
+        }
+    }
+    QVERIFY(entryCount > 0);
+}
+
+QTEST_MAIN(tst_QXmlStreamReader)
+
+#include "tst_bench_qxmlstreamreader.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = tst_bench_qdomdocument
+QT = core xml testlib
+CONFIG += release
+
+SOURCES += tst_bench_qdomdocument.cpp
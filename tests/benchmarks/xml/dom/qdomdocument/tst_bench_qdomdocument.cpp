@@ -0,0 +1,248 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <QDomDocument>
+#include <QXmlInputSource>
+#include <QXmlSimpleReader>
+#include <QXmlStreamReader>
+
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#endif
+
+class tst_QDomDocument : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void setContent_data();
+    void setContent();
+    void setContentInThreads_data();
+    void setContentInThreads();
+    void firstAccess_data();
+    void firstAccess();
+    void memoryPerNode_data();
+    void memoryPerNode();
+
+private:
+    void addRows();
+
+    QString catalog;
+};
+
+enum Mode { Sax, Stream, Lazy };
+Q_DECLARE_METATYPE(Mode)
+
+/*
+    Generates a catalog of \a count products with a few attributes and
+    text-only children each, the typical shape of configuration and data
+    exchange documents.
+*/
+static QString generateCatalog(int count)
+{
+    QString xml;
+    xml += QLatin1String("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                         "<catalog xmlns=\"urn:example:catalog\" version=\"2\">\n");
+    for (int i = 0; i < count; ++i) {
+        const QString n = QString::number(i);
+        xml += QLatin1String("  <product id=\"p") + n + QLatin1String("\" category=\"c")
+            + QString::number(i % 23) + QLatin1String("\">\n"
+                                "    <name>Product ") + n + QLatin1String("</name>\n"
+                                "    <price currency=\"EUR\">") + QString::number(i % 997) + QLatin1String(".95</price>\n"
+                                "    <description>A description of the product with some text in it.</description>\n"
+                                "    <tags><tag>new</tag><tag>sale</tag></tags>\n"
+                                "  </product>\n");
+    }
+    xml += QLatin1String("</catalog>\n");
+    return xml;
+}
+
+static bool load(QDomDocument *doc, const QString &xml, Mode mode)
+{
+    switch (mode) {
+    case Sax:
+        return doc->setContent(xml, true);
+    case Stream: {
+        QXmlStreamReader reader(xml);
+        return doc->setContent(&reader, true);
+    }
+    case Lazy:
+        return doc->setContentLazily(xml, 2, true);
+    }
+    return false;
+}
+
+static int countNodes(const QDomNode &node)
+{
+    int count = 1 + node.attributes().count();
+    for (QDomNode n = node.firstChild(); !n.isNull(); n = n.nextSibling())
+        count += countNodes(n);
+    return count;
+}
+
+void tst_QDomDocument::initTestCase()
+{
+    catalog = generateCatalog(20000);
+}
+
+void tst_QDomDocument::addRows()
+{
+    QTest::addColumn<Mode>("mode");
+
+    QTest::newRow("QXmlSimpleReader") << Sax;
+    QTest::newRow("QXmlStreamReader") << Stream;
+    QTest::newRow("lazy") << Lazy;
+}
+
+void tst_QDomDocument::setContent_data()
+{
+    addRows();
+}
+
+void tst_QDomDocument::setContent()
+{
+    QFETCH(Mode, mode);
+
+    QBENCHMARK {
+        QDomDocument doc;
+        QVERIFY(load(&doc, catalog, mode));
+    }
+}
+
+class LoadThread : public QThread
+{
+public:
+    LoadThread(const QString &xml, Mode mode) : xml(xml), mode(mode), ok(false) {}
+
+    const QString &xml;
+    const Mode mode;
+    bool ok;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        QDomDocument doc;
+        ok = load(&doc, xml, mode);
+    }
+};
+
+void tst_QDomDocument::setContentInThreads_data()
+{
+    QTest::addColumn<Mode>("mode");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("QXmlStreamReader, 1 thread") << Stream << 1;
+    QTest::newRow("QXmlStreamReader, 4 threads") << Stream << 4;
+}
+
+// every thread loads a document of its own, so that the time only grows
+// with the number of threads if they contend for shared state
+void tst_QDomDocument::setContentInThreads()
+{
+    QFETCH(Mode, mode);
+    QFETCH(int, threadCount);
+
+    QBENCHMARK {
+        QVector<LoadThread *> threads;
+        for (int i = 0; i < threadCount; ++i)
+            threads.append(new LoadThread(catalog, mode));
+        for (LoadThread *thread : qAsConst(threads))
+            thread->start();
+        for (LoadThread *thread : qAsConst(threads))
+            thread->wait();
+        bool ok = true;
+        for (LoadThread *thread : qAsConst(threads))
+            ok &= thread->ok;
+        qDeleteAll(threads);
+        QVERIFY(ok);
+    }
+}
+
+void tst_QDomDocument::firstAccess_data()
+{
+    addRows();
+}
+
+// loads the document and looks at a single product, as a consumer
+// interested in one record would do
+void tst_QDomDocument::firstAccess()
+{
+    QFETCH(Mode, mode);
+
+    QBENCHMARK {
+        QDomDocument doc;
+        QVERIFY(load(&doc, catalog, mode));
+        QDomElement product = doc.documentElement().firstChildElement();
+        for (int i = 0; i < 100; ++i)
+            product = product.nextSiblingElement();
+        QCOMPARE(product.firstChildElement(QStringLiteral("name")).text(), QStringLiteral("Product 100"));
+    }
+}
+
+void tst_QDomDocument::memoryPerNode_data()
+{
+    addRows();
+}
+
+// reports the heap in use by the document, divided by the number of nodes
+// it has once fully built
+void tst_QDomDocument::memoryPerNode()
+{
+#if defined(__GLIBC__)
+    QFETCH(Mode, mode);
+
+    QDomDocument reference;
+    QVERIFY(load(&reference, catalog, Sax));
+    const int nodeCount = countNodes(reference.documentElement());
+    reference.clear();
+
+#  if __GLIBC_PREREQ(2, 33)
+    const qint64 before = qint64(mallinfo2().uordblks);
+#  else
+    const qint64 before = mallinfo().uordblks;
+#  endif
+    QDomDocument doc;
+    QVERIFY(load(&doc, catalog, mode));
+#  if __GLIBC_PREREQ(2, 33)
+    const qint64 after = qint64(mallinfo2().uordblks);
+#  else
+    const qint64 after = mallinfo().uordblks;
+#  endif
+
+    QTest::setBenchmarkResult(qreal(after - before) / nodeCount, QTest::BytesAllocated);
+#else
+    QSKIP("Heap statistics are only available with glibc");
+#endif
+}
+
+QTEST_MAIN(tst_QDomDocument)
+
+#include "tst_bench_qdomdocument.moc"